@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/xml.h>
+using namespace clan;
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		Console::write_line("Usage: resourcecompiler <resources.xml> <output file>");
+		return 1;
+	}
+
+	try
+	{
+		uint64_t start_time = System::get_microseconds();
+
+		XMLResourceDocument document(argv[1]);
+		document.save_compiled(argv[2]);
+
+		Console::write_line("Compiled %1 resources from %2 in %3 ms", (int)document.get_resource_names().size(), argv[1], (int)((System::get_microseconds() - start_time) / 1000));
+	}
+	catch (Exception &exception)
+	{
+		Console::write_line("Exception caught: " + exception.get_message_and_stack_trace());
+		return 1;
+	}
+
+	return 0;
+}
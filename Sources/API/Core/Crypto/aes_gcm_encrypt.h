@@ -0,0 +1,108 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Crypto clanCore Crypto
+	/// \{
+
+	class DataBuffer;
+	class AES_GCM_Impl;
+
+	/// \brief AES authenticated encryption class (running in Galois/Counter mode)
+	///
+	/// The data is encrypted in counter mode and authenticated together with the additional data
+	/// by a 16 byte tag. Blocks are processed in parallel, using AES-NI and PCLMULQDQ when the CPU supports them.
+	class AES_GCM_Encrypt
+	{
+	public:
+		/// \brief Constructs a AES generator (running in Galois/Counter mode)
+		AES_GCM_Encrypt();
+
+		/// \brief Get encrypted data
+		///
+		/// This is the databuffer used internally to store the encrypted data.
+		/// You may call "set_size()" to clear the buffer, inbetween calls to "add()"
+		/// You may call "set_capacity()" to optimise storage requirements before the add() call
+		DataBuffer get_data() const;
+
+		static const int iv_size = 12;
+		static const int tag_size = 16;
+		static const int block_size = 16;
+
+		/// \brief Resets the encryption
+		void reset();
+
+		/// \brief Sets the initialisation vector
+		///
+		/// An initialisation vector must never be used twice with the same key.\n
+		/// This must be called before the initial add()
+		///
+		/// \param iv = The initialisation vector
+		/// \param iv_length = Size of the initialisation vector. 12 bytes is recommended
+		void set_iv(const unsigned char *iv, int iv_length = iv_size);
+
+		/// \brief Sets the cipher key
+		///
+		/// This must be called before the initial add()
+		///
+		/// \param key = The cipher key
+		/// \param key_size = 16 (AES-128), 24 (AES-192) or 32 (AES-256) bytes
+		void set_key(const unsigned char *key, int key_size);
+
+		/// \brief Adds data that is authenticated, but not encrypted
+		///
+		/// This must be called before the initial add()
+		void add_additional_data(const void *data, int size);
+
+		/// \brief Adds data to be encrypted
+		void add(const void *data, int size);
+
+		/// \brief Add data to be encrypted
+		///
+		/// \param data = Data Buffer
+		void add(const DataBuffer &data);
+
+		/// \brief Finalize encryption and calculate the authentication tag
+		void calculate();
+
+		/// \brief Get the authentication tag
+		///
+		/// This must be called after calculate()
+		void get_tag(unsigned char out_tag[tag_size]) const;
+
+	private:
+		std::shared_ptr<AES_GCM_Impl> impl;
+	};
+
+	/// \}
+}
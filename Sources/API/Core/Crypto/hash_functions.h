@@ -44,6 +44,8 @@ namespace clan
 	/// \addtogroup clanCore_Crypto clanCore Crypto
 	/// \{
 
+	class IODevice;
+
 	/// \brief A Collection of checksum functions.
 	class HashFunctions
 	{
@@ -359,6 +361,53 @@ namespace clan
 		/// \param data = Data Buffer
 		/// \param out_hash = char
 		static void sha512_256(const DataBuffer &data, unsigned char out_hash[32]);
+
+		/// \brief Generate the SHA-1 hashes of many independent messages at once
+		///
+		/// When the CPU supports AVX2 (but not the faster SHA extensions), eight messages are hashed side by side in SIMD lanes.
+		///
+		/// \param num_messages = Number of messages
+		/// \param data = Pointer to each message
+		/// \param sizes = Size of each message
+		/// \param out_hashes = Where to write to, 20 bytes per message
+		static void sha1_multi_buffer(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes);
+
+		/// \brief Generate the SHA-256 hashes of many independent messages at once
+		///
+		/// When the CPU supports AVX2 (but not the faster SHA extensions), eight messages are hashed side by side in SIMD lanes.
+		///
+		/// \param num_messages = Number of messages
+		/// \param data = Pointer to each message
+		/// \param sizes = Size of each message
+		/// \param out_hashes = Where to write to, 32 bytes per message
+		static void sha256_multi_buffer(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes);
+
+		static const int sha256_tree_leaf_size = 1024 * 1024;
+
+		/// \brief Generate a SHA-256 tree hash from data
+		///
+		/// The data is split into leaves of leaf_size bytes, which are hashed in parallel on all CPU cores.\n
+		/// A leaf hashes to SHA-256(0x00 + leaf) and a pair of nodes to SHA-256(0x01 + left + right).
+		/// An odd node is carried up to the next level unchanged.\n
+		/// The result differs from sha256() of the same data, and depends on the leaf size.
+		static std::string sha256_tree(const void *data, int size, bool uppercase = false, int leaf_size = sha256_tree_leaf_size);
+
+		/// \brief SHA256 tree hash
+		///
+		/// \param data = void
+		/// \param size = value
+		/// \param out_hash = char
+		/// \param leaf_size = Size of the leaves
+		static void sha256_tree(const void *data, int size, unsigned char out_hash[32], int leaf_size = sha256_tree_leaf_size);
+
+		/// \brief SHA256 tree hash of the remaining data of a device
+		///
+		/// The device is read a batch of leaves at a time, so large files do not need to fit in memory.
+		///
+		/// \param device = IODevice
+		/// \param out_hash = char
+		/// \param leaf_size = Size of the leaves
+		static void sha256_tree(IODevice &device, unsigned char out_hash[32], int leaf_size = sha256_tree_leaf_size);
 	};
 
 	/// \}
@@ -71,6 +71,21 @@ namespace clan
 		/// \param public_exponent_value = public exponent value
 		static void create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, int key_size_in_bits = 1024, int public_exponent_value = 65537);
 
+		/// \brief Create a keypair, including the Chinese Remainder Theorem (CRT) parameters for the faster private key operations
+		///
+		/// \param random = Random number generator
+		/// \param out_private_exponent = Private exponent (to decrypt with)
+		/// \param out_public_exponent = Public exponent (to encrypt with)
+		/// \param out_modulus = Modulus
+		/// \param out_prime1 = First prime factor of the modulus (p)
+		/// \param out_prime2 = Second prime factor of the modulus (q)
+		/// \param out_exponent1 = Private exponent mod (p-1)
+		/// \param out_exponent2 = Private exponent mod (q-1)
+		/// \param out_coefficient = q^-1 mod p
+		/// \param key_size_in_bits = key size in bits
+		/// \param public_exponent_value = public exponent value
+		static void create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, Secret &out_prime1, Secret &out_prime2, Secret &out_exponent1, Secret &out_exponent2, Secret &out_coefficient, int key_size_in_bits = 1024, int public_exponent_value = 65537);
+
 		/// \brief Encrypt
 		///
 		/// \param block_type = 0 (private key), 1 (private key) or 2 (public key)
@@ -94,6 +109,19 @@ namespace clan
 		/// \return Encrypted data
 		static DataBuffer encrypt(int block_type, Random &random, const void *in_public_exponent, unsigned int in_public_exponent_size, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size);
 
+		/// \brief Encrypt with the private key using the Chinese Remainder Theorem (about 3 times faster than a private exponent)
+		///
+		/// \param block_type = 0 (private key) or 1 (private key)
+		/// \param random = Random number generator
+		/// \param in_prime1 = First prime factor of the modulus (p)
+		/// \param in_prime2 = Second prime factor of the modulus (q)
+		/// \param in_exponent1 = Private exponent mod (p-1)
+		/// \param in_exponent2 = Private exponent mod (q-1)
+		/// \param in_coefficient = q^-1 mod p
+		/// \param in_data = Data to encrypt (maximum length is the modulus size - 11)
+		/// \return Encrypted data
+		static DataBuffer encrypt(int block_type, Random &random, const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const Secret &in_data);
+
 		/// \brief Decrypt
 		///
 		/// Warning: An exception may be thrown when decrypting if in_data is not valid.
@@ -117,6 +145,20 @@ namespace clan
 		/// \param in_data_size = size in bytes of in_data (length equals in_modulus_size)
 		/// \return Decrypted data
 		static Secret decrypt(const Secret &in_private_exponent, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size);
+
+		/// \brief Decrypt using the Chinese Remainder Theorem (about 3 times faster than a private exponent)
+		///
+		/// Warning: An exception may be thrown when decrypting if in_data is not valid.
+		/// Be careful handling this, to prevent "timing attacks"
+		///
+		/// \param in_prime1 = First prime factor of the modulus (p)
+		/// \param in_prime2 = Second prime factor of the modulus (q)
+		/// \param in_exponent1 = Private exponent mod (p-1)
+		/// \param in_exponent2 = Private exponent mod (q-1)
+		/// \param in_coefficient = q^-1 mod p
+		/// \param in_data = Data to decrypt (length equals the modulus size)
+		/// \return Decrypted data
+		static Secret decrypt(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const DataBuffer &in_data);
 	};
 
 	/// \}
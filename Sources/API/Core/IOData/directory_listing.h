@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 namespace clan
 {
@@ -47,6 +48,9 @@ namespace clan
 		/// \brief Constructs a virtual directory listening object.
 		DirectoryListing(FileSystemProvider *provider, const std::string &path);
 
+		/// \brief Constructs a directory listing from already scanned entries.
+		DirectoryListing(const std::vector<DirectoryListingEntry> &entries);
+
 		virtual ~DirectoryListing();
 
 		/// \brief Returns true if this object is invalid.
@@ -124,11 +124,47 @@ namespace clan
 		/** param: mount_point = The mount point to unmount*/
 		void unmount(const std::string &mount_point);
 
+		/// \brief Mounts a file system as an overlay layer on top of this file system.
+		/** Overlay layers form a union file system: a file is opened from the first layer that contains it,
+			and directory listings merge the contents of all layers.
+			Layers are searched from the highest priority to the lowest, and layers with equal priority
+			in reverse mount order, so the most recently mounted layer wins.
+			The provider of this file system is always searched last.
+			Mount points (see mount()) are matched before any overlay layer.
+			param: fs = Filesystem to use as a layer
+			param: priority = Search priority of the layer*/
+		void mount_overlay(FileSystem fs, int priority = 0);
+
+		/// \brief Mounts a file system as an overlay layer on top of this file system.
+		/** param: path = Path of the directory or zip file to use as a layer
+			param: is_zip_file = false, create as a FileSystemProvider_File, else create as a FileSystemProvider_Zip
+			param: priority = Search priority of the layer*/
+		void mount_overlay(const std::string &path, bool is_zip_file, int priority = 0);
+
+		/// \brief Unmount an overlay layer.
+		/** param: fs = The layer to unmount*/
+		void unmount_overlay(FileSystem fs);
+
+		/// \brief Enables caching of directory listings and overlay path resolution.
+		/** Paths routed to mount points are always cached, as they only depend on the mounts.
+			Directory listings and overlay lookups depend on the contents of the layers and are only cached
+			when this is enabled. Call invalidate_cache() if files are added or removed outside this file system.
+			Caching is disabled by default.*/
+		void set_cache_enabled(bool enable);
+
+		/// \brief Returns true if directory listing and overlay resolution caching is enabled.
+		bool is_cache_enabled() const;
+
+		/// \brief Discards all cached path resolutions and directory listings, including those of mounted file systems.
+		void invalidate_cache();
+
 	private:
 		class NullVFS { };
 		explicit FileSystem(class NullVFS null_fs);
 
 		std::shared_ptr<FileSystem_Impl> impl;
+
+		friend class FileSystem_Impl;
 	};
 
 	/// \}
@@ -65,6 +65,11 @@ namespace clan
 		/// \brief Update directory listing item.
 		virtual bool next_file(DirectoryListingEntry &entry) = 0;
 
+		/// \brief Returns true if a file (not a directory) exists in this source.
+		/** <p>The default implementation searches the directory listing of the file.
+			Providers that can test a single file directly should override it.</p>*/
+		virtual bool file_exists(const std::string &filename);
+
 		/// \brief Return the path of this file source.
 		virtual std::string get_path() const = 0;
 
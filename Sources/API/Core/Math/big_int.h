@@ -135,13 +135,21 @@ namespace clan
 
 		/// \brief  Compute c = (a ** b) mod m.
 		///
-		/// Uses a standard square-and-multiply
-		/// method with modular reductions at each step. (This is basically the
-		/// same code as expt(), except for the addition of the reductions)
+		/// For odd moduli this uses sliding window exponentiation with Montgomery
+		/// multiplication on 64-bit limbs (Karatsuba multiplication for large moduli).
 		///
-		/// The modular reductions are done using Barrett's algorithm (see reduce() for details)
+		/// Even moduli use a standard square-and-multiply method, with the modular
+		/// reductions done using Barrett's algorithm (see reduce() for details)
 		void exptmod(const BigInt *b, const BigInt *m, BigInt *c) const;
 
+		/// \brief  Compute c = (a ** b) mod m, where a or b is a secret (a private key operation).
+		///
+		/// Uses a fixed window with Montgomery multiplication, where the sequence of
+		/// operations and memory accesses only depends on the bit length of b.
+		///
+		/// The modulus must be odd to be constant time (even moduli fall back to exptmod())
+		void exptmod_secret(const BigInt *b, const BigInt *m, BigInt *c) const;
+
 		/// \brief  Compute c = a (mod m).  Result will always be 0 <= c < m.
 		void mod(const BigInt *m, BigInt *c) const;
 
@@ -0,0 +1,103 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "../System/cl_platform.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	/// \brief Small fast non-cryptographic pseudorandom number generator (PCG-XSH-RR 64/32)
+	///
+	/// 16 bytes of state with a period of 2^64 per stream. Generators with different stream numbers
+	/// produce unrelated sequences, which makes streams the natural way to give each thread its own generator.
+	/// Use Random for anything security related.
+	class PCG32
+	{
+	public:
+		/// \brief Constructs the generator
+		///
+		/// \param seed = Starting point in the sequence
+		/// \param stream = Sequence selector, only the lower 63 bits are used
+		explicit PCG32(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0xda3e39cb94b95bdbULL);
+
+		/// \brief Returns the next 32 random bits
+		uint32_t next()
+		{
+			uint64_t old_state = state;
+			state = old_state * multiplier + increment;
+			uint32_t xor_shifted = (uint32_t)(((old_state >> 18) ^ old_state) >> 27);
+			uint32_t rotation = (uint32_t)(old_state >> 59);
+			return (xor_shifted >> rotation) | (xor_shifted << ((0 - rotation) & 31));
+		}
+
+		/// \brief Returns a random bool
+		bool next_bool() { return (next() >> 31) != 0; }
+
+		/// \brief Returns a float in the range [0, 1)
+		float next_float() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+		/// \brief Returns a float in the range [min, max)
+		float next_float(float min, float max) { return min + next_float() * (max - min); }
+
+		/// \brief Returns a double in the range [0, 1)
+		double next_double() { uint64_t high = next() >> 11; return ((high << 32) | next()) * (1.0 / 9007199254740992.0); }
+
+		/// \brief Returns an int in the range [min, max], without bias
+		int next_int(int min, int max);
+
+		/// \brief Returns a normally distributed float
+		float next_normal(float mean = 0.0f, float standard_deviation = 1.0f);
+
+		/// \brief Advances the generator by delta steps in O(log delta)
+		void advance(uint64_t delta);
+
+		/// \brief Returns a generator on a new stream, seeded from this generator
+		PCG32 split();
+
+		/// \brief Fill an array with random 32 bit numbers
+		void fill_uint32(uint32_t *out, int count);
+
+		/// \brief Fill an array with floats in the range [min, max)
+		void fill_float(float *out, int count, float min = 0.0f, float max = 1.0f);
+
+		/// \brief Fill an array with ints in the range [min, max], without bias
+		void fill_int(int *out, int count, int min, int max);
+
+	private:
+		static const uint64_t multiplier = 6364136223846793005ULL;
+
+		uint64_t state;
+		uint64_t increment;
+	};
+
+	/// \}
+}
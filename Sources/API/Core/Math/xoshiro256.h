@@ -0,0 +1,126 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "../System/cl_platform.h"
+#include <cmath>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	/// \brief Fast non-cryptographic pseudorandom number generator (xoshiro256**)
+	///
+	/// Intended for gameplay randomness, such as particle spawns, in hot loops. Use Random for anything
+	/// security related. The period is 2^256-1, and jump() and split() give non-overlapping streams for other threads.
+	///
+	/// The fill functions generate eight numbers at a time with SSE2 or AVX2, from four lanes that are
+	/// 2^192 steps apart. They therefore do not produce the same sequence as repeated calls to next().
+	class Xoshiro256
+	{
+	public:
+		/// \brief Constructs the generator, expanding the seed with SplitMix64
+		explicit Xoshiro256(uint64_t seed = 0);
+
+		/// \brief Returns the next 64 random bits
+		uint64_t next()
+		{
+			uint64_t result = rotate_left(state[1] * 5, 7) * 9;
+			uint64_t t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotate_left(state[3], 45);
+			return result;
+		}
+
+		/// \brief Returns the next 32 random bits
+		uint32_t next_uint32() { return (uint32_t)(next() >> 32); }
+
+		/// \brief Returns a random bool
+		bool next_bool() { return (next() >> 63) != 0; }
+
+		/// \brief Returns a float in the range [0, 1)
+		float next_float() { return (next() >> 40) * (1.0f / 16777216.0f); }
+
+		/// \brief Returns a float in the range [min, max)
+		float next_float(float min, float max) { return min + next_float() * (max - min); }
+
+		/// \brief Returns a double in the range [0, 1)
+		double next_double() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+		/// \brief Returns an int in the range [min, max], without bias
+		int next_int(int min, int max);
+
+		/// \brief Returns a normally distributed float
+		float next_normal(float mean = 0.0f, float standard_deviation = 1.0f);
+
+		/// \brief Advances the generator by 2^128 steps
+		///
+		/// Equivalent to 2^128 calls to next(), for 2^128 non-overlapping sequences
+		void jump();
+
+		/// \brief Advances the generator by 2^192 steps
+		///
+		/// Equivalent to 2^192 calls to next(), for 2^64 starting points that can each be split with jump()
+		void long_jump();
+
+		/// \brief Returns a generator for the current stream, and jumps this generator ahead by 2^128 steps
+		///
+		/// Call once per worker thread to give each thread its own non-overlapping stream
+		Xoshiro256 split();
+
+		/// \brief Fill an array with random 32 bit numbers
+		void fill_uint32(uint32_t *out, int count);
+
+		/// \brief Fill an array with floats in the range [min, max)
+		void fill_float(float *out, int count, float min = 0.0f, float max = 1.0f);
+
+		/// \brief Fill an array with ints in the range [min, max]
+		///
+		/// Uses a multiply and shift instead of rejection sampling, which has a bias of at most (max-min+1)/2^32
+		void fill_int(int *out, int count, int min, int max);
+
+	private:
+		static uint64_t rotate_left(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+		static void jump(uint64_t state[4], const uint64_t polynomial[4]);
+		void init_lanes();
+
+		uint64_t state[4];
+
+		// Lane states for the fill functions, lanes[word][lane]
+		uint64_t lanes[4][4];
+		bool lanes_initialized = false;
+	};
+
+	/// \}
+}
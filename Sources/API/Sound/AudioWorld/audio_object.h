@@ -52,16 +52,23 @@ namespace clan
 		float get_attenuation_begin() const;
 		float get_attenuation_end() const;
 		float get_volume() const;
+		int get_priority() const;
 		bool is_looping() const;
 		bool is_ambience() const;
 		bool is_playing() const;
 
+		/// \brief Returns true if the object is playing without a mixer session, because it is inaudible or lost to higher priority voices
+		bool is_virtual() const;
+
 		void set_position(const Vec3f &position);
 
 		void set_attenuation_begin(float distance);
 		void set_attenuation_end(float distance);
 		void set_volume(float volume);
 
+		/// \brief Sets the priority when the world has more audible objects than voices. Higher priorities play first.
+		void set_priority(int priority);
+
 		void set_sound(const std::string &id);
 		void set_sound(const SoundBuffer &buffer);
 
@@ -53,6 +53,20 @@ namespace clan
 		void enable_reverse_stereo(bool enable);
 		bool is_reverse_stereo_enabled() const;
 
+		/// \brief Sets how many objects may play through the mixer at once
+		///
+		/// The loudest objects of the highest priority play through the mixer. The rest become virtual voices
+		/// that only track their play position, and resume from there once they are among the loudest again.
+		void set_max_voices(int voices);
+		int get_max_voices() const;
+
+		int get_num_real_voices() const;
+		int get_num_virtual_voices() const;
+
+		/// \brief Sets the size of the grid cells used to find the objects within hearing range of the listener
+		void set_cell_size(float size);
+		float get_cell_size() const;
+
 	private:
 		std::shared_ptr<AudioWorld_Impl> impl;
 
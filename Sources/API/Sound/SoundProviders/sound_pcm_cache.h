@@ -0,0 +1,95 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanSound_Sound_Providers clanSound Sound Providers
+	/// \{
+
+	/// \brief Cache of decoded PCM for short compressed clips.
+	///
+	/// Ogg Vorbis providers loaded to memory are decoded on a background thread as soon as
+	/// they are loaded. Sessions started after that share the immutable decoded samples instead
+	/// of running a decoder of their own. The least recently played clips are dropped when the
+	/// decoded samples exceed the memory budget, and decoded again the next time they are played.
+	/// Streamed providers and clips larger than the maximum clip size are never cached.
+	class SoundPCMCache
+	{
+	public:
+		/// \brief Returns the memory budget for decoded samples, in bytes
+		static int64_t get_budget();
+
+		/// \brief Returns the largest decoded clip that is cached, in bytes
+		static int64_t get_max_clip_size();
+
+		/// \brief Returns the number of bytes currently held by decoded clips
+		static int64_t get_cached_bytes();
+
+		/// \brief Returns the number of clips currently decoded
+		static int get_num_clips();
+
+		/// \brief Returns the number of sessions that started from decoded samples
+		static int64_t get_hits();
+
+		/// \brief Returns the number of sessions of cacheable clips that had to run a decoder
+		static int64_t get_misses();
+
+		/// \brief Returns hits / (hits + misses), or 0 if no session started yet
+		static double get_hit_rate();
+
+		/// \brief Returns the decoding time the hits saved, in microseconds
+		static double get_decode_time_saved();
+
+		/// \brief Returns the time spent decoding clips on the background thread, in microseconds
+		static double get_decode_time();
+
+		/// \brief Returns the number of clips dropped to stay within the budget
+		static int64_t get_evictions();
+
+		/// \brief Sets the memory budget for decoded samples, in bytes. 0 disables the cache.
+		static void set_budget(int64_t bytes);
+
+		/// \brief Sets the largest decoded clip to cache, in bytes
+		static void set_max_clip_size(int64_t bytes);
+
+		/// \brief Resets the hit, miss, time and eviction counters
+		static void reset_counters();
+
+		/// \brief Drops all decoded clips
+		static void clear();
+
+		/// \brief Waits until the background thread has decoded all queued clips
+		static void wait_for_predecode();
+	};
+
+	/// \}
+}
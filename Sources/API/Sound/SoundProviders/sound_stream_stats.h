@@ -0,0 +1,67 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanSound_Sound_Providers clanSound Sound Providers
+	/// \{
+
+	/// \brief Memory and underrun counters for the sound providers.
+	///
+	/// Streaming providers (constructed with stream set to true) keep a small ring buffer
+	/// per playing session, refilled ahead of the mixer by a background I/O thread.
+	/// An underrun is counted every time the mixer found a ring buffer short of data. The
+	/// mixer never waits for the device: the missing samples are played as silence.
+	class SoundStreamStats
+	{
+	public:
+		/// \brief Returns the number of bytes held by streaming sessions (ring buffers and decoder input)
+		static int64_t get_streaming_bytes();
+
+		/// \brief Returns the number of bytes held by providers loaded to memory
+		static int64_t get_loaded_bytes();
+
+		/// \brief Returns the number of streaming sessions currently open
+		static int get_active_streams();
+
+		/// \brief Returns the total number of bytes read from devices by streaming sessions
+		static int64_t get_bytes_streamed();
+
+		/// \brief Returns the number of times the mixer played silence because a ring buffer ran dry
+		static int get_underruns();
+
+		/// \brief Resets the bytes streamed and underrun counters
+		static void reset_counters();
+	};
+
+	/// \}
+}
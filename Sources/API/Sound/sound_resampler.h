@@ -0,0 +1,93 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanSound_Audio_Mixing clanSound Audio Mixing
+	/// \{
+
+	class SoundResampler_Impl;
+
+	/// \brief Interpolation used when converting a sound to the mixing frequency
+	enum ResamplerQuality
+	{
+		/// \brief Repeats the previous sample. Cheapest, but aliases badly.
+		resampler_nearest,
+
+		/// \brief Linear interpolation between two samples
+		resampler_linear,
+
+		/// \brief Cubic Hermite (Catmull-Rom) interpolation over four samples
+		resampler_cubic,
+
+		/// \brief 16 tap Kaiser windowed sinc, band-limited to the lower of the two frequencies
+		resampler_sinc
+	};
+
+	/// \brief Converts float sample channels between frequencies in blocks
+	///
+	/// The input is read around a fractional position, which advances by step for each output
+	/// sample. The kernels need up to history samples before and lookahead samples after the
+	/// integer part of every position read.
+	class SoundResampler
+	{
+	public:
+		/// \brief Constructs a resampler
+		SoundResampler(ResamplerQuality quality = resampler_linear);
+
+		/// \brief Returns the interpolation quality
+		ResamplerQuality get_quality() const;
+
+		/// \brief Sets the interpolation quality
+		void set_quality(ResamplerQuality quality);
+
+		/// \brief Resamples one channel
+		///
+		/// \param input Input samples. input[int(position) - history] to input[int(position + (num_samples - 1) * step) + lookahead] must be readable.
+		/// \param position Position in input of the first output sample.
+		/// \param step Input samples to advance for each output sample (input frequency divided by output frequency).
+		/// \param output Receives num_samples samples.
+		/// \param num_samples Number of samples to produce.
+		void resample(const float *input, double position, double step, float *output, int num_samples);
+
+		/// \brief Input samples read before the integer part of a position
+		static const int history = 8;
+
+		/// \brief Input samples read after the integer part of a position
+		static const int lookahead = 9;
+
+	private:
+		std::shared_ptr<SoundResampler_Impl> impl;
+	};
+
+	/// \}
+}
@@ -34,6 +34,8 @@ namespace clan
 	/// \{
 
 	/// \brief Sound related functions implemented as SIMD using SSE
+	///
+	/// Functions with an AVX2 implementation use it when the CPU supports it.
 	class SoundSSE
 	{
 	public:
@@ -73,6 +75,9 @@ namespace clan
 		/// \brief Multiplies floats with a float
 		static void multiply_float(float *channel, int size, float volume);
 
+		/// \brief Clamps floats to the range min_value to max_value
+		static void clamp_float(float *channel, int size, float min_value, float max_value);
+
 		/// \brief Sets floats to a specific value
 		static void set_float(float *channel, int size, float value);
 
@@ -84,6 +89,15 @@ namespace clan
 
 		/// \brief Mixes many float channels into one float channel with individual volumes for each channel
 		static void mix_many_to_one(float **input, float *volume, int channels, int size, float *output);
+
+		/// \brief Mixes float channels into as many float channels with individual volumes for each channel
+		static void mix_many_to_many(float **input, int size, float **output, float *volume, int channels);
+
+		/// \brief Runs a float channel through a feedback delay line
+		///
+		/// Each sample becomes delay_line[i] * feedback + channel[i], and is written back to both buffers.
+		/// The delay line is a contiguous run of the ring buffer of a filter, so it must not wrap within size samples.
+		static void feedback_delay(float *channel, float *delay_line, int size, float feedback);
 	};
 
 	/// \}
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include "sound_resampler.h"
 
 namespace clan
 {
@@ -99,10 +100,15 @@ namespace clan
 		/// \brief Returns true if the session is playing
 		bool is_playing();
 
+		/// \brief Returns the interpolation used to convert the session to the mixing frequency
+		ResamplerQuality get_resampler_quality() const;
+
 		/// \brief Sets the session position to 'new_pos'.
 		///
+		/// The mixer thread applies the new position before it mixes its next fragment.
+		///
 		/// \param new_pos = The new position of the session.
-		/// \return Returns true if operation completed succesfully.
+		/// \return Returns false if the position is outside the sound.
 		bool set_position(int new_pos);
 
 		/// \brief Sets the relative position of the session.
@@ -117,9 +123,11 @@ namespace clan
 
 		/// \brief Sets the end position within the current stream.
 		///
+		/// Applied by the mixer thread like set_position. Providers without end position support ignore it.
+		///
 		/// \param pos = End position.
 		///
-		/// \return True for success. False otherwise.
+		/// \return False if the position is outside the sound.
 		bool set_end_position(int pos);
 
 		/// \brief Sets the frequency of the session.
@@ -127,6 +135,12 @@ namespace clan
 		/// \param new_freq New frequency of session.
 		void set_frequency(int new_freq);
 
+		/// \brief Sets the interpolation used to convert the session to the mixing frequency
+		///
+		/// The default is resampler_linear. resampler_sinc avoids aliasing for pitch shifted
+		/// sounds and sounds recorded at a lower frequency than the mixer, at a higher CPU cost.
+		void set_resampler_quality(ResamplerQuality quality);
+
 		/// \brief Sets the volume of the session in a relative measure (0->1)
 		///
 		/// A value of 0 will effectively mute the sound (although it will
@@ -29,6 +29,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace clan
 {
@@ -40,6 +42,61 @@ namespace clan
 	class SoundOutput_Description;
 	class SoundOutput_Impl;
 
+	/// \brief Timing of the mixer thread, as returned by SoundOutput::get_mixer_statistics.
+	///
+	/// All times are in microseconds.
+	class SoundMixerStatistics
+	{
+	public:
+		/// \brief Number of fragments mixed since the statistics were reset
+		int fragments = 0;
+
+		/// \brief Size of the last fragment, in samples
+		int fragment_size = 0;
+
+		/// \brief Number of voices playing after the last fragment
+		int voices = 0;
+
+		/// \brief Total time spent mixing fragments
+		double total_mix_time = 0.0;
+
+		/// \brief Longest time spent mixing a single fragment
+		double max_mix_time = 0.0;
+
+		/// \brief Time spent mixing the voices into the mixing buffers
+		double total_fill_time = 0.0;
+
+		/// \brief Time spent in the filters and master volume of the output
+		double total_filter_time = 0.0;
+
+		/// \brief Time spent clamping the mixing buffers
+		double total_clamp_time = 0.0;
+
+		/// \brief Number of buffer underruns the device recovered from
+		int xruns = 0;
+
+		/// \brief Playing time of the device buffer, or 0 if the device does not report it
+		double device_latency = 0.0;
+
+		/// \brief Time until the last written sample is heard, measured after the last fragment
+		double device_delay = 0.0;
+
+		/// \brief Returns the average time spent mixing a fragment
+		double get_average_mix_time() const { return average(total_mix_time); }
+
+		/// \brief Returns the average time per fragment spent mixing the voices
+		double get_average_fill_time() const { return average(total_fill_time); }
+
+		/// \brief Returns the average time per fragment spent in the filters
+		double get_average_filter_time() const { return average(total_filter_time); }
+
+		/// \brief Returns the average time per fragment spent clamping
+		double get_average_clamp_time() const { return average(total_clamp_time); }
+
+	private:
+		double average(double total) const { return fragments > 0 ? total / fragments : 0.0; }
+	};
+
 	/// \brief SoundOutput interface in ClanLib.
 	///
 	///   <p>SoundOutput is the interface to a sound output device. It is used to
@@ -84,6 +141,15 @@ namespace clan
 		/// \brief Returns the main panning position of the sound output.
 		float get_global_pan() const;
 
+		/// \brief Returns the number of threads mixing voices, including the mixer thread.
+		int get_mixing_threads() const;
+
+		/// \brief Returns the timing of the mixer since the last reset.
+		SoundMixerStatistics get_mixer_statistics() const;
+
+		/// \brief Returns true if the output mixes without a sound device.
+		bool is_offline() const;
+
 		/// \brief Stops all sample playbacks on the sound output.
 		void stop_all();
 
@@ -93,6 +159,26 @@ namespace clan
 		/// \brief Sets the main panning position on the sound output.
 		void set_global_pan(float pan);
 
+		/// \brief Sets the number of threads mixing voices, including the mixer thread.
+		///
+		/// Voices are split into groups mixed in parallel once there are enough of them
+		/// to make it worthwhile. Defaults to 1, mixing everything on the mixer thread.
+		void set_mixing_threads(int num_threads);
+
+		/// \brief Clears the mixer statistics. The device latency is kept.
+		void reset_mixer_statistics();
+
+		/// \brief Mixes fragments on the calling thread.
+		///
+		/// Only available on offline outputs that are not free running.
+		/// \param num_fragments Number of fragments to mix
+		void render(int num_fragments = 1);
+
+		/// \brief Returns the interleaved stereo samples captured since the last call, and clears them.
+		///
+		/// Only available on offline outputs capturing to memory.
+		std::vector<float> take_captured_samples();
+
 		/// \brief Adds the sound filter to the sound output.
 		///
 		/// \param filter Sound filter to pass sound through.
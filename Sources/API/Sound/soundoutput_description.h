@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 namespace clan
 {
@@ -51,12 +52,63 @@ namespace clan
 		/// \brief Returns the mixing latency in milliseconds.
 		int get_mixing_latency() const;
 
+		/// \brief Returns true if the output mixes without a sound device.
+		bool is_offline() const;
+
+		/// \brief Returns true if an offline output mixes continuously on its mixer thread.
+		bool is_free_running() const;
+
+		/// \brief Returns true if an offline output keeps the mixed samples in memory.
+		bool get_capture_to_memory() const;
+
+		/// \brief Returns the WAV file an offline output writes to, or an empty string.
+		const std::string &get_capture_filename() const;
+
+		/// \brief Returns the name of the device to open, or an empty string for the default device.
+		const std::string &get_device() const;
+
+		/// \brief Returns true if the output should keep the device buffer as small as possible.
+		bool is_low_latency() const;
+
+		/// \brief Returns the SCHED_FIFO priority of the mixer thread, or 0 for normal scheduling.
+		int get_realtime_priority() const;
+
 		/// \brief Sets the mixing frequency for the sound output device.
 		void set_mixing_frequency(int frequency);
 
 		/// \brief Sets the mixing latency in milliseconds.
 		void set_mixing_latency(int latency);
 
+		/// \brief Mixes without a sound device.
+		///
+		/// An offline output mixes fragments of mixing_latency milliseconds. Unless free running,
+		/// fragments are only mixed when SoundOutput::render is called, which makes the output
+		/// deterministic. A free running output mixes as fast as possible on its mixer thread.
+		void set_offline(bool offline, bool free_running = false);
+
+		/// \brief Keeps the samples mixed by an offline output, for SoundOutput::take_captured_samples.
+		void set_capture_to_memory(bool enable);
+
+		/// \brief Writes the samples mixed by an offline output to a 16 bit stereo WAV file.
+		void set_capture_filename(const std::string &filename);
+
+		/// \brief Sets the name of the device to open.
+		///
+		/// On Linux this is an ALSA PCM name, such as "hw:0", or "null" to play without a sound card.
+		void set_device(const std::string &device);
+
+		/// \brief Keeps the device buffer as small as possible.
+		///
+		/// The ALSA output then negotiates a buffer of two periods totalling mixing_latency milliseconds,
+		/// and mixes into the device buffer with mmap transfers when the device supports them.
+		/// Otherwise the buffer is 4096 frames in four periods.
+		void set_low_latency(bool enable);
+
+		/// \brief Runs the mixer thread with SCHED_FIFO scheduling at the given priority. 0 disables it.
+		///
+		/// This requires real-time scheduling rights. The mixer keeps normal scheduling if they are missing.
+		void set_realtime_priority(int priority);
+
 	private:
 		std::shared_ptr<SoundOutput_Description_Impl> impl;
 	};
@@ -36,12 +36,33 @@ namespace clan
 {
 	class ListBoxViewImpl;
 
+	/// Supplies the items of a virtualized ListBoxView
+	class ListBoxViewDataSource
+	{
+	public:
+		virtual ~ListBoxViewDataSource() { }
+
+		/// Number of items in the list
+		virtual int item_count() = 0;
+
+		/// Creates a view for displaying items
+		///
+		/// Item views are recycled when the list scrolls. This is only called when no unused view is available.
+		virtual std::shared_ptr<View> create_item_view() = 0;
+
+		/// Updates an item view to display the specified item
+		virtual void update_item_view(const std::shared_ptr<View> &view, int index) = 0;
+	};
+
 	class ListBoxView : public ScrollView
 	{
 	public:
 		ListBoxView();
 		~ListBoxView();
 		
+		/// Sets the items of the list, one view per item
+		///
+		/// This leaves virtualized mode if a data source was set.
 		void set_items(const std::vector<std::shared_ptr<View>> &items);
 		
 		template<typename T>
@@ -56,6 +77,32 @@ namespace clan
 			set_items(views);
 		}
 		
+		/// Switches the list to virtualized mode
+		///
+		/// Views are only created for the visible items plus the overscan, and are reused for other items as the list scrolls.
+		/// Items not yet displayed are assumed to be estimated_item_height tall when calculating the scroll range.
+		void set_data_source(const std::shared_ptr<ListBoxViewDataSource> &data_source, float estimated_item_height = 20.0f);
+		const std::shared_ptr<ListBoxViewDataSource> &data_source() const;
+
+		/// Notifies a virtualized list that items were inserted into the data source
+		void items_inserted(int index, int count);
+
+		/// Notifies a virtualized list that items were removed from the data source
+		void items_removed(int index, int count);
+
+		/// Notifies a virtualized list that the content of items changed
+		void items_changed(int index, int count);
+
+		/// Notifies a virtualized list that all items changed
+		void reload_items();
+
+		/// Number of items above and below the visible area that have views in virtualized mode
+		int overscan() const;
+		void set_overscan(int items);
+
+		/// Number of item views created by a virtualized list
+		int item_view_count() const;
+
 		int selected_item() const;
 		void set_selected_item(int index);
 
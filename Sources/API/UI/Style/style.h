@@ -32,6 +32,7 @@
 #include "../../Core/Math/cl_math.h"
 #include "../../Display/2D/color.h"
 #include "style_get_value.h"
+#include "style_property_id.h"
 #include <memory>
 
 namespace clan
@@ -40,13 +41,16 @@ namespace clan
 	class StyleGetValue;
 
 	/// Style property set
+	///
+	/// The declared values are kept in an immutable property block shared by every property set with the same
+	/// values. Copying a property set only shares the block, and setting properties replaces it.
 	class Style
 	{
 	public:
 		Style();
-		Style(const Style &) = delete;
+		Style(const Style &that);
 		~Style();
-		Style &operator=(const Style &) = delete;
+		Style &operator=(const Style &that);
 
 		/// Parse and apply CSS properties to property set
 		///
@@ -54,6 +58,9 @@ namespace clan
 		/// This function does not clear the current properties already set and can be called multiple times with
 		/// individual sets of properties.
 		///
+		/// Each distinct properties string is only parsed once. Later calls with the same string reuse the parsed
+		/// declarations.
+		///
 		/// Additional arguments can be passed in and will be inserted with the same syntax as when using the
 		/// string_format function.
 		void set(const std::string &properties);
@@ -65,9 +72,20 @@ namespace clan
 		}
 
 		/// Retrieve the declared value for a property
+		StyleGetValue declared_value(const StylePropertyId &property_id) const;
 		StyleGetValue declared_value(const char *property_name) const;
 		StyleGetValue declared_value(const std::string &property_name) const { return declared_value(property_name.c_str()); }
 
+		/// Generation number of the property set
+		///
+		/// The generation changes every time properties are set. Generation numbers are unique across all property sets.
+		unsigned int generation() const;
+
+		/// Returns true if both property sets have the same declared values
+		///
+		/// Property sets with equal values share the same property block, making this a pointer comparison.
+		bool shares_properties(const Style &other) const;
+
 		/// Static helper that generates a "rgba(%1,%2,%3,%4)" string for the given color.
 		static std::string to_rgba(const Colorf &c)
 		{
@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include "style_get_value.h"
+#include "style_property_id.h"
 
 namespace clan
 {
@@ -40,26 +41,7 @@ namespace clan
 	class Canvas;
 	class Font;
 	class ViewGeometry;
-
-#if defined(MICROSOFT_FINALLY_IMPLEMENTED_CONSTEXPR_TEN_YEARS_AFTER_EVERYONE_ELSE)
-	/// Allows property name hashes to be evaluated at compile time
-	class PropertyNameConst
-	{
-	public:
-		template<std::size_t Length>
-		constexpr PropertyNameConst(const char(&text)[Length]) : text(text), length(Length - 1) { }
-
-		constexpr char operator[](std::size_t index) const { return index < length ? text[index] : throw std::out_of_range("PropertyNameConst operator[] out of bounds"); }
-		constexpr std::size_t size() const { return length; }
-		constexpr std::size_t hash() const { return hash(2166136261U, 0); }
-
-	private:
-		constexpr std::size_t hash(std::size_t value, std::size_t index) const { return index == length ? value : hash((value ^ (std::size_t)text[index]) * 16777619U, index + 1); }
-
-		const char * const text;
-		const std::size_t length;
-	};
-#endif
+	class StyleCascadeCache;
 
 	/// Style value resolver
 	class StyleCascade
@@ -67,6 +49,8 @@ namespace clan
 	public:
 		StyleCascade() { }
 		StyleCascade(std::vector<Style *> cascade, const StyleCascade *parent = nullptr) : cascade(std::move(cascade)), parent(parent) { }
+		StyleCascade(const StyleCascade &that);
+		StyleCascade &operator=(const StyleCascade &that);
 
 		/// Property sets to be examined
 		std::vector<Style *> cascade;
@@ -75,16 +59,19 @@ namespace clan
 		const StyleCascade *parent = nullptr;
 		
 		/// Find the first declared value in the cascade for the specified property
+		StyleGetValue cascade_value(const StylePropertyId &property_id) const;
 		StyleGetValue cascade_value(const char *property_name) const;
 		StyleGetValue cascade_value(const std::string &property_name) const { return cascade_value(property_name.c_str()); }
 
 		/// Resolve any inheritance or initial values for the cascade value
+		StyleGetValue specified_value(const StylePropertyId &property_id) const;
 		StyleGetValue specified_value(const char *property_name) const;
 		StyleGetValue specified_value(const std::string &property_name) const { return specified_value(property_name.c_str()); }
 
 		/// Find the computed value for the specified value
 		///
 		/// The computed value is a simplified value for the property. Lengths are resolved to device independent pixels and so on.
+		StyleGetValue computed_value(const StylePropertyId &property_id) const;
 		StyleGetValue computed_value(const char *property_name) const;
 		StyleGetValue computed_value(const std::string &property_name) const { return computed_value(property_name.c_str()); }
 		
@@ -104,6 +91,7 @@ namespace clan
 		StyleGetValue compute_resolution(const StyleGetValue &resolution) const;
 		
 		/// Value array size for the property
+		int array_size(const StylePropertyId &property_id) const;
 		int array_size(const char *property_name) const;
 		int array_size(const std::string &property_name) const { return array_size(property_name.c_str()); }
 		
@@ -115,5 +103,28 @@ namespace clan
 		
 		/// Font used by this style cascade
 		Font font(Canvas &canvas) const;
+
+		/// Enable memoization of computed values
+		///
+		/// Cached values are discarded when a style in the cascade is modified or when the parent cascade computes
+		/// different values. Values are only cached if the parent cascade, if any, also has caching enabled.
+		/// Call invalidate_cache() after modifying the cascade or parent members directly.
+		void set_cache_enabled(bool enable);
+		bool is_cache_enabled() const { return (bool)cache; }
+
+		/// Discard cached computed values
+		void invalidate_cache();
+
+		/// Version of the cached computed values
+		///
+		/// The version changes every time cached values are discarded, which makes it possible to cache results derived
+		/// from computed values. Returns 0 if values are not being cached.
+		unsigned int cache_version() const;
+
+	private:
+		StyleGetValue compute_value(const StylePropertyId &property_id) const;
+		bool validate_cache() const;
+
+		std::shared_ptr<StyleCascadeCache> cache;
 	};
 }
@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace clan
+{
+	/// Property name with a hash evaluated at compile time
+	class PropertyNameConst
+	{
+	public:
+		template<std::size_t Length>
+		constexpr PropertyNameConst(const char(&text)[Length]) : text(text), length(Length - 1) { }
+
+		constexpr char operator[](std::size_t index) const { return index < length ? text[index] : throw std::out_of_range("PropertyNameConst operator[] out of bounds"); }
+		constexpr std::size_t size() const { return length; }
+		constexpr std::size_t hash() const { return hash(2166136261U, 0); }
+		constexpr const char *c_str() const { return text; }
+
+	private:
+		constexpr std::size_t hash(std::size_t value, std::size_t index) const { return index == length ? value : hash((value ^ (std::size_t)text[index]) * 16777619U, index + 1); }
+
+		const char * const text;
+		const std::size_t length;
+	};
+
+	/// Interned style property name
+	///
+	/// Property names are registered once in a global table and given a small integer ID.
+	/// Style property sets store their values by ID, so looking up a property by ID skips hashing and comparing names.
+	/// Keep the IDs of frequently used properties in static variables:
+	///
+	/// \code
+	/// static const StylePropertyId font_size("font-size");
+	/// float size = cascade.computed_value(font_size).number();
+	/// \endcode
+	class StylePropertyId
+	{
+	public:
+		/// Null ID, not used by any property
+		StylePropertyId() { }
+
+		/// Interns a property name given as a string literal. The name is hashed at compile time.
+		template<std::size_t Length>
+		StylePropertyId(const char(&name)[Length]) : id(intern(PropertyNameConst(name)).id) { }
+
+		/// Interns a property name
+		explicit StylePropertyId(const std::string &name) : id(intern(name.c_str()).id) { }
+
+		/// Returns the ID for a property name, registering the name if it is new
+		static StylePropertyId intern(const char *name);
+		static StylePropertyId intern(const PropertyNameConst &name) { return intern(name.c_str(), name.size(), name.hash()); }
+
+		/// Returns the ID for a property name, or a null ID if the name was never registered
+		///
+		/// This never locks, so it is safe to call from any thread while other threads intern names.
+		static StylePropertyId find(const char *name);
+		static StylePropertyId find(const std::string &name) { return find(name.c_str()); }
+
+		/// Number of registered property names
+		static int count();
+
+		/// Check if this is the null ID
+		bool is_null() const { return id == 0; }
+
+		/// Index of the property name, starting at 1
+		int value() const { return id; }
+
+		/// Property name
+		const char *name() const;
+
+		bool operator==(const StylePropertyId &other) const { return id == other.id; }
+		bool operator!=(const StylePropertyId &other) const { return id != other.id; }
+		bool operator<(const StylePropertyId &other) const { return id < other.id; }
+
+	private:
+		explicit StylePropertyId(int id) : id(id) { }
+		static StylePropertyId intern(const char *name, std::size_t length, std::size_t hash);
+
+		int id = 0;
+	};
+}
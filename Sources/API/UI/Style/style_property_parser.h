@@ -37,6 +37,7 @@
 #include "style_set_image.h"
 #include "style_token.h"
 #include "style_tokenizer.h"
+#include "style_property_id.h"
 
 namespace clan
 {
@@ -115,10 +116,12 @@ namespace clan
 	{
 	public:
 		/// Gets the default value for a given property
+		static const StyleGetValue &default_value(const StylePropertyId &id);
 		static const StyleGetValue &default_value(const char *name);
 		static const StyleGetValue &default_value(const std::string &name);
 
 		/// Indicates if this an inherited property or not
+		static bool is_inherited(const StylePropertyId &id);
 		static bool is_inherited(const char *name);
 		static bool is_inherited(const std::string &name);
 
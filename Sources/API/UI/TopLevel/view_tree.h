@@ -37,6 +37,35 @@ namespace clan
 	class Canvas;
 	class ViewTreeImpl;
 
+	/// Rendering statistics and timing of the last frame, as returned by ViewTree::render_statistics
+	class ViewTreeRenderStatistics
+	{
+	public:
+		/// Milliseconds spent running functions posted to the UI thread since the previous frame
+		double task_time = 0.0;
+
+		/// Milliseconds spent computing the layout styles of the views about to be laid out
+		double style_time = 0.0;
+
+		/// Milliseconds spent laying out views
+		double layout_time = 0.0;
+
+		/// Milliseconds spent rendering views
+		double render_time = 0.0;
+
+		/// Views examined while rendering, including the ones skipped because they were outside the rendered region
+		int views_visited = 0;
+
+		/// Views that rendered their background, border and content
+		int views_rendered = 0;
+
+		/// True if the entire tree was rendered
+		bool full_render = false;
+
+		/// Region rendered, in canvas coordinates
+		Rectf render_box;
+	};
+
 	/// Base class for managing a tree of views
 	class ViewTree
 	{
@@ -80,11 +109,35 @@ namespace clan
 			return add_child<View>();
 		}
 
+		/// Marks a region of the canvas as needing to be rendered again
+		///
+		/// Views call this automatically with their bounds when set_needs_render or set_needs_layout is called.
+		void invalidate_rect(const Rectf &box);
+
+		/// Bounding box of the regions invalidated since the last frame, in canvas coordinates
+		Rectf dirty_box() const;
+
+		/// Retained rendering keeps the rendered views in a layer and only renders the invalidated regions again
+		///
+		/// Views must call set_needs_render or set_needs_layout whenever their appearance changes for this to work.
+		void set_retained_rendering(bool enable = true);
+		bool retained_rendering() const;
+
+		/// Statistics for the last rendered frame
+		const ViewTreeRenderStatistics &render_statistics() const;
+
 	protected:
 		/// Set or clears the focus
 		void set_focus_view(View *view);
 
+		/// Lays out the views that need layout
+		///
+		/// Only the subtrees below views that requested layout are visited. Called by render.
+		void layout(Canvas &canvas, const Rectf &margin_box);
+
 		/// Renders view into the specified canvas
+		///
+		/// Runs the functions posted to the UI thread and lays out the views before rendering them.
 		void render(Canvas &canvas, const Rectf &margin_box);
 
 		/// Dispatch activation change event to all views
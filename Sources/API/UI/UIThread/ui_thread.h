@@ -29,6 +29,8 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <string>
 
 namespace clan
 {
@@ -36,6 +38,16 @@ namespace clan
 	class Canvas;
 	class UIThreadImpl;
 
+	/// Priority of a function posted to the UI thread
+	enum class UITaskPriority
+	{
+		/// Runs before the next frame
+		normal,
+
+		/// Runs when the frame budget allows it, possibly several frames later
+		low
+	};
+
 	class UIThread
 	{
 	public:
@@ -50,6 +62,33 @@ namespace clan
 
 		static bool try_catch(const std::function<void()> &block);
 
+		/// Posts a function to run on the UI thread
+		///
+		/// This function is thread-safe and never blocks. Posted functions run in order at the start of the next frame,
+		/// and during message processing if a UIThread has been created.
+		static void post(std::function<void()> task, UITaskPriority priority = UITaskPriority::normal);
+
+		/// Posts a function that replaces the function posted with the same key if it has not run yet
+		///
+		/// Use this for updates where only the latest one matters, such as progress reports.
+		static void post(const std::string &key, std::function<void()> task, UITaskPriority priority = UITaskPriority::normal);
+
+		/// Runs the posted functions
+		///
+		/// Normal priority functions always run. Low priority functions run until the frame budget is spent, and the
+		/// remaining ones wait for the next call. At least one low priority function runs per call.
+		/// View trees call this at the start of every frame.
+		///
+		/// \return Time spent, in milliseconds
+		static double process_tasks();
+
+		/// Number of posted functions that have not run yet
+		static int pending_tasks();
+
+		/// Time in milliseconds spent on posted functions per frame before low priority functions are deferred
+		static double frame_budget();
+		static void set_frame_budget(double milliseconds);
+
 	private:
 		std::shared_ptr<UIThreadImpl> impl;
 	};
@@ -145,7 +145,26 @@ namespace clan
 		/// \param file = IODevice
 		void save(IODevice file);
 
+		/// \brief Save resources in the precompiled binary format.
+		/** <p>Compiled resource documents are loaded with the normal load functions. They
+			start up without parsing any XML and only create the DOM element of a resource
+			when it is requested. Elements outside the resources, such as comments between
+			them, are not kept.</p>*/
+		void save_compiled(const std::string &filename);
+
+		/// \brief Save in the precompiled binary format
+		///
+		/// \param filename = the filename to save
+		/// \param directory = Virtual Directory
+		void save_compiled(const std::string &filename, const FileSystem &file_system);
+
+		/// \brief Save in the precompiled binary format
+		///
+		/// \param file = IODevice
+		void save_compiled(IODevice file);
+
 		/// \brief Load resource XML tree from file.
+		/** <p>Both resource XML files and files saved with save_compiled are accepted.</p>*/
 		void load(const std::string &filename);
 
 		/// \brief Load
@@ -93,6 +93,7 @@ namespace clan
 		std::shared_ptr<XMLResourceNode_Impl> impl;
 
 		friend class XMLResourceDocument;
+		friend class XMLResourceDocument_Impl;
 	};
 
 	/// \}
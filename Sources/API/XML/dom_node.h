@@ -52,6 +52,7 @@ namespace clan
 	class DomNodeList;
 	class DomNamedNodeMap;
 	class DomNode_Impl;
+	class XPathExpression;
 
 	/// \brief DOM Node class.
 	///
@@ -377,6 +378,12 @@ namespace clan
 		/// \brief Returns the first node matching the specified xpath expression using this node as the context node.
 		DomNode select_node(const DomString &xpath_expression) const;
 
+		/// \brief Returns all the nodes matching the compiled xpath expression using this node as the context node.
+		std::vector<DomNode> select_nodes(const XPathExpression &xpath_expression) const;
+
+		/// \brief Returns the first node matching the compiled xpath expression using this node as the context node.
+		DomNode select_node(const XPathExpression &xpath_expression) const;
+
 		/// \brief Returns the first node value matching the specified xpath expression using this node as the context node.
 		std::string select_string(const DomString &xpath_expression) const;
 
@@ -397,6 +404,7 @@ namespace clan
 
 		friend class DomDocument;
 		friend class DomNamedNodeMap;
+		friend class XPathEvaluator_Impl;
 	};
 
 	/// \}
@@ -0,0 +1,124 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "xml_token.h"
+#include <string>
+#include <cstring>
+#include <vector>
+#include <utility>
+
+namespace clan
+{
+	/// \addtogroup clanXML_XML clanXML XML
+	/// \{
+
+	/// \brief Unowned range of characters in the buffer of a XMLStreamTokenizer.
+	///
+	/// Entities are left in place. Use decode() or to_string() to get the text with entities replaced.
+	class XMLStringView
+	{
+	public:
+		XMLStringView() : ptr(nullptr), length(0), entities(false) { }
+		XMLStringView(const char *data, size_t length, bool has_entities = false) : ptr(data), length(length), entities(has_entities) { }
+
+		/// \brief Returns the first character of the range.
+		const char *data() const { return ptr; }
+
+		/// \brief Returns the number of characters in the range.
+		size_t size() const { return length; }
+
+		/// \brief Returns true if the range is empty.
+		bool empty() const { return length == 0; }
+
+		/// \brief Returns true if the range contains entities that decode() replaces.
+		bool has_entities() const { return entities; }
+
+		/// \brief Returns the characters as they appear in the XML file.
+		std::string raw() const { return std::string(ptr, length); }
+
+		/// \brief Returns the text with entities replaced.
+		std::string to_string() const { std::string text; decode(text); return text; }
+
+		/// \brief Stores the text with entities replaced in text_out, reusing its memory.
+		void decode(std::string &text_out) const;
+
+		/// \brief Compares the raw characters with a string.
+		bool operator==(const char *text) const { return std::strlen(text) == length && std::memcmp(ptr, text, length) == 0; }
+		bool operator==(const std::string &text) const { return text.length() == length && std::memcmp(ptr, text.data(), length) == 0; }
+		bool operator!=(const char *text) const { return !(*this == text); }
+		bool operator!=(const std::string &text) const { return !(*this == text); }
+
+	private:
+		const char *ptr;
+		size_t length;
+		bool entities;
+	};
+
+	/// \brief XML token returned by XMLStreamTokenizer.
+	///
+	/// The name, value and attributes point into the tokenizer buffer and are only valid until the next token is read.
+	class XMLStreamToken
+	{
+	public:
+		XMLStreamToken() : type(XMLToken::NULL_TOKEN), variant(XMLToken::SINGLE)
+		{
+		}
+
+		// Attribute name/value pair.
+		typedef std::pair<XMLStringView, XMLStringView> Attribute;
+
+		/// \brief The token type.
+		XMLToken::TokenType type;
+
+		/// \brief The token variant.
+		XMLToken::TokenVariant variant;
+
+		/// \brief The name of the token.
+		XMLStringView name;
+
+		/// \brief The value of the token.
+		XMLStringView value;
+
+		/// \brief All the attributes attached to the token.
+		std::vector<Attribute> attributes;
+
+		/// \brief Returns true if the token has an attribute with the given name.
+		bool has_attribute(const char *name) const;
+
+		/// \brief Returns the value of an attribute, or an empty range if it is missing.
+		XMLStringView get_attribute(const char *name) const;
+
+		/// \brief Copies the token into a XMLToken, decoding all entities.
+		void to_token(XMLToken *out_token) const;
+	};
+
+	/// \}
+}
@@ -0,0 +1,82 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanXML_XML clanXML XML
+	/// \{
+
+	class IODevice;
+	class XMLStreamToken;
+	class XMLStreamTokenizer_Impl;
+
+	/// \brief Pull parser that reads a XML file in chunks.
+	///
+	/// Unlike XMLTokenizer the input is never loaded as a whole. Tokens point into a buffer that holds
+	/// the current chunk, so memory use depends on the chunk size and the largest token rather than on the file size.
+	class XMLStreamTokenizer
+	{
+	public:
+		XMLStreamTokenizer();
+
+		/// \brief Constructs a XMLStreamTokenizer
+		///
+		/// \param input = IODevice, read from its current position
+		/// \param chunk_size = Number of bytes read at a time. The buffer grows if a token does not fit.
+		XMLStreamTokenizer(IODevice &input, size_t chunk_size = 64 * 1024);
+
+		~XMLStreamTokenizer();
+
+		/// \brief Returns true if eat whitespace flag is set.
+		bool get_eat_whitespace() const;
+
+		/// \brief If enabled, will eat any whitespace between tags.
+		void set_eat_whitespace(bool enable);
+
+		/// \brief Returns the number of bytes read from the input device so far.
+		size_t get_bytes_read() const;
+
+		/// \brief Returns the line number of the start of the next token.
+		int get_line_number() const;
+
+		/// \brief Reads the next token in the input stream.
+		///
+		/// The type is XMLToken::NULL_TOKEN at the end of the input. The previous contents of out_token become invalid.
+		void next(XMLStreamToken *out_token);
+
+	private:
+		std::shared_ptr<XMLStreamTokenizer_Impl> impl;
+	};
+
+	/// \}
+}
@@ -31,6 +31,7 @@
 
 #include <memory>
 #include "xpath_object.h"
+#include "xpath_expression.h"
 
 namespace clan
 {
@@ -41,6 +42,8 @@ namespace clan
 	class XPathEvaluator_Impl;
 
 	/// \brief XPath evaluator.
+	///
+	/// Expression strings are compiled on first use and kept in a process wide cache.
 	class XPathEvaluator
 	{
 	public:
@@ -54,6 +57,17 @@ namespace clan
 		/// \return XPath Object
 		XPathObject evaluate(const std::string &expression, const DomNode &context_node) const;
 
+		/// \brief Evaluate a compiled expression
+		///
+		/// \param expression = XPath Expression
+		/// \param context_node = Dom Node
+		///
+		/// \return XPath Object
+		XPathObject evaluate(const XPathExpression &expression, const DomNode &context_node) const;
+
+		/// \brief Returns the compiled expression from the expression cache
+		XPathExpression compile(const std::string &expression) const;
+
 	private:
 		std::shared_ptr<XPathEvaluator_Impl> impl;
 	};
@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "xpath_object.h"
+
+namespace clan
+{
+	/// \addtogroup clanXML_XML clanXML XML
+	/// \{
+
+	class DomNode;
+	class XPathExpression_Impl;
+
+	/// \brief Compiled XPath expression.
+	///
+	/// The expression is parsed once when constructed and can then be evaluated
+	/// any number of times against different context nodes.
+	class XPathExpression
+	{
+	public:
+		/// \brief Constructs a null expression
+		XPathExpression();
+
+		/// \brief Compiles an expression
+		///
+		/// Throws XPathException if the expression is not valid.
+		explicit XPathExpression(const std::string &expression);
+
+		/// \brief Is Null
+		///
+		/// \return true = null
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns the expression text
+		const std::string &get_expression() const;
+
+		/// \brief Evaluate
+		///
+		/// \param context_node = Dom Node
+		///
+		/// \return XPath Object
+		XPathObject evaluate(const DomNode &context_node) const;
+
+		/// \brief Selects the nodes of a node-set expression
+		///
+		/// out_nodes is cleared first. Passing the same vector to every call reuses its memory.
+		/// Throws XPathException if the expression does not evaluate to a node-set.
+		void select_nodes(const DomNode &context_node, std::vector<DomNode> &out_nodes) const;
+
+		/// \brief Returns the first node selected by a node-set expression, or a null node
+		DomNode select_node(const DomNode &context_node) const;
+
+	private:
+		XPathExpression(const std::shared_ptr<XPathExpression_Impl> &impl);
+		void throw_if_null() const;
+
+		std::shared_ptr<XPathExpression_Impl> impl;
+
+		friend class XPathEvaluator;
+		friend class DomNode;
+	};
+
+	/// \}
+}
@@ -128,6 +128,8 @@
 #include "Core/Math/half_float.h"
 #include "Core/Math/half_float_vector.h"
 #include "Core/Math/big_int.h"
+#include "Core/Math/pcg32.h"
+#include "Core/Math/xoshiro256.h"
 #include "Core/Math/frustum_planes.h"
 #include "Core/Math/intersection_test.h"
 #include "Core/Math/aabb.h"
@@ -149,6 +151,9 @@
 #include "Core/Crypto/aes192_decrypt.h"
 #include "Core/Crypto/aes256_encrypt.h"
 #include "Core/Crypto/aes256_decrypt.h"
+#include "Core/Crypto/aes_ctr.h"
+#include "Core/Crypto/aes_gcm_encrypt.h"
+#include "Core/Crypto/aes_gcm_decrypt.h"
 #include "Core/Crypto/rsa.h"
 #include "Core/Crypto/tls_client.h"
 #include "Core/Math/size.h"
@@ -50,10 +50,13 @@
 #include "Sound/soundbuffer_session.h"
 #include "Sound/soundfilter.h"
 #include "Sound/sound_sse.h"
+#include "Sound/sound_resampler.h"
 
 #include "Sound/SoundProviders/soundprovider_wave.h"
 #include "Sound/SoundProviders/soundprovider_raw.h"
 #include "Sound/SoundProviders/soundprovider_vorbis.h"
+#include "Sound/SoundProviders/sound_stream_stats.h"
+#include "Sound/SoundProviders/sound_pcm_cache.h"
 #include "Sound/SoundProviders/soundfilter_provider.h"
 
 #include "Sound/SoundFilters/echofilter.h"
@@ -69,6 +69,7 @@
 #include "UI/Style/style_dimension.h"
 #include "UI/Style/style_get_value.h"
 #include "UI/Style/style_property_parser.h"
+#include "UI/Style/style_property_id.h"
 #include "UI/Style/style_set_image.h"
 #include "UI/Style/style_set_value.h"
 #include "UI/Style/style_token.h"
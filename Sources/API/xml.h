@@ -61,7 +61,10 @@
 #include "XML/xml_tokenizer.h"
 #include "XML/xml_writer.h"
 #include "XML/xml_token.h"
+#include "XML/xml_stream_tokenizer.h"
+#include "XML/xml_stream_token.h"
 #include "XML/xpath_evaluator.h"
+#include "XML/xpath_expression.h"
 #include "XML/xpath_object.h"
 #include "XML/Resources/resource_factory.h"
 #include "XML/Resources/xml_resource_node.h"
@@ -0,0 +1,75 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Crypto/aes_ctr.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_ctr_impl.h"
+
+namespace clan
+{
+	AES_CTR::AES_CTR()
+		: impl(std::make_shared<AES_CTR_Impl>())
+	{
+	}
+
+	DataBuffer AES_CTR::get_data() const
+	{
+		return impl->get_data();
+	}
+
+	void AES_CTR::reset()
+	{
+		impl->reset();
+	}
+
+	void AES_CTR::set_iv(const unsigned char iv[16])
+	{
+		impl->set_iv(iv);
+	}
+
+	void AES_CTR::set_key(const unsigned char *key, int key_size)
+	{
+		impl->set_key(key, key_size);
+	}
+
+	void AES_CTR::add(const void *data, int size)
+	{
+		impl->add(data, size);
+	}
+
+	void AES_CTR::add(const DataBuffer &data)
+	{
+		add(data.get_data(), data.get_size());
+	}
+
+	void AES_CTR::calculate()
+	{
+		impl->calculate();
+	}
+}
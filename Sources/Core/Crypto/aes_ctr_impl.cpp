@@ -0,0 +1,85 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "aes_ctr_impl.h"
+
+namespace clan
+{
+	AES_CTR_Impl::AES_CTR_Impl() : keystream(128), initialisation_vector_set(false)
+	{
+		reset();
+	}
+
+	DataBuffer AES_CTR_Impl::get_data() const
+	{
+		return databuffer;
+	}
+
+	void AES_CTR_Impl::reset()
+	{
+		calculated = false;
+		databuffer.set_size(0);
+	}
+
+	void AES_CTR_Impl::set_iv(const unsigned char iv[16])
+	{
+		keystream.set_counter(iv);
+		initialisation_vector_set = true;
+	}
+
+	void AES_CTR_Impl::set_key(const unsigned char *key, int key_size)
+	{
+		keystream.set_key(key, key_size);
+	}
+
+	void AES_CTR_Impl::add(const void *data, int size)
+	{
+		if (calculated)
+			reset();
+
+		if (!initialisation_vector_set)
+			throw Exception("AES-CTR initialisation vector has not been set");
+
+		if (!keystream.is_key_set())
+			throw Exception("AES-CTR cipher key has not been set");
+
+		unsigned char *dest = AES_Impl::append_data(databuffer, size);
+		keystream.process((const unsigned char *)data, dest, size);
+	}
+
+	void AES_CTR_Impl::calculate()
+	{
+		if (calculated)
+			reset();
+
+		calculated = true;
+		initialisation_vector_set = false;	// Force to reset after each call
+		keystream.clear_key();				// Force to reset after each call (to avoid keeping the cipher key in memory)
+	}
+}
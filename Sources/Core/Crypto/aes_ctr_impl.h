@@ -0,0 +1,68 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_keystream.h"
+
+namespace clan
+{
+	class AES_CTR_Impl
+	{
+	public:
+		AES_CTR_Impl();
+
+		/// \brief Get encrypted data
+		DataBuffer get_data() const;
+
+		/// \brief Resets the encryption
+		void reset();
+
+		/// \brief Sets the initial counter block
+		void set_iv(const unsigned char iv[16]);
+
+		/// \brief Sets the cipher key
+		void set_key(const unsigned char *key, int key_size);
+
+		/// \brief Adds data to be encrypted
+		void add(const void *data, int size);
+
+		/// \brief Finalize encryption
+		void calculate();
+
+	private:
+		AES_Keystream keystream;
+
+		bool initialisation_vector_set;
+		bool calculated;
+
+		DataBuffer databuffer;
+	};
+}
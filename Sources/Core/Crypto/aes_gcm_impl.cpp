@@ -0,0 +1,335 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "aes_gcm_impl.h"
+#include "aes_ni.h"
+#include "API/Core/Math/cl_math.h"
+
+#ifndef WIN32
+#include <cstring>
+#endif
+
+namespace clan
+{
+	AES_GCM_Impl::AES_GCM_Impl(bool decrypt) : keystream(32), decrypt(decrypt), use_pclmul(false), expected_tag_length(0), initialisation_vector_set(false)
+	{
+		memset(hash_subkey, 0, sizeof(hash_subkey));
+		memset(hash_powers, 0, sizeof(hash_powers));
+		memset(tag, 0, sizeof(tag));
+		memset(expected_tag, 0, sizeof(expected_tag));
+		reset();
+	}
+
+	AES_GCM_Impl::~AES_GCM_Impl()
+	{
+		memset(hash_subkey, 0, sizeof(hash_subkey));
+		memset(hash_powers, 0, sizeof(hash_powers));
+	}
+
+	DataBuffer AES_GCM_Impl::get_data() const
+	{
+		return databuffer;
+	}
+
+	void AES_GCM_Impl::reset()
+	{
+		calculated = false;
+		started = false;
+		additional_data_done = false;
+		additional_data_size = 0;
+		data_size = 0;
+		ghash_filled = 0;
+		memset(accumulator, 0, sizeof(accumulator));
+		databuffer.set_size(0);
+	}
+
+	void AES_GCM_Impl::set_iv(const unsigned char *iv, int iv_length)
+	{
+		if (iv_length <= 0)
+			throw Exception("AES-GCM initialisation vector must not be empty");
+
+		initialisation_vector.assign(iv, iv + iv_length);
+		initialisation_vector_set = true;
+	}
+
+	void AES_GCM_Impl::set_key(const unsigned char *key, int key_size)
+	{
+		keystream.set_key(key, key_size);
+
+		// The hash subkey is the encrypted zero block
+		unsigned char zero_block[block_size] = { 0 };
+		keystream.encrypt_blocks(zero_block, hash_subkey, 1);
+
+		use_pclmul = AES_NI::is_ghash_supported();
+		if (use_pclmul)
+			AES_NI::ghash_init(hash_subkey, hash_powers);
+	}
+
+	void AES_GCM_Impl::set_tag(const unsigned char *new_tag, int tag_length)
+	{
+		if (tag_length < 12 || tag_length > tag_size)
+			throw Exception("AES-GCM authentication tag must be 12 to 16 bytes");
+
+		memcpy(expected_tag, new_tag, tag_length);
+		expected_tag_length = tag_length;
+	}
+
+	void AES_GCM_Impl::add_additional_data(const void *data, int size)
+	{
+		if (calculated)
+			reset();
+
+		start();
+
+		if (additional_data_done)
+			throw Exception("AES-GCM additional data must be added before the data");
+
+		ghash_update((const unsigned char *)data, size);
+		additional_data_size += size;
+	}
+
+	void AES_GCM_Impl::add(const void *_data, int size)
+	{
+		if (calculated)
+			reset();
+
+		start();
+
+		if (!additional_data_done)
+		{
+			ghash_flush();
+			additional_data_done = true;
+		}
+
+		const unsigned char *data = (const unsigned char *)_data;
+		unsigned char *dest = AES_Impl::append_data(databuffer, size);
+
+		// Interleave the hash with the cipher in chunks small enough to stay in the L1 cache
+		const int chunk_size = 4096;
+		for (int pos = 0; pos < size; pos += chunk_size)
+		{
+			int length = min(chunk_size, size - pos);
+			if (decrypt)
+			{
+				ghash_update(data + pos, length);
+				keystream.process(data + pos, dest + pos, length);
+			}
+			else
+			{
+				keystream.process(data + pos, dest + pos, length);
+				ghash_update(dest + pos, length);
+			}
+		}
+
+		data_size += size;
+	}
+
+	void AES_GCM_Impl::calculate()
+	{
+		if (calculated)
+			reset();
+
+		start();
+
+		ghash_flush();
+		ghash_lengths(additional_data_size * 8, data_size * 8);
+
+		keystream.encrypt_blocks(pre_counter_block, tag, 1);
+		for (int cnt = 0; cnt < tag_size; cnt++)
+			tag[cnt] ^= accumulator[cnt];
+
+		calculated = true;
+		initialisation_vector_set = false;	// Force to reset after each call
+		keystream.clear_key();				// Force to reset after each call (to avoid keeping the cipher key in memory)
+		memset(hash_subkey, 0, sizeof(hash_subkey));
+		memset(hash_powers, 0, sizeof(hash_powers));
+	}
+
+	void AES_GCM_Impl::get_tag(unsigned char out_tag[tag_size]) const
+	{
+		if (!calculated)
+			throw Exception("AES-GCM authentication tag has not been calculated");
+
+		memcpy(out_tag, tag, tag_size);
+	}
+
+	bool AES_GCM_Impl::is_tag_valid() const
+	{
+		if (!calculated || expected_tag_length == 0)
+			return false;
+
+		unsigned char difference = 0;
+		for (int cnt = 0; cnt < expected_tag_length; cnt++)
+			difference |= tag[cnt] ^ expected_tag[cnt];
+		return difference == 0;
+	}
+
+	void AES_GCM_Impl::start()
+	{
+		if (started)
+			return;
+
+		if (!initialisation_vector_set)
+			throw Exception("AES-GCM initialisation vector has not been set");
+
+		if (!keystream.is_key_set())
+			throw Exception("AES-GCM cipher key has not been set");
+
+		if (initialisation_vector.size() == 12)
+		{
+			// J0 = IV || 0^31 || 1
+			memcpy(pre_counter_block, &initialisation_vector[0], 12);
+			pre_counter_block[12] = 0;
+			pre_counter_block[13] = 0;
+			pre_counter_block[14] = 0;
+			pre_counter_block[15] = 1;
+		}
+		else
+		{
+			// J0 = GHASH(IV || 0^s || 0^64 || [len(IV)]64)
+			memset(accumulator, 0, sizeof(accumulator));
+			ghash_filled = 0;
+			ghash_update(&initialisation_vector[0], (int)initialisation_vector.size());
+			ghash_flush();
+			ghash_lengths(0, initialisation_vector.size() * 8);
+			memcpy(pre_counter_block, accumulator, block_size);
+		}
+
+		unsigned char counter[block_size];
+		memcpy(counter, pre_counter_block, block_size);
+		for (int pos = block_size - 1; pos >= block_size - 4; pos--)
+		{
+			if (++counter[pos] != 0)
+				break;
+		}
+		keystream.set_counter(counter);
+
+		memset(accumulator, 0, sizeof(accumulator));
+		ghash_filled = 0;
+		started = true;
+	}
+
+	void AES_GCM_Impl::ghash_update(const unsigned char *data, int size)
+	{
+		if (ghash_filled > 0)
+		{
+			int length = min(block_size - ghash_filled, size);
+			memcpy(ghash_buffer + ghash_filled, data, length);
+			ghash_filled += length;
+			data += length;
+			size -= length;
+			if (ghash_filled < block_size)
+				return;
+			ghash_blocks(ghash_buffer, 1);
+			ghash_filled = 0;
+		}
+
+		int num_blocks = size / block_size;
+		ghash_blocks(data, num_blocks);
+		data += num_blocks * block_size;
+		size -= num_blocks * block_size;
+
+		memcpy(ghash_buffer, data, size);
+		ghash_filled = size;
+	}
+
+	void AES_GCM_Impl::ghash_flush()
+	{
+		// Zero pad the last partial block
+		if (ghash_filled > 0)
+		{
+			memset(ghash_buffer + ghash_filled, 0, block_size - ghash_filled);
+			ghash_blocks(ghash_buffer, 1);
+			ghash_filled = 0;
+		}
+	}
+
+	void AES_GCM_Impl::ghash_lengths(uint64_t first_length, uint64_t second_length)
+	{
+		unsigned char lengths[block_size];
+		for (int cnt = 0; cnt < 8; cnt++)
+		{
+			lengths[cnt] = (unsigned char)(first_length >> (56 - cnt * 8));
+			lengths[cnt + 8] = (unsigned char)(second_length >> (56 - cnt * 8));
+		}
+		ghash_blocks(lengths, 1);
+	}
+
+	void AES_GCM_Impl::ghash_blocks(const unsigned char *data, int num_blocks)
+	{
+		if (num_blocks <= 0)
+			return;
+
+		if (use_pclmul)
+		{
+			AES_NI::ghash(hash_powers, accumulator, data, num_blocks);
+			return;
+		}
+
+		for (int block = 0; block < num_blocks; block++, data += block_size)
+		{
+			for (int cnt = 0; cnt < block_size; cnt++)
+				accumulator[cnt] ^= data[cnt];
+			gf_multiply(accumulator);
+		}
+	}
+
+	void AES_GCM_Impl::gf_multiply(unsigned char value[block_size]) const
+	{
+		// Multiplication in GF(2^128) by the hash subkey (NIST SP 800-38D, algorithm 1).
+		// Uses masks instead of branches and table lookups, so the timing does not depend on the data.
+		uint64_t x_high = 0, x_low = 0, v_high = 0, v_low = 0;
+		for (int cnt = 0; cnt < 8; cnt++)
+		{
+			x_high = (x_high << 8) | value[cnt];
+			x_low = (x_low << 8) | value[cnt + 8];
+			v_high = (v_high << 8) | hash_subkey[cnt];
+			v_low = (v_low << 8) | hash_subkey[cnt + 8];
+		}
+
+		uint64_t z_high = 0, z_low = 0;
+		for (int bit = 0; bit < 128; bit++)
+		{
+			uint64_t x_bit = (bit < 64) ? (x_high >> (63 - bit)) : (x_low >> (127 - bit));
+			uint64_t mask = 0 - (x_bit & 1);
+			z_high ^= v_high & mask;
+			z_low ^= v_low & mask;
+
+			uint64_t reduce_mask = 0 - (v_low & 1);
+			v_low = (v_low >> 1) | (v_high << 63);
+			v_high = (v_high >> 1) ^ (0xe100000000000000ULL & reduce_mask);
+		}
+
+		for (int cnt = 0; cnt < 8; cnt++)
+		{
+			value[cnt] = (unsigned char)(z_high >> (56 - cnt * 8));
+			value[cnt + 8] = (unsigned char)(z_low >> (56 - cnt * 8));
+		}
+	}
+}
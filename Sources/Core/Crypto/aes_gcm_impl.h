@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_keystream.h"
+#include <vector>
+
+namespace clan
+{
+	class AES_GCM_Impl
+	{
+	public:
+		AES_GCM_Impl(bool decrypt);
+		~AES_GCM_Impl();
+
+		static const int block_size = 16;
+		static const int tag_size = 16;
+
+		/// \brief Get encrypted or decrypted data
+		DataBuffer get_data() const;
+
+		/// \brief Resets the encryption
+		void reset();
+
+		/// \brief Sets the initialisation vector
+		void set_iv(const unsigned char *iv, int iv_length);
+
+		/// \brief Sets the cipher key
+		void set_key(const unsigned char *key, int key_size);
+
+		/// \brief Adds data that is authenticated, but not encrypted
+		void add_additional_data(const void *data, int size);
+
+		/// \brief Adds data to be encrypted or decrypted
+		void add(const void *data, int size);
+
+		/// \brief Finalize and calculate the authentication tag
+		void calculate();
+
+		/// \brief Get the calculated authentication tag
+		void get_tag(unsigned char out_tag[tag_size]) const;
+
+		/// \brief Sets the expected authentication tag
+		void set_tag(const unsigned char *tag, int tag_length);
+
+		/// \brief Compares the calculated tag with the expected tag, in constant time
+		bool is_tag_valid() const;
+
+	private:
+		void start();
+		void ghash_update(const unsigned char *data, int size);
+		void ghash_flush();
+		void ghash_lengths(uint64_t first_length, uint64_t second_length);
+		void ghash_blocks(const unsigned char *data, int num_blocks);
+		void gf_multiply(unsigned char value[block_size]) const;
+
+		AES_Keystream keystream;
+		bool decrypt;
+		bool use_pclmul;
+
+		unsigned char hash_subkey[block_size];
+		unsigned char hash_powers[block_size * 4];
+		unsigned char pre_counter_block[block_size];
+		unsigned char accumulator[block_size];
+		unsigned char ghash_buffer[block_size];
+		int ghash_filled;
+
+		std::vector<unsigned char> initialisation_vector;
+		uint64_t additional_data_size;
+		uint64_t data_size;
+
+		unsigned char tag[tag_size];
+		unsigned char expected_tag[tag_size];
+		int expected_tag_length;
+
+		bool initialisation_vector_set;
+		bool started;
+		bool additional_data_done;
+		bool calculated;
+
+		DataBuffer databuffer;
+	};
+}
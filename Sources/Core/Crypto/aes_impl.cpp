@@ -162,17 +162,7 @@ namespace clan
 	{
 		// (Note AES 128, 192 and 256 all have the same block size)
 
-		// Store the data
-		int current_size = databuffer.get_size();
-		int current_capacity = databuffer.get_capacity();
-		int available = current_capacity - current_size;
-		if (available < aes128_block_size_bytes)	// Increase capacity required
-		{
-			databuffer.set_capacity(current_capacity + 1024);	// Increase in blocks of 1K
-		}
-		databuffer.set_size(current_size + aes128_block_size_bytes);
-		unsigned char *dest_ptr = (unsigned char *)databuffer.get_data();
-		dest_ptr += current_size;
+		unsigned char *dest_ptr = append_data(databuffer, aes128_block_size_bytes);
 
 		put_word(s0, dest_ptr);
 		put_word(s1, dest_ptr + 4);
@@ -180,6 +170,55 @@ namespace clan
 		put_word(s3, dest_ptr + 12);
 	}
 
+	unsigned char *AES_Impl::append_data(DataBuffer &databuffer, int size)
+	{
+		int current_size = databuffer.get_size();
+		int current_capacity = databuffer.get_capacity();
+		if (current_capacity - current_size < size)
+			databuffer.set_capacity(max(current_size + size, current_capacity * 2));	// Grow geometrically, to keep streaming linear
+		databuffer.set_size(current_size + size);
+		return (unsigned char *)databuffer.get_data() + current_size;
+	}
+
+	void AES_Impl::encrypt_blocks(const uint32_t *key_expanded, int num_rounds, const unsigned char *input, unsigned char *output, int num_blocks) const
+	{
+		for (int block = 0; block < num_blocks; block++, input += aes128_block_size_bytes, output += aes128_block_size_bytes)
+		{
+			const uint32_t *key_expanded_ptr = key_expanded;
+
+			uint32_t s0 = get_word(input) ^ key_expanded_ptr[0];
+			uint32_t s1 = get_word(input + 4) ^ key_expanded_ptr[1];
+			uint32_t s2 = get_word(input + 8) ^ key_expanded_ptr[2];
+			uint32_t s3 = get_word(input + 12) ^ key_expanded_ptr[3];
+
+			for (int round = 1; round < num_rounds; round++)
+			{
+				key_expanded_ptr += 4;
+				uint32_t t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[0];
+				uint32_t t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[1];
+				uint32_t t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[2];
+				uint32_t t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[3];
+				s0 = t0;
+				s1 = t1;
+				s2 = t2;
+				s3 = t3;
+			}
+
+			key_expanded_ptr += 4;
+
+			// Apply last round
+			uint32_t t0 = (sbox_substitution_values[(s0 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s3)& 0xff] & 0x000000ff) ^ key_expanded_ptr[0];
+			uint32_t t1 = (sbox_substitution_values[(s1 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s0)& 0xff] & 0x000000ff) ^ key_expanded_ptr[1];
+			uint32_t t2 = (sbox_substitution_values[(s2 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s1)& 0xff] & 0x000000ff) ^ key_expanded_ptr[2];
+			uint32_t t3 = (sbox_substitution_values[(s3 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s2)& 0xff] & 0x000000ff) ^ key_expanded_ptr[3];
+
+			put_word(t0, output);
+			put_word(t1, output + 4);
+			put_word(t2, output + 8);
+			put_word(t3, output + 12);
+		}
+	}
+
 	void AES_Impl::extract_decrypt_key(uint32_t *key_expanded, int num_rounds)
 	{
 		// Invert the order of the round keys
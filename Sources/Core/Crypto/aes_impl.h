@@ -30,6 +30,8 @@
 
 namespace clan
 {
+	class DataBuffer;
+
 	class AES_Impl
 	{
 	public:
@@ -77,6 +79,12 @@ namespace clan
 		void extract_decrypt_key(uint32_t *key_expanded, int num_rounds);
 		void store_block(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3, DataBuffer &databuffer);
 
+		/// \brief Grows the databuffer by size bytes, returning a pointer to the new space
+		static unsigned char *append_data(DataBuffer &databuffer, int size);
+
+		/// \brief Encrypt blocks in Electronic Codebook Mode using the lookup tables
+		void encrypt_blocks(const uint32_t *key_expanded, int num_rounds, const unsigned char *input, unsigned char *output, int num_blocks) const;
+
 		inline uint32_t get_word(const unsigned char *data) const
 		{
 			return ((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | (data[3]));
@@ -0,0 +1,153 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "aes_keystream.h"
+#include "aes_ni.h"
+#include "API/Core/Math/cl_math.h"
+
+#ifndef WIN32
+#include <cstring>
+#endif
+
+namespace clan
+{
+	AES_Keystream::AES_Keystream(int counter_bits) : counter_bits(counter_bits), num_rounds(0), cipher_key_set(false), use_aes_ni(false), keystream_pos(0), keystream_size(0)
+	{
+		memset(counter, 0, sizeof(counter));
+	}
+
+	AES_Keystream::~AES_Keystream()
+	{
+		clear_key();
+	}
+
+	void AES_Keystream::set_key(const unsigned char *key, int key_size)
+	{
+		switch (key_size)
+		{
+		case aes128_key_length_bytes:
+			extract_encrypt_key128(key, key_expanded);
+			num_rounds = aes128_num_rounds_nr;
+			break;
+		case aes192_key_length_bytes:
+			extract_encrypt_key192(key, key_expanded);
+			num_rounds = aes192_num_rounds_nr;
+			break;
+		case aes256_key_length_bytes:
+			extract_encrypt_key256(key, key_expanded);
+			num_rounds = aes256_num_rounds_nr;
+			break;
+		default:
+			throw Exception("AES cipher key must be 16, 24 or 32 bytes");
+		}
+
+		// AES-NI expects the round keys in byte order
+		for (int cnt = 0; cnt < (num_rounds + 1) * 4; cnt++)
+			put_word(key_expanded[cnt], round_keys + cnt * 4);
+
+		use_aes_ni = AES_NI::is_supported();
+		cipher_key_set = true;
+		keystream_pos = keystream_size = 0;
+	}
+
+	void AES_Keystream::set_counter(const unsigned char new_counter[16])
+	{
+		memcpy(counter, new_counter, sizeof(counter));
+		keystream_pos = keystream_size = 0;
+	}
+
+	void AES_Keystream::clear_key()
+	{
+		cipher_key_set = false;
+		memset(key_expanded, 0, sizeof(key_expanded));
+		memset(round_keys, 0, sizeof(round_keys));
+		memset(keystream, 0, sizeof(keystream));
+		keystream_pos = keystream_size = 0;
+	}
+
+	void AES_Keystream::encrypt_blocks(const unsigned char *input, unsigned char *output, int num_blocks) const
+	{
+		if (use_aes_ni)
+			AES_NI::encrypt_blocks(round_keys, num_rounds, input, output, num_blocks);
+		else
+			AES_Impl::encrypt_blocks(key_expanded, num_rounds, input, output, num_blocks);
+	}
+
+	void AES_Keystream::process(const unsigned char *input, unsigned char *output, int size)
+	{
+		while (size > 0)
+		{
+			if (keystream_pos == keystream_size)
+				generate(min(batch_blocks, (size + aes128_block_size_bytes - 1) / aes128_block_size_bytes));
+
+			int length = min(size, keystream_size - keystream_pos);
+			const unsigned char *key = keystream + keystream_pos;
+
+			int pos = 0;
+			for (; pos + 8 <= length; pos += 8)
+			{
+				uint64_t data_value, key_value;
+				memcpy(&data_value, input + pos, 8);
+				memcpy(&key_value, key + pos, 8);
+				data_value ^= key_value;
+				memcpy(output + pos, &data_value, 8);
+			}
+			for (; pos < length; pos++)
+				output[pos] = input[pos] ^ key[pos];
+
+			keystream_pos += length;
+			input += length;
+			output += length;
+			size -= length;
+		}
+	}
+
+	void AES_Keystream::generate(int num_blocks)
+	{
+		for (int block = 0; block < num_blocks; block++)
+		{
+			memcpy(counter_blocks + block * aes128_block_size_bytes, counter, aes128_block_size_bytes);
+			increment_counter();
+		}
+
+		encrypt_blocks(counter_blocks, keystream, num_blocks);
+		keystream_pos = 0;
+		keystream_size = num_blocks * aes128_block_size_bytes;
+	}
+
+	void AES_Keystream::increment_counter()
+	{
+		int last_byte = aes128_block_size_bytes - counter_bits / 8;
+		for (int pos = aes128_block_size_bytes - 1; pos >= last_byte; pos--)
+		{
+			if (++counter[pos] != 0)
+				break;
+		}
+	}
+}
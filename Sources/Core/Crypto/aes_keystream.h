@@ -0,0 +1,86 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "aes_impl.h"
+
+namespace clan
+{
+	/// \brief AES counter mode key stream, shared by the CTR and GCM modes
+	///
+	/// Counter blocks are encrypted several at a time, using AES-NI when the CPU supports it.
+	class AES_Keystream : public AES_Impl
+	{
+	public:
+		/// \brief Constructs a key stream
+		///
+		/// \param counter_bits = Number of (big endian) low bits incremented per block. 128 for CTR, 32 for GCM
+		AES_Keystream(int counter_bits);
+		~AES_Keystream();
+
+		static const int batch_blocks = 64;
+
+		/// \brief Sets the cipher key (16, 24 or 32 bytes)
+		void set_key(const unsigned char *key, int key_size);
+
+		/// \brief Sets the next counter block
+		void set_counter(const unsigned char counter[16]);
+
+		/// \brief Removes the key from memory
+		void clear_key();
+
+		bool is_key_set() const { return cipher_key_set; }
+
+		/// \brief Encrypt single blocks with the cipher key (Electronic Codebook Mode)
+		void encrypt_blocks(const unsigned char *input, unsigned char *output, int num_blocks) const;
+
+		/// \brief Xor the data with the key stream
+		///
+		/// Input and output may point to the same memory
+		void process(const unsigned char *input, unsigned char *output, int size);
+
+	private:
+		void generate(int num_blocks);
+		void increment_counter();
+
+		int counter_bits;
+		int num_rounds;
+		bool cipher_key_set;
+		bool use_aes_ni;
+
+		uint32_t key_expanded[aes256_nb_mult_nr_plus1];
+		unsigned char round_keys[aes256_nb_mult_nr_plus1 * 4];
+
+		unsigned char counter[aes128_block_size_bytes];
+		unsigned char counter_blocks[aes128_block_size_bytes * batch_blocks];
+		unsigned char keystream[aes128_block_size_bytes * batch_blocks];
+		int keystream_pos;
+		int keystream_size;
+	};
+}
@@ -0,0 +1,258 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/system.h"
+#include "aes_ni.h"
+
+#ifdef CL_AES_NI_AVAILABLE
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+// Allow the intrinsics in these functions without enabling the instruction sets for the whole build
+#if defined(__GNUC__)
+#define CL_AES_NI_TARGET __attribute__((target("aes,pclmul,ssse3")))
+#else
+#define CL_AES_NI_TARGET
+#endif
+#endif
+
+namespace clan
+{
+	bool AES_NI::is_supported()
+	{
+#ifdef CL_AES_NI_AVAILABLE
+		static bool supported = System::detect_cpu_extension(System::aes) && System::detect_cpu_extension(System::ssse3);
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	bool AES_NI::is_ghash_supported()
+	{
+#ifdef CL_AES_NI_AVAILABLE
+		static bool supported = is_supported() && System::detect_cpu_extension(System::pclmul);
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+#ifdef CL_AES_NI_AVAILABLE
+
+	static inline CL_AES_NI_TARGET __m128i byte_swap(__m128i value)
+	{
+		return _mm_shuffle_epi8(value, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	}
+
+	// 256 bit carry-less product of two byte swapped GHASH blocks, without reduction
+	static inline CL_AES_NI_TARGET void clmul(__m128i a, __m128i b, __m128i &low, __m128i &high)
+	{
+		__m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+		__m128i t1 = _mm_clmulepi64_si128(a, b, 0x10);
+		__m128i t2 = _mm_clmulepi64_si128(a, b, 0x01);
+		__m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+		t1 = _mm_xor_si128(t1, t2);
+		low = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+		high = _mm_xor_si128(t3, _mm_srli_si128(t1, 8));
+	}
+
+	// Reduce a 256 bit product modulo the GCM polynomial (Intel carry-less multiplication white paper, algorithm 5).
+	// The reduction is linear, so several products may be xor'ed together before reducing them once.
+	static inline CL_AES_NI_TARGET __m128i reduce(__m128i low, __m128i high)
+	{
+		// Shift the product left by one bit, as the operands are bit reflected
+		__m128i carry_low = _mm_srli_epi32(low, 31);
+		__m128i carry_high = _mm_srli_epi32(high, 31);
+		low = _mm_slli_epi32(low, 1);
+		high = _mm_slli_epi32(high, 1);
+		__m128i carry_middle = _mm_srli_si128(carry_low, 12);
+		carry_high = _mm_slli_si128(carry_high, 4);
+		carry_low = _mm_slli_si128(carry_low, 4);
+		low = _mm_or_si128(low, carry_low);
+		high = _mm_or_si128(high, carry_high);
+		high = _mm_or_si128(high, carry_middle);
+
+		// First phase of the reduction
+		__m128i a = _mm_slli_epi32(low, 31);
+		__m128i b = _mm_slli_epi32(low, 30);
+		__m128i c = _mm_slli_epi32(low, 25);
+		a = _mm_xor_si128(a, b);
+		a = _mm_xor_si128(a, c);
+		b = _mm_srli_si128(a, 4);
+		a = _mm_slli_si128(a, 12);
+		low = _mm_xor_si128(low, a);
+
+		// Second phase of the reduction
+		__m128i d = _mm_srli_epi32(low, 1);
+		__m128i e = _mm_srli_epi32(low, 2);
+		__m128i f = _mm_srli_epi32(low, 7);
+		d = _mm_xor_si128(d, e);
+		d = _mm_xor_si128(d, f);
+		d = _mm_xor_si128(d, b);
+		low = _mm_xor_si128(low, d);
+		return _mm_xor_si128(high, low);
+	}
+
+	static inline CL_AES_NI_TARGET __m128i gfmul(__m128i a, __m128i b)
+	{
+		__m128i low, high;
+		clmul(a, b, low, high);
+		return reduce(low, high);
+	}
+
+	CL_AES_NI_TARGET void AES_NI::encrypt_blocks(const unsigned char *round_keys, int num_rounds, const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		__m128i keys[15];
+		for (int round = 0; round <= num_rounds; round++)
+			keys[round] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(round_keys + round * 16));
+
+		const __m128i *src = reinterpret_cast<const __m128i*>(input);
+		__m128i *dest = reinterpret_cast<__m128i*>(output);
+
+		// Eight independent blocks keep the AES unit pipeline busy
+		int block = 0;
+		for (; block + 8 <= num_blocks; block += 8)
+		{
+			__m128i b0 = _mm_xor_si128(_mm_loadu_si128(src + block + 0), keys[0]);
+			__m128i b1 = _mm_xor_si128(_mm_loadu_si128(src + block + 1), keys[0]);
+			__m128i b2 = _mm_xor_si128(_mm_loadu_si128(src + block + 2), keys[0]);
+			__m128i b3 = _mm_xor_si128(_mm_loadu_si128(src + block + 3), keys[0]);
+			__m128i b4 = _mm_xor_si128(_mm_loadu_si128(src + block + 4), keys[0]);
+			__m128i b5 = _mm_xor_si128(_mm_loadu_si128(src + block + 5), keys[0]);
+			__m128i b6 = _mm_xor_si128(_mm_loadu_si128(src + block + 6), keys[0]);
+			__m128i b7 = _mm_xor_si128(_mm_loadu_si128(src + block + 7), keys[0]);
+
+			for (int round = 1; round < num_rounds; round++)
+			{
+				__m128i key = keys[round];
+				b0 = _mm_aesenc_si128(b0, key);
+				b1 = _mm_aesenc_si128(b1, key);
+				b2 = _mm_aesenc_si128(b2, key);
+				b3 = _mm_aesenc_si128(b3, key);
+				b4 = _mm_aesenc_si128(b4, key);
+				b5 = _mm_aesenc_si128(b5, key);
+				b6 = _mm_aesenc_si128(b6, key);
+				b7 = _mm_aesenc_si128(b7, key);
+			}
+
+			__m128i key = keys[num_rounds];
+			_mm_storeu_si128(dest + block + 0, _mm_aesenclast_si128(b0, key));
+			_mm_storeu_si128(dest + block + 1, _mm_aesenclast_si128(b1, key));
+			_mm_storeu_si128(dest + block + 2, _mm_aesenclast_si128(b2, key));
+			_mm_storeu_si128(dest + block + 3, _mm_aesenclast_si128(b3, key));
+			_mm_storeu_si128(dest + block + 4, _mm_aesenclast_si128(b4, key));
+			_mm_storeu_si128(dest + block + 5, _mm_aesenclast_si128(b5, key));
+			_mm_storeu_si128(dest + block + 6, _mm_aesenclast_si128(b6, key));
+			_mm_storeu_si128(dest + block + 7, _mm_aesenclast_si128(b7, key));
+		}
+
+		for (; block < num_blocks; block++)
+		{
+			__m128i b0 = _mm_xor_si128(_mm_loadu_si128(src + block), keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+				b0 = _mm_aesenc_si128(b0, keys[round]);
+			_mm_storeu_si128(dest + block, _mm_aesenclast_si128(b0, keys[num_rounds]));
+		}
+	}
+
+	CL_AES_NI_TARGET void AES_NI::ghash_init(const unsigned char hash_subkey[16], unsigned char hash_powers[64])
+	{
+		__m128i h1 = byte_swap(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hash_subkey)));
+		__m128i h2 = gfmul(h1, h1);
+		__m128i h3 = gfmul(h2, h1);
+		__m128i h4 = gfmul(h3, h1);
+
+		__m128i *dest = reinterpret_cast<__m128i*>(hash_powers);
+		_mm_storeu_si128(dest + 0, h1);
+		_mm_storeu_si128(dest + 1, h2);
+		_mm_storeu_si128(dest + 2, h3);
+		_mm_storeu_si128(dest + 3, h4);
+	}
+
+	CL_AES_NI_TARGET void AES_NI::ghash(const unsigned char hash_powers[64], unsigned char accumulator[16], const unsigned char *data, int num_blocks)
+	{
+		const __m128i *powers = reinterpret_cast<const __m128i*>(hash_powers);
+		__m128i h1 = _mm_loadu_si128(powers + 0);
+		__m128i h2 = _mm_loadu_si128(powers + 1);
+		__m128i h3 = _mm_loadu_si128(powers + 2);
+		__m128i h4 = _mm_loadu_si128(powers + 3);
+
+		__m128i y = byte_swap(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator)));
+		const __m128i *src = reinterpret_cast<const __m128i*>(data);
+
+		// Y = (Y + X0) * H^4 + X1 * H^3 + X2 * H^2 + X3 * H, with a single reduction
+		int block = 0;
+		for (; block + 4 <= num_blocks; block += 4)
+		{
+			__m128i x0 = _mm_xor_si128(y, byte_swap(_mm_loadu_si128(src + block + 0)));
+			__m128i x1 = byte_swap(_mm_loadu_si128(src + block + 1));
+			__m128i x2 = byte_swap(_mm_loadu_si128(src + block + 2));
+			__m128i x3 = byte_swap(_mm_loadu_si128(src + block + 3));
+
+			__m128i low, high, product_low, product_high;
+			clmul(x0, h4, low, high);
+			clmul(x1, h3, product_low, product_high);
+			low = _mm_xor_si128(low, product_low);
+			high = _mm_xor_si128(high, product_high);
+			clmul(x2, h2, product_low, product_high);
+			low = _mm_xor_si128(low, product_low);
+			high = _mm_xor_si128(high, product_high);
+			clmul(x3, h1, product_low, product_high);
+			low = _mm_xor_si128(low, product_low);
+			high = _mm_xor_si128(high, product_high);
+			y = reduce(low, high);
+		}
+
+		for (; block < num_blocks; block++)
+			y = gfmul(_mm_xor_si128(y, byte_swap(_mm_loadu_si128(src + block))), h1);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator), byte_swap(y));
+	}
+
+#else
+
+	void AES_NI::encrypt_blocks(const unsigned char *round_keys, int num_rounds, const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		throw Exception("AES-NI is not available on this platform");
+	}
+
+	void AES_NI::ghash_init(const unsigned char hash_subkey[16], unsigned char hash_powers[64])
+	{
+		throw Exception("PCLMULQDQ is not available on this platform");
+	}
+
+	void AES_NI::ghash(const unsigned char hash_powers[64], unsigned char accumulator[16], const unsigned char *data, int num_blocks)
+	{
+		throw Exception("PCLMULQDQ is not available on this platform");
+	}
+
+#endif
+}
@@ -0,0 +1,64 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#if !defined(CL_DISABLE_SSE2) && !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_AES_NI_AVAILABLE
+#endif
+
+namespace clan
+{
+	/// \brief AES-NI and PCLMULQDQ accelerated AES kernels
+	///
+	/// The kernels are compiled for these instruction sets regardless of the compiler flags,
+	/// so callers must check is_supported() or is_ghash_supported() at runtime before using them.
+	class AES_NI
+	{
+	public:
+		/// \brief Returns true if the CPU supports the AES-NI block cipher kernels
+		static bool is_supported();
+
+		/// \brief Returns true if the CPU supports the PCLMULQDQ GHASH kernels
+		static bool is_ghash_supported();
+
+		/// \brief Encrypt blocks in Electronic Codebook Mode
+		///
+		/// \param round_keys = Expanded key, (num_rounds + 1) * 16 bytes
+		static void encrypt_blocks(const unsigned char *round_keys, int num_rounds, const unsigned char *input, unsigned char *output, int num_blocks);
+
+		/// \brief Calculate the powers of the hash subkey used by ghash()
+		///
+		/// \param hash_subkey = The GCM hash subkey H
+		/// \param hash_powers = Destination, 64 bytes (H, H^2, H^3 and H^4 in the kernel representation)
+		static void ghash_init(const unsigned char hash_subkey[16], unsigned char hash_powers[64]);
+
+		/// \brief Multiply the data blocks into the GHASH accumulator
+		static void ghash(const unsigned char hash_powers[64], unsigned char accumulator[16], const unsigned char *data, int num_blocks);
+	};
+}
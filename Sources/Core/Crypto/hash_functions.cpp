@@ -29,7 +29,12 @@
 #include "Core/precomp.h"
 #include "API/Core/Crypto/hash_functions.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/Math/cl_math.h"
+#include "sha_multi_buffer.h"
 #include "Core/Zip/miniz.h"
+#include <thread>
+#include <vector>
 
 namespace clan
 {
@@ -340,4 +345,66 @@ namespace clan
 	{
 		sha512_256(data.data(), data.length(), out_hash);
 	}
+
+	void HashFunctions::sha1_multi_buffer(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes)
+	{
+		SHA_MultiBuffer::sha1(num_messages, data, sizes, out_hashes);
+	}
+
+	void HashFunctions::sha256_multi_buffer(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes)
+	{
+		SHA_MultiBuffer::sha256(num_messages, data, sizes, out_hashes);
+	}
+
+	std::string HashFunctions::sha256_tree(const void *data, int size, bool uppercase, int leaf_size)
+	{
+		unsigned char hash[SHA256::hash_size];
+		sha256_tree(data, size, hash, leaf_size);
+
+		const char *digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+		std::string digest;
+		for (auto value : hash)
+		{
+			digest.push_back(digits[value >> 4]);
+			digest.push_back(digits[value & 0x0f]);
+		}
+		return digest;
+	}
+
+	void HashFunctions::sha256_tree(const void *data, int size, unsigned char out_hash[32], int leaf_size)
+	{
+		if (leaf_size <= 0)
+			throw Exception("SHA-256 tree hash leaf size must be positive");
+
+		std::vector<unsigned char> hashes(SHA_MultiBuffer::get_num_tree_leaves(size, leaf_size) * SHA256::hash_size);
+		SHA_MultiBuffer::sha256_tree_leaves((const unsigned char *)data, size, leaf_size, &hashes[0]);
+		SHA_MultiBuffer::sha256_tree_root(&hashes[0], hashes.size() / SHA256::hash_size, out_hash);
+	}
+
+	void HashFunctions::sha256_tree(IODevice &device, unsigned char out_hash[32], int leaf_size)
+	{
+		if (leaf_size <= 0)
+			throw Exception("SHA-256 tree hash leaf size must be positive");
+
+		// Read enough leaves at a time to keep every core and SIMD lane busy
+		const int max_batch_size = 64 * 1024 * 1024;
+		int batch_leaves = max(1, min(max(1, (int)std::thread::hardware_concurrency()) * 8, max_batch_size / leaf_size));
+
+		DataBuffer batch(batch_leaves * leaf_size);
+		std::vector<unsigned char> hashes;
+		while (true)
+		{
+			int size = device.read(batch.get_data(), batch.get_size());
+			if (size > 0 || hashes.empty())
+			{
+				size_t offset = hashes.size();
+				hashes.resize(offset + SHA_MultiBuffer::get_num_tree_leaves(size, leaf_size) * SHA256::hash_size);
+				SHA_MultiBuffer::sha256_tree_leaves((const unsigned char *)batch.get_data(), size, leaf_size, &hashes[offset]);
+			}
+			if (size < (int)batch.get_size())
+				break;
+		}
+
+		SHA_MultiBuffer::sha256_tree_root(&hashes[0], hashes.size() / SHA256::hash_size, out_hash);
+	}
 }
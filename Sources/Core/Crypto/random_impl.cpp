@@ -30,28 +30,111 @@
 #include "random_impl.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/IOData/file.h"
+#include <thread>
+#include <condition_variable>
+#include <vector>
 
 #ifndef WIN32
 #include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/syscall.h>
 #endif
 
 namespace clan
 {
-	Random_Impl::Random_Impl(int cache_size) : random_pool_size(cache_size), random_pool_free(0), random_pool(nullptr), random_bool_bits_free(0)
+	namespace
+	{
+		/// \brief Background thread shared by all Random objects, refilling their back pools
+		class RandomRefillThread
+		{
+		public:
+			static RandomRefillThread &instance()
+			{
+				static RandomRefillThread refill_thread;
+				return refill_thread;
+			}
+
+			~RandomRefillThread()
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				stop_flag = true;
+				mutex_lock.unlock();
+				worker_event.notify_all();
+
+				if (thread.joinable())
+					thread.join();
+			}
+
+			void queue(std::shared_ptr<Random_Impl> random)
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				if (!thread.joinable())
+					thread = std::thread(&RandomRefillThread::worker_main, this);
+				queued.push_back(random);
+				mutex_lock.unlock();
+				worker_event.notify_one();
+			}
+
+		private:
+			void worker_main()
+			{
+				while (true)
+				{
+					std::unique_lock<std::mutex> mutex_lock(mutex);
+					worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued.empty(); });
+
+					if (stop_flag)
+						break;
+
+					std::shared_ptr<Random_Impl> random = queued.front();
+					queued.erase(queued.begin());
+					mutex_lock.unlock();
+
+					random->refill_back_pool();
+				}
+			}
+
+			std::thread thread;
+			std::mutex mutex;
+			std::condition_variable worker_event;
+			std::vector<std::shared_ptr<Random_Impl>> queued;
+			bool stop_flag = false;
+		};
+	}
+
+	Random_Impl::Random_Impl(int cache_size) : random_pool_size(cache_size), random_pool_free(0), random_pool(nullptr), back_pool(nullptr), back_pool_ready(false), refill_pending(false), random_bool_bits_free(0)
 #ifdef WIN32
 		, hProvider(0)
 #endif
 	{
 		random_pool = new unsigned char[random_pool_size];
+		back_pool = new unsigned char[random_pool_size];
+
+#ifdef WIN32
+		// Acquired up front, as the pools are filled from two threads
+		if (!::CryptAcquireContextW(&hProvider, 0, 0, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT | CRYPT_SILENT))
+		{
+			delete[] random_pool;
+			delete[] back_pool;
+			throw Exception("Cannot acquire crypt context");
+		}
+#endif
 	}
 
 	Random_Impl::~Random_Impl()
 	{
+		// A pending refill keeps a reference, so the back pool is no longer in use here
 		if (random_pool)
 		{
 			memset(random_pool, 0, random_pool_size);
 			delete[] random_pool;
 		}
+		if (back_pool)
+		{
+			memset(back_pool, 0, random_pool_size);
+			delete[] back_pool;
+		}
 #ifdef WIN32
 		if (hProvider)
 			::CryptReleaseContext(hProvider, 0);
@@ -101,27 +184,84 @@ namespace clan
 	{
 		// Note "random_pool_free" should always by zero at this point
 
-#ifdef WIN32
-		if (!hProvider)
+		std::unique_lock<std::mutex> mutex_lock(back_pool_mutex);
+		if (back_pool_ready)
 		{
-			if (!::CryptAcquireContextW(&hProvider, 0, 0, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT | CRYPT_SILENT))
-			{
-				throw Exception("Cannot acquire crypt context");
-			}
+			std::swap(random_pool, back_pool);
+			back_pool_ready = false;
+			mutex_lock.unlock();
 		}
-		if (!::CryptGenRandom(hProvider, random_pool_size, random_pool))
+		else
+		{
+			// The background refill has not finished (or not started), read on this thread
+			mutex_lock.unlock();
+			read_os_random(random_pool, random_pool_size);
+		}
+
+		random_pool_free = random_pool_size;	// Reset it
+
+		request_refill();
+	}
+
+	void Random_Impl::request_refill()
+	{
+		std::unique_lock<std::mutex> mutex_lock(back_pool_mutex);
+		if (back_pool_ready || refill_pending)
+			return;
+		refill_pending = true;
+		mutex_lock.unlock();
+
+		RandomRefillThread::instance().queue(shared_from_this());
+	}
+
+	void Random_Impl::refill_back_pool()
+	{
+		// Only this thread touches the back pool while a refill is pending
+		bool succeeded = true;
+		try
+		{
+			read_os_random(back_pool, random_pool_size);
+		}
+		catch (...)
+		{
+			succeeded = false;	// The calling thread reads synchronously instead, and reports the error
+		}
+
+		std::unique_lock<std::mutex> mutex_lock(back_pool_mutex);
+		back_pool_ready = succeeded;
+		refill_pending = false;
+	}
+
+	void Random_Impl::read_os_random(unsigned char *out_dest_ptr, int num_bytes)
+	{
+#ifdef WIN32
+		if (!::CryptGenRandom(hProvider, num_bytes, out_dest_ptr))
 		{
 			throw Exception("Cannot generate random numbers");
 		}
 
 #else
+#if defined(__linux__) && defined(SYS_getrandom)
+		// getrandom() avoids the file descriptor, and blocks only until the kernel pool has been seeded
+		while (num_bytes > 0)
+		{
+			long result = syscall(SYS_getrandom, out_dest_ptr, num_bytes, 0);
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				break;	// Kernel without getrandom()
+			}
+			out_dest_ptr += result;
+			num_bytes -= result;
+		}
+		if (num_bytes == 0)
+			return;
+#endif
 		File file("/dev/urandom");
-		file.read(random_pool, random_pool_size);
+		file.read(out_dest_ptr, num_bytes);
 		file.close();
 #endif
-
-		random_pool_free = random_pool_size;	// Reset it
-
 	}
 
 	bool Random_Impl::get_random_bool()
@@ -30,10 +30,17 @@
 
 #include "API/Core/System/cl_platform.h"
 #include "API/Core/System/databuffer.h"
+#include <memory>
+#include <mutex>
 
 namespace clan
 {
-	class Random_Impl
+	/// \brief Double buffered random number cache
+	///
+	/// While the front pool is being consumed, the back pool is refilled from the operating system
+	/// on a shared background thread. An empty front pool is swapped with the back pool, and is only
+	/// refilled on the calling thread if the background refill has not finished yet.
+	class Random_Impl : public std::enable_shared_from_this<Random_Impl>
 	{
 	public:
 		Random_Impl(int cache_size);
@@ -43,12 +50,23 @@ namespace clan
 		void get_random_bytes_nzero(unsigned char *out_dest_ptr, int num_bytes);
 		bool get_random_bool();
 
+		/// \brief Fill the back pool (called on the refill thread)
+		void refill_back_pool();
+
 	private:
 		void fill_random_pool();
+		void request_refill();
+		void read_os_random(unsigned char *out_dest_ptr, int num_bytes);
 
 		int random_pool_size;
 		int random_pool_free;
 		unsigned char *random_pool;
+
+		std::mutex back_pool_mutex;
+		unsigned char *back_pool;
+		bool back_pool_ready;
+		bool refill_pending;
+
 #ifdef WIN32
 		HCRYPTPROV hProvider;
 #endif
@@ -185,7 +185,7 @@ namespace clan
 		throw Exception("Cannot create a prime number");
 	}
 
-	void RSA_Impl::rsaep(BigInt *msg, const BigInt *e, const BigInt *modulus, BigInt *cipher)
+	void RSA_Impl::rsaep(BigInt *msg, const BigInt *e, const BigInt *modulus, BigInt *cipher, bool secret_exponent)
 	{
 		// Insure that message representative is in range of modulus
 		if ((msg->cmp_z() < 0) || (msg->cmp(modulus) >= 0))
@@ -193,7 +193,10 @@ namespace clan
 			throw Exception("Message is out of range of modulus");
 		}
 
-		msg->exptmod(e, modulus, cipher);
+		if (secret_exponent)
+			msg->exptmod_secret(e, modulus, cipher);
+		else
+			msg->exptmod(e, modulus, cipher);
 
 	}
 
@@ -205,7 +208,61 @@ namespace clan
 			throw Exception("ciphertext is out of range of modulus");
 		}
 
-		cipher->exptmod(d, modulus, msg);
+		cipher->exptmod_secret(d, modulus, msg);
+	}
+
+	void RSA_Impl::rsa_private_crt(Random &random, BigInt *input, const RSAPrivateKey &key, BigInt *output)
+	{
+		// Insure that the representative is in range of modulus
+		if ((input->cmp_z() < 0) || (input->cmp(&key.modulus) >= 0))
+		{
+			throw Exception("ciphertext is out of range of modulus");
+		}
+
+		BigInt original = *input;
+
+		// Blinding factor r, invertible modulo n
+		int k = key.modulus.unsigned_octet_size();
+		Secret random_bytes(k);
+		BigInt r, r_inverse;
+		do
+		{
+			random.get_random_bytes(random_bytes.get_data(), k);
+			r.read_unsigned_octets(random_bytes.get_data(), k);
+			r.mod(&key.modulus, &r);
+		} while (r.cmp_d(1) <= 0 || !r.invmod(&key.modulus, &r_inverse));
+
+		// c' = c * r^e mod n
+		BigInt blinded;
+		r.exptmod(&key.public_exponent, &key.modulus, &blinded);
+		blinded *= original;
+		blinded.mod(&key.modulus, &blinded);
+
+		// m1 = c'^dP mod p, m2 = c'^dQ mod q
+		BigInt m1, m2;
+		blinded.exptmod_secret(&key.exponent1, &key.prime1, &m1);
+		blinded.exptmod_secret(&key.exponent2, &key.prime2, &m2);
+
+		// h = qInv * (m1 - m2) mod p, with m1 + p - (m2 mod p) keeping the difference positive
+		BigInt m2_mod_p;
+		m2.mod(&key.prime1, &m2_mod_p);
+		BigInt h = m1 + key.prime1;
+		h -= m2_mod_p;
+		h *= key.coefficient;
+		h.mod(&key.prime1, &h);
+
+		// m' = m2 + h * q, and m = m' * r^-1 mod n
+		BigInt result = m2 + h * key.prime2;
+		result *= r_inverse;
+		result.mod(&key.modulus, &result);
+
+		// A faulty result would leak a prime through gcd(m^e - c, n), so it must never be returned
+		BigInt check;
+		result.exptmod(&key.public_exponent, &key.modulus, &check);
+		if (check.cmp(&original) != 0)
+			throw Exception("RSA private key operation failed verification");
+
+		*output = result;
 	}
 
 	void RSA_Impl::pkcs1v15_encode(int block_type, Random &random, const char *msg, int mlen, char *emsg, int emlen)
@@ -291,7 +348,32 @@ namespace clan
 		mrep.read_unsigned_octets(key.get_data(), key.get_size());
 
 		// Now, encrypt...
-		rsaep(&mrep, e, modulus, &mrep);
+		rsaep(&mrep, e, modulus, &mrep, block_type != 2);
+
+		// Unpack message representative...
+		DataBuffer buffer(mrep.unsigned_octet_size());
+		mrep.to_unsigned_octets((unsigned char *)buffer.get_data(), buffer.get_size());
+		return buffer;
+	}
+
+	DataBuffer RSA_Impl::pkcs1v15_encrypt(int block_type, Random &random, const char *msg, int mlen, const RSAPrivateKey &key)
+	{
+		int k = key.modulus.unsigned_octet_size();	// length of modulus, in bytes
+
+		Secret key_buffer(k);
+
+		char *buf = (char *)key_buffer.get_data();
+
+		// Encode according to PKCS #1 v1.5
+		pkcs1v15_encode(block_type, random, msg, mlen, buf, k);
+
+		// Convert encoded message to a big number for encryption
+		BigInt mrep;
+
+		mrep.read_unsigned_octets(key_buffer.get_data(), key_buffer.get_size());
+
+		// Now, encrypt...
+		rsa_private_crt(random, &mrep, key, &mrep);
 
 		// Unpack message representative...
 		DataBuffer buffer(mrep.unsigned_octet_size());
@@ -320,6 +402,25 @@ namespace clan
 		return pkcs1v15_decode((char *)key_buffer.get_data(), k);
 	}
 
+	Secret RSA_Impl::pkcs1v15_decrypt(const char *msg, int mlen, const RSAPrivateKey &key)
+	{
+		int k = key.modulus.unsigned_octet_size();		// size of modulus, in bytes
+		if (mlen != k)
+			throw Exception("Invalid message length");
+
+		// Convert ciphertext to integer representative
+		BigInt  mrep;
+		mrep.read_unsigned_octets((const unsigned char *)msg, mlen);
+
+		// Decrypt ...
+		Random random;
+		rsa_private_crt(random, &mrep, key, &mrep);
+
+		Secret key_buffer(k);
+		mrep.to_unsigned_octets(key_buffer.get_data(), k);
+		return pkcs1v15_decode((char *)key_buffer.get_data(), k);
+	}
+
 	DataBuffer RSA_Impl::encrypt(int block_type, Random &random, const void *in_public_exponent, unsigned int in_public_exponent_size, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size)
 	{
 		BigInt exponent;
@@ -342,6 +443,49 @@ namespace clan
 		return pkcs1v15_decrypt((const char *)in_data, in_data_size, &exponent, &modulus);
 	}
 
+	DataBuffer RSA_Impl::encrypt(int block_type, Random &random, const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const void *in_data, unsigned int in_data_size)
+	{
+		RSAPrivateKey key;
+		read_crt_key(in_prime1, in_prime2, in_exponent1, in_exponent2, in_coefficient, key);
+		return pkcs1v15_encrypt(block_type, random, (const char *)in_data, in_data_size, key);
+	}
+
+	Secret RSA_Impl::decrypt(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const void *in_data, unsigned int in_data_size)
+	{
+		RSAPrivateKey key;
+		read_crt_key(in_prime1, in_prime2, in_exponent1, in_exponent2, in_coefficient, key);
+		return pkcs1v15_decrypt((const char *)in_data, in_data_size, key);
+	}
+
+	void RSA_Impl::read_crt_key(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, RSAPrivateKey &out_key)
+	{
+		out_key.prime1.read_unsigned_octets(in_prime1.get_data(), in_prime1.get_size());
+		out_key.prime2.read_unsigned_octets(in_prime2.get_data(), in_prime2.get_size());
+		out_key.exponent1.read_unsigned_octets(in_exponent1.get_data(), in_exponent1.get_size());
+		out_key.exponent2.read_unsigned_octets(in_exponent2.get_data(), in_exponent2.get_size());
+		out_key.coefficient.read_unsigned_octets(in_coefficient.get_data(), in_coefficient.get_size());
+		out_key.modulus = out_key.prime1 * out_key.prime2;
+
+		// The public exponent is needed for blinding and verification. As e * dP = 1 mod (p - 1), it is the
+		// inverse of dP modulo p - 1 whenever e < p - 1, which holds for all keys in practical use.
+		BigInt psub1 = out_key.prime1 - 1;
+		BigInt qsub1 = out_key.prime2 - 1;
+		BigInt check;
+		if (!out_key.exponent1.invmod(&psub1, &out_key.public_exponent))
+			throw Exception("Invalid RSA private key");
+		check = out_key.public_exponent * out_key.exponent2;
+		check.mod(&qsub1, &check);
+		if (check.cmp_d(1) != 0)
+			throw Exception("Unsupported RSA private key");
+	}
+
+	Secret RSA_Impl::to_secret(const BigInt &value)
+	{
+		Secret buffer(value.unsigned_octet_size());
+		value.to_unsigned_octets(buffer.get_data(), buffer.get_size());
+		return buffer;
+	}
+
 	void RSA_Impl::create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, int key_size_in_bits, int public_exponent_value)
 	{
 		create(random, key_size_in_bits, public_exponent_value);
@@ -354,4 +498,13 @@ namespace clan
 		out_modulus = DataBuffer(rsa_private_key.modulus.unsigned_octet_size());
 		rsa_private_key.modulus.to_unsigned_octets((unsigned char *)out_modulus.get_data(), out_modulus.get_size());
 	}
+
+	void RSA_Impl::get_crt_parameters(Secret &out_prime1, Secret &out_prime2, Secret &out_exponent1, Secret &out_exponent2, Secret &out_coefficient)
+	{
+		out_prime1 = to_secret(rsa_private_key.prime1);
+		out_prime2 = to_secret(rsa_private_key.prime2);
+		out_exponent1 = to_secret(rsa_private_key.exponent1);
+		out_exponent2 = to_secret(rsa_private_key.exponent2);
+		out_coefficient = to_secret(rsa_private_key.coefficient);
+	}
 }
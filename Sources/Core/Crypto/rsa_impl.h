@@ -77,6 +77,8 @@ namespace clan
 
 		static DataBuffer encrypt(int block_type, Random &random, const void *in_public_exponent, unsigned int in_public_exponent_size, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size);
 		static Secret decrypt(const Secret &in_private_exponent, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size);
+		static DataBuffer encrypt(int block_type, Random &random, const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const void *in_data, unsigned int in_data_size);
+		static Secret decrypt(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const void *in_data, unsigned int in_data_size);
 
 		/// \brief Create the keypair
 		void create(Random &random, int key_size_in_bits, int public_exponent_value);
@@ -91,13 +93,25 @@ namespace clan
 		/// \param public_exponent_value = public exponent value
 		void create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, int key_size_in_bits, int public_exponent_value);
 
+		/// \brief Get the Chinese Remainder Theorem parameters of the created keypair
+		void get_crt_parameters(Secret &out_prime1, Secret &out_prime2, Secret &out_exponent1, Secret &out_exponent2, Secret &out_coefficient);
+
 	private:
 		void generate_prime(Random &random, BigInt &prime, int prime_len);
 		bool build_from_primes(BigInt *p, BigInt *q, BigInt *e, BigInt *d, unsigned int key_size_in_bits);
 
-		static void rsaep(BigInt *msg, const BigInt *e, const BigInt *modulus, BigInt *cipher);
+		static void rsaep(BigInt *msg, const BigInt *e, const BigInt *modulus, BigInt *cipher, bool secret_exponent);
 		static void rsadp(BigInt *cipher, const BigInt *d, const BigInt *modulus, BigInt *msg);
 
+		// RSA private key operation using the Chinese Remainder Theorem (the public exponent and modulus are used for blinding and verification)
+		//
+		// The input is blinded with a random factor, so the timing of the recombination does not depend on the actual input.
+		// The result is verified with the public key, so a fault during the computation can not reveal a prime.
+		static void rsa_private_crt(Random &random, BigInt *input, const RSAPrivateKey &key, BigInt *output);
+
+		static void read_crt_key(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, RSAPrivateKey &out_key);
+		static Secret to_secret(const BigInt &value);
+
 		// PKCS#1 v.1.5 message padding and encoding
 		// msg       - input message
 		// mlen      - length of input message, in bytes
@@ -118,6 +132,9 @@ namespace clan
 		// modulus   - encryption key modulus
 		static DataBuffer pkcs1v15_encrypt(int block_type, Random &random, const char *msg, int mlen, const BigInt *e, const BigInt *modulus);
 
+		// As above, using the Chinese Remainder Theorem private key
+		static DataBuffer pkcs1v15_encrypt(int block_type, Random &random, const char *msg, int mlen, const RSAPrivateKey &key);
+
 		// Decrypt a message using RSA and PKCS#1 v.1.5 padding
 		// msg       - input message (ciphertext)
 		// mlen      - length of input message, in bytes
@@ -125,6 +142,9 @@ namespace clan
 		// modulus   - decryption key modulus
 		static Secret pkcs1v15_decrypt(const char *msg, int mlen, const BigInt *d, const BigInt *modulus);
 
+		// As above, using the Chinese Remainder Theorem private key
+		static Secret pkcs1v15_decrypt(const char *msg, int mlen, const RSAPrivateKey &key);
+
 		RSAPrivateKey rsa_private_key;
 	};
 }
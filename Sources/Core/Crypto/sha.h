@@ -87,22 +87,22 @@ namespace clan
 	class SHA
 	{
 	public:
-		inline uint32_t leftrotate_uint32(uint32_t value, int shift) const
+		static inline uint32_t leftrotate_uint32(uint32_t value, int shift)
 		{
 			return (value << shift) | (value >> (32 - shift));
 		}
 
-		inline uint32_t rightrotate_uint32(uint32_t value, int shift) const
+		static inline uint32_t rightrotate_uint32(uint32_t value, int shift)
 		{
 			return (value >> shift) | (value << (32 - shift));
 		}
 
-		inline uint64_t leftrotate_uint64(uint64_t value, int shift) const
+		static inline uint64_t leftrotate_uint64(uint64_t value, int shift)
 		{
 			return (value << shift) | (value >> (64 - shift));
 		}
 
-		inline uint64_t rightrotate_uint64(uint64_t value, int shift) const
+		static inline uint64_t rightrotate_uint64(uint64_t value, int shift)
 		{
 			return (value >> shift) | (value << (64 - shift));
 		}
@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "sha1_impl.h"
+#include "sha_ni.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Crypto/sha1.h"
 
@@ -48,11 +49,11 @@ namespace clan
 			throw Exception("SHA-1 hash has not been calculated yet!");
 
 		char digest[41];
-		to_hex_be(digest, h0, uppercase);
-		to_hex_be(digest + 8, h1, uppercase);
-		to_hex_be(digest + 16, h2, uppercase);
-		to_hex_be(digest + 24, h3, uppercase);
-		to_hex_be(digest + 32, h4, uppercase);
+		to_hex_be(digest, h[0], uppercase);
+		to_hex_be(digest + 8, h[1], uppercase);
+		to_hex_be(digest + 16, h[2], uppercase);
+		to_hex_be(digest + 24, h[3], uppercase);
+		to_hex_be(digest + 32, h[4], uppercase);
 		digest[40] = 0;
 		return digest;
 	}
@@ -62,36 +63,36 @@ namespace clan
 		if (calculated == false)
 			throw Exception("SHA-1 hash has not been calculated yet!");
 
-		out_hash[0] = (unsigned char)((h0 >> 24) & 0xff);
-		out_hash[1] = (unsigned char)((h0 >> 16) & 0xff);
-		out_hash[2] = (unsigned char)((h0 >> 8) & 0xff);
-		out_hash[3] = (unsigned char)(h0 & 0xff);
-		out_hash[4] = (unsigned char)((h1 >> 24) & 0xff);
-		out_hash[5] = (unsigned char)((h1 >> 16) & 0xff);
-		out_hash[6] = (unsigned char)((h1 >> 8) & 0xff);
-		out_hash[7] = (unsigned char)(h1 & 0xff);
-		out_hash[8] = (unsigned char)((h2 >> 24) & 0xff);
-		out_hash[9] = (unsigned char)((h2 >> 16) & 0xff);
-		out_hash[10] = (unsigned char)((h2 >> 8) & 0xff);
-		out_hash[11] = (unsigned char)(h2 & 0xff);
-		out_hash[12] = (unsigned char)((h3 >> 24) & 0xff);
-		out_hash[13] = (unsigned char)((h3 >> 16) & 0xff);
-		out_hash[14] = (unsigned char)((h3 >> 8) & 0xff);
-		out_hash[15] = (unsigned char)(h3 & 0xff);
-		out_hash[16] = (unsigned char)((h4 >> 24) & 0xff);
-		out_hash[17] = (unsigned char)((h4 >> 16) & 0xff);
-		out_hash[18] = (unsigned char)((h4 >> 8) & 0xff);
-		out_hash[19] = (unsigned char)(h4 & 0xff);
+		out_hash[0] = (unsigned char)((h[0] >> 24) & 0xff);
+		out_hash[1] = (unsigned char)((h[0] >> 16) & 0xff);
+		out_hash[2] = (unsigned char)((h[0] >> 8) & 0xff);
+		out_hash[3] = (unsigned char)(h[0] & 0xff);
+		out_hash[4] = (unsigned char)((h[1] >> 24) & 0xff);
+		out_hash[5] = (unsigned char)((h[1] >> 16) & 0xff);
+		out_hash[6] = (unsigned char)((h[1] >> 8) & 0xff);
+		out_hash[7] = (unsigned char)(h[1] & 0xff);
+		out_hash[8] = (unsigned char)((h[2] >> 24) & 0xff);
+		out_hash[9] = (unsigned char)((h[2] >> 16) & 0xff);
+		out_hash[10] = (unsigned char)((h[2] >> 8) & 0xff);
+		out_hash[11] = (unsigned char)(h[2] & 0xff);
+		out_hash[12] = (unsigned char)((h[3] >> 24) & 0xff);
+		out_hash[13] = (unsigned char)((h[3] >> 16) & 0xff);
+		out_hash[14] = (unsigned char)((h[3] >> 8) & 0xff);
+		out_hash[15] = (unsigned char)(h[3] & 0xff);
+		out_hash[16] = (unsigned char)((h[4] >> 24) & 0xff);
+		out_hash[17] = (unsigned char)((h[4] >> 16) & 0xff);
+		out_hash[18] = (unsigned char)((h[4] >> 8) & 0xff);
+		out_hash[19] = (unsigned char)(h[4] & 0xff);
 	}
 
 	void SHA1_Impl::reset()
 	{
 		//  FIPS 180-3 section 5.3.1
-		h0 = 0x67452301;
-		h1 = 0xEFCDAB89;
-		h2 = 0x98BADCFE;
-		h3 = 0x10325476;
-		h4 = 0xC3D2E1F0;
+		h[0] = 0x67452301;
+		h[1] = 0xEFCDAB89;
+		h[2] = 0x98BADCFE;
+		h[3] = 0x10325476;
+		h[4] = 0xC3D2E1F0;
 		memset(chunk, 0, block_size);
 		chunk_filled = 0;
 		length_message = 0;
@@ -110,6 +111,15 @@ namespace clan
 		while (pos < size)
 		{
 			int data_left = size - pos;
+			if (chunk_filled == 0 && data_left >= block_size)
+			{
+				// Compress whole blocks directly from the input
+				int num_blocks = data_left / block_size;
+				process_blocks(h, data + pos, num_blocks);
+				pos += num_blocks * block_size;
+				continue;
+			}
+
 			int buffer_space = block_size - chunk_filled;
 			int data_used = min(buffer_space, data_left);
 			memcpy(chunk + chunk_filled, data + pos, data_used);
@@ -117,7 +127,7 @@ namespace clan
 			pos += data_used;
 			if (chunk_filled == block_size)
 			{
-				process_chunk();
+				process_blocks(h, chunk, 1);
 				chunk_filled = 0;
 			}
 		}
@@ -207,28 +217,41 @@ namespace clan
 		}
 	}
 
-	void SHA1_Impl::process_chunk()
+	void SHA1_Impl::process_blocks(uint32_t state[5], const unsigned char *data, int num_blocks)
+	{
+		if (SHA_NI::is_supported())
+		{
+			SHA_NI::sha1_process_blocks(state, data, num_blocks);
+		}
+		else
+		{
+			for (int block = 0; block < num_blocks; block++)
+				process_chunk(state, data + block * block_size);
+		}
+	}
+
+	void SHA1_Impl::process_chunk(uint32_t state[5], const unsigned char *data)
 	{
 		int i;
 		unsigned int w[80];
 
 		for (i = 0; i < 16; i++)
 		{
-			unsigned int b1 = chunk[i * 4];
-			unsigned int b2 = chunk[i * 4 + 1];
-			unsigned int b3 = chunk[i * 4 + 2];
-			unsigned int b4 = chunk[i * 4 + 3];
+			unsigned int b1 = data[i * 4];
+			unsigned int b2 = data[i * 4 + 1];
+			unsigned int b3 = data[i * 4 + 2];
+			unsigned int b4 = data[i * 4 + 3];
 			w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
 		}
 
 		for (i = 16; i < 80; i++)
 			w[i] = leftrotate_uint32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
 
-		uint32_t a = h0;
-		uint32_t b = h1;
-		uint32_t c = h2;
-		uint32_t d = h3;
-		uint32_t e = h4;
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
 
 		for (i = 0; i < 80; i++)
 		{
@@ -262,10 +285,10 @@ namespace clan
 			a = temp;
 		}
 
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
 	}
 }
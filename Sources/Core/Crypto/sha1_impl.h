@@ -45,15 +45,18 @@ namespace clan
 		void add(const void *data, int size);
 		void calculate();
 
+		/// \brief Compress 64 byte blocks into the state, using the SHA extensions when the CPU supports them
+		static void process_blocks(uint32_t state[5], const unsigned char *data, int num_blocks);
+
 	private:
-		void process_chunk();
+		static void process_chunk(uint32_t state[5], const unsigned char *data);
 
-		inline unsigned int leftrotate_uint32(unsigned int value, int shift) const
+		static inline unsigned int leftrotate_uint32(unsigned int value, int shift)
 		{
 			return (value << shift) + (value >> (32 - shift));
 		}
 
-		uint32_t h0, h1, h2, h3, h4;
+		uint32_t h[5];
 		const static int block_size = 64;
 		unsigned char chunk[block_size];
 		int chunk_filled;
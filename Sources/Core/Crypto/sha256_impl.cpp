@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "sha256_impl.h"
+#include "sha_ni.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Crypto/sha224.h"
 #include "API/Core/Crypto/sha256.h"
@@ -38,6 +39,23 @@
 
 namespace clan
 {
+	// Constants defined in FIPS 180-3, section 4.2.2
+	const uint32_t SHA256_Impl::constant_K[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+		0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+		0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+		0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+		0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+		0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+		0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+		0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+		0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+		0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+		0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+		0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
 	SHA256_Impl::SHA256_Impl(cl_sha_type new_sha_type) : sha_type(new_sha_type)
 	{
 		reset();
@@ -49,13 +67,13 @@ namespace clan
 			throw Exception("SHA-256 hash has not been calculated yet!");
 
 		char digest[32 * 2 + 1];
-		to_hex_be(digest, h0, uppercase);
-		to_hex_be(digest + 8, h1, uppercase);
-		to_hex_be(digest + 16, h2, uppercase);
-		to_hex_be(digest + 24, h3, uppercase);
-		to_hex_be(digest + 32, h4, uppercase);
-		to_hex_be(digest + 40, h5, uppercase);
-		to_hex_be(digest + 48, h6, uppercase);
+		to_hex_be(digest, h[0], uppercase);
+		to_hex_be(digest + 8, h[1], uppercase);
+		to_hex_be(digest + 16, h[2], uppercase);
+		to_hex_be(digest + 24, h[3], uppercase);
+		to_hex_be(digest + 32, h[4], uppercase);
+		to_hex_be(digest + 40, h[5], uppercase);
+		to_hex_be(digest + 48, h[6], uppercase);
 
 		if (sha_type == cl_sha_224)
 		{
@@ -64,7 +82,7 @@ namespace clan
 		else
 		{
 			// Must be cl_sha_256
-			to_hex_be(digest + 56, h7, uppercase);
+			to_hex_be(digest + 56, h[7], uppercase);
 			digest[64] = 0;
 		}
 		return digest;
@@ -75,41 +93,41 @@ namespace clan
 		if (calculated == false)
 			throw Exception("SHA-256 hash has not been calculated yet!");
 
-		out_hash[0] = (unsigned char)((h0 >> 24) & 0xff);
-		out_hash[1] = (unsigned char)((h0 >> 16) & 0xff);
-		out_hash[2] = (unsigned char)((h0 >> 8) & 0xff);
-		out_hash[3] = (unsigned char)(h0 & 0xff);
-		out_hash[4] = (unsigned char)((h1 >> 24) & 0xff);
-		out_hash[5] = (unsigned char)((h1 >> 16) & 0xff);
-		out_hash[6] = (unsigned char)((h1 >> 8) & 0xff);
-		out_hash[7] = (unsigned char)(h1 & 0xff);
-		out_hash[8] = (unsigned char)((h2 >> 24) & 0xff);
-		out_hash[9] = (unsigned char)((h2 >> 16) & 0xff);
-		out_hash[10] = (unsigned char)((h2 >> 8) & 0xff);
-		out_hash[11] = (unsigned char)(h2 & 0xff);
-		out_hash[12] = (unsigned char)((h3 >> 24) & 0xff);
-		out_hash[13] = (unsigned char)((h3 >> 16) & 0xff);
-		out_hash[14] = (unsigned char)((h3 >> 8) & 0xff);
-		out_hash[15] = (unsigned char)(h3 & 0xff);
-		out_hash[16] = (unsigned char)((h4 >> 24) & 0xff);
-		out_hash[17] = (unsigned char)((h4 >> 16) & 0xff);
-		out_hash[18] = (unsigned char)((h4 >> 8) & 0xff);
-		out_hash[19] = (unsigned char)(h4 & 0xff);
-		out_hash[20] = (unsigned char)((h5 >> 24) & 0xff);
-		out_hash[21] = (unsigned char)((h5 >> 16) & 0xff);
-		out_hash[22] = (unsigned char)((h5 >> 8) & 0xff);
-		out_hash[23] = (unsigned char)(h5 & 0xff);
-		out_hash[24] = (unsigned char)((h6 >> 24) & 0xff);
-		out_hash[25] = (unsigned char)((h6 >> 16) & 0xff);
-		out_hash[26] = (unsigned char)((h6 >> 8) & 0xff);
-		out_hash[27] = (unsigned char)(h6 & 0xff);
+		out_hash[0] = (unsigned char)((h[0] >> 24) & 0xff);
+		out_hash[1] = (unsigned char)((h[0] >> 16) & 0xff);
+		out_hash[2] = (unsigned char)((h[0] >> 8) & 0xff);
+		out_hash[3] = (unsigned char)(h[0] & 0xff);
+		out_hash[4] = (unsigned char)((h[1] >> 24) & 0xff);
+		out_hash[5] = (unsigned char)((h[1] >> 16) & 0xff);
+		out_hash[6] = (unsigned char)((h[1] >> 8) & 0xff);
+		out_hash[7] = (unsigned char)(h[1] & 0xff);
+		out_hash[8] = (unsigned char)((h[2] >> 24) & 0xff);
+		out_hash[9] = (unsigned char)((h[2] >> 16) & 0xff);
+		out_hash[10] = (unsigned char)((h[2] >> 8) & 0xff);
+		out_hash[11] = (unsigned char)(h[2] & 0xff);
+		out_hash[12] = (unsigned char)((h[3] >> 24) & 0xff);
+		out_hash[13] = (unsigned char)((h[3] >> 16) & 0xff);
+		out_hash[14] = (unsigned char)((h[3] >> 8) & 0xff);
+		out_hash[15] = (unsigned char)(h[3] & 0xff);
+		out_hash[16] = (unsigned char)((h[4] >> 24) & 0xff);
+		out_hash[17] = (unsigned char)((h[4] >> 16) & 0xff);
+		out_hash[18] = (unsigned char)((h[4] >> 8) & 0xff);
+		out_hash[19] = (unsigned char)(h[4] & 0xff);
+		out_hash[20] = (unsigned char)((h[5] >> 24) & 0xff);
+		out_hash[21] = (unsigned char)((h[5] >> 16) & 0xff);
+		out_hash[22] = (unsigned char)((h[5] >> 8) & 0xff);
+		out_hash[23] = (unsigned char)(h[5] & 0xff);
+		out_hash[24] = (unsigned char)((h[6] >> 24) & 0xff);
+		out_hash[25] = (unsigned char)((h[6] >> 16) & 0xff);
+		out_hash[26] = (unsigned char)((h[6] >> 8) & 0xff);
+		out_hash[27] = (unsigned char)(h[6] & 0xff);
 
 		if (sha_type == cl_sha_256)
 		{
-			out_hash[28] = (unsigned char)((h7 >> 24) & 0xff);
-			out_hash[29] = (unsigned char)((h7 >> 16) & 0xff);
-			out_hash[30] = (unsigned char)((h7 >> 8) & 0xff);
-			out_hash[31] = (unsigned char)(h7 & 0xff);
+			out_hash[28] = (unsigned char)((h[7] >> 24) & 0xff);
+			out_hash[29] = (unsigned char)((h[7] >> 16) & 0xff);
+			out_hash[30] = (unsigned char)((h[7] >> 8) & 0xff);
+			out_hash[31] = (unsigned char)(h[7] & 0xff);
 		}	// Else cl_sha_224
 	}
 
@@ -117,26 +135,26 @@ namespace clan
 	{
 		if (sha_type == cl_sha_224)
 		{
-			h0 = 0xc1059ed8;
-			h1 = 0x367cd507;
-			h2 = 0x3070dd17;
-			h3 = 0xf70e5939;
-			h4 = 0xffc00b31;
-			h5 = 0x68581511;
-			h6 = 0x64f98fa7;
-			h7 = 0xbefa4fa4;
+			h[0] = 0xc1059ed8;
+			h[1] = 0x367cd507;
+			h[2] = 0x3070dd17;
+			h[3] = 0xf70e5939;
+			h[4] = 0xffc00b31;
+			h[5] = 0x68581511;
+			h[6] = 0x64f98fa7;
+			h[7] = 0xbefa4fa4;
 		}
 		else if (sha_type == cl_sha_256)
 		{
 			// These words were obtained by taking the first thirty-two bits of the fractional parts of the square roots of the first eight prime numbers
-			h0 = 0x6a09e667;
-			h1 = 0xbb67ae85;
-			h2 = 0x3c6ef372;
-			h3 = 0xa54ff53a;
-			h4 = 0x510e527f;
-			h5 = 0x9b05688c;
-			h6 = 0x1f83d9ab;
-			h7 = 0x5be0cd19;
+			h[0] = 0x6a09e667;
+			h[1] = 0xbb67ae85;
+			h[2] = 0x3c6ef372;
+			h[3] = 0xa54ff53a;
+			h[4] = 0x510e527f;
+			h[5] = 0x9b05688c;
+			h[6] = 0x1f83d9ab;
+			h[7] = 0x5be0cd19;
 		}
 		else
 		{
@@ -160,6 +178,15 @@ namespace clan
 		while (pos < size)
 		{
 			int data_left = size - pos;
+			if (chunk_filled == 0 && data_left >= block_size)
+			{
+				// Compress whole blocks directly from the input
+				int num_blocks = data_left / block_size;
+				process_blocks(h, data + pos, num_blocks);
+				pos += num_blocks * block_size;
+				continue;
+			}
+
 			int buffer_space = block_size - chunk_filled;
 			int data_used = min(buffer_space, data_left);
 			memcpy(chunk + chunk_filled, data + pos, data_used);
@@ -167,7 +194,7 @@ namespace clan
 			pos += data_used;
 			if (chunk_filled == block_size)
 			{
-				process_chunk();
+				process_blocks(h, chunk, 1);
 				chunk_filled = 0;
 			}
 		}
@@ -286,34 +313,30 @@ namespace clan
 		}
 	}
 
-	void SHA256_Impl::process_chunk()
+	void SHA256_Impl::process_blocks(uint32_t state[8], const unsigned char *data, int num_blocks)
 	{
-		// Constants defined in FIPS 180-3, section 4.2.2
-		static const uint32_t constant_K[64] = {
-			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-			0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-			0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-			0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-			0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-			0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-			0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-			0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-			0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-			0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-			0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-			0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-		};
+		if (SHA_NI::is_supported())
+		{
+			SHA_NI::sha256_process_blocks(state, data, num_blocks);
+		}
+		else
+		{
+			for (int block = 0; block < num_blocks; block++)
+				process_chunk(state, data + block * block_size);
+		}
+	}
 
+	void SHA256_Impl::process_chunk(uint32_t state[8], const unsigned char *data)
+	{
 		int i;
 		unsigned int w[64];
 
 		for (i = 0; i < 16; i++)
 		{
-			unsigned int b1 = chunk[i * 4];
-			unsigned int b2 = chunk[i * 4 + 1];
-			unsigned int b3 = chunk[i * 4 + 2];
-			unsigned int b4 = chunk[i * 4 + 3];
+			unsigned int b1 = data[i * 4];
+			unsigned int b2 = data[i * 4 + 1];
+			unsigned int b3 = data[i * 4 + 2];
+			unsigned int b4 = data[i * 4 + 3];
 			w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
 		}
 
@@ -322,14 +345,14 @@ namespace clan
 			w[i] = sigma_rr17_rr19_sr10(w[i - 2]) + w[i - 7] + sigma_rr7_rr18_sr3(w[i - 15]) + w[i - 16];
 		}
 
-		uint32_t a = h0;
-		uint32_t b = h1;
-		uint32_t c = h2;
-		uint32_t d = h3;
-		uint32_t e = h4;
-		uint32_t f = h5;
-		uint32_t g = h6;
-		uint32_t h = h7;
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+		uint32_t f = state[5];
+		uint32_t g = state[6];
+		uint32_t h = state[7];
 
 		for (i = 0; i < 64; i++)
 		{
@@ -347,13 +370,13 @@ namespace clan
 			a = t1 + t2;
 		}
 
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
-		h5 += f;
-		h6 += g;
-		h7 += h;
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
 	}
 }
@@ -0,0 +1,492 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/system.h"
+#include "API/Core/Math/cl_math.h"
+#include "sha_multi_buffer.h"
+#include "sha_ni.h"
+#include "sha1_impl.h"
+#include "sha256_impl.h"
+#include "API/Core/Crypto/sha256.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef CL_SHA_AVX2_AVAILABLE
+#include <immintrin.h>
+
+// Allow the intrinsics in these functions without enabling the instruction set for the whole build
+#if defined(__GNUC__)
+#define CL_SHA_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CL_SHA_AVX2_TARGET
+#endif
+#endif
+
+namespace clan
+{
+	typedef void(*SHA_ProcessBlocksFunc)(uint32_t *state, const unsigned char *data, int num_blocks);
+	typedef void(*SHA_KernelX8Func)(uint32_t(*state)[8], const unsigned char * const *blocks);
+
+	/// \brief The padded 64 byte blocks of a message
+	///
+	/// Whole blocks are read in place, only the blocks holding the prefix or the padding are copied.
+	class SHA_MessageBlocks
+	{
+	public:
+		static const int block_size = 64;
+
+		void init(const unsigned char *data, int size, int prefix)
+		{
+			num_segments = 0;
+			segment = 0;
+			segment_pos = 0;
+
+			uint64_t length_bits = ((uint64_t)size + (prefix >= 0 ? 1 : 0)) * 8;
+			int pos = 0;
+			int tail_size = 0;
+
+			if (prefix >= 0)
+			{
+				if (size >= block_size - 1)
+				{
+					head[0] = (unsigned char)prefix;
+					memcpy(head + 1, data, block_size - 1);
+					add_segment(head, 1);
+					pos = block_size - 1;
+				}
+				else
+				{
+					tail[tail_size++] = (unsigned char)prefix;
+				}
+			}
+
+			int num_blocks = (size - pos) / block_size;
+			if (num_blocks > 0)
+			{
+				add_segment(data + pos, num_blocks);
+				pos += num_blocks * block_size;
+			}
+
+			// Append a "1" bit, "0" bits and the message length in bits as a 64 bit big endian number
+			memcpy(tail + tail_size, data + pos, size - pos);
+			tail_size += size - pos;
+			int tail_blocks = (tail_size + 9 <= block_size) ? 1 : 2;
+			memset(tail + tail_size, 0, tail_blocks * block_size - tail_size);
+			tail[tail_size] = 0x80;
+			for (int cnt = 0; cnt < 8; cnt++)
+				tail[tail_blocks * block_size - 1 - cnt] = (unsigned char)(length_bits >> (cnt * 8));
+			add_segment(tail, tail_blocks);
+		}
+
+		bool is_done() const { return segment == num_segments; }
+
+		const unsigned char *next_block()
+		{
+			const unsigned char *block = segment_data[segment] + segment_pos * block_size;
+			if (++segment_pos == segment_blocks[segment])
+			{
+				segment++;
+				segment_pos = 0;
+			}
+			return block;
+		}
+
+		void process_remaining(uint32_t *state, SHA_ProcessBlocksFunc process_blocks)
+		{
+			for (; segment < num_segments; segment++, segment_pos = 0)
+				process_blocks(state, segment_data[segment] + segment_pos * block_size, segment_blocks[segment] - segment_pos);
+		}
+
+	private:
+		void add_segment(const unsigned char *data, int num_blocks)
+		{
+			segment_data[num_segments] = data;
+			segment_blocks[num_segments] = num_blocks;
+			num_segments++;
+		}
+
+		const unsigned char *segment_data[3];
+		int segment_blocks[3];
+		int num_segments;
+		int segment;
+		int segment_pos;
+
+		unsigned char head[block_size];
+		unsigned char tail[block_size * 2];
+	};
+
+	static void sha_store_hash(const uint32_t *state, int num_words, unsigned char *out_hash)
+	{
+		for (int word = 0; word < num_words; word++)
+		{
+			out_hash[word * 4] = (unsigned char)(state[word] >> 24);
+			out_hash[word * 4 + 1] = (unsigned char)(state[word] >> 16);
+			out_hash[word * 4 + 2] = (unsigned char)(state[word] >> 8);
+			out_hash[word * 4 + 3] = (unsigned char)state[word];
+		}
+	}
+
+	static void sha_hash_messages(int num_words, const uint32_t *initial_state, SHA_ProcessBlocksFunc process_blocks, SHA_KernelX8Func kernel_x8,
+		int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes, int prefix)
+	{
+		const int num_lanes = 8;
+		const int min_active_lanes = 3;	// Below this, the eight lane kernel is slower than compressing the messages one by one
+
+		if (!kernel_x8)
+		{
+			SHA_MessageBlocks message;
+			uint32_t state[8];
+			for (int cnt = 0; cnt < num_messages; cnt++)
+			{
+				memcpy(state, initial_state, num_words * sizeof(uint32_t));
+				message.init((const unsigned char *)data[cnt], sizes[cnt], prefix);
+				message.process_remaining(state, process_blocks);
+				sha_store_hash(state, num_words, out_hashes + cnt * num_words * 4);
+			}
+			return;
+		}
+
+		// The state is stored word by word, so each word of the eight lanes is a single SIMD register
+		alignas(32) uint32_t state[8][num_lanes];
+		SHA_MessageBlocks lanes[num_lanes];
+		int lane_message[num_lanes];
+		const unsigned char *blocks[num_lanes];
+		static const unsigned char idle_block[SHA_MessageBlocks::block_size] = { 0 };
+
+		int next_message = 0;
+		int active_lanes = 0;
+		auto start_lane = [&](int lane)
+		{
+			if (next_message == num_messages)
+			{
+				lane_message[lane] = -1;
+				return;
+			}
+			lanes[lane].init((const unsigned char *)data[next_message], sizes[next_message], prefix);
+			for (int word = 0; word < num_words; word++)
+				state[word][lane] = initial_state[word];
+			lane_message[lane] = next_message++;
+			active_lanes++;
+		};
+
+		for (int lane = 0; lane < num_lanes; lane++)
+			start_lane(lane);
+
+		while (active_lanes > 0)
+		{
+			if (active_lanes < min_active_lanes && next_message == num_messages)
+			{
+				for (int lane = 0; lane < num_lanes; lane++)
+				{
+					if (lane_message[lane] < 0)
+						continue;
+					uint32_t lane_state[8];
+					for (int word = 0; word < num_words; word++)
+						lane_state[word] = state[word][lane];
+					lanes[lane].process_remaining(lane_state, process_blocks);
+					sha_store_hash(lane_state, num_words, out_hashes + lane_message[lane] * num_words * 4);
+				}
+				break;
+			}
+
+			for (int lane = 0; lane < num_lanes; lane++)
+				blocks[lane] = lane_message[lane] >= 0 ? lanes[lane].next_block() : idle_block;
+
+			kernel_x8(state, blocks);
+
+			for (int lane = 0; lane < num_lanes; lane++)
+			{
+				if (lane_message[lane] >= 0 && lanes[lane].is_done())
+				{
+					uint32_t lane_state[8];
+					for (int word = 0; word < num_words; word++)
+						lane_state[word] = state[word][lane];
+					sha_store_hash(lane_state, num_words, out_hashes + lane_message[lane] * num_words * 4);
+					active_lanes--;
+					start_lane(lane);
+				}
+			}
+		}
+	}
+
+#ifdef CL_SHA_AVX2_AVAILABLE
+
+	static inline CL_SHA_AVX2_TARGET __m256i rotate_right(__m256i value, int shift)
+	{
+		return _mm256_or_si256(_mm256_srli_epi32(value, shift), _mm256_slli_epi32(value, 32 - shift));
+	}
+
+	static inline CL_SHA_AVX2_TARGET __m256i rotate_left(__m256i value, int shift)
+	{
+		return _mm256_or_si256(_mm256_slli_epi32(value, shift), _mm256_srli_epi32(value, 32 - shift));
+	}
+
+	// Load 32 bytes of each block, so that register n holds big endian word n of all eight blocks
+	static inline CL_SHA_AVX2_TARGET void sha_load_transposed(__m256i *words, const unsigned char * const *blocks, int offset)
+	{
+		const __m256i byte_swap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+		__m256i rows[8];
+		for (int lane = 0; lane < 8; lane++)
+			rows[lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[lane] + offset));
+
+		__m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+		__m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+		__m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+		__m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+		__m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+		__m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+		__m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+		__m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+		__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+		__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+		__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+		__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+		__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+		__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+		__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+		__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+		words[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x20), byte_swap);
+		words[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x20), byte_swap);
+		words[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x20), byte_swap);
+		words[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x20), byte_swap);
+		words[4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x31), byte_swap);
+		words[5] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x31), byte_swap);
+		words[6] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x31), byte_swap);
+		words[7] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x31), byte_swap);
+	}
+
+	static CL_SHA_AVX2_TARGET void sha256_kernel_x8(uint32_t(*state)[8], const unsigned char * const *blocks)
+	{
+		__m256i w[16];
+		sha_load_transposed(w, blocks, 0);
+		sha_load_transposed(w + 8, blocks, 32);
+
+		__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[0]));
+		__m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[1]));
+		__m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[2]));
+		__m256i d = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[3]));
+		__m256i e = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[4]));
+		__m256i f = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[5]));
+		__m256i g = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[6]));
+		__m256i h = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[7]));
+
+		for (int i = 0; i < 64; i++)
+		{
+			if (i >= 16)
+			{
+				__m256i w15 = w[(i - 15) & 15];
+				__m256i w2 = w[(i - 2) & 15];
+				__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(w15, 7), rotate_right(w15, 18)), _mm256_srli_epi32(w15, 3));
+				__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(w2, 17), rotate_right(w2, 19)), _mm256_srli_epi32(w2, 10));
+				w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0), _mm256_add_epi32(w[(i - 7) & 15], s1));
+			}
+
+			__m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(e, 6), rotate_right(e, 11)), rotate_right(e, 25));
+			__m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+			__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(choose, _mm256_add_epi32(_mm256_set1_epi32(SHA256_Impl::constant_K[i]), w[i & 15])));
+			__m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(a, 2), rotate_right(a, 13)), rotate_right(a, 22));
+			__m256i majority = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+			__m256i t2 = _mm256_add_epi32(sum0, majority);
+
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(t1, t2);
+		}
+
+		__m256i *dest = reinterpret_cast<__m256i*>(state);
+		_mm256_store_si256(dest, _mm256_add_epi32(_mm256_load_si256(dest), a));
+		_mm256_store_si256(dest + 1, _mm256_add_epi32(_mm256_load_si256(dest + 1), b));
+		_mm256_store_si256(dest + 2, _mm256_add_epi32(_mm256_load_si256(dest + 2), c));
+		_mm256_store_si256(dest + 3, _mm256_add_epi32(_mm256_load_si256(dest + 3), d));
+		_mm256_store_si256(dest + 4, _mm256_add_epi32(_mm256_load_si256(dest + 4), e));
+		_mm256_store_si256(dest + 5, _mm256_add_epi32(_mm256_load_si256(dest + 5), f));
+		_mm256_store_si256(dest + 6, _mm256_add_epi32(_mm256_load_si256(dest + 6), g));
+		_mm256_store_si256(dest + 7, _mm256_add_epi32(_mm256_load_si256(dest + 7), h));
+	}
+
+	static CL_SHA_AVX2_TARGET void sha1_kernel_x8(uint32_t(*state)[8], const unsigned char * const *blocks)
+	{
+		__m256i w[16];
+		sha_load_transposed(w, blocks, 0);
+		sha_load_transposed(w + 8, blocks, 32);
+
+		__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[0]));
+		__m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[1]));
+		__m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[2]));
+		__m256i d = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[3]));
+		__m256i e = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[4]));
+
+		for (int i = 0; i < 80; i++)
+		{
+			if (i >= 16)
+				w[i & 15] = rotate_left(_mm256_xor_si256(_mm256_xor_si256(w[(i - 3) & 15], w[(i - 8) & 15]), _mm256_xor_si256(w[(i - 14) & 15], w[i & 15])), 1);
+
+			__m256i f, k;
+			if (i < 20)
+			{
+				f = _mm256_xor_si256(_mm256_and_si256(b, c), _mm256_andnot_si256(b, d));
+				k = _mm256_set1_epi32(0x5A827999);
+			}
+			else if (i < 40)
+			{
+				f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+				k = _mm256_set1_epi32(0x6ED9EBA1);
+			}
+			else if (i < 60)
+			{
+				f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+				k = _mm256_set1_epi32(0x8F1BBCDC);
+			}
+			else
+			{
+				f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+				k = _mm256_set1_epi32(0xCA62C1D6);
+			}
+
+			__m256i temp = _mm256_add_epi32(_mm256_add_epi32(rotate_left(a, 5), f), _mm256_add_epi32(_mm256_add_epi32(e, k), w[i & 15]));
+			e = d;
+			d = c;
+			c = rotate_left(b, 30);
+			b = a;
+			a = temp;
+		}
+
+		__m256i *dest = reinterpret_cast<__m256i*>(state);
+		_mm256_store_si256(dest, _mm256_add_epi32(_mm256_load_si256(dest), a));
+		_mm256_store_si256(dest + 1, _mm256_add_epi32(_mm256_load_si256(dest + 1), b));
+		_mm256_store_si256(dest + 2, _mm256_add_epi32(_mm256_load_si256(dest + 2), c));
+		_mm256_store_si256(dest + 3, _mm256_add_epi32(_mm256_load_si256(dest + 3), d));
+		_mm256_store_si256(dest + 4, _mm256_add_epi32(_mm256_load_si256(dest + 4), e));
+	}
+
+#endif
+
+	bool SHA_MultiBuffer::is_avx2_supported()
+	{
+#ifdef CL_SHA_AVX2_AVAILABLE
+		static bool supported = System::detect_cpu_extension(System::avx) && System::detect_cpu_extension(System::avx2);
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	void SHA_MultiBuffer::sha1(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes, int prefix)
+	{
+		//  FIPS 180-3 section 5.3.1
+		static const uint32_t initial_state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+		// The SHA extensions are faster than eight SHA-1 lanes
+		SHA_KernelX8Func kernel_x8 = nullptr;
+#ifdef CL_SHA_AVX2_AVAILABLE
+		if (is_avx2_supported() && !SHA_NI::is_supported())
+			kernel_x8 = &sha1_kernel_x8;
+#endif
+		sha_hash_messages(5, initial_state, &SHA1_Impl::process_blocks, kernel_x8, num_messages, data, sizes, out_hashes, prefix);
+	}
+
+	void SHA_MultiBuffer::sha256(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes, int prefix)
+	{
+		//  FIPS 180-3 section 5.3.3
+		static const uint32_t initial_state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+		// The SHA extensions are faster than eight SHA-256 lanes
+		SHA_KernelX8Func kernel_x8 = nullptr;
+#ifdef CL_SHA_AVX2_AVAILABLE
+		if (is_avx2_supported() && !SHA_NI::is_supported())
+			kernel_x8 = &sha256_kernel_x8;
+#endif
+		sha_hash_messages(8, initial_state, &SHA256_Impl::process_blocks, kernel_x8, num_messages, data, sizes, out_hashes, prefix);
+	}
+
+	void SHA_MultiBuffer::sha256_tree_leaves(const unsigned char *data, int size, int leaf_size, unsigned char *out_hashes)
+	{
+		const int min_leaves_per_thread = 8;
+
+		int num_leaves = get_num_tree_leaves(size, leaf_size);
+		std::vector<const void *> leaf_data(num_leaves);
+		std::vector<int> leaf_sizes(num_leaves);
+		for (int leaf = 0; leaf < num_leaves; leaf++)
+		{
+			leaf_data[leaf] = data + (size_t)leaf * leaf_size;
+			leaf_sizes[leaf] = min(leaf_size, size - leaf * leaf_size);
+		}
+
+		int num_threads = max(1, min((int)std::thread::hardware_concurrency(), num_leaves / min_leaves_per_thread));
+		int leaves_per_thread = (num_leaves + num_threads - 1) / num_threads;
+
+		std::vector<std::thread> threads;
+		for (int first_leaf = leaves_per_thread; first_leaf < num_leaves; first_leaf += leaves_per_thread)
+		{
+			int count = min(leaves_per_thread, num_leaves - first_leaf);
+			threads.push_back(std::thread([&, first_leaf, count]()
+			{
+				sha256(count, &leaf_data[first_leaf], &leaf_sizes[first_leaf], out_hashes + first_leaf * SHA256::hash_size, 0);
+			}));
+		}
+
+		sha256(min(leaves_per_thread, num_leaves), &leaf_data[0], &leaf_sizes[0], out_hashes, 0);
+
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	void SHA_MultiBuffer::sha256_tree_root(unsigned char *hashes, int num_hashes, unsigned char out_hash[32])
+	{
+		const int hash_size = SHA256::hash_size;
+
+		std::vector<const void *> pair_data;
+		std::vector<int> pair_sizes;
+		std::vector<unsigned char> parents;
+		while (num_hashes > 1)
+		{
+			int num_pairs = num_hashes / 2;
+			pair_data.resize(num_pairs);
+			pair_sizes.assign(num_pairs, hash_size * 2);
+			parents.resize(num_pairs * hash_size);
+			for (int pair = 0; pair < num_pairs; pair++)
+				pair_data[pair] = hashes + pair * hash_size * 2;
+
+			sha256(num_pairs, &pair_data[0], &pair_sizes[0], &parents[0], 1);
+
+			if (num_hashes & 1)
+				memmove(hashes + num_pairs * hash_size, hashes + (num_hashes - 1) * hash_size, hash_size);
+			memcpy(hashes, &parents[0], num_pairs * hash_size);
+			num_hashes = num_pairs + (num_hashes & 1);
+		}
+		memcpy(out_hash, hashes, hash_size);
+	}
+}
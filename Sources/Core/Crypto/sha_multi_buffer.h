@@ -0,0 +1,76 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+
+#if !defined(CL_DISABLE_SSE2) && !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_SHA_AVX2_AVAILABLE
+#endif
+
+namespace clan
+{
+	/// \brief Hashes many independent messages at once
+	///
+	/// With AVX2 (and without the SHA extensions, which are faster per message) eight messages are
+	/// compressed side by side, one per 32 bit SIMD lane. A lane is refilled with the next message as soon as
+	/// its current message is finished, so messages of different sizes can be mixed freely.
+	class SHA_MultiBuffer
+	{
+	public:
+		/// \brief Returns true if the CPU supports the eight lane AVX2 kernels
+		static bool is_avx2_supported();
+
+		/// \brief Calculate SHA-1 hashes
+		///
+		/// \param prefix = A byte to hash in front of every message, or -1 for none
+		/// \param out_hashes = Destination, 20 bytes per message
+		static void sha1(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes, int prefix = -1);
+
+		/// \brief Calculate SHA-256 hashes
+		///
+		/// \param prefix = A byte to hash in front of every message, or -1 for none
+		/// \param out_hashes = Destination, 32 bytes per message
+		static void sha256(int num_messages, const void * const *data, const int *sizes, unsigned char *out_hashes, int prefix = -1);
+
+		/// \brief Calculate the SHA-256 tree hash leaves of the data, SHA-256(0x00 + leaf), using all CPU cores
+		///
+		/// \param out_hashes = Destination, 32 bytes per leaf. The number of leaves is get_num_tree_leaves()
+		static void sha256_tree_leaves(const unsigned char *data, int size, int leaf_size, unsigned char *out_hashes);
+
+		/// \brief Reduce a level of SHA-256 tree hashes to the root hash
+		///
+		/// Pairs are hashed as SHA-256(0x01 + left + right), an odd node is carried up unchanged.
+		/// The hashes are overwritten.
+		static void sha256_tree_root(unsigned char *hashes, int num_hashes, unsigned char out_hash[32]);
+
+		/// \brief Returns the number of leaves in a tree hash of the data. Empty data has a single empty leaf
+		static int get_num_tree_leaves(int size, int leaf_size) { return size > 0 ? (size - 1) / leaf_size + 1 : 1; }
+	};
+}
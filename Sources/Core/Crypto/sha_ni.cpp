@@ -0,0 +1,249 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/system.h"
+#include "sha_ni.h"
+#include "sha256_impl.h"
+
+#ifdef CL_SHA_NI_AVAILABLE
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+// Allow the intrinsics in these functions without enabling the instruction sets for the whole build
+#if defined(__GNUC__)
+#define CL_SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define CL_SHA_NI_TARGET
+#endif
+#endif
+
+namespace clan
+{
+	bool SHA_NI::is_supported()
+	{
+#ifdef CL_SHA_NI_AVAILABLE
+		static bool supported = System::detect_cpu_extension(System::sha) && System::detect_cpu_extension(System::sse4_1) && System::detect_cpu_extension(System::ssse3);
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+#ifdef CL_SHA_NI_AVAILABLE
+
+	// Four SHA-256 rounds
+	static inline CL_SHA_NI_TARGET void sha256_rounds(__m128i &state0, __m128i &state1, __m128i message, int round)
+	{
+		message = _mm_add_epi32(message, _mm_loadu_si128(reinterpret_cast<const __m128i*>(SHA256_Impl::constant_K + round)));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+		message = _mm_shuffle_epi32(message, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+	}
+
+	// Complete the message schedule of the next four words
+	static inline CL_SHA_NI_TARGET void sha256_schedule(__m128i &next, __m128i previous, __m128i current)
+	{
+		next = _mm_add_epi32(next, _mm_alignr_epi8(current, previous, 4));
+		next = _mm_sha256msg2_epu32(next, current);
+	}
+
+	CL_SHA_NI_TARGET void SHA_NI::sha256_process_blocks(uint32_t state[8], const unsigned char *data, int num_blocks)
+	{
+		const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+		// The rounds instruction works on the state as ABEF and CDGH
+		__m128i temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+		__m128i state0 = _mm_alignr_epi8(temp, state1, 8);
+		state1 = _mm_blend_epi16(state1, temp, 0xF0);
+
+		const __m128i *src = reinterpret_cast<const __m128i*>(data);
+		for (int block = 0; block < num_blocks; block++, src += 4)
+		{
+			__m128i saved_state0 = state0;
+			__m128i saved_state1 = state1;
+
+			__m128i message0 = _mm_shuffle_epi8(_mm_loadu_si128(src), byte_swap);
+			__m128i message1 = _mm_shuffle_epi8(_mm_loadu_si128(src + 1), byte_swap);
+			__m128i message2 = _mm_shuffle_epi8(_mm_loadu_si128(src + 2), byte_swap);
+			__m128i message3 = _mm_shuffle_epi8(_mm_loadu_si128(src + 3), byte_swap);
+
+			sha256_rounds(state0, state1, message0, 0);
+			sha256_rounds(state0, state1, message1, 4);
+			message0 = _mm_sha256msg1_epu32(message0, message1);
+			sha256_rounds(state0, state1, message2, 8);
+			message1 = _mm_sha256msg1_epu32(message1, message2);
+			sha256_rounds(state0, state1, message3, 12);
+			sha256_schedule(message0, message2, message3);
+			message2 = _mm_sha256msg1_epu32(message2, message3);
+
+			for (int round = 16; round < 48; round += 16)
+			{
+				sha256_rounds(state0, state1, message0, round);
+				sha256_schedule(message1, message3, message0);
+				message3 = _mm_sha256msg1_epu32(message3, message0);
+				sha256_rounds(state0, state1, message1, round + 4);
+				sha256_schedule(message2, message0, message1);
+				message0 = _mm_sha256msg1_epu32(message0, message1);
+				sha256_rounds(state0, state1, message2, round + 8);
+				sha256_schedule(message3, message1, message2);
+				message1 = _mm_sha256msg1_epu32(message1, message2);
+				sha256_rounds(state0, state1, message3, round + 12);
+				sha256_schedule(message0, message2, message3);
+				message2 = _mm_sha256msg1_epu32(message2, message3);
+			}
+
+			sha256_rounds(state0, state1, message0, 48);
+			sha256_schedule(message1, message3, message0);
+			message3 = _mm_sha256msg1_epu32(message3, message0);
+			sha256_rounds(state0, state1, message1, 52);
+			sha256_schedule(message2, message0, message1);
+			sha256_rounds(state0, state1, message2, 56);
+			sha256_schedule(message3, message1, message2);
+			sha256_rounds(state0, state1, message3, 60);
+
+			state0 = _mm_add_epi32(state0, saved_state0);
+			state1 = _mm_add_epi32(state1, saved_state1);
+		}
+
+		temp = _mm_shuffle_epi32(state0, 0x1B);
+		state1 = _mm_shuffle_epi32(state1, 0xB1);
+		state0 = _mm_blend_epi16(temp, state1, 0xF0);
+		state1 = _mm_alignr_epi8(state1, temp, 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+	}
+
+	CL_SHA_NI_TARGET void SHA_NI::sha1_process_blocks(uint32_t state[5], const unsigned char *data, int num_blocks)
+	{
+		const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+		__m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+		__m128i e1;
+
+		const __m128i *src = reinterpret_cast<const __m128i*>(data);
+		for (int block = 0; block < num_blocks; block++, src += 4)
+		{
+			__m128i saved_abcd = abcd;
+			__m128i saved_e0 = e0;
+
+			__m128i message0 = _mm_shuffle_epi8(_mm_loadu_si128(src), byte_swap);
+			__m128i message1 = _mm_shuffle_epi8(_mm_loadu_si128(src + 1), byte_swap);
+			__m128i message2 = _mm_shuffle_epi8(_mm_loadu_si128(src + 2), byte_swap);
+			__m128i message3 = _mm_shuffle_epi8(_mm_loadu_si128(src + 3), byte_swap);
+
+			// Rounds 0 to 15
+			e0 = _mm_add_epi32(e0, message0);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+			e1 = _mm_sha1nexte_epu32(e1, message1);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			message0 = _mm_sha1msg1_epu32(message0, message1);
+
+			e0 = _mm_sha1nexte_epu32(e0, message2);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			message1 = _mm_sha1msg1_epu32(message1, message2);
+			message0 = _mm_xor_si128(message0, message2);
+
+			e1 = _mm_sha1nexte_epu32(e1, message3);
+			e0 = abcd;
+			message0 = _mm_sha1msg2_epu32(message0, message3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			message2 = _mm_sha1msg1_epu32(message2, message3);
+			message1 = _mm_xor_si128(message1, message3);
+
+			// Rounds 16 to 63. The round function (the immediate) changes every 20 rounds
+#define CL_SHA1_NI_ROUNDS(e_current, e_next, function, m_current, m_next, m_previous, m_after_next) \
+			e_current = _mm_sha1nexte_epu32(e_current, m_current); \
+			e_next = abcd; \
+			m_next = _mm_sha1msg2_epu32(m_next, m_current); \
+			abcd = _mm_sha1rnds4_epu32(abcd, e_current, function); \
+			m_previous = _mm_sha1msg1_epu32(m_previous, m_current); \
+			m_after_next = _mm_xor_si128(m_after_next, m_current);
+
+			CL_SHA1_NI_ROUNDS(e0, e1, 0, message0, message1, message3, message2);
+			CL_SHA1_NI_ROUNDS(e1, e0, 1, message1, message2, message0, message3);
+			CL_SHA1_NI_ROUNDS(e0, e1, 1, message2, message3, message1, message0);
+			CL_SHA1_NI_ROUNDS(e1, e0, 1, message3, message0, message2, message1);
+			CL_SHA1_NI_ROUNDS(e0, e1, 1, message0, message1, message3, message2);
+			CL_SHA1_NI_ROUNDS(e1, e0, 1, message1, message2, message0, message3);
+			CL_SHA1_NI_ROUNDS(e0, e1, 2, message2, message3, message1, message0);
+			CL_SHA1_NI_ROUNDS(e1, e0, 2, message3, message0, message2, message1);
+			CL_SHA1_NI_ROUNDS(e0, e1, 2, message0, message1, message3, message2);
+			CL_SHA1_NI_ROUNDS(e1, e0, 2, message1, message2, message0, message3);
+			CL_SHA1_NI_ROUNDS(e0, e1, 2, message2, message3, message1, message0);
+			CL_SHA1_NI_ROUNDS(e1, e0, 3, message3, message0, message2, message1);
+			CL_SHA1_NI_ROUNDS(e0, e1, 3, message0, message1, message3, message2);
+#undef CL_SHA1_NI_ROUNDS
+
+			// Rounds 64 to 79
+			e1 = _mm_sha1nexte_epu32(e1, message1);
+			e0 = abcd;
+			message2 = _mm_sha1msg2_epu32(message2, message1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+			message3 = _mm_xor_si128(message3, message1);
+
+			e0 = _mm_sha1nexte_epu32(e0, message2);
+			e1 = abcd;
+			message3 = _mm_sha1msg2_epu32(message3, message2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+			e1 = _mm_sha1nexte_epu32(e1, message3);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+			e0 = _mm_sha1nexte_epu32(e0, saved_e0);
+			abcd = _mm_add_epi32(abcd, saved_abcd);
+		}
+
+		abcd = _mm_shuffle_epi32(abcd, 0x1B);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+		state[4] = _mm_extract_epi32(e0, 3);
+	}
+
+#else
+
+	void SHA_NI::sha1_process_blocks(uint32_t state[5], const unsigned char *data, int num_blocks)
+	{
+		throw Exception("SHA extensions are not available on this platform");
+	}
+
+	void SHA_NI::sha256_process_blocks(uint32_t state[8], const unsigned char *data, int num_blocks)
+	{
+		throw Exception("SHA extensions are not available on this platform");
+	}
+
+#endif
+}
@@ -0,0 +1,55 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+
+#if !defined(CL_DISABLE_SSE2) && !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_SHA_NI_AVAILABLE
+#endif
+
+namespace clan
+{
+	/// \brief SHA extensions (SHA-NI) accelerated SHA-1 and SHA-256 compression functions
+	///
+	/// The kernels are compiled for these instruction sets regardless of the compiler flags,
+	/// so callers must check is_supported() at runtime before using them.
+	class SHA_NI
+	{
+	public:
+		/// \brief Returns true if the CPU supports the SHA extensions
+		static bool is_supported();
+
+		/// \brief Compress 64 byte blocks into a SHA-1 state (h0 to h4)
+		static void sha1_process_blocks(uint32_t state[5], const unsigned char *data, int num_blocks);
+
+		/// \brief Compress 64 byte blocks into a SHA-256 state (h0 to h7)
+		static void sha256_process_blocks(uint32_t state[8], const unsigned char *data, int num_blocks);
+	};
+}
@@ -54,6 +54,10 @@ namespace clan
 			} while (next);
 		}
 
+		DirectoryListing_Impl(const std::vector<DirectoryListingEntry> &entries) : list_entries(entries), index(0)
+		{
+		}
+
 		~DirectoryListing_Impl()
 		{
 		}
@@ -105,6 +109,11 @@ namespace clan
 	{
 	}
 
+	DirectoryListing::DirectoryListing(const std::vector<DirectoryListingEntry> &entries)
+		: impl(std::make_shared<DirectoryListing_Impl>(entries))
+	{
+	}
+
 	DirectoryListing::DirectoryListing()
 	{
 		// NULL instance
@@ -33,17 +33,57 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/directory_listing.h"
+#include "API/Core/IOData/directory_listing_entry.h"
 #include "API/Core/Text/string_format.h"
 #include "file_system_provider_file.h"
 #include "file_system_provider_zip.h"
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
 
 namespace clan
 {
+	class FileSystemOverlay
+	{
+	public:
+		FileSystemOverlay(FileSystem fs, int priority) : fs(fs), priority(priority)
+		{
+		}
+
+		FileSystem fs;
+		int priority;
+	};
+
+	class FileSystemRoute
+	{
+	public:
+		enum Type
+		{
+			type_provider,
+			type_mount,
+			type_overlay
+		};
+
+		FileSystemRoute(Type type = type_provider, int index = 0) : type(type), index(index)
+		{
+		}
+
+		Type type;
+		int index;
+	};
+
+	class FileSystemCachedListing
+	{
+	public:
+		std::vector<DirectoryListingEntry> entries;
+		std::unordered_map<std::string, bool> is_directory;
+	};
+
 	class FileSystem_Impl
 	{
 		//! Construction:
 	public:
-		FileSystem_Impl() : provider(nullptr)
+		FileSystem_Impl() : provider(nullptr), cache_enabled(false)
 		{
 		}
 
@@ -57,6 +97,179 @@ namespace clan
 		FileSystemProvider *provider;
 
 		std::vector< std::pair<std::string, FileSystem> > mounts;
+
+		/// \brief Overlay layers, sorted in search order
+		std::vector<FileSystemOverlay> overlays;
+
+		bool cache_enabled;
+
+		std::mutex cache_mutex;
+
+		/// \brief Absolute filename to the mount, overlay or provider that serves it
+		std::unordered_map<std::string, FileSystemRoute> route_cache;
+
+		/// \brief Absolute directory path to its merged listing (null if the directory does not exist)
+		std::unordered_map<std::string, std::shared_ptr<FileSystemCachedListing> > listing_cache;
+
+		/// \brief Upper bound for route_cache before it is flushed
+		static const size_t max_cached_routes = 256 * 1024;
+
+		//! Operations:
+	public:
+		int find_mount(const std::string &path) const
+		{
+			int size = (int)mounts.size();
+			for (int index = 0; index < size; index++)
+			{
+				const std::string &mount_point = mounts[index].first;
+				if (path.compare(0, mount_point.length(), mount_point) == 0)
+					return index;
+			}
+			return -1;
+		}
+
+		FileSystemRoute find_route(const std::string &filename)
+		{
+			if (mounts.empty() && overlays.empty())
+				return FileSystemRoute();
+
+			{
+				std::unique_lock<std::mutex> lock(cache_mutex);
+				auto it = route_cache.find(filename);
+				if (it != route_cache.end())
+					return it->second;
+			}
+
+			FileSystemRoute route;
+			int mount_index = find_mount(filename);
+			if (mount_index != -1)
+			{
+				route = FileSystemRoute(FileSystemRoute::type_mount, mount_index);
+			}
+			else
+			{
+				int size = (int)overlays.size();
+				for (int index = 0; index < size; index++)
+				{
+					if (overlays[index].fs.impl->contains_file(filename))
+					{
+						route = FileSystemRoute(FileSystemRoute::type_overlay, index);
+						break;
+					}
+				}
+			}
+
+			// Overlay routes depend on the contents of the layers, so only keep those if caching is enabled
+			if (route.type == FileSystemRoute::type_mount || overlays.empty() || cache_enabled)
+			{
+				std::unique_lock<std::mutex> lock(cache_mutex);
+				if (route_cache.size() >= max_cached_routes)
+					route_cache.clear();
+				route_cache[filename] = route;
+			}
+
+			return route;
+		}
+
+		std::shared_ptr<FileSystemCachedListing> find_listing(const std::string &path)
+		{
+			int mount_index = find_mount(path);
+			if (mount_index != -1)
+				return mounts[mount_index].second.impl->find_listing("/" + path.substr(mounts[mount_index].first.length()));
+
+			if (cache_enabled)
+			{
+				std::unique_lock<std::mutex> lock(cache_mutex);
+				auto it = listing_cache.find(path);
+				if (it != listing_cache.end())
+					return it->second;
+			}
+
+			std::shared_ptr<FileSystemCachedListing> listing;
+			for (auto &overlay : overlays)
+				merge_listing(listing, overlay.fs.impl->find_listing(path).get());
+			if (provider)
+				merge_listing(listing, scan_provider(path).get());
+
+			if (cache_enabled)
+			{
+				std::unique_lock<std::mutex> lock(cache_mutex);
+				listing_cache[path] = listing;
+			}
+
+			return listing;
+		}
+
+		bool contains_file(const std::string &filename)
+		{
+			// Without a listing cache a single file is probed directly instead of scanning its directory
+			if (!cache_enabled)
+			{
+				int mount_index = find_mount(filename);
+				if (mount_index != -1)
+					return mounts[mount_index].second.impl->contains_file("/" + filename.substr(mounts[mount_index].first.length()));
+
+				for (auto &overlay : overlays)
+				{
+					if (overlay.fs.impl->contains_file(filename))
+						return true;
+				}
+
+				return provider && provider->file_exists(PathHelp::make_relative("/", filename, PathHelp::path_type_virtual));
+			}
+
+			std::shared_ptr<FileSystemCachedListing> listing = find_listing(PathHelp::get_fullpath(filename, PathHelp::path_type_virtual));
+			if (!listing)
+				return false;
+
+			auto it = listing->is_directory.find(PathHelp::get_filename(filename, PathHelp::path_type_virtual));
+			return it != listing->is_directory.end() && !it->second;
+		}
+
+		void invalidate_cache()
+		{
+			std::unique_lock<std::mutex> lock(cache_mutex);
+			route_cache.clear();
+			listing_cache.clear();
+		}
+
+	private:
+		std::shared_ptr<FileSystemCachedListing> scan_provider(const std::string &path)
+		{
+			std::shared_ptr<FileSystemCachedListing> listing;
+			if (provider->initialize_directory_listing(PathHelp::make_relative("/", path, PathHelp::path_type_virtual)))
+			{
+				listing = std::make_shared<FileSystemCachedListing>();
+				while (true)
+				{
+					DirectoryListingEntry entry;
+					if (!provider->next_file(entry))
+						break;
+					listing->is_directory[entry.get_filename()] = entry.is_directory();
+					listing->entries.push_back(entry);
+				}
+			}
+			return listing;
+		}
+
+		static void merge_listing(std::shared_ptr<FileSystemCachedListing> &dest, FileSystemCachedListing *src)
+		{
+			if (!src)
+				return;
+
+			if (!dest)
+			{
+				dest = std::make_shared<FileSystemCachedListing>(*src);
+				return;
+			}
+
+			// Entries of earlier layers hide those of later layers with the same name
+			for (auto &entry : src->entries)
+			{
+				if (dest->is_directory.insert(std::make_pair(entry.get_filename(), entry.is_directory())).second)
+					dest->entries.push_back(entry);
+			}
+		}
 	};
 
 	FileSystem::FileSystem()
@@ -110,30 +323,26 @@ namespace clan
 			path_rel,
 			PathHelp::path_type_virtual);
 
-		// First see if its a mount point:
-		int index, size;
-		size = (int)impl->mounts.size();
-		for (index = 0; index < size; index++)
+		// Without caching or layers there is nothing to merge, so list straight from the provider
+		if (!impl->cache_enabled && impl->overlays.empty() && impl->find_mount(path) == -1)
 		{
-			if (impl->mounts[index].first == path.substr(0, impl->mounts[index].first.length()))
+			if (impl->provider)
 			{
-				return impl->mounts[index].second.get_directory_listing(path.substr(impl->mounts[index].first.length(), path.length()));
+				return DirectoryListing(
+					impl->provider,
+					PathHelp::make_relative(
+					"/",
+					path,
+					PathHelp::path_type_virtual));
 			}
+			else
+				throw Exception(string_format("Unable to list directory: %1", path));
 		}
 
-		// Try open locally, if we got a file provider attached
-		if (impl->provider)
-		{
-			return DirectoryListing(
-				impl->provider,
-				PathHelp::make_relative(
-				"/",
-				path,
-				PathHelp::path_type_virtual));
-		}
-		else
+		std::shared_ptr<FileSystemCachedListing> listing = impl->find_listing(path);
+		if (!listing)
 			throw Exception(string_format("Unable to list directory: %1", path));
-
+		return DirectoryListing(listing->entries);
 	}
 
 	FileSystemProvider *FileSystem::get_provider()
@@ -161,6 +370,13 @@ namespace clan
 			internal_name += impl->mounts[index].second.get_identifier();
 		}
 
+		// Add on the overlay layers, in search order
+		for (auto &overlay : impl->overlays)
+		{
+			internal_name += "|";
+			internal_name += overlay.fs.get_identifier();
+		}
+
 		if (impl->provider)
 			internal_name = internal_name + impl->provider->get_identifier();
 
@@ -178,15 +394,19 @@ namespace clan
 			filename_rel,
 			PathHelp::path_type_virtual);
 
-		// First see if its a file for one of our mount points:
-		int index, size;
-		size = (int)impl->mounts.size();
-		for (index = 0; index < size; index++)
+		// Files created through this file system may change the cached listings
+		if (mode != File::open_existing && impl->cache_enabled)
+			impl->invalidate_cache();
+
+		FileSystemRoute route = impl->find_route(filename);
+		if (route.type == FileSystemRoute::type_mount)
 		{
-			if (impl->mounts[index].first == filename.substr(0, impl->mounts[index].first.length()))
-			{
-				return impl->mounts[index].second.open_file(filename.substr(impl->mounts[index].first.length(), filename.length()));
-			}
+			const std::pair<std::string, FileSystem> &mount = impl->mounts[route.index];
+			return mount.second.open_file(filename.substr(mount.first.length(), filename.length()), mode, access, share, flags);
+		}
+		else if (route.type == FileSystemRoute::type_overlay)
+		{
+			return impl->overlays[route.index].fs.open_file(filename, mode, access, share, flags);
 		}
 
 		// Try open locally, if we got a file provider attached
@@ -213,6 +433,7 @@ namespace clan
 			PathHelp::path_type_virtual),
 			PathHelp::path_type_virtual);
 		impl->mounts.push_back(std::pair<std::string, FileSystem>(mount_point_slash, fs));
+		impl->invalidate_cache();
 	}
 
 	void FileSystem::mount(const std::string &mount_point, const std::string &path, bool is_zip_file)
@@ -242,6 +463,55 @@ namespace clan
 				index--;
 			}
 		}
+		impl->invalidate_cache();
+	}
+
+	void FileSystem::mount_overlay(FileSystem fs, int priority)
+	{
+		if (fs.is_null())
+			throw Exception("Cannot mount a null file system as overlay");
+
+		// Insert before the first layer with the same or a lower priority, so newer layers are searched first
+		auto it = std::find_if(impl->overlays.begin(), impl->overlays.end(), [&](const FileSystemOverlay &overlay) { return overlay.priority <= priority; });
+		impl->overlays.insert(it, FileSystemOverlay(fs, priority));
+		impl->invalidate_cache();
+	}
+
+	void FileSystem::mount_overlay(const std::string &path, bool is_zip_file, int priority)
+	{
+		if (is_zip_file)
+			mount_overlay(FileSystem(new FileSystemProvider_Zip(ZipArchive(path))), priority);
+		else
+			mount_overlay(FileSystem(new FileSystemProvider_File(path)), priority);
+	}
+
+	void FileSystem::unmount_overlay(FileSystem fs)
+	{
+		impl->overlays.erase(
+			std::remove_if(impl->overlays.begin(), impl->overlays.end(), [&](const FileSystemOverlay &overlay) { return overlay.fs.impl == fs.impl; }),
+			impl->overlays.end());
+		impl->invalidate_cache();
+	}
+
+	void FileSystem::set_cache_enabled(bool enable)
+	{
+		impl->cache_enabled = enable;
+		impl->invalidate_cache();
+	}
+
+	bool FileSystem::is_cache_enabled() const
+	{
+		return impl->cache_enabled;
+	}
+
+	void FileSystem::invalidate_cache()
+	{
+		impl->invalidate_cache();
+
+		for (auto &mount : impl->mounts)
+			mount.second.invalidate_cache();
+		for (auto &overlay : impl->overlays)
+			overlay.fs.invalidate_cache();
 	}
 
 	bool FileSystem::has_directory(const std::string &directory)
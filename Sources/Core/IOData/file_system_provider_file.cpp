@@ -32,6 +32,11 @@
 #include "API/Core/IOData/file.h"
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/directory_listing_entry.h"
+#include "API/Core/Text/string_help.h"
+
+#ifndef WIN32
+#include <sys/stat.h>
+#endif
 
 namespace clan
 {
@@ -83,4 +88,15 @@ namespace clan
 
 		return next;
 	}
+
+	bool FileSystemProvider_File::file_exists(const std::string &filename)
+	{
+#ifdef WIN32
+		DWORD attributes = GetFileAttributes(StringHelp::utf8_to_ucs2(path + filename).c_str());
+		return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+#else
+		struct stat file_info;
+		return stat((path + filename).c_str(), &file_info) == 0 && !S_ISDIR(file_info.st_mode);
+#endif
+	}
 }
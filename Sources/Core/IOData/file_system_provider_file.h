@@ -63,6 +63,8 @@ namespace clan
 
 		bool next_file(DirectoryListingEntry &entry) override;
 
+		bool file_exists(const std::string &filename) override;
+
 	private:
 		std::string path;
 		DirectoryScanner dir_scanner;
@@ -341,6 +341,11 @@ namespace clan
 		impl->exptmod(b->impl.get(), m->impl.get(), c->impl.get());
 	}
 
+	void BigInt::exptmod_secret(const BigInt *b, const BigInt *m, BigInt *c) const
+	{
+		impl->exptmod(b->impl.get(), m->impl.get(), c->impl.get(), true);
+	}
+
 	bool BigInt::fermat(uint32_t w) const
 	{
 		return impl->fermat(w);
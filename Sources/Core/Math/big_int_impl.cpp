@@ -47,6 +47,7 @@
 
 #include "Core/precomp.h"
 #include "big_int_impl.h"
+#include "big_int_montgomery.h"
 #include "API/Core/Math/big_int.h"
 #include <cstdlib>
 
@@ -1599,8 +1600,30 @@ namespace clan
 		tmp_impl.internal_exch(this);
 	}
 
-	void BigInt_Impl::exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	void BigInt_Impl::exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c, bool constant_time) const
 	{
+		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
+			throw Exception("Divide by zero");
+
+		if (m->isodd())
+		{
+			BigInt_Montgomery montgomery(m->digits, m->digits_used);
+
+			// The conversion to Montgomery form accepts any base below m*R, only larger (or negative) values need the division
+			BigInt_Impl x(*this);
+			if (x.digits_negative || x.significant_bits() >= montgomery.get_num_limbs() * 64 + m->significant_bits())
+				x.mod(m, &x);
+
+			std::vector<uint32_t> result;
+			montgomery.exptmod(x.digits, x.digits_used, b->digits, b->digits_used, constant_time, result);
+
+			c->zero();
+			c->internal_pad(result.size());
+			memcpy(c->digits, result.data(), result.size() * sizeof(uint32_t));
+			c->internal_clamp();
+			return;
+		}
+
 		BigInt_Impl s, mu;
 		uint32_t d;
 		const uint32_t *db = b->digits;
@@ -1608,9 +1631,6 @@ namespace clan
 		unsigned int  ub = b->digits_used;
 		unsigned int dig, bit;
 
-		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
-			throw Exception("Divide by zero");
-
 		BigInt_Impl x(*this);
 
 		x.mod(m, &x);
@@ -81,7 +81,7 @@ namespace clan
 		void get(int32_t &d);
 		void get(uint64_t &d);
 		void get(int64_t &d);
-		void exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const;
+		void exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c, bool constant_time = false) const;
 		void mod(const BigInt_Impl *m, BigInt_Impl *c) const;
 		void div(const BigInt_Impl *b, BigInt_Impl *q, BigInt_Impl *r) const;
 		void add(const BigInt_Impl *b, BigInt_Impl *c) const;
@@ -0,0 +1,484 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "big_int_montgomery.h"
+#include "API/Core/System/exception.h"
+
+namespace clan
+{
+	namespace
+	{
+#if defined(__SIZEOF_INT128__)
+		typedef unsigned __int128 uint128_type;
+
+		// Returns the low half of a * b + c + d and stores the high half in out_high (this cannot overflow)
+		inline uint64_t mul_add(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t &out_high)
+		{
+			uint128_type p = (uint128_type)a * b + c + d;
+			out_high = (uint64_t)(p >> 64);
+			return (uint64_t)p;
+		}
+#else
+		inline uint64_t mul_add(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t &out_high)
+		{
+			uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+			uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+			uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+			uint64_t middle = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff);
+			uint64_t low = (middle << 32) | (p0 & 0xffffffff);
+			uint64_t high = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+			low += c;
+			high += (low < c);
+			low += d;
+			high += (low < d);
+			out_high = high;
+			return low;
+		}
+#endif
+
+		// a + b + carry, with carry in and out being 0 or 1
+		inline uint64_t add_carry(uint64_t a, uint64_t b, uint64_t &carry)
+		{
+			uint64_t s = a + b;
+			uint64_t c1 = s < a;
+			uint64_t r = s + carry;
+			carry = c1 | (r < s);
+			return r;
+		}
+
+		// a - b - borrow, with borrow in and out being 0 or 1
+		inline uint64_t sub_borrow(uint64_t a, uint64_t b, uint64_t &borrow)
+		{
+			uint64_t d = a - b;
+			uint64_t b1 = a < b;
+			uint64_t r = d - borrow;
+			borrow = b1 | (d < borrow);
+			return r;
+		}
+
+		// out[0..k) = |x - y|, where x has xn <= k limbs and y has k limbs. Returns all ones if x < y, otherwise zero
+		uint64_t abs_diff(const uint64_t *x, int xn, const uint64_t *y, int k, uint64_t *out)
+		{
+			uint64_t borrow = 0;
+			int i;
+			for (i = 0; i < xn; i++)
+				out[i] = sub_borrow(x[i], y[i], borrow);
+			for (; i < k; i++)
+				out[i] = sub_borrow(0, y[i], borrow);
+
+			// Conditionally negate (two's complement) without branching on the result
+			uint64_t mask = 0 - borrow;
+			uint64_t carry = borrow;
+			for (i = 0; i < k; i++)
+				out[i] = add_carry(out[i] ^ mask, 0, carry);
+			return mask;
+		}
+
+		// Karatsuba recombination. out holds z0 = a0*b0 in [0..2h) and z2 = a1*b1 in [2h..2h+2k), d = |a0-a1| * |b0-b1|.
+		// Adds z1 = z0 + z2 -/+ d at limb h, adding d when the product of the differences was negative
+		void karatsuba_combine(uint64_t *out, int h, int k, const uint64_t *d, uint64_t negative_mask, uint64_t *t)
+		{
+			uint64_t carry = 0;
+			int i;
+			for (i = 0; i < 2 * h; i++)
+				t[i] = add_carry(out[i], out[2 * h + i], carry);
+			for (; i < 2 * k; i++)
+				t[i] = add_carry(0, out[2 * h + i], carry);
+			t[2 * k] = carry;
+
+			uint64_t add_c = 0, sub_b = 0;
+			for (i = 0; i < 2 * k; i++)
+			{
+				uint64_t sum = add_carry(t[i], d[i], add_c);
+				uint64_t difference = sub_borrow(t[i], d[i], sub_b);
+				t[i] = (sum & negative_mask) | (difference & ~negative_mask);
+			}
+			uint64_t sum = t[2 * k] + add_c;
+			uint64_t difference = t[2 * k] - sub_b;
+			t[2 * k] = (sum & negative_mask) | (difference & ~negative_mask);
+
+			// The sum fits in the 2n limbs of out, so t[2k] only carries into limbs that exist
+			carry = 0;
+			int size = 2 * (h + k);
+			for (i = 0; i < 2 * k + 1; i++)
+				out[h + i] = add_carry(out[h + i], t[i], carry);
+			for (i += h; i < size; i++)
+				out[i] = add_carry(out[i], 0, carry);
+		}
+
+		inline unsigned int get_bit(const uint32_t *digits, unsigned int digits_used, int bit)
+		{
+			unsigned int digit = bit / 32;
+			if (digit >= digits_used)
+				return 0;
+			return (digits[digit] >> (bit % 32)) & 1;
+		}
+	}
+
+	BigInt_Montgomery::BigInt_Montgomery(const uint32_t *modulus_digits, unsigned int modulus_digits_used)
+	{
+		num_limbs = (modulus_digits_used + 1) / 2;
+		const int n = num_limbs;
+
+		modulus.assign(n, 0);
+		for (unsigned int i = 0; i < modulus_digits_used; i++)
+			modulus[i / 2] |= ((uint64_t)modulus_digits[i]) << (32 * (i & 1));
+
+		if ((modulus[0] & 1) == 0)
+			throw Exception("Montgomery reduction requires an odd modulus");
+
+		// Newton iteration for m^-1 (mod 2^64). Each step doubles the number of correct bits, starting from 3 (x*x == 1 mod 8 for odd x)
+		uint64_t inv = modulus[0];
+		for (int i = 0; i < 5; i++)
+			inv *= 2 - modulus[0] * inv;
+		m0_inv = 0 - inv;
+
+		product.assign(2 * n, 0);
+		scratch.assign(get_scratch_size(n) + 1, 0);
+		r2.assign(n, 0);
+		one.assign(n, 0);
+
+		int top_limb = n - 1;
+		while (top_limb > 0 && modulus[top_limb] == 0)
+			top_limb--;
+		int modulus_bits = top_limb * 64;
+		for (uint64_t v = modulus[top_limb]; v; v >>= 1)
+			modulus_bits++;
+
+		if (modulus_bits == 1)	// m == 1, everything is zero
+			return;
+
+		// Start at 2^(modulus_bits-1), which is below m, and double up to 2^n * R (mod m).
+		// Six Montgomery squarings then turn 2^n * R into 2^(64*n) * R = R^2 (mod m)
+		r2[(modulus_bits - 1) / 64] = ((uint64_t)1) << ((modulus_bits - 1) % 64);
+		std::vector<uint64_t> reduced(n);
+		for (int bit = modulus_bits - 1; bit < 64 * n + n; bit++)
+		{
+			uint64_t top = r2[n - 1] >> 63;
+			for (int i = n - 1; i > 0; i--)
+				r2[i] = (r2[i] << 1) | (r2[i - 1] >> 63);
+			r2[0] <<= 1;
+
+			uint64_t borrow = 0;
+			for (int i = 0; i < n; i++)
+				reduced[i] = sub_borrow(r2[i], modulus[i], borrow);
+			uint64_t keep_mask = 0 - (top | (borrow ^ 1));
+			for (int i = 0; i < n; i++)
+				r2[i] = (reduced[i] & keep_mask) | (r2[i] & ~keep_mask);
+		}
+		for (int i = 0; i < 6; i++)
+			mont_sqr(r2.data(), r2.data());
+
+		// R (mod m) is the Montgomery form of 1
+		std::fill(product.begin(), product.end(), 0);
+		std::copy(r2.begin(), r2.end(), product.begin());
+		reduce(product.data(), one.data());
+	}
+
+	void BigInt_Montgomery::exptmod(const uint32_t *base_digits, unsigned int base_digits_used, const uint32_t *exponent_digits, unsigned int exponent_digits_used, bool constant_time, std::vector<uint32_t> &out_digits)
+	{
+		const int n = num_limbs;
+		if (base_digits_used > (unsigned int)(4 * n))
+			throw Exception("Base is too large for the Montgomery reduction");
+
+		// Convert the base to Montgomery form. reduce() takes it to base * R^-1, then a multiplication by R^3 gives base * R
+		std::vector<uint64_t> base(n), r3(n), acc(n);
+		std::fill(product.begin(), product.end(), 0);
+		for (unsigned int i = 0; i < base_digits_used; i++)
+			product[i / 2] |= ((uint64_t)base_digits[i]) << (32 * (i & 1));
+		reduce(product.data(), base.data());
+		mont_mul(r2.data(), r2.data(), r3.data());
+		mont_mul(base.data(), r3.data(), base.data());
+
+		int exponent_bits = exponent_digits_used * 32;
+		while (exponent_bits > 0 && get_bit(exponent_digits, exponent_digits_used, exponent_bits - 1) == 0)
+			exponent_bits--;
+
+		if (constant_time)
+			exptmod_fixed_window(base.data(), exponent_digits, exponent_digits_used, exponent_bits, acc.data());
+		else
+			exptmod_sliding_window(base.data(), exponent_digits, exponent_digits_used, exponent_bits, acc.data());
+
+		// Convert out of Montgomery form
+		std::fill(product.begin(), product.end(), 0);
+		std::copy(acc.begin(), acc.end(), product.begin());
+		reduce(product.data(), acc.data());
+
+		out_digits.resize(2 * n);
+		for (int i = 0; i < n; i++)
+		{
+			out_digits[2 * i] = (uint32_t)acc[i];
+			out_digits[2 * i + 1] = (uint32_t)(acc[i] >> 32);
+		}
+	}
+
+	void BigInt_Montgomery::exptmod_fixed_window(const uint64_t *base, const uint32_t *exponent_digits, unsigned int exponent_digits_used, int exponent_bits, uint64_t *acc)
+	{
+		const int n = num_limbs;
+		int window = exponent_bits > 256 ? 5 : (exponent_bits > 32 ? 4 : 2);
+		int table_size = 1 << window;
+
+		// table[i] = base^i, in Montgomery form
+		std::vector<uint64_t> table(table_size * n);
+		std::copy(one.begin(), one.end(), table.begin());
+		std::copy(base, base + n, table.begin() + n);
+		for (int i = 2; i < table_size; i++)
+			mont_mul(&table[(i - 1) * n], base, &table[i * n]);
+
+		std::vector<uint64_t> entry(n);
+		std::copy(one.begin(), one.end(), acc);
+
+		int num_windows = (exponent_bits + window - 1) / window;
+		for (int w = num_windows - 1; w >= 0; w--)
+		{
+			if (w != num_windows - 1)
+			{
+				for (int i = 0; i < window; i++)
+					mont_sqr(acc, acc);
+			}
+
+			unsigned int index = 0;
+			for (int i = window - 1; i >= 0; i--)
+				index = (index << 1) | get_bit(exponent_digits, exponent_digits_used, w * window + i);
+
+			// Scan the whole table, so the memory access pattern does not depend on the index
+			std::fill(entry.begin(), entry.end(), 0);
+			for (int i = 0; i < table_size; i++)
+			{
+				uint64_t mask = 0 - ((((uint64_t)(i ^ index)) - 1) >> 63);
+				const uint64_t *src = &table[i * n];
+				for (int j = 0; j < n; j++)
+					entry[j] |= src[j] & mask;
+			}
+
+			mont_mul(acc, entry.data(), acc);
+		}
+	}
+
+	void BigInt_Montgomery::exptmod_sliding_window(const uint64_t *base, const uint32_t *exponent_digits, unsigned int exponent_digits_used, int exponent_bits, uint64_t *acc)
+	{
+		const int n = num_limbs;
+		int window = exponent_bits > 671 ? 6 : (exponent_bits > 239 ? 5 : (exponent_bits > 79 ? 4 : (exponent_bits > 23 ? 3 : 1)));
+
+		// table[i] = base^(2*i+1), in Montgomery form
+		int table_size = 1 << (window - 1);
+		std::vector<uint64_t> table(table_size * n);
+		std::copy(base, base + n, table.begin());
+		if (table_size > 1)
+		{
+			std::vector<uint64_t> base_squared(n);
+			mont_sqr(base, base_squared.data());
+			for (int i = 1; i < table_size; i++)
+				mont_mul(&table[(i - 1) * n], base_squared.data(), &table[i * n]);
+		}
+
+		std::copy(one.begin(), one.end(), acc);
+		bool started = false;
+
+		int bit = exponent_bits - 1;
+		while (bit >= 0)
+		{
+			if (!get_bit(exponent_digits, exponent_digits_used, bit))
+			{
+				if (started)
+					mont_sqr(acc, acc);
+				bit--;
+				continue;
+			}
+
+			// Find the longest window (up to the window size) that starts and ends with a set bit
+			int low_bit = bit - window + 1;
+			if (low_bit < 0)
+				low_bit = 0;
+			while (!get_bit(exponent_digits, exponent_digits_used, low_bit))
+				low_bit++;
+
+			unsigned int value = 0;
+			for (int i = bit; i >= low_bit; i--)
+				value = (value << 1) | get_bit(exponent_digits, exponent_digits_used, i);
+
+			if (started)
+			{
+				for (int i = low_bit; i <= bit; i++)
+					mont_sqr(acc, acc);
+				mont_mul(acc, &table[(value >> 1) * n], acc);
+			}
+			else
+			{
+				std::copy(&table[(value >> 1) * n], &table[(value >> 1) * n] + n, acc);
+				started = true;
+			}
+
+			bit = low_bit - 1;
+		}
+	}
+
+	void BigInt_Montgomery::mont_mul(const uint64_t *a, const uint64_t *b, uint64_t *out)
+	{
+		mul(a, b, product.data(), num_limbs, scratch.data());
+		reduce(product.data(), out);
+	}
+
+	void BigInt_Montgomery::mont_sqr(const uint64_t *a, uint64_t *out)
+	{
+		sqr(a, product.data(), num_limbs, scratch.data());
+		reduce(product.data(), out);
+	}
+
+	void BigInt_Montgomery::reduce(uint64_t *t, uint64_t *out)
+	{
+		const int n = num_limbs;
+		const uint64_t *m = modulus.data();
+
+		// Add multiples of m to clear the low limbs one at a time. extra holds the carry out of the top limb
+		uint64_t extra = 0;
+		for (int i = 0; i < n; i++)
+		{
+			uint64_t u = t[i] * m0_inv;
+			uint64_t carry = 0;
+			for (int j = 0; j < n; j++)
+				t[i + j] = mul_add(u, m[j], t[i + j], carry, carry);
+			t[i + n] = add_carry(t[i + n], carry, extra);
+		}
+
+		// The result t[n..2n) + extra * R is less than 2m, subtract m once without branching on the value
+		uint64_t borrow = 0;
+		for (int i = 0; i < n; i++)
+			out[i] = sub_borrow(t[n + i], m[i], borrow);
+		uint64_t keep_mask = 0 - (extra | (borrow ^ 1));
+		for (int i = 0; i < n; i++)
+			out[i] = (out[i] & keep_mask) | (t[n + i] & ~keep_mask);
+	}
+
+	int BigInt_Montgomery::get_scratch_size(int n)
+	{
+		if (n < karatsuba_threshold && n < karatsuba_sqr_threshold)
+			return 0;
+		int k = n - n / 2;
+		return 6 * k + 1 + get_scratch_size(k);
+	}
+
+	void BigInt_Montgomery::mul(const uint64_t *a, const uint64_t *b, uint64_t *out, int n, uint64_t *scratch)
+	{
+		if (n < karatsuba_threshold)
+		{
+			mul_schoolbook(a, b, out, n);
+			return;
+		}
+
+		// a = a1 * B^h + a0, b = b1 * B^h + b0
+		// a * b = z2 * B^2h + (z0 + z2 - (a0 - a1) * (b0 - b1)) * B^h + z0
+		int h = n / 2;
+		int k = n - h;
+		uint64_t *diff_a = scratch;
+		uint64_t *diff_b = scratch + k;
+		uint64_t *diff_product = scratch + 2 * k;
+		uint64_t *t = scratch + 4 * k;
+		uint64_t *next = scratch + 6 * k + 1;
+
+		mul(a, b, out, h, next);
+		mul(a + h, b + h, out + 2 * h, k, next);
+
+		uint64_t negative_mask = abs_diff(a, h, a + h, k, diff_a) ^ abs_diff(b, h, b + h, k, diff_b);
+		mul(diff_a, diff_b, diff_product, k, next);
+
+		karatsuba_combine(out, h, k, diff_product, negative_mask, t);
+	}
+
+	void BigInt_Montgomery::sqr(const uint64_t *a, uint64_t *out, int n, uint64_t *scratch)
+	{
+		if (n < karatsuba_sqr_threshold)
+		{
+			sqr_schoolbook(a, out, n);
+			return;
+		}
+
+		int h = n / 2;
+		int k = n - h;
+		uint64_t *diff_a = scratch;
+		uint64_t *diff_product = scratch + 2 * k;
+		uint64_t *t = scratch + 4 * k;
+		uint64_t *next = scratch + 6 * k + 1;
+
+		sqr(a, out, h, next);
+		sqr(a + h, out + 2 * h, k, next);
+
+		abs_diff(a, h, a + h, k, diff_a);
+		sqr(diff_a, diff_product, k, next);
+
+		karatsuba_combine(out, h, k, diff_product, 0, t);
+	}
+
+	void BigInt_Montgomery::mul_schoolbook(const uint64_t *a, const uint64_t *b, uint64_t *out, int n)
+	{
+		for (int i = 0; i < 2 * n; i++)
+			out[i] = 0;
+
+		for (int i = 0; i < n; i++)
+		{
+			uint64_t carry = 0;
+			for (int j = 0; j < n; j++)
+				out[i + j] = mul_add(a[i], b[j], out[i + j], carry, carry);
+			out[i + n] = carry;
+		}
+	}
+
+	void BigInt_Montgomery::sqr_schoolbook(const uint64_t *a, uint64_t *out, int n)
+	{
+		for (int i = 0; i < 2 * n; i++)
+			out[i] = 0;
+
+		// Cross products a[i]*a[j] for i < j, which appear twice in the square
+		for (int i = 0; i < n - 1; i++)
+		{
+			uint64_t carry = 0;
+			for (int j = i + 1; j < n; j++)
+				out[i + j] = mul_add(a[i], a[j], out[i + j], carry, carry);
+			out[i + n] = carry;
+		}
+
+		uint64_t top = 0;
+		for (int i = 0; i < 2 * n; i++)
+		{
+			uint64_t v = out[i];
+			out[i] = (v << 1) | top;
+			top = v >> 63;
+		}
+
+		// Add the squares on the diagonal
+		uint64_t carry = 0;
+		for (int i = 0; i < n; i++)
+		{
+			uint64_t high;
+			out[2 * i] = mul_add(a[i], a[i], out[2 * i], carry, high);
+			carry = 0;
+			out[2 * i + 1] = add_carry(out[2 * i + 1], high, carry);
+		}
+	}
+}
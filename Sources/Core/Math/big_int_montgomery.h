@@ -0,0 +1,96 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+#include <vector>
+
+namespace clan
+{
+	/// \brief Montgomery arithmetic on 64-bit limbs, used by BigInt_Impl::exptmod() for odd moduli
+	///
+	/// Numbers are little endian limb arrays of the modulus size (n limbs). A value x is kept in
+	/// Montgomery form as x*R (mod m), where R = 2^(64*n), so that each modular multiplication only
+	/// needs a product followed by a reduction, without any division.
+	class BigInt_Montgomery
+	{
+	public:
+		/// \brief Prepare the reduction constants for an odd modulus, given as little endian 32-bit digits
+		BigInt_Montgomery(const uint32_t *modulus_digits, unsigned int modulus_digits_used);
+
+		/// \brief Compute out_digits = base ^ exponent (mod m)
+		///
+		/// The base must be less than m*R (any base with fewer significant bits than 64*n plus the modulus bit length will do)
+		///
+		/// When constant_time is set, a fixed window is used and the table lookups scan every entry, so the sequence
+		/// of operations and memory accesses only depends on the bit length of the exponent. Otherwise a sliding window is used.
+		void exptmod(const uint32_t *base_digits, unsigned int base_digits_used, const uint32_t *exponent_digits, unsigned int exponent_digits_used, bool constant_time, std::vector<uint32_t> &out_digits);
+
+		/// \brief Number of 64-bit limbs in the modulus
+		int get_num_limbs() const { return num_limbs; }
+
+		/// \brief Compute out[0..2n) = a[0..n) * b[0..n)
+		///
+		/// Uses Karatsuba multiplication at and above karatsuba_threshold limbs. scratch must hold get_scratch_size(n) limbs
+		static void mul(const uint64_t *a, const uint64_t *b, uint64_t *out, int n, uint64_t *scratch);
+
+		/// \brief Compute out[0..2n) = a[0..n) ^ 2
+		///
+		/// Uses Karatsuba squaring at and above karatsuba_sqr_threshold limbs
+		static void sqr(const uint64_t *a, uint64_t *out, int n, uint64_t *scratch);
+
+		/// \brief Number of scratch limbs needed by mul() and sqr()
+		static int get_scratch_size(int n);
+
+		// Measured crossover points. The schoolbook squaring only needs half the products, so Karatsuba pays off later
+		static const int karatsuba_threshold = 40;
+		static const int karatsuba_sqr_threshold = 64;
+
+	private:
+		void mont_mul(const uint64_t *a, const uint64_t *b, uint64_t *out);
+		void mont_sqr(const uint64_t *a, uint64_t *out);
+
+		// Montgomery reduction of t[0..2n), out = t * R^-1 (mod m). Destroys t
+		void reduce(uint64_t *t, uint64_t *out);
+
+		void exptmod_fixed_window(const uint64_t *base, const uint32_t *exponent_digits, unsigned int exponent_digits_used, int exponent_bits, uint64_t *acc);
+		void exptmod_sliding_window(const uint64_t *base, const uint32_t *exponent_digits, unsigned int exponent_digits_used, int exponent_bits, uint64_t *acc);
+
+		static void mul_schoolbook(const uint64_t *a, const uint64_t *b, uint64_t *out, int n);
+		static void sqr_schoolbook(const uint64_t *a, uint64_t *out, int n);
+
+		int num_limbs;
+		uint64_t m0_inv;				// -m^-1 (mod 2^64)
+		std::vector<uint64_t> modulus;
+		std::vector<uint64_t> one;		// R (mod m)
+		std::vector<uint64_t> r2;		// R^2 (mod m)
+		std::vector<uint64_t> product;	// 2n limbs
+		std::vector<uint64_t> scratch;
+	};
+}
@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/pcg32.h"
+#include <cmath>
+
+namespace clan
+{
+	PCG32::PCG32(uint64_t seed, uint64_t stream) : state(0), increment((stream << 1) | 1)
+	{
+		next();
+		state += seed;
+		next();
+	}
+
+	int PCG32::next_int(int min, int max)
+	{
+		uint64_t range = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+		if (range > 0xffffffffULL)
+			return (int)next();
+
+		// Lemire's nearly divisionless method, rejecting the few values that would cause a bias
+		uint64_t product = (uint64_t)next() * range;
+		uint32_t low = (uint32_t)product;
+		if (low < range)
+		{
+			uint32_t threshold = (uint32_t)(0 - (uint32_t)range) % (uint32_t)range;
+			while (low < threshold)
+			{
+				product = (uint64_t)next() * range;
+				low = (uint32_t)product;
+			}
+		}
+		return (int)((int64_t)min + (int64_t)(product >> 32));
+	}
+
+	float PCG32::next_normal(float mean, float standard_deviation)
+	{
+		// Box-Muller transform. 1 - u keeps the logarithm finite
+		double u1 = 1.0 - next_double();
+		double u2 = next_double();
+		return mean + standard_deviation * (float)(std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2));
+	}
+
+	void PCG32::advance(uint64_t delta)
+	{
+		// Brown's algorithm, applying the LCG step as repeated squaring of the affine transform
+		uint64_t acc_mult = 1;
+		uint64_t acc_plus = 0;
+		uint64_t cur_mult = multiplier;
+		uint64_t cur_plus = increment;
+		while (delta > 0)
+		{
+			if (delta & 1)
+			{
+				acc_mult *= cur_mult;
+				acc_plus = acc_plus * cur_mult + cur_plus;
+			}
+			cur_plus = (cur_mult + 1) * cur_plus;
+			cur_mult *= cur_mult;
+			delta >>= 1;
+		}
+		state = acc_mult * state + acc_plus;
+	}
+
+	PCG32 PCG32::split()
+	{
+		uint64_t seed = next();
+		seed = (seed << 32) | next();
+		uint64_t stream = next();
+		stream = (stream << 32) | next();
+		return PCG32(seed, stream);
+	}
+
+	void PCG32::fill_uint32(uint32_t *out, int count)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = next();
+	}
+
+	void PCG32::fill_float(float *out, int count, float min, float max)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = next_float(min, max);
+	}
+
+	void PCG32::fill_int(int *out, int count, int min, int max)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = next_int(min, max);
+	}
+}
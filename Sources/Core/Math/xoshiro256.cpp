@@ -0,0 +1,349 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/xoshiro256.h"
+#include "API/Core/System/system.h"
+#include <cstring>
+
+#if !defined(CL_DISABLE_SSE2) && !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_XOSHIRO_SIMD_AVAILABLE
+#include <immintrin.h>
+
+// Allow the intrinsics in these functions without enabling the instruction set for the whole build
+#if defined(__GNUC__)
+#define CL_XOSHIRO_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CL_XOSHIRO_AVX2_TARGET
+#endif
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		const int fill_chunk_size = 256;
+
+		const uint64_t jump_polynomial[4] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+		const uint64_t long_jump_polynomial[4] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+
+#ifndef CL_XOSHIRO_SIMD_AVAILABLE
+
+		// Generate num_blocks times eight 32 bit numbers, one 64 bit number from each of the four lanes per step
+		void xoshiro_generate_scalar(uint64_t lanes[4][4], uint32_t *out, int num_blocks)
+		{
+			for (int block = 0; block < num_blocks; block++)
+			{
+				for (int lane = 0; lane < 4; lane++)
+				{
+					uint64_t s0 = lanes[0][lane], s1 = lanes[1][lane], s2 = lanes[2][lane], s3 = lanes[3][lane];
+					uint64_t x = s1 * 5;
+					x = ((x << 7) | (x >> 57)) * 9;
+					uint64_t t = s1 << 17;
+					s2 ^= s0;
+					s3 ^= s1;
+					s1 ^= s2;
+					s0 ^= s3;
+					s2 ^= t;
+					s3 = (s3 << 45) | (s3 >> 19);
+					lanes[0][lane] = s0;
+					lanes[1][lane] = s1;
+					lanes[2][lane] = s2;
+					lanes[3][lane] = s3;
+					out[lane * 2] = (uint32_t)x;
+					out[lane * 2 + 1] = (uint32_t)(x >> 32);
+				}
+				out += 8;
+			}
+		}
+#else
+		inline __m128i xoshiro_rotate_left(__m128i value, int shift)
+		{
+			return _mm_or_si128(_mm_slli_epi64(value, shift), _mm_srli_epi64(value, 64 - shift));
+		}
+
+		// SSE2 has no 64 bit multiply, but multiplying by 5 and 9 only needs a shift and an add
+		void xoshiro_generate_sse2(uint64_t lanes[4][4], uint32_t *out, int num_blocks)
+		{
+			for (int half = 0; half < 2; half++)
+			{
+				__m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lanes[0][half * 2]));
+				__m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lanes[1][half * 2]));
+				__m128i s2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lanes[2][half * 2]));
+				__m128i s3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lanes[3][half * 2]));
+
+				uint32_t *dest = out + half * 4;
+				for (int block = 0; block < num_blocks; block++)
+				{
+					__m128i x = _mm_add_epi64(_mm_slli_epi64(s1, 2), s1);
+					x = xoshiro_rotate_left(x, 7);
+					x = _mm_add_epi64(_mm_slli_epi64(x, 3), x);
+					__m128i t = _mm_slli_epi64(s1, 17);
+					s2 = _mm_xor_si128(s2, s0);
+					s3 = _mm_xor_si128(s3, s1);
+					s1 = _mm_xor_si128(s1, s2);
+					s0 = _mm_xor_si128(s0, s3);
+					s2 = _mm_xor_si128(s2, t);
+					s3 = xoshiro_rotate_left(s3, 45);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), x);
+					dest += 8;
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&lanes[0][half * 2]), s0);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&lanes[1][half * 2]), s1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&lanes[2][half * 2]), s2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&lanes[3][half * 2]), s3);
+			}
+		}
+
+		inline CL_XOSHIRO_AVX2_TARGET __m256i xoshiro_rotate_left(__m256i value, int shift)
+		{
+			return _mm256_or_si256(_mm256_slli_epi64(value, shift), _mm256_srli_epi64(value, 64 - shift));
+		}
+
+		CL_XOSHIRO_AVX2_TARGET void xoshiro_generate_avx2(uint64_t lanes[4][4], uint32_t *out, int num_blocks)
+		{
+			__m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes[0]));
+			__m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes[1]));
+			__m256i s2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes[2]));
+			__m256i s3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes[3]));
+
+			for (int block = 0; block < num_blocks; block++)
+			{
+				__m256i x = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+				x = xoshiro_rotate_left(x, 7);
+				x = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+				__m256i t = _mm256_slli_epi64(s1, 17);
+				s2 = _mm256_xor_si256(s2, s0);
+				s3 = _mm256_xor_si256(s3, s1);
+				s1 = _mm256_xor_si256(s1, s2);
+				s0 = _mm256_xor_si256(s0, s3);
+				s2 = _mm256_xor_si256(s2, t);
+				s3 = xoshiro_rotate_left(s3, 45);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), x);
+				out += 8;
+			}
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[0]), s0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[1]), s1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[2]), s2);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[3]), s3);
+		}
+#endif
+
+		void xoshiro_generate(uint64_t lanes[4][4], uint32_t *out, int num_blocks)
+		{
+#ifdef CL_XOSHIRO_SIMD_AVAILABLE
+			static bool avx2 = System::detect_cpu_extension(System::avx2);
+			if (avx2)
+				xoshiro_generate_avx2(lanes, out, num_blocks);
+			else
+				xoshiro_generate_sse2(lanes, out, num_blocks);
+#else
+			xoshiro_generate_scalar(lanes, out, num_blocks);
+#endif
+		}
+
+		// Converts random 32 bit numbers to floats in [min, max), using the top 24 bits
+		void convert_to_float(const uint32_t *in, float *out, int count, float min, float max)
+		{
+			float scale = (max - min) * (1.0f / 16777216.0f);
+			int i = 0;
+#ifdef CL_XOSHIRO_SIMD_AVAILABLE
+			__m128 scale4 = _mm_set1_ps(scale);
+			__m128 min4 = _mm_set1_ps(min);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i value = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), 8);
+				_mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(value), scale4), min4));
+			}
+#endif
+			for (; i < count; i++)
+				out[i] = min + (in[i] >> 8) * scale;
+		}
+
+		// Maps random 32 bit numbers to [min, max] with a multiply and shift
+		void convert_to_int(const uint32_t *in, int *out, int count, int min, int max)
+		{
+			uint64_t range = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+			int i = 0;
+#ifdef CL_XOSHIRO_SIMD_AVAILABLE
+			if (range < ((uint64_t)1) << 32)
+			{
+				__m128i range4 = _mm_set1_epi32((int)(uint32_t)range);
+				__m128i min4 = _mm_set1_epi32(min);
+				__m128i high_mask = _mm_set1_epi64x((long long)0xffffffff00000000ULL);
+				for (; i + 4 <= count; i += 4)
+				{
+					__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+					__m128i even = _mm_srli_epi64(_mm_mul_epu32(value, range4), 32);
+					__m128i odd = _mm_and_si128(_mm_mul_epu32(_mm_srli_epi64(value, 32), range4), high_mask);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(_mm_or_si128(even, odd), min4));
+				}
+			}
+#endif
+			for (; i < count; i++)
+				out[i] = (int)((int64_t)min + (int64_t)((in[i] * range) >> 32));
+		}
+	}
+
+	Xoshiro256::Xoshiro256(uint64_t seed)
+	{
+		// SplitMix64, so that similar seeds give unrelated states
+		for (auto &word : state)
+		{
+			uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			word = z ^ (z >> 31);
+		}
+	}
+
+	int Xoshiro256::next_int(int min, int max)
+	{
+		uint64_t range = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+		if (range > 0xffffffffULL)
+			return (int)next_uint32();
+
+		// Lemire's nearly divisionless method, rejecting the few values that would cause a bias
+		uint64_t product = (uint64_t)next_uint32() * range;
+		uint32_t low = (uint32_t)product;
+		if (low < range)
+		{
+			uint32_t threshold = (uint32_t)(0 - (uint32_t)range) % (uint32_t)range;
+			while (low < threshold)
+			{
+				product = (uint64_t)next_uint32() * range;
+				low = (uint32_t)product;
+			}
+		}
+		return (int)((int64_t)min + (int64_t)(product >> 32));
+	}
+
+	float Xoshiro256::next_normal(float mean, float standard_deviation)
+	{
+		// Box-Muller transform. 1 - u keeps the logarithm finite
+		double u1 = 1.0 - next_double();
+		double u2 = next_double();
+		return mean + standard_deviation * (float)(std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2));
+	}
+
+	void Xoshiro256::jump()
+	{
+		jump(state, jump_polynomial);
+		lanes_initialized = false;
+	}
+
+	void Xoshiro256::long_jump()
+	{
+		jump(state, long_jump_polynomial);
+		lanes_initialized = false;
+	}
+
+	void Xoshiro256::jump(uint64_t state[4], const uint64_t polynomial[4])
+	{
+		Xoshiro256 generator(0);
+		memcpy(generator.state, state, sizeof(generator.state));
+
+		uint64_t result[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 4; i++)
+		{
+			for (int bit = 0; bit < 64; bit++)
+			{
+				if (polynomial[i] & (((uint64_t)1) << bit))
+				{
+					for (int j = 0; j < 4; j++)
+						result[j] ^= generator.state[j];
+				}
+				generator.next();
+			}
+		}
+		memcpy(state, result, sizeof(result));
+	}
+
+	Xoshiro256 Xoshiro256::split()
+	{
+		Xoshiro256 child(*this);
+		child.lanes_initialized = false;
+		jump();
+		return child;
+	}
+
+	void Xoshiro256::init_lanes()
+	{
+		// The scalar stream uses the first 2^192 steps, lane n the (n+1)th
+		uint64_t lane_state[4];
+		memcpy(lane_state, state, sizeof(lane_state));
+		for (int lane = 0; lane < 4; lane++)
+		{
+			jump(lane_state, long_jump_polynomial);
+			for (int word = 0; word < 4; word++)
+				lanes[word][lane] = lane_state[word];
+		}
+		lanes_initialized = true;
+	}
+
+	void Xoshiro256::fill_uint32(uint32_t *out, int count)
+	{
+		if (!lanes_initialized)
+			init_lanes();
+
+		int num_blocks = count / 8;
+		xoshiro_generate(lanes, out, num_blocks);
+
+		int remaining = count - num_blocks * 8;
+		if (remaining)
+		{
+			uint32_t block[8];
+			xoshiro_generate(lanes, block, 1);
+			memcpy(out + num_blocks * 8, block, remaining * sizeof(uint32_t));
+		}
+	}
+
+	void Xoshiro256::fill_float(float *out, int count, float min, float max)
+	{
+		uint32_t chunk[fill_chunk_size];
+		for (int pos = 0; pos < count; pos += fill_chunk_size)
+		{
+			int size = count - pos < fill_chunk_size ? count - pos : fill_chunk_size;
+			fill_uint32(chunk, size);
+			convert_to_float(chunk, out + pos, size, min, max);
+		}
+	}
+
+	void Xoshiro256::fill_int(int *out, int count, int min, int max)
+	{
+		uint32_t chunk[fill_chunk_size];
+		for (int pos = 0; pos < count; pos += fill_chunk_size)
+		{
+			int size = count - pos < fill_chunk_size ? count - pos : fill_chunk_size;
+			fill_uint32(chunk, size);
+			convert_to_int(chunk, out + pos, size, min, max);
+		}
+	}
+}
@@ -65,7 +65,41 @@ namespace clan
 
 #endif
 
+#ifdef __amd64__
+
+#define __cpuidex(out, infoType, subleaf)\
+	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subleaf));
+#else
+
+#define __cpuidex(out, infoType, subleaf) \
+	asm volatile(	"pushl %%ebx \n" \
+			"cpuid \n" \
+			"movl %%ebx, %1 \n" \
+			"popl %%ebx" \
+		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subleaf));
+
+#endif
+
+#endif
+
+	// The YMM registers can only be used if the OS saves them on context switches:
+	// OSXSAVE must be set, and XCR0 must enable both the SSE (bit 1) and AVX (bit 2) state.
+	static bool os_saves_avx_state()
+	{
+		unsigned int cpuinfo[4] = { 0 };
+		__cpuid((int*)cpuinfo, 0x1);
+		if ((cpuinfo[2] & (1 << 27)) == 0)
+			return false;
+
+#ifdef __GNUC__
+		unsigned int xcr0_low, xcr0_high;
+		asm volatile("xgetbv" : "=a" (xcr0_low), "=d" (xcr0_high) : "c" (0));
+		unsigned long long xcr0 = ((unsigned long long)xcr0_high << 32) | xcr0_low;
+#else
+		unsigned long long xcr0 = _xgetbv(0);
 #endif
+		return (xcr0 & 0x6) == 0x6;
+	}
 
 	bool System::detect_cpu_extension(CPU_ExtensionPPC ext)
 	{
@@ -160,7 +194,7 @@ namespace clan
 		else if (ext == avx)
 		{
 			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 28)) != 0);
+			return ((cpuinfo[2] & (1 << 28)) != 0) && os_saves_avx_state();
 		}
 		else if (ext == aes)
 		{
@@ -170,7 +204,7 @@ namespace clan
 		else if (ext == fma3)
 		{
 			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 12)) != 0);
+			return ((cpuinfo[2] & (1 << 12)) != 0) && os_saves_avx_state();
 		}
 		else if (ext == fma4)
 		{
@@ -181,6 +215,29 @@ namespace clan
 			__cpuid((int*)cpuinfo, 0x80000001);
 			return ((cpuinfo[2] & (1 << 16)) != 0);
 		}
+		else if (ext == pclmul)
+		{
+			__cpuid((int*)cpuinfo, 0x1);
+			return ((cpuinfo[2] & (1 << 1)) != 0);
+		}
+		else if (ext == avx2)
+		{
+			__cpuid((int*)cpuinfo, 0x0);
+			if (cpuinfo[0] < 0x7)
+				return false;
+
+			__cpuidex((int*)cpuinfo, 0x7, 0x0);
+			return ((cpuinfo[1] & (1 << 5)) != 0) && os_saves_avx_state();
+		}
+		else if (ext == sha)
+		{
+			__cpuid((int*)cpuinfo, 0x0);
+			if (cpuinfo[0] < 0x7)
+				return false;
+
+			__cpuidex((int*)cpuinfo, 0x7, 0x0);
+			return ((cpuinfo[1] & (1 << 29)) != 0);
+		}
 		return false;
 	}
 
@@ -162,7 +162,8 @@ namespace clan
 
 	IODeviceProvider *ZipIODevice_FileEntry::duplicate()
 	{
-		ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(this, file_entry);
+		// The duplicate needs its own archive device, as it seeks and inflates independently
+		ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(iodevice.duplicate(), file_entry);
 		return new_provider;
 	}
 
@@ -28,8 +28,10 @@
 
 #include "Display/precomp.h"
 #include "API/Core/Math/cl_math.h"
+#include "API/Core/Text/utf8_reader.h"
 #include "API/Display/2D/canvas.h"
 #include "span_layout_impl.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -155,16 +157,16 @@ namespace clan
 		if (s1 != s2)
 		{
 			int xx = x + segment.x_position;
-			int xx0 = xx + segment.font.measure_text(canvas, segment_text.substr(0, s1)).advance.width;
-			int xx1 = xx0 + segment.font.measure_text(canvas, segment_text.substr(s1, s2 - s1)).advance.width;
-			int sel_width = segment.font.measure_text(canvas, segment_text.substr(s1, s2 - s1)).advance.width;
+			int xx0 = xx + text_width(canvas, segment.object_index, segment.start, segment.start + s1);
+			int sel_width = text_width(canvas, segment.object_index, segment.start + s1, segment.start + s2);
+			int xx1 = xx0 + sel_width;
 
 			canvas.fill_rect(xx0, y + line.ascender - segment.ascender, xx1, y + line.ascender + segment.descender, sel_background);
 
 			if (cursor_visible && cursor_pos >= segment.start && cursor_pos < segment.end)
 			{
-				int cursor_x = x + segment.x_position + segment.font.measure_text(canvas, text.substr(segment.start, cursor_pos - segment.start)).advance.width;
-				int cursor_width = cursor_overwrite_mode ? segment.font.measure_text(canvas, text.substr(cursor_pos, 1)).advance.width : 1;
+				int cursor_x = x + segment.x_position + text_width(canvas, segment.object_index, segment.start, cursor_pos);
+				int cursor_width = cursor_overwrite_mode ? text_width(canvas, segment.object_index, cursor_pos, cursor_pos + 1) : 1;
 				canvas.fill_rect(cursor_x, y + line.ascender - segment.ascender, cursor_x + cursor_width, y + line.ascender + segment.descender, cursor_color);
 			}
 
@@ -192,8 +194,8 @@ namespace clan
 		{
 			if (cursor_visible && cursor_pos >= segment.start && cursor_pos < segment.end)
 			{
-				int cursor_x = x + segment.x_position + segment.font.measure_text(canvas, text.substr(segment.start, cursor_pos - segment.start)).advance.width;
-				int cursor_width = cursor_overwrite_mode ? segment.font.measure_text(canvas, text.substr(cursor_pos, 1)).advance.width : 1;
+				int cursor_x = x + segment.x_position + text_width(canvas, segment.object_index, segment.start, cursor_pos);
+				int cursor_width = cursor_overwrite_mode ? text_width(canvas, segment.object_index, cursor_pos, cursor_pos + 1) : 1;
 				canvas.fill_rect(cursor_x, y + line.ascender - segment.ascender, cursor_x + cursor_width, y + line.ascender + segment.descender, cursor_color);
 			}
 
@@ -204,6 +206,69 @@ namespace clan
 		}
 	}
 
+	const SpanLayout_Impl::SpanObject &SpanLayout_Impl::measure_object(Canvas &canvas, unsigned int object_index)
+	{
+		// Glyph advances depend on the pixel ratio of the canvas
+		float pixel_ratio = canvas.get_pixel_ratio();
+		if (pixel_ratio != measured_pixel_ratio)
+		{
+			for (auto &object : objects)
+			{
+				object.glyph_positions.clear();
+				object.glyph_offsets.clear();
+			}
+			measured_pixel_ratio = pixel_ratio;
+		}
+
+		SpanObject &object = objects[object_index];
+		if (object.glyph_positions.empty())
+		{
+			float x = 0.0f;
+			UTF8_Reader reader(text.data() + object.start, object.end - object.start);
+			while (!reader.is_end())
+			{
+				object.glyph_positions.push_back(object.start + reader.get_position());
+				object.glyph_offsets.push_back(x);
+
+				unsigned int glyph = reader.get_char();
+				if (glyph != '\n')
+					x += object.font.get_metrics(canvas, glyph).advance.width;
+				reader.next();
+			}
+			object.glyph_positions.push_back(object.end);
+			object.glyph_offsets.push_back(x);
+		}
+		return object;
+	}
+
+	float SpanLayout_Impl::glyph_offset(const SpanObject &object, unsigned int pos) const
+	{
+		auto it = std::lower_bound(object.glyph_positions.begin(), object.glyph_positions.end(), pos);
+		if (it == object.glyph_positions.end())
+			return object.glyph_offsets.back();
+		return object.glyph_offsets[it - object.glyph_positions.begin()];
+	}
+
+	float SpanLayout_Impl::text_width(Canvas &canvas, unsigned int object_index, unsigned int start, unsigned int end)
+	{
+		const SpanObject &object = measure_object(canvas, object_index);
+		return glyph_offset(object, end) - glyph_offset(object, start);
+	}
+
+	unsigned int SpanLayout_Impl::text_position(Canvas &canvas, unsigned int object_index, unsigned int start, unsigned int end, float x)
+	{
+		const SpanObject &object = measure_object(canvas, object_index);
+		float target = glyph_offset(object, start) + x;
+
+		// Last glyph starting at or before the offset
+		auto first = std::lower_bound(object.glyph_positions.begin(), object.glyph_positions.end(), start) - object.glyph_positions.begin();
+		auto last = std::lower_bound(object.glyph_positions.begin(), object.glyph_positions.end(), end) - object.glyph_positions.begin();
+		auto it = std::upper_bound(object.glyph_offsets.begin() + first, object.glyph_offsets.begin() + last, target);
+		if (it == object.glyph_offsets.begin() + first)
+			return start;
+		return object.glyph_positions[it - object.glyph_offsets.begin() - 1];
+	}
+
 	SpanLayout::HitTestResult SpanLayout_Impl::hit_test(Canvas &canvas, const Point &pos)
 	{
 		SpanLayout::HitTestResult result;
@@ -249,9 +314,7 @@ namespace clan
 					// Check if we are inside a segment
 					if (pos.x >= x + segment.x_position && pos.x <= x + segment.x_position + segment.width)
 					{
-						std::string segment_text = text.substr(segment.start, segment.end - segment.start);
-						Pointf hit_point(pos.x - x - segment.x_position, 0);
-						int offset = segment.start + segment.font.get_character_index(canvas, segment_text, hit_point);
+						int offset = text_position(canvas, segment.object_index, segment.start, segment.end, pos.x - x - segment.x_position);
 
 						result.type = SpanLayout::HitTestResult::inside;
 						result.object_id = segment.id;
@@ -384,9 +447,7 @@ namespace clan
 		while (pos != block.end)
 		{
 			int end = min(objects[object_index].end, block.end);
-			std::string subtext = text.substr(pos, end - pos);
-
-			float text_width = font.measure_text(canvas, subtext).advance.width;
+			float text_width = this->text_width(canvas, object_index, pos, end);
 
 			result.width += text_width;
 			result.height = max(result.height, (int)(layout_cache.metrics.get_height() + layout_cache.metrics.get_external_leading()));
@@ -400,6 +461,7 @@ namespace clan
 			segment.font = objects[object_index].font;
 			segment.color = objects[object_index].color;
 			segment.id = objects[object_index].id;
+			segment.object_index = object_index;
 			segment.x_position = x_position;
 			segment.width = text_width;
 			segment.ascender = (int)layout_cache.metrics.get_ascent();
@@ -166,6 +166,12 @@ namespace clan
 			int baseline_offset;
 
 			int id;
+
+			/// Text positions of the glyphs in a text object and their offsets from the start of the object
+			///
+			/// Calculated on first use by measure_object. The last entry is the end of the object.
+			std::vector<unsigned int> glyph_positions;
+			std::vector<float> glyph_offsets;
 		};
 
 		struct LineSegment
@@ -179,6 +185,7 @@ namespace clan
 			int start = 0, end = 0;
 			int ascender = 0;
 			int descender = 0;
+			unsigned int object_index = 0;
 
 			int x_position = 0;
 			int width = 0;
@@ -256,6 +263,10 @@ namespace clan
 		void align_right(int max_width);
 		void draw_layout_image(Canvas &canvas, Line &line, LineSegment &segment, int x, int y);
 		void draw_layout_text(Canvas &canvas, Line &line, LineSegment &segment, int x, int y);
+		const SpanObject &measure_object(Canvas &canvas, unsigned int object_index);
+		float glyph_offset(const SpanObject &object, unsigned int pos) const;
+		float text_width(Canvas &canvas, unsigned int object_index, unsigned int start, unsigned int end);
+		unsigned int text_position(Canvas &canvas, unsigned int object_index, unsigned int start, unsigned int end, float x);
 		std::string::size_type sel_start, sel_end;
 		Colorf sel_foreground, sel_background;
 
@@ -276,6 +287,9 @@ namespace clan
 		};
 		LayoutCache layout_cache;
 
+		/// Pixel ratio of the canvas the glyph offsets of the objects were measured with
+		float measured_pixel_ratio = 0.0f;
+
 		bool is_ellipsis_draw;
 		Rect ellipsis_content_rect;
 	};
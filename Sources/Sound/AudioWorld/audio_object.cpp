@@ -47,6 +47,11 @@ namespace clan
 		return impl->volume;
 	}
 
+	int AudioObject::get_priority() const
+	{
+		return impl->priority;
+	}
+
 	bool AudioObject::is_looping() const
 	{
 		return impl->looping;
@@ -59,37 +64,54 @@ namespace clan
 
 	bool AudioObject::is_playing() const
 	{
-		return impl && !impl->session.is_null() && impl->session.is_playing();
+		return impl && impl->index >= 0 && (impl->real_index < 0 || impl->session.is_playing());
+	}
+
+	bool AudioObject::is_virtual() const
+	{
+		return impl && impl->index >= 0 && impl->real_index < 0;
 	}
 
 	void AudioObject::set_position(const Vec3f &position)
 	{
 		impl->position = position;
+		impl->world->update_emitter(impl.get());
 	}
 
 	void AudioObject::set_attenuation_begin(float distance)
 	{
 		impl->attenuation_begin = distance;
+		impl->world->update_emitter(impl.get());
 	}
 
 	void AudioObject::set_attenuation_end(float distance)
 	{
 		impl->attenuation_end = distance;
+		impl->world->update_emitter(impl.get());
 	}
 
 	void AudioObject::set_volume(float volume)
 	{
 		impl->volume = volume;
+		impl->world->update_emitter(impl.get());
+	}
+
+	void AudioObject::set_priority(int priority)
+	{
+		impl->priority = priority;
+		impl->world->update_emitter(impl.get());
 	}
 
 	void AudioObject::set_sound(const SoundBuffer &buffer)
 	{
 		impl->sound = buffer;
+		impl->sound_length = 0;
+		impl->sound_frequency = 0;
 	}
 
 	void AudioObject::set_sound(const std::string &id)
 	{
-		impl->sound = SoundBuffer::resource(id, impl->world->resources);
+		set_sound(SoundBuffer::resource(id, impl->world->resources));
 	}
 
 	void AudioObject::set_looping(bool loop)
@@ -106,32 +128,22 @@ namespace clan
 	{
 		if (!impl->ambience || impl->world->play_ambience)
 		{
-			impl->session = impl->sound.prepare(impl->looping);
-			impl->world->update_session(impl.get());
-			impl->session.play();
-			impl->world->active_objects.push_back(*this);
+			stop();
+			impl->world->add_emitter(*this);
 		}
 	}
 
 	void AudioObject::stop()
 	{
-		if (impl && !impl->session.is_null())
-		{
-			impl->session.stop();
-			impl->session = SoundBuffer_Session();
-		}
+		if (impl)
+			impl->world->remove_emitter(impl.get());
 	}
 
 	/////////////////////////////////////////////////////////////////////////////
 
 	AudioObject_Impl::AudioObject_Impl(AudioWorld_Impl *world)
-		: world(world), attenuation_begin(0.0f), attenuation_end(0.0f), volume(1.0f), looping(false), ambience(false)
-	{
-		it = world->objects.insert(world->objects.end(), this);
-	}
-
-	AudioObject_Impl::~AudioObject_Impl()
+		: world(world), attenuation_begin(0.0f), attenuation_end(0.0f), volume(1.0f), priority(0), looping(false), ambience(false),
+		index(-1), real_index(-1), cell(-1), cell_index(-1), virtual_position(0.0), virtual_time(0.0), sound_length(0), sound_frequency(0)
 	{
-		world->objects.erase(it);
 	}
 }
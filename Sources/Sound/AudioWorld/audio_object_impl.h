@@ -28,7 +28,6 @@
 
 #pragma once
 
-#include <list>
 #include "API/Core/Math/vec3.h"
 #include "API/Sound/soundbuffer.h"
 #include "API/Sound/soundbuffer_session.h"
@@ -41,18 +40,37 @@ namespace clan
 	{
 	public:
 		AudioObject_Impl(AudioWorld_Impl *world);
-		~AudioObject_Impl();
+
+		bool is_positional() const { return attenuation_begin != attenuation_end; }
 
 		AudioWorld_Impl *world;
-		std::list<AudioObject_Impl *>::iterator it;
 
 		Vec3f position;
 		float attenuation_begin;
 		float attenuation_end;
 		float volume;
+		int priority;
 		bool looping;
 		bool ambience;
 		SoundBuffer sound;
 		SoundBuffer_Session session;
+
+		/// \brief Index into the emitter arrays of the world, or -1 when not playing
+		int index;
+
+		/// \brief Index into the real voices of the world, or -1 when the voice is virtual
+		int real_index;
+
+		/// \brief Grid cell key and index into the cell (or into the unpositioned emitters)
+		int64_t cell;
+		int cell_index;
+
+		/// \brief Play position of a virtual voice at virtual_time
+		double virtual_position;
+		double virtual_time;
+
+		/// \brief Length and frequency of the sound, or 0 if no session of it was started yet
+		int sound_length;
+		int sound_frequency;
 	};
 }
@@ -6,6 +6,9 @@
 #include "API/Core/Math/cl_math.h"
 #include "audio_world_impl.h"
 #include "audio_object_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace clan
 {
@@ -20,6 +23,11 @@ namespace clan
 		impl->listener_orientation = orientation;
 	}
 
+	void AudioWorld::enable_ambience(bool enable)
+	{
+		impl->play_ambience = enable;
+	}
+
 	bool AudioWorld::is_ambience_enabled() const
 	{
 		return impl->play_ambience;
@@ -35,62 +43,507 @@ namespace clan
 		return impl->reverse_stereo;
 	}
 
+	void AudioWorld::set_max_voices(int voices)
+	{
+		impl->max_voices = std::max(voices, 0);
+	}
+
+	int AudioWorld::get_max_voices() const
+	{
+		return impl->max_voices;
+	}
+
+	int AudioWorld::get_num_real_voices() const
+	{
+		return (int)impl->real_voices.size();
+	}
+
+	int AudioWorld::get_num_virtual_voices() const
+	{
+		return (int)(impl->emitters.size() - impl->real_voices.size());
+	}
+
+	void AudioWorld::set_cell_size(float size)
+	{
+		if (size <= 0.0f)
+			throw Exception("AudioWorld cell size must be positive");
+		impl->set_cell_size(size);
+	}
+
+	float AudioWorld::get_cell_size() const
+	{
+		return impl->cell_size;
+	}
+
 	void AudioWorld::update()
 	{
-		for (auto it = impl->objects.begin(); it != impl->objects.end(); ++it)
+		impl->update();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		const int64_t cell_mask = (1 << 21) - 1;
+
+		int64_t get_cell_coord(float value, float cell_size)
 		{
-			impl->update_session(*it);
+			double coord = std::floor((double)value / cell_size);
+			return (int64_t)std::min(std::max(coord, -1e12), 1e12);
 		}
 
-		for (auto it = impl->active_objects.begin(); it != impl->active_objects.end();)
+		int64_t get_cell_key(int64_t x, int64_t y, int64_t z)
 		{
-			if (it->impl->session.is_playing())
-			{
-				++it;
-			}
-			else
+			// Coordinates wrap around every 2^21 cells. Cells sharing a key only add candidates that get attenuated to silence.
+			return ((x & cell_mask) << 42) | ((y & cell_mask) << 21) | (z & cell_mask);
+		}
+	}
+
+	AudioWorld_Impl::AudioWorld_Impl(const ResourceManager &resources)
+		: cell_size(64.0f), max_range(0.0f), max_range_dirty(false), max_voices(64), frame(0),
+		play_ambience(true), reverse_stereo(false), resources(resources), start_time(std::chrono::steady_clock::now())
+	{
+	}
+
+	AudioWorld_Impl::~AudioWorld_Impl()
+	{
+		for (auto &emitter : emitters)
+		{
+			AudioObject_Impl *obj = emitter.impl.get();
+			obj->index = -1;
+			obj->real_index = -1;
+			if (!obj->session.is_null())
 			{
-				it = impl->active_objects.erase(it);
+				obj->session.stop();
+				obj->session = SoundBuffer_Session();
 			}
 		}
 	}
 
-	/////////////////////////////////////////////////////////////////////////////
+	double AudioWorld_Impl::get_time() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	}
 
-	AudioWorld_Impl::AudioWorld_Impl(const ResourceManager &resources)
-		: play_ambience(true), reverse_stereo(false), resources(resources)
+	void AudioWorld_Impl::update()
 	{
+		double time = get_time();
+
+		// Remove voices that reached the end of a one-shot sound
+		for (size_t i = 0; i < real_voices.size();)
+		{
+			if (real_voices[i]->session.is_playing())
+				++i;
+			else
+				remove_emitter(real_voices[i]);
+		}
+
+		for (size_t i = 0; i < emitters.size();)
+		{
+			if (emitter_expire_time[i] > time)
+				++i;
+			else
+				remove_emitter(emitters[i].impl.get());
+		}
+
+		find_candidates();
+
+		int count = (int)candidates.size();
+		candidate_volume.resize(count);
+		candidate_pan.resize(count);
+		evaluate(candidates.data(), count, candidate_volume.data(), candidate_pan.data());
+
+		// Pick the audible emitters with the highest priority, then the loudest.
+		// Real voices get a small bonus so that equally loud voices do not swap every frame.
+		selected.clear();
+		for (int i = 0; i < count; i++)
+		{
+			if (candidate_volume[i] > 0.0f)
+				selected.push_back(i);
+		}
+
+		if ((int)selected.size() > max_voices)
+		{
+			auto compare = [this](int a, int b)
+			{
+				int priority_a = emitter_priority[candidates[a]];
+				int priority_b = emitter_priority[candidates[b]];
+				if (priority_a != priority_b)
+					return priority_a > priority_b;
+				float score_a = candidate_volume[a] * (emitters[candidates[a]].impl->real_index >= 0 ? 1.25f : 1.0f);
+				float score_b = candidate_volume[b] * (emitters[candidates[b]].impl->real_index >= 0 ? 1.25f : 1.0f);
+				return score_a > score_b;
+			};
+			std::nth_element(selected.begin(), selected.begin() + max_voices, selected.end(), compare);
+			selected.resize(max_voices);
+		}
+
+		frame++;
+		for (int i : selected)
+			emitter_selected[candidates[i]] = frame;
+
+		for (size_t i = 0; i < real_voices.size();)
+		{
+			if (emitter_selected[real_voices[i]->index] == frame)
+				++i;
+			else
+				make_virtual(real_voices[i]);
+		}
+
+		ended.clear();
+		for (int i : selected)
+		{
+			AudioObject_Impl *obj = emitters[candidates[i]].impl.get();
+			if (obj->real_index >= 0)
+			{
+				obj->session.set_volume(candidate_volume[i]);
+				obj->session.set_pan(candidate_pan[i]);
+			}
+			else if (!make_real(obj, candidate_volume[i], candidate_pan[i]))
+			{
+				ended.push_back(obj);
+			}
+		}
+
+		for (AudioObject_Impl *obj : ended)
+			remove_emitter(obj);
 	}
 
-	AudioWorld_Impl::~AudioWorld_Impl()
+	void AudioWorld_Impl::find_candidates()
 	{
+		candidates.clear();
+		for (AudioObject_Impl *obj : unpositioned)
+			candidates.push_back(obj->index);
+
+		int num_emitters = (int)emitters.size();
+		int num_positional = num_emitters - (int)unpositioned.size();
+		if (num_positional == 0)
+			return;
+
+		if (max_range_dirty)
+		{
+			max_range = 0.0f;
+			for (int i = 0; i < num_emitters; i++)
+			{
+				if (emitter_attenuation_begin[i] != emitter_attenuation_end[i])
+					max_range = std::max(max_range, std::max(emitter_attenuation_begin[i], emitter_attenuation_end[i]));
+			}
+			max_range_dirty = false;
+		}
+
+		int64_t x0 = get_cell_coord(listener_position.x - max_range, cell_size);
+		int64_t y0 = get_cell_coord(listener_position.y - max_range, cell_size);
+		int64_t z0 = get_cell_coord(listener_position.z - max_range, cell_size);
+		int64_t x1 = get_cell_coord(listener_position.x + max_range, cell_size);
+		int64_t y1 = get_cell_coord(listener_position.y + max_range, cell_size);
+		int64_t z1 = get_cell_coord(listener_position.z + max_range, cell_size);
+
+		double num_cells = (double)(x1 - x0 + 1) * (double)(y1 - y0 + 1) * (double)(z1 - z0 + 1);
+		if (num_cells >= num_positional)
+		{
+			// Visiting the cells would cost more than testing every emitter
+			for (int i = 0; i < num_emitters; i++)
+			{
+				if (emitter_attenuation_begin[i] != emitter_attenuation_end[i])
+					candidates.push_back(i);
+			}
+			return;
+		}
+
+		for (int64_t z = z0; z <= z1; z++)
+		{
+			for (int64_t y = y0; y <= y1; y++)
+			{
+				for (int64_t x = x0; x <= x1; x++)
+				{
+					auto it = grid.find(get_cell_key(x, y, z));
+					if (it != grid.end())
+					{
+						for (AudioObject_Impl *obj : it->second)
+							candidates.push_back(obj->index);
+					}
+				}
+			}
+		}
 	}
 
-	void AudioWorld_Impl::update_session(AudioObject_Impl *obj)
+	void AudioWorld_Impl::evaluate(const int *indices, int count, float *out_volume, float *out_pan)
 	{
-		if (obj->attenuation_begin != obj->attenuation_end)
+		candidate_dx.resize(count);
+		candidate_dy.resize(count);
+		candidate_dz.resize(count);
+		candidate_begin.resize(count);
+		candidate_end.resize(count);
+
+		float *dx = candidate_dx.data();
+		float *dy = candidate_dy.data();
+		float *dz = candidate_dz.data();
+		float *begin = candidate_begin.data();
+		float *end = candidate_end.data();
+
+		for (int i = 0; i < count; i++)
+		{
+			int index = indices[i];
+			dx[i] = emitter_x[index] - listener_position.x;
+			dy[i] = emitter_y[index] - listener_position.y;
+			dz[i] = emitter_z[index] - listener_position.z;
+			begin[i] = emitter_attenuation_begin[index];
+			end[i] = emitter_attenuation_end[index];
+			out_volume[i] = emitter_volume[index];
+		}
+
+		Vec3f ear_vector = listener_orientation.rotate_vector(Vec3f(1.0f, 0.0f, 0.0f));
+		if (reverse_stereo)
+			ear_vector = Vec3f(0.0f) - ear_vector;
+
+		for (int i = 0; i < count; i++)
 		{
+			float range = end[i] - begin[i];
+			bool positional = range != 0.0f;
+
 			// Calculate volume from distance
-			float distance = obj->position.distance(listener_position);
-			float t = 1.0f - smoothstep(obj->attenuation_begin, obj->attenuation_end, distance);
+			float distance = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+			float x = positional ? (distance - begin[i]) / range : 0.0f;
+			x = std::min(std::max(x, 0.0f), 1.0f);
+			float t = 1.0f - x * x * (3.0f - 2.0f * x);
 
 			// Calculate pan from ear angle
-			Vec3f sound_direction = Vec3f::normalize(obj->position - listener_position);
-			Vec3f ear_vector = listener_orientation.rotate_vector(Vec3f(1.0f, 0.0f, 0.0f));
-			float pan = Vec3f::dot(ear_vector, sound_direction);
-			if (reverse_stereo)
-				pan = -pan;
+			float pan = (ear_vector.x * dx[i] + ear_vector.y * dy[i] + ear_vector.z * dz[i]) / std::max(distance, 1e-6f);
+			pan = positional ? pan : 0.0f;
 
 			// Final volume needs to stay the same no matter the panning direction
-			float volume = (0.5f + std::abs(pan) * 0.5f) * t * obj->volume;
+			float gain = positional ? (0.5f + std::abs(pan) * 0.5f) * t : 1.0f;
+			out_volume[i] *= gain;
+			out_pan[i] = pan;
+		}
+	}
+
+	void AudioWorld_Impl::add_emitter(const AudioObject &object)
+	{
+		AudioObject_Impl *obj = object.impl.get();
+		obj->index = (int)emitters.size();
+		obj->real_index = -1;
+		obj->virtual_position = 0.0;
+		obj->virtual_time = get_time();
+
+		emitters.push_back(object);
+		emitter_x.push_back(obj->position.x);
+		emitter_y.push_back(obj->position.y);
+		emitter_z.push_back(obj->position.z);
+		emitter_attenuation_begin.push_back(obj->attenuation_begin);
+		emitter_attenuation_end.push_back(obj->attenuation_end);
+		emitter_volume.push_back(obj->volume);
+		emitter_priority.push_back(obj->priority);
+		emitter_expire_time.push_back(std::numeric_limits<double>::infinity());
+		emitter_selected.push_back(0);
+
+		insert_bucket(obj);
+		if (obj->is_positional())
+			max_range = std::max(max_range, std::max(obj->attenuation_begin, obj->attenuation_end));
+
+		// Start a mixer session right away if there is room for it
+		float volume = 0.0f, pan = 0.0f;
+		evaluate(&obj->index, 1, &volume, &pan);
+		if ((int)real_voices.size() < max_voices && volume > 0.0f)
+		{
+			if (!make_real(obj, volume, pan))
+				remove_emitter(obj);
+		}
+		else
+		{
+			probe_sound(obj);
+			set_expire_time(obj);
+		}
+	}
+
+	void AudioWorld_Impl::remove_emitter(AudioObject_Impl *obj)
+	{
+		if (obj->index < 0)
+			return;
+
+		if (obj->real_index >= 0)
+		{
+			remove_real_voice(obj);
+			obj->session.stop();
+			obj->session = SoundBuffer_Session();
+		}
+
+		remove_bucket(obj);
+		if (obj->is_positional())
+			max_range_dirty = true;
+
+		// Keep the object alive until its slot has been reused
+		AudioObject object = emitters[obj->index];
+
+		int index = obj->index;
+		int last = (int)emitters.size() - 1;
+		if (index != last)
+		{
+			emitters[index] = emitters[last];
+			emitter_x[index] = emitter_x[last];
+			emitter_y[index] = emitter_y[last];
+			emitter_z[index] = emitter_z[last];
+			emitter_attenuation_begin[index] = emitter_attenuation_begin[last];
+			emitter_attenuation_end[index] = emitter_attenuation_end[last];
+			emitter_volume[index] = emitter_volume[last];
+			emitter_priority[index] = emitter_priority[last];
+			emitter_expire_time[index] = emitter_expire_time[last];
+			emitter_selected[index] = emitter_selected[last];
+			emitters[index].impl->index = index;
+		}
+
+		emitters.pop_back();
+		emitter_x.pop_back();
+		emitter_y.pop_back();
+		emitter_z.pop_back();
+		emitter_attenuation_begin.pop_back();
+		emitter_attenuation_end.pop_back();
+		emitter_volume.pop_back();
+		emitter_priority.pop_back();
+		emitter_expire_time.pop_back();
+		emitter_selected.pop_back();
+
+		obj->index = -1;
+	}
+
+	void AudioWorld_Impl::update_emitter(AudioObject_Impl *obj)
+	{
+		int index = obj->index;
+		if (index < 0)
+			return;
+
+		if (emitter_attenuation_begin[index] != obj->attenuation_begin || emitter_attenuation_end[index] != obj->attenuation_end)
+		{
+			max_range_dirty = true;
+			emitter_attenuation_begin[index] = obj->attenuation_begin;
+			emitter_attenuation_end[index] = obj->attenuation_end;
+		}
+
+		emitter_x[index] = obj->position.x;
+		emitter_y[index] = obj->position.y;
+		emitter_z[index] = obj->position.z;
+		emitter_volume[index] = obj->volume;
+		emitter_priority[index] = obj->priority;
+
+		int64_t cell = obj->is_positional() ? get_cell(obj->position) : -1;
+		if (cell != obj->cell)
+		{
+			remove_bucket(obj);
+			insert_bucket(obj);
+		}
+	}
+
+	bool AudioWorld_Impl::make_real(AudioObject_Impl *obj, float volume, float pan)
+	{
+		double position = obj->virtual_position;
+		if (obj->sound_frequency > 0)
+			position += (get_time() - obj->virtual_time) * obj->sound_frequency;
+
+		if (obj->sound_length > 0)
+		{
+			if (obj->looping)
+				position = std::fmod(position, (double)obj->sound_length);
+			else if (position >= obj->sound_length)
+				return false;
+		}
 
-			obj->session.set_volume(volume);
-			obj->session.set_pan(pan);
+		obj->session = obj->sound.prepare(obj->looping);
+		obj->sound_length = obj->session.get_length();
+		obj->sound_frequency = obj->session.get_frequency();
+		if ((int)position > 0)
+			obj->session.set_position((int)position);
+		obj->session.set_volume(volume);
+		obj->session.set_pan(pan);
+		obj->session.play();
+
+		obj->real_index = (int)real_voices.size();
+		real_voices.push_back(obj);
+		emitter_expire_time[obj->index] = std::numeric_limits<double>::infinity();
+		return true;
+	}
+
+	void AudioWorld_Impl::make_virtual(AudioObject_Impl *obj)
+	{
+		obj->sound_length = obj->session.get_length();
+		obj->sound_frequency = obj->session.get_frequency();
+		obj->virtual_position = obj->session.get_position();
+		obj->virtual_time = get_time();
+
+		obj->session.stop();
+		obj->session = SoundBuffer_Session();
+
+		remove_real_voice(obj);
+		set_expire_time(obj);
+	}
+
+	void AudioWorld_Impl::set_cell_size(float size)
+	{
+		cell_size = size;
+		grid.clear();
+		for (auto &emitter : emitters)
+		{
+			AudioObject_Impl *obj = emitter.impl.get();
+			if (obj->cell >= 0)
+				insert_bucket(obj);
 		}
+	}
+
+	int64_t AudioWorld_Impl::get_cell(const Vec3f &position) const
+	{
+		return get_cell_key(get_cell_coord(position.x, cell_size), get_cell_coord(position.y, cell_size), get_cell_coord(position.z, cell_size));
+	}
+
+	std::vector<AudioObject_Impl *> &AudioWorld_Impl::get_bucket(AudioObject_Impl *obj)
+	{
+		return obj->cell >= 0 ? grid[obj->cell] : unpositioned;
+	}
+
+	void AudioWorld_Impl::insert_bucket(AudioObject_Impl *obj)
+	{
+		obj->cell = obj->is_positional() ? get_cell(obj->position) : -1;
+		std::vector<AudioObject_Impl *> &bucket = get_bucket(obj);
+		obj->cell_index = (int)bucket.size();
+		bucket.push_back(obj);
+	}
+
+	void AudioWorld_Impl::remove_bucket(AudioObject_Impl *obj)
+	{
+		std::vector<AudioObject_Impl *> &bucket = get_bucket(obj);
+		AudioObject_Impl *last = bucket.back();
+		bucket[obj->cell_index] = last;
+		last->cell_index = obj->cell_index;
+		bucket.pop_back();
+
+		if (obj->cell >= 0 && bucket.empty())
+			grid.erase(obj->cell);
+		obj->cell_index = -1;
+	}
+
+	void AudioWorld_Impl::remove_real_voice(AudioObject_Impl *obj)
+	{
+		AudioObject_Impl *last = real_voices.back();
+		real_voices[obj->real_index] = last;
+		last->real_index = obj->real_index;
+		real_voices.pop_back();
+		obj->real_index = -1;
+	}
+
+	void AudioWorld_Impl::set_expire_time(AudioObject_Impl *obj)
+	{
+		if (obj->looping || obj->sound_frequency <= 0)
+			emitter_expire_time[obj->index] = std::numeric_limits<double>::infinity();
 		else
+			emitter_expire_time[obj->index] = obj->virtual_time + (obj->sound_length - obj->virtual_position) / obj->sound_frequency;
+	}
+
+	void AudioWorld_Impl::probe_sound(AudioObject_Impl *obj)
+	{
+		// A virtual one-shot voice needs the length of its sound to know when it ends
+		if (obj->sound_length == 0 && !obj->looping)
 		{
-			obj->session.set_volume(obj->volume);
-			obj->session.set_pan(0.0f);
+			SoundBuffer_Session session = obj->sound.prepare(false);
+			obj->sound_length = session.get_length();
+			obj->sound_frequency = session.get_frequency();
 		}
 	}
 }
@@ -28,10 +28,13 @@
 
 #pragma once
 
-#include <list>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
 #include "API/Core/Math/vec3.h"
 #include "API/Core/Math/quaternion.h"
 #include "API/Core/Resources/resource_manager.h"
+#include "API/Sound/AudioWorld/audio_object.h"
 
 namespace clan
 {
@@ -43,10 +46,58 @@ namespace clan
 		AudioWorld_Impl(const ResourceManager &resources);
 		~AudioWorld_Impl();
 
-		void update_session(AudioObject_Impl *obj);
+		void update();
 
-		std::list<AudioObject_Impl *> objects;
-		std::list<AudioObject> active_objects;
+		void add_emitter(const AudioObject &object);
+		void remove_emitter(AudioObject_Impl *obj);
+		void update_emitter(AudioObject_Impl *obj);
+
+		/// \brief Calculates volume and pan for the emitters at the given indices
+		void evaluate(const int *indices, int count, float *out_volume, float *out_pan);
+
+		/// \brief Starts a mixer session at the tracked play position. Returns false if a one-shot sound already ended.
+		bool make_real(AudioObject_Impl *obj, float volume, float pan);
+
+		/// \brief Stops the mixer session and keeps tracking the play position by time
+		void make_virtual(AudioObject_Impl *obj);
+
+		void set_cell_size(float size);
+		double get_time() const;
+
+		// Playing emitters as structure of arrays, indexed by AudioObject_Impl::index
+		std::vector<AudioObject> emitters;
+		std::vector<float> emitter_x;
+		std::vector<float> emitter_y;
+		std::vector<float> emitter_z;
+		std::vector<float> emitter_attenuation_begin;
+		std::vector<float> emitter_attenuation_end;
+		std::vector<float> emitter_volume;
+		std::vector<int> emitter_priority;
+		std::vector<double> emitter_expire_time;
+		std::vector<unsigned int> emitter_selected;
+
+		// Spatial grid of positional emitters
+		std::unordered_map<int64_t, std::vector<AudioObject_Impl *>> grid;
+		std::vector<AudioObject_Impl *> unpositioned;
+		float cell_size;
+		float max_range;
+		bool max_range_dirty;
+
+		std::vector<AudioObject_Impl *> real_voices;
+		int max_voices;
+		unsigned int frame;
+
+		// Scratch buffers for update()
+		std::vector<int> candidates;
+		std::vector<float> candidate_dx;
+		std::vector<float> candidate_dy;
+		std::vector<float> candidate_dz;
+		std::vector<float> candidate_begin;
+		std::vector<float> candidate_end;
+		std::vector<float> candidate_volume;
+		std::vector<float> candidate_pan;
+		std::vector<int> selected;
+		std::vector<AudioObject_Impl *> ended;
 
 		Vec3f listener_position;
 		Quaternionf listener_orientation;
@@ -54,5 +105,17 @@ namespace clan
 		bool reverse_stereo;
 
 		ResourceManager resources;
+
+	private:
+		int64_t get_cell(const Vec3f &position) const;
+		std::vector<AudioObject_Impl *> &get_bucket(AudioObject_Impl *obj);
+		void insert_bucket(AudioObject_Impl *obj);
+		void remove_bucket(AudioObject_Impl *obj);
+		void remove_real_voice(AudioObject_Impl *obj);
+		void set_expire_time(AudioObject_Impl *obj);
+		void probe_sound(AudioObject_Impl *obj);
+		void find_candidates();
+
+		std::chrono::steady_clock::time_point start_time;
 	};
 }
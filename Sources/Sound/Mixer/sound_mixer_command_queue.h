@@ -0,0 +1,176 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "API/Sound/soundfilter.h"
+
+namespace clan
+{
+	class SoundBuffer_Session_Impl;
+
+	/// \brief Lock-free queue of voice commands from API threads to the mixer thread
+	///
+	/// Everything that changes the playback state of a session goes through here, so the mixer is
+	/// the only thread touching the provider session and the voice buffers. Any thread may push commands. Only the mixer thread takes them, all pending commands at once
+	/// and in the order they were pushed.
+	///
+	/// Processed commands are handed back on a free list and reused by push, so once the queue has
+	/// seen its largest burst neither side allocates or frees memory.
+	class SoundMixerCommandQueue
+	{
+	public:
+		enum Type
+		{
+			command_play,
+			command_stop,
+			command_stop_all,
+			command_set_position,
+			command_set_end_position,
+			command_set_looping,
+			command_set_resampler_quality,
+			command_add_filter,
+			command_remove_filter
+		};
+
+		struct Command
+		{
+			Type type;
+			std::shared_ptr<SoundBuffer_Session_Impl> session;
+			int value;
+			SoundFilter filter;
+			Command *next;
+			Command *last; // On the free list: the last node of the chain this node starts
+		};
+
+		SoundMixerCommandQueue() : pending(nullptr), free_commands(nullptr)
+		{
+		}
+
+		~SoundMixerCommandQueue()
+		{
+			process([](Command &) {});
+
+			Command *list = free_commands.exchange(nullptr);
+			while (list)
+			{
+				Command *next = list->next;
+				delete list;
+				list = next;
+			}
+		}
+
+		void push(Type type, const std::shared_ptr<SoundBuffer_Session_Impl> &session, int value = 0, const SoundFilter &filter = SoundFilter())
+		{
+			Command *command = allocate();
+			command->type = type;
+			command->session = session;
+			command->value = value;
+			command->filter = filter;
+			push_list(pending, command, command);
+		}
+
+		/// \brief Calls func for every pending command, oldest first
+		template<typename Func>
+		void process(Func func)
+		{
+			// Taking the whole list means no other thread can pop, so there is no ABA problem
+			Command *list = pending.exchange(nullptr, std::memory_order_acquire);
+			if (!list)
+				return;
+
+			Command *ordered = nullptr;
+			while (list)
+			{
+				Command *next = list->next;
+				list->next = ordered;
+				ordered = list;
+				list = next;
+			}
+
+			Command *recycled = nullptr;
+			Command *recycled_last = nullptr;
+			while (ordered)
+			{
+				Command *next = ordered->next;
+				func(*ordered);
+				ordered->session.reset();
+				ordered->filter = SoundFilter();
+
+				ordered->next = recycled;
+				if (!recycled_last)
+					recycled_last = ordered;
+				recycled = ordered;
+				ordered = next;
+			}
+			recycled->last = recycled_last;
+			push_list(free_commands, recycled, recycled_last);
+		}
+
+	private:
+		Command *allocate()
+		{
+			// Like process, take the whole free list so no other thread pops from it at the same time
+			Command *list = free_commands.exchange(nullptr, std::memory_order_acquire);
+			if (!list)
+				return new Command{ command_play, nullptr, 0, SoundFilter(), nullptr, nullptr };
+
+			// Put the rest back as a single chain. Finding its end only visits the first node of each chain.
+			Command *rest = list->next;
+			if (rest)
+			{
+				if (list->last != list)
+					rest->last = list->last;
+				Command *last = rest->last;
+				while (last->next)
+					last = last->next->last;
+				rest->last = last;
+				push_list(free_commands, rest, last);
+			}
+			list->next = nullptr;
+			return list;
+		}
+
+		static void push_list(std::atomic<Command *> &stack, Command *first, Command *last)
+		{
+			Command *head = stack.load(std::memory_order_relaxed);
+			do
+			{
+				last->next = head;
+			} while (!stack.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		std::atomic<Command *> pending;
+		std::atomic<Command *> free_commands;
+
+		SoundMixerCommandQueue(const SoundMixerCommandQueue &) = delete;
+		SoundMixerCommandQueue &operator=(const SoundMixerCommandQueue &) = delete;
+	};
+}
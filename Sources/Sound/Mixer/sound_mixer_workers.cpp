@@ -0,0 +1,184 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Sound/precomp.h"
+#include "sound_mixer_workers.h"
+#include "Sound/soundbuffer_session_impl.h"
+#include "API/Sound/sound_sse.h"
+#include <algorithm>
+
+namespace clan
+{
+	SoundMixerWorkers::SoundMixerWorkers()
+	{
+	}
+
+	SoundMixerWorkers::~SoundMixerWorkers()
+	{
+		stop_workers();
+	}
+
+	void SoundMixerWorkers::set_num_threads(int num_threads)
+	{
+		num_threads = std::max(std::min(num_threads, max_threads), 1);
+		if (num_threads == get_num_threads())
+			return;
+
+		stop_workers();
+
+		stop_flag = false;
+		for (int i = 1; i < num_threads; i++)
+		{
+			workers.push_back(std::unique_ptr<Worker>(new Worker()));
+			Worker *worker = workers.back().get();
+			worker->thread = std::thread(&SoundMixerWorkers::worker_main, this, worker);
+		}
+	}
+
+	void SoundMixerWorkers::stop_workers()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		stop_flag = true;
+		mutex_lock.unlock();
+		start_event.notify_all();
+
+		for (auto &worker : workers)
+		{
+			worker->thread.join();
+			for (int channel = 0; channel < 2; channel++)
+			{
+				SoundSSE::aligned_free(worker->mix_buffers[channel]);
+				SoundSSE::aligned_free(worker->temp_buffers[channel]);
+			}
+		}
+		workers.clear();
+	}
+
+	void SoundMixerWorkers::mix(const std::vector<std::shared_ptr<SoundBuffer_Session_Impl>> &voices, std::vector<char> &ended, float **mix_buffers, float **temp_buffers, int num_samples)
+	{
+		int num_voices = int(voices.size());
+		int num_groups = std::min(get_num_threads(), num_voices / min_voices_per_group);
+		if (num_groups <= 1)
+		{
+			mix_group(voices, ended, 0, num_voices, mix_buffers, temp_buffers, num_samples);
+			return;
+		}
+
+		int group_size = (num_voices + num_groups - 1) / num_groups;
+
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		job_voices = &voices;
+		job_ended = &ended;
+		job_num_samples = num_samples;
+		pending = 0;
+		for (int i = 0; i < (int)workers.size(); i++)
+		{
+			Worker *worker = workers[i].get();
+			worker->begin = std::min((i + 1) * group_size, num_voices);
+			worker->end = std::min((i + 2) * group_size, num_voices);
+			worker->active = worker->begin < worker->end;
+			if (worker->active)
+				pending++;
+		}
+		generation++;
+		mutex_lock.unlock();
+		start_event.notify_all();
+
+		// The first group is mixed on this thread, directly into the output
+		mix_group(voices, ended, 0, std::min(group_size, num_voices), mix_buffers, temp_buffers, num_samples);
+
+		mutex_lock.lock();
+		done_event.wait(mutex_lock, [&]() { return pending == 0; });
+		mutex_lock.unlock();
+
+		// Sum the groups of the workers
+		float *worker_channels[2][max_threads];
+		float volumes[max_threads];
+		int num_inputs = 0;
+		for (auto &worker : workers)
+		{
+			if (worker->active)
+			{
+				worker_channels[0][num_inputs] = worker->mix_buffers[0];
+				worker_channels[1][num_inputs] = worker->mix_buffers[1];
+				volumes[num_inputs] = 1.0f;
+				num_inputs++;
+			}
+		}
+		SoundSSE::mix_many_to_one(worker_channels[0], volumes, num_inputs, num_samples, mix_buffers[0]);
+		SoundSSE::mix_many_to_one(worker_channels[1], volumes, num_inputs, num_samples, mix_buffers[1]);
+	}
+
+	void SoundMixerWorkers::mix_group(const std::vector<std::shared_ptr<SoundBuffer_Session_Impl>> &voices, std::vector<char> &ended, int begin, int end, float **mix_buffers, float **temp_buffers, int num_samples)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			bool playing = voices[i]->mix_to(mix_buffers, temp_buffers, num_samples, 2);
+			ended[i] = !playing;
+		}
+	}
+
+	void SoundMixerWorkers::worker_main(Worker *worker)
+	{
+		int last_generation = 0;
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		while (true)
+		{
+			start_event.wait(mutex_lock, [&]() { return stop_flag || generation != last_generation; });
+			if (stop_flag)
+				break;
+
+			last_generation = generation;
+			if (!worker->active)
+				continue;
+
+			int num_samples = job_num_samples;
+			mutex_lock.unlock();
+
+			if (worker->buffer_size < num_samples)
+			{
+				for (int channel = 0; channel < 2; channel++)
+				{
+					SoundSSE::aligned_free(worker->mix_buffers[channel]);
+					SoundSSE::aligned_free(worker->temp_buffers[channel]);
+					worker->mix_buffers[channel] = (float *)SoundSSE::aligned_alloc(sizeof(float) * num_samples);
+					worker->temp_buffers[channel] = (float *)SoundSSE::aligned_alloc(sizeof(float) * num_samples);
+				}
+				worker->buffer_size = num_samples;
+			}
+
+			SoundSSE::set_float(worker->mix_buffers[0], num_samples, 0.0f);
+			SoundSSE::set_float(worker->mix_buffers[1], num_samples, 0.0f);
+			mix_group(*job_voices, *job_ended, worker->begin, worker->end, worker->mix_buffers, worker->temp_buffers, num_samples);
+
+			mutex_lock.lock();
+			if (--pending == 0)
+				done_event.notify_one();
+		}
+	}
+}
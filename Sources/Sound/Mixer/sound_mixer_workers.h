@@ -0,0 +1,95 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace clan
+{
+	class SoundBuffer_Session_Impl;
+
+	/// \brief Mixes groups of voices in parallel on worker threads
+	///
+	/// Each worker mixes its group into buffers of its own, which are then summed into the
+	/// output by the mixer thread. Only the mixer thread may call the functions of this class.
+	class SoundMixerWorkers
+	{
+	public:
+		SoundMixerWorkers();
+		~SoundMixerWorkers();
+
+		/// \brief Sets the number of threads mixing, including the calling thread
+		void set_num_threads(int num_threads);
+
+		/// \brief Returns the number of threads mixing, including the calling thread
+		int get_num_threads() const { return int(workers.size()) + 1; }
+
+		/// \brief Mixes the voices into mix_buffers and sets ended for voices that stopped playing
+		///
+		/// Groups are only split off when each gets at least min_voices_per_group voices.
+		void mix(const std::vector<std::shared_ptr<SoundBuffer_Session_Impl>> &voices, std::vector<char> &ended, float **mix_buffers, float **temp_buffers, int num_samples);
+
+		static const int min_voices_per_group = 16;
+		static const int max_threads = 64;
+
+	private:
+		struct Worker
+		{
+			std::thread thread;
+			float *mix_buffers[2] = { nullptr, nullptr };
+			float *temp_buffers[2] = { nullptr, nullptr };
+			int buffer_size = 0;
+			int begin = 0;
+			int end = 0;
+			bool active = false;
+		};
+
+		void worker_main(Worker *worker);
+		void stop_workers();
+		static void mix_group(const std::vector<std::shared_ptr<SoundBuffer_Session_Impl>> &voices, std::vector<char> &ended, int begin, int end, float **mix_buffers, float **temp_buffers, int num_samples);
+
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		std::mutex mutex;
+		std::condition_variable start_event;
+		std::condition_variable done_event;
+		int generation = 0;
+		int pending = 0;
+		bool stop_flag = false;
+
+		// Job of the current generation
+		const std::vector<std::shared_ptr<SoundBuffer_Session_Impl>> *job_voices = nullptr;
+		std::vector<char> *job_ended = nullptr;
+		int job_num_samples = 0;
+	};
+}
@@ -32,9 +32,16 @@
 #include <API/Core/System/exception.h>
 #include "API/Core/System/system.h"
 #include "API/Core/Text/logger.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Sound/soundoutput_description.h"
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 
 #ifdef __linux__
 
@@ -44,42 +51,32 @@ namespace clan
 /////////////////////////////////////////////////////////////////////////////
 // SoundOutput_alsa construction:
 
-SoundOutput_alsa::SoundOutput_alsa(int mixing_frequency, int mixing_latency) :
-	SoundOutput_Impl(mixing_frequency, mixing_latency), frames_in_buffer(4096),
-	frames_in_period(1024)
+SoundOutput_alsa::SoundOutput_alsa(const SoundOutput_Description &desc) :
+	SoundOutput_Impl(desc.get_mixing_frequency(), desc.get_mixing_latency()), handle(nullptr),
+	frames_in_period(0), frames_in_buffer(0), use_mmap(false), realtime_priority(desc.get_realtime_priority())
 {
-	int rc;
-	snd_pcm_hw_params_t *hwparams;
-	
-	rc = snd_pcm_open(&handle, "default", SND_PCM_STREAM_PLAYBACK, 0);
+	std::string device = desc.get_device().empty() ? std::string("default") : desc.get_device();
+
+	int rc = snd_pcm_open(&handle, device.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
 	if (rc < 0)
 	{
-		log_event("warn", "ClanSound: Couldn't open sound device, disabling sound");
+		log_event("warn", "ClanSound: Couldn't open sound device %1, disabling sound", device);
 		handle = nullptr;
 		return;
 	}
 
-	snd_pcm_hw_params_alloca(&hwparams);
-	snd_pcm_hw_params_any(handle, hwparams);
-	snd_pcm_hw_params_set_access(handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED);
-	snd_pcm_hw_params_set_format(handle, hwparams, SND_PCM_FORMAT_FLOAT);
-	snd_pcm_hw_params_set_channels(handle, hwparams, 2);
-	snd_pcm_hw_params_set_rate_near(handle, hwparams,
-				(unsigned int *)&this->mixing_frequency, nullptr);
-	snd_pcm_hw_params_set_buffer_size_near(handle, hwparams, &frames_in_buffer);
-	frames_in_period = frames_in_buffer / 4;
-	snd_pcm_hw_params_set_period_size_near(handle, hwparams, &frames_in_period, nullptr);
-	
-	rc = snd_pcm_hw_params(handle, hwparams);
-	if (rc < 0)
+	// Fall back to read/write transfers and a longer buffer if the device rejects the low latency setup
+	bool low_latency = desc.is_low_latency();
+	if (!(set_hw_params(low_latency) || (low_latency && set_hw_params(false))) || !set_sw_params())
 	{
 		log_event("warn", "ClanSound: Couldn't initialize sound device, disabling sound");
 		snd_pcm_close(handle);
 		handle = nullptr;
 		return;
 	}
-	
-	snd_pcm_hw_params_get_period_size(hwparams, &frames_in_period, nullptr);
+
+	log_event("debug", "ClanSound: ALSA period %1 frames, buffer %2 frames, %3 transfers", (int)frames_in_period, (int)frames_in_buffer, use_mmap ? "mmap" : "read/write");
+	update_latency();
 
 	start_mixer_thread();
 }
@@ -127,14 +124,14 @@ int SoundOutput_alsa::get_fragment_size()
 
 void SoundOutput_alsa::write_fragment(float *data)
 {
-	snd_pcm_sframes_t rc;
-
 	if (handle == nullptr) return;
 
 	switch(snd_pcm_state(handle)) {
 		case SND_PCM_STATE_XRUN:
+			recover(-EPIPE);
+			break;
 		case SND_PCM_STATE_SUSPENDED:
-			snd_pcm_prepare(handle);
+			recover(-ESTRPIPE);
 			break;
 		case SND_PCM_STATE_PAUSED:
 			snd_pcm_pause(handle, 0);
@@ -143,9 +140,12 @@ void SoundOutput_alsa::write_fragment(float *data)
 			break;
 	}
 
-	rc = snd_pcm_writei(handle, data, frames_in_period);
-	if (rc < 0)
-		log_event("debug", "ClanSound: snd_pcm_writei() failed!");
+	if (use_mmap)
+		write_mmap(data);
+	else
+		write_rw(data);
+
+	update_latency();
 }
 
 void SoundOutput_alsa::wait()
@@ -159,9 +159,174 @@ void SoundOutput_alsa::wait()
 	snd_pcm_wait(handle, 1000);
 }
 
+void SoundOutput_alsa::mixer_thread_starting()
+{
+	if (realtime_priority <= 0)
+		return;
+
+	sched_param param;
+	param.sched_priority = clamp(realtime_priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+		log_event("warn", "ClanSound: Couldn't set real-time priority for the mixer thread");
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // SoundOutput_alsa implementation:
 
+bool SoundOutput_alsa::set_hw_params(bool low_latency)
+{
+	snd_pcm_hw_params_t *hwparams;
+	snd_pcm_hw_params_alloca(&hwparams);
+	if (snd_pcm_hw_params_any(handle, hwparams) < 0)
+		return false;
+
+	use_mmap = low_latency && snd_pcm_hw_params_set_access(handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+	if (!use_mmap && snd_pcm_hw_params_set_access(handle, hwparams, SND_PCM_ACCESS_RW_INTERLEAVED) < 0)
+		return false;
+	if (snd_pcm_hw_params_set_format(handle, hwparams, SND_PCM_FORMAT_FLOAT) < 0)
+		return false;
+	if (snd_pcm_hw_params_set_channels(handle, hwparams, 2) < 0)
+		return false;
+
+	unsigned int rate = mixing_frequency;
+	if (snd_pcm_hw_params_set_rate_near(handle, hwparams, &rate, nullptr) < 0)
+		return false;
+
+	int dir = 0;
+	if (low_latency)
+	{
+		// Two periods totalling the mixing latency. The period is rounded to 16 frames, which most DMA engines transfer in whole.
+		snd_pcm_uframes_t target_buffer = std::max((snd_pcm_uframes_t)rate * mixing_latency / 1000, (snd_pcm_uframes_t)32);
+		snd_pcm_uframes_t period = std::max((target_buffer / 2 + 8) / 16 * 16, (snd_pcm_uframes_t)16);
+		if (snd_pcm_hw_params_set_period_size_near(handle, hwparams, &period, &dir) < 0)
+			return false;
+		snd_pcm_uframes_t buffer = period * 2;
+		if (snd_pcm_hw_params_set_buffer_size_near(handle, hwparams, &buffer) < 0)
+			return false;
+	}
+	else
+	{
+		// Same sizing as before the low latency mode existed: 4096 frames in four periods
+		snd_pcm_uframes_t buffer = 4096;
+		if (snd_pcm_hw_params_set_buffer_size_near(handle, hwparams, &buffer) < 0)
+			return false;
+		snd_pcm_uframes_t period = buffer / 4;
+		if (snd_pcm_hw_params_set_period_size_near(handle, hwparams, &period, &dir) < 0)
+			return false;
+	}
+
+	if (snd_pcm_hw_params(handle, hwparams) < 0)
+		return false;
+
+	snd_pcm_hw_params_get_period_size(hwparams, &frames_in_period, &dir);
+	snd_pcm_hw_params_get_buffer_size(hwparams, &frames_in_buffer);
+	mixing_frequency = rate;
+	return true;
+}
+
+bool SoundOutput_alsa::set_sw_params()
+{
+	snd_pcm_sw_params_t *swparams;
+	snd_pcm_sw_params_alloca(&swparams);
+	if (snd_pcm_sw_params_current(handle, swparams) < 0)
+		return false;
+	if (snd_pcm_sw_params_set_start_threshold(handle, swparams, frames_in_period) < 0)
+		return false;
+	if (snd_pcm_sw_params_set_avail_min(handle, swparams, frames_in_period) < 0)
+		return false;
+	return snd_pcm_sw_params(handle, swparams) == 0;
+}
+
+void SoundOutput_alsa::write_rw(float *data)
+{
+	snd_pcm_uframes_t written = 0;
+	while (written < frames_in_period)
+	{
+		snd_pcm_sframes_t rc = snd_pcm_writei(handle, data + written * 2, frames_in_period - written);
+		if (rc < 0)
+		{
+			if (!recover((int)rc))
+				return;
+		}
+		else
+		{
+			written += rc;
+		}
+	}
+}
+
+void SoundOutput_alsa::write_mmap(float *data)
+{
+	snd_pcm_uframes_t written = 0;
+	while (written < frames_in_period)
+	{
+		snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+		if (avail < 0)
+		{
+			if (!recover((int)avail))
+				return;
+			continue;
+		}
+
+		if (avail == 0)
+		{
+			// Buffer is full: make sure it is draining, then wait for a free period
+			if (snd_pcm_state(handle) == SND_PCM_STATE_PREPARED)
+				snd_pcm_start(handle);
+			int rc = snd_pcm_wait(handle, 1000);
+			if (rc == 0 || (rc < 0 && !recover(rc)))
+				return;
+			continue;
+		}
+
+		const snd_pcm_channel_area_t *areas = nullptr;
+		snd_pcm_uframes_t offset = 0;
+		snd_pcm_uframes_t frames = std::min((snd_pcm_uframes_t)avail, frames_in_period - written);
+		int rc = snd_pcm_mmap_begin(handle, &areas, &offset, &frames);
+		if (rc < 0)
+		{
+			if (!recover(rc))
+				return;
+			continue;
+		}
+
+		// Interleaved stereo: the left channel area addresses both channels
+		char *dest = (char *)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+		memcpy(dest, data + written * 2, frames * 2 * sizeof(float));
+
+		snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, frames);
+		if (committed < 0 || (snd_pcm_uframes_t)committed != frames)
+		{
+			if (!recover(committed < 0 ? (int)committed : -EPIPE))
+				return;
+			continue;
+		}
+		written += frames;
+	}
+}
+
+bool SoundOutput_alsa::recover(int err)
+{
+	if (err == -EPIPE)
+		count_xrun();
+
+	int rc = snd_pcm_recover(handle, err, 1);
+	if (rc < 0)
+	{
+		log_event("debug", "ClanSound: ALSA could not recover from %1", snd_strerror(err));
+		return false;
+	}
+	return true;
+}
+
+void SoundOutput_alsa::update_latency()
+{
+	snd_pcm_sframes_t delay = 0;
+	if (snd_pcm_delay(handle, &delay) < 0)
+		delay = 0;
+	set_device_latency(frames_in_buffer * 1000000.0 / mixing_frequency, std::max(delay, (snd_pcm_sframes_t)0) * 1000000.0 / mixing_frequency);
+}
+
 }
 
 #endif
@@ -42,11 +42,13 @@
 namespace clan
 {
 
+class SoundOutput_Description;
+
 class SoundOutput_alsa : public SoundOutput_Impl
 {
 //! Construction:
 public:
-	SoundOutput_alsa(int mixing_frequency, int mixing_latency);
+	SoundOutput_alsa(const SoundOutput_Description &desc);
 	
 	~SoundOutput_alsa();
 
@@ -56,6 +58,12 @@ public:
 	snd_pcm_uframes_t frames_in_period;
 	snd_pcm_uframes_t frames_in_buffer;
 
+	//: True if fragments are copied straight into the device buffer.
+	bool use_mmap;
+
+	//: SCHED_FIFO priority of the mixer thread, or 0.
+	int realtime_priority;
+
 //! Operations:
 public:
 	//: Called when we have no samples to play - and wants to tell the soundcard
@@ -74,8 +82,25 @@ public:
 	//: Waits until output source isn't full anymore.
 	virtual void wait() override;
 
+	//: Raises the mixer thread to real-time scheduling if requested.
+	virtual void mixer_thread_starting() override;
+
 //! Implementation:
 private:
+	//: Negotiates a period and buffer size close to the mixing latency.
+	bool set_hw_params(bool low_latency);
+
+	//: Starts playback after the first period and wakes the mixer for every free period.
+	bool set_sw_params();
+
+	void write_rw(float *data);
+	void write_mmap(float *data);
+
+	//: Recovers from an xrun or suspend. Returns false if the device could not be recovered.
+	bool recover(int err);
+
+	//: Reports the buffer latency and current delay to the mixer statistics.
+	void update_latency();
 };
 
 }
@@ -62,6 +62,8 @@ SoundOutput_OSS::SoundOutput_OSS(int mixing_frequency, int mixing_latency) :
 	{
 		has_sound = false;
 		frag_size = mixing_frequency/2;
+		// Keep mixing without a device, so sessions still advance and end
+		start_mixer_thread();
 		return;
 //		throw Error("Could not open " + DEFAULT_DSP + ". No sound will be available.");
 	}
@@ -158,6 +160,7 @@ int SoundOutput_OSS::get_fragment_size()
 
 void SoundOutput_OSS::write_fragment(float *data)
 {
+	if (!has_sound) return;
 
 	// OSS Cannot handle floats (why!)
 	std::vector<int16_t> buffer;
@@ -29,7 +29,9 @@
 
 #include "Sound/precomp.h"
 #include "echofilter_provider.h"
+#include "API/Sound/sound_sse.h"
 #include <memory.h>
+#include <algorithm>
 
 namespace clan
 {
@@ -52,25 +54,20 @@ namespace clan
 
 	void EchoFilterProvider::filter(float **sample_data, int num_samples, int channels)
 	{
-		int start_pos = pos;
+		float feedback = 1.0f / shift_factor;
+		channels = std::min(channels, 2);
 
-		for (int c = 0; c < 2; c++)
+		// Process the contiguous runs between the wraps of the ring buffer
+		int done = 0;
+		while (done < num_samples)
 		{
-			if (c == channels) break;
+			int run = std::min(num_samples - done, buffer_size - pos);
+			for (int c = 0; c < channels; c++)
+				SoundSSE::feedback_delay(sample_data[c] + done, buffer[c] + pos, run, feedback);
 
-			float *data = sample_data[c];
-			float *work_buffer = buffer[c];
-
-			pos = start_pos;
-
-			for (int i = 0; i < num_samples; i++)
-			{
-				work_buffer[pos] /= shift_factor;
-				work_buffer[pos] += data[i];
-				data[i] = work_buffer[pos];
-				pos++;
-				if (pos == buffer_size) pos = 0;
-			}
+			done += run;
+			pos += run;
+			if (pos == buffer_size) pos = 0;
 		}
 	}
 }
@@ -30,7 +30,9 @@
 #include "Sound/precomp.h"
 
 #include "inverse_echofilter_provider.h"
+#include "API/Sound/sound_sse.h"
 #include <memory>
+#include <algorithm>
 
 #ifndef WIN32
 #include <string.h>
@@ -57,35 +59,42 @@ namespace clan
 
 	void InverseEchoFilterProvider::filter(float **sample_data, int num_samples, int channels)
 	{
-		int start_pos = pos;
-
-		for (int c = 0; c < 2; c++)
+		const int num_taps = 4;
+		int delay = buffer_size / num_taps;
+		float volumes[num_taps];
+		for (int j = 0; j < num_taps; j++)
+			volumes[j] = 1.0f / (5 - j);
+
+		channels = std::min(channels, 2);
+
+		// Process contiguous runs in which no tap wraps. Runs are at most one delay long,
+		// so the later taps never read samples written by the same run.
+		int done = 0;
+		while (done < num_samples)
 		{
-			if (c == channels) break;
-
-			float *work_buffer = buffer[c];
-
-			pos = start_pos;
-
-			int delay = buffer_size / 4;
-			for (int i = 0; i < num_samples; i++)
+			int run = std::min(num_samples - done, std::max(delay, 1));
+			int tap_pos[num_taps];
+			for (int j = 0; j < num_taps; j++)
 			{
-				work_buffer[pos] = sample_data[c][i];
-
-				int res = 0;
-				for (int j = 0; j < 4; j++)
-				{
-					int p = pos + delay*j;
-					if (p >= buffer_size) p -= buffer_size;
-
-					res += work_buffer[p] / (5 - j);
-				}
-
-				sample_data[c][i] = res;
+				tap_pos[j] = (pos + delay * j) % buffer_size;
+				run = std::min(run, buffer_size - tap_pos[j]);
+			}
 
-				pos++;
-				if (pos == buffer_size) pos = 0;
+			for (int c = 0; c < channels; c++)
+			{
+				float *data = sample_data[c] + done;
+				float *taps[num_taps];
+				for (int j = 0; j < num_taps; j++)
+					taps[j] = buffer[c] + tap_pos[j];
+
+				SoundSSE::copy_float(data, run, buffer[c] + pos);
+				SoundSSE::set_float(data, run, 0.0f);
+				SoundSSE::mix_many_to_one(taps, volumes, num_taps, run, data);
 			}
+
+			done += run;
+			pos += run;
+			if (pos == buffer_size) pos = 0;
 		}
 	}
 }
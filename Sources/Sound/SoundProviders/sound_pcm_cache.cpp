@@ -0,0 +1,365 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Sound/precomp.h"
+#include "sound_pcm_cache_impl.h"
+#include "API/Sound/SoundProviders/sound_pcm_cache.h"
+#include "stb_vorbis.h"
+#include <chrono>
+#include <algorithm>
+
+namespace clan
+{
+	SoundPCMCache_Impl &SoundPCMCache_Impl::instance()
+	{
+		static SoundPCMCache_Impl cache;
+		return cache;
+	}
+
+	SoundPCMCache_Impl::~SoundPCMCache_Impl()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		stop_flag = true;
+		mutex_lock.unlock();
+		worker_event.notify_all();
+
+		if (thread.joinable())
+			thread.join();
+	}
+
+	int64_t SoundPCMCache_Impl::add(const DataBuffer &encoded)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		if (budget <= 0)
+			return 0;
+
+		int64_t key = next_key++;
+		Entry &entry = entries[key];
+		entry.encoded = encoded;
+		entry.lru_position = lru.end();
+		queue(key, entry);
+		return key;
+	}
+
+	void SoundPCMCache_Impl::remove(int64_t key)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		auto it = entries.find(key);
+		if (it == entries.end())
+			return;
+
+		drop_clip(it->second);
+		entries.erase(it);
+	}
+
+	std::shared_ptr<const SoundPCMClip> SoundPCMCache_Impl::find(int64_t key)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		auto it = entries.find(key);
+		if (it == entries.end() || it->second.uncacheable)
+			return nullptr;
+
+		Entry &entry = it->second;
+		if (entry.clip)
+		{
+			hits++;
+			decode_time_saved += entry.decode_time;
+			lru.splice(lru.begin(), lru, entry.lru_position);
+			return entry.clip;
+		}
+
+		misses++;
+		if (budget > 0)
+			queue(key, entry);
+		return nullptr;
+	}
+
+	void SoundPCMCache_Impl::wait_idle()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		idle_event.wait(mutex_lock, [&]() { return queued.empty() && !decoding; });
+	}
+
+	void SoundPCMCache_Impl::evict(int64_t target)
+	{
+		while (cached_bytes > target && !lru.empty())
+		{
+			Entry &entry = entries[lru.back()];
+			drop_clip(entry);
+			evictions++;
+		}
+	}
+
+	void SoundPCMCache_Impl::queue(int64_t key, Entry &entry)
+	{
+		if (entry.pending)
+			return;
+
+		entry.pending = true;
+		if (!thread.joinable())
+			thread = std::thread(&SoundPCMCache_Impl::worker_main, this);
+		queued.push_back(key);
+		worker_event.notify_one();
+	}
+
+	void SoundPCMCache_Impl::drop_clip(Entry &entry)
+	{
+		if (entry.clip)
+		{
+			cached_bytes -= entry.clip->get_size();
+			num_clips--;
+			entry.clip.reset();
+			lru.erase(entry.lru_position);
+			entry.lru_position = lru.end();
+		}
+	}
+
+	void SoundPCMCache_Impl::worker_main()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		while (true)
+		{
+			worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued.empty(); });
+			if (stop_flag)
+				break;
+
+			int64_t key = queued.front();
+			queued.pop_front();
+			auto it = entries.find(key);
+			if (it == entries.end() || it->second.clip)
+			{
+				if (queued.empty())
+					idle_event.notify_all();
+				continue;
+			}
+
+			DataBuffer encoded = it->second.encoded;
+			int64_t max_size = std::min(max_clip_size, budget);
+			decoding = true;
+			mutex_lock.unlock();
+
+			auto start_time = std::chrono::steady_clock::now();
+			std::shared_ptr<SoundPCMClip> clip;
+			try
+			{
+				clip = decode(encoded, max_size);
+			}
+			catch (const Exception &)
+			{
+				// Sessions will report the error when they decode the clip themselves
+			}
+			double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+
+			mutex_lock.lock();
+			decoding = false;
+			decode_time += time;
+			it = entries.find(key);
+			if (it != entries.end())
+			{
+				Entry &entry = it->second;
+				entry.pending = false;
+				if (!clip)
+				{
+					entry.uncacheable = true;
+				}
+				else if (budget > 0)
+				{
+					evict(budget - clip->get_size());
+					entry.clip = clip;
+					entry.decode_time = time;
+					lru.push_front(key);
+					entry.lru_position = lru.begin();
+					cached_bytes += clip->get_size();
+					num_clips++;
+				}
+			}
+
+			if (queued.empty())
+				idle_event.notify_all();
+		}
+	}
+
+	std::shared_ptr<SoundPCMClip> SoundPCMCache_Impl::decode(const DataBuffer &encoded, int64_t max_size)
+	{
+		int error = 0;
+		stb_vorbis *handle = stb_vorbis_open_memory((unsigned char *)encoded.get_data(), encoded.get_size(), &error, nullptr);
+		if (!handle)
+			throw Exception("Unable to read ogg file");
+
+		stb_vorbis_info info = stb_vorbis_get_info(handle);
+		int64_t length = stb_vorbis_stream_length_in_samples(handle);
+		if (length <= 0 || length * info.channels * int64_t(sizeof(float)) > max_size)
+		{
+			stb_vorbis_close(handle);
+			return nullptr;
+		}
+
+		auto clip = std::make_shared<SoundPCMClip>();
+		clip->frequency = info.sample_rate;
+		clip->channels.resize(info.channels);
+		for (auto &channel : clip->channels)
+			channel.resize(length);
+
+		int num_samples = 0;
+		while (true)
+		{
+			int num_channels = 0;
+			float **frame = nullptr;
+			int samples = stb_vorbis_get_frame_float(handle, &num_channels, &frame);
+			if (samples <= 0)
+				break;
+
+			samples = std::min(samples, int(length) - num_samples);
+			for (int c = 0; c < info.channels; c++)
+				memcpy(clip->channels[c].data() + num_samples, frame[c], samples * sizeof(float));
+			num_samples += samples;
+			if (num_samples == length)
+				break;
+		}
+		stb_vorbis_close(handle);
+
+		clip->num_samples = num_samples;
+		for (auto &channel : clip->channels)
+		{
+			channel.resize(num_samples);
+			channel.shrink_to_fit();
+		}
+		return clip;
+	}
+
+	int64_t SoundPCMCache::get_budget()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.budget;
+	}
+
+	int64_t SoundPCMCache::get_max_clip_size()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.max_clip_size;
+	}
+
+	int64_t SoundPCMCache::get_cached_bytes()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.cached_bytes;
+	}
+
+	int SoundPCMCache::get_num_clips()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.num_clips;
+	}
+
+	int64_t SoundPCMCache::get_hits()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.hits;
+	}
+
+	int64_t SoundPCMCache::get_misses()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.misses;
+	}
+
+	double SoundPCMCache::get_hit_rate()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		int64_t total = cache.hits + cache.misses;
+		return total > 0 ? cache.hits / double(total) : 0.0;
+	}
+
+	double SoundPCMCache::get_decode_time_saved()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.decode_time_saved;
+	}
+
+	double SoundPCMCache::get_decode_time()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.decode_time;
+	}
+
+	int64_t SoundPCMCache::get_evictions()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		return cache.evictions;
+	}
+
+	void SoundPCMCache::set_budget(int64_t bytes)
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		cache.budget = std::max(bytes, int64_t(0));
+		cache.evict(cache.budget);
+	}
+
+	void SoundPCMCache::set_max_clip_size(int64_t bytes)
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		cache.max_clip_size = bytes;
+	}
+
+	void SoundPCMCache::reset_counters()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		cache.hits = 0;
+		cache.misses = 0;
+		cache.evictions = 0;
+		cache.decode_time_saved = 0.0;
+		cache.decode_time = 0.0;
+	}
+
+	void SoundPCMCache::clear()
+	{
+		SoundPCMCache_Impl &cache = SoundPCMCache_Impl::instance();
+		std::unique_lock<std::mutex> mutex_lock(cache.mutex);
+		int64_t evictions = cache.evictions;
+		cache.evict(0);
+		cache.evictions = evictions;
+	}
+
+	void SoundPCMCache::wait_for_predecode()
+	{
+		SoundPCMCache_Impl::instance().wait_idle();
+	}
+}
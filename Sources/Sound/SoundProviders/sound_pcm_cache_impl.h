@@ -0,0 +1,121 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/databuffer.h"
+#include <vector>
+#include <list>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace clan
+{
+	/// \brief Decoded samples of a clip, shared by the sessions playing it
+	class SoundPCMClip
+	{
+	public:
+		int frequency = 0;
+		int num_samples = 0;
+		std::vector<std::vector<float>> channels;
+
+		int64_t get_size() const { return int64_t(channels.size()) * num_samples * sizeof(float); }
+	};
+
+	class SoundPCMCache_Impl
+	{
+	public:
+		static SoundPCMCache_Impl &instance();
+		~SoundPCMCache_Impl();
+
+		/// \brief Registers an encoded Ogg Vorbis clip and queues it for decoding
+		/** \return Key identifying the clip, or 0 if the cache is disabled.*/
+		int64_t add(const DataBuffer &encoded);
+
+		/// \brief Forgets a clip
+		void remove(int64_t key);
+
+		/// \brief Returns the decoded clip, or null if it is not decoded (yet)
+		///
+		/// Counts a hit or a miss. A miss queues the clip for decoding again.
+		std::shared_ptr<const SoundPCMClip> find(int64_t key);
+
+		/// \brief Waits until the queued clips are decoded
+		void wait_idle();
+
+		/// \brief Decodes a whole Ogg Vorbis clip, unless it decodes to more than max_size bytes
+		static std::shared_ptr<SoundPCMClip> decode(const DataBuffer &encoded, int64_t max_size);
+
+		std::mutex mutex;
+		std::condition_variable idle_event;
+
+		int64_t budget = 16 * 1024 * 1024;
+		int64_t max_clip_size = 1024 * 1024;
+		int64_t cached_bytes = 0;
+		int num_clips = 0;
+		int64_t hits = 0;
+		int64_t misses = 0;
+		int64_t evictions = 0;
+		double decode_time_saved = 0.0;
+		double decode_time = 0.0;
+
+		/// \brief Drops least recently used clips until the cached bytes are within the budget. Requires the mutex.
+		void evict(int64_t budget);
+
+	private:
+		SoundPCMCache_Impl() { }
+
+		struct Entry
+		{
+			DataBuffer encoded;
+			std::shared_ptr<const SoundPCMClip> clip;
+			double decode_time = 0.0;
+			bool pending = false;
+			bool uncacheable = false;
+			std::list<int64_t>::iterator lru_position;
+		};
+
+		void queue(int64_t key, Entry &entry);
+		void drop_clip(Entry &entry);
+		void worker_main();
+
+		std::map<int64_t, Entry> entries;
+		std::list<int64_t> lru; // Most recently used first
+		int64_t next_key = 1;
+
+		std::thread thread;
+		std::condition_variable worker_event;
+		std::deque<int64_t> queued;
+		bool decoding = false;
+		bool stop_flag = false;
+	};
+}
@@ -0,0 +1,260 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Sound/precomp.h"
+#include "sound_stream.h"
+#include "API/Sound/SoundProviders/sound_stream_stats.h"
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+
+namespace clan
+{
+	namespace
+	{
+		std::atomic<int64_t> streaming_bytes(0);
+		std::atomic<int64_t> loaded_bytes(0);
+		std::atomic<int64_t> bytes_streamed(0);
+		std::atomic<int> active_streams(0);
+		std::atomic<int> underruns(0);
+
+		/// \brief Background thread shared by all streaming sessions, refilling their ring buffers
+		class SoundStreamThread
+		{
+		public:
+			static SoundStreamThread &instance()
+			{
+				static SoundStreamThread stream_thread;
+				return stream_thread;
+			}
+
+			~SoundStreamThread()
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				stop_flag = true;
+				mutex_lock.unlock();
+				worker_event.notify_all();
+
+				if (thread.joinable())
+					thread.join();
+			}
+
+			void queue(std::shared_ptr<SoundStream> stream)
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				if (!thread.joinable())
+					thread = std::thread(&SoundStreamThread::worker_main, this);
+				queued.push_back(stream);
+				mutex_lock.unlock();
+				worker_event.notify_one();
+			}
+
+		private:
+			void worker_main()
+			{
+				while (true)
+				{
+					std::unique_lock<std::mutex> mutex_lock(mutex);
+					worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued.empty(); });
+
+					if (stop_flag)
+						break;
+
+					std::shared_ptr<SoundStream> stream = queued.front();
+					queued.erase(queued.begin());
+					mutex_lock.unlock();
+
+					try
+					{
+						stream->refill();
+					}
+					catch (const Exception &)
+					{
+						// The session will see the error when it reads the device itself
+					}
+				}
+			}
+
+			std::thread thread;
+			std::mutex mutex;
+			std::condition_variable worker_event;
+			std::vector<std::shared_ptr<SoundStream>> queued;
+			bool stop_flag = false;
+		};
+	}
+
+	SoundStream::SoundStream(IODevice device, int start_offset, int length, int ring_size)
+		: device(device), start_offset(start_offset), length(length), device_position(0), read_pos(0), write_pos(0), device_eof(length <= 0), refill_pending(false), position(0)
+	{
+		int size = 4096;
+		while (size < ring_size)
+			size *= 2;
+		ring.resize(size);
+		ring_mask = size - 1;
+
+		this->device.seek(start_offset);
+
+		streaming_bytes += size;
+		active_streams++;
+	}
+
+	SoundStream::~SoundStream()
+	{
+		streaming_bytes -= ring.size();
+		active_streams--;
+	}
+
+	int SoundStream::read(void *data, int size, int block_size)
+	{
+		// End of device is flagged after the last write, so it must be checked first
+		bool end_of_device = device_eof;
+		uint64_t read_offset = read_pos.load(std::memory_order_relaxed);
+		int available = int(write_pos.load(std::memory_order_acquire) - read_offset);
+
+		int bytes_read = std::min(available, size);
+		if (bytes_read < size && !end_of_device)
+		{
+			// Underrun. Waiting for the device would stall the mixer, so hand out the whole blocks there are.
+			underruns++;
+			bytes_read -= bytes_read % block_size;
+		}
+
+		unsigned char *dest = static_cast<unsigned char *>(data);
+		int ring_offset = int(read_offset & ring_mask);
+		int first_part = std::min(bytes_read, int(ring.size()) - ring_offset);
+		memcpy(dest, ring.data() + ring_offset, first_part);
+		memcpy(dest + first_part, ring.data(), bytes_read - first_part);
+		read_pos.store(read_offset + bytes_read, std::memory_order_release);
+
+		position += bytes_read;
+
+		if (!device_eof && write_pos.load(std::memory_order_relaxed) - read_pos.load(std::memory_order_relaxed) < ring.size() / 2)
+			request_refill();
+
+		return bytes_read;
+	}
+
+	void SoundStream::seek(int new_position)
+	{
+		std::unique_lock<std::mutex> mutex_lock(device_mutex);
+		new_position = std::max(0, std::min(new_position, length));
+		device.seek(start_offset + new_position);
+		device_position = new_position;
+		read_pos = 0;
+		write_pos = 0;
+		device_eof = (device_position >= length);
+		position = new_position;
+		mutex_lock.unlock();
+
+		request_refill();
+	}
+
+	bool SoundStream::eof() const
+	{
+		return device_eof && read_pos == write_pos;
+	}
+
+	void SoundStream::request_refill()
+	{
+		if (!device_eof && !refill_pending.exchange(true))
+			SoundStreamThread::instance().queue(shared_from_this());
+	}
+
+	void SoundStream::refill()
+	{
+		std::unique_lock<std::mutex> mutex_lock(device_mutex);
+		refill_pending = false;
+
+		while (!device_eof)
+		{
+			uint64_t write_offset = write_pos.load(std::memory_order_relaxed);
+			int space = int(ring.size() - (write_offset - read_pos.load(std::memory_order_acquire)));
+			int ring_offset = int(write_offset & ring_mask);
+			int bytes = std::min(std::min(space, length - device_position), int(ring.size()) - ring_offset);
+			if (bytes <= 0)
+				break;
+
+			int received = int(device.read(ring.data() + ring_offset, bytes));
+			if (received <= 0)
+			{
+				// Device ended before the range did
+				device_eof = true;
+				break;
+			}
+
+			device_position += received;
+			bytes_streamed += received;
+			write_pos.store(write_offset + received, std::memory_order_release);
+			if (device_position >= length)
+				device_eof = true;
+		}
+	}
+
+	void SoundStream::add_streaming_bytes(int64_t bytes)
+	{
+		streaming_bytes += bytes;
+	}
+
+	void SoundStream::add_loaded_bytes(int64_t bytes)
+	{
+		loaded_bytes += bytes;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	int64_t SoundStreamStats::get_streaming_bytes()
+	{
+		return streaming_bytes;
+	}
+
+	int64_t SoundStreamStats::get_loaded_bytes()
+	{
+		return loaded_bytes;
+	}
+
+	int SoundStreamStats::get_active_streams()
+	{
+		return active_streams;
+	}
+
+	int64_t SoundStreamStats::get_bytes_streamed()
+	{
+		return bytes_streamed;
+	}
+
+	int SoundStreamStats::get_underruns()
+	{
+		return underruns;
+	}
+
+	void SoundStreamStats::reset_counters()
+	{
+		bytes_streamed = 0;
+		underruns = 0;
+	}
+}
@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/IOData/iodevice.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace clan
+{
+	/// \brief Ring buffer streaming a byte range of an IODevice, refilled ahead of the reader by a background I/O thread
+	///
+	/// Only one thread may call read() and seek(). The device is owned by the stream and must not be shared.
+	class SoundStream : public std::enable_shared_from_this<SoundStream>
+	{
+	public:
+		SoundStream(IODevice device, int start_offset, int length, int ring_size = default_ring_size);
+		~SoundStream();
+
+		/// \brief Copies up to size bytes to data without waiting for the device
+		///
+		/// If the ring buffer runs dry the underrun is counted, a refill is scheduled and only the
+		/// whole blocks of block_size bytes available are copied. The caller pads the rest with silence.
+		/** \return Bytes copied. Less than size at the end of the stream or on an underrun, which eof() tells apart.*/
+		int read(void *data, int size, int block_size = 1);
+
+		/// \brief Discards the buffered data and restarts the stream at position (relative to the start offset)
+		void seek(int position);
+
+		/// \brief Returns true when all bytes of the range have been read
+		bool eof() const;
+
+		/// \brief Returns the read position relative to the start offset
+		int get_position() const { return position; }
+
+		/// \brief Schedules a refill on the I/O thread unless one is already pending
+		void request_refill();
+
+		/// \brief Reads from the device until the ring buffer is full. Called by the I/O thread, or when a session starts.
+		void refill();
+
+		/// \brief Adjusts the streaming memory counter, for decoder buffers owned by the sessions
+		static void add_streaming_bytes(int64_t bytes);
+
+		/// \brief Adjusts the loaded memory counter, for providers loaded to memory
+		static void add_loaded_bytes(int64_t bytes);
+
+		static const int default_ring_size = 64 * 1024;
+
+	private:
+		std::mutex device_mutex;
+		IODevice device;
+		int start_offset;
+		int length;
+		int device_position;
+
+		std::vector<unsigned char> ring;
+		uint64_t ring_mask;
+		std::atomic<uint64_t> read_pos;
+		std::atomic<uint64_t> write_pos;
+		std::atomic_bool device_eof;
+		std::atomic_bool refill_pending;
+		int position;
+	};
+}
@@ -93,31 +93,22 @@ namespace clan
 			if (data_requested < 0) return 0;
 		}
 
+		int num_channels = get_num_channels();
 		if (source.impl->bytes_per_sample == 2)
 		{
+			short *src = (short *)source.impl->sound_data + position * num_channels;
 			if (source.impl->stereo)
-			{
-				short *src = (short *)source.impl->sound_data + position * source.impl->bytes_per_sample;
-				SoundSSE::unpack_16bit_stereo(src, data_requested, data_ptr);
-			}
+				SoundSSE::unpack_16bit_stereo(src, data_requested * 2, data_ptr);
 			else
-			{
-				short *src = (short *)source.impl->sound_data + position * source.impl->bytes_per_sample;
 				SoundSSE::unpack_16bit_mono(src, data_requested, data_ptr[0]);
-			}
 		}
 		else if (source.impl->bytes_per_sample == 1)
 		{
+			unsigned char *src = (unsigned char *)source.impl->sound_data + position * num_channels;
 			if (source.impl->stereo)
-			{
-				unsigned char *src = (unsigned char *)source.impl->sound_data + position * source.impl->bytes_per_sample;
-				SoundSSE::unpack_8bit_stereo(src, data_requested, data_ptr);
-			}
+				SoundSSE::unpack_8bit_stereo(src, data_requested * 2, data_ptr);
 			else
-			{
-				unsigned char *src = (unsigned char *)source.impl->sound_data + position * source.impl->bytes_per_sample;
 				SoundSSE::unpack_8bit_mono(src, data_requested, data_ptr[0]);
-			}
 		}
 
 		position += data_requested;
@@ -34,6 +34,8 @@
 #include "API/Core/IOData/path_help.h"
 #include "soundprovider_vorbis_impl.h"
 #include "soundprovider_vorbis_session.h"
+#include "sound_stream.h"
+#include "sound_pcm_cache_impl.h"
 
 namespace clan
 {
@@ -44,7 +46,10 @@ namespace clan
 		: impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 	{
 		IODevice input = fs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		if (stream)
+			impl->load_streamed(input, fs, filename);
+		else
+			impl->load(input);
 	}
 
 	SoundProvider_Vorbis::SoundProvider_Vorbis(
@@ -55,14 +60,20 @@ namespace clan
 		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
 		FileSystem vfs(path);
 		IODevice input = vfs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		if (stream)
+			impl->load_streamed(input, vfs, filename);
+		else
+			impl->load(input);
 	}
 
 	SoundProvider_Vorbis::SoundProvider_Vorbis(
 		IODevice &file, bool stream)
 		: impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 	{
-		impl->load(file);
+		if (stream)
+			impl->load_streamed(file);
+		else
+			impl->load(file);
 	}
 
 	SoundProvider_Vorbis::~SoundProvider_Vorbis()
@@ -79,11 +90,41 @@ namespace clan
 		delete session;
 	}
 
+	SoundProvider_Vorbis_Impl::~SoundProvider_Vorbis_Impl()
+	{
+		SoundStream::add_loaded_bytes(-int64_t(buffer.get_size()));
+		if (cache_key)
+			SoundPCMCache_Impl::instance().remove(cache_key);
+	}
+
 	void SoundProvider_Vorbis_Impl::load(IODevice &input)
 	{
 		int size = input.get_size();
 		buffer = DataBuffer(size);
 		int bytes_read = input.read(buffer.get_data(), buffer.get_size());
 		buffer.set_size(bytes_read);
+		SoundStream::add_loaded_bytes(buffer.get_size());
+
+		// Decode in the background, so sessions can share the samples
+		cache_key = SoundPCMCache_Impl::instance().add(buffer);
+	}
+
+	void SoundProvider_Vorbis_Impl::load_streamed(IODevice &input, const FileSystem &new_fs, const std::string &new_filename)
+	{
+		stream = true;
+		stream_size = input.get_size();
+		if (new_filename.empty())
+			device = input;
+		fs = new_fs;
+		filename = new_filename;
+	}
+
+	IODevice SoundProvider_Vorbis_Impl::open_stream_device()
+	{
+		// Reopening by name gives zip entries a fresh inflate state and archive handle
+		if (!filename.empty())
+			return fs.open_file(filename, File::open_existing, File::access_read, File::share_all);
+		else
+			return device.duplicate();
 	}
 }
@@ -30,6 +30,8 @@
 
 #include "API/Sound/soundformat.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/file_system.h"
 #include <string>
 
 namespace clan
@@ -37,8 +39,27 @@ namespace clan
 	class SoundProvider_Vorbis_Impl
 	{
 	public:
+		~SoundProvider_Vorbis_Impl();
+
+		/// \brief Reads the whole file to memory
 		void load(IODevice &input);
 
+		/// \brief Prepares for streaming from a device of its own for each session
+		void load_streamed(IODevice &input, const FileSystem &fs = FileSystem(), const std::string &filename = std::string());
+
+		/// \brief Opens a new device for a streaming session
+		IODevice open_stream_device();
+
+		bool stream = false;
+		int stream_size = 0;
 		DataBuffer buffer;
+
+		/// \brief Key of the decoded samples in SoundPCMCache_Impl, or 0 if not cached
+		int64_t cache_key = 0;
+
+	private:
+		IODevice device;
+		FileSystem fs;
+		std::string filename;
 	};
 }
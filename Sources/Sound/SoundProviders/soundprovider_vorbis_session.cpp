@@ -29,43 +29,56 @@
 #include "Sound/precomp.h"
 #include "soundprovider_vorbis_session.h"
 #include "soundprovider_vorbis_impl.h"
+#include "sound_stream.h"
+#include "sound_pcm_cache_impl.h"
 #include "API/Sound/soundformat.h"
+#include "API/Sound/sound_sse.h"
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/memory_device.h"
 #include "API/Core/System/exception.h"
+#include <algorithm>
 
 namespace clan
 {
 	SoundProvider_Vorbis_Session::SoundProvider_Vorbis_Session(SoundProvider_Vorbis &source) :
-		source(source), position(0), stream_eof(false), handle(nullptr), stream_byte_offset(0), pcm(nullptr), pcm_position(0), pcm_samples(0)
+		source(source), position(0), stream_eof(false), handle(nullptr), stream_byte_offset(0), window_size(0), pcm(nullptr), pcm_position(0), pcm_samples(0)
 	{
-		int error = 0;
-		handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
-		if (handle == nullptr)
-			throw Exception("Unable to read ogg file");
+		if (source.impl->stream)
+		{
+			stream = std::make_shared<SoundStream>(source.impl->open_stream_device(), 0, source.impl->stream_size);
+			stream->refill();
+		}
+		else if (source.impl->cache_key)
+		{
+			clip = SoundPCMCache_Impl::instance().find(source.impl->cache_key);
+			if (clip)
+				return;
+		}
 
-		stream_info = stb_vorbis_get_info(handle);
+		// Sessions are created by the game thread, which can wait for the headers to arrive
+		while (!open_decoder())
+			stream->refill();
 	}
 
 	SoundProvider_Vorbis_Session::~SoundProvider_Vorbis_Session()
 	{
-		if (handle)
-			stb_vorbis_close(handle);
+		close_decoder();
+		SoundStream::add_streaming_bytes(-int64_t(window.size()));
 	}
 
 	int SoundProvider_Vorbis_Session::get_num_samples() const
 	{
-		return -1;
+		return clip ? clip->num_samples : -1;
 	}
 
 	int SoundProvider_Vorbis_Session::get_frequency() const
 	{
-		return stream_info.sample_rate;
+		return clip ? clip->frequency : stream_info.sample_rate;
 	}
 
 	int SoundProvider_Vorbis_Session::get_num_channels() const
 	{
-		return stream_info.channels;
+		return clip ? int(clip->channels.size()) : stream_info.channels;
 	}
 
 	int SoundProvider_Vorbis_Session::get_position() const
@@ -75,7 +88,11 @@ namespace clan
 
 	bool SoundProvider_Vorbis_Session::eof() const
 	{
-		return stream_eof;
+		if (clip)
+			return position >= clip->num_samples;
+
+		// The last frame may not have been fully returned yet
+		return stream_eof && pcm_position == pcm_samples;
 	}
 
 	void SoundProvider_Vorbis_Session::stop()
@@ -89,37 +106,72 @@ namespace clan
 
 	bool SoundProvider_Vorbis_Session::set_position(int pos)
 	{
+		if (clip)
+		{
+			if (pos < 0 || pos > clip->num_samples)
+				return false;
+			position = pos;
+			return true;
+		}
+
 		// Currently only support seeking to beginning of stream.
 		if (pos != 0) return false;
 
-		if (handle)
-			stb_vorbis_close(handle);
-		handle = nullptr;
+		close_decoder();
 		stream_byte_offset = 0;
+		if (stream)
+		{
+			stream->seek(0);
+			window_size = 0;
+		}
 
-		int error = 0;
-		handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
-		if (handle == nullptr)
-			throw Exception("Unable to read ogg file");
+		// The mixer must not wait for the stream, so the decoder is opened by get_data once the headers are in
 
-		stream_info = stb_vorbis_get_info(handle);
+		pcm = nullptr;
+		pcm_position = 0;
+		pcm_samples = 0;
+		position = 0;
 		stream_eof = false;
 		return true;
 	}
 
 	int SoundProvider_Vorbis_Session::get_data(float **channels, int data_requested)
 	{
+		if (clip)
+		{
+			int samples = std::max(std::min(data_requested, clip->num_samples - position), 0);
+			for (size_t j = 0; j < clip->channels.size(); j++)
+				memcpy(channels[j], clip->channels[j].data() + position, samples * sizeof(float));
+			position += samples;
+			return samples;
+		}
+
 		int data_left = data_requested;
-		while (!eof() && data_left > 0)
+		bool underrun = !handle && !open_decoder();
+		while (!underrun && !eof() && data_left > 0)
 		{
 			while (pcm_position == pcm_samples)
 			{
 				pcm = nullptr;
 				pcm_position = 0;
 				pcm_samples = 0;
-				int bytes_used = stb_vorbis_decode_frame_pushdata(handle, source.impl->buffer.get_data<unsigned char>() + stream_byte_offset, source.impl->buffer.get_size() - stream_byte_offset, nullptr, &pcm, &pcm_samples);
+				int bytes_used = stb_vorbis_decode_frame_pushdata(handle, get_input(), get_input_size(), nullptr, &pcm, &pcm_samples);
 				stream_byte_offset += bytes_used;
-				if (bytes_used == 0 || stream_byte_offset == source.impl->buffer.get_size())
+				if (bytes_used == 0)
+				{
+					// Decoder needs a complete packet
+					if (read_input())
+						continue;
+
+					if (stream && !stream->eof())
+					{
+						underrun = true;
+						break;
+					}
+					stream_eof = true;
+					break;
+				}
+				if (get_input_size() == 0 && (!stream || stream->eof()))
 				{
 					stream_eof = true;
 					break;
@@ -130,7 +182,7 @@ namespace clan
 			if (samples > data_left) samples = data_left;
 
 			int buffer_pos = data_requested - data_left;
-			for (int j = 0; j < stream_info.channels; j++)
+			for (int j = 0; j < stream_info.channels && samples > 0; j++)
 			{
 				memcpy(&channels[j][buffer_pos], &pcm[j][pcm_position], samples*sizeof(float));
 			}
@@ -141,6 +193,93 @@ namespace clan
 			position += samples;
 		}
 
+		if (underrun)
+		{
+			// Play silence until the I/O thread has caught up
+			for (int j = 0; j < stream_info.channels; j++)
+				SoundSSE::set_float(channels[j] + data_requested - data_left, data_left, 0.0f);
+			data_left = 0;
+		}
+
 		return data_requested - data_left;
 	}
+
+	bool SoundProvider_Vorbis_Session::open_decoder()
+	{
+		while (true)
+		{
+			if (get_input_size() > 0)
+			{
+				int bytes_used = 0;
+				int error = 0;
+				handle = stb_vorbis_open_pushdata(get_input(), get_input_size(), &bytes_used, &error, nullptr);
+				if (handle)
+				{
+					stream_byte_offset += bytes_used;
+					stream_info = stb_vorbis_get_info(handle);
+					return true;
+				}
+
+				// The headers must be passed in one block from the start of the file
+				if (error != VORBIS_need_more_data)
+					throw Exception("Unable to read ogg file");
+			}
+
+			if (!read_input())
+			{
+				if (stream && !stream->eof())
+					return false;
+				throw Exception("Unable to read ogg file");
+			}
+		}
+	}
+
+	void SoundProvider_Vorbis_Session::close_decoder()
+	{
+		if (handle)
+			stb_vorbis_close(handle);
+		handle = nullptr;
+	}
+
+	unsigned char *SoundProvider_Vorbis_Session::get_input()
+	{
+		if (stream)
+			return window.data() + stream_byte_offset;
+		else
+			return source.impl->buffer.get_data<unsigned char>() + stream_byte_offset;
+	}
+
+	int SoundProvider_Vorbis_Session::get_input_size() const
+	{
+		if (stream)
+			return window_size - stream_byte_offset;
+		else
+			return source.impl->buffer.get_size() - stream_byte_offset;
+	}
+
+	bool SoundProvider_Vorbis_Session::read_input()
+	{
+		if (!stream)
+			return false;
+
+		const int read_size = 4096;
+
+		if (stream_byte_offset > 0)
+		{
+			memmove(window.data(), window.data() + stream_byte_offset, window_size - stream_byte_offset);
+			window_size -= stream_byte_offset;
+			stream_byte_offset = 0;
+		}
+
+		if (int(window.size()) - window_size < read_size)
+		{
+			int new_size = std::max(int(window.size()) * 2, window_size + read_size);
+			SoundStream::add_streaming_bytes(new_size - int64_t(window.size()));
+			window.resize(new_size);
+		}
+
+		int received = stream->read(window.data() + window_size, read_size);
+		window_size += received;
+		return received > 0;
+	}
 }
@@ -31,10 +31,14 @@
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Sound/SoundProviders/soundprovider_vorbis.h"
 #include "stb_vorbis.h"
+#include <vector>
+#include <memory>
 
 namespace clan
 {
 	class IODevice;
+	class SoundStream;
+	class SoundPCMClip;
 
 	class SoundProvider_Vorbis_Session : public SoundProvider_Session
 	{
@@ -55,6 +59,19 @@ namespace clan
 		int get_data(float **data_ptr, int data_requested) override;
 
 	private:
+		/// \brief Opens the decoder on the headers at the start of the input
+		/** \return false if the stream ran dry before the headers were complete.*/
+		bool open_decoder();
+		void close_decoder();
+
+		/// \brief Returns the undecoded input, the whole file when loaded to memory
+		unsigned char *get_input();
+		int get_input_size() const;
+
+		/// \brief Appends more data from the stream to the input window
+		/** \return false if the stream had no more data, either at its end or on an underrun.*/
+		bool read_input();
+
 		SoundProvider_Vorbis source;
 		int position;
 		bool stream_eof;
@@ -63,8 +80,15 @@ namespace clan
 		stb_vorbis_info stream_info;
 		int stream_byte_offset;
 
+		std::shared_ptr<SoundStream> stream;
+		std::vector<unsigned char> window;
+		int window_size;
+
 		float **pcm;
 		int pcm_position;
 		int pcm_samples;
+
+		/// \brief Decoded samples shared through the PCM cache. No decoder is used when set.
+		std::shared_ptr<const SoundPCMClip> clip;
 	};
 }
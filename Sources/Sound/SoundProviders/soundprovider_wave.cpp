@@ -37,6 +37,7 @@
 #include "API/Core/Text/logger.h"
 #include "soundprovider_wave_impl.h"
 #include "soundprovider_wave_session.h"
+#include "sound_stream.h"
 
 namespace clan
 {
@@ -46,7 +47,7 @@ namespace clan
 		bool stream) : impl(std::make_shared<SoundProvider_Wave_Impl>())
 	{
 		IODevice source = fs.open_file(filename, File::open_existing, File::access_read, File::share_read);
-		impl->load(source);
+		impl->load(source, stream, fs, filename);
 	}
 
 	SoundProvider_Wave::SoundProvider_Wave(
@@ -57,14 +58,14 @@ namespace clan
 		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
 		FileSystem vfs(path);
 		IODevice input = vfs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		impl->load(input, stream, vfs, filename);
 	}
 
 	SoundProvider_Wave::SoundProvider_Wave(
 		IODevice &file, bool stream)
 		: impl(std::make_shared<SoundProvider_Wave_Impl>())
 	{
-		impl->load(file);
+		impl->load(file, stream);
 	}
 
 	SoundProvider_Wave::~SoundProvider_Wave()
@@ -81,7 +82,14 @@ namespace clan
 		delete session;
 	}
 
-	void SoundProvider_Wave_Impl::load(IODevice &source)
+	SoundProvider_Wave_Impl::~SoundProvider_Wave_Impl()
+	{
+		if (data)
+			SoundStream::add_loaded_bytes(-int64_t(data_size));
+		delete[] data;
+	}
+
+	void SoundProvider_Wave_Impl::load(IODevice &source, bool new_stream, const FileSystem &new_fs, const std::string &new_filename)
 	{
 		source.set_little_endian_mode();
 
@@ -103,7 +111,7 @@ namespace clan
 		num_channels = source.read_uint16();
 		frequency = source.read_uint32();
 		uint32_t byte_rate = source.read_uint32();
-		uint16_t block_align = source.read_uint16();
+		block_align = source.read_uint16();
 		uint16_t bits_per_sample = source.read_uint16();
 
 		if (bits_per_sample == 16)
@@ -115,10 +123,33 @@ namespace clan
 
 		uint32_t subchunk2_size = find_subchunk("data", source, subchunk_pos, chunk_size);
 
-		data = new char[subchunk2_size];
-		source.read(data, subchunk2_size);
-
+		data_offset = source.get_position();
+		data_size = subchunk2_size;
 		num_samples = subchunk2_size / block_align;
+
+		if (new_stream)
+		{
+			stream = true;
+			if (new_filename.empty())
+				device = source;
+			fs = new_fs;
+			filename = new_filename;
+		}
+		else
+		{
+			data = new char[subchunk2_size];
+			source.read(data, subchunk2_size);
+			SoundStream::add_loaded_bytes(data_size);
+		}
+	}
+
+	IODevice SoundProvider_Wave_Impl::open_stream_device()
+	{
+		// Reopening by name gives zip entries a fresh inflate state and archive handle
+		if (!filename.empty())
+			return fs.open_file(filename, File::open_existing, File::access_read, File::share_read);
+		else
+			return device.duplicate();
 	}
 
 	unsigned int SoundProvider_Wave_Impl::find_subchunk(const char *chunk, IODevice &source, unsigned int file_offset, unsigned int max_offset)
@@ -29,11 +29,13 @@
 #pragma once
 
 #include "API/Sound/soundformat.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/file_system.h"
+#include <string>
 
 namespace clan
 {
 	class InputSourceProvider;
-	class IODevice;
 
 	class SoundProvider_Wave_Impl
 	{
@@ -43,20 +45,30 @@ namespace clan
 		{
 		}
 
-		~SoundProvider_Wave_Impl()
-		{
-			delete[] data;
-		}
+		~SoundProvider_Wave_Impl();
+
+		/// \brief Parses the header. Reads the samples to memory unless stream is set.
+		void load(IODevice &source, bool stream, const FileSystem &fs = FileSystem(), const std::string &filename = std::string());
 
-		void load(IODevice &source);
+		/// \brief Opens a new device for a streaming session
+		IODevice open_stream_device();
 
 		char *data;
 		SoundFormat format;
 		int num_channels;
 		int num_samples;
 		int frequency;
+		int block_align;
+
+		bool stream = false;
+		int data_offset = 0;
+		int data_size = 0;
 
 	private:
 		uint32_t find_subchunk(const char *chunk, IODevice &source, uint32_t file_offset, uint32_t max_offset);
+
+		IODevice device;
+		FileSystem fs;
+		std::string filename;
 	};
 }
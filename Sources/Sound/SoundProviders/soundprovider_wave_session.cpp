@@ -29,6 +29,7 @@
 #include "Sound/precomp.h"
 #include "soundprovider_wave_session.h"
 #include "soundprovider_wave_impl.h"
+#include "sound_stream.h"
 #include "API/Sound/soundformat.h"
 #include "API/Sound/sound_sse.h"
 
@@ -39,10 +40,17 @@ namespace clan
 	{
 		frequency = source.impl->frequency;
 		end_position = num_samples = source.impl->num_samples;
+
+		if (source.impl->stream)
+		{
+			stream = std::make_shared<SoundStream>(source.impl->open_stream_device(), source.impl->data_offset, source.impl->data_size);
+			stream->refill();
+		}
 	}
 
 	SoundProvider_Wave_Session::~SoundProvider_Wave_Session()
 	{
+		SoundStream::add_streaming_bytes(-int64_t(stream_buffer.size()));
 	}
 
 	int SoundProvider_Wave_Session::get_num_samples() const
@@ -82,6 +90,8 @@ namespace clan
 	bool SoundProvider_Wave_Session::set_position(int pos)
 	{
 		position = pos;
+		if (stream)
+			stream->seek(pos * source.impl->block_align);
 		return true;
 	}
 
@@ -101,17 +111,47 @@ namespace clan
 			block_end = end_position;
 
 		int retrieved = block_end - block_start;
+		if (retrieved <= 0)
+			return 0;
+
+		int silence = 0;
+		char *src_data;
+		if (stream)
+		{
+			int block_align = source.impl->block_align;
+			if (int(stream_buffer.size()) < retrieved * block_align)
+			{
+				SoundStream::add_streaming_bytes(retrieved * block_align - int64_t(stream_buffer.size()));
+				stream_buffer.resize(retrieved * block_align);
+			}
+
+			int requested = retrieved;
+			retrieved = stream->read(stream_buffer.data(), retrieved * block_align, block_align) / block_align;
+			if (retrieved < requested)
+			{
+				// A truncated data chunk ends the session early. An underrun plays silence until the I/O thread catches up.
+				if (stream->eof())
+					end_position = position + retrieved;
+				else
+					silence = requested - retrieved;
+			}
+			src_data = stream_buffer.data();
+		}
+		else
+		{
+			src_data = source.impl->data + position * source.impl->block_align;
+		}
 
 		if (source.impl->format == sf_16bit_signed)
 		{
 			if (source.impl->num_channels == 2)
 			{
-				short *src = ((short *)source.impl->data) + position * 2;
+				short *src = (short *)src_data;
 				SoundSSE::unpack_16bit_stereo(src, retrieved * 2, data_ptr);
 			}
 			else
 			{
-				short *src = ((short *)source.impl->data) + position;
+				short *src = (short *)src_data;
 				SoundSSE::unpack_16bit_mono(src, retrieved, data_ptr[0]);
 			}
 		}
@@ -119,17 +159,20 @@ namespace clan
 		{
 			if (source.impl->num_channels == 2)
 			{
-				unsigned char *src = ((unsigned char *)source.impl->data) + position * 2;
+				unsigned char *src = (unsigned char *)src_data;
 				SoundSSE::unpack_8bit_stereo(src, retrieved * 2, data_ptr);
 			}
 			else
 			{
-				unsigned char *src = ((unsigned char *)source.impl->data) + position;
+				unsigned char *src = (unsigned char *)src_data;
 				SoundSSE::unpack_8bit_mono(src, retrieved, data_ptr[0]);
 			}
 		}
 
+		for (int i = 0; i < source.impl->num_channels; i++)
+			SoundSSE::set_float(data_ptr[i] + retrieved, silence, 0.0f);
+
 		position += retrieved;
-		return retrieved;
+		return retrieved + silence;
 	}
 }
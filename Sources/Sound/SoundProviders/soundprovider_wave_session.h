@@ -30,9 +30,13 @@
 
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Sound/SoundProviders/soundprovider_wave.h"
+#include <vector>
+#include <memory>
 
 namespace clan
 {
+	class SoundStream;
+
 	class SoundProvider_Wave_Session : public SoundProvider_Session
 	{
 	public:
@@ -58,5 +62,8 @@ namespace clan
 		int end_position;
 		int num_samples;
 		int frequency;
+
+		std::shared_ptr<SoundStream> stream;
+		std::vector<char> stream_buffer;
 	};
 }
@@ -0,0 +1,400 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Sound/precomp.h"
+#include "API/Sound/sound_resampler.h"
+#include "API/Core/System/system.h"
+#include "sound_resampler_impl.h"
+#include <cmath>
+#include <algorithm>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+
+#if !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_RESAMPLER_AVX2_AVAILABLE
+#include <immintrin.h>
+
+// Allow the intrinsics in these functions without enabling the instruction set for the whole build
+#if defined(__GNUC__)
+#define CL_RESAMPLER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CL_RESAMPLER_AVX2_TARGET
+#endif
+#endif
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		const int sinc_taps = SoundResampler_Impl::sinc_taps;
+		const int sinc_phases = SoundResampler_Impl::sinc_phases;
+
+		// Scalar kernels, used for the samples left over by the SIMD blocks
+
+		inline float sample_nearest(const float *input, double position)
+		{
+			return input[int(std::floor(position))];
+		}
+
+		inline float sample_linear(const float *input, double position)
+		{
+			int index = int(std::floor(position));
+			float frac = float(position - index);
+			return input[index] + (input[index + 1] - input[index]) * frac;
+		}
+
+		inline float sample_cubic(const float *input, double position)
+		{
+			int index = int(std::floor(position));
+			float frac = float(position - index);
+			const float *x = input + index - 1;
+			float c1 = 0.5f * (x[2] - x[0]);
+			float c2 = x[0] - 2.5f * x[1] + 2.0f * x[2] - 0.5f * x[3];
+			float c3 = 0.5f * (x[3] - x[0]) + 1.5f * (x[1] - x[2]);
+			return ((c3 * frac + c2) * frac + c1) * frac + x[1];
+		}
+
+		inline float sample_sinc(const float *input, double position, const float *coefficients, const float *deltas)
+		{
+			int index = int(std::floor(position));
+			float phase = float(position - index) * sinc_phases;
+			int phase_index = std::min(int(phase), sinc_phases - 1);
+			float phase_frac = phase - phase_index;
+
+			const float *x = input + index - (sinc_taps / 2 - 1);
+			const float *c = coefficients + phase_index * sinc_taps;
+			const float *d = deltas + phase_index * sinc_taps;
+			float sum = 0.0f;
+			for (int tap = 0; tap < sinc_taps; tap++)
+				sum += (c[tap] + d[tap] * phase_frac) * x[tap];
+			return sum;
+		}
+
+		void resample_scalar(ResamplerQuality quality, const float *input, double position, double step, float *output, int num_samples, const float *coefficients, const float *deltas)
+		{
+			switch (quality)
+			{
+			case resampler_nearest:
+				for (int i = 0; i < num_samples; i++)
+					output[i] = sample_nearest(input, position + i * step);
+				break;
+			case resampler_linear:
+				for (int i = 0; i < num_samples; i++)
+					output[i] = sample_linear(input, position + i * step);
+				break;
+			case resampler_cubic:
+				for (int i = 0; i < num_samples; i++)
+					output[i] = sample_cubic(input, position + i * step);
+				break;
+			case resampler_sinc:
+				for (int i = 0; i < num_samples; i++)
+					output[i] = sample_sinc(input, position + i * step, coefficients, deltas);
+				break;
+			}
+		}
+
+#ifndef CL_DISABLE_SSE2
+
+		// The SIMD kernels split each block position into an integer base and small float offsets per lane.
+		// Float rounding can move a lane index one sample, covered by the extra history and lookahead sample.
+
+		inline __m128 sse_offsets(double position, double step, int &base)
+		{
+			base = int(std::floor(position));
+			float offset = float(position - base);
+			float fstep = float(step);
+			return _mm_add_ps(_mm_set1_ps(offset), _mm_set_ps(3.0f * fstep, 2.0f * fstep, fstep, 0.0f));
+		}
+
+		int resample_sse2(ResamplerQuality quality, const float *input, double position, double step, float *output, int num_samples, const float *coefficients, const float *deltas)
+		{
+			int sse_size = (num_samples / 4) * 4;
+			alignas(16) int index[4];
+
+			for (int i = 0; i < sse_size; i += 4)
+			{
+				int base;
+				__m128 offsets = sse_offsets(position + i * step, step, base);
+				__m128i ioffsets = _mm_cvttps_epi32(offsets);
+				__m128 frac = _mm_sub_ps(offsets, _mm_cvtepi32_ps(ioffsets));
+				_mm_store_si128((__m128i*)index, ioffsets);
+				const float *src = input + base;
+
+				__m128 result;
+				if (quality == resampler_nearest)
+				{
+					result = _mm_set_ps(src[index[3]], src[index[2]], src[index[1]], src[index[0]]);
+				}
+				else if (quality == resampler_linear)
+				{
+					__m128 x0 = _mm_loadu_ps(src + index[0]);
+					__m128 x1 = _mm_loadu_ps(src + index[1]);
+					__m128 x2 = _mm_loadu_ps(src + index[2]);
+					__m128 x3 = _mm_loadu_ps(src + index[3]);
+					_MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+					result = _mm_add_ps(x0, _mm_mul_ps(_mm_sub_ps(x1, x0), frac));
+				}
+				else if (quality == resampler_cubic)
+				{
+					__m128 xm1 = _mm_loadu_ps(src + index[0] - 1);
+					__m128 x0 = _mm_loadu_ps(src + index[1] - 1);
+					__m128 x1 = _mm_loadu_ps(src + index[2] - 1);
+					__m128 x2 = _mm_loadu_ps(src + index[3] - 1);
+					_MM_TRANSPOSE4_PS(xm1, x0, x1, x2);
+
+					__m128 half = _mm_set1_ps(0.5f);
+					__m128 c1 = _mm_mul_ps(half, _mm_sub_ps(x1, xm1));
+					__m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(xm1, _mm_mul_ps(_mm_set1_ps(2.5f), x0)), _mm_add_ps(x1, x1)), _mm_mul_ps(half, x2));
+					__m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(x2, xm1)), _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(x0, x1)));
+					result = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, frac), c2), frac), c1), frac), x0);
+				}
+				else
+				{
+					__m128 phase = _mm_mul_ps(frac, _mm_set1_ps(float(sinc_phases)));
+					__m128i iphase = _mm_cvttps_epi32(phase);
+					__m128 phase_frac = _mm_sub_ps(phase, _mm_cvtepi32_ps(iphase));
+					alignas(16) int phase_index[4];
+					alignas(16) float phase_fracs[4];
+					_mm_store_si128((__m128i*)phase_index, iphase);
+					_mm_store_ps(phase_fracs, phase_frac);
+
+					__m128 sums[4];
+					for (int lane = 0; lane < 4; lane++)
+					{
+						const float *x = src + index[lane] - (sinc_taps / 2 - 1);
+						const float *c = coefficients + phase_index[lane] * sinc_taps;
+						const float *d = deltas + phase_index[lane] * sinc_taps;
+						__m128 pf = _mm_set1_ps(phase_fracs[lane]);
+
+						__m128 sum = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(c), _mm_mul_ps(_mm_loadu_ps(d), pf)), _mm_loadu_ps(x));
+						for (int tap = 4; tap < sinc_taps; tap += 4)
+							sum = _mm_add_ps(sum, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(c + tap), _mm_mul_ps(_mm_loadu_ps(d + tap), pf)), _mm_loadu_ps(x + tap)));
+						sums[lane] = sum;
+					}
+
+					// Horizontal sums of the four lanes at once
+					_MM_TRANSPOSE4_PS(sums[0], sums[1], sums[2], sums[3]);
+					result = _mm_add_ps(_mm_add_ps(sums[0], sums[1]), _mm_add_ps(sums[2], sums[3]));
+				}
+
+				_mm_storeu_ps(output + i, result);
+			}
+
+			return sse_size;
+		}
+#endif
+
+#ifdef CL_RESAMPLER_AVX2_AVAILABLE
+		CL_RESAMPLER_AVX2_TARGET int resample_avx2(ResamplerQuality quality, const float *input, double position, double step, float *output, int num_samples, const float *coefficients, const float *deltas)
+		{
+			int avx_size = (num_samples / 8) * 8;
+			float fstep = float(step);
+			__m256 lane_steps = _mm256_set_ps(7.0f * fstep, 6.0f * fstep, 5.0f * fstep, 4.0f * fstep, 3.0f * fstep, 2.0f * fstep, fstep, 0.0f);
+
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				double block_position = position + i * step;
+				int base = int(std::floor(block_position));
+				__m256 offsets = _mm256_add_ps(_mm256_set1_ps(float(block_position - base)), lane_steps);
+				__m256i index = _mm256_cvttps_epi32(offsets);
+				__m256 frac = _mm256_sub_ps(offsets, _mm256_cvtepi32_ps(index));
+				const float *src = input + base;
+
+				__m256 result;
+				if (quality == resampler_nearest)
+				{
+					result = _mm256_i32gather_ps(src, index, 4);
+				}
+				else if (quality == resampler_linear)
+				{
+					__m256 x0 = _mm256_i32gather_ps(src, index, 4);
+					__m256 x1 = _mm256_i32gather_ps(src + 1, index, 4);
+					result = _mm256_add_ps(x0, _mm256_mul_ps(_mm256_sub_ps(x1, x0), frac));
+				}
+				else if (quality == resampler_cubic)
+				{
+					__m256 xm1 = _mm256_i32gather_ps(src - 1, index, 4);
+					__m256 x0 = _mm256_i32gather_ps(src, index, 4);
+					__m256 x1 = _mm256_i32gather_ps(src + 1, index, 4);
+					__m256 x2 = _mm256_i32gather_ps(src + 2, index, 4);
+
+					__m256 half = _mm256_set1_ps(0.5f);
+					__m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(x1, xm1));
+					__m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(xm1, _mm256_mul_ps(_mm256_set1_ps(2.5f), x0)), _mm256_add_ps(x1, x1)), _mm256_mul_ps(half, x2));
+					__m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(x2, xm1)), _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(x0, x1)));
+					result = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(c3, frac), c2), frac), c1), frac), x0);
+				}
+				else
+				{
+					__m256 phase = _mm256_mul_ps(frac, _mm256_set1_ps(float(sinc_phases)));
+					__m256i iphase = _mm256_cvttps_epi32(phase);
+					__m256 phase_frac = _mm256_sub_ps(phase, _mm256_cvtepi32_ps(iphase));
+					alignas(32) int indexes[8];
+					alignas(32) int phase_index[8];
+					alignas(32) float phase_fracs[8];
+					_mm256_store_si256((__m256i*)indexes, index);
+					_mm256_store_si256((__m256i*)phase_index, iphase);
+					_mm256_store_ps(phase_fracs, phase_frac);
+
+					__m128 sums[8];
+					for (int lane = 0; lane < 8; lane++)
+					{
+						const float *x = src + indexes[lane] - (sinc_taps / 2 - 1);
+						const float *c = coefficients + phase_index[lane] * sinc_taps;
+						const float *d = deltas + phase_index[lane] * sinc_taps;
+						__m256 pf = _mm256_set1_ps(phase_fracs[lane]);
+
+						__m256 sum0 = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(c), _mm256_mul_ps(_mm256_loadu_ps(d), pf)), _mm256_loadu_ps(x));
+						__m256 sum1 = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(c + 8), _mm256_mul_ps(_mm256_loadu_ps(d + 8), pf)), _mm256_loadu_ps(x + 8));
+						__m256 sum = _mm256_add_ps(sum0, sum1);
+						sums[lane] = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+					}
+
+					// Horizontal sums of four lanes at once
+					_MM_TRANSPOSE4_PS(sums[0], sums[1], sums[2], sums[3]);
+					_MM_TRANSPOSE4_PS(sums[4], sums[5], sums[6], sums[7]);
+					__m128 low = _mm_add_ps(_mm_add_ps(sums[0], sums[1]), _mm_add_ps(sums[2], sums[3]));
+					__m128 high = _mm_add_ps(_mm_add_ps(sums[4], sums[5]), _mm_add_ps(sums[6], sums[7]));
+					result = _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+				}
+
+				_mm256_storeu_ps(output + i, result);
+			}
+
+			return avx_size;
+		}
+#endif
+
+		double bessel_i0(double x)
+		{
+			double sum = 1.0;
+			double term = 1.0;
+			for (int k = 1; k < 32; k++)
+			{
+				term *= (x / (2.0 * k)) * (x / (2.0 * k));
+				sum += term;
+				if (term < sum * 1e-12)
+					break;
+			}
+			return sum;
+		}
+	}
+
+	const int SoundResampler::history;
+	const int SoundResampler::lookahead;
+
+	SoundResampler::SoundResampler(ResamplerQuality quality) : impl(std::make_shared<SoundResampler_Impl>(quality))
+	{
+	}
+
+	ResamplerQuality SoundResampler::get_quality() const
+	{
+		return impl->quality;
+	}
+
+	void SoundResampler::set_quality(ResamplerQuality quality)
+	{
+		impl->quality = quality;
+	}
+
+	void SoundResampler::resample(const float *input, double position, double step, float *output, int num_samples)
+	{
+		if (num_samples <= 0)
+			return;
+
+		// All kernels reproduce the input when the positions fall exactly on samples
+		if (step == 1.0 && position == std::floor(position))
+		{
+			memcpy(output, input + int(position), num_samples * sizeof(float));
+			return;
+		}
+
+		ResamplerQuality quality = impl->quality;
+		if (quality == resampler_sinc)
+			impl->update_sinc_table(step);
+		const float *coefficients = impl->sinc_coefficients.data();
+		const float *deltas = impl->sinc_deltas.data();
+
+		int done = 0;
+#ifdef CL_RESAMPLER_AVX2_AVAILABLE
+		static bool avx2 = System::detect_cpu_extension(System::avx2);
+		if (avx2)
+			done = resample_avx2(quality, input, position, step, output, num_samples, coefficients, deltas);
+#endif
+#ifndef CL_DISABLE_SSE2
+		done += resample_sse2(quality, input, position + done * step, step, output + done, num_samples - done, coefficients, deltas);
+#endif
+		resample_scalar(quality, input, position + done * step, step, output + done, num_samples - done, coefficients, deltas);
+	}
+
+	void SoundResampler_Impl::update_sinc_table(double step)
+	{
+		// Band-limit to the lower of the input and output frequencies, leaving room for the transition band
+		float cutoff = float(0.9 / std::max(step, 1.0));
+		cutoff = std::max(std::floor(cutoff * 128.0f + 0.5f), 1.0f) / 128.0f;
+		if (cutoff == sinc_cutoff)
+			return;
+		sinc_cutoff = cutoff;
+
+		const double pi = 3.14159265358979323846;
+		const double beta = 7.0;
+		const double half_width = sinc_taps / 2;
+		double i0_beta = bessel_i0(beta);
+
+		std::vector<double> table((sinc_phases + 1) * sinc_taps);
+		for (int phase = 0; phase <= sinc_phases; phase++)
+		{
+			double frac = phase / double(sinc_phases);
+			double sum = 0.0;
+			for (int tap = 0; tap < sinc_taps; tap++)
+			{
+				double distance = tap - (sinc_taps / 2 - 1) - frac;
+				double x = cutoff * distance;
+				double sinc = (std::abs(x) < 1e-9) ? 1.0 : std::sin(pi * x) / (pi * x);
+				double w = distance / half_width;
+				double window = (std::abs(w) < 1.0) ? bessel_i0(beta * std::sqrt(1.0 - w * w)) / i0_beta : 0.0;
+				table[phase * sinc_taps + tap] = sinc * window;
+				sum += sinc * window;
+			}
+
+			// Unity gain for a constant signal at every phase
+			for (int tap = 0; tap < sinc_taps; tap++)
+				table[phase * sinc_taps + tap] /= sum;
+		}
+
+		sinc_coefficients.resize(sinc_phases * sinc_taps);
+		sinc_deltas.resize(sinc_phases * sinc_taps);
+		for (int i = 0; i < sinc_phases * sinc_taps; i++)
+		{
+			sinc_coefficients[i] = float(table[i]);
+			sinc_deltas[i] = float(table[i + sinc_taps] - table[i]);
+		}
+	}
+}
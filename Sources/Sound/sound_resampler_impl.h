@@ -0,0 +1,59 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Sound/sound_resampler.h"
+#include <vector>
+
+namespace clan
+{
+	class SoundResampler_Impl
+	{
+	public:
+		SoundResampler_Impl(ResamplerQuality quality) : quality(quality)
+		{
+		}
+
+		/// \brief Builds the polyphase table for the cutoff frequency suited to step, unless already built
+		void update_sinc_table(double step);
+
+		ResamplerQuality quality;
+
+		/// \brief Sinc coefficients for sinc_phases fractional positions, sinc_taps per phase
+		std::vector<float> sinc_coefficients;
+
+		/// \brief Difference to the coefficients of the next phase, for interpolating between phases
+		std::vector<float> sinc_deltas;
+
+		float sinc_cutoff = 0.0f;
+
+		static const int sinc_taps = 16;
+		static const int sinc_phases = 64;
+	};
+}
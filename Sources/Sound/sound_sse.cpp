@@ -32,8 +32,22 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+
 #ifndef CL_DISABLE_SSE2
 #include <emmintrin.h>
+
+#if !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_SOUND_AVX2_AVAILABLE
+#include <immintrin.h>
+
+// Allow the intrinsics in these functions without enabling the instruction set for the whole build
+#if defined(__GNUC__)
+#define CL_SOUND_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CL_SOUND_AVX2_TARGET
+#endif
+#endif
 #endif
 
 #ifdef __MINGW32__
@@ -42,6 +56,142 @@
 
 namespace clan
 {
+#ifdef CL_SOUND_AVX2_AVAILABLE
+	namespace
+	{
+		bool use_avx2()
+		{
+			static bool avx2 = System::detect_cpu_extension(System::avx2);
+			return avx2;
+		}
+
+		// AVX2 kernels. Each returns the number of samples processed, leaving the rest to the SSE2 and scalar code.
+		// Multiplies and adds are kept separate (no FMA) so all paths round the same way.
+
+		CL_SOUND_AVX2_TARGET int multiply_float_avx2(float *channel, int size, float volume)
+		{
+			int avx_size = (size / 8) * 8;
+			__m256 volume0 = _mm256_set1_ps(volume);
+			for (int i = 0; i < avx_size; i += 8)
+				_mm256_storeu_ps(channel + i, _mm256_mul_ps(_mm256_loadu_ps(channel + i), volume0));
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int clamp_float_avx2(float *channel, int size, float min_value, float max_value)
+		{
+			int avx_size = (size / 8) * 8;
+			__m256 min0 = _mm256_set1_ps(min_value);
+			__m256 max0 = _mm256_set1_ps(max_value);
+			for (int i = 0; i < avx_size; i += 8)
+				_mm256_storeu_ps(channel + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(channel + i), min0), max0));
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int mix_one_to_one_avx2(float *input, int size, float *output, float volume)
+		{
+			int avx_size = (size / 8) * 8;
+			__m256 volume0 = _mm256_set1_ps(volume);
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				__m256 sample0 = _mm256_loadu_ps(input + i);
+				__m256 sample1 = _mm256_loadu_ps(output + i);
+				_mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_mul_ps(sample0, volume0), sample1));
+			}
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int mix_one_to_many_avx2(float *input, int size, float **output, float *volume, int channels)
+		{
+			int avx_size = (size / 8) * 8;
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				__m256 sample0 = _mm256_loadu_ps(input + i);
+				for (int j = 0; j < channels; j++)
+				{
+					__m256 sample1 = _mm256_loadu_ps(output[j] + i);
+					_mm256_storeu_ps(output[j] + i, _mm256_add_ps(_mm256_mul_ps(sample0, _mm256_set1_ps(volume[j])), sample1));
+				}
+			}
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int mix_many_to_one_avx2(float **input, float *volume, int channels, int size, float *output)
+		{
+			int avx_size = (size / 8) * 8;
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				__m256 sample0 = _mm256_loadu_ps(output + i);
+				for (int j = 0; j < channels; j++)
+					sample0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(input[j] + i), _mm256_set1_ps(volume[j])), sample0);
+				_mm256_storeu_ps(output + i, sample0);
+			}
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int mix_many_to_many_avx2(float **input, int size, float **output, float *volume, int channels)
+		{
+			int avx_size = (size / 8) * 8;
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				for (int j = 0; j < channels; j++)
+				{
+					__m256 sample0 = _mm256_loadu_ps(input[j] + i);
+					__m256 sample1 = _mm256_loadu_ps(output[j] + i);
+					_mm256_storeu_ps(output[j] + i, _mm256_add_ps(_mm256_mul_ps(sample0, _mm256_set1_ps(volume[j])), sample1));
+				}
+			}
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int feedback_delay_avx2(float *channel, float *delay_line, int size, float feedback)
+		{
+			int avx_size = (size / 8) * 8;
+			__m256 feedback0 = _mm256_set1_ps(feedback);
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				__m256 delayed = _mm256_loadu_ps(delay_line + i);
+				__m256 sample = _mm256_add_ps(_mm256_mul_ps(delayed, feedback0), _mm256_loadu_ps(channel + i));
+				_mm256_storeu_ps(delay_line + i, sample);
+				_mm256_storeu_ps(channel + i, sample);
+			}
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int pack_float_stereo_avx2(float *input[2], int size, float *output)
+		{
+			int avx_size = (size / 8) * 8;
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				__m256 samples0 = _mm256_loadu_ps(input[0] + i);
+				__m256 samples1 = _mm256_loadu_ps(input[1] + i);
+				// Interleaves within each 128 bit lane, then puts the lanes in order
+				__m256 tmp0 = _mm256_unpacklo_ps(samples0, samples1);
+				__m256 tmp1 = _mm256_unpackhi_ps(samples0, samples1);
+				_mm256_storeu_ps(output + i * 2, _mm256_permute2f128_ps(tmp0, tmp1, 0x20));
+				_mm256_storeu_ps(output + i * 2 + 8, _mm256_permute2f128_ps(tmp0, tmp1, 0x31));
+			}
+			return avx_size;
+		}
+
+		CL_SOUND_AVX2_TARGET int pack_16bit_stereo_avx2(float *input[2], int size, short *output)
+		{
+			int avx_size = (size / 8) * 8;
+			__m256 constant1 = _mm256_set1_ps(32767);
+			for (int i = 0; i < avx_size; i += 8)
+			{
+				__m256 samples0 = _mm256_mul_ps(_mm256_loadu_ps(input[0] + i), constant1);
+				__m256 samples1 = _mm256_mul_ps(_mm256_loadu_ps(input[1] + i), constant1);
+				__m256 tmp0 = _mm256_unpacklo_ps(samples0, samples1);
+				__m256 tmp1 = _mm256_unpackhi_ps(samples0, samples1);
+				// Saturating pack works per lane, which keeps the samples of each lane in order
+				__m256i isamples = _mm256_packs_epi32(_mm256_cvtps_epi32(tmp0), _mm256_cvtps_epi32(tmp1));
+				_mm256_storeu_si256((__m256i*)(output + i * 2), isamples);
+			}
+			return avx_size;
+		}
+	}
+#endif
+
 	void *SoundSSE::aligned_alloc(int size)
 	{
 		return System::aligned_alloc(size, 16);
@@ -199,11 +349,16 @@ namespace clan
 
 	void SoundSSE::pack_16bit_stereo(float *input[2], int size, short *output)
 	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = pack_16bit_stereo_avx2(input, size, output);
+#endif
 #ifndef CL_DISABLE_SSE2
 		int sse_size = (size / 4) * 4;
 
 		__m128 constant1 = _mm_set1_ps(32767);
-		for (int i = 0; i < sse_size; i += 4)
+		for (int i = done; i < sse_size; i += 4)
 		{
 			__m128 samples0 = _mm_loadu_ps(input[0] + i);
 			__m128 samples1 = _mm_loadu_ps(input[1] + i);
@@ -219,23 +374,28 @@ namespace clan
 		}
 
 #else
-		const int sse_size = 0;
+		const int sse_size = done;
 #endif
 
-		// Pack remaining
+		// Pack remaining, saturating like the SIMD paths
 		for (int i = sse_size; i < size; i++)
 		{
-			output[i * 2] = input[0][i] * 32767;
-			output[i * 2 + 1] = input[1][i] * 32767;
+			output[i * 2] = (short)std::max(std::min(input[0][i] * 32767.0f, 32767.0f), -32768.0f);
+			output[i * 2 + 1] = (short)std::max(std::min(input[1][i] * 32767.0f, 32767.0f), -32768.0f);
 		}
 	}
 
 	void SoundSSE::pack_float_stereo(float *input[2], int size, float *output)
 	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = pack_float_stereo_avx2(input, size, output);
+#endif
 #ifndef CL_DISABLE_SSE2
 		int sse_size = (size / 4) * 4;
 
-		for (int i = 0; i < sse_size; i += 4)
+		for (int i = done; i < sse_size; i += 4)
 		{
 			__m128 samples0 = _mm_loadu_ps(input[0] + i);
 			__m128 samples1 = _mm_loadu_ps(input[1] + i);
@@ -247,7 +407,7 @@ namespace clan
 		}
 
 #else
-		const int sse_size = 0;
+		const int sse_size = done;
 #endif
 
 		// Pack remaining
@@ -280,24 +440,54 @@ namespace clan
 
 	void SoundSSE::multiply_float(float *channel, int size, float volume)
 	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = multiply_float_avx2(channel, size, volume);
+#endif
 #ifndef CL_DISABLE_SSE2
 		int sse_size = (size / 4) * 4;
 
 		__m128 volume0 = _mm_set1_ps(volume);
-		for (int i = 0; i < sse_size; i += 4)
+		for (int i = done; i < sse_size; i += 4)
 		{
 			__m128 s = _mm_loadu_ps(channel + i);
 			s = _mm_mul_ps(s, volume0);
 			_mm_storeu_ps(channel + i, s);
 		}
 #else
-		const int sse_size = 0;
+		const int sse_size = done;
 #endif
 
 		for (int i = sse_size; i < size; i++)
 			channel[i] *= volume;
 	}
 
+	void SoundSSE::clamp_float(float *channel, int size, float min_value, float max_value)
+	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = clamp_float_avx2(channel, size, min_value, max_value);
+#endif
+#ifndef CL_DISABLE_SSE2
+		int sse_size = (size / 4) * 4;
+
+		__m128 min0 = _mm_set1_ps(min_value);
+		__m128 max0 = _mm_set1_ps(max_value);
+		for (int i = done; i < sse_size; i += 4)
+		{
+			__m128 s = _mm_loadu_ps(channel + i);
+			_mm_storeu_ps(channel + i, _mm_min_ps(_mm_max_ps(s, min0), max0));
+		}
+#else
+		const int sse_size = done;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+			channel[i] = std::min(std::max(channel[i], min_value), max_value);
+	}
+
 	void SoundSSE::set_float(float *channel, int size, float value)
 	{
 #ifndef CL_DISABLE_SSE2
@@ -318,10 +508,15 @@ namespace clan
 
 	void SoundSSE::mix_one_to_one(float *input, int size, float *output, float volume)
 	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = mix_one_to_one_avx2(input, size, output, volume);
+#endif
 #ifndef CL_DISABLE_SSE2
 		int sse_size = (size / 4) * 4;
 		__m128 volume0 = _mm_set1_ps(volume);
-		for (int i = 0; i < sse_size; i += 4)
+		for (int i = done; i < sse_size; i += 4)
 		{
 			__m128 sample0 = _mm_loadu_ps(input + i);
 			__m128 sample1 = _mm_loadu_ps(output + i);
@@ -329,7 +524,7 @@ namespace clan
 		}
 
 #else
-		const int sse_size = 0;
+		const int sse_size = done;
 #endif
 
 		for (int i = sse_size; i < size; i++)
@@ -340,9 +535,14 @@ namespace clan
 
 	void SoundSSE::mix_one_to_many(float *input, int size, float **output, float *volume, int channels)
 	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = mix_one_to_many_avx2(input, size, output, volume, channels);
+#endif
 #ifndef CL_DISABLE_SSE2
 		int sse_size = (size / 4) * 4;
-		for (int i = 0; i < sse_size; i += 4)
+		for (int i = done; i < sse_size; i += 4)
 		{
 			__m128 sample0 = _mm_loadu_ps(input + i);
 			for (int j = 0; j < channels; j++)
@@ -354,7 +554,7 @@ namespace clan
 		}
 
 #else
-		const int sse_size = 0;
+		const int sse_size = done;
 #endif
 
 		for (int i = sse_size; i < size; i++)
@@ -369,9 +569,14 @@ namespace clan
 
 	void SoundSSE::mix_many_to_one(float **input, float *volume, int channels, int size, float *output)
 	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = mix_many_to_one_avx2(input, volume, channels, size, output);
+#endif
 #ifndef CL_DISABLE_SSE2
 		int sse_size = (size / 4) * 4;
-		for (int i = 0; i < sse_size; i += 4)
+		for (int i = done; i < sse_size; i += 4)
 		{
 			__m128 sample0 = _mm_loadu_ps(output + i);
 			for (int j = 0; j < channels; j++)
@@ -384,7 +589,7 @@ namespace clan
 		}
 
 #else
-		const int sse_size = 0;
+		const int sse_size = done;
 #endif
 
 		for (int i = sse_size; i < size; i++)
@@ -398,6 +603,69 @@ namespace clan
 		}
 	}
 
+	void SoundSSE::mix_many_to_many(float **input, int size, float **output, float *volume, int channels)
+	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = mix_many_to_many_avx2(input, size, output, volume, channels);
+#endif
+#ifndef CL_DISABLE_SSE2
+		int sse_size = (size / 4) * 4;
+		for (int i = done; i < sse_size; i += 4)
+		{
+			for (int j = 0; j < channels; j++)
+			{
+				__m128 sample0 = _mm_loadu_ps(input[j] + i);
+				__m128 sample1 = _mm_loadu_ps(output[j] + i);
+				__m128 volume0 = _mm_set1_ps(volume[j]);
+				_mm_storeu_ps(output[j] + i, _mm_add_ps(_mm_mul_ps(sample0, volume0), sample1));
+			}
+		}
+
+#else
+		const int sse_size = done;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+		{
+			for (int j = 0; j < channels; j++)
+			{
+				output[j][i] += input[j][i] * volume[j];
+			}
+		}
+	}
+
+	void SoundSSE::feedback_delay(float *channel, float *delay_line, int size, float feedback)
+	{
+		int done = 0;
+#ifdef CL_SOUND_AVX2_AVAILABLE
+		if (use_avx2())
+			done = feedback_delay_avx2(channel, delay_line, size, feedback);
+#endif
+#ifndef CL_DISABLE_SSE2
+		int sse_size = (size / 4) * 4;
+		__m128 feedback0 = _mm_set1_ps(feedback);
+		for (int i = done; i < sse_size; i += 4)
+		{
+			__m128 delayed = _mm_loadu_ps(delay_line + i);
+			__m128 sample = _mm_add_ps(_mm_mul_ps(delayed, feedback0), _mm_loadu_ps(channel + i));
+			_mm_storeu_ps(delay_line + i, sample);
+			_mm_storeu_ps(channel + i, sample);
+		}
+
+#else
+		const int sse_size = done;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+		{
+			float sample = delay_line[i] * feedback + channel[i];
+			delay_line[i] = sample;
+			channel[i] = sample;
+		}
+	}
+
 	void SoundSSE::unpack_float_stereo(float *input, int size, float *output[2])
 	{
 #ifndef CL_DISABLE_SSE2
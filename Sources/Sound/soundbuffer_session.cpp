@@ -58,8 +58,7 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			return impl->provider_session->get_position();
+			return impl->position;
 		}
 		else
 		{
@@ -71,9 +70,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			int position = impl->provider_session->get_position();
-			int length = impl->provider_session->get_num_samples();
+			int position = impl->position;
+			int length = impl->length;
 			if (length == 0) return 1.0f;
 			return position / (float)length;
 		}
@@ -87,8 +85,7 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			return impl->provider_session->get_num_samples();
+			return impl->length;
 		}
 		else
 		{
@@ -112,7 +109,6 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			return impl->volume;
 		}
 		else
@@ -125,7 +121,6 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			return impl->pan;
 		}
 		else
@@ -150,7 +145,6 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			return impl->playing;
 		}
 		else
@@ -159,17 +153,28 @@ namespace clan
 		}
 	}
 
+	ResamplerQuality SoundBuffer_Session::get_resampler_quality() const
+	{
+		if (impl)
+		{
+			return (ResamplerQuality)impl->resampler_quality.load();
+		}
+		else
+		{
+			return resampler_linear;
+		}
+	}
+
 	bool SoundBuffer_Session::set_position(int new_pos)
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			if (impl->provider_session->set_position(new_pos))
-			{
-				// instantly update position here?
-				return true;
-			}
-			return false;
+			int length = impl->length;
+			if (new_pos < 0 || (length >= 0 && new_pos > length))
+				return false;
+			impl->position = new_pos;
+			impl->output.impl->queue_command(SoundMixerCommandQueue::command_set_position, impl, new_pos);
+			return true;
 		}
 		else
 		{
@@ -181,13 +186,11 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			if (impl->provider_session->set_end_position(new_pos))
-			{
-				// instantly update end position here?
-				return true;
-			}
-			return false;
+			int length = impl->length;
+			if (new_pos < 0 || (length >= 0 && new_pos > length))
+				return false;
+			impl->output.impl->queue_command(SoundMixerCommandQueue::command_set_end_position, impl, new_pos);
+			return true;
 		}
 		else
 		{
@@ -208,6 +211,15 @@ namespace clan
 		}
 	}
 
+	void SoundBuffer_Session::set_resampler_quality(ResamplerQuality quality)
+	{
+		if (impl)
+		{
+			impl->resampler_quality = quality;
+			impl->output.impl->queue_command(SoundMixerCommandQueue::command_set_resampler_quality, impl, quality);
+		}
+	}
+
 	void SoundBuffer_Session::set_volume(float new_volume)
 	{
 		if (impl)
@@ -230,14 +242,9 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			if (impl->playing) return;
-			if (impl->provider_session->play())
-			{
-				impl->playing = true;
-				mutex_lock.unlock();
-				impl->output.impl->play_session(*this);
-			}
+			bool playing = false;
+			if (impl->playing.compare_exchange_strong(playing, true))
+				impl->output.impl->queue_command(SoundMixerCommandQueue::command_play, impl);
 		}
 	}
 
@@ -245,13 +252,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			if (!impl->playing) return;
-			mutex_lock.unlock();
-			impl->output.impl->stop_session(*this);
-			mutex_lock.lock();
-			impl->playing = false;
-			impl->provider_session->stop();
+			if (impl->playing.exchange(false))
+				impl->output.impl->queue_command(SoundMixerCommandQueue::command_stop, impl);
 		}
 	}
 
@@ -259,9 +261,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			impl->looping = loop;
-			impl->provider_session->set_looping(loop);
+			impl->output.impl->queue_command(SoundMixerCommandQueue::command_set_looping, impl, loop ? 1 : 0);
 		}
 	}
 
@@ -269,8 +270,7 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			impl->filters.push_back(filter);
+			impl->output.impl->queue_command(SoundMixerCommandQueue::command_add_filter, impl, 0, filter);
 		}
 	}
 
@@ -278,14 +278,7 @@ namespace clan
 	{
 		if (impl)
 		{
-			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-			for (std::vector<SoundFilter>::size_type i = 0; i < impl->filters.size(); i++)
-			{
-				if (impl->filters[i] == filter)
-				{
-					impl->filters.erase(impl->filters.begin() + i);
-				}
-			}
+			impl->output.impl->queue_command(SoundMixerCommandQueue::command_remove_filter, impl, 0, filter);
 		}
 	}
 }
@@ -35,26 +35,35 @@
 #include "API/Sound/SoundProviders/soundprovider.h"
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Core/Text/logger.h"
+#include <algorithm>
 
 namespace clan
 {
 	SoundBuffer_Session_Impl::SoundBuffer_Session_Impl(SoundBuffer &soundbuffer, bool looping, SoundOutput &output)
-		: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), looping(looping), playing(false)
+		: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), looping(looping), playing(false), position(0), length(0), mixer_index(-1)
 	{
 		volume = soundbuffer.get_volume();
 		pan = soundbuffer.get_pan();
 		provider_session = soundbuffer.get_provider()->begin_session();
 		provider_session->set_looping(looping);
 		frequency = provider_session->get_frequency();
+		position = provider_session->get_position();
+		length = provider_session->get_num_samples();
+		resampler_quality = resampler.get_quality();
 
 		num_buffer_samples = 16 * 1024;
 		num_buffer_channels = provider_session->get_num_channels();
-		buffer_position = 0.0;
-		buffer_samples_written = 0;
+		end_of_data = false;
 
 		float_buffer_data = new float*[num_buffer_channels];
 		for (int i = 0; i < num_buffer_channels; i++) float_buffer_data[i] = new float[num_buffer_samples];
 
+		// Silence before the first sample, read by the resampler kernels
+		buffer_position = SoundResampler::history;
+		buffer_samples_written = SoundResampler::history;
+		for (int i = 0; i < num_buffer_channels; i++)
+			SoundSSE::set_float(float_buffer_data[i], SoundResampler::history, 0.0f);
+
 		float_buffer_data_offsetted.resize(num_buffer_channels);
 	}
 
@@ -71,11 +80,41 @@ namespace clan
 
 	bool SoundBuffer_Session_Impl::mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		get_data_in_mixer_frequency(num_samples, temp_data);
+		bool more_data = get_data_in_mixer_frequency(num_samples, temp_data);
 		run_filters(temp_data, num_samples);
 		mix_channels(num_channels, num_samples, sample_data, temp_data);
-		return playing;
+		position = provider_session->get_position();
+		if (!more_data)
+			playing = false;
+		return more_data;
+	}
+
+	void SoundBuffer_Session_Impl::apply_command(const SoundMixerCommandQueue::Command &command)
+	{
+		switch (command.type)
+		{
+		case SoundMixerCommandQueue::command_set_position:
+			provider_session->set_position(command.value);
+			position = provider_session->get_position();
+			break;
+		case SoundMixerCommandQueue::command_set_end_position:
+			provider_session->set_end_position(command.value);
+			break;
+		case SoundMixerCommandQueue::command_set_looping:
+			provider_session->set_looping(command.value != 0);
+			break;
+		case SoundMixerCommandQueue::command_set_resampler_quality:
+			resampler.set_quality((ResamplerQuality)command.value);
+			break;
+		case SoundMixerCommandQueue::command_add_filter:
+			filters.push_back(command.filter);
+			break;
+		case SoundMixerCommandQueue::command_remove_filter:
+			filters.erase(std::remove(filters.begin(), filters.end(), command.filter), filters.end());
+			break;
+		default:
+			break;
+		}
 	}
 
 	void SoundBuffer_Session_Impl::get_data()
@@ -90,7 +129,7 @@ namespace clan
 		if (num_session_channels > 0)
 		{
 			// Copy stream data to working buffer:
-			int samples_left = num_buffer_samples;
+			int samples_left = num_buffer_samples - buffer_samples_written;
 			while (samples_left > 0)
 			{
 				for (int i = 0; i < num_session_channels; i++)
@@ -130,39 +169,81 @@ namespace clan
 		}
 	}
 
-	void SoundBuffer_Session_Impl::get_data_in_mixer_frequency(int num_samples, float **temp_data)
+	void SoundBuffer_Session_Impl::discard_used_data()
+	{
+		int discard = int(buffer_position) - SoundResampler::history;
+		if (discard <= 0)
+			return;
+
+		discard = std::min(discard, buffer_samples_written);
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			memmove(float_buffer_data[chan], float_buffer_data[chan] + discard, (buffer_samples_written - discard) * sizeof(float));
+		buffer_samples_written -= discard;
+		buffer_position -= discard;
+	}
+
+	bool SoundBuffer_Session_Impl::get_data_in_mixer_frequency(int num_samples, float **temp_data)
 	{
+		bool more_data = true;
 		// Convert from session frequency to mixer frequency:
-		// This is done by copying data from the temporary session buffers (buffer_data) to
+		// This is done by resampling blocks from the temporary session buffers (buffer_data) into
 		// the temporary mixing buffers (temp_data), and if buffer_data is exhausted, calling
-		// get_data() to fill it with new data from the soundprovider session object.
-		double speed = frequency / double(output.get_mixing_frequency());
-		int sample_count;
-		for (sample_count = 0; sample_count < num_samples; sample_count++)
+		// get_data() to append new data from the soundprovider session object.
+		double speed = std::max(frequency / double(output.get_mixing_frequency()), 0.0);
+		int sample_count = 0;
+		while (sample_count < num_samples)
 		{
-			if (buffer_position < buffer_samples_written)
+			// Output samples whose input, including the resampler lookahead, is in the buffers
+			int last_index = buffer_samples_written - SoundResampler::lookahead - 1;
+			int available = 0;
+			if (buffer_position <= last_index && speed == 0.0)
+			{
+				available = num_samples - sample_count;
+			}
+			else if (buffer_position <= last_index)
+			{
+				available = int(std::min((last_index - buffer_position) / speed + 1.0, double(num_samples)));
+				while (available > 0 && buffer_position + (available - 1) * speed >= last_index + 1)
+					available--;
+			}
+
+			int block_size = std::min(available, num_samples - sample_count);
+			if (block_size > 0)
 			{
 				for (int chan = 0; chan < num_buffer_channels; chan++)
-				{
-					temp_data[chan][sample_count] = float_buffer_data[chan][int(buffer_position)];
-				}
+					resampler.resample(float_buffer_data[chan], buffer_position, speed, temp_data[chan] + sample_count, block_size);
+				buffer_position += block_size * speed;
+				sample_count += block_size;
+				continue;
 			}
-			else
+
+			if (end_of_data)
 			{
+				// Continue if the provider was repositioned since
 				if (provider_session->eof())
 				{
-					playing = false;
+					more_data = false;
 					break;
 				}
-
-				// Out of data, get more from provider:
-				buffer_position -= buffer_samples_written;
-				get_data();
-				sample_count--;
-				continue;
+				end_of_data = false;
 			}
 
-			buffer_position += speed;
+			// Out of data, get more from provider:
+			discard_used_data();
+			int samples_written = buffer_samples_written;
+			get_data();
+			if (buffer_samples_written == samples_written)
+			{
+				if (!provider_session->eof())
+					break;
+
+				// Pad with silence so the last samples can be played through the resampler
+				int padding = std::min(SoundResampler::lookahead + 1, num_buffer_samples - buffer_samples_written);
+				for (int chan = 0; chan < num_buffer_channels; chan++)
+					SoundSSE::set_float(float_buffer_data[chan] + buffer_samples_written, padding, 0.0f);
+				buffer_samples_written += padding;
+				end_of_data = true;
+			}
 		}
 
 		// Clear the remaining samples (if any)
@@ -173,6 +254,7 @@ namespace clan
 				temp_data[chan][sample_count] = 0.0f;
 			}
 		}
+		return more_data;
 	}
 
 	void SoundBuffer_Session_Impl::run_filters(float **temp_data, int num_samples)
@@ -185,6 +267,8 @@ namespace clan
 
 	void SoundBuffer_Session_Impl::get_channel_volume(float *channel_volume)
 	{
+		float volume = this->volume;
+		float pan = this->pan;
 		float left_pan = 1 - pan;
 		float right_pan = 1 + pan;
 		if (left_pan < 0.0f) left_pan = 0.0f;
@@ -216,8 +300,7 @@ namespace clan
 			if (num_channels > num_buffer_channels)
 				num_channels = num_buffer_channels;
 
-			for (int chan = 0; chan < num_channels; chan++)
-				SoundSSE::mix_one_to_one(temp_data[chan], num_samples, sample_data[chan], channel_volume[chan]);
+			SoundSSE::mix_many_to_many(temp_data, num_samples, sample_data, channel_volume, num_channels);
 		}
 	}
 }
@@ -32,8 +32,10 @@
 #include "API/Sound/soundformat.h"
 #include "API/Sound/soundoutput.h"
 #include "API/Sound/soundbuffer.h"
+#include "API/Sound/sound_resampler.h"
+#include "Mixer/sound_mixer_command_queue.h"
 #include <memory>
-#include <mutex>
+#include <atomic>
 
 namespace clan
 {
@@ -55,16 +57,32 @@ namespace clan
 		SoundBuffer soundbuffer;
 		SoundProvider_Session *provider_session;
 		SoundOutput output;
-		float volume;
-		float frequency;
-		float pan;
-		bool looping;
-		bool playing;
+		std::atomic<float> volume;
+		std::atomic<float> frequency;
+		std::atomic<float> pan;
+		std::atomic<bool> looping;
+
+		/// \brief Set when play or stop is requested, and cleared by the mixer when the session reaches its end
+		std::atomic<bool> playing;
+
+		/// \brief Provider position and length as of the last mixed fragment, read by the getters without locking
+		std::atomic<int> position;
+		std::atomic<int> length;
+		std::atomic<int> resampler_quality;
+
+		/// \brief Filters and resampler of the voice. Only accessed by the mixer thread, changed through the command queue.
 		std::vector<SoundFilter> filters;
-		mutable std::recursive_mutex mutex;
+		SoundResampler resampler;
+
+		/// \brief Index in the voice array of the mixer, or -1 when not mixed. Only accessed by the mixer thread.
+		int mixer_index;
 
+		/// \brief Mixes the next num_samples into sample_data. Returns false when the session reached its end.
 		bool mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels);
 
+		/// \brief Applies a queued change of position, looping, resampler or filters. Only called by the mixer thread.
+		void apply_command(const SoundMixerCommandQueue::Command &command);
+
 	private:
 		/// \brief Mixes the sample data from 'temp_data' into 'sample_data'
 		void mix_channels(int num_channels, int num_samples, float ** sample_data, float ** temp_data);
@@ -72,15 +90,18 @@ namespace clan
 		/// \brief Returns the volume of left and right channel
 		void get_channel_volume(float *out_volume);
 
-		/// \brief Reads data into temp_data in the mixers native frequency
-		void get_data_in_mixer_frequency(int num_samples, float **temp_data);
+		/// \brief Reads data into temp_data in the mixers native frequency. Returns false if the provider ran out of data.
+		bool get_data_in_mixer_frequency(int num_samples, float **temp_data);
 
 		/// \brief Runs the sample data through attached filters
 		void run_filters(float ** temp_data, int num_samples);
 
-		/// \brief Fills temporary buffers with data from provider.
+		/// \brief Appends data from provider to the temporary buffers, until they are full.
 		void get_data();
 
+		/// \brief Moves the samples still needed by the resampler to the start of the temporary buffers
+		void discard_used_data();
+
 		/// \brief Temporary channel buffers containing sound data in provider frequency.
 		float **float_buffer_data;
 
@@ -93,9 +114,14 @@ namespace clan
 		int num_buffer_channels;
 
 		/// \brief Current playback position in temporary buffers.
+		///
+		/// The buffers keep SoundResampler::history samples before this position for the resampler.
 		double buffer_position;
 
 		/// \brief Number of samples currently written to buffer_data.
 		int buffer_samples_written;
+
+		/// \brief Provider reached its end and the buffers were padded with silence for the resampler.
+		bool end_of_data;
 	};
 }
@@ -32,7 +32,9 @@
 #include "API/Sound/soundfilter.h"
 #include "API/Sound/sound.h"
 #include "soundoutput_impl.h"
+#include "soundoutput_offline.h"
 #include "setupsound.h"
+#include <algorithm>
 
 #ifdef WIN32
 #include "Platform/Win32/soundoutput_win32.h"
@@ -66,6 +68,13 @@ namespace clan
 	SoundOutput::SoundOutput(const SoundOutput_Description &desc)
 	{
 		SetupSound::start();
+		if (desc.is_offline())
+		{
+			impl = std::make_shared<SoundOutput_Offline>(desc);
+			Sound::select_output(*this);
+			return;
+		}
+
 #ifdef WIN32
 		try
 		{
@@ -85,7 +94,7 @@ namespace clan
 #if defined(__linux__) && defined(HAVE_ALSA_ASOUNDLIB_H)
 		// Try building ALSA
 
-		std::shared_ptr<SoundOutput_Impl> alsa_impl(std::make_shared<SoundOutput_alsa>(desc.get_mixing_frequency(), desc.get_mixing_latency()));
+		std::shared_ptr<SoundOutput_Impl> alsa_impl(std::make_shared<SoundOutput_alsa>(desc));
 		if ( ( (SoundOutput_alsa *) (alsa_impl.get()))->handle)
 		{
 			impl = alsa_impl;
@@ -132,13 +141,12 @@ namespace clan
 
 	int SoundOutput::get_mixing_frequency() const
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
+		// Never changes after construction. Read without locking, as sessions ask for it while mixing.
 		return impl->mixing_frequency;
 	}
 
 	int SoundOutput::get_mixing_latency() const
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		return impl->mixing_latency;
 	}
 
@@ -154,8 +162,26 @@ namespace clan
 		return impl->pan;
 	}
 
+	int SoundOutput::get_mixing_threads() const
+	{
+		return impl->mixing_threads;
+	}
+
+	SoundMixerStatistics SoundOutput::get_mixer_statistics() const
+	{
+		std::unique_lock<std::mutex> mutex_lock(impl->statistics_mutex);
+		return impl->statistics;
+	}
+
+	bool SoundOutput::is_offline() const
+	{
+		return dynamic_cast<SoundOutput_Offline *>(impl.get()) != nullptr;
+	}
+
 	void SoundOutput::stop_all()
 	{
+		if (impl)
+			impl->queue_command(SoundMixerCommandQueue::command_stop_all, nullptr);
 	}
 
 	void SoundOutput::set_global_volume(float volume)
@@ -176,6 +202,39 @@ namespace clan
 		}
 	}
 
+	void SoundOutput::set_mixing_threads(int num_threads)
+	{
+		if (impl)
+			impl->mixing_threads = std::max(std::min(num_threads, (int)SoundMixerWorkers::max_threads), 1);
+	}
+
+	void SoundOutput::reset_mixer_statistics()
+	{
+		if (impl)
+		{
+			std::unique_lock<std::mutex> mutex_lock(impl->statistics_mutex);
+			double device_latency = impl->statistics.device_latency;
+			impl->statistics = SoundMixerStatistics();
+			impl->statistics.device_latency = device_latency;
+		}
+	}
+
+	void SoundOutput::render(int num_fragments)
+	{
+		SoundOutput_Offline *offline = dynamic_cast<SoundOutput_Offline *>(impl.get());
+		if (!offline)
+			throw Exception("Only offline sound outputs can render on demand");
+		offline->render(num_fragments);
+	}
+
+	std::vector<float> SoundOutput::take_captured_samples()
+	{
+		SoundOutput_Offline *offline = dynamic_cast<SoundOutput_Offline *>(impl.get());
+		if (!offline)
+			throw Exception("Only offline sound outputs can capture samples");
+		return offline->take_captured_samples();
+	}
+
 	void SoundOutput::add_filter(SoundFilter &filter)
 	{
 		if (impl)
@@ -36,12 +36,24 @@ namespace clan
 	public:
 		int mixing_frequency;
 		int mixing_latency;
+		bool offline;
+		bool free_running;
+		bool capture_to_memory;
+		std::string capture_filename;
+		std::string device;
+		bool low_latency;
+		int realtime_priority;
 	};
 
 	SoundOutput_Description::SoundOutput_Description() : impl(std::make_shared<SoundOutput_Description_Impl>())
 	{
 		impl->mixing_frequency = 44100;
 		impl->mixing_latency = 50;
+		impl->offline = false;
+		impl->free_running = false;
+		impl->capture_to_memory = false;
+		impl->low_latency = false;
+		impl->realtime_priority = 0;
 	}
 
 	SoundOutput_Description::~SoundOutput_Description()
@@ -58,6 +70,41 @@ namespace clan
 		return impl->mixing_latency;
 	}
 
+	bool SoundOutput_Description::is_offline() const
+	{
+		return impl->offline;
+	}
+
+	bool SoundOutput_Description::is_free_running() const
+	{
+		return impl->free_running;
+	}
+
+	bool SoundOutput_Description::get_capture_to_memory() const
+	{
+		return impl->capture_to_memory;
+	}
+
+	const std::string &SoundOutput_Description::get_capture_filename() const
+	{
+		return impl->capture_filename;
+	}
+
+	const std::string &SoundOutput_Description::get_device() const
+	{
+		return impl->device;
+	}
+
+	bool SoundOutput_Description::is_low_latency() const
+	{
+		return impl->low_latency;
+	}
+
+	int SoundOutput_Description::get_realtime_priority() const
+	{
+		return impl->realtime_priority;
+	}
+
 	void SoundOutput_Description::set_mixing_frequency(int frequency)
 	{
 		impl->mixing_frequency = frequency;
@@ -67,4 +114,35 @@ namespace clan
 	{
 		impl->mixing_latency = latency;
 	}
+
+	void SoundOutput_Description::set_offline(bool offline, bool free_running)
+	{
+		impl->offline = offline;
+		impl->free_running = free_running;
+	}
+
+	void SoundOutput_Description::set_capture_to_memory(bool enable)
+	{
+		impl->capture_to_memory = enable;
+	}
+
+	void SoundOutput_Description::set_capture_filename(const std::string &filename)
+	{
+		impl->capture_filename = filename;
+	}
+
+	void SoundOutput_Description::set_device(const std::string &device)
+	{
+		impl->device = device;
+	}
+
+	void SoundOutput_Description::set_low_latency(bool enable)
+	{
+		impl->low_latency = enable;
+	}
+
+	void SoundOutput_Description::set_realtime_priority(int priority)
+	{
+		impl->realtime_priority = priority;
+	}
 }
@@ -30,6 +30,7 @@
 #include "soundoutput_impl.h"
 #include "soundbuffer_session_impl.h"
 #include "API/Sound/soundfilter.h"
+#include "API/Sound/SoundProviders/soundprovider_session.h"
 #include <algorithm>
 #include "API/Sound/sound_sse.h"
 
@@ -40,7 +41,7 @@ namespace clan
 
 	SoundOutput_Impl::SoundOutput_Impl(int mixing_frequency, int latency)
 		: mixing_frequency(mixing_frequency), mixing_latency(latency), volume(1.0f),
-		pan(0.0f), mix_buffer_size(0)
+		pan(0.0f), mixing_threads(1), mix_buffer_size(0)
 	{
 		mix_buffers[0] = nullptr;
 		mix_buffers[1] = nullptr;
@@ -67,24 +68,9 @@ namespace clan
 		instance = nullptr;
 	}
 
-	void SoundOutput_Impl::play_session(SoundBuffer_Session &session)
+	void SoundOutput_Impl::queue_command(SoundMixerCommandQueue::Type type, const std::shared_ptr<SoundBuffer_Session_Impl> &session, int value, const SoundFilter &filter)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		sessions.push_back(session);
-	}
-
-	void SoundOutput_Impl::stop_session(SoundBuffer_Session &session)
-	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-
-		for (auto it = sessions.begin(); it != sessions.end(); ++it)
-		{
-			if (session.impl.get() == it->impl.get())
-			{
-				sessions.erase(it);
-				break;
-			}
-		}
+		commands.push(type, session, value, filter);
 	}
 
 	void SoundOutput_Impl::start_mixer_thread()
@@ -105,13 +91,27 @@ namespace clan
 
 	void SoundOutput_Impl::mix_fragment()
 	{
+		// Times of the start, fill, filter, clamp and end of the fragment
+		std::chrono::steady_clock::time_point times[5];
+		times[0] = std::chrono::steady_clock::now();
+
 		resize_mix_buffers();
 		clear_mix_buffers();
 		fill_mix_buffers();
+		times[1] = std::chrono::steady_clock::now();
 		filter_mix_buffers();
 		apply_master_volume_on_mix_buffers();
+		times[2] = std::chrono::steady_clock::now();
 		clamp_mix_buffers();
+		times[3] = std::chrono::steady_clock::now();
 		SoundSSE::pack_float_stereo(mix_buffers, mix_buffer_size, stereo_buffer);
+		times[4] = std::chrono::steady_clock::now();
+
+		double stage_times[4];
+		stage_times[0] = std::chrono::duration<double, std::micro>(times[4] - times[0]).count();
+		for (int i = 1; i < 4; i++)
+			stage_times[i] = std::chrono::duration<double, std::micro>(times[i] - times[i - 1]).count();
+		update_statistics(stage_times);
 	}
 
 	void SoundOutput_Impl::mixer_thread()
@@ -168,21 +168,104 @@ namespace clan
 		SoundSSE::set_float(mix_buffers[1], mix_buffer_size, 0.0f);
 	}
 
+	void SoundOutput_Impl::process_commands()
+	{
+		commands.process([&](SoundMixerCommandQueue::Command &command)
+		{
+			SoundBuffer_Session_Impl *session = command.session.get();
+			switch (command.type)
+			{
+			case SoundMixerCommandQueue::command_play:
+				if (session->mixer_index == -1 && session->provider_session->play())
+				{
+					session->mixer_index = int(voices.size());
+					voices.push_back(command.session);
+				}
+				session->playing = session->mixer_index != -1;
+				break;
+			case SoundMixerCommandQueue::command_stop:
+				remove_voice(session);
+				session->playing = false;
+				session->provider_session->stop();
+				break;
+			case SoundMixerCommandQueue::command_stop_all:
+				for (auto &voice : voices)
+				{
+					voice->mixer_index = -1;
+					voice->playing = false;
+					voice->provider_session->stop();
+				}
+				voices.clear();
+				break;
+			default:
+				session->apply_command(command);
+				break;
+			}
+		});
+	}
+
+	void SoundOutput_Impl::remove_voice(SoundBuffer_Session_Impl *session)
+	{
+		if (session->mixer_index == -1)
+			return;
+
+		// Swap with the last voice to keep the array packed
+		int index = session->mixer_index;
+		voices[index] = voices.back();
+		voices[index]->mixer_index = index;
+		voices.pop_back();
+		session->mixer_index = -1;
+	}
+
 	void SoundOutput_Impl::fill_mix_buffers()
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		std::vector< SoundBuffer_Session > ended_sessions;
-		std::vector< SoundBuffer_Session >::iterator it;
-		for (it = sessions.begin(); it != sessions.end(); ++it)
+		process_commands();
+
+		workers.set_num_threads(mixing_threads);
+
+		ended_voices.resize(voices.size());
+		workers.mix(voices, ended_voices, mix_buffers, temp_buffers, mix_buffer_size);
+
+		// Remove voices that reached their end, from the back so the indexes stay valid:
+		for (int i = int(voices.size()) - 1; i >= 0; i--)
 		{
-			SoundBuffer_Session session = *it;
-			bool playing = session.impl->mix_to(mix_buffers, temp_buffers, mix_buffer_size, 2);
-			if (!playing) ended_sessions.push_back(session);
+			if (ended_voices[i])
+			{
+				voices[i]->mixer_index = -1;
+				if (i != int(voices.size()) - 1)
+				{
+					voices[i] = voices.back();
+					voices[i]->mixer_index = i;
+				}
+				voices.pop_back();
+			}
 		}
+	}
 
-		// Release any sessions pending for removal:
-		int size_ended_sessions = ended_sessions.size();
-		for (int i = 0; i < size_ended_sessions; i++) stop_session(ended_sessions[i]);
+	void SoundOutput_Impl::update_statistics(const double *stage_times)
+	{
+		std::unique_lock<std::mutex> mutex_lock(statistics_mutex);
+		statistics.fragments++;
+		statistics.fragment_size = mix_buffer_size;
+		statistics.voices = int(voices.size());
+		statistics.total_mix_time += stage_times[0];
+		statistics.max_mix_time = std::max(statistics.max_mix_time, stage_times[0]);
+		statistics.total_fill_time += stage_times[1];
+		statistics.total_filter_time += stage_times[2];
+		statistics.total_clamp_time += stage_times[3];
+	}
+
+	void SoundOutput_Impl::count_xrun()
+	{
+		std::unique_lock<std::mutex> mutex_lock(statistics_mutex);
+		statistics.xruns++;
+	}
+
+	void SoundOutput_Impl::set_device_latency(double latency, double delay)
+	{
+		std::unique_lock<std::mutex> mutex_lock(statistics_mutex);
+		statistics.device_latency = latency;
+		statistics.device_delay = delay;
 	}
 
 	void SoundOutput_Impl::filter_mix_buffers()
@@ -219,13 +302,7 @@ namespace clan
 	void SoundOutput_Impl::clamp_mix_buffers()
 	{
 		// Make sure values stay inside 16 bit range:
-		for (auto & elem : mix_buffers)
-		{
-			for (int k = 0; k < mix_buffer_size; k++)
-			{
-				if (elem[k] > 1.0f)  elem[k] = 1.0f;
-				else if (elem[k] < -1.0f) elem[k] = -1.0f;
-			}
-		}
+		SoundSSE::clamp_float(mix_buffers[0], mix_buffer_size, -1.0f, 1.0f);
+		SoundSSE::clamp_float(mix_buffers[1], mix_buffer_size, -1.0f, 1.0f);
 	}
 }
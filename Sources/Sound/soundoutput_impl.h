@@ -34,6 +34,10 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include "API/Sound/soundoutput.h"
+#include "Mixer/sound_mixer_command_queue.h"
+#include "Mixer/sound_mixer_workers.h"
 
 namespace clan
 {
@@ -47,8 +51,8 @@ namespace clan
 		SoundOutput_Impl(int mixing_frequency, int mixing_latency);
 		virtual ~SoundOutput_Impl();
 
-		void play_session(SoundBuffer_Session &session);
-		void stop_session(SoundBuffer_Session &session);
+		/// \brief Queues a change to a session for the mixer thread. A null session applies to all voices.
+		void queue_command(SoundMixerCommandQueue::Type type, const std::shared_ptr<SoundBuffer_Session_Impl> &session, int value = 0, const SoundFilter &filter = SoundFilter());
 
 	protected:
 		std::string name;
@@ -59,7 +63,19 @@ namespace clan
 		std::vector<SoundFilter> filters;
 		std::thread thread;
 		std::atomic_bool stop_flag;
-		std::vector< SoundBuffer_Session > sessions;
+
+		/// \brief Session changes for the mixer thread
+		SoundMixerCommandQueue commands;
+
+		/// \brief Playing voices. Only accessed by the mixer thread.
+		std::vector<std::shared_ptr<SoundBuffer_Session_Impl>> voices;
+		std::vector<char> ended_voices;
+
+		SoundMixerWorkers workers;
+		std::atomic_int mixing_threads;
+
+		SoundMixerStatistics statistics;
+		std::mutex statistics_mutex;
 
 		int mix_buffer_size;
 		float *mix_buffers[2];
@@ -94,6 +110,12 @@ namespace clan
 		/// \brief Mixes a single fragment and stores the result in stereo_buffer.
 		void mix_fragment();
 
+		/// \brief Records a buffer underrun the device recovered from
+		void count_xrun();
+
+		/// \brief Records the playing time of the device buffer and the current output delay, in microseconds
+		void set_device_latency(double latency, double delay);
+
 	private:
 		/// \brief Worker thread for output device. Mixes the audio and sends it to write_fragment.
 		void mixer_thread();
@@ -107,9 +129,18 @@ namespace clan
 		/// \brief Clears the content of the mixing buffers
 		void clear_mix_buffers();
 
+		/// \brief Applies the session commands queued by other threads
+		void process_commands();
+
+		/// \brief Takes a voice out of the voice array
+		void remove_voice(SoundBuffer_Session_Impl *session);
+
 		/// \brief Mixes soundbuffer sessions into the mixing buffers
 		void fill_mix_buffers();
 
+		/// \brief Adds the time spent mixing a fragment to the statistics
+		void update_statistics(const double *stage_times);
+
 		/// \brief Applies filters to the mixing buffers
 		void filter_mix_buffers();
 
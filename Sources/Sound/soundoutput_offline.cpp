@@ -0,0 +1,134 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Sound/precomp.h"
+#include "soundoutput_offline.h"
+#include "API/Sound/soundoutput_description.h"
+#include <algorithm>
+
+namespace clan
+{
+	SoundOutput_Offline::SoundOutput_Offline(const SoundOutput_Description &desc)
+		: SoundOutput_Impl(desc.get_mixing_frequency(), desc.get_mixing_latency()),
+		free_running(desc.is_free_running()), capture_to_memory(desc.get_capture_to_memory()),
+		capture_to_file(!desc.get_capture_filename().empty())
+	{
+		name = "Offline";
+		fragment_size = std::max(mixing_frequency * mixing_latency / 1000, 1);
+
+		if (capture_to_file)
+		{
+			wav_file = File(desc.get_capture_filename(), File::create_always, File::access_write);
+			wav_file.set_little_endian_mode();
+			write_wav_header();
+		}
+
+		if (free_running)
+			start_mixer_thread();
+	}
+
+	SoundOutput_Offline::~SoundOutput_Offline()
+	{
+		if (free_running)
+			stop_mixer_thread();
+
+		if (capture_to_file)
+		{
+			// Now that the size is known
+			wav_file.seek(0);
+			write_wav_header();
+			wav_file.close();
+		}
+	}
+
+	void SoundOutput_Offline::render(int num_fragments)
+	{
+		if (free_running)
+			throw Exception("Cannot render fragments on a free running sound output");
+
+		std::unique_lock<std::mutex> mutex_lock(render_mutex);
+		for (int i = 0; i < num_fragments; i++)
+		{
+			mix_fragment();
+			write_fragment(stereo_buffer);
+		}
+	}
+
+	std::vector<float> SoundOutput_Offline::take_captured_samples()
+	{
+		if (!capture_to_memory)
+			throw Exception("Sound output does not capture to memory");
+
+		std::unique_lock<std::mutex> mutex_lock(capture_mutex);
+		std::vector<float> samples;
+		samples.swap(captured_samples);
+		return samples;
+	}
+
+	void SoundOutput_Offline::write_fragment(float *data)
+	{
+		int num_values = fragment_size * 2;
+
+		if (capture_to_memory)
+		{
+			std::unique_lock<std::mutex> mutex_lock(capture_mutex);
+			captured_samples.insert(captured_samples.end(), data, data + num_values);
+		}
+
+		if (capture_to_file)
+		{
+			wav_buffer.resize(num_values);
+			for (int i = 0; i < num_values; i++)
+				wav_buffer[i] = (int16_t)(data[i] * 32767.0f);
+			wav_file.write(wav_buffer.data(), num_values * sizeof(int16_t));
+			wav_data_size += num_values * sizeof(int16_t);
+		}
+	}
+
+	void SoundOutput_Offline::write_wav_header()
+	{
+		const int num_channels = 2;
+		const int bytes_per_sample = 2;
+
+		wav_file.write("RIFF", 4);
+		wav_file.write_uint32(36 + wav_data_size);
+		wav_file.write("WAVE", 4);
+
+		wav_file.write("fmt ", 4);
+		wav_file.write_uint32(16);
+		wav_file.write_uint16(1); // PCM
+		wav_file.write_uint16(num_channels);
+		wav_file.write_uint32(mixing_frequency);
+		wav_file.write_uint32(mixing_frequency * num_channels * bytes_per_sample);
+		wav_file.write_uint16(num_channels * bytes_per_sample);
+		wav_file.write_uint16(bytes_per_sample * 8);
+
+		wav_file.write("data", 4);
+		wav_file.write_uint32(wav_data_size);
+	}
+}
@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "soundoutput_impl.h"
+#include "API/Core/IOData/file.h"
+
+namespace clan
+{
+	class SoundOutput_Description;
+
+	/// \brief Sound output mixing without a sound device
+	///
+	/// Fragments are mixed on demand by render(), or as fast as possible by the mixer
+	/// thread when free running. Mixed samples can be captured to memory and to a WAV file.
+	class SoundOutput_Offline : public SoundOutput_Impl
+	{
+	public:
+		SoundOutput_Offline(const SoundOutput_Description &desc);
+		~SoundOutput_Offline();
+
+		/// \brief Mixes fragments on the calling thread
+		void render(int num_fragments);
+
+		/// \brief Returns the captured samples and clears them
+		std::vector<float> take_captured_samples();
+
+		bool is_free_running() const { return free_running; }
+		bool get_capture_to_memory() const { return capture_to_memory; }
+
+	protected:
+		void silence() override { }
+		int get_fragment_size() override { return fragment_size; }
+		void write_fragment(float *data) override;
+		void wait() override { }
+
+	private:
+		void write_wav_header();
+
+		int fragment_size;
+		bool free_running;
+		bool capture_to_memory;
+		bool capture_to_file;
+
+		std::mutex render_mutex;
+
+		std::mutex capture_mutex;
+		std::vector<float> captured_samples;
+
+		File wav_file;
+		uint32_t wav_data_size = 0;
+		std::vector<int16_t> wav_buffer;
+	};
+}
@@ -106,6 +106,8 @@ namespace clan
 
 	void CheckBoxView::render_background(Canvas &canvas)
 	{
+		static const StylePropertyId prop_background_color("background-color");
+
 		// If someone wants to make a transparent background under the label, he needs to call parent.
 		// But now simple fill background.
 
@@ -113,7 +115,7 @@ namespace clan
 		Colorf backColor = StandardColorf::transparent();
 		View *ptr = this;
 		while (ptr) {
-			const StyleGetValue value = ptr->style_cascade().cascade_value("background-color");
+			const StyleGetValue value = ptr->style_cascade().cascade_value(prop_background_color);
 			if (!value.is_undefined()) {
 				backColor = value.color();
 				break;
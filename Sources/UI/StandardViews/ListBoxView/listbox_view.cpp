@@ -46,7 +46,7 @@ namespace clan
 		slots.connect(sig_key_press(), impl.get(), &ListBoxViewImpl::on_key_press);
 		slots.connect(content_view()->sig_pointer_press(), impl.get(), &ListBoxViewImpl::on_pointer_press);
 		slots.connect(content_view()->sig_pointer_release(), impl.get(), &ListBoxViewImpl::on_pointer_release);
-
+		slots.connect(scrollbar_y_view()->sig_scroll(), impl.get(), &ListBoxViewImpl::on_scroll);
 	}
 
 	ListBoxView::~ListBoxView()
@@ -60,6 +60,9 @@ namespace clan
 	
 	void ListBoxView::set_items(const std::vector<std::shared_ptr<View>> &items)
 	{
+		if (impl->data_source)
+			set_data_source(nullptr);
+
 		impl->selected_item = -1;
 		
 		auto &views = content_view()->children();
@@ -74,6 +77,157 @@ namespace clan
 		}
 	}
 	
+	void ListBoxView::set_data_source(const std::shared_ptr<ListBoxViewDataSource> &data_source, float estimated_item_height)
+	{
+		impl->selected_item = -1;
+		impl->hot_item = -1;
+
+		auto &views = content_view()->children();
+		while (!views.empty())
+			views.back()->remove_from_parent();
+
+		impl->active_views.clear();
+		impl->unused_views.clear();
+		impl->item_view_count = 0;
+		impl->measured_width = -1.0f;
+
+		impl->data_source = data_source;
+		impl->estimated_item_height = estimated_item_height;
+
+		if (data_source)
+		{
+			impl->items_view = std::make_shared<ListBoxItemsView>(impl.get());
+			content_view()->add_child(impl->items_view);
+
+			int count = data_source->item_count();
+			impl->item_heights.reset(count, estimated_item_height);
+			impl->item_measured.assign(count, 0);
+		}
+		else
+		{
+			impl->items_view.reset();
+			impl->item_heights.reset(0, estimated_item_height);
+			impl->item_measured.clear();
+		}
+
+		set_needs_layout();
+	}
+
+	const std::shared_ptr<ListBoxViewDataSource> &ListBoxView::data_source() const
+	{
+		return impl->data_source;
+	}
+
+	void ListBoxView::items_inserted(int index, int count)
+	{
+		if (!impl->data_source || count <= 0)
+			return;
+
+		if (index < 0 || index > impl->item_count())
+			throw Exception("Listbox index out of bounds");
+
+		impl->item_heights.insert(index, count, impl->estimated_item_height);
+		impl->item_measured.insert(impl->item_measured.begin() + index, count, 0);
+
+		for (auto &item : impl->active_views)
+		{
+			if (item.index >= index)
+				item.index += count;
+		}
+
+		if (impl->selected_item >= index)
+			impl->selected_item += count;
+		if (impl->hot_item >= index)
+			impl->hot_item += count;
+
+		impl->items_view->set_needs_layout();
+	}
+
+	void ListBoxView::items_removed(int index, int count)
+	{
+		if (!impl->data_source || count <= 0)
+			return;
+
+		if (index < 0 || index + count > impl->item_count())
+			throw Exception("Listbox index out of bounds");
+
+		impl->recycle_item_views(index, count);
+		impl->item_heights.remove(index, count);
+		impl->item_measured.erase(impl->item_measured.begin() + index, impl->item_measured.begin() + index + count);
+
+		for (auto &item : impl->active_views)
+		{
+			if (item.index >= index + count)
+				item.index -= count;
+		}
+
+		if (impl->selected_item >= index + count)
+			impl->selected_item -= count;
+		else if (impl->selected_item >= index)
+			impl->selected_item = -1;
+
+		if (impl->hot_item >= index + count)
+			impl->hot_item -= count;
+		else if (impl->hot_item >= index)
+			impl->hot_item = -1;
+
+		impl->items_view->set_needs_layout();
+	}
+
+	void ListBoxView::items_changed(int index, int count)
+	{
+		if (!impl->data_source || count <= 0)
+			return;
+
+		if (index < 0 || index + count > impl->item_count())
+			throw Exception("Listbox index out of bounds");
+
+		for (auto &item : impl->active_views)
+		{
+			if (item.index >= index && item.index < index + count)
+				impl->data_source->update_item_view(item.view, item.index);
+		}
+		std::fill(impl->item_measured.begin() + index, impl->item_measured.begin() + index + count, 0);
+
+		impl->items_view->set_needs_layout();
+	}
+
+	void ListBoxView::reload_items()
+	{
+		if (!impl->data_source)
+			return;
+
+		impl->recycle_item_views(0, impl->item_count());
+		impl->selected_item = -1;
+		impl->hot_item = -1;
+
+		int count = impl->data_source->item_count();
+		impl->item_heights.reset(count, impl->estimated_item_height);
+		impl->item_measured.assign(count, 0);
+
+		impl->items_view->set_needs_layout();
+	}
+
+	int ListBoxView::overscan() const
+	{
+		return impl->overscan;
+	}
+
+	void ListBoxView::set_overscan(int items)
+	{
+		if (impl->overscan == items)
+			return;
+
+		impl->overscan = items;
+		if (impl->items_view)
+			impl->items_view->set_needs_layout();
+	}
+
+	int ListBoxView::item_view_count() const
+	{
+		return impl->item_view_count;
+	}
+
 	int ListBoxView::selected_item() const
 	{
 		return impl->selected_item;
@@ -84,19 +238,24 @@ namespace clan
 		if (index == impl->selected_item)
 			return;
 		
-		if (index < -1 || index >= (int) content_view()->children().size())
+		if (index < -1 || index >= impl->item_count())
 			throw Exception("Listbox index out of bounds");
 
 		if (impl->selected_item != -1)
-			content_view()->children().at(impl->selected_item)->set_state("selected", false);
+		{
+			auto old_selected_item = impl->item_view(impl->selected_item);
+			if (old_selected_item)
+				old_selected_item->set_state("selected", false);
+		}
 		
 		if (index != -1)
 		{
 			if (impl->hot_item == index)
 				impl->set_hot_item(-1);
 
-			auto new_selected_item = content_view()->children().at(index);
-			new_selected_item->set_state("selected", true);
+			auto new_selected_item = impl->item_view(index);
+			if (new_selected_item)
+				new_selected_item->set_state("selected", true);
 			
 			// Scroll to selected in layout_children(), when geometry will be defined.
 			needScrollToSelected = true;
@@ -110,14 +269,14 @@ namespace clan
 		// Call parent.
 		ScrollView::layout_children(canvas);
 
-		// Content of the ListBoxView.
-		auto items(content_view()->children());
+		// Views for the visible items of a virtualized list.
+		impl->update_item_views(canvas);
 
 		// Scroll to selected item if it needs.
 		if (needScrollToSelected) {
 
 			// Geometry of the selected item.
-			const Rectf boxOfSelected = items.at(impl->selected_item)->geometry().margin_box();
+			const Rectf boxOfSelected = impl->item_box(impl->selected_item);
 
 
 			// Scroll position.
@@ -137,11 +296,12 @@ namespace clan
 
 			// Call parent again to update the scrolled positions.
 			ScrollView::layout_children(canvas);
+			impl->update_item_views(canvas);
 		}
 
 		// Set line_step size equal to the height of first item.
-		if (!items.empty()) {
-			float height = items.front()->geometry().margin_box().get_height();
+		if (impl->item_count() > 0) {
+			float height = impl->item_box(0).get_height();
 			scrollbar_y_view()->set_line_step(height);
 		}
 	}
@@ -29,17 +29,274 @@
 */
 
 #include "UI/precomp.h"
+#include "API/Display/2D/canvas.h"
 #include "API/UI/StandardViews/listbox_view.h"
 #include "API/UI/StandardViews/text_field_view.h"
 #include "API/UI/Events/pointer_event.h"
 #include "API/UI/Events/key_event.h"
+#include "API/UI/StandardViews/scrollbar_view.h"
+#include "UI/View/view_impl.h"
 #include "listbox_view_impl.h"
+#include <algorithm>
 
 namespace clan
 {
+	void ListBoxItemHeights::reset(int count, float height)
+	{
+		heights.assign(count, height);
+		rebuild();
+	}
+
+	void ListBoxItemHeights::insert(int index, int count, float height)
+	{
+		heights.insert(heights.begin() + index, count, height);
+		rebuild();
+	}
+
+	void ListBoxItemHeights::remove(int index, int count)
+	{
+		heights.erase(heights.begin() + index, heights.begin() + index + count);
+		rebuild();
+	}
+
+	void ListBoxItemHeights::set_height(int index, float height)
+	{
+		double delta = height - heights[index];
+		heights[index] = height;
+
+		int size = (int)heights.size();
+		for (int i = index + 1; i <= size; i += i & -i)
+			tree[i] += delta;
+		total_height = (float)offset_sum(size);
+	}
+
+	float ListBoxItemHeights::offset(int index) const
+	{
+		return (float)offset_sum(index);
+	}
+
+	double ListBoxItemHeights::offset_sum(int count) const
+	{
+		double sum = 0.0;
+		for (int i = count; i > 0; i -= i & -i)
+			sum += tree[i];
+		return sum;
+	}
+
+	int ListBoxItemHeights::find(float offset) const
+	{
+		int size = (int)heights.size();
+		int step = 1;
+		while (step * 2 <= size)
+			step *= 2;
+
+		// Descend the tree to find the number of items ending at or above the offset
+		int index = 0;
+		double remaining = offset;
+		for (; step > 0; step /= 2)
+		{
+			if (index + step <= size && tree[index + step] <= remaining)
+			{
+				index += step;
+				remaining -= tree[index];
+			}
+		}
+		return clan::max(clan::min(index, size - 1), 0);
+	}
+
+	void ListBoxItemHeights::rebuild()
+	{
+		int size = (int)heights.size();
+		tree.assign(size + 1, 0.0);
+		for (int i = 1; i <= size; i++)
+		{
+			tree[i] += heights[i - 1];
+			int parent = i + (i & -i);
+			if (parent <= size)
+				tree[parent] += tree[i];
+		}
+		total_height = (float)offset_sum(size);
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void ListBoxItemsView::layout_children(Canvas &canvas)
+	{
+		impl->update_item_views(canvas);
+	}
+
+	float ListBoxItemsView::calculate_preferred_height(Canvas &canvas, float width)
+	{
+		return impl->item_heights.total();
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	int ListBoxViewImpl::item_count() const
+	{
+		if (data_source)
+			return item_heights.size();
+		else
+			return (int)listbox->content_view()->children().size();
+	}
+
+	std::shared_ptr<View> ListBoxViewImpl::item_view(int index) const
+	{
+		if (!data_source)
+			return listbox->content_view()->children().at(index);
+
+		auto it = std::lower_bound(active_views.begin(), active_views.end(), index, [](const ItemView &item, int index) { return item.index < index; });
+		if (it != active_views.end() && it->index == index)
+			return it->view;
+		return nullptr;
+	}
+
+	Rectf ListBoxViewImpl::item_box(int index) const
+	{
+		if (!data_source)
+			return listbox->content_view()->children().at(index)->geometry().margin_box();
+
+		const ViewGeometry &geometry = items_view->geometry();
+		float top = geometry.content_y + item_heights.offset(index);
+		return Rectf(geometry.content_x, top, geometry.content_x + geometry.content_width, top + item_heights.height(index));
+	}
+
+	void ListBoxViewImpl::update_item_views(Canvas &canvas)
+	{
+		if (!data_source)
+			return;
+
+		const ViewGeometry &geometry = items_view->geometry();
+		float width = geometry.content_width;
+		if (width != measured_width)
+		{
+			std::fill(item_measured.begin(), item_measured.end(), 0);
+			measured_width = width;
+		}
+
+		// Range of items intersecting the visible area, plus the overscan
+		int count = item_heights.size();
+		int first = 0;
+		int last = -1;
+		if (count > 0)
+		{
+			float visible_top = (float)listbox->scrollbar_y_view()->position() - geometry.content_y;
+			float visible_bottom = visible_top + listbox->geometry().content_height;
+			first = clan::max(item_heights.find(visible_top) - overscan, 0);
+			last = clan::min(item_heights.find(visible_bottom) + overscan, count - 1);
+		}
+
+		// Views scrolled out of the range are reused for the items scrolled into it
+		std::vector<std::shared_ptr<View>> reusable;
+		std::vector<ItemView> views;
+		views.reserve(last - first + 1);
+		for (ItemView &item : active_views)
+		{
+			if (item.index < first || item.index > last)
+				reusable.push_back(std::move(item.view));
+			else
+				views.push_back(std::move(item));
+		}
+
+		active_views.clear();
+		active_views.reserve(last - first + 1);
+		size_t next_view = 0;
+		for (int index = first; index <= last; index++)
+		{
+			if (next_view < views.size() && views[next_view].index == index)
+			{
+				active_views.push_back(std::move(views[next_view++]));
+				continue;
+			}
+
+			std::shared_ptr<View> view;
+			if (!reusable.empty())
+			{
+				view = std::move(reusable.back());
+				reusable.pop_back();
+			}
+			else if (!unused_views.empty())
+			{
+				view = std::move(unused_views.back());
+				unused_views.pop_back();
+				view->set_hidden(false);
+			}
+			else
+			{
+				view = data_source->create_item_view();
+				items_view->add_child(view);
+				listbox->slots.connect(view->sig_pointer_enter(), this, &ListBoxViewImpl::on_pointer_enter);
+				listbox->slots.connect(view->sig_pointer_leave(), this, &ListBoxViewImpl::on_pointer_leave);
+				item_view_count++;
+			}
+
+			data_source->update_item_view(view, index);
+			view->set_state("selected", index == selected_item);
+			view->set_state("hot", index == hot_item);
+			item_measured[index] = 0;
+
+			active_views.push_back({ index, std::move(view) });
+		}
+
+		for (auto &view : reusable)
+		{
+			view->set_hidden(true);
+			unused_views.push_back(std::move(view));
+		}
+
+		// Measure items displayed for the first time and position all the views
+		float total_height = item_heights.total();
+		for (ItemView &item : active_views)
+		{
+			const StyleCascade &style = item.view->style_cascade();
+			if (!item_measured[item.index])
+			{
+				float content_width = ViewGeometry::from_margin_box(style, Rectf(0.0f, 0.0f, width, 0.0f)).content_width;
+				float content_height = item.view->preferred_height(canvas, content_width);
+				item_heights.set_height(item.index, ViewGeometry::from_content_box(style, Rectf(0.0f, 0.0f, content_width, content_height)).margin_box().get_height());
+				item_measured[item.index] = 1;
+			}
+		}
+
+		for (ItemView &item : active_views)
+		{
+			float top = item_heights.offset(item.index);
+			item.view->set_geometry(ViewGeometry::from_margin_box(item.view->style_cascade(), Rectf(0.0f, top, width, top + item_heights.height(item.index))));
+			ViewImpl::update_layout(item.view.get(), canvas, true);
+		}
+
+		// The scroll range has to be updated when the measured heights differ from the estimates
+		if (item_heights.total() != total_height)
+			items_view->set_needs_layout();
+	}
+
+	void ListBoxViewImpl::recycle_item_views(int index, int count)
+	{
+		auto it = std::remove_if(active_views.begin(), active_views.end(), [&](ItemView &item)
+		{
+			if (item.index < index || item.index >= index + count)
+				return false;
+			item.view->set_hidden(true);
+			unused_views.push_back(std::move(item.view));
+			return true;
+		});
+		active_views.erase(it, active_views.end());
+	}
+
+	void ListBoxViewImpl::on_scroll()
+	{
+		if (data_source)
+		{
+			Canvas canvas = listbox->canvas();
+			update_item_views(canvas);
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
 	void ListBoxViewImpl::on_key_press(KeyEvent &e)
 	{
-		if (listbox->content_view()->children().empty())
+		if (item_count() == 0)
 			return;
 
 		if (e.key() == Key::up)
@@ -50,7 +307,7 @@ namespace clan
 		}
 		else if (e.key() == Key::down)
 		{
-			set_selected_item(clan::min(selected_item + 1, (int)listbox->content_view()->children().size() - 1));
+			set_selected_item(clan::min(selected_item + 1, item_count() - 1));
 			if (func_selection_changed)
 				func_selection_changed();
 		}
@@ -88,6 +345,14 @@ namespace clan
 
 	int ListBoxViewImpl::get_selection_index(PointerEvent &e)
 	{
+		if (data_source)
+		{
+			float y = e.pos(items_view).y;
+			if (item_heights.size() == 0 || y < 0.0f || y >= item_heights.total())
+				return -1;
+			return item_heights.find(y);
+		}
+
 		int index = 0;
 		for (auto &view : listbox->content_view()->children())
 		{
@@ -104,16 +369,21 @@ namespace clan
 		if (index == hot_item || index == selected_item && index != -1)
 			return;
 
-		if (index < -1 || index >= (int) listbox->content_view()->children().size())
+		if (index < -1 || index >= item_count())
 			throw Exception("Listbox index out of bounds");
 
 		if (hot_item != -1)
-			listbox->content_view()->children().at(hot_item)->set_state("hot", false);
+		{
+			auto old_hot_item = item_view(hot_item);
+			if (old_hot_item)
+				old_hot_item->set_state("hot", false);
+		}
 
 		if (index != -1)
 		{
-			auto new_selected_item = listbox->content_view()->children().at(index);
-			new_selected_item->set_state("hot", true);
+			auto new_hot_item = item_view(index);
+			if (new_hot_item)
+				new_hot_item->set_state("hot", true);
 		}
 
 		hot_item = index;
@@ -28,8 +28,59 @@
 */
 #pragma once
 
+#include <vector>
+
 namespace clan
 {
+	class ListBoxViewImpl;
+
+	/// Item heights of a virtualized list with prefix sums for finding item offsets
+	class ListBoxItemHeights
+	{
+	public:
+		void reset(int count, float height);
+		void insert(int index, int count, float height);
+		void remove(int index, int count);
+
+		int size() const { return (int)heights.size(); }
+		float height(int index) const { return heights[index]; }
+		void set_height(int index, float height);
+
+		/// Offset of the top of an item
+		float offset(int index) const;
+
+		/// Index of the item containing the offset, clamped to the valid items
+		int find(float offset) const;
+
+		float total() const { return total_height; }
+
+	private:
+		double offset_sum(int count) const;
+		void rebuild();
+
+		std::vector<float> heights;
+		std::vector<double> tree;
+		float total_height = 0.0f;
+	};
+
+	/// Container of the item views in a virtualized list
+	class ListBoxItemsView : public View
+	{
+	public:
+		ListBoxItemsView(ListBoxViewImpl *impl) : impl(impl) { }
+
+		void layout_children(Canvas &canvas) override;
+
+	protected:
+		float calculate_preferred_width(Canvas &canvas) override { return 0.0f; }
+		float calculate_preferred_height(Canvas &canvas, float width) override;
+		float calculate_first_baseline_offset(Canvas &canvas, float width) override { return 0.0f; }
+		float calculate_last_baseline_offset(Canvas &canvas, float width) override { return 0.0f; }
+
+	private:
+		ListBoxViewImpl *impl;
+	};
+
 	class ListBoxViewImpl
 	{
 	public:
@@ -38,10 +89,24 @@ namespace clan
 		void on_pointer_release(PointerEvent &e);
 		void on_pointer_enter(PointerEvent &e);
 		void on_pointer_leave(PointerEvent &e);
+		void on_scroll();
 
 		void set_hot_item(int index);
 		void set_selected_item(int index);
 
+		/// Number of items, in both normal and virtualized mode
+		int item_count() const;
+
+		/// View displaying an item, or nullptr if the item has no view in virtualized mode
+		std::shared_ptr<View> item_view(int index) const;
+
+		/// Margin box of an item relative to the content view
+		Rectf item_box(int index) const;
+
+		/// Creates, reuses and positions the item views for the visible part of a virtualized list
+		void update_item_views(Canvas &canvas);
+		void recycle_item_views(int index, int count);
+
 		ListBoxView *listbox = nullptr;
 		int selected_item = -1;
 		int hot_item = -1;
@@ -49,6 +114,25 @@ namespace clan
 
 		std::function<void()> func_selection_changed;
 
+		struct ItemView
+		{
+			int index;
+			std::shared_ptr<View> view;
+		};
+
+		std::shared_ptr<ListBoxViewDataSource> data_source;
+		std::shared_ptr<ListBoxItemsView> items_view;
+		ListBoxItemHeights item_heights;
+		std::vector<unsigned char> item_measured;
+		float estimated_item_height = 20.0f;
+		float measured_width = -1.0f;
+		int overscan = 4;
+		int item_view_count = 0;
+
+		/// Item views in use, sorted by item index
+		std::vector<ItemView> active_views;
+		std::vector<std::shared_ptr<View>> unused_views;
+
 	private:
 		int get_selection_index(PointerEvent &e);
 	};
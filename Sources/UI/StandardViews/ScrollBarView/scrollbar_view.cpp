@@ -144,7 +144,9 @@ namespace clan
 
 	bool ScrollBarView::vertical() const
 	{
-		return style_cascade().computed_value("flex-direction").is_keyword("column");
+		static const StylePropertyId prop_flex_direction("flex-direction");
+
+		return style_cascade().computed_value(prop_flex_direction).is_keyword("column");
 	}
 
 	bool ScrollBarView::horizontal() const
@@ -96,6 +96,8 @@ namespace clan
 
 	void SpanLayoutViewImpl::render_content(Canvas &canvas, float width)
 	{
+		static const StylePropertyId prop_color("color");
+
 		float y = 0.0f;
 		size_t obj_start = 0;
 		size_t text_start = 0;
@@ -130,7 +132,7 @@ namespace clan
 					GlyphMetrics advance = object.get_font(canvas).measure_text(canvas, obj_text);
 
 					clan::Font font = object.get_font(canvas);
-					font.draw_text(canvas, x, y + metrics.ascent + object.baseline_offset, obj_text, object.style_cascade.computed_value("color").color());
+					font.draw_text(canvas, x, y + metrics.ascent + object.baseline_offset, obj_text, object.style_cascade.computed_value(prop_color).color());
 
 					x += advance.advance.width;
 				}
@@ -149,6 +151,19 @@ namespace clan
 
 	void SpanLayoutViewImpl::layout_views(Canvas &canvas, float width)
 	{
+		static const StylePropertyId prop_margin_left("margin-left");
+		static const StylePropertyId prop_border_left_width("border-left-width");
+		static const StylePropertyId prop_padding_left("padding-left");
+		static const StylePropertyId prop_margin_right("margin-right");
+		static const StylePropertyId prop_border_right_width("border-right-width");
+		static const StylePropertyId prop_padding_right("padding-right");
+		static const StylePropertyId prop_margin_top("margin-top");
+		static const StylePropertyId prop_border_top_width("border-top-width");
+		static const StylePropertyId prop_padding_top("padding-top");
+		static const StylePropertyId prop_margin_bottom("margin-bottom");
+		static const StylePropertyId prop_border_bottom_width("border-bottom-width");
+		static const StylePropertyId prop_padding_bottom("padding-bottom");
+
 		float y = 0.0f;
 		size_t obj_start = 0;
 		size_t text_start = 0;
@@ -193,23 +208,23 @@ namespace clan
 					if (obj_baseline_offset == 0.0f) // Hmm, do we need first_baseline_offset to be able to return that there is no baseline?
 						obj_baseline_offset = obj_height;
 
-					obj_width += object.view->style_cascade().computed_value("margin-left").number();
-					obj_width += object.view->style_cascade().computed_value("border-left-width").number();
-					obj_width += object.view->style_cascade().computed_value("padding-left").number();
-					obj_width += object.view->style_cascade().computed_value("margin-right").number();
-					obj_width += object.view->style_cascade().computed_value("border-right-width").number();
-					obj_width += object.view->style_cascade().computed_value("padding-right").number();
+					obj_width += object.view->style_cascade().computed_value(prop_margin_left).number();
+					obj_width += object.view->style_cascade().computed_value(prop_border_left_width).number();
+					obj_width += object.view->style_cascade().computed_value(prop_padding_left).number();
+					obj_width += object.view->style_cascade().computed_value(prop_margin_right).number();
+					obj_width += object.view->style_cascade().computed_value(prop_border_right_width).number();
+					obj_width += object.view->style_cascade().computed_value(prop_padding_right).number();
 
-					obj_height += object.view->style_cascade().computed_value("margin-top").number();
-					obj_height += object.view->style_cascade().computed_value("border-top-width").number();
-					obj_height += object.view->style_cascade().computed_value("padding-top").number();
-					obj_height += object.view->style_cascade().computed_value("margin-bottom").number();
-					obj_height += object.view->style_cascade().computed_value("border-bottom-width").number();
-					obj_height += object.view->style_cascade().computed_value("padding-bottom").number();
+					obj_height += object.view->style_cascade().computed_value(prop_margin_top).number();
+					obj_height += object.view->style_cascade().computed_value(prop_border_top_width).number();
+					obj_height += object.view->style_cascade().computed_value(prop_padding_top).number();
+					obj_height += object.view->style_cascade().computed_value(prop_margin_bottom).number();
+					obj_height += object.view->style_cascade().computed_value(prop_border_bottom_width).number();
+					obj_height += object.view->style_cascade().computed_value(prop_padding_bottom).number();
 
-					obj_baseline_offset += object.view->style_cascade().computed_value("margin-top").number();
-					obj_baseline_offset += object.view->style_cascade().computed_value("border-top-width").number();
-					obj_baseline_offset += object.view->style_cascade().computed_value("padding-top").number();
+					obj_baseline_offset += object.view->style_cascade().computed_value(prop_margin_top).number();
+					obj_baseline_offset += object.view->style_cascade().computed_value(prop_border_top_width).number();
+					obj_baseline_offset += object.view->style_cascade().computed_value(prop_padding_top).number();
 
 					obj_y -= obj_baseline_offset;
 
@@ -285,6 +300,19 @@ namespace clan
 
 	SpanLineMetrics SpanLayoutViewImpl::find_line_metrics(Canvas &canvas, size_t obj_start, size_t text_start, float width)
 	{
+		static const StylePropertyId prop_margin_left("margin-left");
+		static const StylePropertyId prop_border_left_width("border-left-width");
+		static const StylePropertyId prop_padding_left("padding-left");
+		static const StylePropertyId prop_margin_right("margin-right");
+		static const StylePropertyId prop_border_right_width("border-right-width");
+		static const StylePropertyId prop_padding_right("padding-right");
+		static const StylePropertyId prop_margin_top("margin-top");
+		static const StylePropertyId prop_border_top_width("border-top-width");
+		static const StylePropertyId prop_padding_top("padding-top");
+		static const StylePropertyId prop_margin_bottom("margin-bottom");
+		static const StylePropertyId prop_border_bottom_width("border-bottom-width");
+		static const StylePropertyId prop_padding_bottom("padding-bottom");
+
 		float line_ascent = 0.0f;
 		float line_descent = 0.0f;
 		float x = 0.0f;
@@ -352,23 +380,23 @@ namespace clan
 				if (obj_baseline_offset == 0.0f) // Hmm, do we need first_baseline_offset to be able to return that there is no baseline?
 					obj_baseline_offset = obj_height;
 
-				obj_width += object.view->style_cascade().computed_value("margin-left").number();
-				obj_width += object.view->style_cascade().computed_value("border-left-width").number();
-				obj_width += object.view->style_cascade().computed_value("padding-left").number();
-				obj_width += object.view->style_cascade().computed_value("margin-right").number();
-				obj_width += object.view->style_cascade().computed_value("border-right-width").number();
-				obj_width += object.view->style_cascade().computed_value("padding-right").number();
-
-				obj_height += object.view->style_cascade().computed_value("margin-top").number();
-				obj_height += object.view->style_cascade().computed_value("border-top-width").number();
-				obj_height += object.view->style_cascade().computed_value("padding-top").number();
-				obj_height += object.view->style_cascade().computed_value("margin-bottom").number();
-				obj_height += object.view->style_cascade().computed_value("border-bottom-width").number();
-				obj_height += object.view->style_cascade().computed_value("padding-bottom").number();
-
-				obj_baseline_offset += object.view->style_cascade().computed_value("margin-top").number();
-				obj_baseline_offset += object.view->style_cascade().computed_value("border-top-width").number();
-				obj_baseline_offset += object.view->style_cascade().computed_value("padding-top").number();
+				obj_width += object.view->style_cascade().computed_value(prop_margin_left).number();
+				obj_width += object.view->style_cascade().computed_value(prop_border_left_width).number();
+				obj_width += object.view->style_cascade().computed_value(prop_padding_left).number();
+				obj_width += object.view->style_cascade().computed_value(prop_margin_right).number();
+				obj_width += object.view->style_cascade().computed_value(prop_border_right_width).number();
+				obj_width += object.view->style_cascade().computed_value(prop_padding_right).number();
+
+				obj_height += object.view->style_cascade().computed_value(prop_margin_top).number();
+				obj_height += object.view->style_cascade().computed_value(prop_border_top_width).number();
+				obj_height += object.view->style_cascade().computed_value(prop_padding_top).number();
+				obj_height += object.view->style_cascade().computed_value(prop_margin_bottom).number();
+				obj_height += object.view->style_cascade().computed_value(prop_border_bottom_width).number();
+				obj_height += object.view->style_cascade().computed_value(prop_padding_bottom).number();
+
+				obj_baseline_offset += object.view->style_cascade().computed_value(prop_margin_top).number();
+				obj_baseline_offset += object.view->style_cascade().computed_value(prop_border_top_width).number();
+				obj_baseline_offset += object.view->style_cascade().computed_value(prop_padding_top).number();
 
 				obj_ascent = obj_baseline_offset;
 				obj_descent = obj_height - obj_baseline_offset;
@@ -343,6 +343,8 @@ namespace clan
 
 	void TextFieldView::render_content(Canvas &canvas)
 	{
+		static const StylePropertyId prop_color("color");
+
 		std::string txt_before = impl->get_text_before_selection();
 		std::string txt_selected = impl->get_selected_text();
 		std::string txt_after = impl->get_text_after_selection();
@@ -380,7 +382,7 @@ namespace clan
 			Path::rect(selection_rect).fill(canvas, focus_view() == this ? Brush::solid_rgb8(51, 153, 255) : Brush::solid_rgb8(200, 200, 200));
 		}
 
-		Colorf color = style_cascade().computed_value("color").color();
+		Colorf color = style_cascade().computed_value(prop_color).color();
 		font.draw_text(canvas, -impl->scroll_pos, baseline, txt_before, color);
 		font.draw_text(canvas, advance_before - impl->scroll_pos, baseline, txt_selected, focus_view() == this ? Colorf(255, 255, 255) : color);
 		font.draw_text(canvas, advance_before + advance_selected - impl->scroll_pos, baseline, txt_after, color);
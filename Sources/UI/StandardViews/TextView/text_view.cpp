@@ -51,6 +51,7 @@ namespace clan
 	{
 		impl->textfield = this;
 		impl->text_lines.resize(1);
+		impl->line_metrics.resize(1);
 		impl->selection.set_view(this);
 
 		set_focus_policy(FocusPolicy::accept);
@@ -116,6 +117,8 @@ namespace clan
 		impl->text_lines = StringHelp::split_text(text, "\n", false);
 		if (impl->text_lines.empty())
 			impl->text_lines.resize(1);
+		impl->line_metrics.clear();
+		impl->line_metrics.resize(impl->text_lines.size());
 
 		impl->selection.reset();
 		impl->cursor_pos = Vec2i();
@@ -185,7 +188,7 @@ namespace clan
 	{
 		// Bounds check: (to do: should we throw an out of bounds exception instead?)
 		head.y = std::max(std::min(head.y, (int)impl->text_lines.size() - 1), 0);
-		tail.y = std::max(std::min(head.y, (int)impl->text_lines.size() - 1), 0);
+		tail.y = std::max(std::min(tail.y, (int)impl->text_lines.size() - 1), 0);
 		head.x = std::max(std::min(head.x, (int)impl->text_lines[head.y].size()), 0);
 		tail.x = std::max(std::min(tail.x, (int)impl->text_lines[tail.y].size()), 0);
 
@@ -248,47 +251,53 @@ namespace clan
 
 	void TextView::render_content(Canvas &canvas)
 	{
+		static const StylePropertyId prop_color("color");
+
 		Font font = impl->get_font(canvas);
 		FontMetrics font_metrics = font.get_font_metrics(canvas);
 		float baseline = font_metrics.get_baseline_offset();
 		float top_y = baseline - font_metrics.get_ascent();
 		float bottom_y = baseline + font_metrics.get_descent();
 
-		Colorf color = style_cascade().computed_value("color").color();
+		Colorf color = style_cascade().computed_value(prop_color).color();
 
-		float cursor_advance = canvas.grid_fit({ font.measure_text(canvas, impl->text_lines[impl->cursor_pos.y].substr(0, impl->cursor_pos.x)).advance.width, 0.0f }).x;
+		float cursor_advance = canvas.grid_fit({ impl->get_line_offset(canvas, impl->cursor_pos.y, impl->cursor_pos.x), 0.0f }).x;
 
 		// Keep cursor in view
 		impl->scroll_pos.x = std::min(impl->scroll_pos.x, cursor_advance);
 		impl->scroll_pos.x = std::max(impl->scroll_pos.x, cursor_advance - geometry().content_width + 1.0f);
 
-		size_t line_start_y = -impl->scroll_pos.y;
+		// Only the lines inside the content box are drawn
+		float line_height = font_metrics.get_line_height();
+		int first_line = impl->scroll_pos.y > 0.0f ? (int)std::floor(impl->scroll_pos.y / line_height) : 0;
+		float line_start_y = first_line * line_height - impl->scroll_pos.y;
+
+		Vec2i selection_start = impl->selection.start();
+		Vec2i selection_end = impl->selection.end();
 
-		for (size_t line_index = 0; line_index < impl->text_lines.size(); line_index++)
+		for (int line_index = first_line; line_index < (int)impl->text_lines.size() && line_start_y < geometry().content_height; line_index++)
 		{
-			std::string txt_before = impl->get_text_before_selection(line_index);
-			std::string txt_selected = impl->get_selected_text(line_index);
-			std::string txt_after = impl->get_text_after_selection(line_index);
+			const std::string &line = impl->text_lines[line_index];
+			int line_length = (int)line.length();
 
-			float advance_before = font.measure_text(canvas, txt_before).advance.width;
-			float advance_selected = font.measure_text(canvas, txt_selected).advance.width;
+			int selected_begin = selection_start.y < line_index ? 0 : selection_start.y == line_index ? selection_start.x : line_length;
+			int selected_end = selection_end.y > line_index ? line_length : selection_end.y == line_index ? selection_end.x : 0;
+			selected_end = std::max(selected_end, selected_begin);
 
-			// Measure text for get_character_index()
-			impl->last_measured_rects = font.get_character_indices(canvas, txt_before + txt_selected + txt_after);
-			for (auto &box : impl->last_measured_rects)
-				box.translate(-impl->scroll_pos.x, line_start_y);
+			float advance_before = impl->get_line_offset(canvas, line_index, selected_begin);
+			float advance_selected = impl->get_line_offset(canvas, line_index, selected_end) - advance_before;
 
-			if (!txt_selected.empty())
+			if (selected_end != selected_begin)
 			{
 				Rectf selection_rect = Rectf(advance_before - impl->scroll_pos.x, top_y + line_start_y, advance_before + advance_selected - impl->scroll_pos.x, bottom_y + line_start_y);
 				Path::rect(selection_rect).fill(canvas, focus_view() == this ? Brush::solid_rgb8(51, 153, 255) : Brush::solid_rgb8(200, 200, 200));
 			}
 
-			font.draw_text(canvas, -impl->scroll_pos.x, baseline + line_start_y, txt_before, color);
-			font.draw_text(canvas, advance_before - impl->scroll_pos.x, baseline + line_start_y, txt_selected, focus_view() == this ? Colorf(255, 255, 255) : color);
-			font.draw_text(canvas, advance_before + advance_selected - impl->scroll_pos.x, baseline + line_start_y, txt_after, color);
+			font.draw_text(canvas, -impl->scroll_pos.x, baseline + line_start_y, line.substr(0, selected_begin), color);
+			font.draw_text(canvas, advance_before - impl->scroll_pos.x, baseline + line_start_y, line.substr(selected_begin, selected_end - selected_begin), focus_view() == this ? Colorf(255, 255, 255) : color);
+			font.draw_text(canvas, advance_before + advance_selected - impl->scroll_pos.x, baseline + line_start_y, line.substr(selected_end), color);
 
-			line_start_y += font_metrics.get_line_height();
+			line_start_y += line_height;
 		}
 
 		if (impl->cursor_blink_visible)
@@ -338,6 +347,47 @@ namespace clan
 		return font;
 	}
 
+	const TextViewImpl::LineMetrics &TextViewImpl::measure_line(Canvas &canvas, int line_index)
+	{
+		// Glyph advances depend on the pixel ratio of the canvas
+		float pixel_ratio = canvas.get_pixel_ratio();
+		if (pixel_ratio != measured_pixel_ratio)
+		{
+			for (auto &metrics : line_metrics)
+				metrics = LineMetrics();
+			measured_pixel_ratio = pixel_ratio;
+		}
+
+		LineMetrics &metrics = line_metrics[line_index];
+		if (metrics.positions.empty())
+		{
+			Font &font = get_font(canvas);
+			const std::string &line = text_lines[line_index];
+
+			float x = 0.0f;
+			UTF8_Reader reader(line.data(), line.length());
+			while (!reader.is_end())
+			{
+				metrics.positions.push_back(reader.get_position());
+				metrics.offsets.push_back(x);
+				x += font.get_metrics(canvas, reader.get_char()).advance.width;
+				reader.next();
+			}
+			metrics.positions.push_back(line.length());
+			metrics.offsets.push_back(x);
+		}
+		return metrics;
+	}
+
+	float TextViewImpl::get_line_offset(Canvas &canvas, int line_index, int pos)
+	{
+		const LineMetrics &metrics = measure_line(canvas, line_index);
+		auto it = std::lower_bound(metrics.positions.begin(), metrics.positions.end(), pos);
+		if (it == metrics.positions.end())
+			return metrics.offsets.back();
+		return metrics.offsets[it - metrics.positions.begin()];
+	}
+
 	void TextViewImpl::start_blink()
 	{
 		blink_timer.func_expired() = [&]()
@@ -574,7 +624,7 @@ namespace clan
 
 	void TextViewImpl::select_all()
 	{
-		selection.set_head_and_tail(Vec2i(), Vec2i(text_lines.back().size(), text_lines.size()));
+		selection.set_head_and_tail(Vec2i(), Vec2i(text_lines.back().size(), text_lines.size() - 1));
 	}
 
 	void TextViewImpl::move_line(int steps, bool ctrl, bool shift, bool stay_on_line)
@@ -769,29 +819,16 @@ namespace clan
 		}
 		else if (cursor_pos.x > 0)
 		{
-			save_undo();
-
 			UTF8_Reader utf8_reader(text_lines[cursor_pos.y].data(), text_lines[cursor_pos.y].length());
 			utf8_reader.set_position(cursor_pos.x);
 			utf8_reader.prev();
 			int new_cursor_pos = utf8_reader.get_position();
 
-			text_lines[cursor_pos.y].erase(text_lines[cursor_pos.y].begin() + new_cursor_pos, text_lines[cursor_pos.y].begin() + cursor_pos.x);
-			cursor_pos.x = new_cursor_pos;
-
-			textfield->set_needs_render();
+			edit(Vec2i(new_cursor_pos, cursor_pos.y), cursor_pos, std::string());
 		}
 		else if (cursor_pos.y > 0)
 		{
-			save_undo();
-
-			cursor_pos.y--;
-			cursor_pos.x = text_lines[cursor_pos.y].length();
-
-			text_lines[cursor_pos.y] += text_lines[cursor_pos.y + 1];
-			text_lines.erase(text_lines.begin() + cursor_pos.y + 1);
-
-			textfield->set_needs_render();
+			edit(Vec2i(text_lines[cursor_pos.y - 1].length(), cursor_pos.y - 1), cursor_pos, std::string());
 		}
 	}
 
@@ -799,45 +836,22 @@ namespace clan
 	{
 		if (selection.start() != selection.end())
 		{
-			save_undo();
-
 			auto start = selection.start();
 			auto end = selection.end();
-
-			if (start.y == end.y)
-			{
-				text_lines[start.y].erase(text_lines[start.y].begin() + start.x, text_lines[start.y].begin() + end.x);
-			}
-			else
-			{
-				text_lines[start.y].erase(text_lines[start.y].begin() + start.x, text_lines[start.y].end());
-				text_lines[end.y].erase(text_lines[end.y].begin(), text_lines[end.y].begin() + end.x);
-				text_lines.erase(text_lines.begin() + start.y + 1, text_lines.begin() + end.y);
-			}
-
-			cursor_pos = start;
 			selection.reset();
 
-			textfield->set_needs_render();
+			edit(start, end, std::string());
 		}
 		else if (cursor_pos.x < text_lines[cursor_pos.y].length())
 		{
-			save_undo();
-
 			UTF8_Reader utf8_reader(text_lines[cursor_pos.y].data(), text_lines[cursor_pos.y].length());
 			utf8_reader.set_position(cursor_pos.x);
-			text_lines[cursor_pos.y].erase(text_lines[cursor_pos.y].begin() + cursor_pos.x, text_lines[cursor_pos.y].begin() + cursor_pos.x + utf8_reader.get_char_length());
 
-			textfield->set_needs_render();
+			edit(cursor_pos, Vec2i(cursor_pos.x + utf8_reader.get_char_length(), cursor_pos.y), std::string());
 		}
 		else if (cursor_pos.y + 1 < text_lines.size())
 		{
-			save_undo();
-
-			text_lines[cursor_pos.y] += text_lines[cursor_pos.y + 1];
-			text_lines.erase(text_lines.begin() + cursor_pos.y + 1);
-
-			textfield->set_needs_render();
+			edit(cursor_pos, Vec2i(0, cursor_pos.y + 1), std::string());
 		}
 	}
 
@@ -878,109 +892,148 @@ namespace clan
 
 	void TextViewImpl::undo()
 	{
-		/*
 		if (undo_buffer.empty())
 			return;
 
-		UndoInfo info;
-		info.text = text;
-		info.cursor_pos = cursor_pos;
-		info.selection_start = selection.start();
-		info.selection_length = selection.length();
-		redo_buffer.push_back(info);
-
-		text = undo_buffer.back().text;
-		cursor_pos = undo_buffer.back().cursor_pos;
-		selection.set(undo_buffer.back().selection_start, undo_buffer.back().selection_length);
-
+		UndoInfo info = std::move(undo_buffer.back());
 		undo_buffer.pop_back();
 
+		replace_text(info.start, text_end(info.start, info.inserted), info.removed);
+		cursor_pos = info.cursor_pos;
+		selection.reset();
+
+		redo_buffer.push_back(std::move(info));
+		needs_new_undo_step = true;
 		textfield->set_needs_render();
-		*/
 	}
 
 	void TextViewImpl::redo()
 	{
-		/*
 		if (redo_buffer.empty())
 			return;
 
-		UndoInfo info;
-		info.text = text;
-		info.cursor_pos = cursor_pos;
-		info.selection_start = selection.start();
-		info.selection_length = selection.length();
-		undo_buffer.push_back(info);
-
-		text = redo_buffer.back().text;
-		cursor_pos = redo_buffer.back().cursor_pos;
-		selection.set(redo_buffer.back().selection_start, redo_buffer.back().selection_length);
-
+		UndoInfo info = std::move(redo_buffer.back());
 		redo_buffer.pop_back();
 
+		cursor_pos = replace_text(info.start, text_end(info.start, info.removed), info.inserted);
+		selection.reset();
+
+		undo_buffer.push_back(std::move(info));
+		needs_new_undo_step = true;
 		textfield->set_needs_render();
-		*/
 	}
 
-	void TextViewImpl::save_undo()
+	void TextViewImpl::add(std::string new_text)
 	{
-		/*
-		redo_buffer.clear();
+		if (selection.start() != selection.end())
+		{
+			auto start = selection.start();
+			auto end = selection.end();
+			selection.reset();
 
-		if (undo_buffer.empty() || needs_new_undo_step)
+			edit(start, end, new_text);
+		}
+		else
 		{
-			UndoInfo info;
-			info.text = text;
-			info.cursor_pos = cursor_pos;
-			info.selection_start = selection.start();
-			info.selection_length = selection.length();
-			undo_buffer.push_back(info);
-			needs_new_undo_step = false;
+			edit(cursor_pos, cursor_pos, new_text);
 		}
-		*/
 	}
 
-	void TextViewImpl::add(std::string new_text)
+	void TextViewImpl::edit(Vec2i start, Vec2i end, const std::string &new_text)
 	{
-		if (selection.start() != selection.end())
-			del();
+		UndoInfo info;
+		info.start = start;
+		info.removed = get_text(start, end);
+		info.inserted = new_text;
+		info.cursor_pos = cursor_pos;
 
-		save_undo();
+		cursor_pos = replace_text(start, end, new_text);
+		redo_buffer.clear();
+		textfield->set_needs_render();
 
-		size_t start = 0;
-		while (true)
+		// Typing, backspacing or deleting in a row is undone as a single step
+		if (!needs_new_undo_step && !undo_buffer.empty())
 		{
-			size_t end = new_text.find('\n', start);
-			if (end == std::string::npos)
-				end = new_text.size();
+			UndoInfo &last = undo_buffer.back();
+			if (info.removed.empty() && !last.inserted.empty() && text_end(last.start, last.inserted) == start)
+			{
+				last.inserted += info.inserted;
+				return;
+			}
+			else if (info.inserted.empty() && last.inserted.empty() && end == last.start)
+			{
+				last.start = start;
+				last.removed = info.removed + last.removed;
+				return;
+			}
+			else if (info.inserted.empty() && last.inserted.empty() && start == last.start)
+			{
+				last.removed += info.removed;
+				return;
+			}
+		}
 
-			text_lines[cursor_pos.y] = text_lines[cursor_pos.y].substr(0, cursor_pos.x) + new_text.substr(start, end - start) + text_lines[cursor_pos.y].substr(cursor_pos.x);
-			cursor_pos.x += end - start;
+		undo_buffer.push_back(std::move(info));
+		needs_new_undo_step = false;
+	}
 
-			if (end == new_text.size())
-				break;
-			start = end + 1;
+	Vec2i TextViewImpl::replace_text(Vec2i start, Vec2i end, const std::string &new_text)
+	{
+		std::string tail = text_lines[end.y].substr(end.x);
+		text_lines[start.y].resize(start.x);
+		text_lines.erase(text_lines.begin() + start.y + 1, text_lines.begin() + end.y + 1);
+		line_metrics.erase(line_metrics.begin() + start.y + 1, line_metrics.begin() + end.y + 1);
 
-			text_lines.insert(text_lines.begin() + cursor_pos.y + 1, text_lines[cursor_pos.y].substr(cursor_pos.x));
-			text_lines[cursor_pos.y].resize(cursor_pos.x);
-			cursor_pos = Vec2i(0, cursor_pos.y + 1);
+		// Text up to the first newline joins the start line, the remaining lines are inserted after it
+		size_t line_end = new_text.find('\n');
+		text_lines[start.y].append(new_text, 0, line_end);
+
+		Vec2i pos = start;
+		if (line_end != std::string::npos)
+		{
+			std::vector<std::string> new_lines;
+			while (line_end != std::string::npos)
+			{
+				size_t line_start = line_end + 1;
+				line_end = new_text.find('\n', line_start);
+				new_lines.push_back(new_text.substr(line_start, line_end == std::string::npos ? std::string::npos : line_end - line_start));
+			}
+			text_lines.insert(text_lines.begin() + start.y + 1, new_lines.begin(), new_lines.end());
+			line_metrics.insert(line_metrics.begin() + start.y + 1, new_lines.size(), LineMetrics());
+			pos.y += new_lines.size();
 		}
 
-		textfield->set_needs_render();
+		pos.x = text_lines[pos.y].length();
+		text_lines[pos.y] += tail;
+
+		for (int y = start.y; y <= pos.y; y++)
+			line_metrics[y] = LineMetrics();
+
+		return pos;
+	}
+
+	Vec2i TextViewImpl::text_end(Vec2i start, const std::string &text)
+	{
+		size_t last_newline = text.rfind('\n');
+		if (last_newline == std::string::npos)
+			return Vec2i(start.x + text.length(), start.y);
+		return Vec2i(text.length() - last_newline - 1, start.y + std::count(text.begin(), text.end(), '\n'));
 	}
 
 	std::string TextViewImpl::get_all_selected_text() const
 	{
-		Vec2i start = selection.start();
-		Vec2i end = selection.end();
+		return get_text(selection.start(), selection.end());
+	}
 
+	std::string TextViewImpl::get_text(Vec2i start, Vec2i end) const
+	{
 		if (start.y == end.y)
 		{
 			return text_lines[start.y].substr(start.x, end.x - start.x);
 		}
 		else
 		{
-			size_t length = text_lines[start.y].length() - start.x + text_lines[end.y].length() - end.x + 1;
+			size_t length = text_lines[start.y].length() - start.x + end.x + 1;
 			for (auto y = start.y + 1; y < end.y; y++)
 				length += text_lines[y].length() + 1;
 
@@ -998,47 +1051,6 @@ namespace clan
 		}
 	}
 
-	std::string TextViewImpl::get_text_before_selection(size_t line_index) const
-	{
-		Vec2i start = selection.start();
-
-		if ((size_t)start.y == line_index)
-			return text_lines[line_index].substr(0, start.x);
-		else if ((size_t)start.y > line_index)
-			return text_lines[line_index];
-		else
-			return std::string();
-	}
-
-	std::string TextViewImpl::get_selected_text(size_t line_index) const
-	{
-		Vec2i start = selection.start();
-		Vec2i end = selection.end();
-
-		if (start.y == line_index && end.y == line_index)
-			return text_lines[line_index].substr(start.x, end.x - start.x);
-		else if ((size_t)start.y > line_index || (size_t)end.y < line_index)
-			return std::string();
-		else if (start.y == line_index)
-			return text_lines[line_index].substr(start.x);
-		else if (end.y == line_index)
-			return text_lines[line_index].substr(0, end.x);
-		else
-			return text_lines[line_index];
-	}
-
-	std::string TextViewImpl::get_text_after_selection(size_t line_index) const
-	{
-		Vec2i end = selection.end();
-
-		if ((size_t)end.y == line_index)
-			return text_lines[line_index].substr(end.x);
-		else if ((size_t)end.y < line_index)
-			return text_lines[line_index];
-		else
-			return std::string();
-	}
-
 	int TextViewImpl::find_next_break_character(int search_start, int line) const
 	{
 		if (search_start == text_lines[line].size())
@@ -1062,20 +1074,26 @@ namespace clan
 
 	Vec2i TextViewImpl::get_character_index(const Pointf &pos)
 	{
-		return Vec2i();
-		/*
-		if (last_measured_rects.empty())
-			return Vec2i();
-
-		for (unsigned int cnt = 0; cnt < last_measured_rects.size(); cnt++)
-		{
-			if ((last_measured_rects[cnt].left <= pos.x) && (last_measured_rects[cnt].right > pos.x))
-				return cnt + 1;
-		}
-		if (last_measured_rects[0].left >= pos.x)
-			return 0;
-		return last_measured_rects.size();
-		*/
+		Canvas canvas = textfield->canvas();
+		if (canvas.is_null())
+			return cursor_pos;
+
+		float line_height = get_font(canvas).get_font_metrics(canvas).get_line_height();
+		int line_index = (int)std::floor((pos.y + scroll_pos.y) / line_height);
+		line_index = std::max(std::min(line_index, (int)text_lines.size() - 1), 0);
+
+		// Closest glyph boundary to the position
+		const LineMetrics &metrics = measure_line(canvas, line_index);
+		float x = pos.x + scroll_pos.x;
+		size_t index = std::upper_bound(metrics.offsets.begin(), metrics.offsets.end(), x) - metrics.offsets.begin();
+		if (index == 0)
+			return Vec2i(0, line_index);
+		else if (index == metrics.offsets.size())
+			return Vec2i(metrics.positions.back(), line_index);
+		else if (x - metrics.offsets[index - 1] < metrics.offsets[index] - x)
+			return Vec2i(metrics.positions[index - 1], line_index);
+		else
+			return Vec2i(metrics.positions[index], line_index);
 	}
 
 	const std::string TextViewImpl::break_characters = " ::;,.-";
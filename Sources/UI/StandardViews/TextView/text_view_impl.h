@@ -110,7 +110,14 @@ namespace clan
 		void start_blink();
 		void stop_blink();
 
-		void save_undo();
+		/// Replaces the text between start and end and records the change in the undo buffer
+		void edit(Vec2i start, Vec2i end, const std::string &new_text);
+
+		/// Replaces the text between start and end, returning the end of the inserted text
+		Vec2i replace_text(Vec2i start, Vec2i end, const std::string &new_text);
+
+		/// Position after text inserted at start
+		static Vec2i text_end(Vec2i start, const std::string &text);
 
 		TextView *textfield = nullptr;
 
@@ -121,6 +128,20 @@ namespace clan
 
 		Size preferred_size = Size(20, 5);
 		std::vector<std::string> text_lines;
+
+		/// Glyph positions in a line and their x offsets, measured on first use
+		struct LineMetrics
+		{
+			std::vector<int> positions;
+			std::vector<float> offsets;
+		};
+
+		/// Metrics for each entry in text_lines. Edits reset the metrics of the lines they touch.
+		std::vector<LineMetrics> line_metrics;
+		float measured_pixel_ratio = 0.0f;
+
+		const LineMetrics &measure_line(Canvas &canvas, int line_index);
+		float get_line_offset(Canvas &canvas, int line_index, int pos);
 		std::string placeholder;
 
 		Signal<void(KeyEvent &)> sig_before_edit_changed;
@@ -131,7 +152,7 @@ namespace clan
 		bool cursor_drawing_enabled_when_parent_focused = false;
 
 		TextViewSelection selection;
-		Vec2f cursor_pos;
+		Vec2i cursor_pos;
 
 		Vec2f scroll_pos;
 
@@ -142,12 +163,13 @@ namespace clan
 		bool ignore_mouse_events = false;
 		bool mouse_selecting = false;
 
+		/// An edit, stored as the text it removed and inserted at a position
 		struct UndoInfo
 		{
-			std::string text;
-			size_t selection_start = 0;
-			size_t selection_length = 0;
-			size_t cursor_pos = 0;
+			Vec2i start;
+			std::string removed;
+			std::string inserted;
+			Vec2i cursor_pos;
 		};
 
 		std::vector<UndoInfo> undo_buffer;
@@ -156,13 +178,8 @@ namespace clan
 
 		static const std::string break_characters;
 
-		std::vector<Rectf> last_measured_rects;
-
 		std::string get_all_selected_text() const;
-
-		std::string get_text_before_selection(size_t line_index) const;
-		std::string get_selected_text(size_t line_index) const;
-		std::string get_text_after_selection(size_t line_index) const;
+		std::string get_text(Vec2i start, Vec2i end) const;
 
 		int find_next_break_character(int search_start, int line) const;
 		int find_previous_break_character(int search_start, int line) const;
@@ -190,10 +190,12 @@ namespace clan
 
 	void LabelView::reset_font()
 	{
+		static const StylePropertyId prop_color("color");
+
 		/// Reset the font.
 		Canvas dummycanvas; // Dummy to have a reference
 		impl->font = style_cascade().font(dummycanvas);	// Canvas actually is not needed in this case, use stub.
-		impl->font_color = style_cascade().computed_value("color").color();
+		impl->font_color = style_cascade().computed_value(prop_color).color();
 	}
 
 }
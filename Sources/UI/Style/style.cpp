@@ -66,50 +66,49 @@ namespace clan
 	{
 	}
 
-	Style::~Style()
+	Style::Style(const Style &that) : impl(new StyleImpl())
 	{
+		impl->block = that.impl->block;
+		impl->generation = ++StyleImpl::change_counter;
 	}
 
-	void Style::set(const std::string &properties)
+	Style::~Style()
 	{
-		StyleProperty::parse(impl.get(), properties);
 	}
 
-	StyleGetValue Style::declared_value(const char *property_name_str) const
+	Style &Style::operator=(const Style &that)
 	{
-		StyleString property_name = property_name_str;
-		const auto it = impl->prop_type.find(property_name);
-		if (it != impl->prop_type.end())
+		if (impl->block != that.impl->block)
 		{
-			switch (it->second)
-			{
-				default:
-				case StyleValueType::undefined:
-					return StyleGetValue();
-				case StyleValueType::keyword:
-					return StyleGetValue::from_keyword(impl->prop_text.find(property_name)->second.c_str());
-				case StyleValueType::string:
-					return StyleGetValue::from_string(impl->prop_text.find(property_name)->second.c_str());
-				case StyleValueType::url:
-					return StyleGetValue::from_url(impl->prop_text.find(property_name)->second.c_str());
-				case StyleValueType::length:
-					return StyleGetValue::from_length(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
-				case StyleValueType::angle:
-					return StyleGetValue::from_angle(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
-				case StyleValueType::time:
-					return StyleGetValue::from_time(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
-				case StyleValueType::frequency:
-					return StyleGetValue::from_frequency(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
-				case StyleValueType::resolution:
-					return StyleGetValue::from_resolution(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
-				case StyleValueType::percentage:
-					return StyleGetValue::from_percentage(impl->prop_number.find(property_name)->second);
-				case StyleValueType::number:
-					return StyleGetValue::from_number(impl->prop_number.find(property_name)->second);
-				case StyleValueType::color:
-					return StyleGetValue::from_color(impl->prop_color.find(property_name)->second);
-			}
+			impl->block = that.impl->block;
+			impl->generation = ++StyleImpl::change_counter;
 		}
-		return StyleGetValue();
+		return *this;
+	}
+
+	void Style::set(const std::string &properties)
+	{
+		impl->block = StyleImplCompiler::apply(impl->block, StyleImplCompiler::compile(properties));
+		impl->generation = ++StyleImpl::change_counter;
+	}
+
+	unsigned int Style::generation() const
+	{
+		return impl->generation;
+	}
+
+	bool Style::shares_properties(const Style &other) const
+	{
+		return impl->block == other.impl->block;
+	}
+
+	StyleGetValue Style::declared_value(const StylePropertyId &property_id) const
+	{
+		return impl->block->get_value(property_id);
+	}
+
+	StyleGetValue Style::declared_value(const char *property_name) const
+	{
+		return impl->block->get_value(StylePropertyId::find(property_name));
 	}
 }
@@ -48,11 +48,14 @@ namespace clan
 
 	void StyleBackgroundRenderer::render_background()
 	{
+		static const StylePropertyId prop_background_image("background-image");
+		static const StylePropertyId prop_background_color("background-color");
+
 		render_box_shadow();
 
-		int num_layers = style.array_size("background-image");
+		int num_layers = style.array_size(prop_background_image);
 
-		StyleGetValue bg_color = style.computed_value("background-color");
+		StyleGetValue bg_color = style.computed_value(prop_background_color);
 		if (bg_color.is_color() && bg_color.color().a != 0.0f)
 		{
 			auto border_points = get_border_points();
@@ -338,14 +341,18 @@ namespace clan
 
 	void StyleBackgroundRenderer::render_border()
 	{
-		int num_layers = style.array_size("background-image");
+		static const StylePropertyId prop_background_image("background-image");
+		static const StylePropertyId prop_border_top_style("border-top-style");
+		static const StylePropertyId prop_border_top_color("border-top-color");
+
+		int num_layers = style.array_size(prop_background_image);
 		if (!get_layer_clip(num_layers - 1).is_keyword("border-box"))
 			return;
 
-		StyleGetValue style_top = style.computed_value("border-top-style");
+		StyleGetValue style_top = style.computed_value(prop_border_top_style);
 		if (style_top.is_keyword("solid"))
 		{
-			Colorf color = style.computed_value("border-top-color").color();
+			Colorf color = style.computed_value(prop_border_top_color).color();
 			if (color.a > 0.0f)
 			{
 				auto border_points = get_border_points();
@@ -358,10 +365,13 @@ namespace clan
 
 	bool StyleBackgroundRenderer::is_render_border_antialias_fix_required()
 	{
-		StyleGetValue style_top = style.computed_value("border-top-style");
+		static const StylePropertyId prop_border_top_style("border-top-style");
+		static const StylePropertyId prop_border_top_color("border-top-color");
+
+		StyleGetValue style_top = style.computed_value(prop_border_top_style);
 		if (style_top.is_keyword("solid"))
 		{
-			Colorf color = style.computed_value("border-top-color").color();
+			Colorf color = style.computed_value(prop_border_top_color).color();
 			if (color.a > 0.5f)
 				return true;
 		}
@@ -549,68 +559,95 @@ namespace clan
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_clip(int index)
 	{
-		int count = style.array_size("background-clip");
+		static const StylePropertyId prop_background_clip("background-clip");
+
+		int count = style.array_size(prop_background_clip);
 		return style.computed_value("background-clip[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_origin(int index)
 	{
-		int count = style.array_size("background-origin");
+		static const StylePropertyId prop_background_origin("background-origin");
+
+		int count = style.array_size(prop_background_origin);
 		return style.computed_value("background-origin[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_size_x(int index)
 	{
-		int count = style.array_size("background-size-x");
+		static const StylePropertyId prop_background_size_x("background-size-x");
+
+		int count = style.array_size(prop_background_size_x);
 		return style.computed_value("background-size-x[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_size_y(int index)
 	{
-		int count = style.array_size("background-size-y");
+		static const StylePropertyId prop_background_size_y("background-size-y");
+
+		int count = style.array_size(prop_background_size_y);
 		return style.computed_value("background-size-y[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_position_x(int index)
 	{
-		int count = style.array_size("background-position-x");
+		static const StylePropertyId prop_background_position_x("background-position-x");
+
+		int count = style.array_size(prop_background_position_x);
 		return style.computed_value("background-position-x[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_position_y(int index)
 	{
-		int count = style.array_size("background-position-y");
+		static const StylePropertyId prop_background_position_y("background-position-y");
+
+		int count = style.array_size(prop_background_position_y);
 		return style.computed_value("background-position-y[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_attachment(int index)
 	{
-		int count = style.array_size("background-attachment");
+		static const StylePropertyId prop_background_attachment("background-attachment");
+
+		int count = style.array_size(prop_background_attachment);
 		return style.computed_value("background-attachment[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_repeat_x(int index)
 	{
-		int count = style.array_size("background-repeat-x");
+		static const StylePropertyId prop_background_repeat_x("background-repeat-x");
+
+		int count = style.array_size(prop_background_repeat_x);
 		return style.computed_value("background-repeat-x[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	StyleGetValue StyleBackgroundRenderer::get_layer_repeat_y(int index)
 	{
-		int count = style.array_size("background-repeat-y");
+		static const StylePropertyId prop_background_repeat_y("background-repeat-y");
+
+		int count = style.array_size(prop_background_repeat_y);
 		return style.computed_value("background-repeat-y[" + StringHelp::int_to_text(index % count) + "]");
 	}
 
 	std::array<Pointf, 2 * 4> StyleBackgroundRenderer::get_border_points()
 	{
-		float top_left_x = get_horizontal_radius(style.computed_value("border-top-left-radius-x"));
-		float top_left_y = get_vertical_radius(style.computed_value("border-top-left-radius-y"));
-		float top_right_x = get_horizontal_radius(style.computed_value("border-top-right-radius-x"));
-		float top_right_y = get_vertical_radius(style.computed_value("border-top-right-radius-y"));
-		float bottom_left_x = get_horizontal_radius(style.computed_value("border-bottom-left-radius-x"));
-		float bottom_left_y = get_vertical_radius(style.computed_value("border-bottom-left-radius-y"));
-		float bottom_right_x = get_horizontal_radius(style.computed_value("border-bottom-right-radius-x"));
-		float bottom_right_y = get_vertical_radius(style.computed_value("border-bottom-right-radius-y"));
+		static const StylePropertyId prop_border_top_left_radius_x("border-top-left-radius-x");
+		static const StylePropertyId prop_border_top_left_radius_y("border-top-left-radius-y");
+		static const StylePropertyId prop_border_top_right_radius_x("border-top-right-radius-x");
+		static const StylePropertyId prop_border_top_right_radius_y("border-top-right-radius-y");
+		static const StylePropertyId prop_border_bottom_left_radius_x("border-bottom-left-radius-x");
+		static const StylePropertyId prop_border_bottom_left_radius_y("border-bottom-left-radius-y");
+		static const StylePropertyId prop_border_bottom_right_radius_x("border-bottom-right-radius-x");
+		static const StylePropertyId prop_border_bottom_right_radius_y("border-bottom-right-radius-y");
+
+		float top_left_x = get_horizontal_radius(style.computed_value(prop_border_top_left_radius_x));
+		float top_left_y = get_vertical_radius(style.computed_value(prop_border_top_left_radius_y));
+		float top_right_x = get_horizontal_radius(style.computed_value(prop_border_top_right_radius_x));
+		float top_right_y = get_vertical_radius(style.computed_value(prop_border_top_right_radius_y));
+		float bottom_left_x = get_horizontal_radius(style.computed_value(prop_border_bottom_left_radius_x));
+		float bottom_left_y = get_vertical_radius(style.computed_value(prop_border_bottom_left_radius_y));
+		float bottom_right_x = get_horizontal_radius(style.computed_value(prop_border_bottom_right_radius_x));
+		float bottom_right_y = get_vertical_radius(style.computed_value(prop_border_bottom_right_radius_y));
 
 		Rectf border_box = geometry.border_box();
 
@@ -801,7 +838,17 @@ namespace clan
 
 	void StyleBackgroundRenderer::render_box_shadow()
 	{
-		int num_shadows = style.array_size("box-shadow-style");
+		static const StylePropertyId prop_box_shadow_style("box-shadow-style");
+		static const StylePropertyId prop_border_top_left_radius_x("border-top-left-radius-x");
+		static const StylePropertyId prop_border_top_left_radius_y("border-top-left-radius-y");
+		static const StylePropertyId prop_border_top_right_radius_x("border-top-right-radius-x");
+		static const StylePropertyId prop_border_top_right_radius_y("border-top-right-radius-y");
+		static const StylePropertyId prop_border_bottom_left_radius_x("border-bottom-left-radius-x");
+		static const StylePropertyId prop_border_bottom_left_radius_y("border-bottom-left-radius-y");
+		static const StylePropertyId prop_border_bottom_right_radius_x("border-bottom-right-radius-x");
+		static const StylePropertyId prop_border_bottom_right_radius_y("border-bottom-right-radius-y");
+
+		int num_shadows = style.array_size(prop_box_shadow_style);
 		if (num_shadows == 0)
 			return;
 
@@ -836,14 +883,14 @@ namespace clan
 
 			float kappa = 0.552228474f;
 
-			float top_left_x = get_horizontal_radius(style.computed_value("border-top-left-radius-x"));
-			float top_left_y = get_vertical_radius(style.computed_value("border-top-left-radius-y"));
-			float top_right_x = get_horizontal_radius(style.computed_value("border-top-right-radius-x"));
-			float top_right_y = get_vertical_radius(style.computed_value("border-top-right-radius-y"));
-			float bottom_left_x = get_horizontal_radius(style.computed_value("border-bottom-left-radius-x"));
-			float bottom_left_y = get_vertical_radius(style.computed_value("border-bottom-left-radius-y"));
-			float bottom_right_x = get_horizontal_radius(style.computed_value("border-bottom-right-radius-x"));
-			float bottom_right_y = get_vertical_radius(style.computed_value("border-bottom-right-radius-y"));
+			float top_left_x = get_horizontal_radius(style.computed_value(prop_border_top_left_radius_x));
+			float top_left_y = get_vertical_radius(style.computed_value(prop_border_top_left_radius_y));
+			float top_right_x = get_horizontal_radius(style.computed_value(prop_border_top_right_radius_x));
+			float top_right_y = get_vertical_radius(style.computed_value(prop_border_top_right_radius_y));
+			float bottom_left_x = get_horizontal_radius(style.computed_value(prop_border_bottom_left_radius_x));
+			float bottom_left_y = get_vertical_radius(style.computed_value(prop_border_bottom_left_radius_y));
+			float bottom_right_x = get_horizontal_radius(style.computed_value(prop_border_bottom_right_radius_x));
+			float bottom_right_y = get_vertical_radius(style.computed_value(prop_border_bottom_right_radius_y));
 
 			if (shadow_blur_radius != 0.0f)
 			{
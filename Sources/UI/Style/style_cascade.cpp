@@ -37,31 +37,203 @@
 #include "style_background_renderer.h"
 #include "style_border_image_renderer.h"
 #include "style_impl.h"
+#include <algorithm>
 
 namespace clan
 {
-	StyleGetValue StyleCascade::cascade_value(const char *property_name) const
+	class StyleCascadeCache
+	{
+	public:
+		/// Set when the cache has been checked against the current cascade
+		bool checked = false;
+
+		/// StyleImpl::change_counter at the last check
+		unsigned int checked_at = 0;
+
+		/// False if a parent cascade does not cache its values
+		bool usable = false;
+
+		/// Changes every time the cached values are discarded
+		unsigned int version = 0;
+
+		/// Styles and their generations when the cached values were computed
+		std::vector<std::pair<const Style *, unsigned int>> styles;
+
+		/// Parent cascade and its version when the cached values were computed
+		const StyleCascade *parent = nullptr;
+		unsigned int parent_version = 0;
+
+		/// Open addressed table of computed values keyed by property ID. Views only look up a small subset of all properties.
+		struct Entry
+		{
+			int id = 0;
+			StyleGetValue value;
+		};
+		std::vector<Entry> entries;
+		size_t num_entries = 0;
+
+		const StyleGetValue *find(int id) const
+		{
+			if (entries.empty())
+				return nullptr;
+
+			size_t mask = entries.size() - 1;
+			for (size_t index = id & mask; entries[index].id != 0; index = (index + 1) & mask)
+			{
+				if (entries[index].id == id)
+					return &entries[index].value;
+			}
+			return nullptr;
+		}
+
+		void insert(int id, const StyleGetValue &value)
+		{
+			if ((num_entries + 1) * 2 > entries.size())
+			{
+				std::vector<Entry> old_entries(std::max(entries.size() * 2, (size_t)64));
+				old_entries.swap(entries);
+				num_entries = 0;
+				for (const Entry &entry : old_entries)
+				{
+					if (entry.id != 0)
+						insert(entry.id, entry.value);
+				}
+			}
+
+			size_t mask = entries.size() - 1;
+			size_t index = id & mask;
+			while (entries[index].id != 0 && entries[index].id != id)
+				index = (index + 1) & mask;
+			if (entries[index].id == 0)
+				num_entries++;
+			entries[index].id = id;
+			entries[index].value = value;
+		}
+
+		void clear()
+		{
+			for (Entry &entry : entries)
+				entry.id = 0;
+			num_entries = 0;
+		}
+
+		static unsigned int next_version;
+	};
+
+	unsigned int StyleCascadeCache::next_version = 0;
+
+	StyleCascade::StyleCascade(const StyleCascade &that) : cascade(that.cascade), parent(that.parent)
+	{
+		if (that.cache)
+			cache = std::make_shared<StyleCascadeCache>();
+	}
+
+	StyleCascade &StyleCascade::operator=(const StyleCascade &that)
+	{
+		if (this != &that)
+		{
+			cascade = that.cascade;
+			parent = that.parent;
+			invalidate_cache();
+		}
+		return *this;
+	}
+
+	void StyleCascade::set_cache_enabled(bool enable)
+	{
+		if (enable && !cache)
+			cache = std::make_shared<StyleCascadeCache>();
+		else if (!enable)
+			cache.reset();
+		invalidate_cache();
+	}
+
+	void StyleCascade::invalidate_cache()
+	{
+		if (cache)
+		{
+			cache->checked = false;
+			cache->parent = nullptr;
+			cache->styles.clear();
+		}
+
+		// Makes cascades inheriting from this one check their parent version again
+		StyleImpl::change_counter++;
+	}
+
+	bool StyleCascade::validate_cache() const
+	{
+		if (!cache)
+			return false;
+
+		unsigned int counter = StyleImpl::change_counter;
+		if (cache->checked && cache->checked_at == counter)
+			return cache->usable;
+
+		bool usable = true;
+		unsigned int parent_version = 0;
+		if (parent)
+		{
+			usable = parent->validate_cache();
+			if (usable)
+				parent_version = parent->cache->version;
+		}
+
+		bool unchanged = cache->checked && cache->parent == parent && cache->parent_version == parent_version && cache->styles.size() == cascade.size();
+		for (size_t i = 0; unchanged && i < cascade.size(); i++)
+		{
+			unchanged = cache->styles[i].first == cascade[i] && cache->styles[i].second == cascade[i]->generation();
+		}
+
+		if (!unchanged)
+		{
+			cache->styles.clear();
+			for (Style *style : cascade)
+				cache->styles.push_back({ style, style->generation() });
+			cache->parent = parent;
+			cache->parent_version = parent_version;
+			cache->clear();
+			cache->version = ++StyleCascadeCache::next_version;
+		}
+
+		cache->checked = true;
+		cache->checked_at = counter;
+		cache->usable = usable;
+		return usable;
+	}
+
+	unsigned int StyleCascade::cache_version() const
+	{
+		return validate_cache() ? cache->version : 0;
+	}
+
+	StyleGetValue StyleCascade::cascade_value(const StylePropertyId &property_id) const
 	{
 		for (Style *style : cascade)
 		{
-			StyleGetValue value = style->declared_value(property_name);
+			StyleGetValue value = style->declared_value(property_id);
 			if (!value.is_undefined())
 				return value;
 		}
 		return StyleGetValue();
 	}
 
-	StyleGetValue StyleCascade::specified_value(const char *property_name) const
+	StyleGetValue StyleCascade::cascade_value(const char *property_name) const
+	{
+		return cascade_value(StylePropertyId::find(property_name));
+	}
+
+	StyleGetValue StyleCascade::specified_value(const StylePropertyId &property_id) const
 	{
-		StyleGetValue value = cascade_value(property_name);
-		bool inherit = (value.is_undefined() && StyleProperty::is_inherited(property_name)) || value.is_keyword("inherit");
+		StyleGetValue value = cascade_value(property_id);
+		bool inherit = (value.is_undefined() && StyleProperty::is_inherited(property_id)) || value.is_keyword("inherit");
 		if (inherit && parent)
 		{
-			return parent->computed_value(property_name);
+			return parent->computed_value(property_id);
 		}
 		else if (value.is_undefined() || value.is_keyword("initial") || value.is_keyword("inherit"))
 		{
-			return StyleProperty::default_value(property_name);
+			return StyleProperty::default_value(property_id);
 		}
 		else
 		{
@@ -69,14 +241,42 @@ namespace clan
 		}
 	}
 
-	StyleGetValue StyleCascade::computed_value(const char *property_name) const
+	StyleGetValue StyleCascade::specified_value(const char *property_name) const
+	{
+		return specified_value(StylePropertyId::find(property_name));
+	}
+
+	StyleGetValue StyleCascade::computed_value(const StylePropertyId &property_id) const
+	{
+		if (property_id.is_null() || !validate_cache())
+			return compute_value(property_id);
+
+		const StyleGetValue *cached_value = cache->find(property_id.value());
+		if (cached_value)
+			return *cached_value;
+
+		StyleGetValue value = compute_value(property_id);
+		cache->insert(property_id.value(), value);
+		return value;
+	}
+
+	StyleGetValue StyleCascade::compute_value(const StylePropertyId &property_id) const
 	{
 		// To do: pass on to property compute functions
 
-		StyleGetValue specified = specified_value(property_name);
+		static const StylePropertyId font_size("font-size");
+
+		StyleGetValue specified = specified_value(property_id);
 		switch (specified.type())
 		{
 		case StyleValueType::length:
+			// em and ex units in font-size refer to the font size of the parent
+			if (property_id == font_size && (specified.dimension() == StyleDimension::em || specified.dimension() == StyleDimension::ex))
+			{
+				float parent_font_size = parent ? parent->computed_value(font_size).number() : 16.0f;
+				float scale = specified.dimension() == StyleDimension::ex ? 0.5f : 1.0f;
+				return StyleGetValue::from_length(parent_font_size * specified.number() * scale);
+			}
 			return compute_length(specified);
 		case StyleValueType::angle:
 			return compute_angle(specified);
@@ -91,8 +291,14 @@ namespace clan
 		}
 	}
 
+	StyleGetValue StyleCascade::computed_value(const char *property_name) const
+	{
+		return computed_value(StylePropertyId::find(property_name));
+	}
+
 	StyleGetValue StyleCascade::compute_length(const StyleGetValue &length) const
 	{
+		static const StylePropertyId font_size("font-size");
 		switch (length.dimension())
 		{
 		default:
@@ -109,9 +315,9 @@ namespace clan
 		case StyleDimension::pc:
 			return StyleGetValue::from_length(length.number() * (float)(12.0 * 96.0 / 72.0));
 		case StyleDimension::em:
-			return StyleGetValue::from_length(computed_value("font-size").number() * length.number());
+			return StyleGetValue::from_length(computed_value(font_size).number() * length.number());
 		case StyleDimension::ex:
-			return StyleGetValue::from_length(computed_value("font-size").number() * length.number() * 0.5f);
+			return StyleGetValue::from_length(computed_value(font_size).number() * length.number() * 0.5f);
 		}
 	}
 
@@ -186,13 +392,20 @@ namespace clan
 
 	Font StyleCascade::font(Canvas &canvas) const
 	{
-		auto font_size = computed_value("font-size");
-		auto line_height = computed_value("line-height");
-		auto font_weight = computed_value("font-weight");
-		auto font_style = computed_value("font-style");
+		static const StylePropertyId font_size_id("font-size");
+		static const StylePropertyId line_height_id("line-height");
+		static const StylePropertyId font_weight_id("font-weight");
+		static const StylePropertyId font_style_id("font-style");
+		static const StylePropertyId font_rendering_id("-clan-font-rendering");
+		static const StylePropertyId font_family_name_id("font-family-names[0]");
+
+		auto font_size = computed_value(font_size_id);
+		auto line_height = computed_value(line_height_id);
+		auto font_weight = computed_value(font_weight_id);
+		auto font_style = computed_value(font_style_id);
 		//auto font_variant = computed_value("font-variant"); // To do: needs FontDescription support
-		auto font_rendering = computed_value("-clan-font-rendering");
-		auto font_family_name = computed_value("font-family-names[0]");
+		auto font_rendering = computed_value(font_rendering_id);
+		auto font_family_name = computed_value(font_family_name_id);
 
 		FontDescription font_desc;
 		font_desc.set_height(font_size.number());
@@ -231,6 +444,11 @@ namespace clan
 		return Font::resource(canvas, family, font_desc, UIThread::get_resources());
 	}
 
+	int StyleCascade::array_size(const StylePropertyId &property_id) const
+	{
+		return property_id.is_null() ? 0 : array_size(property_id.name());
+	}
+
 	int StyleCascade::array_size(const char *property_name) const
 	{
 		int size = 0;
@@ -241,7 +459,8 @@ namespace clan
 			prop_name.append("[");
 			prop_name.append(StringHelp::int_to_text(size));
 			prop_name.append("]");
-			if (specified_value(prop_name).is_undefined())
+			StylePropertyId prop_id = StylePropertyId::find(prop_name.c_str());
+			if (prop_id.is_null() || specified_value(prop_id).is_undefined())
 				break;
 			size++;
 		}
@@ -30,89 +30,310 @@
 #include "API/UI/Style/style.h"
 #include "API/Core/Text/string_help.h"
 #include "style_impl.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 namespace clan
 {
-	void StyleImpl::set_value(const std::string &name, const StyleSetValue &value)
+	std::atomic<unsigned int> StyleImpl::change_counter(0);
+
+	bool StyleImplValue::operator==(const StyleImplValue &that) const
+	{
+		// Values copied from the same declaration share their text
+		bool same_text = text == that.text || (text && that.text && *text == *that.text);
+		return type == that.type && dimension == that.dimension && same_text &&
+			number[0] == that.number[0] && number[1] == that.number[1] && number[2] == that.number[2] && number[3] == that.number[3];
+	}
+
+	StyleGetValue StyleImplBlock::get_value(const StylePropertyId &id) const
 	{
-		auto type_it = prop_type.find(name);
-		if (type_it != prop_type.end() && type_it->second != value.type)
+		auto it = std::lower_bound(ids.begin(), ids.end(), id.value());
+		if (it == ids.end() || *it != id.value())
+			return StyleGetValue();
+
+		const StyleImplValue &value = values[it - ids.begin()];
+		switch (value.type)
 		{
-			switch (type_it->second)
-			{
 			default:
 			case StyleValueType::undefined:
-				break;
+				return StyleGetValue();
 			case StyleValueType::keyword:
+				return StyleGetValue::from_keyword(value.text->c_str());
 			case StyleValueType::string:
+				return StyleGetValue::from_string(value.text->c_str());
 			case StyleValueType::url:
-				prop_text.erase(prop_text.find(name));
-				break;
+				return StyleGetValue::from_url(value.text->c_str());
 			case StyleValueType::length:
+				return StyleGetValue::from_length(value.number[0], value.dimension);
 			case StyleValueType::angle:
+				return StyleGetValue::from_angle(value.number[0], value.dimension);
 			case StyleValueType::time:
+				return StyleGetValue::from_time(value.number[0], value.dimension);
 			case StyleValueType::frequency:
+				return StyleGetValue::from_frequency(value.number[0], value.dimension);
 			case StyleValueType::resolution:
-				prop_dimension.erase(prop_dimension.find(name));
-				prop_number.erase(prop_number.find(name));
-				break;
+				return StyleGetValue::from_resolution(value.number[0], value.dimension);
 			case StyleValueType::percentage:
+				return StyleGetValue::from_percentage(value.number[0]);
 			case StyleValueType::number:
-				prop_number.erase(prop_number.find(name));
-				break;
+				return StyleGetValue::from_number(value.number[0]);
 			case StyleValueType::color:
-				prop_color.erase(prop_color.find(name));
-				break;
-			}
+				return StyleGetValue::from_color(Colorf(value.number[0], value.number[1], value.number[2], value.number[3]));
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void StyleImplDeclarations::set_value(const std::string &name, const StyleSetValue &value)
+	{
+		set_value(StylePropertyId(name), value);
+	}
+
+	void StyleImplDeclarations::set_value(const StylePropertyId &id, const StyleSetValue &value)
+	{
+		auto it = std::lower_bound(ids.begin(), ids.end(), id.value());
+		size_t index = it - ids.begin();
+		if (it == ids.end() || *it != id.value())
+		{
+			ids.insert(it, id.value());
+			values.insert(values.begin() + index, StyleImplValue());
 		}
 
-		if (value.type != StyleValueType::undefined)
-			prop_type[name] = value.type;
-		else if (type_it != prop_type.end())
-			prop_type.erase(type_it);
+		StyleImplValue slot;
+		slot.type = value.type;
 
 		switch (value.type)
 		{
-		default:
-		case StyleValueType::undefined:
-			break;
 		case StyleValueType::keyword:
 		case StyleValueType::string:
 		case StyleValueType::url:
-			prop_text[name] = value.text;
+			slot.text = std::make_shared<std::string>(value.text);
 			break;
 		case StyleValueType::length:
 		case StyleValueType::angle:
 		case StyleValueType::time:
 		case StyleValueType::frequency:
 		case StyleValueType::resolution:
-			prop_dimension[name] = value.dimension;
-			prop_number[name] = value.number;
+			slot.number[0] = value.number;
+			slot.dimension = value.dimension;
 			break;
 		case StyleValueType::percentage:
 		case StyleValueType::number:
-			prop_number[name] = value.number;
+			slot.number[0] = value.number;
 			break;
 		case StyleValueType::color:
-			prop_color[name] = value.color;
+			slot.number[0] = value.color.r;
+			slot.number[1] = value.color.g;
+			slot.number[2] = value.color.b;
+			slot.number[3] = value.color.a;
+			break;
+		default:
 			break;
 		}
+
+		values[index] = slot;
 	}
 
-	void StyleImpl::set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array)
+	void StyleImplDeclarations::set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array)
 	{
 		for (size_t i = 0; i < value_array.size(); i++)
 		{
 			set_value(name + "[" + StringHelp::int_to_text((int)i) + "]", value_array[i]);
 		}
 
-		size_t i = value_array.size();
-		while (true)
+		// Elements left over from a longer array declared earlier in the same string
+		for (size_t i = value_array.size(); ; i++)
 		{
-			auto index_name = name + "[" + StringHelp::int_to_text((int)i) + "]";
-			if (prop_type.find(index_name) == prop_type.end())
+			StylePropertyId index_id = StylePropertyId::find(name + "[" + StringHelp::int_to_text((int)i) + "]");
+			if (!std::binary_search(ids.begin(), ids.end(), index_id.value()))
 				break;
-			set_value(index_name, StyleSetValue());
+			set_value(index_id, StyleSetValue());
+		}
+
+		arrays.push_back({ name, value_array.size() });
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	/// Caches shared by all property sets
+	///
+	/// Compiled declarations and the results of applying them are kept with strong references, so the
+	/// addresses used as keys stay unique. Both caches are cleared when they grow too large, which only
+	/// happens when styles are generated from changing values. Blocks are found by their contents through
+	/// weak references, letting unused blocks be freed.
+	class StyleImplCache
+	{
+	public:
+		static StyleImplCache &instance()
+		{
+			static StyleImplCache cache;
+			return cache;
+		}
+
+		std::shared_ptr<const StyleImplBlock> intern_block(StyleImplBlock &block);
+
+		struct ApplyKey
+		{
+			const StyleImplBlock *block;
+			const StyleImplDeclarations *declarations;
+
+			bool operator==(const ApplyKey &that) const { return block == that.block && declarations == that.declarations; }
+		};
+
+		struct ApplyKeyHash
+		{
+			std::size_t operator()(const ApplyKey &key) const { return std::hash<const void *>()(key.block) * 31 + std::hash<const void *>()(key.declarations); }
+		};
+
+		struct ApplyEntry
+		{
+			std::shared_ptr<const StyleImplBlock> block;
+			std::shared_ptr<const StyleImplDeclarations> declarations;
+			std::shared_ptr<const StyleImplBlock> result;
+		};
+
+		enum { max_cache_size = 4096 };
+
+		std::mutex mutex;
+		std::unordered_map<std::string, std::shared_ptr<const StyleImplDeclarations>> compiled;
+		std::unordered_map<ApplyKey, ApplyEntry, ApplyKeyHash> applied;
+		std::unordered_multimap<std::size_t, std::weak_ptr<const StyleImplBlock>> blocks;
+		size_t blocks_prune_size = 1024;
+	};
+
+	std::shared_ptr<const StyleImplBlock> StyleImplCache::intern_block(StyleImplBlock &block)
+	{
+		if (block.ids.empty())
+			return StyleImplCompiler::empty_block();
+
+		std::size_t hash = block.ids.size();
+		for (size_t i = 0; i < block.ids.size(); i++)
+		{
+			const StyleImplValue &value = block.values[i];
+			std::size_t value_hash = std::hash<int>()(block.ids[i]) ^ (std::hash<int>()((int)value.type) << 1) ^ (value.text ? std::hash<std::string>()(*value.text) : 0);
+			for (float number : value.number)
+				value_hash = value_hash * 31 + std::hash<float>()(number);
+			hash = hash * 16777619U ^ value_hash;
+		}
+		block.hash = hash;
+
+		auto range = blocks.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			std::shared_ptr<const StyleImplBlock> existing = it->second.lock();
+			if (existing && existing->ids == block.ids && existing->values == block.values)
+				return existing;
+		}
+
+		if (blocks.size() >= blocks_prune_size)
+		{
+			for (auto it = blocks.begin(); it != blocks.end();)
+			{
+				if (it->second.expired())
+					it = blocks.erase(it);
+				else
+					++it;
+			}
+			blocks_prune_size = std::max(blocks.size() * 2, (size_t)1024);
+		}
+
+		auto result = std::make_shared<StyleImplBlock>(std::move(block));
+		blocks.insert({ hash, result });
+		return result;
+	}
+
+	std::shared_ptr<const StyleImplDeclarations> StyleImplCompiler::compile(const std::string &properties)
+	{
+		StyleImplCache &cache = StyleImplCache::instance();
+		{
+			std::unique_lock<std::mutex> lock(cache.mutex);
+			auto it = cache.compiled.find(properties);
+			if (it != cache.compiled.end())
+				return it->second;
+		}
+
+		auto declarations = std::make_shared<StyleImplDeclarations>();
+		StyleProperty::parse(declarations.get(), properties);
+
+		std::unique_lock<std::mutex> lock(cache.mutex);
+		if (cache.compiled.size() >= StyleImplCache::max_cache_size)
+			cache.compiled.clear();
+		return cache.compiled.insert({ properties, declarations }).first->second;
+	}
+
+	std::shared_ptr<const StyleImplBlock> StyleImplCompiler::apply(const std::shared_ptr<const StyleImplBlock> &block, const std::shared_ptr<const StyleImplDeclarations> &declarations)
+	{
+		StyleImplCache &cache = StyleImplCache::instance();
+		std::unique_lock<std::mutex> lock(cache.mutex);
+
+		StyleImplCache::ApplyKey key = { block.get(), declarations.get() };
+		auto it = cache.applied.find(key);
+		if (it != cache.applied.end())
+			return it->second.result;
+
+		// Array elements beyond the size of the declared arrays
+		std::vector<int> removed_ids;
+		for (const auto &array : declarations->arrays)
+		{
+			for (size_t i = array.second; ; i++)
+			{
+				StylePropertyId index_id = StylePropertyId::find(array.first + "[" + StringHelp::int_to_text((int)i) + "]");
+				if (!std::binary_search(block->ids.begin(), block->ids.end(), index_id.value()))
+					break;
+				removed_ids.push_back(index_id.value());
+			}
+		}
+		std::sort(removed_ids.begin(), removed_ids.end());
+
+		// Merge the two sorted property lists, with the declarations taking precedence
+		StyleImplBlock result;
+		result.ids.reserve(block->ids.size() + declarations->ids.size());
+		result.values.reserve(block->ids.size() + declarations->ids.size());
+
+		size_t block_index = 0, declaration_index = 0;
+		while (block_index < block->ids.size() || declaration_index < declarations->ids.size())
+		{
+			if (declaration_index == declarations->ids.size() || (block_index < block->ids.size() && block->ids[block_index] < declarations->ids[declaration_index]))
+			{
+				int id = block->ids[block_index];
+				if (!std::binary_search(removed_ids.begin(), removed_ids.end(), id))
+				{
+					result.ids.push_back(id);
+					result.values.push_back(block->values[block_index]);
+				}
+				block_index++;
+			}
+			else
+			{
+				if (block_index < block->ids.size() && block->ids[block_index] == declarations->ids[declaration_index])
+					block_index++;
+
+				const StyleImplValue &value = declarations->values[declaration_index];
+				if (value.type != StyleValueType::undefined)
+				{
+					result.ids.push_back(declarations->ids[declaration_index]);
+					result.values.push_back(value);
+				}
+				declaration_index++;
+			}
 		}
+
+		if (cache.applied.size() >= StyleImplCache::max_cache_size)
+			cache.applied.clear();
+
+		StyleImplCache::ApplyEntry entry;
+		entry.block = block;
+		entry.declarations = declarations;
+		entry.result = cache.intern_block(result);
+		cache.applied[key] = entry;
+		return entry.result;
+	}
+
+	const std::shared_ptr<const StyleImplBlock> &StyleImplCompiler::empty_block()
+	{
+		static const std::shared_ptr<const StyleImplBlock> block = std::make_shared<StyleImplBlock>();
+		return block;
 	}
 }
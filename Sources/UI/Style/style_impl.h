@@ -29,9 +29,11 @@
 #pragma once
 
 #include "API/UI/Style/style_property_parser.h"
+#include "API/UI/Style/style_property_id.h"
+#include <atomic>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace clan
 {
@@ -138,16 +140,84 @@ namespace clan
 		mutable std::size_t _hash = 0;
 	};
 
-	class StyleImpl : public StylePropertySetter
+	/// Tagged property value stored in a property block
+	class StyleImplValue
+	{
+	public:
+		StyleValueType type = StyleValueType::undefined;
+		StyleDimension dimension = StyleDimension::px;
+
+		/// Number in the first element, or the color components
+		float number[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		/// Text of keyword, string and url values, shared by the declarations and blocks holding the value
+		std::shared_ptr<const std::string> text;
+
+		bool operator==(const StyleImplValue &that) const;
+		bool operator!=(const StyleImplValue &that) const { return !(*this == that); }
+	};
+
+	/// Immutable set of declared property values
+	///
+	/// Blocks are hash-consed: every property set with the same declared values references the same block.
+	class StyleImplBlock
+	{
+	public:
+		StyleGetValue get_value(const StylePropertyId &id) const;
+
+		/// Property IDs in ascending order
+		std::vector<int> ids;
+
+		/// Values for the properties in ids
+		std::vector<StyleImplValue> values;
+
+		/// Hash of the IDs and values
+		std::size_t hash = 0;
+	};
+
+	/// Declarations parsed from a properties string
+	class StyleImplDeclarations : public StylePropertySetter
 	{
 	public:
 		void set_value(const std::string &name, const StyleSetValue &value) override;
 		void set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array) override;
 
-		std::unordered_map<StyleString, StyleValueType, StyleString::hash> prop_type;
-		std::unordered_map<StyleString, std::string, StyleString::hash> prop_text;
-		std::unordered_map<StyleString, float, StyleString::hash> prop_number;
-		std::unordered_map<StyleString, StyleDimension, StyleString::hash> prop_dimension;
-		std::unordered_map<StyleString, Colorf, StyleString::hash> prop_color;
+		void set_value(const StylePropertyId &id, const StyleSetValue &value);
+
+		/// Property IDs in ascending order
+		std::vector<int> ids;
+
+		/// Values for the properties in ids. Undefined values remove the property.
+		std::vector<StyleImplValue> values;
+
+		/// Value arrays set, with their sizes. Elements beyond the size are removed from the block the declarations are applied to.
+		std::vector<std::pair<std::string, size_t>> arrays;
+	};
+
+	/// Compiles properties strings once and applies them to shared property blocks
+	class StyleImplCompiler
+	{
+	public:
+		/// Parsed declarations for a properties string
+		static std::shared_ptr<const StyleImplDeclarations> compile(const std::string &properties);
+
+		/// Block with the declarations applied on top of another block
+		static std::shared_ptr<const StyleImplBlock> apply(const std::shared_ptr<const StyleImplBlock> &block, const std::shared_ptr<const StyleImplDeclarations> &declarations);
+
+		/// Block without any properties
+		static const std::shared_ptr<const StyleImplBlock> &empty_block();
+	};
+
+	class StyleImpl
+	{
+	public:
+		/// Declared values, shared with other property sets
+		std::shared_ptr<const StyleImplBlock> block = StyleImplCompiler::empty_block();
+
+		/// Value of change_counter when the properties were last set
+		unsigned int generation = 0;
+
+		/// Incremented every time a property set changes or a style cascade is invalidated
+		static std::atomic<unsigned int> change_counter;
 	};
 }
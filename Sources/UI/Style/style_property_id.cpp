@@ -0,0 +1,251 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "UI/precomp.h"
+#include "API/UI/Style/style_property_id.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace clan
+{
+	/// Global table of interned property names
+	///
+	/// Names are found with an open addressing hash table using the same hash as PropertyNameConst.
+	/// Lookups never lock: they read the currently published table, and tables are only replaced, never freed,
+	/// while the registry exists. Only interning a new name takes the mutex.
+	class StylePropertyRegistry
+	{
+	public:
+		static StylePropertyRegistry &instance()
+		{
+			static StylePropertyRegistry registry;
+			return registry;
+		}
+
+		static std::size_t hash(const char *name, std::size_t &out_length)
+		{
+			std::size_t value = 2166136261U;
+			std::size_t length = 0;
+			while (name[length] != 0)
+			{
+				value = (value ^ (std::size_t)name[length]) * 16777619U;
+				length++;
+			}
+			out_length = length;
+			return value;
+		}
+
+		int find(const char *name, std::size_t length, std::size_t hash) const
+		{
+			int id = 0;
+			find_slot(table.load(std::memory_order_acquire), name, length, hash, id);
+			return id;
+		}
+
+		int intern(const char *name, std::size_t length, std::size_t hash)
+		{
+			int id = find(name, length, hash);
+			if (id != 0)
+				return id;
+
+			std::unique_lock<std::mutex> lock(mutex);
+			Table *current = table.load(std::memory_order_relaxed);
+			std::size_t slot = find_slot(current, name, length, hash, id);
+			if (id != 0)
+				return id;
+
+			// The name is published before the ID can be found, so name() works for every ID handed out
+			names.push_back(std::string(name, length));
+			id = (int)names.size();
+			add_name(id, names.back().c_str());
+			num_names.store(id, std::memory_order_release);
+
+			// Keep the table at most half full
+			if (names.size() * 2 > current->size)
+			{
+				grow(id, hash);
+			}
+			else
+			{
+				current->slots[slot].hash = hash;
+				current->slots[slot].name = names.back().c_str();
+				current->slots[slot].length = length;
+				current->slots[slot].id.store(id, std::memory_order_release);
+			}
+			return id;
+		}
+
+		const char *name(int id) const
+		{
+			if (id <= 0 || id > num_names.load(std::memory_order_acquire))
+				return "";
+			return name_array.load(std::memory_order_acquire)->names[id - 1];
+		}
+
+		int count() const
+		{
+			return num_names.load(std::memory_order_acquire);
+		}
+
+	private:
+		struct Slot
+		{
+			std::atomic<int> id{ 0 };
+			std::size_t hash = 0;
+			const char *name = nullptr;
+			std::size_t length = 0;
+		};
+
+		struct Table
+		{
+			Table(std::size_t size) : slots(new Slot[size]), size(size) { }
+			std::unique_ptr<Slot[]> slots;
+			std::size_t size;
+		};
+
+		struct NameArray
+		{
+			NameArray(std::size_t capacity) : names(new const char *[capacity]), capacity(capacity) { }
+			std::unique_ptr<const char *[]> names;
+			std::size_t capacity;
+		};
+
+		StylePropertyRegistry()
+		{
+			tables.push_back(std::unique_ptr<Table>(new Table(512)));
+			table.store(tables.back().get());
+			name_arrays.push_back(std::unique_ptr<NameArray>(new NameArray(256)));
+			name_array.store(name_arrays.back().get());
+		}
+
+		/// Returns the slot holding the name, or the empty slot where it would go.
+		/// out_id is the ID this probe saw for the name, as the slot may be filled with another name right after it was seen empty.
+		static std::size_t find_slot(const Table *table, const char *name, std::size_t length, std::size_t hash, int &out_id)
+		{
+			std::size_t mask = table->size - 1;
+			std::size_t slot = hash & mask;
+			while (true)
+			{
+				const Slot &entry = table->slots[slot];
+				int id = entry.id.load(std::memory_order_acquire);
+				if (id == 0 || (entry.hash == hash && entry.length == length && memcmp(entry.name, name, length) == 0))
+				{
+					out_id = id;
+					return slot;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+
+		void add_name(int id, const char *name)
+		{
+			NameArray *current = name_array.load(std::memory_order_relaxed);
+			if ((std::size_t)id > current->capacity)
+			{
+				NameArray *next = new NameArray(current->capacity * 2);
+				std::copy(current->names.get(), current->names.get() + current->capacity, next->names.get());
+				name_arrays.push_back(std::unique_ptr<NameArray>(next));
+				current = next;
+			}
+			current->names[id - 1] = name;
+			name_array.store(current, std::memory_order_release);
+		}
+
+		// Builds a table twice the size holding all names up to and including the new one
+		void grow(int new_id, std::size_t new_hash)
+		{
+			const Table *current = table.load(std::memory_order_relaxed);
+			Table *next = new Table(current->size * 2);
+			std::size_t mask = next->size - 1;
+			auto insert = [&](int id, std::size_t hash, const char *name, std::size_t length)
+			{
+				std::size_t slot = hash & mask;
+				while (next->slots[slot].id.load(std::memory_order_relaxed) != 0)
+					slot = (slot + 1) & mask;
+				next->slots[slot].hash = hash;
+				next->slots[slot].name = name;
+				next->slots[slot].length = length;
+				next->slots[slot].id.store(id, std::memory_order_relaxed);
+			};
+
+			for (std::size_t i = 0; i < current->size; i++)
+			{
+				const Slot &entry = current->slots[i];
+				int id = entry.id.load(std::memory_order_relaxed);
+				if (id != 0)
+					insert(id, entry.hash, entry.name, entry.length);
+			}
+			insert(new_id, new_hash, names.back().c_str(), names.back().length());
+
+			// Readers may still be probing the old table, so it is kept
+			tables.push_back(std::unique_ptr<Table>(next));
+			table.store(next, std::memory_order_release);
+		}
+
+		std::mutex mutex;
+		std::atomic<Table *> table{ nullptr };
+		std::atomic<NameArray *> name_array{ nullptr };
+		std::atomic<int> num_names{ 0 };
+		std::vector<std::unique_ptr<Table>> tables;
+		std::vector<std::unique_ptr<NameArray>> name_arrays;
+		std::deque<std::string> names;
+	};
+
+	StylePropertyId StylePropertyId::intern(const char *name)
+	{
+		std::size_t length;
+		std::size_t hash = StylePropertyRegistry::hash(name, length);
+		return StylePropertyId(StylePropertyRegistry::instance().intern(name, length, hash));
+	}
+
+	StylePropertyId StylePropertyId::intern(const char *name, std::size_t length, std::size_t hash)
+	{
+		return StylePropertyId(StylePropertyRegistry::instance().intern(name, length, hash));
+	}
+
+	StylePropertyId StylePropertyId::find(const char *name)
+	{
+		std::size_t length;
+		std::size_t hash = StylePropertyRegistry::hash(name, length);
+		return StylePropertyId(StylePropertyRegistry::instance().find(name, length, hash));
+	}
+
+	int StylePropertyId::count()
+	{
+		return StylePropertyRegistry::instance().count();
+	}
+
+	const char *StylePropertyId::name() const
+	{
+		return StylePropertyRegistry::instance().name(id);
+	}
+}
@@ -37,9 +37,10 @@
 
 namespace clan
 {
-	std::unordered_map<StyleString, std::pair<StyleGetValue, bool>, StyleString::hash> &style_defaults()
+	/// Default value and inherit flag for each property, indexed by StylePropertyId
+	std::vector<std::pair<StyleGetValue, bool>> &style_defaults()
 	{
-		static std::unordered_map<StyleString, std::pair<StyleGetValue, bool>, StyleString::hash> defaults;
+		static std::vector<std::pair<StyleGetValue, bool>> defaults;
 		return defaults;
 	}
 
@@ -53,7 +54,11 @@ namespace clan
 
 	StylePropertyDefault::StylePropertyDefault(const std::string &name, const StyleGetValue &value, bool inherit)
 	{
-		style_defaults()[name] = { value, inherit };
+		StylePropertyId id(name);
+		auto &defaults = style_defaults();
+		if (id.value() >= (int)defaults.size())
+			defaults.resize(id.value() + 1, { StyleGetValue(), false });
+		defaults[id.value()] = { value, inherit };
 	}
 
 	/////////////////////////////////////////////////////////////////////////
@@ -1062,25 +1067,28 @@ namespace clan
 
 	/////////////////////////////////////////////////////////////////////////
 
+	bool StyleProperty::is_inherited(const StylePropertyId &id)
+	{
+		const auto &defaults = style_defaults();
+		return id.value() < (int)defaults.size() && defaults[id.value()].second;
+	}
+
 	bool StyleProperty::is_inherited(const char *name)
 	{
-		auto it = style_defaults().find(name);
-		if (it != style_defaults().end())
-		{
-			return it->second.second;
-		}
-		else
-		{
-			return false;
-		}
+		return is_inherited(StylePropertyId::find(name));
 	}
-	
-	const StyleGetValue &StyleProperty::default_value(const char *name)
+
+	bool StyleProperty::is_inherited(const std::string &name)
 	{
-		auto it = style_defaults().find(name);
-		if (it != style_defaults().end())
+		return is_inherited(StylePropertyId::find(name));
+	}
+
+	const StyleGetValue &StyleProperty::default_value(const StylePropertyId &id)
+	{
+		const auto &defaults = style_defaults();
+		if (id.value() < (int)defaults.size())
 		{
-			return it->second.first;
+			return defaults[id.value()].first;
 		}
 		else
 		{
@@ -1089,6 +1097,16 @@ namespace clan
 		}
 	}
 
+	const StyleGetValue &StyleProperty::default_value(const char *name)
+	{
+		return default_value(StylePropertyId::find(name));
+	}
+
+	const StyleGetValue &StyleProperty::default_value(const std::string &name)
+	{
+		return default_value(StylePropertyId::find(name));
+	}
+
 	void StyleProperty::parse(StylePropertySetter *setter, const std::string &properties)
 	{
 		StyleTokenizer tokenizer(properties);
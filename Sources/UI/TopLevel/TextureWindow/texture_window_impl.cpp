@@ -32,6 +32,7 @@
 #include "API/UI/Events/pointer_event.h"
 #include "API/UI/Events/close_event.h"
 #include "API/UI/Events/activation_change_event.h"
+#include "API/UI/UIThread/ui_thread.h"
 #include "API/Display/Render/blend_state_description.h"
 #include "API/Display/Window/input_event.h"
 #include "API/Display/2D/canvas.h"
@@ -71,6 +72,9 @@ namespace clan
 
 	void TextureWindow_Impl::update()
 	{
+		// Posted functions run every frame and may request rendering
+		UIThread::process_tasks();
+
 		if (needs_render || always_render)
 		{
 			ClipRectState cliprect_state(&canvas);
@@ -30,9 +30,18 @@
 #include "API/UI/TopLevel/view_tree.h"
 #include "API/UI/Events/event.h"
 #include "API/UI/Events/focus_change_event.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/2D/image.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/Render/blend_state_description.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/UI/UIThread/ui_thread.h"
 #include "../View/view_impl.h"
-#include "../View/positioned_layout.h"
+#include "../UIThread/ui_task_queue.h"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 
 namespace clan
 {
@@ -49,10 +58,88 @@ namespace clan
 			}
 		}
 
+		void render_retained(View *view, ViewImpl *view_impl, Canvas &canvas, const Rectf &margin_box);
+
 		View *focus_view = nullptr;
 		std::shared_ptr<View> root;
+
+		bool has_damage = false;
+		Rectf damage;
+
+		ViewTreeRenderStatistics statistics;
+
+		bool retained = false;
+		Rectf layer_box;
+		Texture2D layer_texture;
+		Image layer_image;
+		Canvas layer_canvas;
+		BlendState opaque_blend;
 	};
 
+	void ViewTreeImpl::render_retained(View *view, ViewImpl *view_impl, Canvas &canvas, const Rectf &margin_box)
+	{
+		float pixel_ratio = canvas.get_pixel_ratio();
+		Size size((int)std::ceil(margin_box.get_width() * pixel_ratio), (int)std::ceil(margin_box.get_height() * pixel_ratio));
+		if (size.width <= 0 || size.height <= 0)
+			return;
+
+		bool full_render = false;
+		if (layer_texture.is_null() || layer_texture.get_size() != size || layer_texture.get_pixel_ratio() != pixel_ratio || layer_box != margin_box)
+		{
+			layer_texture = Texture2D(canvas, size);
+			layer_texture.set_pixel_ratio(pixel_ratio);
+			FrameBuffer framebuffer(canvas);
+			framebuffer.attach_color(0, layer_texture);
+			layer_canvas = Canvas(canvas, framebuffer);
+			layer_image = Image(layer_texture, size);
+			layer_box = margin_box;
+			full_render = true;
+
+			BlendStateDescription blend_desc;
+			blend_desc.enable_blending(false);
+			opaque_blend = BlendState(canvas, blend_desc);
+		}
+
+		Rectf box = margin_box;
+		if (!full_render)
+		{
+			box = damage;
+			box.overlap(margin_box);
+		}
+
+		if (has_damage || full_render)
+		{
+			// Align the region to device pixels in the layer to avoid seams along its edges
+			Rectf layer_rect = Rectf(box).translate(-margin_box.left, -margin_box.top);
+			layer_rect.left = std::floor(layer_rect.left * pixel_ratio) / pixel_ratio;
+			layer_rect.top = std::floor(layer_rect.top * pixel_ratio) / pixel_ratio;
+			layer_rect.right = std::ceil(layer_rect.right * pixel_ratio) / pixel_ratio;
+			layer_rect.bottom = std::ceil(layer_rect.bottom * pixel_ratio) / pixel_ratio;
+
+			if (layer_rect.get_width() > 0.0f && layer_rect.get_height() > 0.0f)
+			{
+				layer_canvas.set_cliprect(layer_rect);
+
+				layer_canvas.set_blend_state(opaque_blend);
+				layer_canvas.fill_rect(layer_rect, StandardColorf::transparent());
+				layer_canvas.reset_blend_state();
+
+				// Views outside the cliprect are skipped by ViewImpl::render
+				layer_canvas.set_transform(Mat4f::translate(-margin_box.left, -margin_box.top, 0.0f));
+				view_impl->render(view, layer_canvas);
+				layer_canvas.set_transform(Mat4f::identity());
+
+				layer_canvas.reset_cliprect();
+				layer_canvas.flush();
+
+				statistics.full_render = full_render;
+				statistics.render_box = Rectf(layer_rect).translate(margin_box.left, margin_box.top);
+			}
+		}
+
+		layer_image.draw(canvas, margin_box);
+	}
+
 	ViewTree::ViewTree() : impl(new ViewTreeImpl)
 	{
 		set_root_view(std::make_shared<View>());
@@ -103,20 +190,93 @@ namespace clan
 		}
 	}
 
+	void ViewTree::layout(Canvas &canvas, const Rectf &margin_box)
+	{
+		View *view = impl->root.get();
+		view->set_geometry(ViewGeometry::from_margin_box(view->style_cascade(), margin_box));
+		ViewImpl::update_layout(view, canvas, true);
+	}
+
 	void ViewTree::render(Canvas &canvas, const Rectf &margin_box)
 	{
+		UIThread::process_tasks();
+
+		// Read after the tasks ran, as they may have replaced the root view
 		View *view = impl->root.get();
 
-		view->set_geometry(ViewGeometry::from_margin_box(view->style_cascade(), margin_box));
+		ViewTreeRenderStatistics statistics;
+		statistics.task_time = UITaskQueue::instance().take_task_time();
+
+		auto style_start = std::chrono::steady_clock::now();
+		ViewImpl::update_styles(view);
+		auto layout_start = std::chrono::steady_clock::now();
+		layout(canvas, margin_box);
+		auto render_start = std::chrono::steady_clock::now();
+
+		impl->statistics = statistics;
+		impl->statistics.views_visited = 1;
+
+		{
+			ViewRenderStatisticsScope statistics_scope(&impl->statistics);
+			if (impl->retained)
+			{
+				impl->render_retained(view, view->impl.get(), canvas, margin_box);
+			}
+			else
+			{
+				impl->statistics.full_render = true;
+				impl->statistics.render_box = margin_box;
+				view->impl->render(view, canvas);
+			}
+		}
+
+		impl->has_damage = false;
+		impl->damage = Rectf();
+
+		auto render_end = std::chrono::steady_clock::now();
+
+		impl->statistics.style_time = std::chrono::duration<double, std::milli>(layout_start - style_start).count();
+		impl->statistics.layout_time = std::chrono::duration<double, std::milli>(render_start - layout_start).count();
+		impl->statistics.render_time = std::chrono::duration<double, std::milli>(render_end - render_start).count();
+	}
+
+	void ViewTree::invalidate_rect(const Rectf &box)
+	{
+		if (box.get_width() <= 0.0f || box.get_height() <= 0.0f)
+			return;
 
-		if (view->needs_layout())
+		if (impl->has_damage)
+			impl->damage.bounding_rect(box);
+		else
+			impl->damage = box;
+		impl->has_damage = true;
+	}
+
+	Rectf ViewTree::dirty_box() const
+	{
+		return impl->damage;
+	}
+
+	void ViewTree::set_retained_rendering(bool enable)
+	{
+		if (impl->retained != enable)
 		{
-			view->layout_children(canvas);
-			PositionedLayout::layout_children(canvas, view);
+			impl->retained = enable;
+			impl->layer_texture = Texture2D();
+			impl->layer_image = Image();
+			impl->layer_canvas = Canvas();
+			set_needs_render();
 		}
-		view->impl->needs_layout = false;
+	}
 
-		view->impl->render(view, canvas);
+	bool ViewTree::retained_rendering() const
+	{
+		return impl->retained;
+	}
+
+	const ViewTreeRenderStatistics &ViewTree::render_statistics() const
+	{
+		return impl->statistics;
 	}
 
 	void ViewTree::dispatch_activation_change(ActivationChangeType type)
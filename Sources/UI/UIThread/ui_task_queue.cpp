@@ -0,0 +1,160 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UI/precomp.h"
+#include "ui_task_queue.h"
+#include <chrono>
+
+namespace clan
+{
+	UITaskQueue::UITaskQueue() : budget(4.0), wakeup_pending(false), posted(nullptr), pending_count(0)
+	{
+	}
+
+	UITaskQueue::~UITaskQueue()
+	{
+		UITask *task = posted.exchange(nullptr);
+		while (task)
+		{
+			UITask *next = task->next;
+			delete task;
+			task = next;
+		}
+	}
+
+	UITaskQueue &UITaskQueue::instance()
+	{
+		static UITaskQueue queue;
+		return queue;
+	}
+
+	bool UITaskQueue::push(std::unique_ptr<UITask> task)
+	{
+		pending_count++;
+
+		UITask *head = posted.load(std::memory_order_relaxed);
+		UITask *new_head = task.release();
+		do
+		{
+			new_head->next = head;
+		} while (!posted.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+
+		return head == nullptr;
+	}
+
+	void UITaskQueue::take_posted()
+	{
+		// The list is in reverse posting order
+		UITask *task = posted.exchange(nullptr, std::memory_order_acquire);
+		UITask *reversed = nullptr;
+		while (task)
+		{
+			UITask *next = task->next;
+			task->next = reversed;
+			reversed = task;
+			task = next;
+		}
+
+		while (reversed)
+		{
+			std::unique_ptr<UITask> current(reversed);
+			reversed = reversed->next;
+			current->next = nullptr;
+
+			if (!current->key.empty())
+			{
+				UITask *&keyed_task = keyed_tasks[current->key];
+				if (keyed_task)
+				{
+					// Only the latest task for a key runs
+					keyed_task->func = std::function<void()>();
+					pending_count--;
+				}
+				keyed_task = current.get();
+			}
+
+			if (current->priority == UITaskPriority::low)
+				low_tasks.push_back(std::move(current));
+			else
+				normal_tasks.push_back(std::move(current));
+		}
+	}
+
+	double UITaskQueue::process(const std::function<void(UITask &)> &run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto elapsed = [&]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+		// Tasks posted by the tasks run here wait for the next call
+		take_posted();
+
+		bool low_task_run = false;
+		while (!normal_tasks.empty() || !low_tasks.empty())
+		{
+			std::unique_ptr<UITask> task;
+			if (!normal_tasks.empty())
+			{
+				task = std::move(normal_tasks.front());
+				normal_tasks.pop_front();
+			}
+			else
+			{
+				// At least one low priority task runs per call, so they are never starved
+				if (low_task_run && elapsed() >= budget)
+					break;
+				task = std::move(low_tasks.front());
+				low_tasks.pop_front();
+				low_task_run = true;
+			}
+
+			if (!task->key.empty())
+			{
+				auto it = keyed_tasks.find(task->key);
+				if (it != keyed_tasks.end() && it->second == task.get())
+					keyed_tasks.erase(it);
+			}
+
+			if (task->func)
+			{
+				pending_count--;
+				run(*task);
+			}
+		}
+
+		double time = elapsed();
+		task_time += time;
+		return time;
+	}
+
+	double UITaskQueue::take_task_time()
+	{
+		double time = task_time;
+		task_time = 0.0;
+		return time;
+	}
+}
@@ -0,0 +1,96 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/UI/UIThread/ui_thread.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace clan
+{
+	/// Function posted to the UI thread
+	class UITask
+	{
+	public:
+		std::function<void()> func;
+		std::string key;
+		UITaskPriority priority = UITaskPriority::normal;
+
+		/// Next task in the list of posted tasks
+		UITask *next = nullptr;
+	};
+
+	/// Multiple producer, single consumer queue of tasks for the UI thread
+	///
+	/// Producers push tasks onto a lock-free list. The UI thread takes the whole list at once and moves the tasks
+	/// into its own queues, where a task with a key replaces the task with the same key that has not run yet.
+	class UITaskQueue
+	{
+	public:
+		UITaskQueue();
+		~UITaskQueue();
+
+		static UITaskQueue &instance();
+
+		/// Posts a task. Returns true if the list of posted tasks was empty. Thread-safe.
+		bool push(std::unique_ptr<UITask> task);
+
+		/// Runs the posted tasks within the budget, calling run for each of them
+		///
+		/// Returns the time spent in milliseconds. Only called from the UI thread.
+		double process(const std::function<void(UITask &)> &run);
+
+		/// Returns the time spent processing tasks since the last call, in milliseconds
+		double take_task_time();
+
+		/// Number of tasks that have not run yet
+		int pending() const { return pending_count; }
+
+		/// Time in milliseconds after which low priority tasks are deferred
+		std::atomic<double> budget;
+
+		/// True while a wake-up of the UI thread is scheduled
+		std::atomic<bool> wakeup_pending;
+
+	private:
+		void take_posted();
+
+		std::atomic<UITask *> posted;
+		std::atomic<int> pending_count;
+
+		std::deque<std::unique_ptr<UITask>> normal_tasks;
+		std::deque<std::unique_ptr<UITask>> low_tasks;
+		std::unordered_map<std::string, UITask *> keyed_tasks;
+		double task_time = 0.0;
+	};
+}
@@ -31,18 +31,21 @@
 #include "API/Display/2D/canvas.h"
 #include "API/Display/System/run_loop.h"
 #include "API/UI/UIThread/ui_thread.h"
+#include "ui_task_queue.h"
+#include <atomic>
 
 namespace clan
 {
-	static UIThreadImpl *ui_thread_instance = nullptr;
+	// Atomic as worker threads posting tasks check it while the UI thread creates or destroys the instance
+	static std::atomic<UIThreadImpl *> ui_thread_instance(nullptr);
 
 	class UIThreadImpl
 	{
 	public:
 		UIThreadImpl()
 		{
-			if (ui_thread_instance != nullptr) throw Exception("Only one UIThread is allowed");
-			ui_thread_instance = this;
+			UIThreadImpl *expected = nullptr;
+			if (!ui_thread_instance.compare_exchange_strong(expected, this)) throw Exception("Only one UIThread is allowed");
 		}
 
 		~UIThreadImpl()
@@ -53,10 +56,29 @@ namespace clan
 		ResourceManager resources;
 		std::function<void(const std::exception_ptr &)> exception_handler;
 
+		/// Runs the posted tasks during message processing
+		///
+		/// Deferred low priority tasks are scheduled again, which lets other messages be processed in between.
+		static void schedule_tasks()
+		{
+			UITaskQueue &queue = UITaskQueue::instance();
+			if (ui_thread_instance.load() && !queue.wakeup_pending.exchange(true))
+			{
+				RunLoop::main_thread_async([]()
+				{
+					UITaskQueue::instance().wakeup_pending = false;
+					UIThread::process_tasks();
+					if (UIThread::pending_tasks() > 0)
+						schedule_tasks();
+				});
+			}
+		}
+
 		static UIThreadImpl *get_instance()
 		{
-			if (ui_thread_instance == nullptr) throw Exception("No UIThread created");
-			return ui_thread_instance;
+			UIThreadImpl *instance = ui_thread_instance.load();
+			if (instance == nullptr) throw Exception("No UIThread created");
+			return instance;
 		}
 	};
 
@@ -101,4 +123,49 @@ namespace clan
 			return false;
 		}
 	}
+
+	void UIThread::post(std::function<void()> task, UITaskPriority priority)
+	{
+		post(std::string(), std::move(task), priority);
+	}
+
+	void UIThread::post(const std::string &key, std::function<void()> task, UITaskPriority priority)
+	{
+		if (!task)
+			return;
+
+		auto queued_task = clan::make_unique<UITask>();
+		queued_task->func = std::move(task);
+		queued_task->key = key;
+		queued_task->priority = priority;
+
+		if (UITaskQueue::instance().push(std::move(queued_task)))
+			UIThreadImpl::schedule_tasks();
+	}
+
+	double UIThread::process_tasks()
+	{
+		return UITaskQueue::instance().process([](UITask &task)
+		{
+			if (ui_thread_instance.load())
+				UIThread::try_catch(task.func);
+			else
+				task.func();
+		});
+	}
+
+	int UIThread::pending_tasks()
+	{
+		return UITaskQueue::instance().pending();
+	}
+
+	double UIThread::frame_budget()
+	{
+		return UITaskQueue::instance().budget;
+	}
+
+	void UIThread::set_frame_budget(double milliseconds)
+	{
+		UITaskQueue::instance().budget = milliseconds;
+	}
 }
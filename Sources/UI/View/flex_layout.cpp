@@ -29,11 +29,82 @@
 #include "UI/precomp.h"
 #include "API/Display/2D/canvas.h"
 #include "flex_layout.h"
+#include "view_impl.h"
 #include <algorithm>
 #include <cmath>
 
 namespace clan
 {
+	void FlexLayoutItemStyle::update(View *view)
+	{
+		static const StylePropertyId prop_min_width("min-width");
+		static const StylePropertyId prop_max_width("max-width");
+		static const StylePropertyId prop_min_height("min-height");
+		static const StylePropertyId prop_max_height("max-height");
+		static const StylePropertyId prop_margin_left("margin-left");
+		static const StylePropertyId prop_margin_top("margin-top");
+		static const StylePropertyId prop_margin_right("margin-right");
+		static const StylePropertyId prop_margin_bottom("margin-bottom");
+		static const StylePropertyId prop_border_left("border-left-width");
+		static const StylePropertyId prop_border_top("border-top-width");
+		static const StylePropertyId prop_border_right("border-right-width");
+		static const StylePropertyId prop_border_bottom("border-bottom-width");
+		static const StylePropertyId prop_padding_left("padding-left");
+		static const StylePropertyId prop_padding_top("padding-top");
+		static const StylePropertyId prop_padding_right("padding-right");
+		static const StylePropertyId prop_padding_bottom("padding-bottom");
+		static const StylePropertyId prop_flex_basis("flex-basis");
+		static const StylePropertyId prop_flex_grow("flex-grow");
+		static const StylePropertyId prop_flex_shrink("flex-shrink");
+
+		const StyleCascade &style = view->style_cascade();
+
+		definite_width = view->is_width_definite();
+		definite_height = view->is_height_definite();
+		width = definite_width ? view->definite_width() : 0.0f;
+		height = definite_height ? view->definite_height() : 0.0f;
+
+		StyleGetValue min_width_value = style.computed_value(prop_min_width);
+		StyleGetValue max_width_value = style.computed_value(prop_max_width);
+		StyleGetValue min_height_value = style.computed_value(prop_min_height);
+		StyleGetValue max_height_value = style.computed_value(prop_max_height);
+
+		definite_min_width = min_width_value.is_length();
+		definite_max_width = max_width_value.is_length();
+		definite_min_height = min_height_value.is_length();
+		definite_max_height = max_height_value.is_length();
+		min_width = definite_min_width ? min_width_value.number() : 0.0f;
+		max_width = definite_max_width ? max_width_value.number() : 0.0f;
+		min_height = definite_min_height ? min_height_value.number() : 0.0f;
+		max_height = definite_max_height ? max_height_value.number() : 0.0f;
+
+		auto_min_width = min_width_value.is_keyword("auto");
+		auto_min_height = min_height_value.is_keyword("auto");
+
+		StyleGetValue margin_left = style.computed_value(prop_margin_left);
+		StyleGetValue margin_top = style.computed_value(prop_margin_top);
+		StyleGetValue margin_right = style.computed_value(prop_margin_right);
+		StyleGetValue margin_bottom = style.computed_value(prop_margin_bottom);
+
+		noncontent_left = margin_left.number() + style.computed_value(prop_border_left).number() + style.computed_value(prop_padding_left).number();
+		noncontent_top = margin_top.number() + style.computed_value(prop_border_top).number() + style.computed_value(prop_padding_top).number();
+		noncontent_right = style.computed_value(prop_padding_right).number() + style.computed_value(prop_border_right).number() + margin_right.number();
+		noncontent_bottom = style.computed_value(prop_padding_bottom).number() + style.computed_value(prop_border_bottom).number() + margin_bottom.number();
+
+		auto_margin_left = margin_left.is_keyword("auto");
+		auto_margin_top = margin_top.is_keyword("auto");
+		auto_margin_right = margin_right.is_keyword("auto");
+		auto_margin_bottom = margin_bottom.is_keyword("auto");
+
+		StyleGetValue flex_basis_value = style.computed_value(prop_flex_basis);
+		flex_basis_length = flex_basis_value.is_length();
+		flex_basis_auto = flex_basis_value.is_keyword("auto");
+		flex_basis = flex_basis_length ? flex_basis_value.number() : 0.0f;
+
+		flex_grow = style.computed_value(prop_flex_grow).number();
+		flex_shrink = style.computed_value(prop_flex_shrink).number();
+	}
+
 	float FlexLayout::preferred_width(Canvas &canvas, View *view)
 	{
 		calculate_layout(canvas, view, FlexLayoutMode::preferred_width);
@@ -66,6 +137,15 @@ namespace clan
 		return 0.0f;
 	}
 
+	namespace
+	{
+		// Views can be laid out without a canvas when only measuring
+		Pointf flex_grid_fit(Canvas &canvas, const Pointf &pos)
+		{
+			return canvas.is_null() ? pos : canvas.grid_fit(pos);
+		}
+	}
+
 	void FlexLayout::layout_children(Canvas &canvas, View *view)
 	{
 		calculate_layout(canvas, view);
@@ -76,12 +156,12 @@ namespace clan
 			{
 				for (auto &item : line)
 				{
-					auto tl = canvas.grid_fit(Pointf(item.used_main_pos, item.used_cross_pos));
-					auto br = canvas.grid_fit(Pointf(item.used_main_pos + item.used_main_size, item.used_cross_pos + item.used_cross_size));
+					auto tl = flex_grid_fit(canvas, Pointf(item.used_main_pos, item.used_cross_pos));
+					auto br = flex_grid_fit(canvas, Pointf(item.used_main_pos + item.used_main_size, item.used_cross_pos + item.used_cross_size));
 					Rectf box = Rectf(tl.x, tl.y, br.x, br.y);
 
 					item.view->set_geometry(ViewGeometry::from_content_box(item.view->style_cascade(), box));
-					item.view->layout_children(canvas);
+					ViewImpl::update_layout(item.view, canvas, false);
 				}
 			}
 		}
@@ -91,12 +171,12 @@ namespace clan
 			{
 				for (auto &item : line)
 				{
-					auto tl = canvas.grid_fit(Pointf(item.used_cross_pos, item.used_main_pos));
-					auto br = canvas.grid_fit(Pointf(item.used_cross_pos + item.used_cross_size, item.used_main_pos + item.used_main_size));
+					auto tl = flex_grid_fit(canvas, Pointf(item.used_cross_pos, item.used_main_pos));
+					auto br = flex_grid_fit(canvas, Pointf(item.used_cross_pos + item.used_cross_size, item.used_main_pos + item.used_main_size));
 					Rectf box = Rectf(tl.x, tl.y, br.x, br.y);
 
 					item.view->set_geometry(ViewGeometry::from_content_box(item.view->style_cascade(), box));
-					item.view->layout_children(canvas);
+					ViewImpl::update_layout(item.view, canvas, false);
 				}
 			}
 		}
@@ -118,10 +198,13 @@ namespace clan
 
 	void FlexLayout::create_items(Canvas &canvas, View *view)
 	{
+		static const StylePropertyId prop_flex_direction("flex-direction");
+		static const StylePropertyId prop_flex_wrap("flex-wrap");
+
 		const auto &container_style = view->style_cascade();
 
-		auto computed_direction = container_style.computed_value("flex-direction");
-		auto computed_wrap = container_style.computed_value("flex-wrap");
+		auto computed_direction = container_style.computed_value(prop_flex_direction);
+		auto computed_wrap = container_style.computed_value(prop_flex_wrap);
 
 		direction = computed_direction.is_keyword("row") ? FlexDirection::row : FlexDirection::column;
 
@@ -172,36 +255,36 @@ namespace clan
 			if (!child->is_static_position_and_visible())
 				continue;
 
-			const auto &item_style = child->style_cascade();
+			const FlexLayoutItemStyle &item_style = ViewImpl::flex_item_style(child.get());
 
 			FlexLayoutItem item;
 			item.view = child.get();
 
 			// Definite sizes:
 
-			item.definite_main_size = child->is_width_definite();
-			item.definite_cross_size = child->is_height_definite();
-			item.definite_min_main_size = item_style.computed_value("min-width").is_length();
-			item.definite_max_main_size = item_style.computed_value("max-width").is_length();
-			item.definite_min_cross_size = item_style.computed_value("min-height").is_length();
-			item.definite_max_cross_size = item_style.computed_value("max-height").is_length();
+			item.definite_main_size = item_style.definite_width;
+			item.definite_cross_size = item_style.definite_height;
+			item.definite_min_main_size = item_style.definite_min_width;
+			item.definite_max_main_size = item_style.definite_max_width;
+			item.definite_min_cross_size = item_style.definite_min_height;
+			item.definite_max_cross_size = item_style.definite_max_height;
 
 			if (item.definite_main_size)
-				item.main_size = child->definite_width();
+				item.main_size = item_style.width;
 			if (item.definite_cross_size)
-				item.cross_size = child->definite_height();
+				item.cross_size = item_style.height;
 			if (item.definite_min_main_size)
-				item.min_main_size = item_style.computed_value("min-width").number();
+				item.min_main_size = item_style.min_width;
 			if (item.definite_max_main_size)
-				item.max_main_size = item_style.computed_value("max-width").number();
+				item.max_main_size = item_style.max_width;
 			if (item.definite_min_cross_size)
-				item.min_cross_size = item_style.computed_value("min-height").number();
+				item.min_cross_size = item_style.min_height;
 			if (item.definite_max_cross_size)
-				item.max_cross_size = item_style.computed_value("max-height").number();
+				item.max_cross_size = item_style.max_height;
 
 			// Main axis auto min:
 
-			if (item_style.computed_value("min-width").is_keyword("auto"))
+			if (item_style.auto_min_width)
 			{
 				float min_content_size = 0.0f; // item.view->min_content_width(); // shrink-to-fit in CSS 2.1
 				if (item.definite_main_size)
@@ -233,31 +316,23 @@ namespace clan
 
 			// Non-content sizes:
 
-			item.main_noncontent_start += child->style_cascade().computed_value("margin-left").number();
-			item.main_noncontent_start += child->style_cascade().computed_value("border-left-width").number();
-			item.main_noncontent_start += child->style_cascade().computed_value("padding-left").number();
-			item.main_noncontent_end += child->style_cascade().computed_value("padding-right").number();
-			item.main_noncontent_end += child->style_cascade().computed_value("border-right-width").number();
-			item.main_noncontent_end += child->style_cascade().computed_value("margin-right").number();
+			item.main_noncontent_start = item_style.noncontent_left;
+			item.main_noncontent_end = item_style.noncontent_right;
 
-			item.main_auto_margin_start = item_style.computed_value("margin-left").is_keyword("auto");
-			item.main_auto_margin_end = item_style.computed_value("margin-right").is_keyword("auto");
+			item.main_auto_margin_start = item_style.auto_margin_left;
+			item.main_auto_margin_end = item_style.auto_margin_right;
 
-			item.cross_noncontent_start += child->style_cascade().computed_value("margin-top").number();
-			item.cross_noncontent_start += child->style_cascade().computed_value("border-top-width").number();
-			item.cross_noncontent_start += child->style_cascade().computed_value("padding-top").number();
-			item.cross_noncontent_end += child->style_cascade().computed_value("padding-bottom").number();
-			item.cross_noncontent_end += child->style_cascade().computed_value("border-bottom-width").number();
-			item.cross_noncontent_end += child->style_cascade().computed_value("margin-bottom").number();
+			item.cross_noncontent_start = item_style.noncontent_top;
+			item.cross_noncontent_end = item_style.noncontent_bottom;
 
-			item.cross_auto_margin_start = item_style.computed_value("margin-top").is_keyword("auto");
-			item.cross_auto_margin_end = item_style.computed_value("margin-bottom").is_keyword("auto");
+			item.cross_auto_margin_start = item_style.auto_margin_top;
+			item.cross_auto_margin_end = item_style.auto_margin_bottom;
 
 			// Flex base size and hypothetical (preferred) main size:
 
-			if (item.view->style_cascade().computed_value("flex-basis").is_length())
-				item.flex_base_size = item.view->style_cascade().computed_value("flex-basis").number();
-			else if (item.definite_main_size && item.view->style_cascade().computed_value("flex-basis").is_keyword("auto"))
+			if (item_style.flex_basis_length)
+				item.flex_base_size = item_style.flex_basis;
+			else if (item.definite_main_size && item_style.flex_basis_auto)
 				item.flex_base_size = item.main_size;
 			else
 				item.flex_base_size = item.view->preferred_width(canvas);
@@ -270,8 +345,8 @@ namespace clan
 			if (item.definite_max_main_size)
 				item.flex_preferred_main_size = std::min(item.flex_preferred_main_size, item.max_main_size);
 
-			item.flex_grow = item.view->style_cascade().computed_value("flex-grow").number();
-			item.flex_shrink = item.view->style_cascade().computed_value("flex-shrink").number();
+			item.flex_grow = item_style.flex_grow;
+			item.flex_shrink = item_style.flex_shrink;
 
 			items.push_back(item);
 		}
@@ -311,36 +386,36 @@ namespace clan
 			if (!child->is_static_position_and_visible())
 				continue;
 
-			const auto &item_style = child->style_cascade();
+			const FlexLayoutItemStyle &item_style = ViewImpl::flex_item_style(child.get());
 
 			FlexLayoutItem item;
 			item.view = child.get();
 
 			// Definite sizes:
 
-			item.definite_main_size = child->is_height_definite();
-			item.definite_cross_size = child->is_width_definite();
-			item.definite_min_main_size = item_style.computed_value("min-height").is_length();
-			item.definite_max_main_size = item_style.computed_value("max-height").is_length();
-			item.definite_min_cross_size = item_style.computed_value("min-width").is_length();
-			item.definite_max_cross_size = item_style.computed_value("max-width").is_length();
+			item.definite_main_size = item_style.definite_height;
+			item.definite_cross_size = item_style.definite_width;
+			item.definite_min_main_size = item_style.definite_min_height;
+			item.definite_max_main_size = item_style.definite_max_height;
+			item.definite_min_cross_size = item_style.definite_min_width;
+			item.definite_max_cross_size = item_style.definite_max_width;
 
 			if (item.definite_main_size)
-				item.main_size = child->definite_height();
+				item.main_size = item_style.height;
 			if (item.definite_cross_size)
-				item.cross_size = child->definite_width();
+				item.cross_size = item_style.width;
 			if (item.definite_min_main_size)
-				item.min_main_size = item_style.computed_value("min-height").number();
+				item.min_main_size = item_style.min_height;
 			if (item.definite_max_main_size)
-				item.max_main_size = item_style.computed_value("max-height").number();
+				item.max_main_size = item_style.max_height;
 			if (item.definite_min_cross_size)
-				item.min_cross_size = item_style.computed_value("min-width").number();
+				item.min_cross_size = item_style.min_width;
 			if (item.definite_max_cross_size)
-				item.max_cross_size = item_style.computed_value("max-width").number();
+				item.max_cross_size = item_style.max_width;
 
 			// Main axis auto min:
 
-			if (item_style.computed_value("min-height").is_keyword("auto"))
+			if (item_style.auto_min_height)
 			{
 				float min_content_size = 0.0f; // item.view->preferred_height(canvas, item.view->min_content_width()); // shrink-to-fit in CSS 2.1
 				if (item.definite_main_size)
@@ -372,31 +447,23 @@ namespace clan
 
 			// Non-content sizes:
 
-			item.main_noncontent_start += child->style_cascade().computed_value("margin-top").number();
-			item.main_noncontent_start += child->style_cascade().computed_value("border-top-width").number();
-			item.main_noncontent_start += child->style_cascade().computed_value("padding-top").number();
-			item.main_noncontent_end += child->style_cascade().computed_value("padding-bottom").number();
-			item.main_noncontent_end += child->style_cascade().computed_value("border-bottom-width").number();
-			item.main_noncontent_end += child->style_cascade().computed_value("margin-bottom").number();
+			item.main_noncontent_start = item_style.noncontent_top;
+			item.main_noncontent_end = item_style.noncontent_bottom;
 
-			item.main_auto_margin_start = item_style.computed_value("margin-top").is_keyword("auto");
-			item.main_auto_margin_end = item_style.computed_value("margin-bottom").is_keyword("auto");
+			item.main_auto_margin_start = item_style.auto_margin_top;
+			item.main_auto_margin_end = item_style.auto_margin_bottom;
 
-			item.cross_noncontent_start += child->style_cascade().computed_value("margin-left").number();
-			item.cross_noncontent_start += child->style_cascade().computed_value("border-left-width").number();
-			item.cross_noncontent_start += child->style_cascade().computed_value("padding-left").number();
-			item.cross_noncontent_end += child->style_cascade().computed_value("padding-right").number();
-			item.cross_noncontent_end += child->style_cascade().computed_value("border-right-width").number();
-			item.cross_noncontent_end += child->style_cascade().computed_value("margin-right").number();
+			item.cross_noncontent_start = item_style.noncontent_left;
+			item.cross_noncontent_end = item_style.noncontent_right;
 
-			item.cross_auto_margin_start = item_style.computed_value("margin-left").is_keyword("auto");
-			item.cross_auto_margin_end = item_style.computed_value("margin-right").is_keyword("auto");
+			item.cross_auto_margin_start = item_style.auto_margin_left;
+			item.cross_auto_margin_end = item_style.auto_margin_right;
 
 			// Flex base size and hypothetical (preferred) main size:
 
-			if (item.view->style_cascade().computed_value("flex-basis").is_length())
+			if (item_style.flex_basis_length)
 			{
-				item.flex_base_size = item.view->style_cascade().computed_value("flex-basis").number();
+				item.flex_base_size = item_style.flex_basis;
 			}
 			else if (item.definite_main_size)
 			{
@@ -431,8 +498,8 @@ namespace clan
 			if (item.definite_max_main_size)
 				item.flex_preferred_main_size = std::min(item.flex_preferred_main_size, item.max_main_size);
 
-			item.flex_grow = item.view->style_cascade().computed_value("flex-grow").number();
-			item.flex_shrink = item.view->style_cascade().computed_value("flex-shrink").number();
+			item.flex_grow = item_style.flex_grow;
+			item.flex_shrink = item_style.flex_shrink;
 
 			items.push_back(item);
 		}
@@ -724,6 +791,11 @@ namespace clan
 
 	void FlexLayout::calculate_lines_cross_size(Canvas &canvas, View *view)
 	{
+		static const StylePropertyId prop_align_self("align-self");
+		static const StylePropertyId prop_align_items("align-items");
+		static const StylePropertyId prop_align_content("align-content");
+		static const StylePropertyId prop_visibility("visibility");
+
 		if (wrap == FlexWrap::nowrap && known_container_cross_size)
 		{
 			for (auto &line : lines)
@@ -764,10 +836,10 @@ namespace clan
 				{
 					auto &item_style = item.view->style_cascade();
 
-					auto align_self = item_style.computed_value("align-self");
+					auto align_self = item_style.computed_value(prop_align_self);
 					if (align_self.is_keyword("auto")) // To do: computed_value should have done this for us
 					{
-						align_self = view->style_cascade().computed_value("align-items");
+						align_self = view->style_cascade().computed_value(prop_align_items);
 					}
 
 					if (restarted_layout && item.collapsed)
@@ -796,7 +868,7 @@ namespace clan
 			}
 		}
 
-		if (view->style_cascade().computed_value("align-content").is_keyword("stretch") && known_container_cross_size && lines.size() > 0)
+		if (view->style_cascade().computed_value(prop_align_content).is_keyword("stretch") && known_container_cross_size && lines.size() > 0)
 		{
 			float total_cross_size = 0.0f;
 			for (auto &line : lines)
@@ -817,7 +889,7 @@ namespace clan
 		{
 			for (auto &item : line)
 			{
-				if (item.view->style_cascade().computed_value("visibility").is_keyword("collapse"))
+				if (item.view->style_cascade().computed_value(prop_visibility).is_keyword("collapse"))
 				{
 					item.collapsed = true;
 					item.strut_size = line.cross_size;
@@ -841,10 +913,10 @@ namespace clan
 			{
 				auto &item_style = item.view->style_cascade();
 
-				auto align_self = item_style.computed_value("align-self");
+				auto align_self = item_style.computed_value(prop_align_self);
 				if (align_self.is_keyword("auto")) // To do: computed_value should have done this for us
 				{
-					align_self = view->style_cascade().computed_value("align-items");
+					align_self = view->style_cascade().computed_value(prop_align_items);
 				}
 
 				if (align_self.is_keyword("stretch") && !item.definite_cross_size && !item.cross_auto_margin_start && !item.cross_auto_margin_end)
@@ -877,6 +949,8 @@ namespace clan
 
 	void FlexLayout::main_axis_alignment(Canvas &canvas, View *view)
 	{
+		static const StylePropertyId prop_justify_content("justify-content");
+
 		for (auto &line : lines)
 		{
 			int auto_margin_count = 0;
@@ -913,7 +987,7 @@ namespace clan
 				space_available = 0.0f;
 			}
 
-			auto justify_content = view->style_cascade().computed_value("justify-content");
+			auto justify_content = view->style_cascade().computed_value(prop_justify_content);
 			if (justify_content.is_keyword("flex-start") || ((item_count < 2 || space_available < 0.0f) && justify_content.is_keyword("space-between")))
 			{
 				float pos = 0.0f;
@@ -997,6 +1071,10 @@ namespace clan
 
 	void FlexLayout::cross_axis_alignment(Canvas &canvas, View *view)
 	{
+		static const StylePropertyId prop_align_self("align-self");
+		static const StylePropertyId prop_align_items("align-items");
+		static const StylePropertyId prop_align_content("align-content");
+
 		float total_cross_size = 0.0f;
 		for (auto &line : lines)
 		{
@@ -1036,10 +1114,10 @@ namespace clan
 				}
 				else
 				{
-					auto align_self = item.view->style_cascade().computed_value("align-self");
+					auto align_self = item.view->style_cascade().computed_value(prop_align_self);
 					if (align_self.is_keyword("auto")) // To do: computed_value should have done this for us
 					{
-						align_self = view->style_cascade().computed_value("align-items");
+						align_self = view->style_cascade().computed_value(prop_align_items);
 					}
 
 					if (align_self.is_keyword("flex-start") || (direction == FlexDirection::column && align_self.is_keyword("baseline")) || align_self.is_keyword("stretch"))
@@ -1069,10 +1147,10 @@ namespace clan
 					if (item.collapsed || item.cross_auto_margin_start || item.cross_auto_margin_end)
 						continue;
 
-					auto align_self = item.view->style_cascade().computed_value("align-self");
+					auto align_self = item.view->style_cascade().computed_value(prop_align_self);
 					if (align_self.is_keyword("auto")) // To do: computed_value should have done this for us
 					{
-						align_self = view->style_cascade().computed_value("align-items");
+						align_self = view->style_cascade().computed_value(prop_align_items);
 					}
 
 					if (align_self.is_keyword("baseline"))
@@ -1095,7 +1173,7 @@ namespace clan
 			float line_pos = 0.0f;
 			float line_extra = 0.0f;
 
-			auto align_content = view->style_cascade().computed_value("align-content");
+			auto align_content = view->style_cascade().computed_value(prop_align_content);
 			if (align_content.is_keyword("flex-start") || align_content.is_keyword("stretch") || (free_space < 0.0f && align_content.is_keyword("space-between")))
 			{
 			}
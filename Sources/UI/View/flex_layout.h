@@ -40,6 +40,48 @@ namespace clan
 		max_violation
 	};
 
+	/// Style derived inputs of a flex item, kept by each view until its style cascade changes
+	class FlexLayoutItemStyle
+	{
+	public:
+		void update(View *view);
+
+		bool definite_width = false;
+		bool definite_height = false;
+		float width = 0.0f;
+		float height = 0.0f;
+
+		bool definite_min_width = false;
+		bool definite_max_width = false;
+		bool definite_min_height = false;
+		bool definite_max_height = false;
+		float min_width = 0.0f;
+		float max_width = 0.0f;
+		float min_height = 0.0f;
+		float max_height = 0.0f;
+
+		bool auto_min_width = false;
+		bool auto_min_height = false;
+
+		/// Margin, border and padding for each edge
+		float noncontent_left = 0.0f;
+		float noncontent_top = 0.0f;
+		float noncontent_right = 0.0f;
+		float noncontent_bottom = 0.0f;
+
+		bool auto_margin_left = false;
+		bool auto_margin_top = false;
+		bool auto_margin_right = false;
+		bool auto_margin_bottom = false;
+
+		bool flex_basis_length = false;
+		bool flex_basis_auto = false;
+		float flex_basis = 0.0f;
+
+		float flex_grow = 0.0f;
+		float flex_shrink = 0.0f;
+	};
+
 	class FlexLayoutItem
 	{
 	public:
@@ -48,12 +48,14 @@
 #include "view_action_impl.h"
 #include "flex_layout.h"
 #include "custom_layout.h"
+#include "positioned_layout.h"
 #include <algorithm>
 
 namespace clan
 {
 	View::View() : impl(new ViewImpl())
 	{
+		impl->style_cascade.set_cache_enabled(true);
 		//box_style.set_style_changed(bind_member(this, &View::set_needs_layout));
 	}
 
@@ -103,6 +105,7 @@ namespace clan
 		{
 			impl->states[name] = ViewImpl::StyleState(false, value);
 			impl->update_style_cascade();
+			set_needs_render();
 		}
 	}
 	void View::set_state_cascade(const std::string &name, bool value)
@@ -112,6 +115,7 @@ namespace clan
 			impl->states[name] = ViewImpl::StyleState(false, value);
 			impl->update_style_cascade();
 			impl->set_state_cascade_children(name, value);
+			set_needs_render();
 		}
 	}
 
@@ -207,7 +211,9 @@ namespace clan
 
 	bool View::is_static_position_and_visible() const
 	{
-		return style_cascade().computed_value("position").is_keyword("static") && !hidden();
+		static const StylePropertyId prop_position("position");
+
+		return style_cascade().computed_value(prop_position).is_keyword("static") && !hidden();
 	}
 
 	bool View::needs_layout() const
@@ -217,14 +223,34 @@ namespace clan
 
 	void View::set_needs_layout()
 	{
-		impl->needs_layout = true;
-		impl->layout_cache.clear();
+		View *view = this;
+		while (true)
+		{
+			view->impl->needs_layout = true;
+			view->impl->layout_cache.clear();
 
-		View *super = parent();
-		if (super)
-			super->set_needs_layout();
-		else
-			set_needs_render();
+			View *super = view->parent();
+			if (!super)
+				break;
+
+			// Stop at views whose size does not depend on their content
+			if (view->impl->is_layout_boundary(view))
+			{
+				for (; super; super = super->parent())
+					super->impl->descendant_needs_layout = true;
+				break;
+			}
+
+			view = super;
+		}
+
+		// Only this view is damaged. Ancestors that change size as a result damage themselves in set_geometry.
+		ViewTree *tree = view_tree();
+		if (tree)
+		{
+			tree->invalidate_rect(impl->render_box(this));
+			tree->set_needs_render();
+		}
 	}
 
 	Canvas View::canvas() const
@@ -240,7 +266,10 @@ namespace clan
 	{
 		ViewTree *tree = view_tree();
 		if (tree)
+		{
+			tree->invalidate_rect(impl->render_box(this));
 			tree->set_needs_render();
+		}
 	}
 
 	const ViewGeometry &View::geometry() const
@@ -252,8 +281,22 @@ namespace clan
 	{
 		if (impl->_geometry.content_box() != geometry.content_box())
 		{
+			ViewTree *tree = view_tree();
+			if (tree)
+				tree->invalidate_rect(impl->render_box(this));
+
 			impl->_geometry = geometry;
-			set_needs_layout();
+
+			// The children need to be positioned again, but the measurements of this view and its ancestors are still valid
+			impl->needs_layout = true;
+			for (View *super = parent(); super; super = super->parent())
+				super->impl->descendant_needs_layout = true;
+
+			if (tree)
+			{
+				tree->invalidate_rect(impl->render_box(this));
+				tree->set_needs_render();
+			}
 		}
 	}
 
@@ -352,34 +395,34 @@ namespace clan
 
 	float View::preferred_height(Canvas &canvas, float width)
 	{
-		auto it = impl->layout_cache.preferred_height.find(width);
-		if (it != impl->layout_cache.preferred_height.end())
-			return it->second;
+		float height = 0.0f;
+		if (impl->layout_cache.preferred_height.find(width, height))
+			return height;
 
-		float height = calculate_preferred_height(canvas, width);
-		impl->layout_cache.preferred_height[width] = height;
+		height = calculate_preferred_height(canvas, width);
+		impl->layout_cache.preferred_height.insert(width, height);
 		return height;
 	}
 
 	float View::first_baseline_offset(Canvas &canvas, float width)
 	{
-		auto it = impl->layout_cache.first_baseline_offset.find(width);
-		if (it != impl->layout_cache.first_baseline_offset.end())
-			return it->second;
+		float baseline_offset = 0.0f;
+		if (impl->layout_cache.first_baseline_offset.find(width, baseline_offset))
+			return baseline_offset;
 
-		float baseline_offset = calculate_first_baseline_offset(canvas, width);
-		impl->layout_cache.first_baseline_offset[width] = baseline_offset;
+		baseline_offset = calculate_first_baseline_offset(canvas, width);
+		impl->layout_cache.first_baseline_offset.insert(width, baseline_offset);
 		return baseline_offset;
 	}
 
 	float View::last_baseline_offset(Canvas &canvas, float width)
 	{
-		auto it = impl->layout_cache.last_baseline_offset.find(width);
-		if (it != impl->layout_cache.last_baseline_offset.end())
-			return it->second;
+		float baseline_offset = 0.0f;
+		if (impl->layout_cache.last_baseline_offset.find(width, baseline_offset))
+			return baseline_offset;
 
-		float baseline_offset = calculate_last_baseline_offset(canvas, width);
-		impl->layout_cache.last_baseline_offset[width] = baseline_offset;
+		baseline_offset = calculate_last_baseline_offset(canvas, width);
+		impl->layout_cache.last_baseline_offset.insert(width, baseline_offset);
 		return baseline_offset;
 	}
 
@@ -410,7 +453,9 @@ namespace clan
 
 	float View::calculate_definite_width(bool &is_definite)
 	{
-		auto css_width = style_cascade().computed_value("width");
+		static const StylePropertyId prop_width("width");
+
+		auto css_width = style_cascade().computed_value(prop_width);
 		if (css_width.is_length())
 		{
 			is_definite = true;
@@ -430,7 +475,9 @@ namespace clan
 
 	float View::calculate_definite_height(bool &is_definite)
 	{
-		auto css_height = style_cascade().computed_value("height");
+		static const StylePropertyId prop_height("height");
+
+		auto css_height = style_cascade().computed_value(prop_height);
 		if (css_height.is_length())
 		{
 			is_definite = true;
@@ -881,7 +928,9 @@ namespace clan
 
 	ViewLayout *ViewImpl::active_layout(View *self)
 	{
-		if (self->style_cascade().computed_value("layout").is_keyword("flex"))
+		static const StylePropertyId prop_layout("layout");
+
+		if (self->style_cascade().computed_value(prop_layout).is_keyword("flex"))
 		{
 			return &flex;
 		}
@@ -892,8 +941,54 @@ namespace clan
 		}
 	}
 
+	cl_tls_variable ViewTreeRenderStatistics *ViewImpl::render_statistics = nullptr;
+
+	Rectf ViewImpl::render_box(View *self) const
+	{
+		static const StylePropertyId prop_box_shadow_style("box-shadow-style");
+		static const StylePropertyId prop_box_shadow_style_0("box-shadow-style[0]");
+
+		Rectf box = _geometry.border_box();
+
+		// Outer box shadows extend past the border box
+		if (!style_cascade.computed_value(prop_box_shadow_style_0).is_undefined())
+		{
+			int num_shadows = style_cascade.array_size(prop_box_shadow_style);
+			for (int index = 0; index < num_shadows; index++)
+			{
+				std::string suffix = "[" + StringHelp::int_to_text(index) + "]";
+				if (style_cascade.computed_value("box-shadow-style" + suffix).is_keyword("inset"))
+					continue;
+				float offset_x = style_cascade.computed_value("box-shadow-horizontal-offset" + suffix).number();
+				float offset_y = style_cascade.computed_value("box-shadow-vertical-offset" + suffix).number();
+				float blur_radius = style_cascade.computed_value("box-shadow-blur-radius" + suffix).number();
+				box.bounding_rect(Rectf(_geometry.border_box()).translate(offset_x, offset_y).expand(blur_radius));
+			}
+		}
+
+		View *super = self->parent();
+		if (!super)
+			return box;
+
+		// Note: this code isn't correct for rotated transforms (plus canvas cliprect can only clip AABB)
+		Pointf corners[4] =
+		{
+			super->to_root_pos(box.get_top_left(), true),
+			super->to_root_pos(Pointf(box.right, box.top), true),
+			super->to_root_pos(Pointf(box.left, box.bottom), true),
+			super->to_root_pos(box.get_bottom_right(), true)
+		};
+		Rectf result(corners[0], Sizef());
+		for (const Pointf &corner : corners)
+			result.bounding_rect(Rectf(corner, Sizef()));
+		return result;
+	}
+
 	void ViewImpl::render(View *self, Canvas &canvas)
 	{
+		if (render_statistics)
+			render_statistics->views_rendered++;
+
 		// Draw the background.
 		self->render_background(canvas);
 
@@ -946,6 +1041,9 @@ namespace clan
 		{
 			if (!view->hidden())
 			{
+				if (render_statistics)
+					render_statistics->views_visited++;
+
 				// Note: this code isn't correct for rotated transforms (plus canvas cliprect can only clip AABB)
 				Rectf border_box = view->geometry().border_box();
 				Vec4f tl_point = canvas.get_transform() * Vec4f(border_box.left, border_box.top, 0.0f, 1.0f);
@@ -959,6 +1057,68 @@ namespace clan
 		}
 	}
 
+	bool ViewImpl::is_layout_boundary(View *self) const
+	{
+		View *super = self->parent();
+		if (!super || super->impl->active_layout(super) != &super->impl->flex)
+			return false;
+
+		// The cached style is the one the parent used for the current layout
+		const FlexLayoutItemStyle &style = cached_flex_item_style;
+		if (cached_flex_item_style_version == 0 || cached_flex_item_style_version != style_cascade.cache_version())
+			return false;
+
+		return style.definite_width && style.definite_height && (style.flex_basis_length || style.flex_basis_auto) && self->is_static_position_and_visible();
+	}
+
+	const FlexLayoutItemStyle &ViewImpl::flex_item_style(View *view)
+	{
+		ViewImpl *impl = view->impl.get();
+		unsigned int version = impl->style_cascade.cache_version();
+		if (version == 0 || version != impl->cached_flex_item_style_version)
+		{
+			impl->cached_flex_item_style.update(view);
+			impl->cached_flex_item_style_version = version;
+		}
+		return impl->cached_flex_item_style;
+	}
+
+	void ViewImpl::update_styles(View *view, bool layout_subtree)
+	{
+		ViewImpl *impl = view->impl.get();
+		layout_subtree = layout_subtree || impl->needs_layout;
+		if (!layout_subtree && !impl->descendant_needs_layout)
+			return;
+
+		bool flex = impl->active_layout(view) == &impl->flex;
+		for (const std::shared_ptr<View> &child : impl->_children)
+		{
+			if (flex)
+				flex_item_style(child.get());
+			update_styles(child.get(), layout_subtree);
+		}
+	}
+
+	void ViewImpl::update_layout(View *view, Canvas &canvas, bool position_subtree)
+	{
+		ViewImpl *impl = view->impl.get();
+		// Flags are cleared first so that views requesting layout while being laid out are handled in the next pass
+		if (impl->needs_layout)
+		{
+			impl->needs_layout = false;
+			impl->descendant_needs_layout = false;
+			view->layout_children(canvas);
+			if (position_subtree)
+				PositionedLayout::layout_children(canvas, view);
+		}
+		else if (impl->descendant_needs_layout)
+		{
+			impl->descendant_needs_layout = false;
+			for (const std::shared_ptr<View> &child : impl->_children)
+				update_layout(child.get(), canvas, position_subtree);
+		}
+	}
+
 	void ViewImpl::update_style_cascade() const
 	{
 		std::vector<std::pair<Style *, size_t>> matches;
@@ -984,14 +1144,19 @@ namespace clan
 
 		std::stable_sort(matches.begin(), matches.end(), [](const std::pair<Style *, size_t> &a, const std::pair<Style *, size_t> &b) { return a.second != b.second ? a.second > b.second : a.first > b.first; });
 
-		if (_parent)
-			style_cascade.parent = &_parent->style_cascade();
-		else
-			style_cascade.parent = nullptr;
+		const StyleCascade *parent_cascade = _parent ? &_parent->style_cascade() : nullptr;
+
+		bool changed = style_cascade.parent != parent_cascade || style_cascade.cascade.size() != matches.size();
+		for (size_t i = 0; !changed && i < matches.size(); i++)
+			changed = style_cascade.cascade[i] != matches[i].first;
+		if (!changed)
+			return;
 
+		style_cascade.parent = parent_cascade;
 		style_cascade.cascade.clear();
 		for (auto &match : matches)
 			style_cascade.cascade.push_back(match.first);
+		style_cascade.invalidate_cache();
 	}
 
 	void ViewImpl::process_action(ViewAction *action, EventUI *e)
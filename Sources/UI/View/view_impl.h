@@ -29,26 +29,68 @@
 #include "API/UI/View/view.h"
 #include "API/UI/View/focus_policy.h"
 #include "API/UI/Style/style.h"
+#include "API/UI/TopLevel/view_tree.h"
 #include "API/Display/Window/display_window.h"
 #include "API/Display/Window/cursor.h"
 #include "API/Display/Window/cursor_description.h"
+#include "API/Core/System/thread_local_storage.h"
 #include "../Animation/animation_group.h"
 #include "view_layout.h"
 #include "flex_layout.h"
+#include <algorithm>
 #include <map>
 
 namespace clan
 {
 	class ViewLayout;
 
+	/// Measurements for the last few widths a view was measured with
+	class ViewLayoutMeasureCache
+	{
+	public:
+		bool find(float width, float &value) const
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (widths[i] == width)
+				{
+					value = values[i];
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void insert(float width, float value)
+		{
+			widths[next] = width;
+			values[next] = value;
+			next = (next + 1) % num_slots;
+			count = std::min(count + 1, (int)num_slots);
+		}
+
+		void clear()
+		{
+			count = 0;
+			next = 0;
+		}
+
+	private:
+		enum { num_slots = 4 };
+		float widths[num_slots] = { 0.0f };
+		float values[num_slots] = { 0.0f };
+		int count = 0;
+		int next = 0;
+	};
+
 	class ViewLayoutCache
 	{
 	public:
 		bool preferred_width_calculated = false;
 		float preferred_width = 0.0f;
-		std::map<float, float> preferred_height;
-		std::map<float, float> first_baseline_offset;
-		std::map<float, float> last_baseline_offset;
+		ViewLayoutMeasureCache preferred_height;
+		ViewLayoutMeasureCache first_baseline_offset;
+		ViewLayoutMeasureCache last_baseline_offset;
 
 		bool definite_width_calculated = false;
 		bool is_width_definite = false;
@@ -92,6 +134,25 @@ namespace clan
 
 		void set_state_cascade_children(const std::string &name, bool value);
 
+		/// Bounds of the border box plus box shadows, in canvas coordinates
+		Rectf render_box(View *self) const;
+
+		/// Test if layout changes inside this view can not affect the layout of its parent
+		///
+		/// This is the case for flex items with a definite size where the style inputs used for the item are unchanged.
+		bool is_layout_boundary(View *self) const;
+
+		/// Style inputs of a view as a flex item
+		static const FlexLayoutItemStyle &flex_item_style(View *view);
+
+		/// Computes the flex item styles of the views that update_layout is going to lay out
+		static void update_styles(View *view, bool layout_subtree = false);
+
+		/// Lays out the children of a view if it or any of its descendants need layout
+		///
+		/// If position_subtree is true, absolute and fixed positioned views in the subtrees laid out are positioned as well.
+		static void update_layout(View *view, Canvas &canvas, bool position_subtree);
+
 		void inverse_bubble(EventUI *e);
 
 		View *_parent = nullptr;
@@ -125,6 +186,7 @@ namespace clan
 		bool exception_encountered = false;
 
 		bool needs_layout = true;
+		bool descendant_needs_layout = false;
 
 		Signal<void(ActivationChangeEvent &)> _sig_activated[2];
 		Signal<void(ActivationChangeEvent &)> _sig_deactivated[2];
@@ -156,7 +218,27 @@ namespace clan
 
 		FlexLayout flex;
 
+		FlexLayoutItemStyle cached_flex_item_style;
+		unsigned int cached_flex_item_style_version = 0;
+
+		/// Statistics updated by render on this thread while ViewTree::render is active
+		static cl_tls_variable ViewTreeRenderStatistics *render_statistics;
+
 	private:
 		unsigned int find_prev_tab_index_helper(unsigned int tab_index) const;
 	};
+
+	/// Makes ViewImpl::render update a statistics object for the lifetime of the scope
+	class ViewRenderStatisticsScope
+	{
+	public:
+		ViewRenderStatisticsScope(ViewTreeRenderStatistics *statistics) : previous(ViewImpl::render_statistics) { ViewImpl::render_statistics = statistics; }
+		~ViewRenderStatisticsScope() { ViewImpl::render_statistics = previous; }
+
+	private:
+		ViewRenderStatisticsScope(const ViewRenderStatisticsScope &) = delete;
+		ViewRenderStatisticsScope &operator=(const ViewRenderStatisticsScope &) = delete;
+
+		ViewTreeRenderStatistics *previous;
+	};
 }
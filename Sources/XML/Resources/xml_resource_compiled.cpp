@@ -0,0 +1,736 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "XML/precomp.h"
+#include "xml_resource_compiled.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/Text/string_format.h"
+#include "API/XML/dom_attr.h"
+#include "API/XML/dom_cdata_section.h"
+#include "API/XML/dom_comment.h"
+#include "API/XML/dom_named_node_map.h"
+#include "API/XML/dom_node.h"
+#include "API/XML/dom_processing_instruction.h"
+#include "API/XML/dom_text.h"
+#include <algorithm>
+#include <cstring>
+
+namespace clan
+{
+	namespace
+	{
+		const char compiled_magic[8] = { 'C', 'L', 'R', 'E', 'S', 'B', 'I', 'N' };
+		const uint32_t compiled_byte_order = 0x01020304;
+		const uint32_t no_index = 0xffffffff;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// XMLResourceCompiled::Writer:
+
+	class XMLResourceCompiled::Writer
+	{
+	public:
+		uint32_t add_string(const std::string &str)
+		{
+			auto it = string_ids.find(str);
+			if (it != string_ids.end())
+				return it->second;
+
+			StringEntry entry;
+			entry.offset = string_data.size();
+			entry.length = str.length();
+			string_data.insert(string_data.end(), str.begin(), str.end());
+			string_data.push_back(0);
+
+			uint32_t id = strings.size();
+			strings.push_back(entry);
+			string_ids[str] = id;
+			return id;
+		}
+
+		uint32_t add_element(const DomElement &element, bool include_children)
+		{
+			uint32_t index = nodes.size();
+			nodes.push_back(node_element);
+			nodes.push_back(add_string(element.get_namespace_uri()));
+			nodes.push_back(add_string(element.get_node_name()));
+
+			DomNamedNodeMap attributes = element.get_attributes();
+			int num_attributes = attributes.get_length();
+			nodes.push_back(num_attributes);
+			size_t num_children_index = nodes.size();
+			nodes.push_back(0);
+
+			for (int i = 0; i < num_attributes; i++)
+			{
+				DomAttr attribute = attributes.item(i).to_attr();
+				nodes.push_back(add_string(attribute.get_namespace_uri()));
+				nodes.push_back(add_string(attribute.get_node_name()));
+				nodes.push_back(add_string(attribute.get_node_value()));
+			}
+
+			if (include_children)
+			{
+				uint32_t num_children = 0;
+				for (DomNode child = element.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+				{
+					if (add_node(child))
+						num_children++;
+				}
+				nodes[num_children_index] = num_children;
+			}
+
+			return index;
+		}
+
+		template<typename Type>
+		static uint32_t table_size(const std::vector<Type> &table)
+		{
+			return (table.size() * sizeof(Type) + 3) & ~3;
+		}
+
+		template<typename Type>
+		static void write_table(IODevice &file, const std::vector<Type> &table)
+		{
+			if (table.empty())
+				return;
+			file.write(table.data(), table.size() * sizeof(Type));
+			char padding[4] = { 0, 0, 0, 0 };
+			size_t padding_size = table_size(table) - table.size() * sizeof(Type);
+			if (padding_size > 0)
+				file.write(padding, padding_size);
+		}
+
+		std::vector<StringEntry> strings;
+		std::vector<char> string_data;
+		std::vector<uint32_t> nodes;
+
+	private:
+		bool add_node(const DomNode &node)
+		{
+			switch (node.get_node_type())
+			{
+			case DomNode::ELEMENT_NODE:
+				add_element(node.to_element(), true);
+				return true;
+			case DomNode::TEXT_NODE:
+				nodes.push_back(node_text);
+				nodes.push_back(add_string(node.get_node_value()));
+				return true;
+			case DomNode::CDATA_SECTION_NODE:
+				nodes.push_back(node_cdata);
+				nodes.push_back(add_string(node.get_node_value()));
+				return true;
+			case DomNode::COMMENT_NODE:
+				nodes.push_back(node_comment);
+				nodes.push_back(add_string(node.get_node_value()));
+				return true;
+			case DomNode::PROCESSING_INSTRUCTION_NODE:
+				nodes.push_back(node_processing_instruction);
+				nodes.push_back(add_string(node.get_node_name()));
+				nodes.push_back(add_string(node.get_node_value()));
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		std::map<std::string, uint32_t> string_ids;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////
+	// XMLResourceCompiled Attributes:
+
+	bool XMLResourceCompiled::is_compiled(IODevice &file)
+	{
+		char magic[sizeof(compiled_magic)];
+		size_t received = file.peek(magic, sizeof(magic));
+		return received == sizeof(magic) && memcmp(magic, compiled_magic, sizeof(magic)) == 0;
+	}
+
+	int XMLResourceCompiled::find_resource(const std::string &resource_id) const
+	{
+		const Header *h = header();
+		if (h->num_resources == 0)
+			return -1;
+
+		uint32_t displacement = table<uint32_t>(h->buckets_offset)[hash(resource_id, 0) % h->num_buckets];
+		uint32_t index = table<uint32_t>(h->slots_offset)[hash(resource_id, displacement) % h->num_resources];
+		if (index >= h->num_resources)
+			throw_corrupt();
+
+		if (!string_equals(table<ResourceEntry>(h->resources_offset)[index].id, resource_id))
+			return -1;
+		return index;
+	}
+
+	std::string XMLResourceCompiled::get_resource_id(int index) const
+	{
+		return get_string(table<ResourceEntry>(header()->resources_offset)[index].id);
+	}
+
+	std::vector<std::string> XMLResourceCompiled::get_section_names() const
+	{
+		const Header *h = header();
+		const uint32_t *section_names = table<uint32_t>(h->section_names_offset);
+
+		std::vector<std::string> names;
+		names.reserve(h->num_section_names);
+		for (uint32_t i = 0; i < h->num_section_names; i++)
+			names.push_back(get_string(section_names[i]));
+		return names;
+	}
+
+	std::vector<std::string> XMLResourceCompiled::get_resource_names() const
+	{
+		const Header *h = header();
+		const ResourceEntry *resources = table<ResourceEntry>(h->resources_offset);
+
+		std::vector<std::string> names;
+		names.reserve(h->num_resources);
+		for (uint32_t i = 0; i < h->num_resources; i++)
+			names.push_back(get_string(resources[i].id));
+		return names;
+	}
+
+	std::vector<std::string> XMLResourceCompiled::get_resource_names(const std::string &section) const
+	{
+		const Header *h = header();
+		const ResourceEntry *resources = table<ResourceEntry>(h->resources_offset);
+		const ListEntry *sections = table<ListEntry>(h->sections_offset);
+		const uint32_t *indices = table<uint32_t>(h->indices_offset);
+
+		std::vector<std::string> names;
+		for (uint32_t i = 0; i < h->num_sections; i++)
+		{
+			if (!string_equals(sections[i].base_name, section))
+				continue;
+			if ((uint64_t)sections[i].first_index + sections[i].num_indices > h->num_indices)
+				throw_corrupt();
+
+			for (uint32_t j = 0; j < sections[i].num_indices; j++)
+			{
+				uint32_t index = indices[sections[i].first_index + j];
+				if (index >= h->num_resources)
+					throw_corrupt();
+				names.push_back(get_string(resources[index].name));
+			}
+		}
+		return names;
+	}
+
+	std::vector<std::string> XMLResourceCompiled::get_resource_names_of_type(const std::string &type) const
+	{
+		std::vector<std::string> names;
+		add_names(names, find_list(header()->types_offset, header()->num_types, type), no_index);
+		return names;
+	}
+
+	std::vector<std::string> XMLResourceCompiled::get_resource_names_of_type(const std::string &type, const std::string &section) const
+	{
+		const Header *h = header();
+		std::vector<std::string> names;
+		const ListEntry *section_list = find_list(h->sections_offset, h->num_sections, PathHelp::add_trailing_slash(section, PathHelp::path_type_virtual));
+		if (section_list)
+			add_names(names, find_list(h->types_offset, h->num_types, type), section_list - table<ListEntry>(h->sections_offset));
+		return names;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// XMLResourceCompiled Operations:
+
+	void XMLResourceCompiled::save(IODevice &file, DomDocument &document, const std::string &ns_resources)
+	{
+		struct ResourceInfo
+		{
+			uint32_t section_element;
+			uint32_t node;
+			std::string type;
+		};
+
+		Writer writer;
+		std::vector<SectionElementEntry> section_elements;
+		std::map<std::string, ResourceInfo> resource_infos;
+
+		DomElement doc_element = document.get_document_element();
+
+		Header h;
+		memset(&h, 0, sizeof(Header));
+		memcpy(h.magic, compiled_magic, sizeof(compiled_magic));
+		h.version = version;
+		h.byte_order = compiled_byte_order;
+		h.ns_resources = writer.add_string(ns_resources);
+		h.document_element = writer.add_element(doc_element, false);
+
+		// Walk the sections the same way XMLResourceDocument::load does:
+		std::vector<std::string> section_stack;
+		std::vector<uint32_t> section_element_stack;
+		std::vector<DomNode> nodes_stack;
+		section_stack.push_back(std::string());
+		section_element_stack.push_back(no_index);
+		nodes_stack.push_back(doc_element.get_first_child());
+		while (!nodes_stack.empty())
+		{
+			if (nodes_stack.back().is_element())
+			{
+				DomElement element = nodes_stack.back().to_element();
+				if (element.get_namespace_uri() == ns_resources && element.get_local_name() == "section")
+				{
+					SectionElementEntry entry;
+					entry.parent = section_element_stack.back();
+					entry.node = writer.add_element(element, false);
+
+					std::string section_name = element.get_attribute_ns(ns_resources, "name");
+					section_stack.push_back(section_stack.back() + PathHelp::add_trailing_slash(section_name, PathHelp::path_type_virtual));
+					section_element_stack.push_back(section_elements.size());
+					section_elements.push_back(entry);
+					nodes_stack.push_back(element.get_first_child());
+					continue;
+				}
+				else if (element.has_attribute_ns(ns_resources, "name"))
+				{
+					std::string resource_name = element.get_attribute_ns(ns_resources, "name");
+					ResourceInfo &info = resource_infos[section_stack.back() + resource_name];
+					info.section_element = section_element_stack.back();
+					info.node = writer.add_element(element, true);
+					info.type = element.get_local_name();
+				}
+			}
+
+			nodes_stack.back() = nodes_stack.back().get_next_sibling();
+
+			while (nodes_stack.back().is_null())
+			{
+				nodes_stack.pop_back();
+				section_stack.pop_back();
+				section_element_stack.pop_back();
+				if (nodes_stack.empty())
+					break;
+				nodes_stack.back() = nodes_stack.back().get_next_sibling();
+			}
+		}
+
+		// Resource records in resource id order, and the lists referring to them:
+		std::map<std::string, std::vector<uint32_t>> section_lists;
+		std::map<std::string, std::vector<uint32_t>> type_lists;
+		std::vector<ResourceEntry> resources;
+		std::vector<std::string> resource_ids;
+		std::vector<uint32_t> section_names;
+		std::string last_section;
+		for (auto &it : resource_infos)
+		{
+			uint32_t index = resources.size();
+			std::string section = PathHelp::get_fullpath(it.first, PathHelp::path_type_virtual);
+
+			ResourceEntry entry;
+			entry.id = writer.add_string(it.first);
+			entry.name = writer.add_string(PathHelp::get_filename(it.first, PathHelp::path_type_virtual));
+			entry.section_element = it.second.section_element;
+			entry.section = 0;
+			entry.node = it.second.node;
+			resources.push_back(entry);
+			resource_ids.push_back(it.first);
+
+			section_lists[section].push_back(index);
+			type_lists[it.second.type].push_back(index);
+
+			if (section != last_section)
+			{
+				section_names.push_back(writer.add_string(section));
+				last_section = section;
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		std::vector<ListEntry> sections;
+		for (auto &it : section_lists)
+		{
+			ListEntry entry;
+			entry.name = writer.add_string(it.first);
+			entry.base_name = writer.add_string(PathHelp::get_basepath(resource_ids[it.second.front()], PathHelp::path_type_virtual));
+			entry.first_index = indices.size();
+			entry.num_indices = it.second.size();
+			for (uint32_t index : it.second)
+				resources[index].section = sections.size();
+			indices.insert(indices.end(), it.second.begin(), it.second.end());
+			sections.push_back(entry);
+		}
+
+		std::vector<ListEntry> types;
+		for (auto &it : type_lists)
+		{
+			ListEntry entry;
+			entry.name = writer.add_string(it.first);
+			entry.base_name = entry.name;
+			entry.first_index = indices.size();
+			entry.num_indices = it.second.size();
+			indices.insert(indices.end(), it.second.begin(), it.second.end());
+			types.push_back(entry);
+		}
+
+		// Perfect hash index (hash and displace): each bucket of ids gets a hash seed that places its ids in free slots
+		uint32_t num_resources = resources.size();
+		uint32_t num_buckets = (num_resources + 3) / 4;
+		std::vector<uint32_t> buckets(num_buckets, 0);
+		std::vector<uint32_t> slots(num_resources, no_index);
+		if (num_resources > 0)
+		{
+			std::vector<std::vector<uint32_t>> bucket_resources(num_buckets);
+			for (uint32_t i = 0; i < num_resources; i++)
+				bucket_resources[hash(resource_ids[i], 0) % num_buckets].push_back(i);
+
+			std::vector<uint32_t> bucket_order(num_buckets);
+			for (uint32_t i = 0; i < num_buckets; i++)
+				bucket_order[i] = i;
+			std::stable_sort(bucket_order.begin(), bucket_order.end(), [&](uint32_t a, uint32_t b) { return bucket_resources[a].size() > bucket_resources[b].size(); });
+
+			std::vector<uint32_t> bucket_slots;
+			for (uint32_t bucket : bucket_order)
+			{
+				if (bucket_resources[bucket].empty())
+					break;
+
+				for (uint32_t displacement = 1;; displacement++)
+				{
+					if (displacement == 0x1000000)
+						throw Exception("Unable to build the resource id index");
+
+					bucket_slots.clear();
+					for (uint32_t index : bucket_resources[bucket])
+					{
+						uint32_t slot = hash(resource_ids[index], displacement) % num_resources;
+						if (slots[slot] != no_index || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end())
+							break;
+						bucket_slots.push_back(slot);
+					}
+
+					if (bucket_slots.size() == bucket_resources[bucket].size())
+					{
+						for (size_t i = 0; i < bucket_slots.size(); i++)
+							slots[bucket_slots[i]] = bucket_resources[bucket][i];
+						buckets[bucket] = displacement;
+						break;
+					}
+				}
+			}
+		}
+
+		// Table layout:
+		uint32_t offset = sizeof(Header);
+		h.num_strings = writer.strings.size();
+		h.strings_offset = offset;
+		offset += Writer::table_size(writer.strings);
+		h.string_data_size = writer.string_data.size();
+		h.string_data_offset = offset;
+		offset += Writer::table_size(writer.string_data);
+		h.num_resources = num_resources;
+		h.resources_offset = offset;
+		offset += Writer::table_size(resources);
+		h.num_buckets = num_buckets;
+		h.buckets_offset = offset;
+		offset += Writer::table_size(buckets);
+		h.slots_offset = offset;
+		offset += Writer::table_size(slots);
+		h.num_section_elements = section_elements.size();
+		h.section_elements_offset = offset;
+		offset += Writer::table_size(section_elements);
+		h.num_sections = sections.size();
+		h.sections_offset = offset;
+		offset += Writer::table_size(sections);
+		h.num_types = types.size();
+		h.types_offset = offset;
+		offset += Writer::table_size(types);
+		h.num_indices = indices.size();
+		h.indices_offset = offset;
+		offset += Writer::table_size(indices);
+		h.num_section_names = section_names.size();
+		h.section_names_offset = offset;
+		offset += Writer::table_size(section_names);
+		h.num_nodes = writer.nodes.size();
+		h.nodes_offset = offset;
+
+		file.write(&h, sizeof(Header));
+		Writer::write_table(file, writer.strings);
+		Writer::write_table(file, writer.string_data);
+		Writer::write_table(file, resources);
+		Writer::write_table(file, buckets);
+		Writer::write_table(file, slots);
+		Writer::write_table(file, section_elements);
+		Writer::write_table(file, sections);
+		Writer::write_table(file, types);
+		Writer::write_table(file, indices);
+		Writer::write_table(file, section_names);
+		Writer::write_table(file, writer.nodes);
+	}
+
+	void XMLResourceCompiled::load(IODevice &file)
+	{
+		// Read the whole file with as few reads as possible. All tables are then used in place.
+		size_t size = 0;
+		DataBuffer buffer(std::max(file.get_size(), (size_t)sizeof(Header)) + 1);
+		while (true)
+		{
+			if (size == buffer.get_size())
+				buffer.set_size(size * 2);
+
+			size_t received = file.read(buffer.get_data() + size, buffer.get_size() - size, false);
+			if (received == 0 || received > buffer.get_size() - size)
+				break;
+			size += received;
+		}
+
+		if (size < sizeof(Header))
+			throw_corrupt();
+
+		const Header *h = buffer.get_data<Header>();
+		if (memcmp(h->magic, compiled_magic, sizeof(compiled_magic)) != 0)
+			throw Exception("Not a compiled resource document");
+		if (h->version != version || h->byte_order != compiled_byte_order)
+			throw Exception("Compiled resource document was created for a different version or platform");
+
+		struct Table { uint32_t offset; uint64_t count; size_t entry_size; };
+		Table tables[] =
+		{
+			{ h->strings_offset, h->num_strings, sizeof(StringEntry) },
+			{ h->string_data_offset, h->string_data_size, 1 },
+			{ h->resources_offset, h->num_resources, sizeof(ResourceEntry) },
+			{ h->buckets_offset, h->num_buckets, sizeof(uint32_t) },
+			{ h->slots_offset, h->num_resources, sizeof(uint32_t) },
+			{ h->section_elements_offset, h->num_section_elements, sizeof(SectionElementEntry) },
+			{ h->sections_offset, h->num_sections, sizeof(ListEntry) },
+			{ h->types_offset, h->num_types, sizeof(ListEntry) },
+			{ h->indices_offset, h->num_indices, sizeof(uint32_t) },
+			{ h->section_names_offset, h->num_section_names, sizeof(uint32_t) },
+			{ h->nodes_offset, h->num_nodes, sizeof(uint32_t) }
+		};
+		for (const Table &t : tables)
+		{
+			if (t.offset % 4 != 0 || t.offset < sizeof(Header) || t.offset + t.count * t.entry_size > size)
+				throw_corrupt();
+		}
+		if ((h->num_resources > 0) != (h->num_buckets > 0))
+			throw_corrupt();
+
+		data = buffer;
+		section_elements.clear();
+		section_elements.resize(h->num_section_elements);
+	}
+
+	DomElement XMLResourceCompiled::create_document_element(DomDocument &document) const
+	{
+		uint32_t index = header()->document_element;
+		if (get_node_word(index) != node_element)
+			throw_corrupt();
+		return create_node(document, index).to_element();
+	}
+
+	DomElement XMLResourceCompiled::create_element(DomDocument &document, int index)
+	{
+		const ResourceEntry &entry = table<ResourceEntry>(header()->resources_offset)[index];
+
+		DomElement parent;
+		if (entry.section_element == no_index)
+			parent = document.get_document_element();
+		else
+			parent = create_section_element(document, entry.section_element);
+
+		uint32_t node_index = entry.node;
+		if (get_node_word(node_index) != node_element)
+			throw_corrupt();
+		DomElement element = create_node(document, node_index).to_element();
+		parent.append_child(element);
+		return element;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// XMLResourceCompiled Implementation:
+
+	std::string XMLResourceCompiled::get_string(uint32_t id) const
+	{
+		const Header *h = header();
+		if (id >= h->num_strings)
+			throw_corrupt();
+
+		const StringEntry &entry = table<StringEntry>(h->strings_offset)[id];
+		if ((uint64_t)entry.offset + entry.length > h->string_data_size)
+			throw_corrupt();
+		return std::string(table<char>(h->string_data_offset) + entry.offset, entry.length);
+	}
+
+	bool XMLResourceCompiled::string_equals(uint32_t id, const std::string &str) const
+	{
+		const Header *h = header();
+		if (id >= h->num_strings)
+			throw_corrupt();
+
+		const StringEntry &entry = table<StringEntry>(h->strings_offset)[id];
+		if ((uint64_t)entry.offset + entry.length > h->string_data_size)
+			throw_corrupt();
+		return entry.length == str.length() && memcmp(table<char>(h->string_data_offset) + entry.offset, str.data(), entry.length) == 0;
+	}
+
+	uint32_t XMLResourceCompiled::get_node_word(uint32_t index) const
+	{
+		if (index >= header()->num_nodes)
+			throw_corrupt();
+		return table<uint32_t>(header()->nodes_offset)[index];
+	}
+
+	DomNode XMLResourceCompiled::create_node(DomDocument &document, uint32_t &index) const
+	{
+		switch (get_node_word(index++))
+		{
+		case node_element:
+		{
+			std::string namespace_uri = get_string(get_node_word(index++));
+			std::string qualified_name = get_string(get_node_word(index++));
+			uint32_t num_attributes = get_node_word(index++);
+			uint32_t num_children = get_node_word(index++);
+
+			DomElement element = document.create_element_ns(namespace_uri, qualified_name);
+			set_attributes(element, index, num_attributes);
+			for (uint32_t i = 0; i < num_children; i++)
+				element.append_child(create_node(document, index));
+			return element;
+		}
+		case node_text:
+			return document.create_text_node(get_string(get_node_word(index++)));
+		case node_cdata:
+			return document.create_cdata_section(get_string(get_node_word(index++)));
+		case node_comment:
+			return document.create_comment(get_string(get_node_word(index++)));
+		case node_processing_instruction:
+		{
+			std::string target = get_string(get_node_word(index++));
+			std::string data = get_string(get_node_word(index++));
+			return document.create_processing_instruction(target, data);
+		}
+		default:
+			throw_corrupt();
+			return DomNode();
+		}
+	}
+
+	void XMLResourceCompiled::set_attributes(DomElement &element, uint32_t &index, uint32_t num_attributes) const
+	{
+		for (uint32_t i = 0; i < num_attributes; i++)
+		{
+			std::string namespace_uri = get_string(get_node_word(index++));
+			std::string qualified_name = get_string(get_node_word(index++));
+			std::string value = get_string(get_node_word(index++));
+			element.set_attribute_ns(namespace_uri, qualified_name, value);
+		}
+	}
+
+	DomElement XMLResourceCompiled::create_section_element(DomDocument &document, uint32_t section_element)
+	{
+		if (section_element >= section_elements.size())
+			throw_corrupt();
+
+		if (section_elements[section_element].is_null())
+		{
+			const SectionElementEntry &entry = table<SectionElementEntry>(header()->section_elements_offset)[section_element];
+
+			DomElement parent;
+			if (entry.parent == no_index)
+				parent = document.get_document_element();
+			else if (entry.parent < section_element)
+				parent = create_section_element(document, entry.parent);
+			else
+				throw_corrupt();
+
+			uint32_t node_index = entry.node;
+			if (get_node_word(node_index) != node_element)
+				throw_corrupt();
+			section_elements[section_element] = create_node(document, node_index).to_element();
+			parent.append_child(section_elements[section_element]);
+		}
+		return section_elements[section_element];
+	}
+
+	const XMLResourceCompiled::ListEntry *XMLResourceCompiled::find_list(uint32_t offset, uint32_t count, const std::string &name) const
+	{
+		const Header *h = header();
+		const ListEntry *begin = table<ListEntry>(offset);
+		const ListEntry *end = begin + count;
+		const ListEntry *it = std::lower_bound(begin, end, name, [&](const ListEntry &entry, const std::string &value)
+		{
+			if (entry.name >= h->num_strings)
+				throw_corrupt();
+			const StringEntry &str = table<StringEntry>(h->strings_offset)[entry.name];
+			if ((uint64_t)str.offset + str.length > h->string_data_size)
+				throw_corrupt();
+			int result = memcmp(table<char>(h->string_data_offset) + str.offset, value.data(), std::min((size_t)str.length, value.length()));
+			return result < 0 || (result == 0 && str.length < value.length());
+		});
+
+		if (it != end && string_equals(it->name, name))
+			return it;
+		return nullptr;
+	}
+
+	void XMLResourceCompiled::add_names(std::vector<std::string> &names, const ListEntry *list, uint32_t section) const
+	{
+		if (!list)
+			return;
+
+		const Header *h = header();
+		const ResourceEntry *resources = table<ResourceEntry>(h->resources_offset);
+		const uint32_t *indices = table<uint32_t>(h->indices_offset);
+		if ((uint64_t)list->first_index + list->num_indices > h->num_indices)
+			throw_corrupt();
+
+		for (uint32_t i = 0; i < list->num_indices; i++)
+		{
+			uint32_t index = indices[list->first_index + i];
+			if (index >= h->num_resources)
+				throw_corrupt();
+			if (section == no_index || resources[index].section == section)
+				names.push_back(get_string(resources[index].id));
+		}
+	}
+
+	uint32_t XMLResourceCompiled::hash(const std::string &str, uint32_t seed)
+	{
+		uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+		for (char c : str)
+			h = (h ^ (unsigned char)c) * 16777619u;
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	void XMLResourceCompiled::throw_corrupt()
+	{
+		throw Exception("Compiled resource document is corrupt");
+	}
+}
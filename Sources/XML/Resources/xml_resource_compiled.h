@@ -0,0 +1,162 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/System/databuffer.h"
+#include "API/XML/dom_document.h"
+#include "API/XML/dom_element.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	class IODevice;
+
+	/// \brief Precompiled binary resource document.
+	///
+	/// The file is a set of offset based tables that are used in place after a single read:
+	/// a string table, a perfect hash index on the resource ids, one record per resource
+	/// and presorted section and type lists. The DOM element of a resource is only created
+	/// when the resource is requested.
+	class XMLResourceCompiled
+	{
+	public:
+		/// \brief Returns true if the device starts with the compiled resource file signature.
+		static bool is_compiled(IODevice &file);
+
+		/// \brief Compiles the resources of a loaded resource XML document.
+		static void save(IODevice &file, DomDocument &document, const std::string &ns_resources);
+
+		/// \brief Reads a compiled resource file.
+		void load(IODevice &file);
+
+		/// \brief Creates the document element of the resource document with its attributes.
+		DomElement create_document_element(DomDocument &document) const;
+
+		/// \brief Returns the index of a resource, or -1 if it does not exist.
+		int find_resource(const std::string &resource_id) const;
+
+		int get_resource_count() const { return header()->num_resources; }
+		std::string get_resource_id(int index) const;
+
+		/// \brief Creates the DOM element of a resource, including the sections it belongs to.
+		DomElement create_element(DomDocument &document, int index);
+
+		std::string get_ns_resources() const { return get_string(header()->ns_resources); }
+
+		std::vector<std::string> get_section_names() const;
+		std::vector<std::string> get_resource_names() const;
+		std::vector<std::string> get_resource_names(const std::string &section) const;
+		std::vector<std::string> get_resource_names_of_type(const std::string &type) const;
+		std::vector<std::string> get_resource_names_of_type(const std::string &type, const std::string &section) const;
+
+		static const uint32_t version = 1;
+
+	private:
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t byte_order;
+			uint32_t ns_resources;
+			uint32_t document_element;
+			uint32_t num_strings, strings_offset;
+			uint32_t string_data_size, string_data_offset;
+			uint32_t num_resources, resources_offset;
+			uint32_t num_buckets, buckets_offset, slots_offset;
+			uint32_t num_section_elements, section_elements_offset;
+			uint32_t num_sections, sections_offset;
+			uint32_t num_types, types_offset;
+			uint32_t num_indices, indices_offset;
+			uint32_t num_section_names, section_names_offset;
+			uint32_t num_nodes, nodes_offset;
+		};
+
+		struct StringEntry
+		{
+			uint32_t offset;
+			uint32_t length;
+		};
+
+		struct ResourceEntry
+		{
+			uint32_t id;
+			uint32_t name;
+			uint32_t section_element;
+			uint32_t section;
+			uint32_t node;
+		};
+
+		struct SectionElementEntry
+		{
+			uint32_t parent;
+			uint32_t node;
+		};
+
+		/// \brief Sorted list of resources sharing a section or a type.
+		struct ListEntry
+		{
+			uint32_t name;
+			uint32_t base_name;
+			uint32_t first_index;
+			uint32_t num_indices;
+		};
+
+		enum NodeKind
+		{
+			node_element = 1,
+			node_text = 2,
+			node_cdata = 3,
+			node_comment = 4,
+			node_processing_instruction = 5
+		};
+
+		class Writer;
+
+		const Header *header() const { return data.get_data<Header>(); }
+		template<typename Type> const Type *table(uint32_t offset) const { return reinterpret_cast<const Type*>(data.get_data() + offset); }
+
+		std::string get_string(uint32_t id) const;
+		bool string_equals(uint32_t id, const std::string &str) const;
+		uint32_t get_node_word(uint32_t index) const;
+		DomNode create_node(DomDocument &document, uint32_t &index) const;
+		void set_attributes(DomElement &element, uint32_t &index, uint32_t num_attributes) const;
+		DomElement create_section_element(DomDocument &document, uint32_t section_element);
+		const ListEntry *find_list(uint32_t offset, uint32_t count, const std::string &name) const;
+		void add_names(std::vector<std::string> &names, const ListEntry *list, uint32_t section) const;
+
+		static uint32_t hash(const std::string &str, uint32_t seed);
+		static void throw_corrupt();
+
+		DataBuffer data;
+		std::vector<DomElement> section_elements;
+	};
+}
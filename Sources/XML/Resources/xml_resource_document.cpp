@@ -93,6 +93,9 @@ namespace clan
 		if (it != impl->resources.end())
 			return true;
 
+		if (impl->compiled && impl->compiled->find_resource(resource_id) != -1)
+			return true;
+
 		for (std::vector<XMLResourceDocument>::const_iterator it = impl->additional_resources.begin();
 			it != impl->additional_resources.end();
 			++it)
@@ -104,15 +107,22 @@ namespace clan
 	std::vector<std::string> XMLResourceDocument::get_section_names() const
 	{
 		std::vector<std::string> names;
-		std::string last_section;
-		std::map<std::string, XMLResourceNode>::const_iterator it;
-		for (it = impl->resources.begin(); it != impl->resources.end(); ++it)
+		if (impl->compiled)
+		{
+			names = impl->compiled->get_section_names();
+		}
+		else
 		{
-			std::string section = PathHelp::get_fullpath(it->first, PathHelp::path_type_virtual);
-			if (section != last_section)
+			std::string last_section;
+			std::map<std::string, XMLResourceNode>::const_iterator it;
+			for (it = impl->resources.begin(); it != impl->resources.end(); ++it)
 			{
-				names.push_back(section);
-				last_section = section;
+				std::string section = PathHelp::get_fullpath(it->first, PathHelp::path_type_virtual);
+				if (section != last_section)
+				{
+					names.push_back(section);
+					last_section = section;
+				}
 			}
 		}
 
@@ -134,6 +144,9 @@ namespace clan
 
 	std::vector<std::string> XMLResourceDocument::get_resource_names() const
 	{
+		if (impl->compiled)
+			return impl->compiled->get_resource_names();
+
 		std::vector<std::string> names;
 		std::map<std::string, XMLResourceNode>::const_iterator it;
 		for (it = impl->resources.begin(); it != impl->resources.end(); ++it)
@@ -147,14 +160,21 @@ namespace clan
 	std::vector<std::string> XMLResourceDocument::get_resource_names(const std::string &section) const
 	{
 		std::vector<std::string> names;
-		std::map<std::string, XMLResourceNode>::const_iterator it;
-		for (it = impl->resources.begin(); it != impl->resources.end(); ++it)
+		if (impl->compiled)
 		{
-			std::string cur_section = PathHelp::get_basepath(it->first, PathHelp::path_type_virtual);
-			if (section == cur_section)
+			names = impl->compiled->get_resource_names(section);
+		}
+		else
+		{
+			std::map<std::string, XMLResourceNode>::const_iterator it;
+			for (it = impl->resources.begin(); it != impl->resources.end(); ++it)
 			{
-				std::string name = PathHelp::get_filename(it->first, PathHelp::path_type_virtual);
-				names.push_back(name);
+				std::string cur_section = PathHelp::get_basepath(it->first, PathHelp::path_type_virtual);
+				if (section == cur_section)
+				{
+					std::string name = PathHelp::get_filename(it->first, PathHelp::path_type_virtual);
+					names.push_back(name);
+				}
 			}
 		}
 
@@ -176,6 +196,9 @@ namespace clan
 
 	std::vector<std::string> XMLResourceDocument::get_resource_names_of_type(const std::string &type) const
 	{
+		if (impl->compiled)
+			return impl->compiled->get_resource_names_of_type(type);
+
 		std::vector<std::string> names;
 		std::map<std::string, XMLResourceNode>::const_iterator it;
 		for (it = impl->resources.begin(); it != impl->resources.end(); ++it)
@@ -190,6 +213,8 @@ namespace clan
 		const std::string &type,
 		const std::string &section) const
 	{
+		if (impl->compiled)
+			return impl->compiled->get_resource_names_of_type(type, section);
 
 		std::string section_trailing_slash = PathHelp::add_trailing_slash(section, PathHelp::path_type_virtual);
 
@@ -216,13 +241,26 @@ namespace clan
 		return node;
 	}
 
-	XMLResourceNode XMLResourceDocument_Impl::get_resource(const std::string &resource_id) const
+	XMLResourceNode XMLResourceDocument_Impl::get_resource(const std::string &resource_id)
 	{
 		std::map<std::string, XMLResourceNode>::const_iterator it;
 		it = resources.find(resource_id);
 		if (it != resources.end())
 			return it->second;
 
+		if (compiled)
+		{
+			int index = compiled->find_resource(resource_id);
+			if (index != -1)
+			{
+				std::weak_ptr<XMLResourceDocument_Impl> self = shared_from_this();
+				XMLResourceDocument owner(self);
+				XMLResourceNode node(compiled->create_element(document, index), owner);
+				resources[resource_id] = node;
+				return node;
+			}
+		}
+
 		std::vector<XMLResourceDocument>::size_type i;
 		for (i = 0; i < additional_resources.size(); i++)
 		{
@@ -301,6 +339,8 @@ namespace clan
 		if (resource_exists(resource_id))
 			throw Exception(string_format("Resource %1 already exists", resource_id));
 
+		impl->expand_compiled();
+
 		std::vector<std::string> path_elements = PathHelp::split_basepath(resource_id);
 		std::string name = PathHelp::get_filename(resource_id);
 
@@ -369,6 +409,8 @@ namespace clan
 
 	void XMLResourceDocument::destroy_resource(const std::string &resource_id)
 	{
+		impl->expand_compiled();
+
 		std::map<std::string, XMLResourceNode>::iterator it;
 		it = impl->resources.find(resource_id);
 		if (it == impl->resources.end())
@@ -399,9 +441,27 @@ namespace clan
 
 	void XMLResourceDocument::save(IODevice file)
 	{
+		impl->expand_compiled();
 		impl->document.save(file);
 	}
 
+	void XMLResourceDocument::save_compiled(const std::string &filename)
+	{
+		File file(filename, File::create_always, File::access_read_write);
+		save_compiled(file);
+	}
+
+	void XMLResourceDocument::save_compiled(const std::string &filename, const FileSystem &fs)
+	{
+		save_compiled(fs.open_file(filename, File::create_always, File::access_read_write, File::share_read));
+	}
+
+	void XMLResourceDocument::save_compiled(IODevice file)
+	{
+		impl->expand_compiled();
+		XMLResourceCompiled::save(file, impl->document, impl->ns_resources);
+	}
+
 	void XMLResourceDocument::load(const std::string &fullname)
 	{
 		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
@@ -418,6 +478,23 @@ namespace clan
 
 	void XMLResourceDocument::load(IODevice file, const std::string &base_path, const FileSystem &fs)
 	{
+		if (XMLResourceCompiled::is_compiled(file))
+		{
+			std::unique_ptr<XMLResourceCompiled> compiled(new XMLResourceCompiled());
+			compiled->load(file);
+
+			DomDocument new_document;
+			new_document.append_child(compiled->create_document_element(new_document));
+
+			impl->document = new_document;
+			impl->ns_resources = compiled->get_ns_resources();
+			impl->fs = fs;
+			impl->base_path = base_path;
+			impl->resources.clear();
+			impl->compiled = std::move(compiled);
+			return;
+		}
+
 		DomDocument new_document;
 		new_document.load(file);
 
@@ -443,6 +520,7 @@ namespace clan
 		impl->fs = fs;
 		impl->base_path = base_path;
 		impl->resources.clear();
+		impl->compiled.reset();
 
 		std::vector<std::string> section_stack;
 		std::vector<DomNode> nodes_stack;
@@ -480,4 +558,15 @@ namespace clan
 			}
 		}
 	}
+
+	void XMLResourceDocument_Impl::expand_compiled()
+	{
+		if (!compiled)
+			return;
+
+		int count = compiled->get_resource_count();
+		for (int i = 0; i < count; i++)
+			get_resource(compiled->get_resource_id(i));
+		compiled.reset();
+	}
 }
@@ -31,14 +31,19 @@
 #include "API/Core/IOData/file_system.h"
 #include "API/XML/dom_document.h"
 #include "API/XML/dom_element.h"
+#include "xml_resource_compiled.h"
 #include <map>
+#include <memory>
 
 namespace clan
 {
-	class XMLResourceDocument_Impl
+	class XMLResourceDocument_Impl : public std::enable_shared_from_this<XMLResourceDocument_Impl>
 	{
 	public:
-		XMLResourceNode get_resource(const std::string &resource_id) const;
+		XMLResourceNode get_resource(const std::string &resource_id);
+
+		/// \brief Creates the DOM elements of all compiled resources and switches to the DOM only representation.
+		void expand_compiled();
 
 		FileSystem fs;
 		std::string base_path;
@@ -48,5 +53,8 @@ namespace clan
 		std::map<std::string, XMLResourceNode> resources;
 		std::vector<XMLResourceDocument> additional_resources;
 		std::string ns_resources;
+
+		/// \brief Loaded precompiled resources. Resources are added to the resources map as they are requested.
+		std::unique_ptr<XMLResourceCompiled> compiled;
 	};
 }
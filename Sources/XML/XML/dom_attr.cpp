@@ -58,7 +58,10 @@ namespace clan
 	DomString DomAttr::get_name() const
 	{
 		if (impl)
-			return impl->get_tree_node()->get_node_name();
+		{
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			return impl->get_tree_node()->get_node_name(doc_impl);
+		}
 		return DomString();
 	}
 
@@ -70,7 +73,10 @@ namespace clan
 	DomString DomAttr::get_value() const
 	{
 		if (impl)
-			return impl->get_tree_node()->get_node_value();
+		{
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			return impl->get_tree_node()->get_node_value(doc_impl);
+		}
 		return DomString();
 	}
 
@@ -68,8 +68,9 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString value = impl->get_tree_node()->get_node_value();
-			impl->get_tree_node()->node_value += arg;
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString value = impl->get_tree_node()->get_node_value(doc_impl);
+			impl->get_tree_node()->set_node_value(doc_impl, value + arg);
 		}
 	}
 
@@ -77,10 +78,11 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString value = impl->get_tree_node()->get_node_value();
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString value = impl->get_tree_node()->get_node_value(doc_impl);
 			if (offset > value.length())
 				offset = value.length();
-			impl->get_tree_node()->node_value = value.substr(0, offset) + arg + value.substr(offset);
+			impl->get_tree_node()->set_node_value(doc_impl, value.substr(0, offset) + arg + value.substr(offset));
 		}
 	}
 
@@ -88,7 +90,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString value = impl->get_tree_node()->get_node_value();
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString value = impl->get_tree_node()->get_node_value(doc_impl);
 			if (offset > value.length())
 				offset = value.length();
 			if (offset + count > value.length())
@@ -104,7 +107,7 @@ namespace clan
 			{
 				value = DomString();
 			}
-			impl->get_tree_node()->node_value = value;
+			impl->get_tree_node()->set_node_value(doc_impl, value);
 		}
 	}
 
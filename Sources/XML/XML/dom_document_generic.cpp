@@ -28,6 +28,8 @@
 
 #include "XML/precomp.h"
 #include "API/XML/xml_token.h"
+#include "API/XML/xml_stream_token.h"
+#include "API/XML/xml_stream_tokenizer.h"
 #include "API/XML/dom_node.h"
 #include "dom_document_generic.h"
 #include "dom_tree_node.h"
@@ -35,20 +37,15 @@
 
 namespace clan
 {
-	DomDocument_Impl::DomDocument_Impl()
+	DomDocument_Impl::DomDocument_Impl() : num_nodes(0), text_garbage(0)
 	{
+		intern_string(std::string());
 		node_index = DomDocument_Impl::allocate_tree_node();
-		nodes[node_index]->node_type = DomNode::DOCUMENT_NODE;
+		get_tree_node(node_index)->node_type = DomNode::DOCUMENT_NODE;
 	}
 
 	DomDocument_Impl::~DomDocument_Impl()
 	{
-		std::vector<DomNode_Impl *>::size_type pos, size;
-
-		size = nodes.size();
-		for (pos = 0; pos < size; pos++)
-			delete nodes[pos];
-
 		while (!free_dom_nodes.empty())
 		{
 			delete free_dom_nodes.back();
@@ -97,14 +94,16 @@ namespace clan
 	{
 		if (free_nodes.empty())
 		{
-			auto node = new (&node_allocator) DomTreeNode();
-			nodes.push_back(node);
-			return nodes.size() - 1;
+			if (num_nodes == cl_null_node_index)
+				throw Exception("Too many nodes in XML document");
+			if ((num_nodes >> node_block_shift) == node_blocks.size())
+				node_blocks.push_back(std::unique_ptr<DomTreeNode[]>(new DomTreeNode[node_block_size]));
+			return num_nodes++;
 		}
 		else
 		{
 			unsigned index = free_nodes.back();
-			nodes[index]->reset();
+			get_tree_node(index)->reset(this);
 			free_nodes.pop_back();
 			return index;
 		}
@@ -115,6 +114,265 @@ namespace clan
 		free_nodes.push_back(node_index);
 	}
 
+	unsigned int DomDocument_Impl::intern_string(const std::string &str)
+	{
+		auto it = string_ids.find(str);
+		if (it != string_ids.end())
+			return it->second;
+
+		unsigned int string_id = strings.size();
+		it = string_ids.insert(std::make_pair(str, string_id)).first;
+		strings.push_back(&it->first);
+		return string_id;
+	}
+
+	unsigned int DomDocument_Impl::intern_string(const char *data, size_t length)
+	{
+		intern_key.assign(data, length);
+		return intern_string(intern_key);
+	}
+
+	void DomDocument_Impl::set_text(unsigned int &offset, unsigned int &length, const char *data, size_t size)
+	{
+		if (size <= length)
+		{
+			if (size > 0)
+				memcpy(text.data() + offset, data, size);
+			text_garbage += length - size;
+			length = size;
+			return;
+		}
+
+		if (text.size() + size > 0xffffffff)
+		{
+			compact_text();
+			if (text.size() + size > 0xffffffff)
+				throw Exception("Too much text in XML document");
+		}
+
+		text_garbage += length;
+		offset = text.size();
+		length = size;
+		text.insert(text.end(), data, data + size);
+
+		if (text_garbage > 64 * 1024 && text_garbage > text.size() / 2)
+			compact_text();
+	}
+
+	void DomDocument_Impl::compact_text()
+	{
+		std::vector<char> new_text;
+		new_text.reserve(text.size() - text_garbage);
+		for (unsigned int index = 0; index < num_nodes; index++)
+		{
+			DomTreeNode *tree_node = get_tree_node(index);
+			if (tree_node->value_length > 0)
+			{
+				unsigned int offset = new_text.size();
+				new_text.insert(new_text.end(), text.begin() + tree_node->value_offset, text.begin() + tree_node->value_offset + tree_node->value_length);
+				tree_node->value_offset = offset;
+			}
+		}
+		text.swap(new_text);
+		text_garbage = 0;
+	}
+
+	void DomDocument_Impl::load(XMLStreamTokenizer &tokenizer, const DomNode &insert_point, unsigned int insert_index, std::vector<unsigned int> &out_nodes)
+	{
+		// Namespace declarations of the open elements, innermost last
+		struct NamespaceDeclaration
+		{
+			std::string prefix;
+			unsigned int uri_id;
+		};
+		std::vector<NamespaceDeclaration> declarations;
+
+		// Open elements and the number of namespace declarations before each of them
+		std::vector<std::pair<unsigned int, size_t>> node_stack;
+		node_stack.push_back(std::make_pair(insert_index, size_t(0)));
+
+		unsigned int xml_id = intern_string("xml");
+		unsigned int xmlns_id = intern_string("xmlns");
+		std::string value;
+
+		// Same search order as find_namespace_uri: the token itself, then the open elements, then the insert point
+		auto find_namespace_id = [&](const XMLStreamToken &token, const XMLStringView &qualified_name) -> unsigned int
+		{
+			const char *colon = static_cast<const char*>(memchr(qualified_name.data(), ':', qualified_name.size()));
+			size_t prefix_length = colon ? colon - qualified_name.data() : 0;
+
+			for (const auto &attribute : token.attributes)
+			{
+				const XMLStringView &name = attribute.first;
+				bool match = (prefix_length == 0) ?
+					name == "xmlns" :
+					name.size() == prefix_length + 6 && memcmp(name.data(), "xmlns:", 6) == 0 && memcmp(name.data() + 6, qualified_name.data(), prefix_length) == 0;
+				if (match)
+				{
+					attribute.second.decode(value);
+					return intern_string(value);
+				}
+			}
+
+			if (prefix_length == 3 && memcmp(qualified_name.data(), "xml", 3) == 0)
+				return xml_id;
+			if ((prefix_length == 5 && memcmp(qualified_name.data(), "xmlns", 5) == 0) || qualified_name == "xmlns")
+				return xmlns_id;
+
+			for (auto it = declarations.rbegin(); it != declarations.rend(); ++it)
+			{
+				if (it->prefix.length() == prefix_length && memcmp(it->prefix.data(), qualified_name.data(), prefix_length) == 0)
+					return it->uri_id;
+			}
+
+			if (insert_index == node_index)
+				return 0;
+			return intern_string(insert_point.find_namespace_uri(qualified_name.raw()));
+		};
+
+		auto append_child = [&](unsigned int child_index)
+		{
+			unsigned int parent_index = node_stack.back().first;
+			DomTreeNode *parent = get_tree_node(parent_index);
+			DomTreeNode *child = get_tree_node(child_index);
+			if (parent->last_child != cl_null_node_index)
+			{
+				get_tree_node(parent->last_child)->next_sibling = child_index;
+				child->previous_sibling = parent->last_child;
+			}
+			else
+			{
+				parent->first_child = child_index;
+			}
+			parent->last_child = child_index;
+			child->parent = parent_index;
+
+			if (node_stack.size() == 1)
+				out_nodes.push_back(child_index);
+		};
+
+		auto append_value_node = [&](unsigned short node_type, unsigned int name_id, const XMLStringView &node_value)
+		{
+			unsigned int index = allocate_tree_node();
+			DomTreeNode *tree_node = get_tree_node(index);
+			tree_node->node_type = node_type;
+			tree_node->name_id = name_id;
+			node_value.decode(value);
+			set_text(tree_node->value_offset, tree_node->value_length, value.data(), value.length());
+			append_child(index);
+		};
+
+		XMLStreamToken token;
+		tokenizer.next(&token);
+		while (token.type != XMLToken::NULL_TOKEN)
+		{
+			switch (token.type)
+			{
+			case XMLToken::TEXT_TOKEN:
+				append_value_node(DomNode::TEXT_NODE, 0, token.value);
+				break;
+
+			case XMLToken::CDATA_SECTION_TOKEN:
+				append_value_node(DomNode::CDATA_SECTION_NODE, 0, token.value);
+				break;
+
+			case XMLToken::COMMENT_TOKEN:
+				append_value_node(DomNode::COMMENT_NODE, 0, token.value);
+				break;
+
+			case XMLToken::PROCESSING_INSTRUCTION_TOKEN:
+				append_value_node(DomNode::PROCESSING_INSTRUCTION_NODE, intern_string(token.name.data(), token.name.size()), token.value);
+				break;
+
+			case XMLToken::ELEMENT_TOKEN:
+				if (token.variant != XMLToken::END)
+				{
+					unsigned int element_index = allocate_tree_node();
+					DomTreeNode *element = get_tree_node(element_index);
+					element->node_type = DomNode::ELEMENT_NODE;
+					element->name_id = intern_string(token.name.data(), token.name.size());
+					element->namespace_id = find_namespace_id(token, token.name);
+					append_child(element_index);
+
+					unsigned int last_attribute = cl_null_node_index;
+					for (const auto &attribute : token.attributes)
+					{
+						unsigned int name_id = intern_string(attribute.first.data(), attribute.first.size());
+						unsigned int namespace_id = find_namespace_id(token, attribute.first);
+
+						// Repeated attributes replace the value, like DomElement::set_attribute_ns
+						DomTreeNode *attribute_node = nullptr;
+						for (unsigned int cur_index = element->first_attribute; cur_index != cl_null_node_index; cur_index = get_tree_node(cur_index)->next_sibling)
+						{
+							DomTreeNode *cur_attribute = get_tree_node(cur_index);
+							if (cur_attribute->name_id == name_id && cur_attribute->namespace_id == namespace_id)
+							{
+								attribute_node = cur_attribute;
+								break;
+							}
+						}
+
+						if (!attribute_node)
+						{
+							unsigned int attribute_index = allocate_tree_node();
+							attribute_node = get_tree_node(attribute_index);
+							attribute_node->node_type = DomNode::ATTRIBUTE_NODE;
+							attribute_node->name_id = name_id;
+							attribute_node->namespace_id = namespace_id;
+							attribute_node->parent = element_index;
+							if (last_attribute == cl_null_node_index)
+							{
+								element->first_attribute = attribute_index;
+							}
+							else
+							{
+								attribute_node->previous_sibling = last_attribute;
+								get_tree_node(last_attribute)->next_sibling = attribute_index;
+							}
+							last_attribute = attribute_index;
+						}
+
+						attribute.second.decode(value);
+						set_text(attribute_node->value_offset, attribute_node->value_length, value.data(), value.length());
+					}
+
+					if (token.variant == XMLToken::BEGIN)
+					{
+						node_stack.push_back(std::make_pair(element_index, declarations.size()));
+						for (const auto &attribute : token.attributes)
+						{
+							const XMLStringView &name = attribute.first;
+							if (name == "xmlns" || (name.size() > 6 && memcmp(name.data(), "xmlns:", 6) == 0))
+							{
+								NamespaceDeclaration declaration;
+								if (name.size() > 6)
+									declaration.prefix.assign(name.data() + 6, name.size() - 6);
+								attribute.second.decode(value);
+								declaration.uri_id = intern_string(value);
+								declarations.push_back(declaration);
+							}
+						}
+					}
+				}
+				else
+				{
+					declarations.resize(node_stack.back().second);
+					node_stack.pop_back();
+					if (node_stack.empty()) throw Exception("Malformed XML tree!");
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			tokenizer.next(&token);
+		}
+
+		if (text.capacity() > text.size() + text.size() / 4)
+			text.shrink_to_fit();
+	}
+
 	DomNode_Impl *DomDocument_Impl::allocate_dom_node()
 	{
 		if (free_dom_nodes.empty())
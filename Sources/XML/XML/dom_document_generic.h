@@ -32,11 +32,14 @@
 #include "API/Core/System/block_allocator.h"
 #include <vector>
 #include <stack>
+#include <string>
+#include <unordered_map>
 
 namespace clan
 {
 	class DomTreeNode;
 	class XMLToken;
+	class XMLStreamTokenizer;
 	class DomNamedNodeMap_Impl;
 
 	class DomDocument_Impl : public DomNode_Impl
@@ -50,8 +53,21 @@ namespace clan
 		std::string system_id;
 		std::string internal_subset;
 		BlockAllocator node_allocator;
-		std::vector<DomTreeNode *> nodes;
+
+		// Tree nodes are stored by value in fixed size blocks, so pointers to them stay valid when more are allocated
+		enum { node_block_shift = 12, node_block_size = 1 << node_block_shift };
+		std::vector<std::unique_ptr<DomTreeNode[]>> node_blocks;
+		unsigned int num_nodes;
 		std::vector<int> free_nodes;
+
+		// Interned names and namespace URIs. ID 0 is the empty string.
+		std::vector<const std::string *> strings;
+		std::unordered_map<std::string, unsigned int> string_ids;
+		std::string intern_key;
+
+		// Node values. Text that is no longer referenced is counted as garbage until the arena is compacted.
+		std::vector<char> text;
+		size_t text_garbage;
 		std::vector<DomNode_Impl *> free_dom_nodes;
 		std::vector<DomNamedNodeMap_Impl *> free_named_node_maps;
 
@@ -60,8 +76,21 @@ namespace clan
 			const XMLToken &search_token,
 			const DomNode &search_node);
 
+		DomTreeNode *get_tree_node(unsigned int node_index);
+		const DomTreeNode *get_tree_node(unsigned int node_index) const;
 		unsigned int allocate_tree_node();
 		void free_tree_node(unsigned int node_index);
+
+		unsigned int intern_string(const std::string &str);
+		unsigned int intern_string(const char *data, size_t length);
+		const std::string &get_string(unsigned int string_id) const { return *strings[string_id]; }
+
+		void set_text(unsigned int &offset, unsigned int &length, const char *data, size_t size);
+		void free_text(unsigned int offset, unsigned int length) { text_garbage += length; }
+		void compact_text();
+
+		// Parses the tokens and appends the nodes to the insert point. The top level nodes are added to out_nodes.
+		void load(XMLStreamTokenizer &tokenizer, const DomNode &insert_point, unsigned int insert_index, std::vector<unsigned int> &out_nodes);
 		DomNode_Impl *allocate_dom_node();
 		void free_dom_node(DomNode_Impl *node);
 		DomNamedNodeMap_Impl *allocate_named_node_map();
@@ -81,7 +81,7 @@ namespace clan
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
+			if (cur_attribute->get_node_name(doc_impl) == name)
 			{
 				DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
 				dom_node->node_index = cur_index;
@@ -105,12 +105,12 @@ namespace clan
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
+			std::string lname = cur_attribute->get_node_name(doc_impl);
 			std::string::size_type lpos = lname.find_first_of(':');
 			if (lpos != std::string::npos)
 				lname = lname.substr(lpos + 1);
 
-			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
+			if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
 			{
 				DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
 				dom_node->node_index = cur_index;
@@ -137,7 +137,7 @@ namespace clan
 		DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
+			if (cur_attribute->get_node_name(doc_impl) == name)
 			{
 				new_tree_node->parent = cur_attribute->parent;
 				new_tree_node->previous_sibling = cur_attribute->previous_sibling;
@@ -169,7 +169,7 @@ namespace clan
 			new_tree_node->parent = impl->node_index;
 			new_tree_node->previous_sibling = last_index;
 			new_tree_node->next_sibling = cl_null_node_index;
-			doc_impl->nodes[last_index]->next_sibling = node.impl->node_index;
+			doc_impl->get_tree_node(last_index)->next_sibling = node.impl->node_index;
 		}
 		return node;
 	}
@@ -190,12 +190,12 @@ namespace clan
 		DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
+			std::string lname = cur_attribute->get_node_name(doc_impl);
 			std::string::size_type lpos = lname.find_first_of(':');
 			if (lpos != std::string::npos)
 				lname = lname.substr(lpos + 1);
 
-			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
+			if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
 			{
 				new_tree_node->parent = cur_attribute->parent;
 				new_tree_node->previous_sibling = cur_attribute->previous_sibling;
@@ -227,7 +227,7 @@ namespace clan
 			new_tree_node->parent = impl->node_index;
 			new_tree_node->previous_sibling = last_index;
 			new_tree_node->next_sibling = cl_null_node_index;
-			doc_impl->nodes[last_index]->next_sibling = node.impl->node_index;
+			doc_impl->get_tree_node(last_index)->next_sibling = node.impl->node_index;
 		}
 		return node;
 	}
@@ -243,7 +243,7 @@ namespace clan
 		DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
+			if (cur_attribute->get_node_name(doc_impl) == name)
 			{
 				if (cur_attribute->previous_sibling == cl_null_node_index)
 					tree_node->first_attribute = cur_attribute->next_sibling;
@@ -280,12 +280,12 @@ namespace clan
 		DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
+			std::string lname = cur_attribute->get_node_name(doc_impl);
 			std::string::size_type lpos = lname.find_first_of(':');
 			if (lpos != std::string::npos)
 				lname = lname.substr(lpos + 1);
 
-			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
+			if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
 			{
 				if (cur_attribute->previous_sibling == cl_null_node_index)
 					tree_node->first_attribute = cur_attribute->next_sibling;
@@ -349,7 +349,7 @@ namespace clan
 		if (node_index == cl_null_node_index)
 			return nullptr;
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *)owner_document.lock().get();
-		return doc_impl->nodes[node_index];
+		return doc_impl->get_tree_node(node_index);
 	}
 
 	inline const DomTreeNode *DomNamedNodeMap_Impl::get_tree_node() const
@@ -357,6 +357,6 @@ namespace clan
 		if (node_index == cl_null_node_index)
 			return nullptr;
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *)owner_document.lock().get();
-		return doc_impl->nodes[node_index];
+		return doc_impl->get_tree_node(node_index);
 	}
 }
@@ -49,6 +49,7 @@
 #include "dom_document_generic.h"
 #include "dom_tree_node.h"
 #include "dom_named_node_map_generic.h"
+#include "xpath_evaluator_impl.h"
 
 namespace clan
 {
@@ -84,6 +85,7 @@ namespace clan
 	{
 		if (impl)
 		{
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
 			const DomTreeNode *tree_node = impl->get_tree_node();
 			switch (tree_node->node_type)
 			{
@@ -105,7 +107,7 @@ namespace clan
 			case NOTATION_NODE:
 			case PROCESSING_INSTRUCTION_NODE:
 			default:
-				return tree_node->get_node_name();
+				return tree_node->get_node_name(doc_impl);
 			}
 		}
 		return DomString();
@@ -115,6 +117,7 @@ namespace clan
 	{
 		if (impl)
 		{
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
 			const DomTreeNode *tree_node = impl->get_tree_node();
 			switch (tree_node->node_type)
 			{
@@ -131,7 +134,7 @@ namespace clan
 			case ATTRIBUTE_NODE:
 			case PROCESSING_INSTRUCTION_NODE:
 			default:
-				return tree_node->get_node_value();
+				return tree_node->get_node_value(doc_impl);
 			}
 		}
 		return DomString();
@@ -140,7 +143,10 @@ namespace clan
 	DomString DomNode::get_namespace_uri() const
 	{
 		if (impl)
-			return impl->get_tree_node()->get_namespace_uri();
+		{
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			return impl->get_tree_node()->get_namespace_uri(doc_impl);
+		}
 		return DomString();
 	}
 
@@ -148,7 +154,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString node_name = impl->get_tree_node()->get_node_name();
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 			DomString::size_type pos = node_name.find(':');
 			if (pos != DomString::npos)
 				return node_name.substr(0, pos);
@@ -161,7 +168,7 @@ namespace clan
 		if (impl)
 		{
 			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
-			DomString node_name = impl->get_tree_node()->get_node_name();
+			DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 			DomString::size_type pos = node_name.find(':');
 			if (pos == DomString::npos)
 				impl->get_tree_node()->set_node_name(doc_impl, prefix + ':' + node_name);
@@ -174,7 +181,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString node_name = impl->get_tree_node()->get_node_name();
+			const DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 			DomString::size_type pos = node_name.find(':');
 			if (pos != DomString::npos)
 				return node_name.substr(pos + 1);
@@ -668,16 +676,16 @@ namespace clan
 			const DomTreeNode *cur_attr = cur->get_first_attribute(doc_impl);
 			while (cur_attr)
 			{
-				std::string node_name = cur_attr->get_node_name();
+				std::string node_name = cur_attr->get_node_name(doc_impl);
 				if (prefix.empty())
 				{
 					if (node_name == xmlns_xmlns)
-						return cur_attr->get_node_value();
+						return cur_attr->get_node_value(doc_impl);
 				}
 				else
 				{
 					if (node_name.substr(0, 6) == xmlns_prefix && node_name.substr(6) == prefix)
-						return cur_attr->get_node_value();
+						return cur_attr->get_node_value(doc_impl);
 				}
 				cur_attr = cur_attr->get_next_sibling(doc_impl);
 			}
@@ -709,8 +717,9 @@ namespace clan
 
 	std::vector<DomNode> DomNode::select_nodes(const DomString &xpath_expression) const
 	{
-		XPathEvaluator evaluator;
-		return evaluator.evaluate(xpath_expression, *this).get_node_set();
+		std::vector<DomNode> nodes;
+		XPathEvaluator_Impl().select_nodes(*XPathExpressionCache::get(xpath_expression), *this, nodes);
+		return nodes;
 	}
 
 	DomNode DomNode::select_node(const DomString &xpath_expression) const
@@ -721,6 +730,21 @@ namespace clan
 		return nodes[0];
 	}
 
+	std::vector<DomNode> DomNode::select_nodes(const XPathExpression &xpath_expression) const
+	{
+		std::vector<DomNode> nodes;
+		xpath_expression.select_nodes(*this, nodes);
+		return nodes;
+	}
+
+	DomNode DomNode::select_node(const XPathExpression &xpath_expression) const
+	{
+		DomNode node = xpath_expression.select_node(*this);
+		if (node.is_null())
+			throw Exception(string_format("Xpath did not match any node: %1", xpath_expression.get_expression()));
+		return node;
+	}
+
 	std::string DomNode::select_string(const DomString &xpath_expression) const
 	{
 		DomNode node = select_node(xpath_expression);
@@ -764,7 +788,7 @@ namespace clan
 		if (node_index == cl_null_node_index)
 			return nullptr;
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *)owner_document.lock().get();
-		return doc_impl->nodes[node_index];
+		return doc_impl->get_tree_node(node_index);
 	}
 
 	const DomTreeNode *DomNode_Impl::get_tree_node() const
@@ -772,6 +796,6 @@ namespace clan
 		if (node_index == cl_null_node_index)
 			return nullptr;
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *)owner_document.lock().get();
-		return doc_impl->nodes[node_index];
+		return doc_impl->get_tree_node(node_index);
 	}
 }
@@ -28,7 +28,6 @@
 
 #pragma once
 
-#include "API/Core/System/block_allocator.h"
 #include "dom_document_generic.h"
 
 namespace clan
@@ -37,24 +36,23 @@ namespace clan
 
 	class DomDocument_Impl;
 
-	class DomTreeNode : public BlockAllocated
+	/// Node in the document tree. Names and namespace URIs are interned by the owner document and
+	/// the value is a range in its text arena, so a node is a small fixed size structure.
+	class DomTreeNode
 	{
 	public:
 		DomTreeNode()
-			: node_type(0), parent(cl_null_node_index), first_child(cl_null_node_index),
-			last_child(cl_null_node_index), previous_sibling(cl_null_node_index),
-			next_sibling(cl_null_node_index), first_attribute(cl_null_node_index)
+			: node_type(0), name_id(0), namespace_id(0), value_offset(0), value_length(0),
+			parent(cl_null_node_index), first_child(cl_null_node_index), last_child(cl_null_node_index),
+			previous_sibling(cl_null_node_index), next_sibling(cl_null_node_index), first_attribute(cl_null_node_index)
 		{
 		}
 
-		virtual ~DomTreeNode()
-		{
-		}
-
-		std::string node_name;
-		std::string node_value;
-		std::string namespace_uri;
 		unsigned short node_type;
+		unsigned int name_id;
+		unsigned int namespace_id;
+		unsigned int value_offset;
+		unsigned int value_length;
 		unsigned int parent;
 		unsigned int first_child;
 		unsigned int last_child;
@@ -62,108 +60,115 @@ namespace clan
 		unsigned int next_sibling;
 		unsigned int first_attribute;
 
-		void reset()
+		void reset(DomDocument_Impl *owner_document)
+		{
+			owner_document->free_text(value_offset, value_length);
+			*this = DomTreeNode();
+		}
+
+		const std::string &get_node_name(const DomDocument_Impl *owner_document) const
 		{
-			node_name.clear();
-			node_value.clear();
-			namespace_uri.clear();
-			node_type = 0;
-			parent = cl_null_node_index;
-			first_child = cl_null_node_index;
-			last_child = cl_null_node_index;
-			previous_sibling = cl_null_node_index;
-			next_sibling = cl_null_node_index;
-			first_attribute = cl_null_node_index;
+			return owner_document->get_string(name_id);
 		}
 
-		std::string get_node_name() const
+		std::string get_node_value(const DomDocument_Impl *owner_document) const
 		{
-			return node_name;
+			return std::string(owner_document->text.data() + value_offset, value_length);
 		}
 
-		std::string get_node_value() const
+		bool has_node_value(const DomDocument_Impl *owner_document, const std::string &value) const
 		{
-			return node_value;
+			return value.length() == value_length && memcmp(owner_document->text.data() + value_offset, value.data(), value_length) == 0;
 		}
 
-		std::string get_namespace_uri() const
+		const std::string &get_namespace_uri(const DomDocument_Impl *owner_document) const
 		{
-			return namespace_uri;
+			return owner_document->get_string(namespace_id);
 		}
 
 		void set_node_name(DomDocument_Impl *owner_document, const DomString &str)
 		{
-			node_name = str;
+			name_id = owner_document->intern_string(str);
 		}
 
 		void set_node_value(DomDocument_Impl *owner_document, const DomString &str)
 		{
-			node_value = str;
+			owner_document->set_text(value_offset, value_length, str.data(), str.length());
 		}
 
 		void set_namespace_uri(DomDocument_Impl *owner_document, const DomString &str)
 		{
-			namespace_uri = str;
+			namespace_id = owner_document->intern_string(str);
 		}
 
 		DomTreeNode *get_parent(DomDocument_Impl *owner_document)
 		{
-			return parent != cl_null_node_index ? owner_document->nodes[parent] : nullptr;
+			return parent != cl_null_node_index ? owner_document->get_tree_node(parent) : nullptr;
 		}
 
-		const DomTreeNode *get_parent(DomDocument_Impl *owner_document) const
+		const DomTreeNode *get_parent(const DomDocument_Impl *owner_document) const
 		{
-			return parent != cl_null_node_index ? owner_document->nodes[parent] : nullptr;
+			return parent != cl_null_node_index ? owner_document->get_tree_node(parent) : nullptr;
 		}
 
 		DomTreeNode *get_first_child(DomDocument_Impl *owner_document)
 		{
-			return first_child != cl_null_node_index ? owner_document->nodes[first_child] : nullptr;
+			return first_child != cl_null_node_index ? owner_document->get_tree_node(first_child) : nullptr;
 		}
 
-		const DomTreeNode *get_first_child(DomDocument_Impl *owner_document) const
+		const DomTreeNode *get_first_child(const DomDocument_Impl *owner_document) const
 		{
-			return first_child != cl_null_node_index ? owner_document->nodes[first_child] : nullptr;
+			return first_child != cl_null_node_index ? owner_document->get_tree_node(first_child) : nullptr;
 		}
 
 		DomTreeNode *get_last_child(DomDocument_Impl *owner_document)
 		{
-			return last_child != cl_null_node_index ? owner_document->nodes[last_child] : nullptr;
+			return last_child != cl_null_node_index ? owner_document->get_tree_node(last_child) : nullptr;
 		}
 
-		const DomTreeNode *get_last_child(DomDocument_Impl *owner_document) const
+		const DomTreeNode *get_last_child(const DomDocument_Impl *owner_document) const
 		{
-			return last_child != cl_null_node_index ? owner_document->nodes[last_child] : nullptr;
+			return last_child != cl_null_node_index ? owner_document->get_tree_node(last_child) : nullptr;
 		}
 
 		DomTreeNode *get_previous_sibling(DomDocument_Impl *owner_document)
 		{
-			return previous_sibling != cl_null_node_index ? owner_document->nodes[previous_sibling] : nullptr;
+			return previous_sibling != cl_null_node_index ? owner_document->get_tree_node(previous_sibling) : nullptr;
 		}
 
-		const DomTreeNode *get_previous_sibling(DomDocument_Impl *owner_document) const
+		const DomTreeNode *get_previous_sibling(const DomDocument_Impl *owner_document) const
 		{
-			return previous_sibling != cl_null_node_index ? owner_document->nodes[previous_sibling] : nullptr;
+			return previous_sibling != cl_null_node_index ? owner_document->get_tree_node(previous_sibling) : nullptr;
 		}
 
 		DomTreeNode *get_next_sibling(DomDocument_Impl *owner_document)
 		{
-			return next_sibling != cl_null_node_index ? owner_document->nodes[next_sibling] : nullptr;
+			return next_sibling != cl_null_node_index ? owner_document->get_tree_node(next_sibling) : nullptr;
 		}
 
-		const DomTreeNode *get_next_sibling(DomDocument_Impl *owner_document) const
+		const DomTreeNode *get_next_sibling(const DomDocument_Impl *owner_document) const
 		{
-			return next_sibling != cl_null_node_index ? owner_document->nodes[next_sibling] : nullptr;
+			return next_sibling != cl_null_node_index ? owner_document->get_tree_node(next_sibling) : nullptr;
 		}
 
 		DomTreeNode *get_first_attribute(DomDocument_Impl *owner_document)
 		{
-			return first_attribute != cl_null_node_index ? owner_document->nodes[first_attribute] : nullptr;
+			return first_attribute != cl_null_node_index ? owner_document->get_tree_node(first_attribute) : nullptr;
 		}
 
-		const DomTreeNode *get_first_attribute(DomDocument_Impl *owner_document) const
+		const DomTreeNode *get_first_attribute(const DomDocument_Impl *owner_document) const
 		{
-			return first_attribute != cl_null_node_index ? owner_document->nodes[first_attribute] : nullptr;
+			return first_attribute != cl_null_node_index ? owner_document->get_tree_node(first_attribute) : nullptr;
 		}
 	};
+
+	inline DomTreeNode *DomDocument_Impl::get_tree_node(unsigned int node_index)
+	{
+		return &node_blocks[node_index >> node_block_shift][node_index & (node_block_size - 1)];
+	}
+
+	inline const DomTreeNode *DomDocument_Impl::get_tree_node(unsigned int node_index) const
+	{
+		return &node_blocks[node_index >> node_block_shift][node_index & (node_block_size - 1)];
+	}
 }
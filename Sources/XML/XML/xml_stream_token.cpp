@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include "XML/precomp.h"
+#include "API/XML/xml_stream_token.h"
+
+namespace clan
+{
+	void XMLStringView::decode(std::string &text_out) const
+	{
+		text_out.clear();
+		if (!entities)
+		{
+			text_out.append(ptr, length);
+			return;
+		}
+
+		text_out.reserve(length);
+		const char *p = ptr;
+		const char *end = ptr + length;
+		while (p != end)
+		{
+			const char *amp = static_cast<const char*>(memchr(p, '&', end - p));
+			if (amp == nullptr)
+			{
+				text_out.append(p, end);
+				break;
+			}
+			text_out.append(p, amp);
+
+			size_t available = end - amp;
+			if (available >= 4 && memcmp(amp, "&lt;", 4) == 0)
+			{
+				text_out.push_back('<');
+				p = amp + 4;
+			}
+			else if (available >= 4 && memcmp(amp, "&gt;", 4) == 0)
+			{
+				text_out.push_back('>');
+				p = amp + 4;
+			}
+			else if (available >= 5 && memcmp(amp, "&amp;", 5) == 0)
+			{
+				text_out.push_back('&');
+				p = amp + 5;
+			}
+			else if (available >= 6 && memcmp(amp, "&quot;", 6) == 0)
+			{
+				text_out.push_back('"');
+				p = amp + 6;
+			}
+			else if (available >= 6 && memcmp(amp, "&apos;", 6) == 0)
+			{
+				text_out.push_back('\'');
+				p = amp + 6;
+			}
+			else
+			{
+				text_out.push_back('&');
+				p = amp + 1;
+			}
+		}
+	}
+
+	bool XMLStreamToken::has_attribute(const char *name) const
+	{
+		for (const auto &attribute : attributes)
+		{
+			if (attribute.first == name)
+				return true;
+		}
+		return false;
+	}
+
+	XMLStringView XMLStreamToken::get_attribute(const char *name) const
+	{
+		for (const auto &attribute : attributes)
+		{
+			if (attribute.first == name)
+				return attribute.second;
+		}
+		return XMLStringView();
+	}
+
+	void XMLStreamToken::to_token(XMLToken *out_token) const
+	{
+		out_token->type = type;
+		out_token->variant = variant;
+		out_token->name.assign(name.data(), name.size());
+		value.decode(out_token->value);
+
+		out_token->attributes.resize(attributes.size());
+		for (size_t i = 0; i < attributes.size(); i++)
+		{
+			out_token->attributes[i].first.assign(attributes[i].first.data(), attributes[i].first.size());
+			attributes[i].second.decode(out_token->attributes[i].second);
+		}
+	}
+}
@@ -0,0 +1,505 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include "XML/precomp.h"
+#include "API/XML/xml_stream_tokenizer.h"
+#include "API/XML/xml_stream_token.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Core/Text/string_help.h"
+#include "xml_stream_tokenizer_generic.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef CL_XML_SSE2_AVAILABLE
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace clan
+{
+	XMLStreamTokenizer::XMLStreamTokenizer()
+	{
+	}
+
+	XMLStreamTokenizer::XMLStreamTokenizer(IODevice &input, size_t chunk_size) : impl(std::make_shared<XMLStreamTokenizer_Impl>())
+	{
+		impl->input = input;
+		impl->chunk_size = std::max(chunk_size, (size_t)16);
+	}
+
+	XMLStreamTokenizer::~XMLStreamTokenizer()
+	{
+	}
+
+	bool XMLStreamTokenizer::get_eat_whitespace() const
+	{
+		return impl->eat_whitespace;
+	}
+
+	void XMLStreamTokenizer::set_eat_whitespace(bool enable)
+	{
+		impl->eat_whitespace = enable;
+	}
+
+	size_t XMLStreamTokenizer::get_bytes_read() const
+	{
+		return impl ? impl->bytes_read : 0;
+	}
+
+	int XMLStreamTokenizer::get_line_number() const
+	{
+		return impl ? impl->get_line_number(impl->buffer.data() + impl->pos) : 0;
+	}
+
+	void XMLStreamTokenizer::next(XMLStreamToken *out_token)
+	{
+		out_token->type = XMLToken::NULL_TOKEN;
+		out_token->variant = XMLToken::SINGLE;
+		out_token->name = XMLStringView();
+		out_token->value = XMLStringView();
+		out_token->attributes.clear();
+
+		if (!impl)
+			return;
+
+		while (true)
+		{
+			const char *data = impl->buffer.data();
+			const char *p = data + impl->pos;
+			const char *e = data + impl->end;
+
+			const char *token_end = nullptr;
+			if (p != e)
+				token_end = (*p == '<') ? impl->next_tag_node(p, e, out_token) : impl->next_text_node(p, e, out_token);
+
+			if (token_end)
+			{
+				impl->pos = token_end - data;
+				if (out_token->type != XMLToken::NULL_TOKEN)
+					return;
+			}
+			else if (impl->end_of_input)
+			{
+				if (p != e)
+					XMLStreamTokenizer_Impl::throw_exception("Premature end of XML data!");
+				return;
+			}
+			else
+			{
+				// The token continues past the end of the buffer. Parse it again once more data is available.
+				out_token->type = XMLToken::NULL_TOKEN;
+				out_token->variant = XMLToken::SINGLE;
+				out_token->attributes.clear();
+				impl->read_more();
+			}
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	void XMLStreamTokenizer_Impl::read_more()
+	{
+		if (pos > 0)
+		{
+			const char *data = buffer.data();
+			for (const char *p = data; (p = static_cast<const char*>(memchr(p, '\n', data + pos - p))) != nullptr; p++)
+				discarded_lines++;
+
+			memmove(buffer.data(), buffer.data() + pos, end - pos);
+			end -= pos;
+			pos = 0;
+		}
+
+		// Grow the buffer if the current token fills most of it
+		if (buffer.empty())
+			buffer.resize(chunk_size);
+		else if (buffer.size() - end < buffer.size() / 2)
+			buffer.resize(buffer.size() * 2);
+
+		size_t received = input.receive(buffer.data() + end, buffer.size() - end, false);
+		if (received == 0 || received > buffer.size() - end)
+		{
+			end_of_input = true;
+			return;
+		}
+
+		if (bytes_read == 0)
+		{
+			StringHelp::BOMType bom_type = StringHelp::detect_bom(buffer.data(), received);
+			switch (bom_type)
+			{
+			default:
+			case StringHelp::bom_none:
+				break;
+			case StringHelp::bom_utf32_be:
+			case StringHelp::bom_utf32_le:
+				throw Exception("UTF-32 XML files not supported yet");
+			case StringHelp::bom_utf16_be:
+			case StringHelp::bom_utf16_le:
+				throw Exception("UTF-16 XML files not supported yet");
+			case StringHelp::bom_utf8:
+				pos = 3;
+				break;
+			}
+		}
+
+		end += received;
+		bytes_read += received;
+	}
+
+	const char *XMLStreamTokenizer_Impl::next_text_node(const char *p, const char *e, XMLStreamToken *out_token)
+	{
+		bool entities = false;
+		const char *text_end = p;
+		while (true)
+		{
+			text_end = find_char(text_end, e, '<', '&', '<');
+			if (text_end == e || *text_end == '<')
+				break;
+			entities = true;
+			text_end++;
+		}
+
+		if (text_end == e && !end_of_input)
+			return nullptr;
+
+		const char *text_start = p;
+		const char *text_stop = text_end;
+		if (eat_whitespace)
+		{
+			trim_whitespace(text_start, text_stop);
+			if (text_start == text_stop)
+				return text_end;
+		}
+
+		out_token->type = XMLToken::TEXT_TOKEN;
+		out_token->value = XMLStringView(text_start, text_stop - text_start, entities);
+		return text_end;
+	}
+
+	const char *XMLStreamTokenizer_Impl::next_tag_node(const char *p, const char *e, XMLStreamToken *out_token)
+	{
+		p++;
+		if (p == e)
+			return nullptr;
+
+		// Try to early predict what sort of node it might be:
+		bool closing = (*p == '/');
+		bool question_mark = (*p == '?');
+		bool exclamation_mark = (*p == '!');
+
+		if (closing || question_mark || exclamation_mark)
+		{
+			p++;
+			if (p == e)
+				return nullptr;
+		}
+
+		if (exclamation_mark) // cdata section, comment or doctype
+			return next_exclamation_mark_node(p, e, out_token);
+
+		// Extract the tag name:
+		const char *name_start = p;
+		while (p != e && !is_whitespace(*p) && *p != '?' && *p != '/' && *p != '>')
+			p++;
+		if (p == e)
+			return nullptr;
+
+		out_token->type = question_mark ? XMLToken::PROCESSING_INSTRUCTION_TOKEN : XMLToken::ELEMENT_TOKEN;
+		out_token->variant = closing ? XMLToken::END : XMLToken::BEGIN;
+		out_token->name = XMLStringView(name_start, p - name_start);
+
+		if (question_mark)
+		{
+			p = skip_whitespace(p, e);
+			const char *value_end = find_char(p, e, '?', '?', '?');
+			if (value_end == e)
+				return nullptr;
+			out_token->value = XMLStringView(p, value_end - p);
+			p = value_end;
+		}
+		else
+		{
+			// Check for possible attributes:
+			while (true)
+			{
+				p = skip_whitespace(p, e);
+				if (p == e)
+					return nullptr;
+
+				// End of tag, stop searching for more attributes:
+				if (*p == '/' || *p == '?' || *p == '>')
+					break;
+
+				// Extract attribute name:
+				const char *attribute_name = p;
+				while (p != e && !is_whitespace(*p) && *p != '=')
+					p++;
+				if (p == e)
+					return nullptr;
+				XMLStringView name(attribute_name, p - attribute_name);
+
+				// Find separator:
+				p = skip_whitespace(p, e);
+				if (p == e)
+					return nullptr;
+				if (*p != '=')
+					throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(p), out_token->name.raw(), name.raw()));
+				p = skip_whitespace(p + 1, e);
+				if (p == e)
+					return nullptr;
+
+				// Extract attribute value:
+				bool entities = false;
+				const char *value_start;
+				const char *value_end;
+				if (*p == '"' || *p == '\'')
+				{
+					char quote = *p;
+					value_start = p + 1;
+					value_end = value_start;
+					while (true)
+					{
+						value_end = find_char(value_end, e, quote, '&', quote);
+						if (value_end == e || *value_end == quote)
+							break;
+						entities = true;
+						value_end++;
+					}
+					if (value_end == e)
+						return nullptr;
+					p = value_end + 1;
+				}
+				else
+				{
+					value_start = p;
+					while (p != e && !is_whitespace(*p) && *p != '>')
+					{
+						entities = entities || *p == '&';
+						p++;
+					}
+					if (p == e)
+						return nullptr;
+					value_end = p;
+				}
+
+				out_token->attributes.push_back(XMLStreamToken::Attribute(name, XMLStringView(value_start, value_end - value_start, entities)));
+			}
+		}
+
+		// Check if its singular:
+		if (*p == '/' || *p == '?')
+		{
+			out_token->variant = XMLToken::SINGLE;
+			p++;
+			if (p == e)
+				return nullptr;
+		}
+
+		// Data stream should be ending now.
+		if (*p != '>')
+			throw_exception(string_format("Error in XML stream, line %1 (expected end of tag)", get_line_number(p)));
+		return p + 1;
+	}
+
+	const char *XMLStreamTokenizer_Impl::next_exclamation_mark_node(const char *p, const char *e, XMLStreamToken *out_token)
+	{
+		if (e - p < 2)
+			return nullptr;
+
+		if (p[0] == '-' && p[1] == '-') // comment block
+		{
+			bool entities = false;
+			const char *text_start = p + 2;
+			const char *text_end = text_start;
+			while (true)
+			{
+				text_end = find_char(text_end, e, '-', '&', '-');
+				if (e - text_end < 3)
+					return nullptr;
+				if (*text_end == '-' && text_end[1] == '-' && text_end[2] == '>')
+					break;
+				entities = entities || *text_end == '&';
+				text_end++;
+			}
+			p = text_end + 3;
+
+			if (eat_whitespace)
+				trim_whitespace(text_start, text_end);
+
+			out_token->type = XMLToken::COMMENT_TOKEN;
+			out_token->variant = XMLToken::SINGLE;
+			out_token->value = XMLStringView(text_start, text_end - text_start, entities);
+			return p;
+		}
+
+		if (e - p < 7)
+			return nullptr;
+
+		if (memcmp(p, "DOCTYPE", 7) == 0)
+		{
+			return next_document_type_node(p + 7, e, out_token);
+		}
+		else if (memcmp(p, "[CDATA[", 7) == 0)
+		{
+			const char *value_start = p + 7;
+			const char *value_end = value_start;
+			while (true)
+			{
+				value_end = find_char(value_end, e, ']', ']', ']');
+				if (e - value_end < 3)
+					return nullptr;
+				if (value_end[1] == ']' && value_end[2] == '>')
+					break;
+				value_end++;
+			}
+
+			out_token->type = XMLToken::CDATA_SECTION_TOKEN;
+			out_token->variant = XMLToken::SINGLE;
+			out_token->value = XMLStringView(value_start, value_end - value_start);
+			return value_end + 3;
+		}
+		else
+		{
+			throw_exception(string_format("Error in XML stream, line %1", get_line_number(p)));
+			return nullptr;
+		}
+	}
+
+	const char *XMLStreamTokenizer_Impl::next_document_type_node(const char *p, const char *e, XMLStreamToken *out_token)
+	{
+		// Find doctype name:
+		p = skip_whitespace(p, e);
+		const char *name_start = p;
+		while (p != e && !is_whitespace(*p) && *p != '[' && *p != '>')
+			p++;
+		if (p == e)
+			return nullptr;
+		XMLStringView name(name_start, p - name_start);
+
+		// Skip the external id and internal subset. Quoted literals may contain any character.
+		bool in_subset = false;
+		char quote = 0;
+		while (true)
+		{
+			if (p == e)
+				return nullptr;
+
+			if (quote)
+			{
+				if (*p == quote)
+					quote = 0;
+			}
+			else if (*p == '"' || *p == '\'')
+			{
+				quote = *p;
+			}
+			else if (*p == '[')
+			{
+				in_subset = true;
+			}
+			else if (*p == ']')
+			{
+				in_subset = false;
+			}
+			else if (*p == '>' && !in_subset)
+			{
+				break;
+			}
+			p++;
+		}
+
+		out_token->type = XMLToken::DOCUMENT_TYPE_TOKEN;
+		out_token->variant = XMLToken::SINGLE;
+		out_token->name = name;
+		return p + 1;
+	}
+
+	int XMLStreamTokenizer_Impl::get_line_number(const char *p) const
+	{
+		int line = discarded_lines + 1;
+		for (const char *data = buffer.data(); data != p; data++)
+		{
+			if (*data == '\n')
+				line++;
+		}
+		return line;
+	}
+
+	void XMLStreamTokenizer_Impl::throw_exception(const std::string &str)
+	{
+		throw Exception(str);
+	}
+
+	const char *XMLStreamTokenizer_Impl::find_char(const char *p, const char *e, char c1, char c2, char c3)
+	{
+#ifdef CL_XML_SSE2_AVAILABLE
+		const __m128i m1 = _mm_set1_epi8(c1);
+		const __m128i m2 = _mm_set1_epi8(c2);
+		const __m128i m3 = _mm_set1_epi8(c3);
+		while (e - p >= 16)
+		{
+			__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			__m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, m1), _mm_cmpeq_epi8(chars, m2)), _mm_cmpeq_epi8(chars, m3));
+			unsigned int mask = _mm_movemask_epi8(found);
+			if (mask)
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return p + index;
+#else
+				return p + __builtin_ctz(mask);
+#endif
+			}
+			p += 16;
+		}
+#endif
+		while (p != e && *p != c1 && *p != c2 && *p != c3)
+			p++;
+		return p;
+	}
+
+	const char *XMLStreamTokenizer_Impl::skip_whitespace(const char *p, const char *e)
+	{
+		while (p != e && is_whitespace(*p))
+			p++;
+		return p;
+	}
+
+	void XMLStreamTokenizer_Impl::trim_whitespace(const char *&p, const char *&e)
+	{
+		while (p != e && is_whitespace(*p))
+			p++;
+		while (p != e && is_whitespace(e[-1]))
+			e--;
+	}
+}
@@ -0,0 +1,81 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/System/cl_platform.h"
+#include <vector>
+
+#if !defined(CL_DISABLE_SSE2) && !defined(__ANDROID__) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CL_XML_SSE2_AVAILABLE
+#endif
+
+namespace clan
+{
+	class XMLStreamToken;
+
+	class XMLStreamTokenizer_Impl
+	{
+	public:
+		XMLStreamTokenizer_Impl() : chunk_size(64 * 1024), pos(0), end(0), end_of_input(false), eat_whitespace(true), bytes_read(0), discarded_lines(0) { }
+
+		IODevice input;
+		std::vector<char> buffer;
+		size_t chunk_size;
+
+		// Unparsed data is buffer[pos, end)
+		size_t pos, end;
+		bool end_of_input;
+		bool eat_whitespace;
+		size_t bytes_read;
+
+		// Line breaks in the data discarded from the start of the buffer
+		int discarded_lines;
+
+		// Discards the parsed data and appends the next chunk from the input device
+		void read_more();
+
+		// The parse functions return where the token ended, or nullptr if the buffer ends first
+		const char *next_text_node(const char *p, const char *e, XMLStreamToken *out_token);
+		const char *next_tag_node(const char *p, const char *e, XMLStreamToken *out_token);
+		const char *next_exclamation_mark_node(const char *p, const char *e, XMLStreamToken *out_token);
+		const char *next_document_type_node(const char *p, const char *e, XMLStreamToken *out_token);
+
+		int get_line_number(const char *p) const;
+		static void throw_exception(const std::string &str);
+
+		// Returns the first occurrence of any of the three characters, or e if none is found
+		static const char *find_char(const char *p, const char *e, char c1, char c2, char c3);
+
+		static const char *skip_whitespace(const char *p, const char *e);
+		static void trim_whitespace(const char *&p, const char *&e);
+		static bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+	};
+}
@@ -32,7 +32,7 @@
 #include "API/XML/xpath_exception.h"
 #include "API/XML/dom_node.h"
 #include "xpath_evaluator_impl.h"
-#include "xpath_token.h"
+#include "xpath_expression_impl.h"
 
 namespace clan
 {
@@ -43,11 +43,17 @@ namespace clan
 
 	XPathObject XPathEvaluator::evaluate(const std::string &expression, const DomNode &context_node) const
 	{
-		XPathToken prev_token;
-		std::vector<DomNode> nodelist(1, context_node);
-		XPathEvaluateResult result = impl->evaluate(expression, nodelist, 0, prev_token);
-		if (result.next_token.type != XPathToken::type_none)
-			throw XPathException("Expected end of expression", expression, result.next_token);
-		return result.result;
+		return impl->evaluate(*XPathExpressionCache::get(expression), context_node);
+	}
+
+	XPathObject XPathEvaluator::evaluate(const XPathExpression &expression, const DomNode &context_node) const
+	{
+		expression.throw_if_null();
+		return impl->evaluate(*expression.impl, context_node);
+	}
+
+	XPathExpression XPathEvaluator::compile(const std::string &expression) const
+	{
+		return XPathExpression(XPathExpressionCache::get(expression));
 	}
 }
@@ -40,503 +40,681 @@
 #include "xpath_evaluator_impl.h"
 #include "xpath_token.h"
 #include "xpath_location_step.h"
+#include "xpath_expression_impl.h"
+#include "dom_document_generic.h"
+#include "dom_tree_node.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace clan
 {
-	XPathEvaluateResult XPathEvaluator_Impl::evaluate(
-		const std::string &expression,
-		const XPathNodeSet &context,
-		XPathNodeSet::size_type context_node_index,
-		XPathToken prev_token) const
+	std::shared_ptr<XPathExpression_Impl> XPathEvaluator_Impl::compile(const std::string &expression_text) const
+	{
+		auto expression = std::make_shared<XPathExpression_Impl>();
+		expression->expression = expression_text;
+
+		XPathToken token = read_token(expression->expression);
+		expression->root = parse_expression(*expression, token);
+		if (token.type != XPathToken::type_none)
+			throw XPathException("Expected end of expression", expression->expression, token);
+
+		return expression;
+	}
+
+	XPathObject XPathEvaluator_Impl::evaluate(const XPathExpression_Impl &expression, const DomNode &context_node) const
 	{
-		std::vector<Operator> operator_stack;
-		std::vector<Operand> operand_stack;
+		XPathNodeSet context(1, context_node);
+		return evaluate(expression, expression.root, context, 0);
+	}
 
-		int parenthesis_count = 0;
-		XPathToken cur_token;
+	void XPathEvaluator_Impl::select_nodes(const XPathExpression_Impl &expression, const DomNode &context_node, XPathNodeSet &out_nodes) const
+	{
+		const XPathExpressionNode &root = expression.nodes[expression.root];
+		if (root.fast && select_tree_nodes(root, context_node, out_nodes))
+			return;
 
+		XPathNodeSet context(1, context_node);
+		select_nodes(expression, expression.root, context, 0, out_nodes);
+	}
+
+	int XPathEvaluator_Impl::parse_expression(XPathExpression_Impl &expression, XPathToken &token, int min_precedence) const
+	{
+	/*
+		[21] OrExpr                    ::= AndExpr | OrExpr 'or' AndExpr
+		[22] AndExpr                   ::= EqualityExpr | AndExpr 'and' EqualityExpr
+		[23] EqualityExpr              ::= RelationalExpr | EqualityExpr '=' RelationalExpr
+										   | EqualityExpr '!=' RelationalExpr
+		[24] RelationalExpr            ::= AdditiveExpr | RelationalExpr '<' AdditiveExpr
+										   | RelationalExpr '>' AdditiveExpr
+										   | RelationalExpr '<=' AdditiveExpr
+										   | RelationalExpr '>=' AdditiveExpr
+		[25] AdditiveExpr              ::= MultiplicativeExpr | AdditiveExpr '+' MultiplicativeExpr
+										   | AdditiveExpr '-' MultiplicativeExpr
+		[26] MultiplicativeExpr        ::= UnaryExpr | MultiplicativeExpr MultiplyOperator UnaryExpr
+										   | MultiplicativeExpr 'div' UnaryExpr
+										   | MultiplicativeExpr 'mod' UnaryExpr
+	*/
+		int left = parse_unary_expression(expression, token);
 		while (true)
 		{
-			cur_token = read_token(expression, prev_token);
+			int precedence = get_precedence(token);
+			if (precedence == 0 || precedence < min_precedence)
+				return left;
 
-			bool end_parenthesis = (
-				cur_token.type == XPathToken::type_operator &&
-				cur_token.value.oper == XPathToken::operator_parenthesis_end &&
-				parenthesis_count == 0);
+			XPathExpressionNode node(XPathExpressionNode::type_operator);
+			node.oper = token.value.oper;
+			token = read_token(expression.expression, token);
+			node.operands.push_back(left);
+			node.operands.push_back(parse_expression(expression, token, precedence + 1));
+			left = add_node(expression, node);
+		}
+	}
 
-			if (cur_token.type == XPathToken::type_none ||
-				cur_token.type == XPathToken::type_comma ||
-				cur_token.type == XPathToken::type_bracket_end ||
-				end_parenthesis)
-				break;
+	int XPathEvaluator_Impl::parse_unary_expression(XPathExpression_Impl &expression, XPathToken &token) const
+	{
+	/*
+		[27] UnaryExpr                 ::= UnionExpr | '-' UnaryExpr
+	*/
+		if (is_operator(token, XPathToken::operator_minus))
+		{
+			token = read_token(expression.expression, token);
+			XPathExpressionNode node(XPathExpressionNode::type_negate);
+			node.operands.push_back(parse_unary_expression(expression, token));
+			return add_node(expression, node);
+		}
+		return parse_union_expression(expression, token);
+	}
 
-			// Check if its a location path:
-			if (cur_token.type == XPathToken::type_axis_name ||
-				cur_token.type == XPathToken::type_name_test ||
-				cur_token.type == XPathToken::type_at_sign ||
-				cur_token.type == XPathToken::type_dot ||
-				cur_token.type == XPathToken::type_double_dot ||
-				cur_token.type == XPathToken::type_node_type ||
-				(cur_token.type == XPathToken::type_operator &&
-					(cur_token.value.oper == XPathToken::operator_slash ||
-					cur_token.value.oper == XPathToken::operator_double_slash)))
-			{
-				prev_token = read_location_path(expression, cur_token, context, context_node_index, operand_stack);
-				continue;
-			}
+	int XPathEvaluator_Impl::parse_union_expression(XPathExpression_Impl &expression, XPathToken &token) const
+	{
+	/*
+		[18] UnionExpr                 ::= PathExpr | UnionExpr '|' PathExpr
+	*/
+		int left = parse_path_expression(expression, token);
+		while (is_operator(token, XPathToken::operator_union))
+		{
+			token = read_token(expression.expression, token);
+			XPathExpressionNode node(XPathExpressionNode::type_operator);
+			node.oper = XPathToken::operator_union;
+			node.operands.push_back(left);
+			node.operands.push_back(parse_path_expression(expression, token));
+			left = add_node(expression, node);
+		}
+		return left;
+	}
 
-			// Evaluate expression:
+	int XPathEvaluator_Impl::parse_path_expression(XPathExpression_Impl &expression, XPathToken &token) const
+	{
+	/*
+		[1]  LocationPath              ::= RelativeLocationPath | AbsoluteLocationPath
+		[2]  AbsoluteLocationPath      ::= '/' RelativeLocationPath? | AbbreviatedAbsoluteLocationPath
+		[19] PathExpr                  ::= LocationPath | FilterExpr
+										   | FilterExpr '/' RelativeLocationPath
+										   | FilterExpr '//' RelativeLocationPath
+		[20] FilterExpr                ::= PrimaryExpr | FilterExpr Predicate
+	*/
+		bool slash = is_operator(token, XPathToken::operator_slash);
+		bool double_slash = is_operator(token, XPathToken::operator_double_slash);
 
-			if (cur_token.type == XPathToken::type_literal)
-			{
-				operand_stack.push_back(XPathObject(cur_token.value.str));
-			}
-			else if (cur_token.type == XPathToken::type_variable_reference)
+		if (slash || double_slash || is_location_step(token))
+		{
+			XPathExpressionNode node(XPathExpressionNode::type_location_path);
+			node.absolute = slash || double_slash;
+			if (slash)
+				token = read_token(expression.expression, token);
+
+			if (double_slash || is_location_step(token))
+				parse_location_steps(expression, token, node.steps);
+			optimize_location_steps(expression, node.steps);
+
+			node.fast = true;
+			for (const auto &step : node.steps)
+				node.fast = node.fast && step.fast;
+
+			return add_node(expression, node);
+		}
+
+		int primary = parse_primary_expression(expression, token);
+
+		slash = is_operator(token, XPathToken::operator_slash);
+		double_slash = is_operator(token, XPathToken::operator_double_slash);
+		if (token.type != XPathToken::type_bracket_begin && !slash && !double_slash)
+			return primary;
+
+		XPathExpressionNode node(XPathExpressionNode::type_filter);
+		node.operands.push_back(primary);
+		while (token.type == XPathToken::type_bracket_begin)
+			node.predicates.push_back(parse_predicate(expression, token));
+
+		slash = is_operator(token, XPathToken::operator_slash);
+		double_slash = is_operator(token, XPathToken::operator_double_slash);
+		if (slash || double_slash)
+		{
+			if (slash)
+				token = read_token(expression.expression, token);
+			parse_location_steps(expression, token, node.steps);
+			optimize_location_steps(expression, node.steps);
+		}
+
+		return add_node(expression, node);
+	}
+
+	int XPathEvaluator_Impl::parse_primary_expression(XPathExpression_Impl &expression, XPathToken &token) const
+	{
+	/*
+		[15] PrimaryExpr               ::= VariableReference | '(' Expr ')' | Literal | Number | FunctionCall
+		[16] FunctionCall              ::= FunctionName '(' ( Argument ( ',' Argument )* )? ')'
+	*/
+		if (token.type == XPathToken::type_literal)
+		{
+			XPathExpressionNode node(XPathExpressionNode::type_constant);
+			node.value = XPathObject(token.value.str);
+			token = read_token(expression.expression, token);
+			return add_node(expression, node);
+		}
+		else if (token.type == XPathToken::type_number)
+		{
+			XPathExpressionNode node(XPathExpressionNode::type_constant);
+			node.value = XPathObject(StringHelp::text_to_double(token.value.str));
+			token = read_token(expression.expression, token);
+			return add_node(expression, node);
+		}
+		else if (token.type == XPathToken::type_variable_reference)
+		{
+			XPathExpressionNode node(XPathExpressionNode::type_variable);
+			node.name = token.value.str;
+			token = read_token(expression.expression, token);
+			return add_node(expression, node);
+		}
+		else if (token.type == XPathToken::type_function_name)
+		{
+			XPathExpressionNode node(XPathExpressionNode::type_function);
+			node.name = token.value.str;
+			node.function = find_function(node.name);
+			if (node.function == nullptr)
+				throw XPathException(string_format("Unknown function '%1'", node.name), expression.expression, token);
+
+			token = read_token(expression.expression, token);
+			if (!is_operator(token, XPathToken::operator_parenthesis_begin))
+				throw XPathException("Expected '(' after function name", expression.expression, token);
+
+			token = read_token(expression.expression, token);
+			while (!is_operator(token, XPathToken::operator_parenthesis_end))
 			{
-				operand_stack.push_back(XPathObject(get_variable(cur_token.value.str)));
+				node.operands.push_back(parse_expression(expression, token));
+				if (token.type == XPathToken::type_comma)
+					token = read_token(expression.expression, token);
+				else if (!is_operator(token, XPathToken::operator_parenthesis_end))
+					throw XPathException("Expected ',' or ')' in function call", expression.expression, token);
 			}
-			else if (cur_token.type == XPathToken::type_number)
+			token = read_token(expression.expression, token);
+			return add_node(expression, node);
+		}
+		else if (is_operator(token, XPathToken::operator_parenthesis_begin))
+		{
+			token = read_token(expression.expression, token);
+			int node_index = parse_expression(expression, token);
+			if (!is_operator(token, XPathToken::operator_parenthesis_end))
+				throw XPathException("Missing matching ')' in expression", expression.expression, token);
+			token = read_token(expression.expression, token);
+			return node_index;
+		}
+		else if (token.type == XPathToken::type_none)
+		{
+			throw XPathException("Expected operand", expression.expression, token);
+		}
+		else
+		{
+			throw XPathException("Unexpected token", expression.expression, token);
+		}
+	}
+
+	int XPathEvaluator_Impl::parse_predicate(XPathExpression_Impl &expression, XPathToken &token) const
+	{
+	/*
+		[8]  Predicate                 ::= '[' PredicateExpr ']'
+		[9]  PredicateExpr             ::= Expr
+	*/
+		token = read_token(expression.expression, token);
+		int node_index = parse_expression(expression, token);
+		if (token.type != XPathToken::type_bracket_end)
+			throw XPathException("Missing matching ']' in expression", expression.expression, token);
+		token = read_token(expression.expression, token);
+		return node_index;
+	}
+
+	void XPathEvaluator_Impl::parse_location_steps(XPathExpression_Impl &expression, XPathToken &token, std::vector<XPathLocationStep> &steps) const
+	{
+	/*
+		[3]  RelativeLocationPath      ::= Step | RelativeLocationPath '/' Step | AbbreviatedRelativeLocationPath
+		[10] AbbreviatedAbsoluteLocationPath ::= '//' RelativeLocationPath
+		[11] AbbreviatedRelativeLocationPath ::= RelativeLocationPath '//' Step
+	*/
+		while (true)
+		{
+			if (is_operator(token, XPathToken::operator_double_slash))
 			{
-				operand_stack.push_back(XPathObject(StringHelp::text_to_double(cur_token.value.str)));
+				XPathLocationStep step;
+				step.axis = XPathLocationStep::axis_descendant_or_self;
+				step.test_type = XPathLocationStep::type_node;
+				step.node_type = XPathToken::node_type_node;
+				steps.push_back(step);
+				token = read_token(expression.expression, token);
 			}
-			else if (cur_token.type == XPathToken::type_function_name)
-			{
-				std::string function_name = cur_token.value.str;
-				cur_token = read_token(expression, cur_token);
-				if (cur_token.type != XPathToken::type_operator ||
-					cur_token.value.oper != XPathToken::operator_parenthesis_begin)
-				{
-					throw XPathException("Expected '(' after function name", expression, cur_token);
-				}
 
-				std::vector<XPathObject> parameters;
-				while (true)
-				{
-					XPathEvaluateResult result = evaluate(expression, context, context_node_index, cur_token);
-					if (!result.result.is_null())
-						parameters.push_back(result.result);
+			if (!is_location_step(token))
+				throw XPathException("Expected location step", expression.expression, token);
 
-					cur_token = result.next_token;
-					if (cur_token.type == XPathToken::type_operator &&
-						cur_token.value.oper == XPathToken::operator_parenthesis_end)
-						break;
-					if (cur_token.type != XPathToken::type_comma)
-						throw XPathException("Expected ',' or ')' in function call", expression, cur_token);
-				}
+			XPathLocationStep step;
+			parse_location_step(expression, token, step);
+			steps.push_back(step);
 
-				XPathObject obj = call_function(context, context_node_index, function_name, parameters);
-				operand_stack.push_back(obj);
-			}
-			else if (cur_token.type == XPathToken::type_bracket_begin)
-			{
-				if (operand_stack.empty())
-					throw XPathException("Missing operand before predicate", expression, cur_token);
+			if (is_operator(token, XPathToken::operator_slash))
+				token = read_token(expression.expression, token);
+			else if (!is_operator(token, XPathToken::operator_double_slash))
+				break;
+		}
+	}
 
-				Operand cur_operand = operand_stack.back();
-				operand_stack.pop_back();
-				if (cur_operand.get_type() != XPathObject::type_node_set)
-					throw XPathException("Expected node-set operand before '['", expression, cur_token);
+	void XPathEvaluator_Impl::parse_location_step(XPathExpression_Impl &expression, XPathToken &token, XPathLocationStep &step) const
+	{
+	/*
+		Location Steps
+		[4]  Step                      ::= AxisSpecifier NodeTest Predicate* | AbbreviatedStep
 
-				XPathToken end_token = cur_token;
-				while (end_token.type != XPathToken::type_bracket_end && end_token.type != XPathToken::type_none)
-					end_token = read_token(expression, end_token);
+		[5]  AxisSpecifier             ::= AxisName '::'	| AbbreviatedAxisSpecifier
+		[6]  AxisName                  ::= 'ancestor' | 'ancestor-or-self' | 'attribute' | 'child'
+										   | 'descendant' | 'descendant-or-self' | 'following'
+										   | 'following-sibling' | 'namespace' | 'parent'
+										   | 'preceding' | 'preceding-sibling' | 'self'	
+		[13] AbbreviatedAxisSpecifier  ::= '@'?
 
-				if (end_token.type == XPathToken::type_none)
-					throw XPathException("Missing matching ']' in expression", expression, cur_token);
+		[7]  NodeTest                  ::= NameTest	
+										   | NodeType '(' ')'	
+										   | 'processing-instruction' '(' Literal ')'	
+		[37] NameTest                  ::= '*' | NCName ':' '*' | QName	
+		[38] NodeType                  ::= 'comment' | 'text' | 'processing-instruction' | 'node'
 
-				XPathLocationStep::Predicate predicate;
-				predicate.pos = cur_token.pos + cur_token.length;
-				predicate.length = end_token.pos - predicate.pos;
+		[12] AbbreviatedStep           ::= '.' | '..'
+	*/
+		if (token.type == XPathToken::type_dot || token.type == XPathToken::type_double_dot)
+		{
+			step.axis = (token.type == XPathToken::type_dot) ? XPathLocationStep::axis_self : XPathLocationStep::axis_parent;
+			step.test_type = XPathLocationStep::type_node;
+			step.node_type = XPathToken::node_type_node;
+			token = read_token(expression.expression, token);
+			return;
+		}
+
+		// Read AxisSpecifier:
+		if (token.type == XPathToken::type_axis_name)
+		{
+			const std::string &axis = token.value.str;
+			if (axis == "ancestor")
+				step.axis = XPathLocationStep::axis_ancestor;
+			else if (axis == "ancestor-or-self")
+				step.axis = XPathLocationStep::axis_ancestor_or_self;
+			else if (axis == "attribute")
+				step.axis = XPathLocationStep::axis_attribute;
+			else if (axis == "child")
+				step.axis = XPathLocationStep::axis_child;
+			else if (axis == "descendant")
+				step.axis = XPathLocationStep::axis_descendant;
+			else if (axis == "descendant-or-self")
+				step.axis = XPathLocationStep::axis_descendant_or_self;
+			else if (axis == "following")
+				step.axis = XPathLocationStep::axis_following;
+			else if (axis == "following-sibling")
+				step.axis = XPathLocationStep::axis_following_sibling;
+			else if (axis == "namespace")
+				step.axis = XPathLocationStep::axis_namespace;
+			else if (axis == "parent")
+				step.axis = XPathLocationStep::axis_parent;
+			else if (axis == "preceding")
+				step.axis = XPathLocationStep::axis_preceding;
+			else if (axis == "preceding-sibling")
+				step.axis = XPathLocationStep::axis_preceding_sibling;
+			else if (axis == "self")
+				step.axis = XPathLocationStep::axis_self;
+			else
+				throw XPathException(string_format("Unknown location step axis '%1'", axis), expression.expression, token);
 
-				XPathNodeSet filtered_nodes;
-				XPathNodeSet nodes = cur_operand.get_node_set();
-				for (XPathNodeSet::size_type node_index = 0, num_nodes = nodes.size(); node_index < num_nodes; node_index++)
-				{
-					if (confirm_step_predicate(nodes, node_index, predicate, expression))
-						filtered_nodes.push_back(nodes[node_index]);
-				}
+			token = read_token(expression.expression, token);
+			if (token.type != XPathToken::type_double_colon)
+				throw XPathException("Expected '::' after axis name", expression.expression, token);
+			token = read_token(expression.expression, token);
+		}
+		else if (token.type == XPathToken::type_at_sign) // Abbreviated axis specifier
+		{
+			step.axis = XPathLocationStep::axis_attribute;
+			token = read_token(expression.expression, token);
+		}
+		else // Abbreviated syntax
+		{
+			step.axis = XPathLocationStep::axis_child;
+		}
 
-				cur_token = read_token(expression, end_token);
-				XPathToken next_token = read_token(expression, cur_token);
-				if (!filtered_nodes.empty() &&
-					(next_token.type == XPathToken::type_axis_name ||
-					next_token.type == XPathToken::type_name_test ||
-					next_token.type == XPathToken::type_node_type ||
-					next_token.type == XPathToken::type_at_sign ||
-					next_token.type == XPathToken::type_dot ||
-					next_token.type == XPathToken::type_double_dot ||
-					(next_token.type == XPathToken::type_operator && next_token.value.oper == XPathToken::operator_double_slash)))
-				{
-					cur_token = read_location_steps(expression, next_token, filtered_nodes, 0, operand_stack);
-				}
-				else
-				{
-					operand_stack.push_back(XPathObject(filtered_nodes));
-				}
-			}
-			else if (cur_token.type == XPathToken::type_operator)
+		// Read Node Test:
+		if (token.type == XPathToken::type_name_test)
+		{
+			step.test_type = XPathLocationStep::type_name;
+			step.test_str = token.value.str;
+		}
+		else if (token.type == XPathToken::type_node_type)
+		{
+			step.test_type = XPathLocationStep::type_node;
+			step.node_type = token.value.node_type;
+			token = read_token(expression.expression, token);
+			if (!is_operator(token, XPathToken::operator_parenthesis_begin))
+				throw XPathException("Expected '(' after node-type test", expression.expression, token);
+			token = read_token(expression.expression, token);
+			if (token.type == XPathToken::type_literal && step.node_type == XPathToken::node_type_processing_instruction)
 			{
-				Operator previous = operator_stack.empty() ? XPathToken::operator_parenthesis_begin : operator_stack.back();
-				Operator cur_operator = cur_token.value.oper;
-				if (cur_operator == XPathToken::operator_parenthesis_begin)
-				{
-					parenthesis_count++;
-				}
-				else if (cur_operator == XPathToken::operator_parenthesis_end)
-				{
-					parenthesis_count--;
-					while(do_npr(operator_stack, operand_stack));
-				}
+				step.test_str = token.value.str;
+				token = read_token(expression.expression, token);
+			}
+			if (!is_operator(token, XPathToken::operator_parenthesis_end))
+				throw XPathException("Expected ')' after node-type test", expression.expression, token);
+		}
+		else
+		{
+			throw XPathException("Unknown node test type", expression.expression, token);
+		}
+		token = read_token(expression.expression, token);
 
-				if (previous < cur_operator)
-					do_npr(operator_stack, operand_stack);
+		while (token.type == XPathToken::type_bracket_begin)
+			step.predicates.push_back(parse_predicate(expression, token));
+	}
 
-				if (cur_operator != XPathToken::operator_parenthesis_end)
-					operator_stack.push_back(cur_operator);
+	void XPathEvaluator_Impl::optimize_location_steps(const XPathExpression_Impl &expression, std::vector<XPathLocationStep> &steps) const
+	{
+		for (auto &step : steps)
+		{
+			step.fast =
+				step.axis == XPathLocationStep::axis_child ||
+				step.axis == XPathLocationStep::axis_attribute ||
+				step.axis == XPathLocationStep::axis_descendant ||
+				step.axis == XPathLocationStep::axis_descendant_or_self ||
+				step.axis == XPathLocationStep::axis_self;
+
+			step.fast_predicates.clear();
+			for (size_t i = 0; step.fast && i < step.predicates.size(); i++)
+			{
+				XPathLocationStep::FastPredicate fast_predicate;
+				step.fast = get_fast_predicate(expression, step.predicates[i], fast_predicate);
+				if (step.fast)
+					step.fast_predicates.push_back(fast_predicate);
 			}
-			else
+		}
+
+		// '//name' is short for '/descendant-or-self::node()/child::name'. This selects the
+		// same nodes as '/descendant::name', unless a predicate depends on the position.
+		for (size_t i = 0; i + 1 < steps.size(); i++)
+		{
+			const XPathLocationStep &step = steps[i];
+			XPathLocationStep &next_step = steps[i + 1];
+			if (step.axis != XPathLocationStep::axis_descendant_or_self || step.test_type != XPathLocationStep::type_node ||
+				step.node_type != XPathToken::node_type_node || !step.predicates.empty() ||
+				next_step.axis != XPathLocationStep::axis_child || !next_step.fast)
+				continue;
+
+			bool positional = false;
+			for (const auto &fast_predicate : next_step.fast_predicates)
+				positional = positional || fast_predicate.type == XPathLocationStep::FastPredicate::type_position;
+
+			if (!positional)
 			{
-				throw XPathException("Unexpected token", expression, cur_token);
+				next_step.axis = XPathLocationStep::axis_descendant;
+				steps.erase(steps.begin() + i);
 			}
+		}
+	}
 
-			prev_token = cur_token;
+	bool XPathEvaluator_Impl::get_fast_predicate(const XPathExpression_Impl &expression, int predicate, XPathLocationStep::FastPredicate &fast_predicate) const
+	{
+		const XPathExpressionNode &node = expression.nodes[predicate];
+
+		// [2]
+		if (node.type == XPathExpressionNode::type_constant && node.value.get_type() == XPathObject::type_number)
+		{
+			double position = node.value.get_number();
+			if (position < 1.0 || position != std::floor(position))
+				return false;
+
+			fast_predicate.type = XPathLocationStep::FastPredicate::type_position;
+			fast_predicate.position = (size_t)position;
+			return true;
 		}
 
-		while (do_npr(operator_stack, operand_stack));
+		// [@name]
+		if (get_attribute_name(expression, predicate, fast_predicate.name))
+		{
+			fast_predicate.type = XPathLocationStep::FastPredicate::type_attribute;
+			return true;
+		}
 
-		// Allow empty expression between parenthesis (for supporting functions that take no parameters)
-		if (operand_stack.empty() &&
-				!(prev_token.type == XPathToken::type_operator &&
-				prev_token.value.oper == XPathToken::operator_parenthesis_begin &&
-				cur_token.type == XPathToken::type_operator &&
-				cur_token.value.oper == XPathToken::operator_parenthesis_end))
+		// [@name='value'] or ['value'=@name]
+		if (node.type == XPathExpressionNode::type_operator && node.oper == XPathToken::operator_compare_equal)
 		{
-			throw XPathException("Expected operand", expression, cur_token);
+			for (int side = 0; side < 2; side++)
+			{
+				const XPathExpressionNode &value = expression.nodes[node.operands[1 - side]];
+				if (value.type == XPathExpressionNode::type_constant && value.value.get_type() == XPathObject::type_string &&
+					get_attribute_name(expression, node.operands[side], fast_predicate.name))
+				{
+					fast_predicate.type = XPathLocationStep::FastPredicate::type_attribute_equal;
+					fast_predicate.value = value.value.get_string();
+					return true;
+				}
+			}
 		}
 
-		XPathEvaluateResult result;
-		result.result = operand_stack.empty() ? XPathObject() : operand_stack.back();
-		result.next_token = cur_token;
-		return result;
+		return false;
+	}
+
+	bool XPathEvaluator_Impl::get_attribute_name(const XPathExpression_Impl &expression, int node_index, std::string &name) const
+	{
+		const XPathExpressionNode &node = expression.nodes[node_index];
+		if (node.type != XPathExpressionNode::type_location_path || node.absolute || node.steps.size() != 1)
+			return false;
+
+		const XPathLocationStep &step = node.steps.front();
+		if (step.axis != XPathLocationStep::axis_attribute || step.test_type != XPathLocationStep::type_name || step.test_str == "*" || !step.predicates.empty())
+			return false;
+
+		name = step.test_str;
+		return true;
 	}
 
-	XPathObject XPathEvaluator_Impl::call_function(const XPathNodeSet& context, XPathNodeSet::size_type context_node_index, const std::string &name, const std::vector<XPathObject> &parameters) const
+	XPathFunction XPathEvaluator_Impl::find_function(const std::string &name) const
 	{
 		if (name == "last")
-			return function_last(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_last;
 		else if (name == "position")
-			return function_position(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_position;
 		else if (name == "count")
-			return function_count(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_count;
 		else if (name == "id")
-			return function_id(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_id;
 		else if (name == "local-name")
-			return function_local_name(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_local_name;
 		else if (name == "namespace-uri")
-			return function_namespace_uri(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_namespace_uri;
 		else if (name == "name")
-			return function_name(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_name;
 		else if (name == "string")
-			return function_string(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_string;
 		else if (name == "concat")
-			return function_concat(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_concat;
 		else if (name == "starts-with")
-			return function_starts_with(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_starts_with;
 		else if (name == "contains")
-			return function_contains(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_contains;
 		else if (name == "substring-before")
-			return function_substring_before(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_substring_before;
 		else if (name == "substring-after")
-			return function_substring_after(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_substring_after;
 		else if (name == "substring")
-			return function_substring(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_substring;
 		else if (name == "string-length")
-			return function_string_length(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_string_length;
 		else if (name == "normalize-space")
-			return function_normalize_space(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_normalize_space;
 		else if (name == "translate")
-			return function_translate(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_translate;
 		else if (name == "boolean")
-			return function_boolean(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_boolean;
 		else if (name == "not")
-			return function_not(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_not;
 		else if (name == "true")
-			return function_true(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_true;
 		else if (name == "false")
-			return function_false(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_false;
 		else if (name == "lang")
-			return function_lang(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_lang;
 		else if (name == "number")
-			return function_number(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_number;
 		else if (name == "sum")
-			return function_sum(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_sum;
 		else if (name == "floor")
-			return function_floor(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_floor;
 		else if (name == "ceiling")
-			return function_ceiling(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_ceiling;
 		else if (name == "round")
-			return function_round(context, context_node_index, parameters);
+			return &XPathEvaluator_Impl::function_round;
 
-		throw Exception(string_format("Unknown function '%1'", name));
+		return nullptr;
 	}
 
-	XPathObject XPathEvaluator_Impl::get_variable(const std::string &name) const
+	int XPathEvaluator_Impl::add_node(XPathExpression_Impl &expression, const XPathExpressionNode &node)
 	{
-		return XPathObject(name);
+		expression.nodes.push_back(node);
+		return (int)expression.nodes.size() - 1;
 	}
 
-	bool XPathEvaluator_Impl::do_npr(
-		std::vector<XPathEvaluator_Impl::Operator> &operator_stack,
-		std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const
+	int XPathEvaluator_Impl::get_precedence(const XPathToken &token)
 	{
-		if (operator_stack.empty()) 
-			return false;
-
-		Operator oper = operator_stack.back();
-		operator_stack.pop_back();
+		if (token.type != XPathToken::type_operator)
+			return 0;
 
-		Operand a, b;
-		Operand result;
-
-		switch (oper)
+		switch (token.value.oper)
 		{
-		case XPathToken::operator_parenthesis_begin:
-			return false;
-
-		case XPathToken::operator_and:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(boolean(b).get_boolean() && boolean(a).get_boolean());
-			operand_stack.push_back(result);
-			break;
-
 		case XPathToken::operator_or:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(boolean(b).get_boolean() || boolean(a).get_boolean());
-			operand_stack.push_back(result);
-			break;
-
-		case XPathToken::operator_mod:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_number(static_cast<int>(number(b).get_number()) % static_cast<int>(number(a).get_number()));
-			operand_stack.push_back(result);
-			break;
+			return 1;
+		case XPathToken::operator_and:
+			return 2;
+		case XPathToken::operator_compare_equal:
+		case XPathToken::operator_compare_not_equal:
+			return 3;
+		case XPathToken::operator_less:
+		case XPathToken::operator_less_equal:
+		case XPathToken::operator_greater:
+		case XPathToken::operator_greater_equal:
+			return 4;
+		case XPathToken::operator_plus:
+		case XPathToken::operator_minus:
+			return 5;
+		case XPathToken::operator_multiply:
 		case XPathToken::operator_div:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
+		case XPathToken::operator_mod:
+			return 6;
+		default:
+			return 0;
+		}
+	}
 
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
+	bool XPathEvaluator_Impl::is_location_step(const XPathToken &token)
+	{
+		return
+			token.type == XPathToken::type_axis_name ||
+			token.type == XPathToken::type_name_test ||
+			token.type == XPathToken::type_node_type ||
+			token.type == XPathToken::type_at_sign ||
+			token.type == XPathToken::type_dot ||
+			token.type == XPathToken::type_double_dot;
+	}
 
-			result.set_number(number(b).get_number() / number(a).get_number());
-			operand_stack.push_back(result);
-			break;
-		case XPathToken::operator_multiply:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
+	bool XPathEvaluator_Impl::is_operator(const XPathToken &token, Operator oper)
+	{
+		return token.type == XPathToken::type_operator && token.value.oper == oper;
+	}
 
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
+	XPathObject XPathEvaluator_Impl::evaluate(const XPathExpression_Impl &expression, int node_index, const XPathNodeSet &context, XPathNodeSet::size_type context_node_index) const
+	{
+		const XPathExpressionNode &node = expression.nodes[node_index];
+		switch (node.type)
+		{
+		case XPathExpressionNode::type_constant:
+			return node.value;
 
-			result.set_number(number(a).get_number() * number(b).get_number());
-			operand_stack.push_back(result);
-			break;
-		case XPathToken::operator_union:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
+		case XPathExpressionNode::type_variable:
+			return get_variable(node.name);
 
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
+		case XPathExpressionNode::type_function:
+			{
+				std::vector<XPathObject> parameters;
+				parameters.reserve(node.operands.size());
+				for (int operand : node.operands)
+					parameters.push_back(evaluate(expression, operand, context, context_node_index));
+				return (this->*node.function)(context, context_node_index, parameters);
+			}
 
-			if (a.get_type() != XPathObject::type_node_set)
-				return false;
-			if (b.get_type() != XPathObject::type_node_set)
-				return false;
+		case XPathExpressionNode::type_negate:
+			return XPathObject(-number(evaluate(expression, node.operands[0], context, context_node_index)).get_number());
 
+		case XPathExpressionNode::type_operator:
+			if (node.oper != XPathToken::operator_union)
 			{
-				XPathNodeSet nodeset_a = a.get_node_set();
-				XPathNodeSet nodeset_b = b.get_node_set();
-				for (XPathNodeSet::const_iterator ita = nodeset_a.begin(), itaEnd = nodeset_a.end(); ita != itaEnd; ++ita)
+				Operand a = evaluate(expression, node.operands[0], context, context_node_index);
+				if (node.oper == XPathToken::operator_and && !boolean(a).get_boolean())
+					return XPathObject(false);
+				if (node.oper == XPathToken::operator_or && boolean(a).get_boolean())
+					return XPathObject(true);
+
+				Operand b = evaluate(expression, node.operands[1], context, context_node_index);
+				switch (node.oper)
 				{
-					bool found = false;
-					for (XPathNodeSet::const_iterator itb = nodeset_b.begin(), itbEnd = nodeset_b.end(); itb != itbEnd; ++itb)
-					{
-						if (*ita == *itb)
-						{
-							found = true;
-							break;
-						}
-					}
-					if (!found)
-						nodeset_b.push_back(*ita);
+				case XPathToken::operator_and:
+				case XPathToken::operator_or:
+					return boolean(b);
+				case XPathToken::operator_mod:
+					return XPathObject(std::fmod(number(a).get_number(), number(b).get_number()));
+				case XPathToken::operator_div:
+					return XPathObject(number(a).get_number() / number(b).get_number());
+				case XPathToken::operator_multiply:
+					return XPathObject(number(a).get_number() * number(b).get_number());
+				case XPathToken::operator_plus:
+					return XPathObject(number(a).get_number() + number(b).get_number());
+				case XPathToken::operator_minus:
+					return XPathObject(number(a).get_number() - number(b).get_number());
+				case XPathToken::operator_compare_equal:
+				case XPathToken::operator_compare_not_equal:
+				case XPathToken::operator_less:
+				case XPathToken::operator_less_equal:
+				case XPathToken::operator_greater:
+				case XPathToken::operator_greater_equal:
+					return XPathObject(compare_operands(a, b, node.oper));
+				default:
+					throw XPathException("Unknown operator", expression.expression);
 				}
-
-				result.set_node_set(nodeset_b);
-				operand_stack.push_back(result);
 			}
 			break;
 
-		case XPathToken::operator_plus:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_number(number(a).get_number() + number(b).get_number());
-			operand_stack.push_back(result);
-			break;
-
-		case XPathToken::operator_minus:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_number(number(b).get_number() - number(a).get_number());
-			operand_stack.push_back(result);
-			break;
-
-		case XPathToken::operator_compare_equal:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(compare_operands(b, a, oper));
-			operand_stack.push_back(result);
-			break;
-		case XPathToken::operator_compare_not_equal:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(compare_operands(b, a, oper));
-			operand_stack.push_back(result);
-			break;
-		case XPathToken::operator_less:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(compare_operands(b, a, oper));
-			operand_stack.push_back(result);
-			break;
-		case XPathToken::operator_less_equal:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(compare_operands(b, a, oper));
-			operand_stack.push_back(result);
-			break;
-
-		case XPathToken::operator_greater:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(compare_operands(b, a, oper));
-			operand_stack.push_back(result);
-			break;
-
-		case XPathToken::operator_greater_equal:
-			if (operand_stack.empty()) 
-				return false;
-			a = operand_stack.back();
-			operand_stack.pop_back();
-
-			if (operand_stack.empty()) 
-				return false;
-			b = operand_stack.back();
-			operand_stack.pop_back();
-
-			result.set_boolean(compare_operands(b, a, oper));
-			operand_stack.push_back(result);
-			break;
-		default:	// Added to stop compiler warnings for "operator_xxx" not handled in switch
+		default:
 			break;
 		}
 
-		return true;
+		XPathNodeSet nodes;
+		select_nodes(expression, node_index, context, context_node_index, nodes);
+		return XPathObject(nodes);
+	}
+
+	XPathObject XPathEvaluator_Impl::get_variable(const std::string &name) const
+	{
+		return XPathObject(name);
 	}
 
 	template<>
@@ -818,560 +996,310 @@ namespace clan
 			case XPathToken::operator_compare_equal:
 			case XPathToken::operator_compare_not_equal:
 				if (compare_node_set(b, a, oper))
-					return true;
-				break;
-			case XPathToken::operator_less_equal:
-				if (compare_node_set(b, a, XPathToken::operator_greater_equal))
-					return true;
-				break;
-			case XPathToken::operator_less:
-				if (compare_node_set(b, a, XPathToken::operator_greater))
-					return true;
-				break;
-			case XPathToken::operator_greater_equal:
-				if (compare_node_set(b, a, XPathToken::operator_less_equal))
-					return true;
-				break;
-			case XPathToken::operator_greater:
-				if (compare_node_set(b, a, XPathToken::operator_less))
-					return true;
-				break;
-			}
-			return false;
-		}
-		else if (b.get_type() == XPathObject::type_number)
-		{
-			return compare(a.get_number(), number(b).get_number(), oper);
-		}
-		else if (b.get_type() == XPathObject::type_boolean)
-		{
-			return compare(boolean(a).get_boolean(), b.get_boolean(), oper);
-		}
-		else if (b.get_type() == XPathObject::type_string)
-		{
-			return compare(a.get_string(), b.get_string(), oper);
-		}
-		else
-		{
-			throw XPathException("Unknown operand type in compare operation");
-		}
-	}
-
-	XPathToken XPathEvaluator_Impl::read_location_path(
-		const std::string &expression,
-		XPathToken cur_token,
-		const XPathNodeSet &context,
-		XPathNodeSet::size_type context_node_index,
-		std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const
-	{
-	/*
-		[1] LocationPath               ::= RelativeLocationPath | AbsoluteLocationPath
-		[2] AbsoluteLocationPath       ::= '/' RelativeLocationPath? | AbbreviatedAbsoluteLocationPath
-		[3] RelativeLocationPath       ::= Step | RelativeLocationPath '/' Step | AbbreviatedRelativeLocationPath
-	*/
-
-		if (cur_token.type == XPathToken::type_operator && (cur_token.value.oper == XPathToken::operator_slash || cur_token.value.oper == XPathToken::operator_double_slash))
-		{
-			// Find root node:
-			DomNode root_node = context[context_node_index];
-			while (true)
-			{
-				DomNode parent = root_node.get_parent_node();
-				if (!parent.is_null())
-					root_node = parent;
-				else
-					break;
-			}
-
-			XPathNodeSet nodeset(1, root_node);
-
-			if (cur_token.value.oper == XPathToken::operator_double_slash)
-			{
-				return read_location_steps(expression, cur_token, nodeset, 0, operand_stack);
-			}
-			else
-			{
-				XPathToken next_token = read_token(expression, cur_token);
-				if (next_token.type == XPathToken::type_axis_name ||
-					next_token.type == XPathToken::type_name_test ||
-					next_token.type == XPathToken::type_node_type ||
-					next_token.type == XPathToken::type_at_sign ||
-					next_token.type == XPathToken::type_dot ||
-					next_token.type == XPathToken::type_double_dot ||
-					(next_token.type == XPathToken::type_operator && next_token.value.oper == XPathToken::operator_double_slash))
-				{
-					cur_token = next_token;
-					return read_location_steps(expression, cur_token, nodeset, 0, operand_stack);
-				}
-				else
-				{
-					operand_stack.push_back(XPathObject(nodeset));
-					return cur_token;
-				}
-			}
-		}
-		else
-		{
-			return read_location_steps(expression, cur_token, context, context_node_index, operand_stack);
-		}
-	}
-
-	XPathToken XPathEvaluator_Impl::read_location_steps(
-		const std::string &expression,
-		XPathToken cur_token,
-		const XPathNodeSet &context,
-		XPathNodeSet::size_type context_node_index,
-		std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const
-	{
-		std::vector<XPathLocationStep> steps;
-		while (true)
-		{
-			XPathLocationStep step;
-			cur_token = read_location_step(expression, cur_token, step);
-			steps.push_back(step);
-
-			XPathToken next_token = read_token(expression, cur_token);
-			if ((next_token.type == XPathToken::type_operator && next_token.value.oper == XPathToken::operator_slash) ||
-				(cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash))
-			{
-				if (next_token.value.oper == XPathToken::operator_slash)
-					next_token = read_token(expression, next_token);
-				if (next_token.type == XPathToken::type_axis_name ||
-					next_token.type == XPathToken::type_name_test ||
-					next_token.type == XPathToken::type_node_type ||
-					next_token.type == XPathToken::type_at_sign ||
-					next_token.type == XPathToken::type_dot ||
-					next_token.type == XPathToken::type_double_dot)
-				{
-					cur_token = next_token;
-				}
-				else
-				{
-					break;
-				}
-			}
-			else
-			{
-				break;
-			}
-		}
-
-		XPathNodeSet nodeset;
-		evaluate_location_step(context, context_node_index, steps, 0, expression, nodeset);
-		operand_stack.push_back(XPathObject(nodeset));
-		return cur_token;
-	}
-
-	XPathToken XPathEvaluator_Impl::read_location_step(
-		const std::string &expression,
-		XPathToken cur_token,
-		XPathLocationStep &step) const
-	{
-	/*
-		Location Steps
-		[4]  Step                      ::= AxisSpecifier NodeTest Predicate* | AbbreviatedStep
-
-		[5]  AxisSpecifier             ::= AxisName '::'	| AbbreviatedAxisSpecifier
-		[6]  AxisName                  ::= 'ancestor' | 'ancestor-or-self' | 'attribute' | 'child'
-										   | 'descendant' | 'descendant-or-self' | 'following'
-										   | 'following-sibling' | 'namespace' | 'parent'
-										   | 'preceding' | 'preceding-sibling' | 'self'	
-		[13] AbbreviatedAxisSpecifier  ::= '@'?
-
-		[7]  NodeTest                  ::= NameTest	
-										   | NodeType '(' ')'	
-										   | 'processing-instruction' '(' Literal ')'	
-		[37] NameTest                  ::= '*' | NCName ':' '*' | QName	
-		[38] NodeType                  ::= 'comment' | 'text' | 'processing-instruction' | 'node'
-
-		[8]  Predicate                 ::= '[' PredicateExpr ']'
-		[9]  PredicateExpr             ::= Expr
-
-		[12] AbbreviatedStep           ::= '.' | '..'
-	*/
-		if (cur_token.type == XPathToken::type_dot)
-		{
-			step.axis = "self";
-			step.test_type = XPathLocationStep::type_node;
-			step.node_type = XPathToken::node_type_node;
-		}
-		else if (cur_token.type == XPathToken::type_double_dot)
-		{
-			step.axis = "parent";
-			step.test_type = XPathLocationStep::type_node;
-			step.node_type = XPathToken::node_type_node;
-		}
-		else if (cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash)
-		{
-			step.axis = "descendant-or-self";
-			step.test_type = XPathLocationStep::type_node;
-			step.node_type = XPathToken::node_type_node;
-		}
-		else
-		{
-			// Read AxisSpecifier:
-			if (cur_token.type == XPathToken::type_axis_name)
-			{
-				step.axis = cur_token.value.str;
-				cur_token = read_token(expression, cur_token);
-				if (cur_token.type != XPathToken::type_double_colon)
-					throw XPathException("Expected '::' after axis name", expression, cur_token);
-				cur_token = read_token(expression, cur_token);
-			}
-			else if (cur_token.type == XPathToken::type_at_sign) // Abbreviated axis specifier
-			{
-				step.axis = "attribute";
-				cur_token = read_token(expression, cur_token);
-			}
-			else // Abbreviated syntax
-			{
-				step.axis = "child";
-			}
-
-			// Read Node Test:
-			if (cur_token.type == XPathToken::type_name_test)
-			{
-				step.test_type = XPathLocationStep::type_name;
-				step.test_str = cur_token.value.str;
-			}
-			else if (cur_token.type == XPathToken::type_node_type)
-			{
-				step.test_type = XPathLocationStep::type_node;
-				step.node_type = cur_token.value.node_type;
-				cur_token = read_token(expression, cur_token);
-				if (cur_token.type != XPathToken::type_operator || cur_token.value.oper != XPathToken::operator_parenthesis_begin)
-					throw XPathException("Expected '(' after node-type test", expression, cur_token);
-				cur_token = read_token(expression, cur_token);
-				if (cur_token.type == XPathToken::type_literal && step.node_type == XPathToken::node_type_processing_instruction)
-				{
-					step.test_str = cur_token.value.str;
-					cur_token = read_token(expression, cur_token);
-				}
-				if (cur_token.type != XPathToken::type_operator || cur_token.value.oper != XPathToken::operator_parenthesis_end)
-					throw XPathException("Expected ')' after node-type test", expression, cur_token);
-			}
-			else
-			{
-				throw XPathException("Unknown node test type", expression, cur_token);
-			}
-
-			XPathToken next_token = read_token(expression, cur_token);
-			while (next_token.type == XPathToken::type_bracket_begin)
-			{
-				XPathLocationStep::Predicate predicate;
-				predicate.pos = next_token.pos + next_token.length;
-				cur_token = skip_predicate_expression(expression, next_token);
-				predicate.length = cur_token.pos - predicate.pos;
-				step.predicates.push_back(predicate);
-				next_token = read_token(expression, cur_token);
-			}
-		}
-		return cur_token;
-	}
-
-	XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &expression, const XPathToken &previous_token) const
-	{
-		int bracket_count = 1;
-		XPathToken cur_token = previous_token;
-		while (true)
-		{
-			cur_token = read_token(expression, cur_token);
-			if (cur_token.type == XPathToken::type_bracket_begin)
-			{
-				bracket_count++;
-			}
-			else if (cur_token.type == XPathToken::type_bracket_end)
-			{
-				bracket_count--;
-				if (bracket_count == 0)
-					break;
-			}
-			else if (cur_token.type == XPathToken::type_none)
-			{
+					return true;
+				break;
+			case XPathToken::operator_less_equal:
+				if (compare_node_set(b, a, XPathToken::operator_greater_equal))
+					return true;
+				break;
+			case XPathToken::operator_less:
+				if (compare_node_set(b, a, XPathToken::operator_greater))
+					return true;
+				break;
+			case XPathToken::operator_greater_equal:
+				if (compare_node_set(b, a, XPathToken::operator_less_equal))
+					return true;
+				break;
+			case XPathToken::operator_greater:
+				if (compare_node_set(b, a, XPathToken::operator_less))
+					return true;
 				break;
 			}
+			return false;
 		}
-		return cur_token;
-	}
-
-	void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		if (step_index < steps.size())
-		{
-			if (steps[step_index].axis == "ancestor")
-				select_nodes_ancestor(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "ancestor-or-self")
-				select_nodes_ancestor_or_self(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "attribute")
-				select_nodes_attribute(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "child")
-				select_nodes_child(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "descendant")
-				select_nodes_descendant(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "descendant-or-self")
-				select_nodes_descendant_or_self(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "following")
-				select_nodes_following(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "follwing-sibling")
-				select_nodes_following_sibling(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "namespace")
-				select_nodes_namespace(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "parent")
-				select_nodes_parent(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "preceding")
-				select_nodes_preceding(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "preceding-sibling")
-				select_nodes_preceding_sibling(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "self")
-				select_nodes_self(context, context_node_index, steps, step_index, expression, nodes);
-			else
-				throw XPathException(string_format("Unknown location step axis", steps[step_index].axis), expression);
-		}
-		else
+		else if (b.get_type() == XPathObject::type_number)
 		{
-			nodes.push_back(context[context_node_index]);
+			return compare(a.get_number(), number(b).get_number(), oper);
 		}
-	}
-
-	void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet nodeset;
-		DomNode parent = context[context_node_index].get_parent_node();
-		while (!parent.is_null())
+		else if (b.get_type() == XPathObject::type_boolean)
 		{
-			if (confirm_step_requirements(parent, steps[step_index], expression))
-				nodeset.push_back(parent);
-
-			parent = parent.get_parent_node();
+			return compare(boolean(a).get_boolean(), b.get_boolean(), oper);
 		}
-
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
-	}
-
-	void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet nodeset;
-		DomNode parent = context[context_node_index];
-		while (!parent.is_null())
+		else if (b.get_type() == XPathObject::type_string)
 		{
-			if (confirm_step_requirements(parent, steps[step_index], expression))
-				nodeset.push_back(parent);
-
-			parent = parent.get_parent_node();
+			return compare(a.get_string(), b.get_string(), oper);
 		}
-
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
-	}
-
-	void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet nodeset;
-		DomNamedNodeMap attributes = context[context_node_index].get_attributes();
-		unsigned long num_attributes = attributes.get_length();
-		for (unsigned long idx = 0; idx < num_attributes; idx++)
+		else
 		{
-			const DomNode &node = attributes.item(idx);
-			if (confirm_step_requirements(node, steps[step_index], expression))
-				nodeset.push_back(node);
+			throw XPathException("Unknown operand type in compare operation");
 		}
-
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 	}
 
-	void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+	void XPathEvaluator_Impl::select_nodes(const XPathExpression_Impl &expression, int node_index, const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, XPathNodeSet &out_nodes) const
 	{
-		XPathNodeSet nodeset;
-		DomNode cur_node = context[context_node_index].get_first_child();
-		while (!cur_node.is_null())
+		const XPathExpressionNode &node = expression.nodes[node_index];
+		switch (node.type)
 		{
-			if (confirm_step_requirements(cur_node, steps[step_index], expression))
-				nodeset.push_back(cur_node);
-			cur_node = cur_node.get_next_sibling();
-		}
-
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
-	}
+		case XPathExpressionNode::type_location_path:
+			if (node.fast && select_tree_nodes(node, context[context_node_index], out_nodes))
+				return;
 
-	void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet parentNodes;
-		XPathNodeSet nodeset;
+			out_nodes.clear();
+			out_nodes.push_back(context[context_node_index]);
+			if (node.absolute)
+			{
+				// Find root node:
+				while (true)
+				{
+					DomNode parent = out_nodes.front().get_parent_node();
+					if (!parent.is_null())
+						out_nodes.front() = parent;
+					else
+						break;
+				}
+			}
+			select_location_steps(expression, node.steps, out_nodes);
+			return;
 
-		DomNode cur_node = context[context_node_index].get_first_child();
-		while (!cur_node.is_null())
-		{
-			if (confirm_step_requirements(cur_node, steps[step_index], expression))
-				nodeset.push_back(cur_node);
+		case XPathExpressionNode::type_filter:
+			select_nodes(expression, node.operands[0], context, context_node_index, out_nodes);
+			filter_predicates(expression, node.predicates, out_nodes);
+			select_location_steps(expression, node.steps, out_nodes);
+			return;
 
-			parentNodes.push_back(cur_node);
-			cur_node = cur_node.get_first_child();
-			while (cur_node.is_null())
+		case XPathExpressionNode::type_operator:
+			if (node.oper == XPathToken::operator_union)
 			{
-				if (parentNodes.empty())
-					break;
-				cur_node = parentNodes.back();
-				parentNodes.pop_back();
-				cur_node = cur_node.get_next_sibling();
+				XPathNodeSet nodes;
+				select_nodes(expression, node.operands[0], context, context_node_index, out_nodes);
+				select_nodes(expression, node.operands[1], context, context_node_index, nodes);
+				append_unique(out_nodes, nodes);
+				sort_document_order(out_nodes);
+				return;
 			}
+			break;
+
+		default:
+			break;
 		}
 
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+		XPathObject result = evaluate(expression, node_index, context, context_node_index);
+		if (result.get_type() != XPathObject::type_node_set)
+			throw XPathException("Expression does not evaluate to a node-set", expression.expression);
+		out_nodes = result.get_node_set();
 	}
 
-	void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+	void XPathEvaluator_Impl::select_location_steps(const XPathExpression_Impl &expression, const std::vector<XPathLocationStep> &steps, XPathNodeSet &nodes) const
 	{
-		XPathNodeSet parentNodes;
-		XPathNodeSet nodeset;
+		XPathNodeSet next_nodes;
+		XPathNodeSet step_nodes;
+		std::unordered_set<unsigned int> selected;
 
-		DomNode cur_node = context[context_node_index];
-		while (!cur_node.is_null())
+		for (const auto &step : steps)
 		{
-			if (confirm_step_requirements(cur_node, steps[step_index], expression))
-				nodeset.push_back(cur_node);
+			// Only the child, attribute and self axes never reach the same node from two different context nodes
+			bool check_duplicates = nodes.size() > 1 &&
+				step.axis != XPathLocationStep::axis_child &&
+				step.axis != XPathLocationStep::axis_attribute &&
+				step.axis != XPathLocationStep::axis_self;
+
+			// Reverse axes list the nearest node first, which is the order predicates see
+			bool reverse_axis =
+				step.axis == XPathLocationStep::axis_ancestor ||
+				step.axis == XPathLocationStep::axis_ancestor_or_self ||
+				step.axis == XPathLocationStep::axis_preceding ||
+				step.axis == XPathLocationStep::axis_preceding_sibling;
+
+			// Descendants of context nodes in document order are already in document order, the other axes can overlap
+			bool needs_sort = check_duplicates &&
+				step.axis != XPathLocationStep::axis_descendant &&
+				step.axis != XPathLocationStep::axis_descendant_or_self;
 
-			parentNodes.push_back(cur_node);
-			cur_node = cur_node.get_first_child();
-			while (cur_node.is_null())
+			next_nodes.clear();
+			selected.clear();
+			for (const auto &node : nodes)
 			{
-				if (parentNodes.empty())
-					break;
-				cur_node = parentNodes.back();
-				parentNodes.pop_back();
-				cur_node = cur_node.get_next_sibling();
+				step_nodes.clear();
+				select_axis(node, step, step_nodes);
+				filter_predicates(expression, step.predicates, step_nodes);
+				if (reverse_axis)
+					std::reverse(step_nodes.begin(), step_nodes.end());
+
+				for (const auto &step_node : step_nodes)
+				{
+					if (!check_duplicates || selected.insert(step_node.impl->node_index).second)
+						next_nodes.push_back(step_node);
+				}
 			}
+			nodes.swap(next_nodes);
+			if (needs_sort)
+				sort_document_order(nodes);
 		}
-
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 	}
 
-	void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+	void XPathEvaluator_Impl::select_axis(const DomNode &node, const XPathLocationStep &step, XPathNodeSet &out_nodes) const
 	{
-		XPathNodeSet nodeset;
+		if (node.is_null())
+			return;
 
-		DomNode cur_node;
-		DomNode next_node = context[context_node_index];
-		while (!next_node.is_null())
+		switch (step.axis)
 		{
-			cur_node = next_node;
-			next_node = cur_node.get_next_sibling();
-			if (next_node.is_null())
+		case XPathLocationStep::axis_ancestor:
+		case XPathLocationStep::axis_ancestor_or_self:
+			for (DomNode cur_node = (step.axis == XPathLocationStep::axis_ancestor) ? node.get_parent_node() : node; !cur_node.is_null(); cur_node = cur_node.get_parent_node())
 			{
-				next_node = cur_node.get_parent_node();
+				if (confirm_step_requirements(cur_node, step))
+					out_nodes.push_back(cur_node);
 			}
-			else
-			{
-				cur_node = next_node;
-				if (confirm_step_requirements(cur_node, steps[step_index], expression))
-					nodeset.push_back(cur_node);
+			break;
 
-				next_node = cur_node.get_first_child();
-				while (!next_node.is_null())
+		case XPathLocationStep::axis_attribute:
+			{
+				DomNamedNodeMap attributes = node.get_attributes();
+				unsigned long num_attributes = attributes.get_length();
+				for (unsigned long idx = 0; idx < num_attributes; idx++)
 				{
-					cur_node = next_node;
-					if (confirm_step_requirements(cur_node, steps[step_index], expression))
-						nodeset.push_back(cur_node);
-
-					next_node = cur_node.get_first_child();
+					DomNode attribute = attributes.item(idx);
+					if (confirm_step_requirements(attribute, step))
+						out_nodes.push_back(attribute);
 				}
-				next_node = cur_node.get_parent_node();
 			}
-		}
-
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
-	}
+			break;
 
-	void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet nodeset;
-		DomNode cur_node = context[context_node_index].get_next_sibling();
-		while (!cur_node.is_null())
-		{
-			if (confirm_step_requirements(cur_node, steps[step_index], expression))
-				nodeset.push_back(cur_node);
-			cur_node = cur_node.get_next_sibling();
-		}
+		case XPathLocationStep::axis_child:
+			for (DomNode cur_node = node.get_first_child(); !cur_node.is_null(); cur_node = cur_node.get_next_sibling())
+			{
+				if (confirm_step_requirements(cur_node, step))
+					out_nodes.push_back(cur_node);
+			}
+			break;
 
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
-	}
+		case XPathLocationStep::axis_descendant_or_self:
+			if (confirm_step_requirements(node, step))
+				out_nodes.push_back(node);
+			select_descendants(node, step, out_nodes);
+			break;
 
-	void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-	}
+		case XPathLocationStep::axis_descendant:
+			select_descendants(node, step, out_nodes);
+			break;
 
-	void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet nodeset;
-		DomNode parent = context[context_node_index].get_parent_node();
-		if (!parent.is_null())
-		{
-			if (confirm_step_requirements(parent, steps[step_index], expression))
-				nodeset.push_back(parent);
-		}
+		case XPathLocationStep::axis_following:
+			for (DomNode cur_node = node; !cur_node.is_null(); cur_node = cur_node.get_parent_node())
+			{
+				for (DomNode sibling = cur_node.get_next_sibling(); !sibling.is_null(); sibling = sibling.get_next_sibling())
+				{
+					if (confirm_step_requirements(sibling, step))
+						out_nodes.push_back(sibling);
+					select_descendants(sibling, step, out_nodes);
+				}
+			}
+			break;
 
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
-	}
+		case XPathLocationStep::axis_following_sibling:
+			for (DomNode cur_node = node.get_next_sibling(); !cur_node.is_null(); cur_node = cur_node.get_next_sibling())
+			{
+				if (confirm_step_requirements(cur_node, step))
+					out_nodes.push_back(cur_node);
+			}
+			break;
 
-	void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
-	{
-		XPathNodeSet nodeset;
+		case XPathLocationStep::axis_namespace:
+			break;
 
-		DomNode cur_node;
-		DomNode next_node = context[context_node_index];
-		while (!next_node.is_null())
-		{
-			cur_node = next_node;
-			next_node = cur_node.get_previous_sibling();
-			if (next_node.is_null())
+		case XPathLocationStep::axis_parent:
 			{
-				next_node = cur_node.get_parent_node();
+				DomNode parent = node.get_parent_node();
+				if (!parent.is_null() && confirm_step_requirements(parent, step))
+					out_nodes.push_back(parent);
 			}
-			else
-			{
-				cur_node = next_node;
-				if (confirm_step_requirements(cur_node, steps[step_index], expression))
-					nodeset.push_back(cur_node);
+			break;
 
-				next_node = cur_node.get_last_child();
-				while (!next_node.is_null())
+		case XPathLocationStep::axis_preceding:
+			// Reverse axis, nearest node first
+			for (DomNode cur_node = node; !cur_node.is_null(); cur_node = cur_node.get_parent_node())
+			{
+				for (DomNode sibling = cur_node.get_previous_sibling(); !sibling.is_null(); sibling = sibling.get_previous_sibling())
 				{
-					cur_node = next_node;
-					if (confirm_step_requirements(cur_node, steps[step_index], expression))
-						nodeset.push_back(cur_node);
-
-					next_node = cur_node.get_last_child();
+					XPathNodeSet::size_type start = out_nodes.size();
+					if (confirm_step_requirements(sibling, step))
+						out_nodes.push_back(sibling);
+					select_descendants(sibling, step, out_nodes);
+					std::reverse(out_nodes.begin() + start, out_nodes.end());
 				}
-				next_node = cur_node.get_parent_node();
 			}
-		}
+			break;
+
+		case XPathLocationStep::axis_preceding_sibling:
+			for (DomNode cur_node = node.get_previous_sibling(); !cur_node.is_null(); cur_node = cur_node.get_previous_sibling())
+			{
+				if (confirm_step_requirements(cur_node, step))
+					out_nodes.push_back(cur_node);
+			}
+			break;
 
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+		case XPathLocationStep::axis_self:
+			if (confirm_step_requirements(node, step))
+				out_nodes.push_back(node);
+			break;
+		}
 	}
 
-	void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+	void XPathEvaluator_Impl::select_descendants(const DomNode &node, const XPathLocationStep &step, XPathNodeSet &out_nodes) const
 	{
-		XPathNodeSet nodeset;
-		DomNode cur_node = context[context_node_index].get_previous_sibling();
+		DomNode cur_node = node.get_first_child();
 		while (!cur_node.is_null())
 		{
-			if (confirm_step_requirements(cur_node, steps[step_index], expression))
-				nodeset.push_back(cur_node);
-			cur_node = cur_node.get_previous_sibling();
-		}
+			if (confirm_step_requirements(cur_node, step))
+				out_nodes.push_back(cur_node);
 
-		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+			DomNode next_node = cur_node.get_first_child();
+			while (next_node.is_null() && cur_node != node)
+			{
+				next_node = cur_node.get_next_sibling();
+				if (next_node.is_null())
+					cur_node = cur_node.get_parent_node();
+			}
+			cur_node = next_node;
+		}
 	}
 
-	void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+	void XPathEvaluator_Impl::filter_predicates(const XPathExpression_Impl &expression, const std::vector<int> &predicates, XPathNodeSet &nodes) const
 	{
-		DomNode cur_node = context[context_node_index];
-		if (!cur_node.is_null())
+		XPathNodeSet filtered_nodes;
+		for (int predicate : predicates)
 		{
-			if (confirm_step_requirements(cur_node, steps[step_index], expression))
-				evaluate_location_step_predicates(XPathNodeSet(1, cur_node), steps, step_index, expression, nodes);
+			if (nodes.empty())
+				break;
+
+			// [2] picks a node without evaluating the predicate for every node
+			const XPathExpressionNode &node = expression.nodes[predicate];
+			if (node.type == XPathExpressionNode::type_constant && node.value.get_type() == XPathObject::type_number)
+			{
+				double position = node.value.get_number();
+				if (position >= 1.0 && position <= nodes.size() && position == std::floor(position))
+				{
+					DomNode selected = nodes[(XPathNodeSet::size_type)position - 1];
+					nodes.assign(1, selected);
+				}
+				else
+				{
+					nodes.clear();
+				}
+				continue;
+			}
+
+			filtered_nodes.clear();
+			for (XPathNodeSet::size_type node_index = 0, num_nodes = nodes.size(); node_index < num_nodes; node_index++)
+			{
+				if (confirm_step_predicate(expression, predicate, nodes, node_index))
+					filtered_nodes.push_back(nodes[node_index]);
+			}
+			nodes.swap(filtered_nodes);
 		}
 	}
 
-	bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const
+	bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step) const
 	{
 		bool test_passed = false;
 		switch (step.test_type)
@@ -1410,46 +1338,266 @@ namespace clan
 		return test_passed;
 	}
 
-	bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const
+	bool XPathEvaluator_Impl::confirm_step_predicate(const XPathExpression_Impl &expression, int predicate, const XPathNodeSet &context, XPathNodeSet::size_type context_node_index) const
 	{
-		XPathEvaluateResult result = evaluate(expression.substr(predicate.pos, predicate.length), context, context_node_index, XPathToken());
+		XPathObject result = evaluate(expression, predicate, context, context_node_index);
 		bool include_in_nodeset = false;
-		switch (result.result.get_type())
+		switch (result.get_type())
 		{
 		case XPathObject::type_null:
 			break;
 		case XPathObject::type_node_set:
-			include_in_nodeset = !result.result.get_node_set().empty();
+			include_in_nodeset = !result.get_node_set().empty();
 			break;
 		case XPathObject::type_boolean:
-			include_in_nodeset = result.result.get_boolean();
+			include_in_nodeset = result.get_boolean();
 			break;
 		case XPathObject::type_number:
-			include_in_nodeset = result.result.get_number() == context_node_index+1;
+			include_in_nodeset = result.get_number() == context_node_index+1;
 			break;
 		case XPathObject::type_string:
-			include_in_nodeset = !result.result.get_string().empty();
+			include_in_nodeset = !result.get_string().empty();
 			break;
 		}
 		return include_in_nodeset;
 	}
 
-	void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+	void XPathEvaluator_Impl::append_unique(XPathNodeSet &nodes, const XPathNodeSet &new_nodes) const
+	{
+		std::unordered_set<unsigned int> selected;
+		for (const auto &node : nodes)
+			selected.insert(node.impl->node_index);
+
+		for (const auto &node : new_nodes)
+		{
+			if (selected.insert(node.impl->node_index).second)
+				nodes.push_back(node);
+		}
+	}
+
+	void XPathEvaluator_Impl::sort_document_order(XPathNodeSet &nodes) const
+	{
+		if (nodes.size() < 2 || !nodes.front().impl)
+			return;
+
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *)nodes.front().impl->owner_document.lock().get();
+		if (!doc_impl)
+			return;
+
+		for (const auto &node : nodes)
+		{
+			if (!node.impl || node.impl->node_index == cl_null_node_index || node.impl->owner_document.lock().get() != doc_impl)
+				return;
+		}
+
+		// Position of each node below its parent, attributes before children. Every sibling list is numbered at most once.
+		std::unordered_map<unsigned int, unsigned int> positions;
+		auto get_position = [&](unsigned int node_index) -> unsigned int
+		{
+			auto it = positions.find(node_index);
+			if (it != positions.end())
+				return it->second;
+
+			const DomTreeNode *parent = doc_impl->get_tree_node(doc_impl->get_tree_node(node_index)->parent);
+			unsigned int position = 0;
+			for (unsigned int cur_index = parent->first_attribute; cur_index != cl_null_node_index; cur_index = doc_impl->get_tree_node(cur_index)->next_sibling)
+				positions[cur_index] = position++;
+			for (unsigned int cur_index = parent->first_child; cur_index != cl_null_node_index; cur_index = doc_impl->get_tree_node(cur_index)->next_sibling)
+				positions[cur_index] = position++;
+			return positions[node_index];
+		};
+
+		// The path of positions from the root sorts like the nodes do in the document, as an ancestor is a prefix of its descendants
+		std::vector<std::vector<unsigned int>> paths(nodes.size());
+		for (XPathNodeSet::size_type i = 0; i < nodes.size(); i++)
+		{
+			for (unsigned int cur_index = nodes[i].impl->node_index; doc_impl->get_tree_node(cur_index)->parent != cl_null_node_index; cur_index = doc_impl->get_tree_node(cur_index)->parent)
+				paths[i].push_back(get_position(cur_index));
+			std::reverse(paths[i].begin(), paths[i].end());
+		}
+
+		std::vector<XPathNodeSet::size_type> order(nodes.size());
+		for (XPathNodeSet::size_type i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&](XPathNodeSet::size_type a, XPathNodeSet::size_type b) { return paths[a] < paths[b]; });
+
+		XPathNodeSet sorted_nodes;
+		sorted_nodes.reserve(nodes.size());
+		for (XPathNodeSet::size_type i : order)
+			sorted_nodes.push_back(nodes[i]);
+		nodes.swap(sorted_nodes);
+	}
+
+	bool XPathEvaluator_Impl::select_tree_nodes(const XPathExpressionNode &path, const DomNode &context_node, XPathNodeSet &out_nodes) const
+	{
+		if (!context_node.impl || context_node.impl->node_index == cl_null_node_index)
+			return false;
+
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *)context_node.impl->owner_document.lock().get();
+		if (!doc_impl)
+			return false;
+
+		std::vector<unsigned int> nodes(1, context_node.impl->node_index);
+		if (path.absolute)
+		{
+			while (doc_impl->get_tree_node(nodes.front())->parent != cl_null_node_index)
+				nodes.front() = doc_impl->get_tree_node(nodes.front())->parent;
+		}
+
+		std::vector<unsigned int> next_nodes;
+		std::vector<unsigned int> step_nodes;
+		std::unordered_set<unsigned int> selected;
+		for (const auto &step : path.steps)
+		{
+			bool check_duplicates = nodes.size() > 1 &&
+				(step.axis == XPathLocationStep::axis_descendant || step.axis == XPathLocationStep::axis_descendant_or_self);
+
+			next_nodes.clear();
+			selected.clear();
+			for (unsigned int node_index : nodes)
+			{
+				step_nodes.clear();
+				select_tree_axis(doc_impl, node_index, step, step_nodes);
+				filter_tree_predicates(doc_impl, step, step_nodes);
+
+				for (unsigned int step_node : step_nodes)
+				{
+					if (!check_duplicates || selected.insert(step_node).second)
+						next_nodes.push_back(step_node);
+				}
+			}
+			nodes.swap(next_nodes);
+		}
+
+		out_nodes.clear();
+		out_nodes.reserve(nodes.size());
+		for (unsigned int node_index : nodes)
+		{
+			DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
+			dom_node->node_index = node_index;
+			out_nodes.push_back(DomNode(std::shared_ptr<DomNode_Impl>(dom_node, DomDocument_Impl::NodeDeleter(doc_impl))));
+		}
+		return true;
+	}
+
+	void XPathEvaluator_Impl::select_tree_axis(const DomDocument_Impl *doc_impl, unsigned int node_index, const XPathLocationStep &step, std::vector<unsigned int> &out_nodes) const
+	{
+		const DomTreeNode *tree_node = doc_impl->get_tree_node(node_index);
+		switch (step.axis)
+		{
+		case XPathLocationStep::axis_self:
+			if (confirm_tree_node(doc_impl, tree_node, step))
+				out_nodes.push_back(node_index);
+			break;
+
+		case XPathLocationStep::axis_attribute:
+			for (unsigned int cur_index = tree_node->first_attribute; cur_index != cl_null_node_index; cur_index = doc_impl->get_tree_node(cur_index)->next_sibling)
+			{
+				if (confirm_tree_node(doc_impl, doc_impl->get_tree_node(cur_index), step))
+					out_nodes.push_back(cur_index);
+			}
+			break;
+
+		case XPathLocationStep::axis_child:
+			for (unsigned int cur_index = tree_node->first_child; cur_index != cl_null_node_index; cur_index = doc_impl->get_tree_node(cur_index)->next_sibling)
+			{
+				if (confirm_tree_node(doc_impl, doc_impl->get_tree_node(cur_index), step))
+					out_nodes.push_back(cur_index);
+			}
+			break;
+
+		case XPathLocationStep::axis_descendant_or_self:
+		case XPathLocationStep::axis_descendant:
+			{
+				if (step.axis == XPathLocationStep::axis_descendant_or_self && confirm_tree_node(doc_impl, tree_node, step))
+					out_nodes.push_back(node_index);
+
+				unsigned int cur_index = tree_node->first_child;
+				while (cur_index != cl_null_node_index)
+				{
+					const DomTreeNode *cur_node = doc_impl->get_tree_node(cur_index);
+					if (confirm_tree_node(doc_impl, cur_node, step))
+						out_nodes.push_back(cur_index);
+
+					if (cur_node->first_child != cl_null_node_index)
+					{
+						cur_index = cur_node->first_child;
+					}
+					else
+					{
+						while (cur_index != node_index && doc_impl->get_tree_node(cur_index)->next_sibling == cl_null_node_index)
+							cur_index = doc_impl->get_tree_node(cur_index)->parent;
+						cur_index = (cur_index != node_index) ? doc_impl->get_tree_node(cur_index)->next_sibling : cl_null_node_index;
+					}
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void XPathEvaluator_Impl::filter_tree_predicates(const DomDocument_Impl *doc_impl, const XPathLocationStep &step, std::vector<unsigned int> &nodes) const
 	{
-		XPathNodeSet nodeset = context;
-		for (const auto & elem : steps[step_index].predicates)
+		for (const auto &predicate : step.fast_predicates)
 		{
-			XPathNodeSet filtered_nodes;
-			for (XPathNodeSet::size_type node_index = 0, num_nodes = nodeset.size(); node_index < num_nodes; node_index++)
+			if (predicate.type == XPathLocationStep::FastPredicate::type_position)
+			{
+				if (predicate.position <= nodes.size())
+				{
+					unsigned int selected = nodes[predicate.position - 1];
+					nodes.assign(1, selected);
+				}
+				else
+				{
+					nodes.clear();
+				}
+				continue;
+			}
+
+			size_t num_nodes = 0;
+			for (unsigned int node_index : nodes)
 			{
-				if (confirm_step_predicate(nodeset, node_index, elem, expression))
-					filtered_nodes.push_back(nodeset[node_index]);
+				bool passed = false;
+				for (unsigned int cur_index = doc_impl->get_tree_node(node_index)->first_attribute; cur_index != cl_null_node_index; cur_index = doc_impl->get_tree_node(cur_index)->next_sibling)
+				{
+					const DomTreeNode *attribute = doc_impl->get_tree_node(cur_index);
+					if (attribute->get_node_name(doc_impl) == predicate.name)
+					{
+						passed = predicate.type == XPathLocationStep::FastPredicate::type_attribute || attribute->has_node_value(doc_impl, predicate.value);
+						break;
+					}
+				}
+
+				if (passed)
+					nodes[num_nodes++] = node_index;
 			}
-			nodeset = filtered_nodes;
+			nodes.resize(num_nodes);
 		}
+	}
 
-		for (XPathNodeSet::size_type node_index = 0, num_nodes = nodeset.size(); node_index < num_nodes; node_index++)
-			evaluate_location_step(nodeset, node_index, steps, step_index+1, expression, nodes);
+	bool XPathEvaluator_Impl::confirm_tree_node(const DomDocument_Impl *doc_impl, const DomTreeNode *tree_node, const XPathLocationStep &step) const
+	{
+		switch (step.test_type)
+		{
+		case XPathLocationStep::type_name:
+			return (tree_node->node_type == DomNode::ELEMENT_NODE || tree_node->node_type == DomNode::ATTRIBUTE_NODE) && (step.test_str == "*" || tree_node->get_node_name(doc_impl) == step.test_str);
+		case XPathLocationStep::type_node:
+			switch (step.node_type)
+			{
+			case XPathToken::node_type_comment:
+				return tree_node->node_type == DomNode::COMMENT_NODE;
+			case XPathToken::node_type_text:
+				return tree_node->node_type == DomNode::TEXT_NODE;
+			case XPathToken::node_type_processing_instruction:
+				return tree_node->node_type == DomNode::PROCESSING_INSTRUCTION_NODE;
+			default:
+				return true;
+			}
+		default:
+			return true;
+		}
 	}
 
 	XPathToken XPathEvaluator_Impl::read_token(
@@ -1601,7 +1749,8 @@ namespace clan
 				previous_token.value.oper == XPathToken::operator_parenthesis_begin) ||
 				previous_token.type == XPathToken::type_bracket_begin ||
 				previous_token.type == XPathToken::type_comma ||
-				previous_token.type == XPathToken::type_operator)
+				(previous_token.type == XPathToken::type_operator &&
+				previous_token.value.oper != XPathToken::operator_parenthesis_end))
 			{
 				token.type = XPathToken::type_name_test;
 				token.value.str = "*";
@@ -1644,7 +1793,7 @@ namespace clan
 			}
 			token.length = pos - token.pos;
 			token.value.str = expression.substr(token.pos + 1, token.length - 1);
-			break;
+			return token;
 		}
 
 		if (is_digit(first_char))
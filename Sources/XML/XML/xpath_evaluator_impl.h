@@ -32,15 +32,12 @@
 #include "API/XML/xpath_object.h"
 #include "xpath_token.h"
 #include "xpath_location_step.h"
+#include "xpath_expression_impl.h"
 
 namespace clan
 {
-	class XPathEvaluateResult
-	{
-	public:
-		XPathObject result;
-		XPathToken next_token;
-	};
+	class DomDocument_Impl;
+	class DomTreeNode;
 
 	class XPathEvaluator_Impl
 	{
@@ -48,24 +45,48 @@ namespace clan
 		typedef std::vector<DomNode> XPathNodeSet;
 
 	public:
-		XPathEvaluateResult evaluate(
-			const std::string &expression,
-			const XPathNodeSet &context,
-			XPathNodeSet::size_type context_node_index,
-			XPathToken prev_token) const;
+		std::shared_ptr<XPathExpression_Impl> compile(const std::string &expression) const;
+
+		XPathObject evaluate(const XPathExpression_Impl &expression, const DomNode &context_node) const;
+		void select_nodes(const XPathExpression_Impl &expression, const DomNode &context_node, XPathNodeSet &out_nodes) const;
 
 	private:
 		typedef XPathToken::Operator Operator;
 		typedef XPathObject Operand;
-		enum ErrorType
-		{
-			syntax_error,
-			expression_error
-		};
 
-		bool do_npr(
-			std::vector<Operator> &operator_stack,
-			std::vector<Operand> &operand_stack) const;
+		int parse_expression(XPathExpression_Impl &expression, XPathToken &token, int min_precedence = 1) const;
+		int parse_unary_expression(XPathExpression_Impl &expression, XPathToken &token) const;
+		int parse_union_expression(XPathExpression_Impl &expression, XPathToken &token) const;
+		int parse_path_expression(XPathExpression_Impl &expression, XPathToken &token) const;
+		int parse_primary_expression(XPathExpression_Impl &expression, XPathToken &token) const;
+		int parse_predicate(XPathExpression_Impl &expression, XPathToken &token) const;
+		void parse_location_steps(XPathExpression_Impl &expression, XPathToken &token, std::vector<XPathLocationStep> &steps) const;
+		void parse_location_step(XPathExpression_Impl &expression, XPathToken &token, XPathLocationStep &step) const;
+		void optimize_location_steps(const XPathExpression_Impl &expression, std::vector<XPathLocationStep> &steps) const;
+		bool get_fast_predicate(const XPathExpression_Impl &expression, int predicate, XPathLocationStep::FastPredicate &fast_predicate) const;
+		bool get_attribute_name(const XPathExpression_Impl &expression, int node_index, std::string &name) const;
+		XPathFunction find_function(const std::string &name) const;
+
+		static int add_node(XPathExpression_Impl &expression, const XPathExpressionNode &node);
+		static int get_precedence(const XPathToken &token);
+		static bool is_location_step(const XPathToken &token);
+		static bool is_operator(const XPathToken &token, Operator oper);
+
+		XPathObject evaluate(const XPathExpression_Impl &expression, int node_index, const XPathNodeSet &context, XPathNodeSet::size_type context_node_index) const;
+		void select_nodes(const XPathExpression_Impl &expression, int node_index, const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, XPathNodeSet &out_nodes) const;
+		void select_location_steps(const XPathExpression_Impl &expression, const std::vector<XPathLocationStep> &steps, XPathNodeSet &nodes) const;
+		void select_axis(const DomNode &node, const XPathLocationStep &step, XPathNodeSet &out_nodes) const;
+		void select_descendants(const DomNode &node, const XPathLocationStep &step, XPathNodeSet &out_nodes) const;
+		void filter_predicates(const XPathExpression_Impl &expression, const std::vector<int> &predicates, XPathNodeSet &nodes) const;
+		bool confirm_step_requirements(const DomNode &node, const XPathLocationStep &step) const;
+		bool confirm_step_predicate(const XPathExpression_Impl &expression, int predicate, const XPathNodeSet &context, XPathNodeSet::size_type context_node_index) const;
+		void append_unique(XPathNodeSet &nodes, const XPathNodeSet &new_nodes) const;
+		void sort_document_order(XPathNodeSet &nodes) const;
+
+		bool select_tree_nodes(const XPathExpressionNode &path, const DomNode &context_node, XPathNodeSet &out_nodes) const;
+		void select_tree_axis(const DomDocument_Impl *doc, unsigned int node_index, const XPathLocationStep &step, std::vector<unsigned int> &out_nodes) const;
+		void filter_tree_predicates(const DomDocument_Impl *doc, const XPathLocationStep &step, std::vector<unsigned int> &nodes) const;
+		bool confirm_tree_node(const DomDocument_Impl *doc_impl, const DomTreeNode *tree_node, const XPathLocationStep &step) const;
 
 		template<typename T>
 		bool compare(const T &a, const T &b, Operator oper) const;
@@ -75,53 +96,10 @@ namespace clan
 		bool compare_number(const Operand &a, const Operand &b, Operator oper) const;
 		bool compare_string(const Operand &a, const Operand &b, Operator oper) const;
 
-		XPathToken read_location_path(
-			const std::string &expression,
-			XPathToken cur_token,
-			const XPathNodeSet &context,
-			XPathNodeSet::size_type context_node_index,
-			std::vector<Operand> &operand_stack) const;
-
-		XPathToken read_location_steps(
-			const std::string &expression,
-			XPathToken cur_token,
-			const XPathNodeSet &context,
-			XPathNodeSet::size_type context_node_index,
-			std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const;
-
-		XPathToken read_location_step(
-			const std::string &expression,
-			XPathToken cur_token,
-			XPathLocationStep &step) const;
-
 		XPathToken read_token(
 			const std::string &expression,
 			const XPathToken &previous_token = XPathToken()) const;
 
-		XPathToken skip_predicate_expression(
-			const std::string &expression,
-			const XPathToken &previous_token = XPathToken()) const;
-
-		void evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string & expression, XPathNodeSet & nodes) const;
-
-		void select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		void select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-		bool confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const;
-		bool confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const;
-
-		XPathObject call_function(const XPathNodeSet& context, XPathNodeSet::size_type context_node_index, const std::string &name, const std::vector<XPathObject> &parameters) const;
 		XPathObject get_variable(const std::string &name) const;
 
 		XPathObject function_last(const XPathNodeSet& context, XPathNodeSet::size_type context_node_index, const std::vector<XPathObject> &parameters) const;
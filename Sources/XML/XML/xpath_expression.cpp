@@ -0,0 +1,105 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include "XML/precomp.h"
+#include "API/XML/xpath_expression.h"
+#include "API/XML/xpath_exception.h"
+#include "API/XML/dom_node.h"
+#include "xpath_evaluator_impl.h"
+#include "xpath_expression_impl.h"
+
+namespace clan
+{
+	XPathExpression::XPathExpression()
+	{
+	}
+
+	XPathExpression::XPathExpression(const std::string &expression)
+		: impl(XPathEvaluator_Impl().compile(expression))
+	{
+	}
+
+	XPathExpression::XPathExpression(const std::shared_ptr<XPathExpression_Impl> &impl)
+		: impl(impl)
+	{
+	}
+
+	void XPathExpression::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("XPathExpression is null");
+	}
+
+	const std::string &XPathExpression::get_expression() const
+	{
+		throw_if_null();
+		return impl->expression;
+	}
+
+	XPathObject XPathExpression::evaluate(const DomNode &context_node) const
+	{
+		throw_if_null();
+		return XPathEvaluator_Impl().evaluate(*impl, context_node);
+	}
+
+	void XPathExpression::select_nodes(const DomNode &context_node, std::vector<DomNode> &out_nodes) const
+	{
+		throw_if_null();
+		XPathEvaluator_Impl().select_nodes(*impl, context_node, out_nodes);
+	}
+
+	DomNode XPathExpression::select_node(const DomNode &context_node) const
+	{
+		std::vector<DomNode> nodes;
+		select_nodes(context_node, nodes);
+		return nodes.empty() ? DomNode() : nodes.front();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<XPathExpression_Impl> XPathExpressionCache::get(const std::string &expression)
+	{
+		static XPathExpressionCache cache;
+
+		{
+			std::lock_guard<std::mutex> lock(cache.mutex);
+			auto it = cache.expressions.find(expression);
+			if (it != cache.expressions.end())
+				return it->second;
+		}
+
+		std::shared_ptr<XPathExpression_Impl> impl = XPathEvaluator_Impl().compile(expression);
+
+		std::lock_guard<std::mutex> lock(cache.mutex);
+		if (cache.expressions.size() >= max_entries)
+			cache.expressions.clear();
+		cache.expressions[expression] = impl;
+		return impl;
+	}
+}
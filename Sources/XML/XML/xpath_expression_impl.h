@@ -0,0 +1,99 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/XML/xpath_object.h"
+#include "xpath_token.h"
+#include "xpath_location_step.h"
+#include <unordered_map>
+#include <mutex>
+
+namespace clan
+{
+	class XPathEvaluator_Impl;
+
+	typedef XPathObject (XPathEvaluator_Impl::*XPathFunction)(const std::vector<DomNode> &context, std::vector<DomNode>::size_type context_node_index, const std::vector<XPathObject> &parameters) const;
+
+	/// \brief Node in the syntax tree of a compiled XPath expression.
+	class XPathExpressionNode
+	{
+	public:
+		enum Type
+		{
+			type_constant,       // Literal or number
+			type_variable,       // $name
+			type_function,       // name(operands...)
+			type_operator,       // operands[0] oper operands[1]
+			type_negate,         // -operands[0]
+			type_location_path,  // [/]step/step...
+			type_filter          // operands[0][predicates]/step/step...
+		};
+
+		XPathExpressionNode(Type type = type_constant) : type(type), oper(XPathToken::operator_parenthesis_begin), function(nullptr), absolute(false), fast(false) { }
+
+		Type type;
+		XPathToken::Operator oper;
+		XPathObject value;
+		std::string name;
+		XPathFunction function;
+		std::vector<int> operands;
+
+		/// \brief Predicates of a filter expression
+		std::vector<int> predicates;
+
+		/// \brief Location path starts at the root node
+		bool absolute;
+		std::vector<XPathLocationStep> steps;
+
+		/// \brief True if all steps are fast steps
+		bool fast;
+	};
+
+	class XPathExpression_Impl
+	{
+	public:
+		std::string expression;
+		std::vector<XPathExpressionNode> nodes;
+		int root = -1;
+	};
+
+	/// \brief Process wide cache of compiled expressions, used when evaluating expression strings.
+	class XPathExpressionCache
+	{
+	public:
+		static std::shared_ptr<XPathExpression_Impl> get(const std::string &expression);
+
+	private:
+		static const size_t max_entries = 256;
+
+		std::mutex mutex;
+		std::unordered_map<std::string, std::shared_ptr<XPathExpression_Impl>> expressions;
+	};
+}
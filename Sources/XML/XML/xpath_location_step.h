@@ -29,6 +29,7 @@
 #pragma once
 
 #include "xpath_token.h"
+#include <vector>
 
 namespace clan
 {
@@ -36,10 +37,27 @@ namespace clan
 	{
 	public:
 		XPathLocationStep()
-			: test_type(type_none)
+			: axis(axis_child), test_type(type_none), node_type(XPathToken::node_type_node), fast(false)
 		{
 		}
 
+		enum Axis
+		{
+			axis_ancestor,
+			axis_ancestor_or_self,
+			axis_attribute,
+			axis_child,
+			axis_descendant,
+			axis_descendant_or_self,
+			axis_following,
+			axis_following_sibling,
+			axis_namespace,
+			axis_parent,
+			axis_preceding,
+			axis_preceding_sibling,
+			axis_self
+		};
+
 		enum TestType
 		{
 			type_none,
@@ -47,16 +65,32 @@ namespace clan
 			type_node,
 		};
 
-		std::string axis;
-		TestType test_type;
-		std::string test_str;
-
-		struct Predicate
+		/// \brief Predicate that can be tested directly on the DOM tree.
+		struct FastPredicate
 		{
-			std::string::size_type pos, length;
+			enum Type
+			{
+				type_position,         // [2]
+				type_attribute,        // [@name]
+				type_attribute_equal   // [@name='value']
+			};
+
+			Type type;
+			size_t position;
+			std::string name;
+			std::string value;
 		};
 
+		Axis axis;
+		TestType test_type;
+		std::string test_str;
 		XPathToken::NodeType node_type;
-		std::vector<Predicate> predicates;
+
+		/// \brief Predicate expressions (indices into XPathExpression_Impl::nodes)
+		std::vector<int> predicates;
+
+		/// \brief True if the axis and all predicates can be evaluated directly on the DOM tree
+		bool fast;
+		std::vector<FastPredicate> fast_predicates;
 	};
 }
@@ -52,10 +52,13 @@ int TestApp::main()
 		Console::write_line("Directory: API/Core/Math");
 
 		test_md5();
+		test_exptmod();
 		test_rsa();
 		test_aes128();
 		test_aes192();
 		test_aes256();
+		test_aes_ctr();
+		test_aes_gcm();
 		test_sha1();
 		test_sha224();
 		test_sha256();
@@ -63,6 +66,7 @@ int TestApp::main()
 		test_sha512();
 		test_sha512_224();
 		test_sha512_256();
+		test_sha_multi_buffer();
 
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
@@ -56,6 +56,7 @@ using namespace clan;
 #endif
 
 #include <cstring>
+#include <algorithm>
 
 class TestApp
 {
@@ -68,9 +69,15 @@ private:
 	void test_aes192_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
 	void test_aes256();
 	void test_aes256_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
+	void test_aes_ctr();
+	void test_aes_ctr_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
+	void test_aes_gcm();
+	void test_aes_gcm_helper(const char *key_ptr, const char *iv_ptr, const char *aad_ptr, const char *plaintext_ptr, const char *ciphertext_ptr, const char *tag_ptr);
 	void convert_ascii(const char *src, std::vector<unsigned char> &dest);
 
 	void test_rsa();
+	void test_exptmod();
+	void test_exptmod_helper(Random &random, int modulus_bits, int exponent_bits);
 	void test_md5();
 	void test_hash(const MD5 &sha1, const char *hash_text);
 	void test_sha1();
@@ -86,6 +93,7 @@ private:
 	void test_sha512_224();
 	void test_hash(const SHA512_224 &sha512_224, const char *hash_text);
 	void test_sha512_256();
+	void test_sha_multi_buffer();
 	void test_hash(const SHA512_256 &sha512_256, const char *hash_text);
 public:
 	void fail() const;
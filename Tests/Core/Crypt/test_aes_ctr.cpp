@@ -0,0 +1,147 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_aes_ctr()
+{
+	Console::write_line(" Header: aes_ctr.h");
+	Console::write_line("  Class: AES_CTR");
+
+	// Test data from http://csrc.nist.gov/publications/nistpubs/800-38a/sp800-38a.pdf (F.5.1 and F.5.5)
+
+	test_aes_ctr_helper(
+		"2b7e151628aed2a6abf7158809cf4f3c",	// KEY
+		"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",	// COUNTER
+		"6bc1bee22e409f96e93d7e117393172a"	// PLAINTEXT
+		"ae2d8a571e03ac9c9eb76fac45af8e51"
+		"30c81c46a35ce411e5fbc1191a0a52ef"
+		"f69f2445df4f9b17ad2b417be66c3710",
+		"874d6191b620e3261bef6864990db6ce"	// CIPHERTEXT
+		"9806f66b7970fdff8617187bb9fffdff"
+		"5ae4df3edbd5d35e5b4f09020db03eab"
+		"1e031dda2fbe03d1792170a0f3009cee"
+		);
+
+	test_aes_ctr_helper(
+		"603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",	// KEY
+		"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",	// COUNTER
+		"6bc1bee22e409f96e93d7e117393172a"	// PLAINTEXT
+		"ae2d8a571e03ac9c9eb76fac45af8e51"
+		"30c81c46a35ce411e5fbc1191a0a52ef"
+		"f69f2445df4f9b17ad2b417be66c3710",
+		"601ec313775789a5b7a7f504bbf3d228"	// CIPHERTEXT
+		"f443e3ca4d62b59aca84e990cacaf5c5"
+		"2b0930daa23de94ce87017ba2d84988d"
+		"dfc9c58db67aada613c2dd08457941a6"
+		);
+
+	// Feed odd sized pieces, to test the keystream carried between add() calls and the counter wrapping
+	const int test_data_length = 1000;
+	unsigned char test_data[test_data_length];
+	for (int cnt = 0; cnt < test_data_length; cnt++)
+		test_data[cnt] = (unsigned char)cnt;
+
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> iv;
+	convert_ascii("000102030405060708090a0b0c0d0e0f1011121314151617", key);
+	convert_ascii("fffffffffffffffffffffffffffffff0", iv);
+
+	AES_CTR reference;
+	reference.set_iv(&iv[0]);
+	reference.set_key(&key[0], key.size());
+	reference.add(test_data, test_data_length);
+	reference.calculate();
+	DataBuffer reference_buffer = reference.get_data();
+	if (reference_buffer.get_size() != test_data_length)
+		fail();
+
+	for (int piece_size = 1; piece_size < 200; piece_size += 7)
+	{
+		AES_CTR aes_ctr;
+		aes_ctr.set_iv(&iv[0]);
+		aes_ctr.set_key(&key[0], key.size());
+		for (int offset = 0; offset < test_data_length; offset += piece_size)
+			aes_ctr.add(test_data + offset, std::min(piece_size, test_data_length - offset));
+		aes_ctr.calculate();
+		DataBuffer buffer = aes_ctr.get_data();
+		if (buffer.get_size() != test_data_length)
+			fail();
+		if (memcmp(buffer.get_data(), reference_buffer.get_data(), test_data_length))
+			fail();
+
+		AES_CTR aes_ctr_decrypt;
+		aes_ctr_decrypt.set_iv(&iv[0]);
+		aes_ctr_decrypt.set_key(&key[0], key.size());
+		aes_ctr_decrypt.add(buffer);
+		aes_ctr_decrypt.calculate();
+		DataBuffer buffer2 = aes_ctr_decrypt.get_data();
+		if (buffer2.get_size() != test_data_length)
+			fail();
+		if (memcmp(buffer2.get_data(), test_data, test_data_length))
+			fail();
+	}
+}
+
+void TestApp::test_aes_ctr_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr)
+{
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> iv;
+	std::vector<unsigned char> plaintext;
+	std::vector<unsigned char> ciphertext;
+
+	convert_ascii(key_ptr, key);
+	convert_ascii(iv_ptr, iv);
+	convert_ascii(plaintext_ptr, plaintext);
+	convert_ascii(ciphertext_ptr, ciphertext);
+
+	AES_CTR aes_ctr;
+	aes_ctr.set_iv(&iv[0]);
+	aes_ctr.set_key(&key[0], key.size());
+	aes_ctr.add(&plaintext[0], plaintext.size());
+	aes_ctr.calculate();
+	DataBuffer buffer = aes_ctr.get_data();
+	if (buffer.get_size() != ciphertext.size())
+		fail();
+	unsigned char *data_ptr = (unsigned char *) buffer.get_data();
+	if (memcmp(data_ptr, &ciphertext[0], ciphertext.size()))
+		fail();
+
+	AES_CTR aes_ctr_decrypt;
+	aes_ctr_decrypt.set_iv(&iv[0]);
+	aes_ctr_decrypt.set_key(&key[0], key.size());
+	aes_ctr_decrypt.add(data_ptr, buffer.get_size());
+	aes_ctr_decrypt.calculate();
+	DataBuffer buffer2 = aes_ctr_decrypt.get_data();
+	if (buffer2.get_size() != plaintext.size())
+		fail();
+	unsigned char *data_ptr2 = (unsigned char *) buffer2.get_data();
+	if (memcmp(data_ptr2, &plaintext[0], plaintext.size()))
+		fail();
+}
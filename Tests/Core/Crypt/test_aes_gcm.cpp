@@ -0,0 +1,197 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_aes_gcm()
+{
+	Console::write_line(" Header: aes_gcm_encrypt.h and aes_gcm_decrypt.h");
+	Console::write_line("  Class: AES_GCM_Encrypt and AES_GCM_Decrypt");
+
+	// Test data from "The Galois/Counter Mode of Operation (GCM)", McGrew and Viega (Test Cases 2 to 5)
+
+	test_aes_gcm_helper(
+		"00000000000000000000000000000000",	// KEY
+		"000000000000000000000000",	// IV
+		"",	// ADDITIONAL DATA
+		"00000000000000000000000000000000",	// PLAINTEXT
+		"0388dace60b6a392f328c2b971b2fe78",	// CIPHERTEXT
+		"ab6e47d42cec13bdf53a67b21257bddf"	// TAG
+		);
+
+	test_aes_gcm_helper(
+		"feffe9928665731c6d6a8f9467308308",	// KEY
+		"cafebabefacedbaddecaf888",	// IV
+		"",	// ADDITIONAL DATA
+		"d9313225f88406e5a55909c5aff5269a"	// PLAINTEXT
+		"86a7a9531534f7da2e4c303d8a318a72"
+		"1c3c0c95956809532fcf0e2449a6b525"
+		"b16aedf5aa0de657ba637b391aafd255",
+		"42831ec2217774244b7221b784d0d49c"	// CIPHERTEXT
+		"e3aa212f2c02a4e035c17e2329aca12e"
+		"21d514b25466931c7d8f6a5aac84aa05"
+		"1ba30b396a0aac973d58e091473f5985",
+		"4d5c2af327cd64a62cf35abd2ba6fab4"	// TAG
+		);
+
+	test_aes_gcm_helper(
+		"feffe9928665731c6d6a8f9467308308",	// KEY
+		"cafebabefacedbaddecaf888",	// IV
+		"feedfacedeadbeeffeedfacedeadbeef"	// ADDITIONAL DATA
+		"abaddad2",
+		"d9313225f88406e5a55909c5aff5269a"	// PLAINTEXT
+		"86a7a9531534f7da2e4c303d8a318a72"
+		"1c3c0c95956809532fcf0e2449a6b525"
+		"b16aedf5aa0de657ba637b39",
+		"42831ec2217774244b7221b784d0d49c"	// CIPHERTEXT
+		"e3aa212f2c02a4e035c17e2329aca12e"
+		"21d514b25466931c7d8f6a5aac84aa05"
+		"1ba30b396a0aac973d58e091",
+		"5bc94fbc3221a5db94fae95ae7121a47"	// TAG
+		);
+
+	test_aes_gcm_helper(
+		"feffe9928665731c6d6a8f9467308308",	// KEY
+		"cafebabefacedbad",	// IV
+		"feedfacedeadbeeffeedfacedeadbeef"	// ADDITIONAL DATA
+		"abaddad2",
+		"d9313225f88406e5a55909c5aff5269a"	// PLAINTEXT
+		"86a7a9531534f7da2e4c303d8a318a72"
+		"1c3c0c95956809532fcf0e2449a6b525"
+		"b16aedf5aa0de657ba637b39",
+		"61353b4c2806934a777ff51fa22a4755"	// CIPHERTEXT
+		"699b2a714fcdc6f83766e5f97b6c7423"
+		"73806900e49f24b22b097544d4896b42"
+		"4989b5e1ebac0f07c23f4598",
+		"3612d2e79e3b0785561be14aaca2fccb"	// TAG
+		);
+
+	// Roundtrip with odd sized pieces, then check that tampering is detected
+	const int test_data_length = 1000;
+	unsigned char test_data[test_data_length];
+	for (int cnt = 0; cnt < test_data_length; cnt++)
+		test_data[cnt] = (unsigned char)cnt;
+
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> iv;
+	convert_ascii("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", key);
+	convert_ascii("000102030405060708090a0b", iv);
+
+	for (int piece_size = 1; piece_size < 200; piece_size += 13)
+	{
+		AES_GCM_Encrypt aes_gcm_encrypt;
+		aes_gcm_encrypt.set_iv(&iv[0]);
+		aes_gcm_encrypt.set_key(&key[0], key.size());
+		aes_gcm_encrypt.add_additional_data(test_data, piece_size);
+		for (int offset = 0; offset < test_data_length; offset += piece_size)
+			aes_gcm_encrypt.add(test_data + offset, std::min(piece_size, test_data_length - offset));
+		aes_gcm_encrypt.calculate();
+		unsigned char tag[AES_GCM_Encrypt::tag_size];
+		aes_gcm_encrypt.get_tag(tag);
+		DataBuffer buffer = aes_gcm_encrypt.get_data();
+		if (buffer.get_size() != test_data_length)
+			fail();
+
+		AES_GCM_Decrypt aes_gcm_decrypt;
+		aes_gcm_decrypt.set_iv(&iv[0]);
+		aes_gcm_decrypt.set_key(&key[0], key.size());
+		aes_gcm_decrypt.set_tag(tag);
+		aes_gcm_decrypt.add_additional_data(test_data, piece_size);
+		aes_gcm_decrypt.add(buffer);
+		if (!aes_gcm_decrypt.calculate())
+			fail();
+		DataBuffer buffer2 = aes_gcm_decrypt.get_data();
+		if (buffer2.get_size() != test_data_length)
+			fail();
+		if (memcmp(buffer2.get_data(), test_data, test_data_length))
+			fail();
+
+		buffer.get_data()[piece_size] ^= 1;
+		AES_GCM_Decrypt aes_gcm_tampered;
+		aes_gcm_tampered.set_iv(&iv[0]);
+		aes_gcm_tampered.set_key(&key[0], key.size());
+		aes_gcm_tampered.set_tag(tag);
+		aes_gcm_tampered.add_additional_data(test_data, piece_size);
+		aes_gcm_tampered.add(buffer);
+		if (aes_gcm_tampered.calculate())
+			fail();
+	}
+}
+
+void TestApp::test_aes_gcm_helper(const char *key_ptr, const char *iv_ptr, const char *aad_ptr, const char *plaintext_ptr, const char *ciphertext_ptr, const char *tag_ptr)
+{
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> iv;
+	std::vector<unsigned char> aad;
+	std::vector<unsigned char> plaintext;
+	std::vector<unsigned char> ciphertext;
+	std::vector<unsigned char> expected_tag;
+
+	convert_ascii(key_ptr, key);
+	convert_ascii(iv_ptr, iv);
+	convert_ascii(aad_ptr, aad);
+	convert_ascii(plaintext_ptr, plaintext);
+	convert_ascii(ciphertext_ptr, ciphertext);
+	convert_ascii(tag_ptr, expected_tag);
+
+	AES_GCM_Encrypt aes_gcm_encrypt;
+	aes_gcm_encrypt.set_iv(&iv[0], iv.size());
+	aes_gcm_encrypt.set_key(&key[0], key.size());
+	if (!aad.empty())
+		aes_gcm_encrypt.add_additional_data(&aad[0], aad.size());
+	aes_gcm_encrypt.add(&plaintext[0], plaintext.size());
+	aes_gcm_encrypt.calculate();
+	unsigned char tag[AES_GCM_Encrypt::tag_size];
+	aes_gcm_encrypt.get_tag(tag);
+	if (memcmp(tag, &expected_tag[0], AES_GCM_Encrypt::tag_size))
+		fail();
+	DataBuffer buffer = aes_gcm_encrypt.get_data();
+	if (buffer.get_size() != ciphertext.size())
+		fail();
+	unsigned char *data_ptr = (unsigned char *) buffer.get_data();
+	if (memcmp(data_ptr, &ciphertext[0], ciphertext.size()))
+		fail();
+
+	AES_GCM_Decrypt aes_gcm_decrypt;
+	aes_gcm_decrypt.set_iv(&iv[0], iv.size());
+	aes_gcm_decrypt.set_key(&key[0], key.size());
+	aes_gcm_decrypt.set_tag(&expected_tag[0]);
+	if (!aad.empty())
+		aes_gcm_decrypt.add_additional_data(&aad[0], aad.size());
+	aes_gcm_decrypt.add(data_ptr, buffer.get_size());
+	bool result = aes_gcm_decrypt.calculate();
+	if (!result)
+		fail();
+	DataBuffer buffer2 = aes_gcm_decrypt.get_data();
+	if (buffer2.get_size() != plaintext.size())
+		fail();
+	unsigned char *data_ptr2 = (unsigned char *) buffer2.get_data();
+	if (memcmp(data_ptr2, &plaintext[0], plaintext.size()))
+		fail();
+}
@@ -118,6 +118,129 @@ void TestApp::test_rsa()
 	if (memcmp(server.m_CryptKey.get_data(), client.m_CryptKey.get_data(), server.m_CryptKey.get_size()))
 		fail();
 
+	Console::write_line("   ... Chinese Remainder Theorem keypair");
+	Random random;
+	Secret private_exponent, prime1, prime2, exponent1, exponent2, coefficient;
+	DataBuffer public_exponent, modulus;
+	RSA::create_keypair(random, private_exponent, public_exponent, modulus, prime1, prime2, exponent1, exponent2, coefficient);
+
+	DataBuffer wrapped_key = RSA::encrypt(2, random, public_exponent, modulus, server.m_CryptKey);
+	Secret crt_key = RSA::decrypt(prime1, prime2, exponent1, exponent2, coefficient, wrapped_key);
+	Secret exponent_key = RSA::decrypt(private_exponent, modulus, wrapped_key);
+	if (crt_key.get_size() != server.m_CryptKey.get_size() || exponent_key.get_size() != server.m_CryptKey.get_size())
+		fail();
+	if (memcmp(crt_key.get_data(), server.m_CryptKey.get_data(), crt_key.get_size()))
+		fail();
+	if (memcmp(exponent_key.get_data(), server.m_CryptKey.get_data(), exponent_key.get_size()))
+		fail();
+
+	// Block type 1 padding is deterministic, so both private key forms give the same signature
+	DataBuffer private_exponent_buffer(private_exponent.get_data(), private_exponent.get_size());
+	DataBuffer crt_signature = RSA::encrypt(1, random, prime1, prime2, exponent1, exponent2, coefficient, server.m_CryptKey);
+	DataBuffer exponent_signature = RSA::encrypt(1, random, private_exponent_buffer, modulus, server.m_CryptKey);
+	if (crt_signature.get_size() != exponent_signature.get_size())
+		fail();
+	if (memcmp(crt_signature.get_data(), exponent_signature.get_data(), crt_signature.get_size()))
+		fail();
+
+	Secret public_exponent_secret(public_exponent.get_size());
+	memcpy(public_exponent_secret.get_data(), public_exponent.get_data(), public_exponent.get_size());
+	DataBuffer padded_signature(modulus.get_size());
+	memset(padded_signature.get_data(), 0, padded_signature.get_size());
+	memcpy(padded_signature.get_data() + padded_signature.get_size() - crt_signature.get_size(), crt_signature.get_data(), crt_signature.get_size());
+	Secret verified = RSA::decrypt(public_exponent_secret, modulus, padded_signature);
+	if (verified.get_size() != server.m_CryptKey.get_size())
+		fail();
+	if (memcmp(verified.get_data(), server.m_CryptKey.get_data(), verified.get_size()))
+		fail();
+
+	// A faulty CRT computation must be detected instead of returning a signature that reveals a prime
+	Secret bad_coefficient(coefficient.get_size());
+	memcpy(bad_coefficient.get_data(), coefficient.get_data(), coefficient.get_size());
+	bad_coefficient.get_data()[bad_coefficient.get_size() - 1] ^= 1;
+	bool detected = false;
+	try
+	{
+		RSA::encrypt(1, random, prime1, prime2, exponent1, exponent2, bad_coefficient, server.m_CryptKey);
+	}
+	catch (const Exception &)
+	{
+		detected = true;
+	}
+	if (!detected)
+		fail();
 }
 
+void TestApp::test_exptmod()
+{
+	Console::write_line(" Header: big_int.h");
+	Console::write_line("  Class: BigInt (exptmod)");
 
+	BigInt base(4U), exponent(13U), modulus(497U), result;
+	base.exptmod(&exponent, &modulus, &result);
+	if (result.cmp_d(445))
+		fail();
+	base.exptmod_secret(&exponent, &modulus, &result);
+	if (result.cmp_d(445))
+		fail();
+
+	// Zero exponent and a modulus of one
+	BigInt zero, one(1U);
+	base.exptmod(&zero, &modulus, &result);
+	if (result.cmp_d(1))
+		fail();
+	base.exptmod_secret(&exponent, &one, &result);
+	if (result.cmp_z())
+		fail();
+
+	// Sizes below and above the Karatsuba threshold, including odd limb counts
+	Random random;
+	test_exptmod_helper(random, 64, 64);
+	test_exptmod_helper(random, 96, 33);
+	test_exptmod_helper(random, 512, 512);
+	test_exptmod_helper(random, 1024, 17);
+	test_exptmod_helper(random, 1600, 300);
+	test_exptmod_helper(random, 2048, 256);
+	test_exptmod_helper(random, 3104, 100);
+	test_exptmod_helper(random, 4096, 128);
+	test_exptmod_helper(random, 4160, 64);
+}
+
+void TestApp::test_exptmod_helper(Random &random, int modulus_bits, int exponent_bits)
+{
+	std::vector<unsigned char> buffer(modulus_bits / 8 * 3);
+
+	random.get_random_bytes(&buffer[0], modulus_bits / 8);
+	buffer[0] |= 0x80;
+	buffer[modulus_bits / 8 - 1] |= 0x01;
+	BigInt modulus;
+	modulus.read_unsigned_octets(&buffer[0], modulus_bits / 8);
+
+	random.get_random_bytes(&buffer[0], exponent_bits / 8 + 1);
+	BigInt exponent;
+	exponent.read_unsigned_octets(&buffer[0], exponent_bits / 8 + 1);
+
+	// Bases below the modulus, up to twice its size, and larger still (which needs a division first)
+	const int base_sizes[] = { modulus_bits / 8 - 1, modulus_bits / 8 * 2, modulus_bits / 8 * 3 };
+	for (int size : base_sizes)
+	{
+		random.get_random_bytes(&buffer[0], size);
+		BigInt base;
+		base.read_unsigned_octets(&buffer[0], size);
+
+		// Reference result, using Barrett's reduction with the even modulus 2m
+		BigInt even_modulus = modulus * 2U;
+		BigInt expected;
+		base.exptmod(&exponent, &even_modulus, &expected);
+		expected.mod(&modulus, &expected);
+
+		BigInt result;
+		base.exptmod(&exponent, &modulus, &result);
+		if (result.cmp(&expected))
+			fail();
+
+		base.exptmod_secret(&exponent, &modulus, &result);
+		if (result.cmp(&expected))
+			fail();
+	}
+}
@@ -0,0 +1,135 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_sha_multi_buffer()
+{
+	Console::write_line(" Header: hash_functions.h");
+	Console::write_line("  Class: HashFunctions (multi buffer and tree hashes)");
+
+	// Messages of every size around the block and padding boundaries, hashed in one call
+	const int num_messages = 300;
+	std::vector<unsigned char> test_data(num_messages);
+	for (int cnt = 0; cnt < num_messages; cnt++)
+		test_data[cnt] = (unsigned char)(cnt * 7 + 3);
+
+	std::vector<const void *> data(num_messages);
+	std::vector<int> sizes(num_messages);
+	for (int cnt = 0; cnt < num_messages; cnt++)
+	{
+		// Odd sizes first, so the lanes finish at different times
+		sizes[cnt] = (cnt * 131) % num_messages;
+		data[cnt] = &test_data[0];
+	}
+
+	std::vector<unsigned char> hashes1(num_messages * SHA1::hash_size);
+	std::vector<unsigned char> hashes256(num_messages * SHA256::hash_size);
+	HashFunctions::sha1_multi_buffer(num_messages, &data[0], &sizes[0], &hashes1[0]);
+	HashFunctions::sha256_multi_buffer(num_messages, &data[0], &sizes[0], &hashes256[0]);
+
+	for (int cnt = 0; cnt < num_messages; cnt++)
+	{
+		unsigned char hash1[SHA1::hash_size];
+		HashFunctions::sha1(data[cnt], sizes[cnt], hash1);
+		if (memcmp(hash1, &hashes1[cnt * SHA1::hash_size], SHA1::hash_size))
+			fail();
+
+		unsigned char hash256[SHA256::hash_size];
+		HashFunctions::sha256(data[cnt], sizes[cnt], hash256);
+		if (memcmp(hash256, &hashes256[cnt * SHA256::hash_size], SHA256::hash_size))
+			fail();
+	}
+
+	// A single large message among small ones
+	std::vector<unsigned char> large_data(100000);
+	for (size_t cnt = 0; cnt < large_data.size(); cnt++)
+		large_data[cnt] = (unsigned char)(cnt >> 3);
+	data[5] = &large_data[0];
+	sizes[5] = large_data.size();
+	HashFunctions::sha256_multi_buffer(num_messages, &data[0], &sizes[0], &hashes256[0]);
+	unsigned char large_hash[SHA256::hash_size];
+	HashFunctions::sha256(&large_data[0], large_data.size(), large_hash);
+	if (memcmp(large_hash, &hashes256[5 * SHA256::hash_size], SHA256::hash_size))
+		fail();
+
+	// Tree hashes, compared to the tree built with the SHA256 class
+	const int leaf_size = 100;
+	for (int size = 0; size < 1200; size += 97)
+	{
+		std::vector<std::string> level;
+		int pos = 0;
+		do
+		{
+			SHA256 leaf;
+			unsigned char prefix = 0;
+			leaf.add(&prefix, 1);
+			leaf.add(&large_data[pos], min(leaf_size, size - pos));
+			leaf.calculate();
+			unsigned char hash[SHA256::hash_size];
+			leaf.get_hash(hash);
+			level.push_back(std::string((const char *)hash, SHA256::hash_size));
+			pos += leaf_size;
+		} while (pos < size);
+
+		while (level.size() > 1)
+		{
+			std::vector<std::string> parents;
+			for (size_t node = 0; node + 1 < level.size(); node += 2)
+			{
+				SHA256 parent;
+				unsigned char prefix = 1;
+				parent.add(&prefix, 1);
+				parent.add(level[node].data(), SHA256::hash_size);
+				parent.add(level[node + 1].data(), SHA256::hash_size);
+				parent.calculate();
+				unsigned char hash[SHA256::hash_size];
+				parent.get_hash(hash);
+				parents.push_back(std::string((const char *)hash, SHA256::hash_size));
+			}
+			if (level.size() & 1)
+				parents.push_back(level.back());
+			level.swap(parents);
+		}
+
+		unsigned char tree_hash[SHA256::hash_size];
+		HashFunctions::sha256_tree(&large_data[0], size, tree_hash, leaf_size);
+		if (memcmp(tree_hash, level[0].data(), SHA256::hash_size))
+			fail();
+
+		DataBuffer buffer(&large_data[0], size);
+		MemoryDevice device(buffer);
+		HashFunctions::sha256_tree(device, tree_hash, leaf_size);
+		if (memcmp(tree_hash, level[0].data(), SHA256::hash_size))
+			fail();
+	}
+
+	if (HashFunctions::sha256_tree(&large_data[0], 0) != "6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d")
+		fail();
+}
@@ -0,0 +1,207 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <thread>
+using namespace clan;
+
+const int data_size = 16 * 1024 * 1024;
+const int num_passes = 3;
+
+template<typename Func>
+void run_benchmark(const char *name, Func func)
+{
+	double best_seconds = 0.0;
+	for (int pass = 0; pass < num_passes; pass++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		func();
+		uint64_t end_time = System::get_microseconds();
+		double seconds = (end_time - start_time) / 1000000.0;
+		if (pass == 0 || seconds < best_seconds)
+			best_seconds = seconds;
+	}
+	Console::write_line("  %1: %2 ms, %3 GB/s", name, StringHelp::float_to_text((float)(best_seconds * 1000.0), 1), StringHelp::float_to_text((float)(data_size / best_seconds / (1024 * 1024 * 1024)), 2));
+}
+
+template<typename Func>
+void run_ops_benchmark(const char *name, int num_ops, Func func)
+{
+	double best_seconds = 0.0;
+	for (int pass = 0; pass < num_passes; pass++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		for (int cnt = 0; cnt < num_ops; cnt++)
+			func();
+		uint64_t end_time = System::get_microseconds();
+		double seconds = (end_time - start_time) / 1000000.0;
+		if (pass == 0 || seconds < best_seconds)
+			best_seconds = seconds;
+	}
+	Console::write_line("  %1: %2 ms, %3 ops/s", name, StringHelp::float_to_text((float)(best_seconds * 1000.0 / num_ops), 2), StringHelp::float_to_text((float)(num_ops / best_seconds), 1));
+}
+
+void benchmark_aes(const DataBuffer &data)
+{
+	unsigned char key[32];
+	unsigned char iv[16];
+	for (int cnt = 0; cnt < 32; cnt++)
+		key[cnt] = (unsigned char)(cnt * 7);
+	for (int cnt = 0; cnt < 16; cnt++)
+		iv[cnt] = (unsigned char)(cnt * 13);
+
+	Console::write_line("AES-256, %1 MB", data_size / (1024 * 1024));
+
+	run_benchmark("CBC encrypt (AES256_Encrypt)", [&]()
+	{
+		AES256_Encrypt aes;
+		aes.set_padding(false);
+		aes.set_iv(iv);
+		aes.set_key(key);
+		aes.add(data);
+		aes.calculate();
+	});
+
+	run_benchmark("CBC decrypt (AES256_Decrypt)", [&]()
+	{
+		AES256_Decrypt aes;
+		aes.set_padding(false);
+		aes.set_iv(iv);
+		aes.set_key(key);
+		aes.add(data);
+		aes.calculate();
+	});
+
+	run_benchmark("CTR (AES_CTR)", [&]()
+	{
+		AES_CTR aes;
+		aes.set_iv(iv);
+		aes.set_key(key, 32);
+		aes.add(data);
+		aes.calculate();
+	});
+
+	run_benchmark("GCM encrypt (AES_GCM_Encrypt)", [&]()
+	{
+		AES_GCM_Encrypt aes;
+		aes.set_iv(iv);
+		aes.set_key(key, 32);
+		aes.add(data);
+		aes.calculate();
+	});
+}
+
+void benchmark_sha(const DataBuffer &data)
+{
+	Console::write_line("SHA, %1 MB", data_size / (1024 * 1024));
+
+	run_benchmark("SHA-1", [&]() { unsigned char hash[SHA1::hash_size]; HashFunctions::sha1(data, hash); });
+	run_benchmark("SHA-256", [&]() { unsigned char hash[SHA256::hash_size]; HashFunctions::sha256(data, hash); });
+	run_benchmark("SHA-512", [&]() { unsigned char hash[SHA512::hash_size]; HashFunctions::sha512(data, hash); });
+
+	// Patch chunk sized messages
+	const int message_size = 4096;
+	const int num_messages = data_size / message_size;
+	std::vector<const void *> messages(num_messages);
+	std::vector<int> sizes(num_messages, message_size);
+	for (int cnt = 0; cnt < num_messages; cnt++)
+		messages[cnt] = data.get_data() + cnt * message_size;
+	std::vector<unsigned char> hashes(num_messages * SHA256::hash_size);
+
+	run_benchmark("SHA-1, one by one (4 KB messages)", [&]()
+	{
+		for (int cnt = 0; cnt < num_messages; cnt++)
+			HashFunctions::sha1(messages[cnt], message_size, &hashes[cnt * SHA1::hash_size]);
+	});
+	run_benchmark("SHA-1, multi buffer (4 KB messages)", [&]() { HashFunctions::sha1_multi_buffer(num_messages, &messages[0], &sizes[0], &hashes[0]); });
+	run_benchmark("SHA-256, one by one (4 KB messages)", [&]()
+	{
+		for (int cnt = 0; cnt < num_messages; cnt++)
+			HashFunctions::sha256(messages[cnt], message_size, &hashes[cnt * SHA256::hash_size]);
+	});
+	run_benchmark("SHA-256, multi buffer (4 KB messages)", [&]() { HashFunctions::sha256_multi_buffer(num_messages, &messages[0], &sizes[0], &hashes[0]); });
+	run_benchmark("SHA-256 tree hash (64 KB leaves)", [&]() { unsigned char hash[SHA256::hash_size]; HashFunctions::sha256_tree(data.get_data(), data.get_size(), hash, 64 * 1024); });
+}
+
+void benchmark_rsa(int key_size_in_bits, int num_private_ops)
+{
+	Console::write_line("RSA-%1", key_size_in_bits);
+
+	Random random;
+	Secret private_exponent, prime1, prime2, exponent1, exponent2, coefficient;
+	DataBuffer public_exponent, modulus;
+
+	uint64_t start_time = System::get_microseconds();
+	RSA::create_keypair(random, private_exponent, public_exponent, modulus, prime1, prime2, exponent1, exponent2, coefficient, key_size_in_bits);
+	uint64_t end_time = System::get_microseconds();
+	Console::write_line("  Key generation: %1 ms", StringHelp::float_to_text((float)((end_time - start_time) / 1000.0), 1));
+
+	Secret message(32);
+	random.get_random_bytes(message.get_data(), message.get_size());
+	DataBuffer encrypted;
+
+	run_ops_benchmark("Public key encrypt", num_private_ops * 20, [&]() { encrypted = RSA::encrypt(2, random, public_exponent, modulus, message); });
+	run_ops_benchmark("Private key decrypt (exponent)", num_private_ops, [&]() { RSA::decrypt(private_exponent, modulus, encrypted); });
+	run_ops_benchmark("Private key decrypt (CRT)", num_private_ops, [&]() { RSA::decrypt(prime1, prime2, exponent1, exponent2, coefficient, encrypted); });
+	run_ops_benchmark("Private key sign (CRT)", num_private_ops, [&]() { RSA::encrypt(1, random, prime1, prime2, exponent1, exponent2, coefficient, message); });
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("Crypto benchmark");
+		Console::write_line("AES-NI: %1, PCLMULQDQ: %2, SHA: %3, AVX2: %4, threads: %5",
+			System::detect_cpu_extension(System::aes) ? "yes" : "no",
+			System::detect_cpu_extension(System::pclmul) ? "yes" : "no",
+			System::detect_cpu_extension(System::sha) ? "yes" : "no",
+			System::detect_cpu_extension(System::avx2) ? "yes" : "no",
+			(int)std::thread::hardware_concurrency());
+
+		DataBuffer data(data_size);
+		for (int cnt = 0; cnt < data_size; cnt++)
+			data[cnt] = (char)(cnt * 31);
+
+		benchmark_aes(data);
+		benchmark_sha(data);
+		benchmark_rsa(2048, 20);
+		benchmark_rsa(4096, 4);
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/xml.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+using namespace clan;
+
+// Live heap bytes, to measure the memory used by the loaded document
+static std::atomic<size_t> allocated_bytes(0);
+
+void *operator new(size_t size)
+{
+	size_t *block = static_cast<size_t*>(std::malloc(size + sizeof(size_t) * 2));
+	if (!block)
+		throw std::bad_alloc();
+	block[0] = size;
+	allocated_bytes += size;
+	return block + 2;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	if (ptr)
+	{
+		size_t *block = static_cast<size_t*>(ptr) - 2;
+		allocated_bytes -= block[0];
+		std::free(block);
+	}
+}
+
+DataBuffer create_map(int num_tiles)
+{
+	std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<map xmlns=\"http://example.com/map\" name=\"Test map\">\n";
+	for (int tile = 0; tile < num_tiles; tile++)
+	{
+		xml += string_format("\t<tile id=\"%1\" x=\"%2\" y=\"%3\" layer=\"ground\">\n", tile, tile % 256, tile / 256);
+		xml += string_format("\t\t<object type=\"tree\" health=\"%1\"/>\n", tile % 100);
+		xml += string_format("\t\t<label>Tile %1 &lt;%2&gt;</label>\n", tile, tile % 7);
+		xml += "\t</tile>\n";
+	}
+	xml += "</map>\n";
+	return DataBuffer(xml.data(), xml.length());
+}
+
+int count_nodes(const DomNode &node)
+{
+	int count = 1 + node.get_attributes().get_length();
+	for (DomNode child = node.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+		count += count_nodes(child);
+	return count;
+}
+
+void verify(DomDocument &document, int num_tiles)
+{
+	DomElement map = document.get_document_element();
+	if (map.get_tag_name() != "map" || map.get_namespace_uri() != "http://example.com/map" || map.get_attribute("name") != "Test map")
+		throw Exception("Map element differs");
+
+	DomElement last = map.get_last_child().to_element();
+	if (last.get_attribute("id") != StringHelp::int_to_text(num_tiles - 1) || last.get_namespace_uri() != "http://example.com/map")
+		throw Exception("Last tile differs");
+	if (last.get_child_string("label") != string_format("Tile %1 <%2>", num_tiles - 1, (num_tiles - 1) % 7))
+		throw Exception("Label differs");
+	if (last.get_first_child_element().get_attribute_int("health") != (num_tiles - 1) % 100)
+		throw Exception("Object differs");
+}
+
+void verify_namespaces()
+{
+	const char *xml = "<r xmlns:a=\"urn:a\"><a:x a:y=\"1\" z=\"&quot;2&quot;\"><b xmlns=\"urn:b\"><c/></b><c/></a:x></r>";
+	DataBuffer data(xml, strlen(xml));
+	MemoryDevice device(data);
+	DomDocument document(device);
+
+	DomElement x = document.get_document_element().get_first_child_element();
+	if (x.get_namespace_uri() != "urn:a" || x.get_local_name() != "x")
+		throw Exception("Prefixed element namespace differs");
+	if (x.get_attribute_ns("urn:a", "y") != "1" || x.get_attribute("z") != "\"2\"")
+		throw Exception("Attribute namespace differs");
+	if (x.get_first_child_element().get_first_child_element().get_namespace_uri() != "urn:b" || !x.get_last_child().to_element().get_namespace_uri().empty())
+		throw Exception("Default namespace scope differs");
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("DOM benchmark");
+
+		verify_namespaces();
+
+		const int num_tiles = 200000;
+		DataBuffer data = create_map(num_tiles);
+		Console::write_line("%1 MB map", StringHelp::float_to_text(data.get_size() / (1024.0f * 1024.0f), 1));
+
+		for (int pass = 0; pass < 3; pass++)
+		{
+			size_t start_bytes = allocated_bytes;
+			uint64_t start_time = System::get_microseconds();
+
+			MemoryDevice device(data);
+			DomDocument document(device);
+
+			uint64_t end_time = System::get_microseconds();
+			size_t document_bytes = allocated_bytes - start_bytes;
+
+			verify(document, num_tiles);
+			int num_nodes = count_nodes(document);
+
+			Console::write_line("  Load: %1 ms, %2 nodes, %3 MB, %4 bytes per node", (int)((end_time - start_time) / 1000), num_nodes,
+				StringHelp::float_to_text(document_bytes / (1024.0f * 1024.0f), 1), (int)(document_bytes / num_nodes));
+		}
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
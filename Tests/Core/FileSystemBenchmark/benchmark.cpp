@@ -0,0 +1,176 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/Core/IOData/directory_listing_entry.h>
+#include <algorithm>
+using namespace clan;
+
+// Serves a synthetic directory tree from memory, so the benchmark measures path resolution and not the OS
+class MemoryFileSystemProvider : public FileSystemProvider
+{
+public:
+	MemoryFileSystemProvider(int layer, int num_directories, int num_files) : layer(layer), scans(0), probes(0), index(0)
+	{
+		for (int dir = 0; dir < num_directories; dir++)
+		{
+			std::vector<std::string> &files = directories[string_format("data/dir%1/", dir)];
+			for (int file = 0; file < num_files; file++)
+			{
+				// Every layer only provides a part of the files, to force the search to go deep
+				if ((file + dir) % 20 == layer)
+					files.push_back(string_format("file%1.dat", file));
+			}
+		}
+	}
+
+	IODevice open_file(const std::string &filename, File::OpenMode mode, unsigned int access, unsigned int share, unsigned int flags) override
+	{
+		DataBuffer data(4);
+		return MemoryDevice(data);
+	}
+
+	bool initialize_directory_listing(const std::string &path) override
+	{
+		scans++;
+		auto it = directories.find(PathHelp::add_trailing_slash(path, PathHelp::path_type_virtual));
+		if (it == directories.end())
+			return false;
+		current = &it->second;
+		index = 0;
+		return true;
+	}
+
+	bool next_file(DirectoryListingEntry &entry) override
+	{
+		if (index >= current->size())
+			return false;
+		entry.set_filename((*current)[index++]);
+		entry.set_directory(false);
+		entry.set_readable(true);
+		return true;
+	}
+
+	bool file_exists(const std::string &filename) override
+	{
+		probes++;
+		auto it = directories.find(PathHelp::get_fullpath(filename, PathHelp::path_type_virtual));
+		return it != directories.end() && std::find(it->second.begin(), it->second.end(), PathHelp::get_filename(filename, PathHelp::path_type_virtual)) != it->second.end();
+	}
+
+	std::string get_path() const override { return std::string(); }
+	std::string get_identifier() const override { return string_format("memory%1", layer); }
+
+	int layer;
+	int scans;
+	int probes;
+
+private:
+	std::map<std::string, std::vector<std::string> > directories;
+	std::vector<std::string> *current = nullptr;
+	size_t index;
+};
+
+const int num_layers = 20;
+const int num_directories = 50;
+const int num_files = 100;
+const int num_lookups = 100000;
+
+void run_benchmark(const char *name, bool overlay, bool cache_enabled, int num_passes)
+{
+	FileSystem vfs(new MemoryFileSystemProvider(num_layers, num_directories, num_files));
+	std::vector<MemoryFileSystemProvider *> providers;
+	for (int layer = 0; layer < num_layers; layer++)
+	{
+		MemoryFileSystemProvider *provider = new MemoryFileSystemProvider(layer, num_directories, num_files);
+		providers.push_back(provider);
+		if (overlay)
+			vfs.mount_overlay(FileSystem(provider), layer);
+		else
+			vfs.mount(string_format("mount%1", layer), FileSystem(provider));
+	}
+	vfs.set_cache_enabled(cache_enabled);
+
+	std::vector<std::string> filenames;
+	for (int lookup = 0; lookup < num_lookups; lookup++)
+	{
+		int dir = lookup % num_directories;
+		int file = (lookup / num_directories) % num_files;
+		if (overlay)
+			filenames.push_back(string_format("data/dir%1/file%2.dat", dir, file));
+		else
+			filenames.push_back(string_format("mount%1/data/dir%2/file%3.dat", (dir + file) % num_layers, dir, file));
+	}
+
+	for (int pass = 0; pass < num_passes; pass++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		for (auto &filename : filenames)
+			vfs.open_file(filename);
+		uint64_t end_time = System::get_microseconds();
+
+		int scans = 0;
+		int probes = 0;
+		for (auto provider : providers)
+		{
+			scans += provider->scans;
+			probes += provider->probes;
+			provider->scans = 0;
+			provider->probes = 0;
+		}
+
+		double seconds = (end_time - start_time) / 1000000.0;
+		Console::write_line("  %1 (pass %2): %3 ms, %4 lookups/s, %5 directory scans, %6 file probes", name, pass + 1,
+			StringHelp::float_to_text((float)(seconds * 1000.0), 1), (int)(num_lookups / seconds), scans, probes);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("FileSystem path resolution benchmark");
+		Console::write_line("%1 lookups over %2 stacked layers", num_lookups, num_layers);
+
+		run_benchmark("Mount points", false, false, 2);
+		run_benchmark("Overlay, uncached", true, false, 1);
+		run_benchmark("Overlay, cached", true, true, 2);
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
@@ -71,6 +71,7 @@ private:
 	void fail(void);
 	void test_vfs();
 	void test_vfs_internal(const char *message, FileSystem vfs);
+	void test_vfs_overlay(const char *message, bool cache_enabled);
 #ifdef WIN32
 	TCHAR working_dir[MAX_PATH];
 	char location_dir[4];
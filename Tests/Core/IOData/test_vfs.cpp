@@ -36,6 +36,9 @@ void TestApp::test_vfs()
 
 	test_vfs_internal("  File based #1", FileSystem("../../", false));
 	test_vfs_internal("  Zip based #1", FileSystem("../IOData/test.zip", true));
+
+	test_vfs_overlay("  Overlay based #1", false);
+	test_vfs_overlay("  Overlay based #2 (cached)", true);
 }
 
 void TestApp::test_vfs_internal(const char *message, FileSystem vfs)
@@ -74,3 +77,50 @@ void TestApp::test_vfs_internal(const char *message, FileSystem vfs)
 
 }
 
+void TestApp::test_vfs_overlay(const char *message, bool cache_enabled)
+{
+	Console::write_line(message);
+
+	FileSystem vfs("../../", false);
+	vfs.mount_overlay("../IOData/test.zip", true);
+	vfs.set_cache_enabled(cache_enabled);
+
+	// Directory listings merge all layers
+	bool found_zip_folder = false;
+	bool found_disk_folder = false;
+	DirectoryListing dir = vfs.get_directory_listing("Core");
+	while (dir.next())
+	{
+		if (dir.get_filename() == "A_Little_Folder" && dir.is_directory())
+			found_zip_folder = true;
+		if (dir.get_filename() == "XPath" && dir.is_directory())
+			found_disk_folder = true;
+	}
+	if (!found_zip_folder || !found_disk_folder)
+		fail();
+
+	// Files only found in the zip layer, or only on disk
+	if (!vfs.has_file("Core/IOData/c.txt"))
+		fail();
+	if (!vfs.has_file("Core/IOData/test_vfs.cpp"))
+		fail();
+
+	// The zip layer hides the Makefile on disk (the zipped one is empty)
+	IODevice file = vfs.open_file("Core/IOData/Makefile");
+	if (file.get_size() != 0)
+		fail();
+
+	file = vfs.open_file("Core/IOData/test_vfs.cpp");
+	if (file.get_size() == 0)
+		fail();
+
+	// Higher priority layers are searched first
+	vfs.mount_overlay(FileSystem("../../", false), 1);
+	file = vfs.open_file("Core/IOData/Makefile");
+	if (file.get_size() == 0)
+		fail();
+
+	vfs.invalidate_cache();
+	if (!vfs.has_file("Core/IOData/c.txt"))
+		fail();
+}
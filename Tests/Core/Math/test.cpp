@@ -56,6 +56,7 @@ int TestApp::main()
 		Console::write_line("Directory: API/Core/Math");
 
 		test_bigint();
+		test_random();
 		test_angle();
 		test_quaternion_f();
 		test_quaternion_d();
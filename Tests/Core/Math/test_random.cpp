@@ -0,0 +1,204 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <climits>
+
+void TestApp::test_random()
+{
+	Console::write_line(" Header: xoshiro256.h");
+	Console::write_line("  Class: Xoshiro256");
+
+	Console::write_line("   Function: next() and jump()");
+	{
+		Xoshiro256 generator(12345);
+		if (generator.next() != 0xbe6a36374160d49bULL) fail();
+		if (generator.next() != 0x214aaa0637a688c6ULL) fail();
+		if (generator.next() != 0xf69d16de9954d388ULL) fail();
+
+		Xoshiro256 jumped(12345);
+		jumped.jump();
+		if (jumped.next() != 0x3ed575283f0594e6ULL) fail();
+
+		Xoshiro256 parent(12345);
+		Xoshiro256 child = parent.split();
+		if (child.next() != 0xbe6a36374160d49bULL) fail();
+		if (parent.next() != 0x3ed575283f0594e6ULL) fail();
+	}
+
+	Console::write_line("   Function: fill_uint32()");
+	{
+		// Lane n is the generator after n+1 long jumps, giving eight numbers per step
+		Xoshiro256 lanes[4] = { Xoshiro256(99), Xoshiro256(99), Xoshiro256(99), Xoshiro256(99) };
+		for (int lane = 0; lane < 4; lane++)
+		{
+			for (int cnt = 0; cnt <= lane; cnt++)
+				lanes[lane].long_jump();
+		}
+
+		Xoshiro256 generator(99);
+		std::vector<uint32_t> values(101);
+		generator.fill_uint32(&values[0], 5);
+		generator.fill_uint32(&values[8], 93);
+
+		for (int step = 0; step < 13; step++)
+		{
+			for (int lane = 0; lane < 4; lane++)
+			{
+				uint64_t expected = lanes[lane].next();
+				int pos = step * 8 + lane * 2;
+				if (pos < 5 || (pos >= 8 && pos < 101))
+				{
+					if (values[pos] != (uint32_t)expected) fail();
+				}
+				if (pos + 1 < 5 || (pos + 1 >= 8 && pos + 1 < 101))
+				{
+					if (values[pos + 1] != (uint32_t)(expected >> 32)) fail();
+				}
+			}
+		}
+
+		// Filling does not disturb the scalar stream
+		if (generator.next() != Xoshiro256(99).next()) fail();
+	}
+
+	Console::write_line("   Function: fill_float() and fill_int()");
+	{
+		Xoshiro256 generator(7);
+		std::vector<float> floats(1003);
+		generator.fill_float(&floats[0], floats.size(), -2.0f, 3.0f);
+		float lowest = 3.0f, highest = -2.0f;
+		for (float value : floats)
+		{
+			if (value < -2.0f || value >= 3.0f) fail();
+			lowest = std::min(lowest, value);
+			highest = std::max(highest, value);
+		}
+		if (lowest > -1.9f || highest < 2.9f) fail();
+
+		std::vector<int> ints(1003);
+		std::vector<int> counts(7);
+		generator.fill_int(&ints[0], ints.size(), -3, 3);
+		for (int value : ints)
+		{
+			if (value < -3 || value > 3) fail();
+			counts[value + 3]++;
+		}
+		for (int count : counts)
+		{
+			if (count < 100) fail();
+		}
+
+		generator.fill_int(&ints[0], ints.size(), INT_MIN, INT_MAX);
+		generator.fill_int(&ints[0], ints.size(), 5, 5);
+		for (int value : ints)
+		{
+			if (value != 5) fail();
+		}
+	}
+
+	Console::write_line("   Function: next_int(), next_float() and next_normal()");
+	{
+		Xoshiro256 generator(3);
+		std::vector<int> counts(10);
+		for (int cnt = 0; cnt < 10000; cnt++)
+		{
+			int value = generator.next_int(10, 19);
+			if (value < 10 || value > 19) fail();
+			counts[value - 10]++;
+		}
+		for (int count : counts)
+		{
+			if (count < 800 || count > 1200) fail();
+		}
+
+		double sum = 0.0, sum_squares = 0.0;
+		for (int cnt = 0; cnt < 10000; cnt++)
+		{
+			float value = generator.next_float();
+			if (value < 0.0f || value >= 1.0f) fail();
+			float normal = generator.next_normal(5.0f, 2.0f);
+			sum += normal;
+			sum_squares += normal * normal;
+		}
+		double mean = sum / 10000;
+		double variance = sum_squares / 10000 - mean * mean;
+		if (mean < 4.9 || mean > 5.1 || variance < 3.7 || variance > 4.3) fail();
+	}
+
+	Console::write_line(" Header: pcg32.h");
+	Console::write_line("  Class: PCG32");
+
+	Console::write_line("   Function: next() and advance()");
+	{
+		PCG32 generator(42, 54);
+		const uint32_t expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+		for (uint32_t value : expected)
+		{
+			if (generator.next() != value) fail();
+		}
+
+		PCG32 advanced(42, 54);
+		advanced.advance(1000);
+		if (advanced.next() != 0xefebeab3) fail();
+
+		PCG32 parent(42, 54);
+		PCG32 child = parent.split();
+		if (child.next() == parent.next()) fail();
+
+		for (int cnt = 0; cnt < 1000; cnt++)
+		{
+			int value = generator.next_int(-5, 5);
+			if (value < -5 || value > 5) fail();
+			double real = generator.next_double();
+			if (real < 0.0 || real >= 1.0) fail();
+		}
+	}
+
+	Console::write_line(" Header: random.h");
+	Console::write_line("  Class: Random");
+
+	Console::write_line("   Function: get_random_bytes() across refills");
+	{
+		// A small cache, so most reads swap in the background refilled pool
+		Random random(64);
+		std::vector<int> counts(256);
+		std::vector<unsigned char> buffer(100);
+		for (int cnt = 0; cnt < 1000; cnt++)
+		{
+			random.get_random_bytes(&buffer[0], buffer.size());
+			for (unsigned char value : buffer)
+				counts[value]++;
+		}
+		for (int count : counts)
+		{
+			if (count < 250 || count > 550) fail();
+		}
+	}
+}
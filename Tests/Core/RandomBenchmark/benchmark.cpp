@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <random>
+#include <cstdlib>
+using namespace clan;
+
+const int num_numbers = 16 * 1024 * 1024;
+const int num_passes = 3;
+
+uint32_t sink = 0;
+
+template<typename Func>
+void run_benchmark(const char *name, Func func)
+{
+	double best_seconds = 0.0;
+	for (int pass = 0; pass < num_passes; pass++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		func();
+		uint64_t end_time = System::get_microseconds();
+		double seconds = (end_time - start_time) / 1000000.0;
+		if (pass == 0 || seconds < best_seconds)
+			best_seconds = seconds;
+	}
+	Console::write_line("  %1: %2 ms, %3 M numbers/s", name, StringHelp::float_to_text((float)(best_seconds * 1000.0), 1), StringHelp::float_to_text((float)(num_numbers / best_seconds / 1000000.0), 1));
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("Random number benchmark, %1 M numbers", num_numbers / (1024 * 1024));
+		Console::write_line("AVX2: %1", System::detect_cpu_extension(System::avx2) ? "yes" : "no");
+
+		std::vector<uint32_t> uints(num_numbers);
+		std::vector<float> floats(num_numbers);
+		std::vector<int> ints(num_numbers);
+
+		Console::write_line("One at a time (32 bit)");
+		run_benchmark("rand()", [&]() { for (int cnt = 0; cnt < num_numbers; cnt++) sink += rand(); });
+		run_benchmark("std::mt19937", [&]() { std::mt19937 generator(1); for (int cnt = 0; cnt < num_numbers; cnt++) sink += generator(); });
+		run_benchmark("Random (4 bytes per call)", [&]()
+		{
+			Random random;
+			for (int cnt = 0; cnt < num_numbers; cnt++)
+			{
+				uint32_t value;
+				random.get_random_bytes((unsigned char *)&value, sizeof(value));
+				sink += value;
+			}
+		});
+		run_benchmark("Xoshiro256::next_uint32()", [&]() { Xoshiro256 generator(1); for (int cnt = 0; cnt < num_numbers; cnt++) sink += generator.next_uint32(); });
+		run_benchmark("PCG32::next()", [&]() { PCG32 generator(1); for (int cnt = 0; cnt < num_numbers; cnt++) sink += generator.next(); });
+		run_benchmark("Xoshiro256::next_int(0, 99)", [&]() { Xoshiro256 generator(1); for (int cnt = 0; cnt < num_numbers; cnt++) sink += generator.next_int(0, 99); });
+		run_benchmark("Xoshiro256::next_float()", [&]() { Xoshiro256 generator(1); float sum = 0.0f; for (int cnt = 0; cnt < num_numbers; cnt++) sum += generator.next_float(); sink += (uint32_t)sum; });
+
+		Console::write_line("Bulk");
+		run_benchmark("Random::get_random_bytes() (64 KB cache)", [&]() { Random random(64 * 1024); random.get_random_bytes((unsigned char *)&uints[0], num_numbers * sizeof(uint32_t)); });
+		run_benchmark("Xoshiro256::fill_uint32()", [&]() { Xoshiro256 generator(1); generator.fill_uint32(&uints[0], num_numbers); });
+		run_benchmark("Xoshiro256::fill_float()", [&]() { Xoshiro256 generator(1); generator.fill_float(&floats[0], num_numbers, -1.0f, 1.0f); });
+		run_benchmark("Xoshiro256::fill_int(0, 99)", [&]() { Xoshiro256 generator(1); generator.fill_int(&ints[0], num_numbers, 0, 99); });
+		run_benchmark("PCG32::fill_uint32()", [&]() { PCG32 generator(1); generator.fill_uint32(&uints[0], num_numbers); });
+		run_benchmark("PCG32::fill_float()", [&]() { PCG32 generator(1); generator.fill_float(&floats[0], num_numbers, -1.0f, 1.0f); });
+
+		Console::write_line("(checksum %1)", (int)(sink + uints[num_numbers / 2] + ints[num_numbers / 3] + (int)floats[num_numbers / 4]));
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
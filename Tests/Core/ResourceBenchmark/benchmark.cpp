@@ -0,0 +1,202 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/xml.h>
+using namespace clan;
+
+DataBuffer create_resources(int num_sections, int num_sprites, bool use_namespace)
+{
+	std::string prefix = use_namespace ? "clres:" : "";
+	std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+	if (use_namespace)
+		xml += "<clres:resources xmlns:clres=\"http://clanlib.org/xmlns/resources-1.0\">\n";
+	else
+		xml += "<resources>\n";
+
+	for (int section = 0; section < num_sections; section++)
+	{
+		xml += "\t<" + prefix + "section " + prefix + string_format("name=\"Section%1\">\n", section);
+		xml += "\t\t<" + prefix + "section " + prefix + "name=\"Sprites\">\n";
+		for (int sprite = 0; sprite < num_sprites; sprite++)
+		{
+			xml += "\t\t\t<" + prefix + "sprite " + prefix + string_format("name=\"Sprite%1\" base_angle=\"%2\">\n", sprite, sprite % 360);
+			xml += "\t\t\t\t<" + prefix + string_format("image file=\"sprites/section%1/sprite%2.png\">", section, sprite);
+			xml += "<" + prefix + "grid pos=\"0,0\" size=\"32,32\" array=\"4,1\"/></" + prefix + "image>\n";
+			xml += "\t\t\t\t<!-- Animation -->\n";
+			xml += "\t\t\t\t<" + prefix + string_format("animation speed=\"%1\" loop=\"yes\"/>\n", 50 + sprite % 10);
+			xml += "\t\t\t</" + prefix + "sprite>\n";
+		}
+		xml += "\t\t</" + prefix + "section>\n";
+		xml += "\t\t<" + prefix + "image " + prefix + string_format("name=\"Background\" file=\"backgrounds/%1.png\"/>\n", section);
+		xml += "\t\t<" + prefix + "string " + prefix + string_format("name=\"Title\" value=\"Section &lt;%1&gt;\"/>\n", section);
+		xml += "\t</" + prefix + "section>\n";
+	}
+	xml += "\t<" + prefix + "integer " + prefix + "name=\"Version\" value=\"3\"/>\n";
+	xml += use_namespace ? "</clres:resources>\n" : "</resources>\n";
+	return DataBuffer(xml.data(), xml.length());
+}
+
+DataBuffer compile(DataBuffer xml)
+{
+	MemoryDevice input(xml);
+	XMLResourceDocument document(input, std::string(), FileSystem());
+
+	MemoryDevice output;
+	document.save_compiled(output);
+	return output.get_data();
+}
+
+std::string dump_node(const DomNode &node)
+{
+	std::string text = string_format("%1 %2 {%3} '%4'", (int)node.get_node_type(), node.get_node_name(), node.get_namespace_uri(), node.get_node_value());
+	DomNamedNodeMap attributes = node.get_attributes();
+	for (int i = 0; i < (int)attributes.get_length(); i++)
+		text += " [" + dump_node(attributes.item(i)) + "]";
+	for (DomNode child = node.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+		text += " (" + dump_node(child) + ")";
+	return text;
+}
+
+void verify_equal(const std::vector<std::string> &a, const std::vector<std::string> &b, const std::string &query)
+{
+	if (a != b)
+		throw Exception(string_format("%1 differs (%2 and %3 names)", query, (int)a.size(), (int)b.size()));
+}
+
+void verify(DataBuffer xml, DataBuffer compiled)
+{
+	MemoryDevice xml_device(xml);
+	XMLResourceDocument xml_document(xml_device, std::string(), FileSystem());
+	MemoryDevice compiled_device(compiled);
+	XMLResourceDocument compiled_document(compiled_device, std::string(), FileSystem());
+
+	verify_equal(xml_document.get_section_names(), compiled_document.get_section_names(), "get_section_names");
+	verify_equal(xml_document.get_resource_names(), compiled_document.get_resource_names(), "get_resource_names");
+	for (const auto &type : { "sprite", "image", "string", "integer", "missing" })
+	{
+		verify_equal(xml_document.get_resource_names_of_type(type), compiled_document.get_resource_names_of_type(type), "get_resource_names_of_type");
+		for (const auto &section : { "", "Section1", "Section1/", "Section1/Sprites", "Missing" })
+			verify_equal(xml_document.get_resource_names_of_type(type, section), compiled_document.get_resource_names_of_type(type, section), "get_resource_names_of_type with section");
+	}
+	for (const auto &section : { "", "Section0", "Section0/Sprites", "Section0/Sprites/", "Missing" })
+		verify_equal(xml_document.get_resource_names(section), compiled_document.get_resource_names(section), "get_resource_names with section");
+
+	if (compiled_document.resource_exists("Section0/Missing") || compiled_document.resource_exists("Section0/Sprites") || !compiled_document.resource_exists("Version"))
+		throw Exception("resource_exists differs");
+
+	for (const auto &id : xml_document.get_resource_names())
+	{
+		XMLResourceNode a = xml_document.get_resource(id);
+		XMLResourceNode b = compiled_document.get_resource(id);
+		if (a.get_type() != b.get_type() || a.get_name() != b.get_name() || dump_node(a.get_element()) != dump_node(b.get_element()))
+			throw Exception("Resource differs: " + id);
+		if (b.get_element().get_parent_node().to_element().get_attribute("name") != a.get_element().get_parent_node().to_element().get_attribute("name"))
+			throw Exception("Resource section differs: " + id);
+	}
+
+	if (compiled_document.get_string_resource("Section1/Title", "") != (xml_document.resource_exists("Section1/Title") ? "Section <1>" : "") ||
+		compiled_document.get_integer_resource("Version", 0) != 3 || compiled_document.get_boolean_resource("Missing", true) != true)
+		throw Exception("Resource values differ");
+
+	// Saving a compiled document as XML again must give the same resources
+	MemoryDevice saved;
+	compiled_document.save(saved);
+	saved.seek(0);
+	XMLResourceDocument saved_document(saved, std::string(), FileSystem());
+	verify_equal(xml_document.get_resource_names(), saved_document.get_resource_names(), "Saved get_resource_names");
+	for (const auto &id : xml_document.get_resource_names())
+	{
+		if (dump_node(saved_document.get_resource(id).get_element()) != dump_node(xml_document.get_resource(id).get_element()))
+			throw Exception("Saved resource differs: " + id);
+	}
+}
+
+uint64_t benchmark_startup(DataBuffer data, const std::vector<std::string> &lookups)
+{
+	uint64_t start_time = System::get_microseconds();
+
+	MemoryDevice device(data);
+	ResourceManager manager = XMLResourceManager::create(XMLResourceDocument(device, std::string(), FileSystem()));
+	XMLResourceDocument &document = XMLResourceManager::get_doc(manager);
+	for (const auto &id : lookups)
+	{
+		if (document.get_resource(id).get_element().get_first_child_element().is_null())
+			throw Exception("Resource lookup failed");
+	}
+	if (document.get_resource_names_of_type("sprite", "Section1/Sprites").empty())
+		throw Exception("Resource query failed");
+
+	return System::get_microseconds() - start_time;
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("Resource benchmark");
+
+		verify(create_resources(3, 5, true), compile(create_resources(3, 5, true)));
+		verify(create_resources(3, 5, false), compile(create_resources(3, 5, false)));
+		verify(create_resources(0, 0, true), compile(create_resources(0, 0, true)));
+
+		const int num_sections = 50;
+		const int num_sprites = 400;
+		DataBuffer xml = create_resources(num_sections, num_sprites, true);
+		DataBuffer compiled = compile(xml);
+		verify(xml, compiled);
+
+		std::vector<std::string> lookups;
+		for (int i = 0; i < 20; i++)
+			lookups.push_back(string_format("Section%1/Sprites/Sprite%2", i * 7 % num_sections, i * 31 % num_sprites));
+
+		Console::write_line("%1 resources, %2 MB XML, %3 MB compiled", num_sections * (num_sprites + 2) + 1,
+			StringHelp::float_to_text(xml.get_size() / (1024.0f * 1024.0f), 1), StringHelp::float_to_text(compiled.get_size() / (1024.0f * 1024.0f), 1));
+
+		for (int pass = 0; pass < 3; pass++)
+		{
+			uint64_t xml_time = benchmark_startup(xml, lookups);
+			uint64_t compiled_time = benchmark_startup(compiled, lookups);
+			Console::write_line("  Startup: XML %1 ms, compiled %2 ms", StringHelp::float_to_text(xml_time / 1000.0f, 2), StringHelp::float_to_text(compiled_time / 1000.0f, 2));
+		}
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
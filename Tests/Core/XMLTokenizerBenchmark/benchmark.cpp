@@ -0,0 +1,202 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/xml.h>
+using namespace clan;
+
+DataBuffer create_map(int num_tiles)
+{
+	std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<!DOCTYPE map SYSTEM \"map.dtd\">\n<map name=\"Test &amp; map\">\n";
+	for (int tile = 0; tile < num_tiles; tile++)
+	{
+		xml += string_format("\t<tile id=\"%1\" x='%2' y=\"%3\" layer=\"ground\">\n", tile, tile % 256, tile / 256);
+		xml += string_format("\t\t<object type=\"tree\" health=\"%1\"/>\n", tile % 100);
+		if (tile % 16 == 0)
+			xml += "\t\t<!-- checkpoint -->\n\t\t<script><![CDATA[if (a < b) spawn();]]></script>\n";
+		xml += string_format("\t\t<label>Tile %1 &lt;%2&gt;</label>\n", tile, tile % 7);
+		xml += "\t</tile>\n";
+	}
+	xml += "</map>\n";
+	return DataBuffer(xml.data(), xml.length());
+}
+
+// XMLTokenizer leaves the name and value of the previous token in tokens that do not have one
+bool equal_tokens(const XMLToken &a, const XMLToken &b)
+{
+	if (a.type != b.type || a.variant != b.variant)
+		return false;
+	if (a.type == XMLToken::DOCUMENT_TYPE_TOKEN || a.type == XMLToken::NULL_TOKEN)
+		return true;
+	if (a.type == XMLToken::ELEMENT_TOKEN)
+		return a.name == b.name && a.attributes == b.attributes;
+	if (a.type == XMLToken::PROCESSING_INSTRUCTION_TOKEN)
+		return a.name == b.name && a.value == b.value;
+	return a.value == b.value;
+}
+
+void verify(DataBuffer data, size_t chunk_size)
+{
+	MemoryDevice device1(data);
+	MemoryDevice device2(data);
+	XMLTokenizer tokenizer(device1);
+	XMLStreamTokenizer stream_tokenizer(device2, chunk_size);
+
+	XMLToken token;
+	XMLStreamToken stream_token;
+	XMLToken converted;
+	int count = 0;
+	while (true)
+	{
+		tokenizer.next(&token);
+		stream_tokenizer.next(&stream_token);
+		stream_token.to_token(&converted);
+
+		if (!equal_tokens(token, converted))
+			throw Exception(string_format("Token %1 differs with %2 byte chunks", count, (int)chunk_size));
+		if (token.type == XMLToken::NULL_TOKEN)
+			break;
+		count++;
+	}
+}
+
+void verify_document_type()
+{
+	// XMLTokenizer stops the internal subset at the first '>'
+	const char *xml = "<!DOCTYPE map [ <!ENTITY tile \"<t>\"> ]><map/>";
+	DataBuffer data(xml, strlen(xml));
+	MemoryDevice device(data);
+	XMLStreamTokenizer tokenizer(device, 16);
+	XMLStreamToken token;
+	tokenizer.next(&token);
+	if (token.type != XMLToken::DOCUMENT_TYPE_TOKEN || token.name != "map")
+		throw Exception("DOCTYPE not parsed");
+	tokenizer.next(&token);
+	if (token.type != XMLToken::ELEMENT_TOKEN || token.variant != XMLToken::SINGLE || token.name != "map")
+		throw Exception("Element after DOCTYPE not parsed");
+}
+
+void verify_errors()
+{
+	const char *invalid[] = { "<a b=\"1\"", "<a b></a>", "<a><!-- x", "<a x=\"1\" <", "<!-x>" };
+	for (const char *xml : invalid)
+	{
+		DataBuffer data(xml, strlen(xml));
+		MemoryDevice device(data);
+		XMLStreamTokenizer tokenizer(device, 16);
+		XMLStreamToken token;
+		try
+		{
+			do
+			{
+				tokenizer.next(&token);
+			} while (token.type != XMLToken::NULL_TOKEN);
+		}
+		catch (Exception &)
+		{
+			continue;
+		}
+		throw Exception(string_format("No error for %1", xml));
+	}
+}
+
+double megabytes_per_second(size_t bytes, uint64_t microseconds)
+{
+	return bytes / (double)microseconds;
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("XML tokenizer benchmark");
+
+		verify(create_map(300), 16);
+		verify(create_map(300), 100);
+		verify(create_map(300), 64 * 1024);
+		verify_document_type();
+		verify_errors();
+
+		DataBuffer data = create_map(400000);
+		Console::write_line("%1 MB map", StringHelp::float_to_text(data.get_size() / (1024.0f * 1024.0f), 1));
+
+		for (int method = 0; method < 3; method++)
+		{
+			MemoryDevice device(data);
+			int count = 0;
+			uint64_t start_time = System::get_microseconds();
+			if (method == 0)
+			{
+				XMLTokenizer tokenizer(device);
+				XMLToken token;
+				do
+				{
+					tokenizer.next(&token);
+					count++;
+				} while (token.type != XMLToken::NULL_TOKEN);
+			}
+			else
+			{
+				XMLStreamTokenizer tokenizer(device);
+				XMLStreamToken token;
+				std::string value;
+				do
+				{
+					tokenizer.next(&token);
+					if (method == 2)
+					{
+						// Decode everything, as a DOM builder would
+						token.value.decode(value);
+						for (auto &attribute : token.attributes)
+							attribute.second.decode(value);
+					}
+					count++;
+				} while (token.type != XMLToken::NULL_TOKEN);
+			}
+			uint64_t end_time = System::get_microseconds();
+
+			const char *names[] = { "XMLTokenizer", "XMLStreamTokenizer", "XMLStreamTokenizer, decoded" };
+			Console::write_line("  %1: %2 tokens, %3 ms, %4 MB/s", names[method], count, (int)((end_time - start_time) / 1000),
+				StringHelp::float_to_text((float)megabytes_per_second(data.get_size(), end_time - start_time), 1));
+		}
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
@@ -1,97 +1,264 @@
 
 #include <ClanLib/core.h>
+#include <ClanLib/xml.h>
 using namespace clan;
 
-void evaluate(const std::string &xpath, const DomDocument &document)
+int failures = 0;
+
+void fail(const std::string &xpath, const std::string &expected, const std::string &result)
+{
+	Console::write_line("FAILED: '%1'", xpath);
+	Console::write_line("  Expected: %1", expected);
+	Console::write_line("  Result:   %1", result);
+	failures++;
+}
+
+std::string node_text(const DomNode &node)
+{
+	if (node.is_element())
+		return node.to_element().get_text();
+	return node.get_node_value();
+}
+
+std::string join_nodes(const std::vector<DomNode> &nodes)
 {
-	Console::write_line("Evaluating XPath '%1'", xpath);
+	std::string text;
+	for (std::vector<DomNode>::size_type i = 0; i < nodes.size(); i++)
+	{
+		if (i > 0)
+			text += ", ";
+		text += node_text(nodes[i]);
+	}
+	return text;
+}
 
-	XPathEvaluator evaluator;
-	XPathObject result = evaluator.evaluate(xpath, document);
-	switch (result.get_type())
+std::string join_strings(const std::vector<std::string> &strings)
+{
+	std::string text;
+	for (std::vector<std::string>::size_type i = 0; i < strings.size(); i++)
+	{
+		if (i > 0)
+			text += ", ";
+		text += strings[i];
+	}
+	return text;
+}
+
+XPathObject evaluate(const std::string &xpath, const DomNode &context)
+{
+	try
+	{
+		XPathEvaluator evaluator;
+		return evaluator.evaluate(xpath, context);
+	}
+	catch (Exception &error)
 	{
-	case XPathObject::type_null:
-		Console::write_line("Result: null");
-		break;
-	case XPathObject::type_node_set:
-		{
-			std::vector<DomNode> nodes = result.get_node_set();
-			Console::write_line("Result: node-set (%1)", (int)nodes.size());
-			for (std::vector<DomNode>::size_type i = 0; i < nodes.size(); i++)
-			{
-				std::string text = nodes[i].get_node_value();
-				if (nodes[i].is_element())
-					text = nodes[i].to_element().get_text();
-				Console::write_line("#%1: [%2] %3", (int)i, nodes[i].get_node_name(), text);
-			}
-		}
-		break;
-	case XPathObject::type_number:
-		Console::write_line("Result: number (%1)", (int) result.get_number());
-		break;
-	case XPathObject::type_string:
-		Console::write_line("Result: string (%1)", result.get_string());
-		break;
-	case XPathObject::type_boolean:
-		Console::write_line("Result: boolean (%1)", result.get_boolean() ? "true" : "false");
-		break;
+		fail(xpath, "no exception", error.message);
+		return XPathObject();
 	}
-	Console::write_line("");
+}
+
+void check_nodes(const std::string &xpath, const DomNode &context, const std::vector<std::string> &expected)
+{
+	XPathObject result = evaluate(xpath, context);
+	if (result.get_type() != XPathObject::type_node_set)
+	{
+		fail(xpath, join_strings(expected), "not a node-set");
+		return;
+	}
+
+	std::vector<DomNode> nodes = result.get_node_set();
+	bool match = nodes.size() == expected.size();
+	for (std::vector<DomNode>::size_type i = 0; match && i < nodes.size(); i++)
+		match = node_text(nodes[i]) == expected[i];
+	if (!match)
+		fail(xpath, join_strings(expected), join_nodes(nodes));
+
+	// The compiled path (with and without the fast location steps) must select the same nodes
+	XPathExpression expression(xpath);
+	std::vector<DomNode> selected;
+	expression.select_nodes(context, selected);
+	if (selected != nodes)
+		fail(xpath + " (select_nodes)", join_nodes(nodes), join_nodes(selected));
+}
+
+void check_number(const std::string &xpath, const DomNode &context, double expected)
+{
+	XPathObject result = evaluate(xpath, context);
+	if (result.get_type() != XPathObject::type_number || result.get_number() != expected)
+		fail(xpath, StringHelp::double_to_text(expected), result.get_type() == XPathObject::type_number ? StringHelp::double_to_text(result.get_number()) : "not a number");
+}
+
+void check_string(const std::string &xpath, const DomNode &context, const std::string &expected)
+{
+	XPathObject result = evaluate(xpath, context);
+	if (result.get_type() != XPathObject::type_string || result.get_string() != expected)
+		fail(xpath, expected, result.get_type() == XPathObject::type_string ? result.get_string() : "not a string");
+}
+
+void check_boolean(const std::string &xpath, const DomNode &context, bool expected)
+{
+	XPathObject result = evaluate(xpath, context);
+	if (result.get_type() != XPathObject::type_boolean || result.get_boolean() != expected)
+		fail(xpath, expected ? "true" : "false", result.get_type() == XPathObject::type_boolean ? (result.get_boolean() ? "true" : "false") : "not a boolean");
+}
+
+DomDocument load(const std::string &filename)
+{
+	File file(filename, File::open_existing, File::access_read);
+	DomDocument document;
+	document.load(file);
+	return document;
+}
+
+void test_axes(const DomDocument &document, const DomDocument &nested)
+{
+	Console::write_line("   ... Axes");
+
+	check_nodes("/root/child[1]/childchild", document, { "Test", "Test2", "Test3" });
+	check_nodes("/child::root/child::child[2]/child::childchild", document, { "Test4", "Test5" });
+	check_nodes("//child/attribute::type", document, { "numbers" });
+	check_nodes("/root/child[@foo]/self::child/@foo", document, { "bar", "barism" });
+	check_nodes("/root/dummy/foobar/parent::*", document, { "Meh!" });
+	check_string("name(/root/child[1]/childchild[2]/..)", document, "child");
+	check_number("count(/root/child[1]/childchild[2]/ancestor::*)", document, 2);
+	check_string("name(/root/child[1]/childchild[2]/ancestor::*[1])", document, "child");
+	check_nodes("root//childchild[@ID]", document, { "Test7.2" });
+
+	// following-sibling was never matched
+	check_nodes("/root/child[2]/following-sibling::child[1]/@foo", document, { "barism" });
+	check_number("count(/root/child[1]/following-sibling::*)", document, 8);
+	check_nodes("/root/child[2]/childchild[1]/following-sibling::*", document, { "Test5" });
+	check_nodes("/root/child/child[3]/preceding-sibling::child[1]/childchild[1]", nested, { "Test2.1" });
+
+	// preceding returned nodes in the wrong order
+	check_nodes("/root/child[2]/childchild[1]/preceding::childchild", document, { "Test", "Test2", "Test3" });
+	check_nodes("/root/child/child[2]/childchild[2]/preceding::childchild", nested, { "Test1.1", "Test1.2", "Test1.3", "Test2.1" });
+	check_nodes("/root/child/child[1]/following::childchild[1]", nested, { "Test2.1" });
+
+	// descendant-or-self visited the context node's siblings
+	check_nodes("/root/child/child[2]/descendant-or-self::childchild", nested, { "Test2.1", "Test2.2", "Test2.3" });
+	check_number("count(/root/child/child[2]/descendant-or-self::*)", nested, 4);
+	check_number("count(/root/child/child[2]/descendant::*)", nested, 3);
+}
+
+void test_predicates(const DomDocument &document)
+{
+	Console::write_line("   ... Predicates");
+
+	check_nodes("/root/child[last()]", document, { "child id Test" });
+	check_nodes("/root/child[last()-3]/foobar", document, { "Age under 27" });
+	check_nodes("root/child[childchild=\"Test6\"]/foobar", document, { "Muh!" });
+	check_nodes("root/child[@age>27]/foobar", document, { "Age over 27" });
+	check_nodes("root/child[@age!=10]/foobar", document, { "Age over 27" });
+	check_nodes("root/child[not(@foo) and not(@age)]/foobar", document, { "Muh!" });
+	check_nodes("root/*[local-name()='child' and (@age=10 or namespace-uri()='fisk')]/foobar", document, { "Age under 27", "To foobar!!" });
+	check_nodes("root/child[foobar][2]/foobar", document, { "Age under 27" });
+	check_number("count(root/child[position() mod 2 = 0])", document, 4);
+	check_number("count(root/child::*[local-name()='child'])", document, 10);
+	check_string("local-name(root/*[local-name()='child'][1])", document, "child");
+	check_string("namespace-uri(root/*[local-name()='child'][1])", document, "fisk");
+	check_nodes("(root/*[local-name()='child'])[1]", document, { "NS Child" });
+	check_nodes("root/*[local-name()='child'][last()]/foobar | root/child[not(@foo) and not(@age)]/foobar", document, { "Muh!" });
+}
+
+void test_fast_paths(const DomDocument &document, const DomDocument &nested)
+{
+	Console::write_line("   ... Attribute and descendant fast paths");
+
+	// /a/b[@id='x']
+	check_nodes("/root/child[@foo='barism']/childchild", document, { "Test4.1", "Test5.1" });
+	check_nodes("/root/child[@foo=\"bar\"]/childchild", document, { "Test4", "Test5" });
+	check_nodes("/root/child[@ID='Test']", document, { "child id Test" });
+	check_nodes("/root/child[@foo='none']", document, {});
+	check_nodes("/root/child[@foo][2]/childchild[1]", document, { "Test4.1" });
+	check_nodes("/root/child[2][@foo]/childchild[2]", document, { "Test5" });
+
+	// //tag
+	check_number("count(//childchild)", document, 13);
+	check_nodes("//number", document, { "10", "15", "20" });
+	check_nodes("//childchild[1]", nested, { "Test1.1", "Test2.1", "Test3.1" });
+	check_nodes("(//childchild)[4]", nested, { "Test2.1" });
+	check_nodes("//child[@foo='bar']/childchild", document, { "Test4", "Test5" });
+	check_nodes("//foobar[@ID]", document, { "To foobar!!" });
+
+	// Queries relative to a context node other than the document
+	DomNode child = document.select_node("/root/child[@age='77']");
+	check_nodes("childchild", child, { "Test6.2", "Test7.2" });
+	check_nodes(".//childchild[@ID='Test72']", child, { "Test7.2" });
+	check_nodes("//number[1]", child, { "10" });
+
+	// A reused buffer is cleared before it is filled
+	XPathExpression expression("//childchild[1]");
+	std::vector<DomNode> nodes;
+	expression.select_nodes(nested, nodes);
+	expression.select_nodes(nested, nodes);
+	if (nodes.size() != 3)
+		fail("//childchild[1] (reused buffer)", "3 nodes", StringHelp::int_to_text((int)nodes.size()));
+}
+
+void test_operators(const DomDocument &document)
+{
+	Console::write_line("   ... Operators");
+
+	check_number("6 mod 4", document, 2);
+	check_number("5.5 mod 2", document, 1.5);
+	check_number("-5 mod 2", document, -1);
+	check_number("5 mod -2", document, 1);
+	check_number("7 div 2", document, 3.5);
+	check_number("1 div 4 + 1", document, 1.25);
+	check_number("(1+2)*3", document, 9);
+	check_number("count(//number)*2", document, 6);
+	check_number("sum(root/child[@type='numbers']/number)", document, 45);
+	check_number("sum(//number) div count(//number)", document, 15);
+	check_boolean("2 + 3 = 5 and 4 > 3", document, true);
+	check_boolean("//number = 15", document, true);
+	check_boolean("//number > 20", document, false);
+	check_string("translate('bare', 'abr', 'AB')", document, "BAe");
+	check_string("substring-before('1999/04/01','/')", document, "1999");
+	check_string("substring-after('1999/04/01','/')", document, "04/01");
+	check_string("substring('12345', 2, 3)", document, "234");
+	check_string("normalize-space('\tchild    \tname\n  \t  thingie\n')", document, "child name thingie");
+	check_number("string-length(root/*[local-name()='child'][position()=last()-2]/foobar)", document, 11);
+}
+
+void test_variables(const DomDocument &document)
+{
+	Console::write_line("   ... Variables");
+
+	// No variable bindings are supported yet, so a reference evaluates to its name
+	check_string("$foo", document, "foo");
+	check_string("concat($first-name, '.', $last_name)", document, "first-name.last_name");
+	check_boolean("$foo = 'foo'", document, true);
+}
+
+void test_document_order(const DomDocument &document, const DomDocument &nested)
+{
+	Console::write_line("   ... Document order");
+
+	check_nodes("/root/child[6]/foobar | /root/dummy/foobar", document, { "Meh!", "Age over 27" });
+	check_nodes("/root/child[2]/childchild | /root/child[1]/childchild[1] | /root/child[2]/childchild[1]", document, { "Test", "Test4", "Test5" });
+	check_nodes("//childchild[3] | //childchild[1]", nested, { "Test1.1", "Test1.3", "Test2.1", "Test2.3", "Test3.1", "Test3.3" });
+	check_nodes("/root/child/child[3]/childchild/preceding-sibling::childchild", nested, { "Test3.1", "Test3.2" });
+	check_nodes("//childchild[.='Test2.2']/ancestor-or-self::*[self::child]/childchild[1]", nested, { "Test2.1" });
 }
 
 int main(int, char**)
 {
 	try
 	{
-		File file("test.xml", File::open_existing, File::access_read);
-// 		File file("test2.xml", File::open_existing, File::access_read);
-		DomDocument document;
-		document.load(file);
-
-// 		evaluate("root/child/child[2]/following::*", document);
-// 		evaluate("root/child/child[2]/childchild[2]/preceding::*", document);
-		evaluate("//child/attribute::type", document);
-
-// 		evaluate("6 mod 4", document);
-// 		evaluate("/root/child/childchild", document);
-// 		evaluate("/child::root/child::child/child::childchild", document);
-// 		evaluate("child::root/child::child/child::childchild", document);
-// 		evaluate("child::root/child::child[@foo]/child::childchild", document);
-// 		evaluate("child::root/child::child[child::foobar]/child::childchild", document);
-// 		evaluate("child::root/child::child[2]/child::childchild", document);
-// 		evaluate("root//childchild", document);
-// 		evaluate("root/child[@foo]/childchild", document);
-// 		evaluate("root/child[@foo=\"barism\"]/childchild", document);
-// 		evaluate("root/child[childchild=\"Test6\"]/foobar", document);
-// 		evaluate("root/child[@age!=10]/foobar", document);
-// 		evaluate("root/child[@age>27]/foobar", document);
-// 		evaluate("root/com:child/foobar", document);
-// 		evaluate("root/child[last()-3]/foobar", document);
-// 		evaluate("root/child[1]/childchild[2]", document);
-// 		evaluate("translate('bare', 'abr', 'AB')", document);
-// 		evaluate("substring-before('1999/04/01','/')", document);
-// 		evaluate("substring-after('1999/04/01','/')", document);
-// 		evaluate("substring('12345', 2)", document);
-// 		evaluate("substring('12345', 2, 3)", document);
-// 		evaluate("count(root/child[position() mod 2 = 0])", document);
-// 		evaluate("namespace-uri(root/com:child)", document);
-// 		evaluate("local-name(root/com:child)", document);
-// 		evaluate("count(root/child::*[local-name()='child'])", document);
-// 		evaluate("normalize-space('\tchild    \tname\n  \t  thingie\n')", document);
-// 		evaluate("string-length(root/*[local-name()='child'][position()=last()-2]/foobar)", document);
-// 		evaluate("root/*[local-name()='child' and (@age=10 or namespace-uri()='fisk')]/foobar", document);
-// 		evaluate("root/child[last()]/foobar", document);
-// 		evaluate("root/child[not(@foo) and not(@age)]/foobar", document);
-// 		evaluate("root/child[last()]/foobar | root/child[not(@foo) and not(@age)]/foobar", document);
-// 		evaluate("root/*[local-name()='child'][last()]/foobar | root/child[not(@foo) and not(@age)]/foobar", document);
-// 		evaluate("sum(root/child[@type='numbers']/number)", document);
-// 		evaluate("/root/child[1]/childchild[1]/text()", document);
-// 		evaluate("(root/*[local-name()='child'])[1]", document);
-// 		evaluate("root/*[local-name()='child'][1]", document);
-// 		evaluate("namespace-uri(root/*[local-name()='child'][1])", document);
-// 		evaluate("local-name(/root/child[1])", document);
-// 		evaluate("id(/root/child[1]/childchild[1])", document);
-// 		evaluate("//childchild[1]", document);
+		Console::write_line(" Header: xpath_evaluator.h");
+		Console::write_line("  Class: XPathEvaluator");
+
+		DomDocument document = load("test.xml");
+		DomDocument nested = load("test2.xml");
+
+		test_axes(document, nested);
+		test_predicates(document);
+		test_fast_paths(document, nested);
+		test_operators(document);
+		test_variables(document);
+		test_document_order(document, nested);
 	}
 	catch(Exception &error)
 	{
@@ -100,5 +267,12 @@ int main(int, char**)
 		return -1;
 	}
 
+	if (failures)
+	{
+		Console::write_line("%1 tests failed", failures);
+		return -1;
+	}
+
+	Console::write_line("All Tests Complete");
 	return 0;
 }
@@ -0,0 +1,121 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/xml.h>
+using namespace clan;
+
+const int num_items = 5000;
+
+DomDocument create_document()
+{
+	std::string xml = "<catalog>";
+	for (int item = 0; item < num_items; item++)
+	{
+		xml += string_format("<item id=\"item%1\" group=\"%2\">", item, item % 10);
+		xml += string_format("<name>Item %1</name><value>%2</value>", item, (item * 7) % 1000);
+		xml += "<tags><tag>a</tag><tag>b</tag><tag>c</tag></tags>";
+		xml += "</item>";
+	}
+	xml += "</catalog>";
+
+	DataBuffer data(xml.data(), xml.length());
+	MemoryDevice device(data);
+	return DomDocument(device);
+}
+
+void run_query(const char *name, const DomDocument &document, const std::string &query, int num_iterations)
+{
+	XPathEvaluator evaluator;
+	XPathExpression expression(query);
+	std::vector<DomNode> nodes;
+	size_t results[3] = { 0, 0, 0 };
+	double milliseconds[3];
+
+	for (int method = 0; method < 3; method++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		for (int iteration = 0; iteration < num_iterations; iteration++)
+		{
+			switch (method)
+			{
+			case 0: // Parsed for every call
+				results[method] += XPathExpression(query).evaluate(document).get_node_set().size();
+				break;
+			case 1: // Compiled expression cache
+				results[method] += document.select_nodes(query).size();
+				break;
+			case 2: // Compiled once, selecting into a reused buffer
+				expression.select_nodes(document, nodes);
+				results[method] += nodes.size();
+				break;
+			}
+		}
+		uint64_t end_time = System::get_microseconds();
+		milliseconds[method] = (end_time - start_time) / 1000.0;
+	}
+
+	if (results[0] != results[1] || results[0] != results[2])
+		throw Exception(string_format("Results differ for %1", query));
+
+	Console::write_line("  %1: %2 nodes, %3 ms parsed per call, %4 ms cached, %5 ms compiled", name, (int)(results[0] / num_iterations),
+		StringHelp::float_to_text((float)milliseconds[0], 1), StringHelp::float_to_text((float)milliseconds[1], 1), StringHelp::float_to_text((float)milliseconds[2], 1));
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("XPath benchmark");
+
+		uint64_t start_time = System::get_microseconds();
+		DomDocument document = create_document();
+		uint64_t end_time = System::get_microseconds();
+		Console::write_line("%1 items, document loaded in %2 ms", num_items, StringHelp::float_to_text((end_time - start_time) / 1000.0f, 1));
+
+		run_query("Attribute lookup", document, "/catalog/item[@id='item4500']/name", 200);
+		run_query("Descendants by name", document, "//tag", 20);
+		run_query("Positional child", document, "/catalog/item[last()]/tags/tag[2]", 200);
+		run_query("Value comparison", document, "/catalog/item[value > 990]/@id", 20);
+		run_query("Function predicate", document, "//item[starts-with(name, 'Item 49')]", 20);
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
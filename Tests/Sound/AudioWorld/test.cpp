@@ -0,0 +1,269 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+static const int mixing_frequency = 44100;
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound AudioWorld voice management");
+
+		SoundOutput_Description desc;
+		desc.set_mixing_frequency(mixing_frequency);
+		desc.set_offline(true);
+		SoundOutput output(desc);
+
+		SoundBuffer loop = create_sound(mixing_frequency);
+
+		test_voice_budget(loop);
+		test_priority(loop);
+		test_distance_culling(loop);
+		test_virtual_one_shot(loop);
+		test_stop();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_voice_budget(SoundBuffer &loop)
+{
+	Console::write_line("   Voice budget");
+
+	AudioWorld world(resources);
+	world.set_max_voices(8);
+	world.set_listener(Vec3f(0.0f), Quaternionf());
+
+	std::vector<AudioObject> objects;
+	for (int i = 0; i < 100; i++)
+	{
+		AudioObject object(world);
+		object.set_sound(loop);
+		object.set_looping(true);
+		object.set_attenuation_begin(1.0f);
+		object.set_attenuation_end(200.0f);
+		object.set_position(Vec3f((float)(i + 2), 0.0f, 0.0f));
+		object.play();
+		objects.push_back(object);
+	}
+
+	// The first objects got voices as they were started
+	if (world.get_num_real_voices() != 8 || world.get_num_virtual_voices() != 92)
+		fail();
+
+	// Reverse the distances: the last objects are now the closest
+	for (int i = 0; i < 100; i++)
+		objects[i].set_position(Vec3f((float)(102 - i), 0.0f, 0.0f));
+	world.update();
+
+	if (world.get_num_real_voices() != 8 || world.get_num_virtual_voices() != 92)
+		fail();
+	for (int i = 0; i < 100; i++)
+	{
+		if (!objects[i].is_playing() || objects[i].is_virtual() != (i < 92))
+			fail();
+	}
+
+	// Objects outside the grid cell of the listener are still found
+	world.set_cell_size(4.0f);
+	world.update();
+	for (int i = 0; i < 100; i++)
+	{
+		if (objects[i].is_virtual() != (i < 92))
+			fail();
+	}
+
+	world.set_max_voices(100);
+	world.update();
+	if (world.get_num_real_voices() != 100 || world.get_num_virtual_voices() != 0)
+		fail();
+}
+
+void TestApp::test_priority(SoundBuffer &loop)
+{
+	Console::write_line("   Priority");
+
+	AudioWorld world(resources);
+	world.set_max_voices(2);
+
+	std::vector<AudioObject> objects;
+	for (int i = 0; i < 4; i++)
+	{
+		AudioObject object(world);
+		object.set_sound(loop);
+		object.set_looping(true);
+		object.set_attenuation_begin(1.0f);
+		object.set_attenuation_end(100.0f);
+		object.set_position(Vec3f(0.0f, 0.0f, (float)(10 + i * 10)));
+		object.play();
+		objects.push_back(object);
+	}
+
+	objects[3].set_priority(1);
+	world.update();
+	if (objects[0].is_virtual() || !objects[1].is_virtual() || !objects[2].is_virtual() || objects[3].is_virtual())
+		fail();
+
+	// Objects without attenuation are always audible
+	AudioObject music(world);
+	music.set_sound(loop);
+	music.set_looping(true);
+	music.set_priority(2);
+	music.play();
+	world.update();
+	if (music.is_virtual() || !objects[0].is_virtual() || objects[3].is_virtual())
+		fail();
+}
+
+void TestApp::test_distance_culling(SoundBuffer &loop)
+{
+	Console::write_line("   Distance culling");
+
+	AudioWorld world(resources);
+	world.set_listener(Vec3f(0.0f), Quaternionf());
+
+	AudioObject object(world);
+	object.set_sound(loop);
+	object.set_looping(true);
+	object.set_attenuation_begin(10.0f);
+	object.set_attenuation_end(50.0f);
+	object.set_position(Vec3f(1000.0f, 0.0f, 1000.0f));
+	object.play();
+
+	// Out of hearing range objects never start a mixer session
+	if (!object.is_playing() || !object.is_virtual() || world.get_num_real_voices() != 0)
+		fail();
+
+	world.set_listener(Vec3f(990.0f, 0.0f, 1000.0f), Quaternionf());
+	world.update();
+	if (object.is_virtual() || world.get_num_real_voices() != 1)
+		fail();
+
+	object.set_position(Vec3f(-1000.0f, 0.0f, 0.0f));
+	world.update();
+	if (!object.is_virtual() || world.get_num_virtual_voices() != 1)
+		fail();
+}
+
+void TestApp::test_virtual_one_shot(SoundBuffer &loop)
+{
+	Console::write_line("   Virtual one-shot sounds end on time");
+
+	AudioWorld world(resources);
+	world.set_max_voices(0);
+
+	AudioObject object(world);
+	object.set_sound(create_sound(mixing_frequency / 20));
+	object.play();
+
+	AudioObject long_object(world);
+	long_object.set_sound(create_sound(mixing_frequency * 60));
+	long_object.play();
+
+	if (!object.is_playing() || !object.is_virtual() || world.get_num_virtual_voices() != 2)
+		fail();
+
+	System::sleep(200);
+	world.update();
+	if (object.is_playing() || !long_object.is_playing() || world.get_num_virtual_voices() != 1)
+		fail();
+
+	// Promoted back to a real voice without restarting the sound
+	world.set_max_voices(1);
+	world.update();
+	if (long_object.is_virtual() || world.get_num_real_voices() != 1)
+		fail();
+}
+
+void TestApp::test_stop()
+{
+	Console::write_line("   Stopping objects");
+
+	AudioWorld world(resources);
+	{
+		AudioObject object(world);
+		object.set_sound(create_sound(mixing_frequency));
+		object.play();
+		if (world.get_num_real_voices() != 1)
+			fail();
+	}
+
+	// The world keeps playing objects alive
+	world.update();
+	if (world.get_num_real_voices() != 1)
+		fail();
+
+	AudioObject object(world);
+	object.set_sound(create_sound(mixing_frequency));
+	object.play();
+	object.play();
+	if (world.get_num_real_voices() != 2)
+		fail();
+	object.stop();
+	if (object.is_playing() || world.get_num_real_voices() != 1)
+		fail();
+}
+
+SoundBuffer TestApp::create_sound(int num_samples)
+{
+	std::vector<short> data(num_samples);
+	for (int i = 0; i < num_samples; i++)
+		data[i] = (short)((i % 100) * 100);
+	return SoundBuffer(new SoundProvider_Raw(data.data(), num_samples, 2, false, mixing_frequency));
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
@@ -0,0 +1,184 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/sound.h>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <random>
+using namespace clan;
+
+const int mixing_frequency = 44100;
+const int mixing_latency = 23;
+const int num_emitters = 10000;
+const int num_frames = 200;
+const float map_size = 4000.0f;
+
+SoundBuffer create_sine(int num_samples)
+{
+	std::vector<short> data(num_samples * 2);
+	for (int i = 0; i < num_samples; i++)
+	{
+		short sample = (short)(std::sin(i * 0.05) * 8000.0);
+		data[i * 2] = sample;
+		data[i * 2 + 1] = sample;
+	}
+	return SoundBuffer(new SoundProvider_Raw(data.data(), num_samples, 2, true, mixing_frequency));
+}
+
+Vec3f get_listener_position(int frame)
+{
+	float angle = frame * 0.01f;
+	return Vec3f(map_size * 0.5f + std::cos(angle) * map_size * 0.3f, 0.0f, map_size * 0.5f + std::sin(angle) * map_size * 0.3f);
+}
+
+/// \brief The per-object volume and pan calculation AudioWorld did before batching, for comparison
+void benchmark_reference(const std::vector<Vec3f> &positions)
+{
+	struct Emitter
+	{
+		Vec3f position;
+		float volume, pan;
+	};
+	std::list<Emitter> emitters;
+	for (const Vec3f &position : positions)
+		emitters.push_back({ position, 0.0f, 0.0f });
+
+	Quaternionf orientation;
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < num_frames; frame++)
+	{
+		Vec3f listener = get_listener_position(frame);
+		for (Emitter &emitter : emitters)
+		{
+			float distance = emitter.position.distance(listener);
+			float t = 1.0f - smoothstep(10.0f, 150.0f, distance);
+			Vec3f sound_direction = Vec3f::normalize(emitter.position - listener);
+			Vec3f ear_vector = orientation.rotate_vector(Vec3f(1.0f, 0.0f, 0.0f));
+			emitter.pan = Vec3f::dot(ear_vector, sound_direction);
+			emitter.volume = (0.5f + std::abs(emitter.pan) * 0.5f) * t;
+		}
+	}
+	double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	Console::write_line("  Per-object evaluation of all emitters: %1 us per update", StringHelp::float_to_text((float)(time / num_frames), 1));
+}
+
+/// \brief Measures AudioWorld::update and the mixing cost of the voices it keeps real
+void benchmark_world(SoundOutput &output, SoundBuffer &buffer, const std::vector<Vec3f> &positions, float cell_size, int max_voices, int num_moving)
+{
+	ResourceManager resources;
+	AudioWorld world(resources);
+	world.set_cell_size(cell_size);
+	world.set_max_voices(max_voices);
+	world.set_listener(get_listener_position(0), Quaternionf());
+
+	std::vector<AudioObject> objects;
+	for (const Vec3f &position : positions)
+	{
+		AudioObject object(world);
+		object.set_sound(buffer);
+		object.set_looping(true);
+		object.set_attenuation_begin(10.0f);
+		object.set_attenuation_end(150.0f);
+		object.set_position(position);
+		object.play();
+		objects.push_back(object);
+	}
+
+	output.render(2);
+	output.reset_mixer_statistics();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < num_frames; frame++)
+	{
+		for (int i = 0; i < num_moving; i++)
+		{
+			AudioObject &object = objects[(frame * num_moving + i) % objects.size()];
+			object.set_position(object.get_position() + Vec3f(1.0f, 0.0f, 0.0f));
+		}
+		world.set_listener(get_listener_position(frame), Quaternionf());
+		world.update();
+	}
+	double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	int real_voices = world.get_num_real_voices();
+	output.render(4);
+	SoundMixerStatistics statistics = output.get_mixer_statistics();
+
+	Console::write_line("  Cell size %1, %2 voices max, %3 moving: %4 us per update, %5 real voices, mixing %6 us per fragment",
+		StringHelp::float_to_text(cell_size, 0), max_voices, num_moving,
+		StringHelp::float_to_text((float)(time / num_frames), 1), real_voices,
+		StringHelp::float_to_text((float)statistics.get_average_mix_time(), 1));
+
+	for (auto &object : objects)
+		object.stop();
+	output.render();
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		SoundOutput_Description desc;
+		desc.set_mixing_frequency(mixing_frequency);
+		desc.set_mixing_latency(mixing_latency);
+		desc.set_offline(true);
+		SoundOutput output(desc);
+
+		SoundBuffer buffer = create_sine(mixing_frequency);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> coord(0.0f, map_size);
+		std::vector<Vec3f> positions;
+		for (int i = 0; i < num_emitters; i++)
+			positions.push_back(Vec3f(coord(random), 0.0f, coord(random)));
+
+		Console::write_line("AudioWorld benchmark, %1 looping emitters on a %2 x %3 map, audible within 150 units", num_emitters, (int)map_size, (int)map_size);
+
+		benchmark_reference(positions);
+		benchmark_world(output, buffer, positions, map_size * 4.0f, 64, 0);
+		benchmark_world(output, buffer, positions, 64.0f, 64, 0);
+		benchmark_world(output, buffer, positions, 64.0f, 64, 100);
+		benchmark_world(output, buffer, positions, 64.0f, 16, 0);
+		benchmark_world(output, buffer, positions, 64.0f, num_emitters, 0);
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
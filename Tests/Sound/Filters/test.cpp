@@ -0,0 +1,165 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <cmath>
+
+const int num_samples = 6000;
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound filters");
+
+		test_echo();
+		test_inverse_echo();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
+void TestApp::check_float(const std::vector<float> &a, const std::vector<float> &b)
+{
+	if (a.size() != b.size())
+		fail();
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (std::abs(a[i] - b[i]) > 0.0001f)
+			fail();
+	}
+}
+
+std::vector<float> TestApp::make_signal(int num_samples)
+{
+	std::vector<float> signal(num_samples * 2);
+	for (int i = 0; i < num_samples; i++)
+	{
+		signal[i] = (float)std::sin(i * 0.031);
+		signal[num_samples + i] = (float)std::cos(i * 0.017) * 0.5f;
+	}
+	return signal;
+}
+
+std::vector<float> TestApp::run_filter(SoundFilter &filter, const std::vector<float> &input)
+{
+	std::vector<float> output = input;
+	int block_sizes[] = { 1, 7, 64, 333, 1000, 2100 };
+	int position = 0;
+	for (int i = 0; position < num_samples; i++)
+	{
+		int block_size = std::min(block_sizes[i % 6], num_samples - position);
+		float *channels[2] = { output.data() + position, output.data() + num_samples + position };
+		filter.filter(channels, block_size, 2);
+		position += block_size;
+	}
+	return output;
+}
+
+void TestApp::test_echo()
+{
+	Console::write_line("   Echo filter matches the per sample delay line");
+
+	const int buffer_size = 1000;
+	const float shift_factor = 2.0f;
+
+	std::vector<float> input = make_signal(num_samples);
+	std::vector<float> expected = input;
+	std::vector<float> delay_line(buffer_size * 2, 0.0f);
+	for (int c = 0; c < 2; c++)
+	{
+		int pos = 0;
+		for (int i = 0; i < num_samples; i++)
+		{
+			float &delayed = delay_line[c * buffer_size + pos];
+			delayed = delayed / shift_factor + expected[c * num_samples + i];
+			expected[c * num_samples + i] = delayed;
+			pos = (pos + 1) % buffer_size;
+		}
+	}
+
+	EchoFilter filter(buffer_size, shift_factor);
+	check_float(run_filter(filter, input), expected);
+}
+
+void TestApp::test_inverse_echo()
+{
+	Console::write_line("   Inverse echo filter matches the per sample taps");
+
+	const int buffer_size = 1003;
+	const int delay = buffer_size / 4;
+
+	std::vector<float> input = make_signal(num_samples);
+	std::vector<float> expected = input;
+	std::vector<float> delay_line(buffer_size * 2, 0.0f);
+	for (int c = 0; c < 2; c++)
+	{
+		float *work_buffer = delay_line.data() + c * buffer_size;
+		int pos = 0;
+		for (int i = 0; i < num_samples; i++)
+		{
+			work_buffer[pos] = expected[c * num_samples + i];
+			float result = 0.0f;
+			for (int j = 0; j < 4; j++)
+				result += work_buffer[(pos + delay * j) % buffer_size] / (5 - j);
+			expected[c * num_samples + i] = result;
+			pos = (pos + 1) % buffer_size;
+		}
+	}
+
+	InverseEchoFilter filter(buffer_size);
+	check_float(run_filter(filter, input), expected);
+}
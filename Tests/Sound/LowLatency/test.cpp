@@ -0,0 +1,150 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+static const int mixing_frequency = 48000;
+static const int mixing_latency = 5;
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound low latency output, using the ALSA null device");
+
+		test_description();
+		test_device(true);
+		test_device(false);
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_description()
+{
+	Console::write_line("   Output description");
+
+	SoundOutput_Description desc;
+	if (!desc.get_device().empty() || desc.is_low_latency() || desc.get_realtime_priority() != 0)
+		fail();
+
+	desc.set_device("null");
+	desc.set_low_latency(true);
+	desc.set_realtime_priority(10);
+	if (desc.get_device() != "null" || !desc.is_low_latency() || desc.get_realtime_priority() != 10)
+		fail();
+}
+
+void TestApp::test_device(bool low_latency)
+{
+	Console::write_line(low_latency ? "   Low latency mode" : "   Default mode");
+
+	SoundOutput_Description desc;
+	desc.set_device("null");
+	desc.set_mixing_frequency(mixing_frequency);
+	desc.set_mixing_latency(mixing_latency);
+	desc.set_low_latency(low_latency);
+	desc.set_realtime_priority(low_latency ? 10 : 0);
+	SoundOutput output(desc);
+
+	std::vector<short> data(mixing_frequency * 2);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (short)((i % 200) * 100);
+	SoundBuffer buffer(new SoundProvider_Raw(data.data(), mixing_frequency, 2, true, mixing_frequency));
+	SoundBuffer_Session session = buffer.play(true, &output);
+
+	System::sleep(300);
+	SoundMixerStatistics statistics = output.get_mixer_statistics();
+
+	// Give the mixer thread time to drop the voice, which keeps the output alive
+	session.stop();
+	session = SoundBuffer_Session();
+	System::sleep(250);
+
+	if (statistics.device_latency == 0.0)
+	{
+		Console::write_line("      Device does not report latency (no ALSA), skipped");
+		return;
+	}
+
+	Console::write_line(string_format("      Period %1 frames, buffer %2 us, delay %3 us, %4 fragments, %5 xruns",
+		statistics.fragment_size, (int)statistics.device_latency, (int)statistics.device_delay, statistics.fragments, statistics.xruns));
+
+	if (statistics.fragments == 0 || statistics.fragment_size <= 0)
+		fail();
+	if (statistics.device_delay > statistics.device_latency)
+		fail();
+
+	// The null device accepts any size, so the negotiated buffer should match what was asked for:
+	// the mixing latency in two periods in low latency mode, otherwise 4096 frames in four periods.
+	int buffer_frames = (int)(statistics.device_latency * mixing_frequency / 1000000.0 + 0.5);
+	if (low_latency)
+	{
+		double requested = mixing_latency * 1000.0;
+		if (statistics.device_latency < requested * 0.5 || statistics.device_latency > requested * 2.0)
+			fail();
+		if (statistics.fragment_size * 2 > buffer_frames + 1)
+			fail();
+	}
+	else
+	{
+		if (buffer_frames < 4096 / 2 || buffer_frames > 4096 * 2)
+			fail();
+		if (statistics.fragment_size * 4 > buffer_frames + 1)
+			fail();
+	}
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/sound.h>
+#include <cmath>
+using namespace clan;
+
+// Renders one second of audio per measurement, in fragments of about 1024 samples
+const int mixing_frequency = 44100;
+const int mixing_latency = 23;
+const int num_fragments = 43;
+
+SoundBuffer create_sine(int num_samples)
+{
+	std::vector<short> data(num_samples * 2);
+	for (int i = 0; i < num_samples; i++)
+	{
+		short sample = (short)(std::sin(i * 0.05) * 8000.0);
+		data[i * 2] = sample;
+		data[i * 2 + 1] = sample;
+	}
+	return SoundBuffer(new SoundProvider_Raw(data.data(), num_samples, 2, true, mixing_frequency));
+}
+
+/// \brief Measures the time spent in each mixer stage with a number of looping voices
+void benchmark_mixer(SoundOutput &output, SoundBuffer &buffer, int num_voices, int num_threads)
+{
+	output.set_mixing_threads(num_threads);
+
+	std::vector<SoundBuffer_Session> sessions;
+	for (int i = 0; i < num_voices; i++)
+	{
+		SoundBuffer_Session session = buffer.prepare(true, &output);
+		session.set_frequency(22050 + i * 31);
+		session.set_volume(1.0f / num_voices);
+		session.play();
+		sessions.push_back(session);
+	}
+
+	// Warm up, then measure
+	output.render(4);
+	output.reset_mixer_statistics();
+	output.render(num_fragments);
+	SoundMixerStatistics statistics = output.get_mixer_statistics();
+
+	double audio_time = 1000000.0 * num_fragments * statistics.fragment_size / mixing_frequency;
+	Console::write_line("  %1 voices, %2 threads: fill %3 us, filter %4 us, clamp %5 us, total %6 us per fragment, %7% of real time",
+		num_voices, num_threads,
+		StringHelp::float_to_text((float)statistics.get_average_fill_time(), 1),
+		StringHelp::float_to_text((float)statistics.get_average_filter_time(), 1),
+		StringHelp::float_to_text((float)statistics.get_average_clamp_time(), 1),
+		StringHelp::float_to_text((float)statistics.get_average_mix_time(), 1),
+		StringHelp::float_to_text((float)(statistics.total_mix_time * 100.0 / audio_time), 2));
+
+	for (auto &session : sessions)
+		session.stop();
+	output.render();
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		SoundOutput_Description desc;
+		desc.set_mixing_frequency(mixing_frequency);
+		desc.set_mixing_latency(mixing_latency);
+		desc.set_offline(true);
+		SoundOutput output(desc);
+
+		EchoFilter echo;
+		output.add_filter(echo);
+
+		SoundBuffer buffer = create_sine(mixing_frequency);
+
+		Console::write_line("Mixer benchmark, offline output at %1 Hz with an echo filter", mixing_frequency);
+
+		int voice_counts[] = { 1, 16, 64, 256, 1024 };
+		int thread_counts[] = { 1, std::max(System::get_num_cores(), 2) };
+		for (int num_threads : thread_counts)
+		{
+			for (int num_voices : voice_counts)
+				benchmark_mixer(output, buffer, num_voices, num_threads);
+		}
+
+		output.remove_filter(echo);
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,204 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <cmath>
+#include <thread>
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound mixer, reporting mix time per fragment versus voice count");
+
+		output = SoundOutput(44100);
+		looping_buffer = create_sine(44100, 44100);
+		short_buffer = create_sine(1000, 44100);
+
+		test_voice_ends();
+		test_command_threads();
+		test_voice_scaling(1);
+		test_voice_scaling(std::max(System::get_num_cores(), 2));
+
+		output = SoundOutput();
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
+SoundBuffer TestApp::create_sine(int num_samples, int frequency)
+{
+	const double pi = 3.14159265358979323846;
+	std::vector<short> data(num_samples * 2);
+	for (int i = 0; i < num_samples; i++)
+	{
+		short sample = (short)(std::sin(2.0 * pi * 440.0 * i / frequency) * 1000.0);
+		data[i * 2] = sample;
+		data[i * 2 + 1] = sample;
+	}
+	return SoundBuffer(new SoundProvider_Raw(data.data(), num_samples, 2, true, frequency));
+}
+
+void TestApp::wait_for_voices(int num_voices)
+{
+	uint64_t start_time = System::get_microseconds();
+	while (true)
+	{
+		output.reset_mixer_statistics();
+		System::sleep(10);
+		SoundMixerStatistics statistics = output.get_mixer_statistics();
+		if (statistics.fragments > 0 && statistics.voices == num_voices)
+			break;
+		if (System::get_microseconds() - start_time > 5000000)
+			fail();
+	}
+}
+
+void TestApp::test_voice_ends()
+{
+	Console::write_line("   Voices leave the mixer when they end or stop");
+
+	SoundBuffer_Session ending = short_buffer.play();
+	SoundBuffer_Session stopped = looping_buffer.play(true);
+	wait_for_voices(1);
+	if (ending.is_playing() || !stopped.is_playing())
+		fail();
+
+	stopped.stop();
+	wait_for_voices(0);
+
+	// Play and stop queued before the mixer gets to them
+	for (int i = 0; i < 10; i++)
+	{
+		stopped.play();
+		stopped.stop();
+	}
+	stopped.play();
+	wait_for_voices(1);
+	stopped.stop();
+	wait_for_voices(0);
+}
+
+void TestApp::test_command_threads()
+{
+	Console::write_line("   Voices started and stopped from several threads");
+
+	// Commands are recycled by the mixer and reused by whichever thread pushes next
+	std::vector<std::thread> threads;
+	for (int thread_index = 0; thread_index < 4; thread_index++)
+	{
+		threads.push_back(std::thread([this]()
+		{
+			SoundBuffer_Session session = looping_buffer.prepare(true);
+			for (int i = 0; i < 2000; i++)
+			{
+				session.play();
+				if (i % 100 == 0)
+					System::sleep(1);
+				session.stop();
+			}
+		}));
+	}
+	for (auto &thread : threads)
+		thread.join();
+
+	wait_for_voices(0);
+
+	SoundBuffer_Session session = looping_buffer.play(true);
+	wait_for_voices(1);
+	session.stop();
+	wait_for_voices(0);
+}
+
+void TestApp::test_voice_scaling(int num_threads)
+{
+	Console::write_line(string_format("   Mixing with %1 thread(s)", num_threads));
+
+	output.set_mixing_threads(num_threads);
+	if (output.get_mixing_threads() != num_threads)
+		fail();
+
+	int voice_counts[] = { 16, 64, 256, 1024 };
+	for (int num_voices : voice_counts)
+	{
+		std::vector<SoundBuffer_Session> sessions;
+		for (int i = 0; i < num_voices; i++)
+		{
+			SoundBuffer_Session session = looping_buffer.prepare(true);
+			session.set_frequency(22050 + i * 17);
+			session.set_pan((i % 3) - 1.0f);
+			session.set_volume(1.0f / num_voices);
+			session.play();
+			sessions.push_back(session);
+		}
+		wait_for_voices(num_voices);
+
+		output.reset_mixer_statistics();
+		System::sleep(500);
+		SoundMixerStatistics statistics = output.get_mixer_statistics();
+		if (statistics.voices != num_voices)
+			fail();
+
+		double average = statistics.get_average_mix_time();
+		double per_voice_sample = statistics.fragment_size > 0 ? average * 1000.0 / (statistics.fragment_size * (double)num_voices) : 0.0;
+		Console::write_line(string_format("      %1 voices: %2 fragments of %3 samples, average %4 us, max %5 us (%6 ns per voice sample)",
+			num_voices, statistics.fragments, statistics.fragment_size,
+			(int)average, (int)statistics.max_mix_time, per_voice_sample));
+
+		for (auto &session : sessions)
+			session.stop();
+		wait_for_voices(0);
+	}
+}
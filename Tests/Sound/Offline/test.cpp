@@ -0,0 +1,278 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <cmath>
+
+// 10 ms fragments
+const int mixing_frequency = 44100;
+const int mixing_latency = 10;
+const int fragment_size = 441;
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound offline output");
+
+		test_render_on_demand();
+		test_deterministic();
+		test_stage_statistics();
+		test_wav_capture();
+		test_free_running();
+		test_session_commands();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
+SoundBuffer TestApp::create_ramp(int num_samples)
+{
+	std::vector<short> data(num_samples * 2);
+	for (int i = 0; i < num_samples; i++)
+	{
+		data[i * 2] = (short)((i % 1000) * 16);
+		data[i * 2 + 1] = (short)(-(i % 1000) * 16);
+	}
+	return SoundBuffer(new SoundProvider_Raw(data.data(), num_samples, 2, true, mixing_frequency));
+}
+
+std::vector<float> TestApp::render_ramp(int num_fragments)
+{
+	SoundOutput_Description desc;
+	desc.set_mixing_frequency(mixing_frequency);
+	desc.set_mixing_latency(mixing_latency);
+	desc.set_offline(true);
+	desc.set_capture_to_memory(true);
+	SoundOutput output(desc);
+
+	SoundBuffer buffer = create_ramp(fragment_size * 2);
+	SoundBuffer_Session session = buffer.prepare(false, &output);
+	session.play();
+	output.render(num_fragments);
+
+	if (session.is_playing())
+		fail();
+	return output.take_captured_samples();
+}
+
+void TestApp::test_render_on_demand()
+{
+	Console::write_line("   Fragments are mixed when rendered");
+
+	std::vector<float> samples = render_ramp(3);
+	if (samples.size() != fragment_size * 3 * 2)
+		fail();
+
+	for (int i = 0; i < fragment_size * 3; i++)
+	{
+		float expected = i < fragment_size * 2 ? (i % 1000) * 16 / 32768.0f : 0.0f;
+		if (std::abs(samples[i * 2] - expected) > 0.0001f || std::abs(samples[i * 2 + 1] + expected) > 0.0001f)
+			fail();
+	}
+}
+
+void TestApp::test_deterministic()
+{
+	Console::write_line("   Rendering is deterministic");
+
+	std::vector<float> first = render_ramp(4);
+	std::vector<float> second = render_ramp(4);
+	if (first != second)
+		fail();
+}
+
+void TestApp::test_stage_statistics()
+{
+	Console::write_line("   Statistics report the time of each stage");
+
+	SoundOutput_Description desc;
+	desc.set_mixing_latency(mixing_latency);
+	desc.set_offline(true);
+	SoundOutput output(desc);
+
+	SoundBuffer buffer = create_ramp(mixing_frequency);
+	SoundBuffer_Session session = buffer.play(true, &output);
+	output.render(20);
+
+	SoundMixerStatistics statistics = output.get_mixer_statistics();
+	if (statistics.fragments != 20 || statistics.fragment_size != fragment_size || statistics.voices != 1)
+		fail();
+	double stages = statistics.total_fill_time + statistics.total_filter_time + statistics.total_clamp_time;
+	if (statistics.total_fill_time <= 0.0 || stages > statistics.total_mix_time)
+		fail();
+
+	output.reset_mixer_statistics();
+	if (output.get_mixer_statistics().fragments != 0)
+		fail();
+
+	// The stop is applied by the next fragment
+	session.stop();
+	output.render();
+}
+
+void TestApp::test_wav_capture()
+{
+	Console::write_line("   Captures to a WAV file");
+
+	std::string filename = "offline_capture.wav";
+	{
+		SoundOutput_Description desc;
+		desc.set_mixing_latency(mixing_latency);
+		desc.set_offline(true);
+		desc.set_capture_filename(filename);
+		SoundOutput output(desc);
+
+		SoundBuffer buffer = create_ramp(mixing_frequency);
+		SoundBuffer_Session session = buffer.play(true, &output);
+		output.render(10);
+		session.stop();
+		output.render();
+	}
+
+	SoundOutput_Description desc;
+	desc.set_offline(true);
+	SoundOutput output(desc);
+
+	SoundBuffer captured(filename);
+	SoundBuffer_Session session = captured.prepare(false, &output);
+	if (session.get_length() != fragment_size * 11)
+		fail();
+
+	session = SoundBuffer_Session();
+	captured = SoundBuffer();
+	FileHelp::delete_file(filename);
+}
+
+void TestApp::test_free_running()
+{
+	Console::write_line("   Free running outputs mix on their own");
+
+	SoundOutput_Description desc;
+	desc.set_mixing_latency(mixing_latency);
+	desc.set_offline(true, true);
+	SoundOutput output(desc);
+
+	SoundBuffer buffer = create_ramp(fragment_size * 5);
+	SoundBuffer_Session session = buffer.play(false, &output);
+	uint64_t start_time = System::get_time();
+	while (session.is_playing())
+	{
+		if (System::get_time() - start_time > 5000)
+			fail();
+		System::sleep(1);
+	}
+
+	bool render_failed = false;
+	try
+	{
+		output.render();
+	}
+	catch (Exception &)
+	{
+		render_failed = true;
+	}
+	if (!render_failed)
+		fail();
+}
+
+void TestApp::test_session_commands()
+{
+	Console::write_line("   Session changes are applied by the next fragment");
+
+	SoundOutput_Description desc;
+	desc.set_mixing_frequency(mixing_frequency);
+	desc.set_mixing_latency(mixing_latency);
+	desc.set_offline(true);
+	desc.set_capture_to_memory(true);
+	SoundOutput output(desc);
+
+	SoundBuffer buffer = create_ramp(fragment_size * 4);
+	SoundBuffer_Session first = buffer.play(true, &output);
+	SoundBuffer_Session second = buffer.play(true, &output);
+	output.render();
+
+	// The getters report the requested state before the mixer has applied it
+	if (!first.set_position(fragment_size) || first.get_position() != fragment_size)
+		fail();
+	if (first.set_position(-1) || first.set_position(fragment_size * 4 + 1))
+		fail();
+	first.set_looping(false);
+	first.set_resampler_quality(resampler_sinc);
+	if (first.get_looping() || first.get_resampler_quality() != resampler_sinc)
+		fail();
+	output.render();
+	if (!first.is_playing() || !second.is_playing() || output.get_mixer_statistics().voices != 2)
+		fail();
+
+	output.stop_all();
+	output.take_captured_samples();
+	output.render();
+	if (first.is_playing() || second.is_playing() || output.get_mixer_statistics().voices != 0)
+		fail();
+	std::vector<float> samples = output.take_captured_samples();
+	for (auto &sample : samples)
+	{
+		if (sample != 0.0f)
+			fail();
+	}
+
+	// A stopped session can be played again
+	first.play();
+	output.render();
+	if (!first.is_playing() || output.get_mixer_statistics().voices != 1)
+		fail();
+}
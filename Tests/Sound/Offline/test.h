@@ -0,0 +1,54 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/sound.h>
+using namespace clan;
+
+class TestApp
+{
+public:
+	int main();
+
+private:
+	void test_render_on_demand();
+	void test_deterministic();
+	void test_stage_statistics();
+	void test_wav_capture();
+	void test_free_running();
+	void test_session_commands();
+
+	/// \brief Renders a ramp on a new offline output capturing to memory
+	std::vector<float> render_ramp(int num_fragments);
+
+	/// \brief Creates a buffer containing a stereo ramp
+	SoundBuffer create_ramp(int num_samples);
+
+	void fail();
+};
@@ -0,0 +1,228 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+static const char *filename = "../../../Examples/Sound/Sound/Resources/cheer1.ogg";
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound decoded PCM cache");
+
+		test_hits();
+		test_budget();
+		test_max_clip_size();
+		test_streamed();
+
+		reset();
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_hits()
+{
+	Console::write_line("   Shared decoded samples");
+	reset();
+
+	// Reference decode with the cache disabled
+	SoundPCMCache::set_budget(0);
+	std::vector<float> reference;
+	{
+		SoundProvider_Vorbis provider(filename, false);
+		reference = decode(provider);
+		if (SoundPCMCache::get_num_clips() != 0 || SoundPCMCache::get_misses() != 0)
+			fail();
+	}
+
+	SoundPCMCache::set_budget(16 * 1024 * 1024);
+	SoundProvider_Vorbis provider(filename, false);
+	SoundPCMCache::wait_for_predecode();
+	if (SoundPCMCache::get_num_clips() != 1 || SoundPCMCache::get_cached_bytes() <= 0)
+		fail();
+	if (SoundPCMCache::get_decode_time() <= 0.0)
+		fail();
+
+	for (int i = 0; i < 4; i++)
+		compare(decode(provider), reference);
+
+	if (SoundPCMCache::get_hits() != 4 || SoundPCMCache::get_misses() != 0)
+		fail();
+	if (SoundPCMCache::get_hit_rate() != 1.0 || SoundPCMCache::get_decode_time_saved() <= 0.0)
+		fail();
+
+	// Seeking inside decoded samples
+	SoundProvider_Session *session = provider.begin_session();
+	if (session->get_num_samples() <= 0 || session->get_frequency() <= 0)
+		fail();
+	if (!session->set_position(session->get_num_samples() / 2) || session->get_position() != session->get_num_samples() / 2)
+		fail();
+	if (session->set_position(session->get_num_samples() + 1))
+		fail();
+	provider.end_session(session);
+
+	Console::write_line(string_format("      Hit rate: %1%%, decode time saved: %2 us", (int)(SoundPCMCache::get_hit_rate() * 100.0), (int)SoundPCMCache::get_decode_time_saved()));
+}
+
+void TestApp::test_budget()
+{
+	Console::write_line("   LRU budget");
+	reset();
+
+	SoundProvider_Vorbis first(filename, false);
+	SoundPCMCache::wait_for_predecode();
+	int64_t clip_size = SoundPCMCache::get_cached_bytes();
+	if (clip_size <= 0)
+		fail();
+
+	// Room for one clip only: loading a second evicts the first
+	SoundPCMCache::set_budget(clip_size + clip_size / 2);
+	SoundProvider_Vorbis second(filename, false);
+	SoundPCMCache::wait_for_predecode();
+	if (SoundPCMCache::get_num_clips() != 1 || SoundPCMCache::get_evictions() != 1)
+		fail();
+	if (SoundPCMCache::get_cached_bytes() > SoundPCMCache::get_budget())
+		fail();
+
+	// The evicted clip still plays, and is decoded again for later sessions
+	std::vector<float> a = decode(first);
+	if (SoundPCMCache::get_misses() != 1)
+		fail();
+	SoundPCMCache::wait_for_predecode();
+	compare(decode(first), a);
+	if (SoundPCMCache::get_hits() != 1 || SoundPCMCache::get_evictions() != 2)
+		fail();
+}
+
+void TestApp::test_max_clip_size()
+{
+	Console::write_line("   Maximum clip size");
+	reset();
+
+	SoundPCMCache::set_max_clip_size(1024);
+	SoundProvider_Vorbis provider(filename, false);
+	SoundPCMCache::wait_for_predecode();
+	if (SoundPCMCache::get_num_clips() != 0 || SoundPCMCache::get_cached_bytes() != 0)
+		fail();
+
+	if (decode(provider).empty())
+		fail();
+	if (SoundPCMCache::get_hits() != 0 || SoundPCMCache::get_misses() != 0)
+		fail();
+}
+
+void TestApp::test_streamed()
+{
+	Console::write_line("   Streamed providers");
+	reset();
+
+	SoundProvider_Vorbis provider(filename, true);
+	SoundPCMCache::wait_for_predecode();
+	if (SoundPCMCache::get_num_clips() != 0)
+		fail();
+	if (decode(provider).empty())
+		fail();
+	if (SoundPCMCache::get_hits() != 0 || SoundPCMCache::get_misses() != 0)
+		fail();
+}
+
+std::vector<float> TestApp::decode(SoundProvider &provider)
+{
+	SoundProvider_Session *session = provider.begin_session();
+	session->play();
+
+	const int block_size = 1000;
+	std::vector<float> left(block_size), right(block_size);
+	float *channels[2] = { left.data(), right.data() };
+	int num_channels = session->get_num_channels();
+
+	std::vector<float> output;
+	while (!session->eof())
+	{
+		int samples = session->get_data(channels, block_size);
+		if (samples == 0)
+			break;
+		for (int i = 0; i < samples; i++)
+		{
+			for (int c = 0; c < num_channels; c++)
+				output.push_back(channels[c][i]);
+		}
+	}
+
+	provider.end_session(session);
+	return output;
+}
+
+void TestApp::compare(const std::vector<float> &a, const std::vector<float> &b)
+{
+	if (a.size() != b.size() || a.empty())
+		fail();
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (std::abs(a[i] - b[i]) > 0.0001f)
+			fail();
+	}
+}
+
+void TestApp::reset()
+{
+	SoundPCMCache::set_budget(16 * 1024 * 1024);
+	SoundPCMCache::set_max_clip_size(1024 * 1024);
+	SoundPCMCache::clear();
+	SoundPCMCache::reset_counters();
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
@@ -0,0 +1,198 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound resampler");
+
+		test_unity_step();
+		test_blocks_match_single_samples();
+		test_sine_accuracy();
+		test_anti_aliasing();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
+std::vector<float> TestApp::make_sine(double cycles_per_sample, int length)
+{
+	const double pi = 3.14159265358979323846;
+	std::vector<float> input(SoundResampler::history + length + SoundResampler::lookahead);
+	for (int i = 0; i < (int)input.size(); i++)
+		input[i] = (float)std::sin(2.0 * pi * cycles_per_sample * (i - SoundResampler::history));
+	return input;
+}
+
+double TestApp::rms_error(const std::vector<float> &output, double cycles_per_sample, double step)
+{
+	const double pi = 3.14159265358979323846;
+	double sum = 0.0;
+	for (int i = 0; i < (int)output.size(); i++)
+	{
+		double expected = std::sin(2.0 * pi * cycles_per_sample * i * step);
+		sum += (output[i] - expected) * (output[i] - expected);
+	}
+	return std::sqrt(sum / output.size());
+}
+
+void TestApp::test_unity_step()
+{
+	Console::write_line("   Unity step copies the input");
+
+	std::vector<float> input = make_sine(0.01, 1000);
+	ResamplerQuality qualities[] = { resampler_nearest, resampler_linear, resampler_cubic, resampler_sinc };
+	for (auto quality : qualities)
+	{
+		SoundResampler resampler(quality);
+		std::vector<float> output(1000);
+		resampler.resample(input.data(), SoundResampler::history, 1.0, output.data(), (int)output.size());
+		for (int i = 0; i < (int)output.size(); i++)
+		{
+			if (output[i] != input[SoundResampler::history + i])
+				fail();
+		}
+	}
+}
+
+void TestApp::test_blocks_match_single_samples()
+{
+	Console::write_line("   SIMD blocks match the scalar kernels");
+
+	std::vector<float> input = make_sine(0.037, 4000);
+	ResamplerQuality qualities[] = { resampler_nearest, resampler_linear, resampler_cubic, resampler_sinc };
+	double steps[] = { 0.5, 0.7317, 1.0594, 1.87 };
+	for (auto quality : qualities)
+	{
+		for (double step : steps)
+		{
+			SoundResampler resampler(quality);
+			int num_samples = int(3900 / step);
+			double position = SoundResampler::history + 0.3;
+
+			std::vector<float> block(num_samples);
+			resampler.resample(input.data(), position, step, block.data(), num_samples);
+
+			for (int i = 0; i < num_samples; i++)
+			{
+				float single;
+				resampler.resample(input.data(), position + i * step, step, &single, 1);
+
+				// SIMD lanes use float offsets, and may pick the neighbouring sample where nearest rounds
+				float tolerance = (quality == resampler_nearest) ? 0.25f : 1e-4f;
+				if (std::abs(single - block[i]) > tolerance)
+					fail();
+			}
+		}
+	}
+}
+
+void TestApp::test_sine_accuracy()
+{
+	Console::write_line("   Accuracy for a sine upsampled from 22050 to 44100 Hz");
+
+	// 1 kHz at 22050 Hz
+	double cycles_per_sample = 1000.0 / 22050.0;
+	std::vector<float> input = make_sine(cycles_per_sample, 22050);
+
+	ResamplerQuality qualities[] = { resampler_nearest, resampler_linear, resampler_cubic, resampler_sinc };
+	const char *names[] = { "nearest", "linear", "cubic", "sinc" };
+	double errors[4];
+	for (int q = 0; q < 4; q++)
+	{
+		SoundResampler resampler(qualities[q]);
+		std::vector<float> output(40000);
+		resampler.resample(input.data(), SoundResampler::history, 0.5, output.data(), (int)output.size());
+		errors[q] = rms_error(output, cycles_per_sample, 0.5);
+		Console::write_line(string_format("      %1: rms error %2", names[q], (float)errors[q]));
+	}
+
+	if (!(errors[1] < errors[0] && errors[2] < errors[1] && errors[3] < errors[1]))
+		fail();
+	if (errors[1] > 0.01 || errors[2] > 0.002 || errors[3] > 0.002)
+		fail();
+}
+
+void TestApp::test_anti_aliasing()
+{
+	Console::write_line("   Attenuation of a 15 kHz tone downsampled from 44100 to 22050 Hz");
+
+	// Above the output Nyquist frequency, it would alias to 7050 Hz
+	double cycles_per_sample = 15000.0 / 44100.0;
+	std::vector<float> input = make_sine(cycles_per_sample, 44100);
+
+	ResamplerQuality qualities[] = { resampler_linear, resampler_cubic, resampler_sinc };
+	const char *names[] = { "linear", "cubic", "sinc" };
+	double levels[3];
+	for (int q = 0; q < 3; q++)
+	{
+		SoundResampler resampler(qualities[q]);
+		std::vector<float> output(22000);
+		resampler.resample(input.data(), SoundResampler::history + 0.25, 2.0, output.data(), (int)output.size());
+
+		double sum = 0.0;
+		for (auto sample : output)
+			sum += sample * sample;
+		levels[q] = 10.0 * std::log10(sum / output.size() / 0.5);
+		Console::write_line(string_format("      %1: %2 dB", names[q], (float)levels[q]));
+	}
+
+	if (levels[2] > -30.0 || levels[2] > levels[0] - 20.0)
+		fail();
+}
@@ -0,0 +1,116 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/sound.h>
+#include <cmath>
+using namespace clan;
+
+// One second of mixing, in fragments of the size used by the mixer thread
+const int mixing_frequency = 44100;
+const int fragment_size = 1024;
+const int num_fragments = mixing_frequency / fragment_size;
+const int num_passes = 5;
+
+float sink = 0.0f;
+
+/// \brief Measures the time one stereo voice spends resampling one second of audio
+void benchmark_voice(ResamplerQuality quality, const char *name, int voice_frequency)
+{
+	double step = voice_frequency / double(mixing_frequency);
+	int input_size = int(num_fragments * fragment_size * step) + SoundResampler::history + SoundResampler::lookahead + 2;
+
+	std::vector<float> input[2];
+	for (auto &channel : input)
+	{
+		channel.resize(input_size);
+		for (int i = 0; i < input_size; i++)
+			channel[i] = std::sin(i * 0.05f);
+	}
+	std::vector<float> output(fragment_size);
+
+	SoundResampler resampler(quality);
+	double best_seconds = 0.0;
+	for (int pass = 0; pass < num_passes; pass++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		double position = SoundResampler::history;
+		for (int fragment = 0; fragment < num_fragments; fragment++)
+		{
+			for (auto &channel : input)
+			{
+				resampler.resample(channel.data(), position, step, output.data(), fragment_size);
+				sink += output[0];
+			}
+			position += fragment_size * step;
+		}
+		uint64_t end_time = System::get_microseconds();
+		double seconds = (end_time - start_time) / 1000000.0;
+		if (pass == 0 || seconds < best_seconds)
+			best_seconds = seconds;
+	}
+
+	double samples = 2.0 * num_fragments * fragment_size;
+	Console::write_line("  %1: %2 ns/sample, %3% of a core per voice", name,
+		StringHelp::float_to_text((float)(best_seconds * 1e9 / samples), 2),
+		StringHelp::float_to_text((float)(best_seconds * 100.0 * mixing_frequency / (num_fragments * fragment_size)), 3));
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("Resampler benchmark, stereo voices mixed at %1 Hz", mixing_frequency);
+		Console::write_line("AVX2: %1", System::detect_cpu_extension(System::avx2) ? "yes" : "no");
+
+		int frequencies[] = { 22050, 46722, 44100 };
+		const char *descriptions[] = { "22050 Hz asset", "44100 Hz asset pitched up a semitone", "44100 Hz asset (unity step)" };
+		for (int i = 0; i < 3; i++)
+		{
+			Console::write_line(descriptions[i]);
+			benchmark_voice(resampler_nearest, "nearest", frequencies[i]);
+			benchmark_voice(resampler_linear, "linear", frequencies[i]);
+			benchmark_voice(resampler_cubic, "cubic", frequencies[i]);
+			benchmark_voice(resampler_sinc, "sinc", frequencies[i]);
+		}
+
+		Console::write_line("(checksum %1)", sink);
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
@@ -217,6 +217,49 @@ void TestApp::do_test()
 	SoundSSE::mix_many_to_one(in_float, volumes, 2, data_size, out2_float_buffer1);
 	check_float(out_float_buffer1, out2_float_buffer1, data_size);
 
+	memcpy(out_float_buffer1, in_float_buffer2, sizeof(out_float_buffer1));
+	memcpy(out_float_buffer2, in_float_buffer1, sizeof(out_float_buffer2));
+	mix_many_to_many(in_float, data_size, out_float, volumes, 2);
+	memcpy(out2_float_buffer1, in_float_buffer2, sizeof(out2_float_buffer1));
+	memcpy(out2_float_buffer2, in_float_buffer1, sizeof(out2_float_buffer2));
+	SoundSSE::mix_many_to_many(in_float, data_size, out2_float, volumes, 2);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+	check_float(out_float_buffer2, out2_float_buffer2, data_size);
+
+	memcpy(out_float_buffer1, in_float_buffer1, sizeof(out_float_buffer1));
+	clamp_float(out_float_buffer1, data_size, -0.5f, 0.25f);
+	memcpy(out2_float_buffer1, in_float_buffer1, sizeof(out2_float_buffer1));
+	SoundSSE::clamp_float(out2_float_buffer1, data_size, -0.5f, 0.25f);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+
+	// Saturation of samples outside the -1 to 1 range
+	for (int cnt = 0; cnt < data_size; cnt++)
+	{
+		out_float_buffer1[cnt] = in_float_buffer1[cnt] * 3.0f;
+		out_float_buffer2[cnt] = in_float_buffer2[cnt] * 3.0f;
+	}
+	memset(out_16_buffer1, 0, sizeof(out_16_buffer1));
+	SoundSSE::clamp_float(out_float_buffer1, data_size, -1.0f, 1.0f);
+	SoundSSE::clamp_float(out_float_buffer2, data_size, -1.0f, 1.0f);
+	pack_16bit_stereo(out_float, data_size/2, out_16_buffer1);
+	for (int cnt = 0; cnt < data_size; cnt++)
+	{
+		out_float_buffer1[cnt] = in_float_buffer1[cnt] * 3.0f;
+		out_float_buffer2[cnt] = in_float_buffer2[cnt] * 3.0f;
+	}
+	memset(out2_16_buffer1, 0, sizeof(out2_16_buffer1));
+	SoundSSE::pack_16bit_stereo(out_float, data_size/2, out2_16_buffer1);
+	check_16(out_16_buffer1, out2_16_buffer1, data_size);
+
+	memcpy(out_float_buffer1, in_float_buffer1, sizeof(out_float_buffer1));
+	memcpy(out_float_buffer2, in_float_buffer2, sizeof(out_float_buffer2));
+	feedback_delay(out_float_buffer1, out_float_buffer2, data_size, 0.5f);
+	memcpy(out2_float_buffer1, in_float_buffer1, sizeof(out2_float_buffer1));
+	memcpy(out2_float_buffer2, in_float_buffer2, sizeof(out2_float_buffer2));
+	SoundSSE::feedback_delay(out2_float_buffer1, out2_float_buffer2, data_size, 0.5f);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+	check_float(out_float_buffer2, out2_float_buffer2, data_size);
+
 }
 
 void TestApp::check_float(float *aptr, float *bptr, int num)
@@ -384,6 +427,35 @@ void TestApp::mix_many_to_one(float **input, float *volume, int channels, int si
 	}
 }
 
+void TestApp::mix_many_to_many(float **input, int size, float **output, float *volume, int channels)
+{
+	for (int i = 0; i < size; i++)
+	{
+		for (int j = 0; j < channels; j++)
+		{
+			output[j][i] += input[j][i] * volume[j];
+		}
+	}
+}
+
+void TestApp::clamp_float(float *channel, int size, float min_value, float max_value)
+{
+	for (int i = 0; i < size; i++)
+	{
+		if (channel[i] > max_value) channel[i] = max_value;
+		else if (channel[i] < min_value) channel[i] = min_value;
+	}
+}
+
+void TestApp::feedback_delay(float *channel, float *delay_line, int size, float feedback)
+{
+	for (int i = 0; i < size; i++)
+	{
+		delay_line[i] = delay_line[i] * feedback + channel[i];
+		channel[i] = delay_line[i];
+	}
+}
+
 void TestApp::unpack_float_stereo(float *input, int size, float *output[2])
 {
 	const int sse_size = 0;
@@ -55,6 +55,9 @@ private:
 	static void mix_one_to_one(float *input, int size, float *output, float volume);
 	static void mix_one_to_many(float *input, int size, float **output, float *volume, int channels);
 	static void mix_many_to_one(float **input, float *volume, int channels, int size, float *output);
+	static void mix_many_to_many(float **input, int size, float **output, float *volume, int channels);
+	static void clamp_float(float *channel, int size, float min_value, float max_value);
+	static void feedback_delay(float *channel, float *delay_line, int size, float feedback);
 
 	void check_16(short *aptr, short *bptr, int num);
 	void check_float(float *aptr, float *bptr, int num);
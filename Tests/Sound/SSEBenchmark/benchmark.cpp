@@ -0,0 +1,193 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/sound.h>
+#include <cmath>
+#include <functional>
+using namespace clan;
+
+// Kernels run over fragments of the size used by the mixer thread, one second of audio per pass
+const int fragment_size = 1024;
+const int num_fragments = 44100 / fragment_size;
+const int num_passes = 20;
+
+float sink = 0.0f;
+
+/// \brief Returns the best time of a number of passes, in nanoseconds per sample
+double measure(const std::function<void()> &fragment)
+{
+	double best_ns = 0.0;
+	for (int pass = 0; pass < num_passes; pass++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		for (int i = 0; i < num_fragments; i++)
+			fragment();
+		uint64_t end_time = System::get_microseconds();
+		double ns = (end_time - start_time) * 1000.0 / (num_fragments * fragment_size);
+		if (pass == 0 || ns < best_ns)
+			best_ns = ns;
+	}
+	return best_ns;
+}
+
+void report(const char *name, double reference_ns, double simd_ns)
+{
+	Console::write_line("  %1: scalar %2 ns/sample, SoundSSE %3 ns/sample, %4x",
+		name,
+		StringHelp::float_to_text((float)reference_ns, 3),
+		StringHelp::float_to_text((float)simd_ns, 3),
+		StringHelp::float_to_text((float)(reference_ns / simd_ns), 2));
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("Mixer kernel benchmark, %1 sample fragments", fragment_size);
+		Console::write_line("AVX2: %1", System::detect_cpu_extension(System::avx2) ? "yes" : "no");
+
+		std::vector<float> buffers[4];
+		for (auto &buffer : buffers)
+		{
+			buffer.resize(fragment_size);
+			for (int i = 0; i < fragment_size; i++)
+				buffer[i] = std::sin(i * 0.05f) * 0.5f;
+		}
+		float *input[2] = { buffers[0].data(), buffers[1].data() };
+		float *output[2] = { buffers[2].data(), buffers[3].data() };
+		float volume[2] = { 0.7f, 0.3f };
+		std::vector<float> interleaved(fragment_size * 2);
+		std::vector<short> interleaved_16(fragment_size * 2);
+
+		// The scalar loops are the ones the mixer used before the SIMD kernels
+		report("clamp",
+			measure([&]() {
+				for (auto &channel : output)
+				{
+					for (int k = 0; k < fragment_size; k++)
+					{
+						if (channel[k] > 1.0f) channel[k] = 1.0f;
+						else if (channel[k] < -1.0f) channel[k] = -1.0f;
+					}
+				}
+			}),
+			measure([&]() {
+				SoundSSE::clamp_float(output[0], fragment_size, -1.0f, 1.0f);
+				SoundSSE::clamp_float(output[1], fragment_size, -1.0f, 1.0f);
+			}));
+
+		report("stereo gain and pan mix",
+			measure([&]() {
+				for (int c = 0; c < 2; c++)
+				{
+					for (int i = 0; i < fragment_size; i++)
+						output[c][i] += input[c][i] * volume[c];
+				}
+			}),
+			measure([&]() { SoundSSE::mix_many_to_many(input, fragment_size, output, volume, 2); }));
+
+		report("mono gain and pan mix",
+			measure([&]() {
+				for (int i = 0; i < fragment_size; i++)
+				{
+					output[0][i] += input[0][i] * volume[0];
+					output[1][i] += input[0][i] * volume[1];
+				}
+			}),
+			measure([&]() { SoundSSE::mix_one_to_many(input[0], fragment_size, output, volume, 2); }));
+
+		report("interleave float",
+			measure([&]() {
+				for (int i = 0; i < fragment_size; i++)
+				{
+					interleaved[i * 2] = input[0][i];
+					interleaved[i * 2 + 1] = input[1][i];
+				}
+			}),
+			measure([&]() { SoundSSE::pack_float_stereo(input, fragment_size, interleaved.data()); }));
+
+		report("interleave 16 bit",
+			measure([&]() {
+				for (int i = 0; i < fragment_size; i++)
+				{
+					interleaved_16[i * 2] = input[0][i] * 32767;
+					interleaved_16[i * 2 + 1] = input[1][i] * 32767;
+				}
+			}),
+			measure([&]() { SoundSSE::pack_16bit_stereo(input, fragment_size, interleaved_16.data()); }));
+
+		// Echo filter: per sample divide and ring buffer wrap, against the block delay line.
+		// Both filter a fresh copy of the input, so the echo does not build up across passes.
+		const int echo_size = 32 * 1024;
+		std::vector<float> work_buffers[2] = { std::vector<float>(echo_size), std::vector<float>(echo_size) };
+		int echo_pos = 0;
+		EchoFilter echo(echo_size, 2.0f);
+		report("echo filter",
+			measure([&]() {
+				SoundSSE::copy_float(input[0], fragment_size, output[0]);
+				SoundSSE::copy_float(input[1], fragment_size, output[1]);
+				int start_pos = echo_pos;
+				for (int c = 0; c < 2; c++)
+				{
+					float *work_buffer = work_buffers[c].data();
+					echo_pos = start_pos;
+					for (int i = 0; i < fragment_size; i++)
+					{
+						work_buffer[echo_pos] /= 2.0f;
+						work_buffer[echo_pos] += output[c][i];
+						output[c][i] = work_buffer[echo_pos];
+						echo_pos++;
+						if (echo_pos == echo_size) echo_pos = 0;
+					}
+				}
+			}),
+			measure([&]() {
+				SoundSSE::copy_float(input[0], fragment_size, output[0]);
+				SoundSSE::copy_float(input[1], fragment_size, output[1]);
+				echo.filter(output, fragment_size, 2);
+			}));
+
+		for (auto &buffer : buffers)
+			sink += buffer[fragment_size / 2];
+		sink += interleaved[3] + interleaved_16[3];
+		Console::write_line("(checksum %1)", sink);
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
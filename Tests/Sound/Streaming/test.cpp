@@ -0,0 +1,237 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanSound streaming sound providers");
+
+		test_wave();
+		test_truncated_wave();
+		test_vorbis();
+
+		Console::write_line(string_format("Underruns: %1, bytes streamed: %2", SoundStreamStats::get_underruns(), (int)SoundStreamStats::get_bytes_streamed()));
+		if (SoundStreamStats::get_active_streams() != 0 || SoundStreamStats::get_streaming_bytes() != 0 || SoundStreamStats::get_loaded_bytes() != 0)
+			fail();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
+std::vector<float> TestApp::decode(SoundProvider &provider, int block_size, bool restart)
+{
+	SoundProvider_Session *session = provider.begin_session();
+	session->play();
+
+	std::vector<float> left(block_size), right(block_size);
+	float *channels[2] = { left.data(), right.data() };
+	int num_channels = session->get_num_channels();
+
+	std::vector<float> output;
+	for (int pass = restart ? 0 : 1; pass < 2; pass++)
+	{
+		output.clear();
+		while (!session->eof())
+		{
+			int samples = session->get_data(channels, block_size);
+			if (samples == 0)
+				break;
+			for (int i = 0; i < samples; i++)
+			{
+				for (int c = 0; c < num_channels; c++)
+					output.push_back(channels[c][i]);
+			}
+
+			if (pass == 0 && output.size() > 20000)
+				break;
+		}
+
+		if (pass == 0)
+		{
+			if (!session->set_position(0))
+				fail();
+			if (session->get_position() != 0)
+				fail();
+		}
+	}
+
+	provider.end_session(session);
+	return output;
+}
+
+void TestApp::compare(const std::vector<float> &expected, const std::vector<float> &streamed)
+{
+	// Underruns insert silence, so the streamed samples must be the expected ones with only zeros added
+	if (expected.empty())
+		fail();
+	size_t i = 0;
+	for (size_t j = 0; j < streamed.size(); j++)
+	{
+		if (i < expected.size() && streamed[j] == expected[i])
+			i++;
+		else if (streamed[j] != 0.0f)
+			fail();
+	}
+	if (i != expected.size())
+		fail();
+}
+
+void TestApp::test_wave()
+{
+	Console::write_line("   Wave:");
+
+	const std::string filename = "../../../Examples/Sound/Sound/Resources/start.wav";
+
+	Console::write_line("      Memory and streamed sessions decode the same samples");
+	std::vector<float> memory_samples;
+	{
+		SoundProvider_Wave provider(filename, false);
+		if (SoundStreamStats::get_loaded_bytes() == 0)
+			fail();
+		memory_samples = decode(provider, 441);
+	}
+	if (SoundStreamStats::get_loaded_bytes() != 0)
+		fail();
+
+	{
+		SoundProvider_Wave provider(filename, true);
+		if (SoundStreamStats::get_loaded_bytes() != 0)
+			fail();
+		compare(memory_samples, decode(provider, 441));
+		compare(memory_samples, decode(provider, 4000));
+
+		Console::write_line("      Restarting a streamed session");
+		compare(memory_samples, decode(provider, 333, true));
+	}
+
+	Console::write_line("      Streaming from a duplicated device");
+	{
+		File file(filename);
+		DataBuffer data(file.get_size());
+		file.read(data.get_data(), data.get_size());
+		MemoryDevice device(data);
+		SoundProvider_Wave provider(device, true);
+		compare(memory_samples, decode(provider, 1024));
+	}
+}
+
+void TestApp::test_truncated_wave()
+{
+	Console::write_line("   Wave with a truncated data chunk:");
+
+	const int num_samples = 5000;
+	const int stored_samples = 3000;
+	DataBuffer data(44 + stored_samples * 4);
+	MemoryDevice device(data);
+	device.set_little_endian_mode();
+	device.write("RIFF", 4);
+	device.write_uint32(36 + num_samples * 4);
+	device.write("WAVEfmt ", 8);
+	device.write_uint32(16);
+	device.write_uint16(1);
+	device.write_uint16(2);
+	device.write_uint32(22050);
+	device.write_uint32(22050 * 4);
+	device.write_uint16(4);
+	device.write_uint16(16);
+	device.write("data", 4);
+	device.write_uint32(num_samples * 4);
+	for (int i = 0; i < stored_samples * 2; i++)
+		device.write_int16(short(i * 7));
+	device.seek(0);
+
+	SoundProvider_Wave provider(device, true);
+	std::vector<float> expected(stored_samples * 2);
+	for (int i = 0; i < stored_samples * 2; i++)
+		expected[i] = short(i * 7) / 32768.0f;
+	compare(expected, decode(provider, 700));
+}
+
+void TestApp::test_vorbis()
+{
+	Console::write_line("   Vorbis:");
+
+	const std::string filename = "../../../Examples/Sound/Sound/Resources/cheer1.ogg";
+
+	Console::write_line("      Memory and streamed sessions decode the same samples");
+	std::vector<float> memory_samples;
+	{
+		SoundProvider_Vorbis provider(filename, false);
+		memory_samples = decode(provider, 441);
+	}
+
+	{
+		SoundProvider_Vorbis provider(filename, true);
+		compare(memory_samples, decode(provider, 441));
+		compare(memory_samples, decode(provider, 8192));
+
+		Console::write_line("      Restarting a streamed session");
+		compare(memory_samples, decode(provider, 256, true));
+
+		Console::write_line("      Concurrent sessions");
+		SoundProvider_Session *session1 = provider.begin_session();
+		SoundProvider_Session *session2 = provider.begin_session();
+		if (SoundStreamStats::get_active_streams() != 2)
+			fail();
+		if (SoundStreamStats::get_streaming_bytes() <= 0)
+			fail();
+		provider.end_session(session1);
+		provider.end_session(session2);
+	}
+}
@@ -0,0 +1,145 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/ui.h>
+#include <chrono>
+using namespace clan;
+
+const int tree_depth = 7;
+const int num_children = 4;
+const int panel_depth = 4;
+const int num_iterations = 20;
+
+class BenchmarkViewTree : public ViewTree
+{
+public:
+	DisplayWindow display_window() override { return DisplayWindow(); }
+	Canvas canvas() const override { return Canvas(); }
+
+	void layout_views()
+	{
+		Canvas canvas;
+		layout(canvas, Rectf(0.0f, 0.0f, 1920.0f, 1080.0f));
+	}
+
+protected:
+	void set_needs_render() override { }
+	Pointf client_to_screen_pos(const Pointf &pos) override { return pos; }
+	Pointf screen_to_client_pos(const Pointf &pos) override { return pos; }
+};
+
+/// \brief Builds a tree of nested rows and columns, with panels of a definite size at panel_depth if requested
+std::shared_ptr<View> create_tree(int depth, bool definite_panels, std::vector<View *> &views)
+{
+	auto view = std::make_shared<View>();
+	views.push_back(view.get());
+
+	if (depth == tree_depth)
+	{
+		view->style()->set("height: 4px; margin: 1px");
+		return view;
+	}
+
+	if (definite_panels && depth == panel_depth)
+		view->style()->set("flex-direction: %1; width: 60px; height: 60px; padding: 1px", depth % 2 ? "row" : "column");
+	else
+		view->style()->set("flex-direction: %1; padding: 1px", depth % 2 ? "row" : "column");
+
+	for (int i = 0; i < num_children; i++)
+		view->add_child(create_tree(depth + 1, definite_panels, views));
+	return view;
+}
+
+double full_relayout(BenchmarkViewTree &tree, const std::vector<View *> &views)
+{
+	double time = 0.0;
+	for (int iteration = 0; iteration < num_iterations; iteration++)
+	{
+		for (View *view : views)
+			view->set_needs_layout();
+
+		auto start = std::chrono::steady_clock::now();
+		tree.layout_views();
+		time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	return time / num_iterations;
+}
+
+double leaf_relayout(BenchmarkViewTree &tree, const std::vector<View *> &views)
+{
+	View *leaf = views.back();
+
+	double time = 0.0;
+	for (int iteration = 0; iteration < num_iterations; iteration++)
+	{
+		leaf->style()->set("width: %1px", 4 + iteration % 2);
+
+		auto start = std::chrono::steady_clock::now();
+		leaf->set_needs_layout();
+		tree.layout_views();
+		time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if (leaf->geometry().content_width != 4.0f + iteration % 2)
+			throw Exception("Leaf was not laid out again");
+	}
+	return time / num_iterations;
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		std::vector<View *> auto_views, panel_views;
+		BenchmarkViewTree auto_tree, panel_tree;
+		auto_tree.set_root_view(create_tree(0, false, auto_views));
+		panel_tree.set_root_view(create_tree(0, true, panel_views));
+
+		auto_tree.layout_views();
+		panel_tree.layout_views();
+
+		Console::write_line("Layout benchmark, %1 views, depth %2, %3 iterations", (int)auto_views.size(), tree_depth, num_iterations);
+		Console::write_line("  Full relayout: %1 ms", StringHelp::float_to_text((float)full_relayout(auto_tree, auto_views), 3));
+		Console::write_line("  Leaf change, content sized ancestors: %1 ms", StringHelp::float_to_text((float)leaf_relayout(auto_tree, auto_views), 3));
+		Console::write_line("  Leaf change, definite size panels: %1 ms", StringHelp::float_to_text((float)leaf_relayout(panel_tree, panel_views), 3));
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
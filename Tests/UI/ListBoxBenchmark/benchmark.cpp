@@ -0,0 +1,175 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/ui.h>
+#include <chrono>
+using namespace clan;
+
+const int item_counts[] = { 1000, 10000, 50000 };
+const int num_scroll_steps = 100;
+
+class BenchmarkViewTree : public ViewTree
+{
+public:
+	DisplayWindow display_window() override { return DisplayWindow(); }
+	Canvas canvas() const override { return Canvas(); }
+
+	void layout_views()
+	{
+		Canvas canvas;
+		layout(canvas, Rectf(0.0f, 0.0f, 1920.0f, 1080.0f));
+	}
+
+protected:
+	void set_needs_render() override { }
+	Pointf client_to_screen_pos(const Pointf &pos) override { return pos; }
+	Pointf screen_to_client_pos(const Pointf &pos) override { return pos; }
+};
+
+/// \brief A row with an icon and a text sized by the item index
+std::shared_ptr<View> create_item_view()
+{
+	auto view = std::make_shared<View>();
+	view->style()->set("flex-direction: row; padding: 2px 4px; border-bottom: 1px solid #ddd");
+	auto icon = std::make_shared<View>();
+	icon->style()->set("width: 16px; height: 16px; margin-right: 4px");
+	auto text = std::make_shared<View>();
+	text->style()->set("height: 14px");
+	view->add_child(icon);
+	view->add_child(text);
+	return view;
+}
+
+void update_item_view(const std::shared_ptr<View> &view, int index)
+{
+	auto &text = view->children().back();
+	text->style()->set("width: %1px", 40 + index % 100);
+	text->set_needs_layout();
+}
+
+class BenchmarkDataSource : public ListBoxViewDataSource
+{
+public:
+	BenchmarkDataSource(int count) : count(count) { }
+
+	int item_count() override { return count; }
+	std::shared_ptr<View> create_item_view() override { return ::create_item_view(); }
+	void update_item_view(const std::shared_ptr<View> &view, int index) override { ::update_item_view(view, index); }
+
+	int count;
+};
+
+std::shared_ptr<ListBoxView> create_listbox(BenchmarkViewTree &tree)
+{
+	auto root = std::make_shared<View>();
+	root->style()->set("flex-direction: column");
+	auto listbox = std::make_shared<ListBoxView>();
+	listbox->style()->set("width: 300px; height: 400px");
+	root->add_child(listbox);
+	tree.set_root_view(root);
+	return listbox;
+}
+
+double populate(BenchmarkViewTree &tree, const std::shared_ptr<ListBoxView> &listbox, int count, bool virtualized)
+{
+	auto start = std::chrono::steady_clock::now();
+	if (virtualized)
+	{
+		listbox->set_data_source(std::make_shared<BenchmarkDataSource>(count));
+	}
+	else
+	{
+		std::vector<std::shared_ptr<View>> items;
+		items.reserve(count);
+		for (int index = 0; index < count; index++)
+		{
+			items.push_back(create_item_view());
+			update_item_view(items.back(), index);
+		}
+		listbox->set_items(items);
+	}
+	tree.layout_views();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double scroll(BenchmarkViewTree &tree, const std::shared_ptr<ListBoxView> &listbox)
+{
+	auto scrollbar = listbox->scrollbar_y_view();
+	double range = scrollbar->max_position();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int step = 0; step < num_scroll_steps; step++)
+	{
+		scrollbar->set_position(range * ((step * 37) % num_scroll_steps) / num_scroll_steps);
+		tree.layout_views();
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / num_scroll_steps;
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ListBoxView benchmark, %1 scroll steps", num_scroll_steps);
+
+		for (int count : item_counts)
+		{
+			BenchmarkViewTree tree, virtualized_tree;
+			auto listbox = create_listbox(tree);
+			auto virtualized_listbox = create_listbox(virtualized_tree);
+
+			double populate_time = populate(tree, listbox, count, false);
+			double virtualized_populate_time = populate(virtualized_tree, virtualized_listbox, count, true);
+			double scroll_time = scroll(tree, listbox);
+			double virtualized_scroll_time = scroll(virtualized_tree, virtualized_listbox);
+
+			// Only the visible items plus the overscan should have views
+			if (virtualized_listbox->item_view_count() > 400 / 21 + 2 + 2 * virtualized_listbox->overscan())
+				throw Exception("Too many item views created");
+
+			Console::write_line("  %1 items:", count);
+			Console::write_line("    set_items: populate %1 ms, scroll %2 ms", StringHelp::float_to_text((float)populate_time, 2), StringHelp::float_to_text((float)scroll_time, 3));
+			Console::write_line("    set_data_source: populate %1 ms, scroll %2 ms, %3 item views", StringHelp::float_to_text((float)virtualized_populate_time, 2), StringHelp::float_to_text((float)virtualized_scroll_time, 3), virtualized_listbox->item_view_count());
+		}
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,367 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanUI style property sets");
+
+		test_property_ids();
+		test_values();
+		test_arrays();
+		test_cascade();
+		test_cache();
+		test_shared_blocks();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_property_ids()
+{
+	Console::write_line("   Interned property IDs");
+
+	// Properties with defaults are registered by the parsers
+	StylePropertyId width = StylePropertyId::find("width");
+	if (width.is_null() || std::string(width.name()) != "width")
+		fail();
+
+	// Literal, string and runtime names all intern to the same ID
+	StylePropertyId literal("width");
+	StylePropertyId string_name(std::string("width"));
+	if (literal != width || string_name != width || StylePropertyId::intern("width") != width)
+		fail();
+
+	// Looking up an unknown name does not register it
+	int count = StylePropertyId::count();
+	if (!StylePropertyId::find("-test-unknown-property").is_null() || StylePropertyId::count() != count)
+		fail();
+
+	StylePropertyId custom = StylePropertyId::intern("-test-custom-property");
+	if (custom.is_null() || StylePropertyId::count() != count + 1 || StylePropertyId::find("-test-custom-property") != custom)
+		fail();
+
+	// Enough names to make the registry grow
+	std::vector<StylePropertyId> ids;
+	for (int i = 0; i < 2000; i++)
+		ids.push_back(StylePropertyId::intern(string_format("-test-property-%1", i).c_str()));
+	for (int i = 0; i < 2000; i++)
+	{
+		if (StylePropertyId::find(string_format("-test-property-%1", i)) != ids[i])
+			fail();
+	}
+	if (StylePropertyId::find("width") != width)
+		fail();
+
+	// Lookups run without locking while another thread interns names and grows the registry
+	std::atomic<bool> lookup_failed(false);
+	std::thread writer([&]()
+	{
+		for (int i = 0; i < 5000; i++)
+			StylePropertyId::intern(string_format("-test-thread-property-%1", i).c_str());
+	});
+	for (int pass = 0; pass < 20; pass++)
+	{
+		for (int i = 0; i < 2000; i += 7)
+		{
+			if (StylePropertyId::find(string_format("-test-property-%1", i)) != ids[i] || std::string(ids[i].name()) != string_format("-test-property-%1", i))
+				lookup_failed = true;
+		}
+		// A name being interned must be either missing or found with its own ID, never another name's
+		for (int i = pass; i < 5000; i += 37)
+		{
+			std::string name = string_format("-test-thread-property-%1", i);
+			StylePropertyId found = StylePropertyId::find(name);
+			if (!found.is_null() && std::string(found.name()) != name)
+				lookup_failed = true;
+		}
+	}
+	writer.join();
+	if (lookup_failed || StylePropertyId::find("-test-thread-property-4999").is_null())
+		fail();
+}
+
+void TestApp::test_values()
+{
+	Console::write_line("   Declared values");
+
+	Style style;
+	style.set("width: 10px; color: red; position: absolute; flex-grow: 0.5");
+
+	StylePropertyId width("width");
+	if (!style.declared_value(width).is_length() || style.declared_value(width).number() != 10.0f)
+		fail();
+	if (!style.declared_value("color").is_color() || style.declared_value("color").color() != Colorf(1.0f, 0.0f, 0.0f, 1.0f))
+		fail();
+	if (!style.declared_value(std::string("position")).is_keyword("absolute"))
+		fail();
+	if (!style.declared_value("flex-grow").is_number() || style.declared_value("flex-grow").number() != 0.5f)
+		fail();
+	if (!style.declared_value("height").is_undefined() || !style.declared_value("-test-unknown-property").is_undefined())
+		fail();
+
+	// Text stays valid while other properties are set
+	StyleGetValue position = style.declared_value("position");
+	style.set("height: 5em; margin-left: auto; top: 1px; left: 3px");
+	if (!position.is_keyword("absolute"))
+		fail();
+	if (style.declared_value("height").dimension() != StyleDimension::em || !style.declared_value("margin-left").is_keyword("auto"))
+		fail();
+
+	// Changing the type of a property
+	style.set("width: auto; position: relative");
+	if (!style.declared_value(width).is_keyword("auto") || !style.declared_value("position").is_keyword("relative"))
+		fail();
+	style.set("width: 50%");
+	if (!style.declared_value(width).is_percentage() || style.declared_value(width).number() != 50.0f)
+		fail();
+}
+
+void TestApp::test_arrays()
+{
+	Console::write_line("   Value arrays");
+
+	Style style;
+	style.set("font-family: Arial, Verdana, sans-serif");
+	if (!style.declared_value("font-family-names[2]").is_keyword("sans-serif"))
+		fail();
+
+	// A shorter array removes the trailing elements
+	style.set("font-family: Tahoma");
+	if (!style.declared_value("font-family-names[0]").is_string() || std::string(style.declared_value("font-family-names[0]").text()) != "Tahoma")
+		fail();
+	if (!style.declared_value("font-family-names[1]").is_undefined() || !style.declared_value("font-family-names[2]").is_undefined())
+		fail();
+
+	StyleCascade cascade({ &style });
+	if (cascade.array_size("font-family-names") != 1)
+		fail();
+}
+
+void TestApp::test_cascade()
+{
+	Console::write_line("   Cascade");
+
+	Style parent_style;
+	parent_style.set("color: blue; width: 20px; font-size: 10px");
+	Style first;
+	first.set("width: 1em");
+	Style second;
+	second.set("width: 30px; height: 40px");
+
+	StyleCascade parent({ &parent_style });
+	StyleCascade cascade({ &first, &second }, &parent);
+
+	static const StylePropertyId width("width");
+	static const StylePropertyId height("height");
+	static const StylePropertyId color("color");
+	static const StylePropertyId text_align("text-align");
+	static const StylePropertyId left("left");
+
+	// First declared value wins, em resolves against the inherited font size
+	if (cascade.cascade_value(width).number() != 1.0f || cascade.computed_value(width).number() != 10.0f)
+		fail();
+	if (cascade.computed_value("width").number() != 10.0f || cascade.computed_value(height).number() != 40.0f)
+		fail();
+
+	// Inherited properties come from the parent, others fall back to their initial value
+	if (cascade.specified_value(color).color() != Colorf(0.0f, 0.0f, 1.0f, 1.0f))
+		fail();
+	if (!cascade.specified_value(text_align).is_keyword("left") || !cascade.specified_value(left).is_keyword("auto"))
+		fail();
+	if (!StyleProperty::is_inherited(color) || StyleProperty::is_inherited(width) || !StyleProperty::is_inherited("color"))
+		fail();
+	if (!cascade.specified_value("-test-unknown-property").is_undefined())
+		fail();
+}
+
+void TestApp::test_cache()
+{
+	Console::write_line("   Computed value cache");
+
+	Style root_style;
+	root_style.set("font-size: 10px; color: red");
+	Style child_style;
+	child_style.set("width: 2em");
+	Style hover_style;
+
+	StyleCascade root({ &root_style });
+	StyleCascade child({ &child_style }, &root);
+	StyleCascade uncached({ &child_style }, &root);
+	root.set_cache_enabled(true);
+	child.set_cache_enabled(true);
+
+	if (!child.is_cache_enabled() || uncached.is_cache_enabled())
+		fail();
+	if (child.computed_value("width").number() != 20.0f || child.computed_value("width").number() != 20.0f)
+		fail();
+
+	// Modifying a style in the cascade
+	child_style.set("width: 3em");
+	if (child.computed_value("width").number() != 30.0f)
+		fail();
+
+	// Modifying inherited values in the parent
+	root_style.set("font-size: 20px");
+	if (child.computed_value("width").number() != 60.0f || !(child.computed_value("color").color() == Colorf(1.0f, 0.0f, 0.0f, 1.0f)))
+		fail();
+	root_style.set("color: blue");
+	if (child.computed_value("color").color() != Colorf(0.0f, 0.0f, 1.0f, 1.0f) || uncached.computed_value("color").color() != Colorf(0.0f, 0.0f, 1.0f, 1.0f))
+		fail();
+
+	// Modifying the cascade members directly requires invalidate_cache()
+	hover_style.set("width: 5px");
+	child.cascade.insert(child.cascade.begin(), &hover_style);
+	child.invalidate_cache();
+	if (child.computed_value("width").number() != 5.0f)
+		fail();
+	child.cascade.erase(child.cascade.begin());
+	child.invalidate_cache();
+	if (child.computed_value("width").number() != 60.0f)
+		fail();
+
+	// A cached cascade below an uncached parent computes its values every time
+	StyleCascade grandchild({ &hover_style }, &uncached);
+	grandchild.set_cache_enabled(true);
+	if (grandchild.computed_value("font-size").number() != 20.0f)
+		fail();
+	Style small_style;
+	small_style.set("font-size: 7px");
+	uncached.cascade.insert(uncached.cascade.begin(), &small_style);
+	if (grandchild.computed_value("font-size").number() != 7.0f)
+		fail();
+
+	// em in font-size is relative to the parent font size
+	child_style.set("font-size: 1.5em");
+	if (child.computed_value("font-size").number() != 30.0f || child.computed_value("width").number() != 90.0f)
+		fail();
+	child_style.set("font-size: inherit");
+
+	// Copies do not share the cache
+	StyleCascade copy = child;
+	copy.cascade = { &hover_style };
+	copy.invalidate_cache();
+	if (!copy.is_cache_enabled() || copy.computed_value("width").number() != 5.0f || child.computed_value("width").number() != 60.0f)
+		fail();
+}
+
+void TestApp::test_shared_blocks()
+{
+	Console::write_line("   Shared property blocks");
+
+	Style first, second, third;
+	if (!first.shares_properties(second))
+		fail();
+
+	// Equal values share a block, no matter how they were declared
+	first.set("width: 10px; color: red");
+	second.set("width: 10px; color: red");
+	third.set("color: #f00");
+	third.set("width: 10px");
+	if (!first.shares_properties(second) || !first.shares_properties(third))
+		fail();
+
+	// Setting properties only changes the modified property set
+	StyleGetValue color = second.declared_value("color");
+	second.set("width: 20px");
+	if (first.shares_properties(second) || first.declared_value("width").number() != 10.0f || second.declared_value("width").number() != 20.0f)
+		fail();
+	if (second.declared_value("color").color() != Colorf(1.0f, 0.0f, 0.0f, 1.0f) || color.color() != Colorf(1.0f, 0.0f, 0.0f, 1.0f))
+		fail();
+
+	// Copies share the block until modified
+	Style copy(first);
+	if (!copy.shares_properties(first) || copy.generation() == first.generation())
+		fail();
+	copy.set("height: 5px");
+	if (copy.shares_properties(first) || !first.declared_value("height").is_undefined() || copy.declared_value("height").number() != 5.0f)
+		fail();
+	copy = second;
+	if (!copy.shares_properties(second) || !copy.declared_value("height").is_undefined())
+		fail();
+
+	// Keyword text stays valid while a property set holds the block it was read from
+	Style keyword_style;
+	keyword_style.set("position: absolute");
+	Style keyword_copy(keyword_style);
+	StyleGetValue position = keyword_style.declared_value("position");
+	keyword_style.set("position: relative");
+	if (!position.is_keyword("absolute") || !keyword_style.declared_value("position").is_keyword("relative"))
+		fail();
+
+	// Texts from different declarations compare by content
+	Style text_first, text_second;
+	text_first.set("position: absolute; font-family: Verdana");
+	text_second.set("font-family: Verdana");
+	text_second.set("position: absolute");
+	if (!text_first.shares_properties(text_second) || text_first.shares_properties(keyword_style))
+		fail();
+
+	// Arrays are truncated in the shared block the declarations are applied to
+	Style fonts, other_fonts;
+	fonts.set("font-family: Arial, Verdana, sans-serif");
+	other_fonts.set("font-family: Arial, Verdana, sans-serif");
+	fonts.set("font-family: Tahoma");
+	if (!fonts.declared_value("font-family-names[1]").is_undefined() || !other_fonts.declared_value("font-family-names[2]").is_keyword("sans-serif"))
+		fail();
+	other_fonts.set("font-family: Tahoma");
+	if (!fonts.shares_properties(other_fonts))
+		fail();
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
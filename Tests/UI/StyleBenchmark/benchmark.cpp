@@ -0,0 +1,201 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/ui.h>
+#include <chrono>
+using namespace clan;
+
+const int num_rows = 50;
+const int num_columns = 10;
+const int num_cells = 9;
+const int num_iterations = 20;
+
+/// \brief Properties read by FlexLayout and the background, border and font code for every view
+const char *property_names[] =
+{
+	"position", "layout", "flex-direction", "flex-wrap", "flex-grow", "flex-shrink", "flex-basis", "align-items", "align-self", "justify-content",
+	"width", "height", "min-width", "min-height", "max-width", "max-height", "left", "top", "right", "bottom",
+	"margin-left", "margin-top", "margin-right", "margin-bottom", "padding-left", "padding-top", "padding-right", "padding-bottom",
+	"border-left-width", "border-top-width", "border-right-width", "border-bottom-width", "border-left-style", "border-left-color",
+	"border-top-left-radius", "background-color", "background-image[0]", "box-shadow", "font-size", "line-height", "font-weight", "font-family-names[0]", "color"
+};
+
+std::shared_ptr<View> create_view(const char *properties)
+{
+	auto view = std::make_shared<View>();
+	view->style()->set(properties);
+	view->style("hot")->set("background-color: yellow; font-size: 1.2em");
+	return view;
+}
+
+/// \brief Builds a root with rows of columns of cells, 5,051 views in total
+std::shared_ptr<View> create_tree(std::vector<View *> &views)
+{
+	auto root = create_view("flex-direction: column; font-size: 13px; padding: 0.5em; background: white; color: black");
+	views.push_back(root.get());
+	for (int row = 0; row < num_rows; row++)
+	{
+		auto row_view = create_view("flex-direction: row; margin: 2px 0; border: 1px solid gray; font-size: 0.9em");
+		views.push_back(row_view.get());
+		for (int column = 0; column < num_columns; column++)
+		{
+			auto column_view = create_view("flex-direction: column; flex: 1 1 0; padding: 0.25em; border-radius: 3px");
+			views.push_back(column_view.get());
+			for (int cell = 0; cell < num_cells; cell++)
+			{
+				auto cell_view = create_view("width: 4em; height: 1.5em; margin: 0.1em; background: #eee; border-bottom: 1px solid #ccc");
+				views.push_back(cell_view.get());
+				column_view->add_child(cell_view);
+			}
+			row_view->add_child(column_view);
+		}
+		root->add_child(row_view);
+	}
+	return root;
+}
+
+/// \brief Copies the style cascades of the views into a tree of cascades with caching disabled
+std::vector<std::unique_ptr<StyleCascade>> create_uncached_cascades(const std::vector<View *> &views)
+{
+	std::vector<std::unique_ptr<StyleCascade>> cascades;
+	std::map<const StyleCascade *, StyleCascade *> copies;
+	for (View *view : views)
+	{
+		auto cascade = clan::make_unique<StyleCascade>(view->style_cascade());
+		cascade->set_cache_enabled(false);
+		if (cascade->parent)
+			cascade->parent = copies[cascade->parent];
+		copies[&view->style_cascade()] = cascade.get();
+		cascades.push_back(std::move(cascade));
+	}
+	return cascades;
+}
+
+double resolve_styles(const std::vector<const StyleCascade *> &cascades, const std::vector<StylePropertyId> &ids, float &checksum, int iterations = num_iterations)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		for (const StyleCascade *cascade : cascades)
+		{
+			for (const StylePropertyId &id : ids)
+			{
+				StyleGetValue value = cascade->computed_value(id);
+				if (value.is_length())
+					checksum += value.number();
+			}
+		}
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+double layout_tree(const std::shared_ptr<View> &root, const std::vector<View *> &views, float &checksum)
+{
+	Canvas canvas;
+	double time = 0.0;
+	for (int iteration = 0; iteration < num_iterations; iteration++)
+	{
+		for (View *view : views)
+			view->set_needs_layout();
+
+		auto start = std::chrono::steady_clock::now();
+		float width = root->preferred_width(canvas);
+		checksum += width + root->preferred_height(canvas, width);
+		for (auto &row : root->children())
+			checksum += row->preferred_height(canvas, width);
+		time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	return time / num_iterations;
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		std::vector<View *> views;
+		std::shared_ptr<View> root = create_tree(views);
+
+		std::vector<StylePropertyId> ids;
+		for (const char *name : property_names)
+			ids.push_back(StylePropertyId(name));
+
+		std::vector<std::unique_ptr<StyleCascade>> uncached = create_uncached_cascades(views);
+		std::vector<const StyleCascade *> uncached_cascades, cached_cascades;
+		for (auto &cascade : uncached)
+			uncached_cascades.push_back(cascade.get());
+		for (View *view : views)
+			cached_cascades.push_back(&view->style_cascade());
+
+		Console::write_line("Style benchmark, %1 views, %2 properties per view, %3 iterations", (int)views.size(), (int)ids.size(), num_iterations);
+
+		float uncached_checksum = 0.0f, cached_checksum = 0.0f, checksum = 0.0f;
+		double uncached_time = resolve_styles(uncached_cascades, ids, uncached_checksum);
+		double cached_time = resolve_styles(cached_cascades, ids, cached_checksum);
+		Console::write_line("  Computed values, no cache: %1 ms per pass", StringHelp::float_to_text((float)uncached_time, 2));
+		Console::write_line("  Computed values, cached: %1 ms per pass", StringHelp::float_to_text((float)cached_time, 2));
+		if (uncached_checksum != cached_checksum)
+			throw Exception("Cached and uncached computed values differ");
+
+		Console::write_line("  Preferred size of the tree: %1 ms per layout", StringHelp::float_to_text((float)layout_tree(root, views, checksum), 2));
+
+		// Toggling a state at the root invalidates every view below it
+		auto start = std::chrono::steady_clock::now();
+		for (int iteration = 0; iteration < num_iterations; iteration++)
+		{
+			root->set_state_cascade("hot", iteration % 2 == 0);
+			resolve_styles(cached_cascades, ids, checksum, 1);
+		}
+		double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / num_iterations;
+		Console::write_line("  Root state toggle followed by a full pass: %1 ms", StringHelp::float_to_text((float)time, 2));
+
+		// Changing a single leaf only invalidates that view
+		start = std::chrono::steady_clock::now();
+		for (int iteration = 0; iteration < num_iterations; iteration++)
+		{
+			views.back()->style()->set("width: %1px", iteration);
+			resolve_styles(cached_cascades, ids, checksum, 1);
+		}
+		time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / num_iterations;
+		Console::write_line("  Leaf style change followed by a full pass: %1 ms", StringHelp::float_to_text((float)time, 2));
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
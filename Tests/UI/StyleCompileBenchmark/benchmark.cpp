@@ -0,0 +1,121 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/ui.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+using namespace clan;
+
+const int num_buttons = 10000;
+const int num_iterations = 5;
+
+/// \brief Bytes currently allocated through operator new
+std::atomic<long long> allocated_bytes(0);
+
+void *operator new(std::size_t size)
+{
+	std::size_t *block = static_cast<std::size_t *>(std::malloc(size + sizeof(std::max_align_t)));
+	if (!block)
+		throw std::bad_alloc();
+	*block = size;
+	allocated_bytes += size;
+	return reinterpret_cast<char *>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	if (ptr)
+	{
+		std::size_t *block = reinterpret_cast<std::size_t *>(static_cast<char *>(ptr) - sizeof(std::max_align_t));
+		allocated_bytes -= *block;
+		std::free(block);
+	}
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void *ptr) noexcept { operator delete(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { operator delete(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { operator delete(ptr); }
+
+/// \brief A button styled the way applications typically do it in their view constructors
+std::shared_ptr<ButtonView> create_button()
+{
+	auto button = std::make_shared<ButtonView>();
+	button->style()->set("border: 1px solid #ccc; border-radius: 3px; background: linear-gradient(to bottom, #fff, #ddd); padding: 2px 10px");
+	button->style("hot")->set("background: linear-gradient(to bottom, #fff, #eee)");
+	button->style("pressed")->set("background: #ccc");
+	button->label()->style()->set("font: 12px/15px 'Segoe UI'; color: black");
+	return button;
+}
+
+int main(int argc, char** argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("Style compile benchmark, %1 buttons, %2 iterations", num_buttons, num_iterations);
+
+		// Warm up property registration and the parsers
+		create_button();
+
+		double time = 0.0;
+		long long bytes = 0;
+		for (int iteration = 0; iteration < num_iterations; iteration++)
+		{
+			std::vector<std::shared_ptr<ButtonView>> buttons;
+			buttons.reserve(num_buttons);
+			long long start_bytes = allocated_bytes;
+
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < num_buttons; i++)
+				buttons.push_back(create_button());
+			time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			bytes += allocated_bytes - start_bytes;
+		}
+
+		Console::write_line("  Construction: %1 ms per %2 buttons", StringHelp::float_to_text((float)(time / num_iterations), 2), num_buttons);
+		Console::write_line("  Memory: %1 bytes per button", (int)(bytes / num_iterations / num_buttons));
+
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught: %1", error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
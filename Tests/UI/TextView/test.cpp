@@ -0,0 +1,247 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanUI text view editing");
+
+		test_typing();
+		test_undo();
+		test_redo();
+		test_multiline();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_typing()
+{
+	Console::write_line("   Typing");
+
+	TextView view;
+	type(view, "Hello");
+	press(view, Key::key_return);
+	type(view, "World");
+	if (view.text() != "Hello\nWorld" || view.cursor_pos() != Vec2i(5, 1))
+		fail();
+
+	press(view, Key::backspace);
+	press(view, Key::backspace);
+	if (view.text() != "Hello\nWor")
+		fail();
+
+	// Backspace at the start of a line joins it with the previous line
+	press(view, Key::home);
+	press(view, Key::backspace);
+	if (view.text() != "HelloWor" || view.cursor_pos() != Vec2i(5, 0))
+		fail();
+
+	press(view, Key::key_delete);
+	if (view.text() != "Helloor")
+		fail();
+
+	// Typing replaces the selection
+	press(view, Key::a, true);
+	type(view, "x");
+	if (view.text() != "x" || view.cursor_pos() != Vec2i(1, 0))
+		fail();
+
+	// Multibyte characters are removed as a whole
+	type(view, "\xc3\xa5");
+	press(view, Key::backspace);
+	if (view.text() != "x")
+		fail();
+}
+
+void TestApp::test_undo()
+{
+	Console::write_line("   Undo");
+
+	TextView view;
+	view.set_text("abc");
+	press(view, Key::end);
+	type(view, "def");
+	if (view.text() != "abcdef")
+		fail();
+
+	// Consecutive typing is undone as one step
+	press(view, Key::z, true);
+	if (view.text() != "abc" || view.cursor_pos() != Vec2i(3, 0))
+		fail();
+	press(view, Key::z, true);
+	if (view.text() != "abc")
+		fail();
+
+	// Backspaces merge, but moving the cursor starts a new step
+	type(view, "xyz");
+	press(view, Key::left);
+	press(view, Key::backspace);
+	press(view, Key::backspace);
+	if (view.text() != "abcz")
+		fail();
+	press(view, Key::z, true);
+	if (view.text() != "abcxyz" || view.cursor_pos() != Vec2i(5, 0))
+		fail();
+	press(view, Key::z, true);
+	if (view.text() != "abc")
+		fail();
+
+	// Forward deletes merge too
+	press(view, Key::home);
+	press(view, Key::key_delete);
+	press(view, Key::key_delete);
+	if (view.text() != "c")
+		fail();
+	press(view, Key::z, true);
+	if (view.text() != "abc" || view.cursor_pos() != Vec2i(0, 0))
+		fail();
+
+	// set_text clears the history
+	view.set_text("new");
+	press(view, Key::z, true);
+	if (view.text() != "new")
+		fail();
+}
+
+void TestApp::test_redo()
+{
+	Console::write_line("   Redo");
+
+	TextView view;
+	type(view, "one");
+	press(view, Key::a, true);
+	type(view, "two");
+	if (view.text() != "two")
+		fail();
+
+	press(view, Key::z, true);
+	if (view.text() != "one")
+		fail();
+	press(view, Key::z, true);
+	if (view.text() != "")
+		fail();
+	press(view, Key::y, true);
+	press(view, Key::y, true);
+	if (view.text() != "two" || view.cursor_pos() != Vec2i(3, 0))
+		fail();
+	press(view, Key::y, true);
+	if (view.text() != "two")
+		fail();
+
+	// A new edit clears the redo history
+	press(view, Key::z, true);
+	type(view, "!");
+	press(view, Key::y, true);
+	if (view.text() != "one!")
+		fail();
+}
+
+void TestApp::test_multiline()
+{
+	Console::write_line("   Multiple lines");
+
+	TextView view;
+	view.set_text("first\nsecond\nthird");
+
+	// Replacing a selection spanning several lines with several lines
+	view.set_selection(Vec2i(2, 0), Vec2i(3, 2));
+	type(view, "A");
+	press(view, Key::key_return);
+	press(view, Key::key_return);
+	type(view, "B");
+	if (view.text() != "fiA\n\nBrd" || view.cursor_pos() != Vec2i(1, 2))
+		fail();
+
+	// Typing after replacing the selection is part of the same step
+	press(view, Key::z, true);
+	if (view.text() != "first\nsecond\nthird" || view.cursor_pos() != Vec2i(3, 2))
+		fail();
+	press(view, Key::y, true);
+	if (view.text() != "fiA\n\nBrd" || view.cursor_pos() != Vec2i(1, 2))
+		fail();
+
+	press(view, Key::a, true);
+	if (view.selection_start() != Vec2i(0, 0) || view.selection_end() != Vec2i(3, 2))
+		fail();
+	press(view, Key::key_delete);
+	if (view.text() != "")
+		fail();
+	press(view, Key::z, true);
+	if (view.text() != "fiA\n\nBrd")
+		fail();
+}
+
+void TestApp::type(TextView &view, const std::string &text)
+{
+	UTF8_Reader reader(text.data(), text.length());
+	while (!reader.is_end())
+	{
+		KeyEvent e(KeyEventType::press, Key::none, 1, text.substr(reader.get_position(), reader.get_char_length()), Pointf(), false, false, false, false);
+		view.sig_key_press()(e);
+		reader.next();
+	}
+}
+
+void TestApp::press(TextView &view, Key key, bool ctrl)
+{
+	KeyEvent e(KeyEventType::press, key, 1, key == Key::key_return ? "\r" : "", Pointf(), false, false, ctrl, false);
+	view.sig_key_press()(e);
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
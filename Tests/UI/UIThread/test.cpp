@@ -0,0 +1,231 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <thread>
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanUI UI thread task queue");
+
+		test_order();
+		test_threads();
+		test_coalescing();
+		test_budget();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_order()
+{
+	Console::write_line("   Order");
+
+	std::vector<int> order;
+	UIThread::post([&]() { order.push_back(1); });
+	UIThread::post([&]() { order.push_back(2); }, UITaskPriority::low);
+	UIThread::post([&]() { order.push_back(3); });
+	if (UIThread::pending_tasks() != 3 || !order.empty())
+		fail();
+
+	// Normal priority tasks run first, and tasks posted while processing wait for the next call
+	UIThread::post([&]()
+	{
+		order.push_back(4);
+		UIThread::post([&]() { order.push_back(5); });
+	});
+	UIThread::process_tasks();
+	if (order != std::vector<int>({ 1, 3, 4, 2 }) || UIThread::pending_tasks() != 1)
+		fail();
+
+	UIThread::process_tasks();
+	if (order.size() != 5 || order.back() != 5 || UIThread::pending_tasks() != 0)
+		fail();
+
+	// Empty functions are ignored
+	UIThread::post(std::function<void()>());
+	if (UIThread::pending_tasks() != 0)
+		fail();
+}
+
+void TestApp::test_threads()
+{
+	Console::write_line("   Multiple threads");
+
+	const int num_threads = 4;
+	const int num_tasks = 10000;
+
+	std::vector<std::vector<int>> results(num_threads);
+	std::vector<std::thread> threads;
+	for (int thread_index = 0; thread_index < num_threads; thread_index++)
+	{
+		threads.push_back(std::thread([&, thread_index]()
+		{
+			for (int i = 0; i < num_tasks; i++)
+				UIThread::post([&, thread_index, i]() { results[thread_index].push_back(i); });
+		}));
+	}
+
+	// Process while the threads are posting
+	while (results[0].size() + results[1].size() + results[2].size() + results[3].size() < num_threads * num_tasks)
+		UIThread::process_tasks();
+
+	for (auto &thread : threads)
+		thread.join();
+
+	// Tasks from the same thread run in the order they were posted
+	for (const auto &result : results)
+	{
+		for (int i = 0; i < num_tasks; i++)
+		{
+			if (result[i] != i)
+				fail();
+		}
+	}
+	if (UIThread::pending_tasks() != 0)
+		fail();
+}
+
+void TestApp::test_coalescing()
+{
+	Console::write_line("   Coalescing keys");
+
+	std::vector<int> progress;
+	int other = 0;
+	for (int i = 0; i <= 100; i++)
+	{
+		UIThread::post("progress", [&, i]() { progress.push_back(i); });
+		UIThread::post([&]() { other++; });
+	}
+	if (UIThread::pending_tasks() != 202)
+		fail();
+
+	// Only the latest task for a key runs, without affecting other tasks
+	run_all_tasks();
+	if (progress != std::vector<int>({ 100 }) || other != 101)
+		fail();
+
+	// Keys replace tasks deferred from an earlier frame
+	UIThread::set_frame_budget(0.0);
+	UIThread::post([]() { }, UITaskPriority::low);
+	UIThread::post("status", [&]() { progress.push_back(1); }, UITaskPriority::low);
+	UIThread::process_tasks();
+	UIThread::post("status", [&]() { progress.push_back(2); }, UITaskPriority::low);
+	if (UIThread::pending_tasks() != 2)
+		fail();
+	run_all_tasks();
+	if (progress != std::vector<int>({ 100, 2 }))
+		fail();
+	UIThread::set_frame_budget(4.0);
+
+	// A key can be used again after its task has run
+	UIThread::post("progress", [&]() { progress.push_back(3); });
+	run_all_tasks();
+	if (progress.back() != 3)
+		fail();
+}
+
+void TestApp::test_budget()
+{
+	Console::write_line("   Frame budget");
+
+	if (UIThread::frame_budget() != 4.0)
+		fail();
+
+	// Without any budget one low priority task runs per frame, while normal ones always run
+	UIThread::set_frame_budget(0.0);
+	int low = 0, normal = 0;
+	for (int i = 0; i < 5; i++)
+	{
+		UIThread::post([&]() { low++; }, UITaskPriority::low);
+		UIThread::post([&]() { normal++; });
+	}
+	UIThread::process_tasks();
+	if (low != 1 || normal != 5)
+		fail();
+	UIThread::process_tasks();
+	if (low != 2 || UIThread::pending_tasks() != 3)
+		fail();
+
+	// Slow low priority tasks are spread over several frames
+	UIThread::set_frame_budget(5.0);
+	int slow = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		UIThread::post([&]()
+		{
+			slow++;
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}, UITaskPriority::low);
+	}
+	double time = UIThread::process_tasks();
+	if (low != 5 || slow == 0 || slow == 6 || time < 5.0)
+		fail();
+	run_all_tasks();
+	if (slow != 6)
+		fail();
+
+	UIThread::set_frame_budget(4.0);
+}
+
+void TestApp::run_all_tasks()
+{
+	while (UIThread::pending_tasks() > 0)
+		UIThread::process_tasks();
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
@@ -0,0 +1,233 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("For clanUI view tree damage tracking");
+
+		test_dirty_box();
+		test_layout_damage();
+		test_box_shadow();
+		test_layout_boundary();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+std::shared_ptr<TestViewTree> TestApp::attach(const std::shared_ptr<View> &root)
+{
+	// Views only report damage once they belong to a tree, so a new tree starts with an empty region
+	auto tree = std::make_shared<TestViewTree>();
+	tree->set_root_view(root);
+	return tree;
+}
+
+/// \brief Builds a root with a child and a grandchild, with the geometry a layout would have produced
+static void create_views(std::shared_ptr<View> &root, std::shared_ptr<View> &child, std::shared_ptr<View> &grandchild)
+{
+	root = std::make_shared<View>();
+	root->style()->set("padding: 10px");
+	child = std::make_shared<View>();
+	child->style()->set("border: 2px solid black");
+	grandchild = std::make_shared<View>();
+	child->add_child(grandchild);
+	root->add_child(child);
+
+	root->set_geometry(ViewGeometry::from_margin_box(root->style_cascade(), Rectf(0.0f, 0.0f, 400.0f, 300.0f)));
+	child->set_geometry(ViewGeometry::from_margin_box(child->style_cascade(), Rectf(20.0f, 30.0f, 120.0f, 80.0f)));
+	grandchild->set_geometry(ViewGeometry::from_margin_box(grandchild->style_cascade(), Rectf(5.0f, 5.0f, 25.0f, 15.0f)));
+}
+
+void TestApp::test_dirty_box()
+{
+	Console::write_line("   Dirty box");
+
+	std::shared_ptr<View> root, child, grandchild;
+	create_views(root, child, grandchild);
+
+	auto tree = attach(root);
+	if (tree->dirty_box() != Rectf() || tree->render_statistics().views_rendered != 0)
+		fail();
+
+	// Bounds are reported in canvas coordinates
+	grandchild->set_needs_render();
+	if (tree->dirty_box() != Rectf(37.0f, 47.0f, 57.0f, 57.0f) || tree->render_requests != 1)
+		fail();
+
+	// The region grows to the bounding box of all invalidated rects
+	tree->invalidate_rect(Rectf(100.0f, 100.0f, 110.0f, 120.0f));
+	if (tree->dirty_box() != Rectf(37.0f, 47.0f, 110.0f, 120.0f))
+		fail();
+
+	// Empty rects are ignored
+	tree->invalidate_rect(Rectf(300.0f, 300.0f, 300.0f, 310.0f));
+	if (tree->dirty_box() != Rectf(37.0f, 47.0f, 110.0f, 120.0f))
+		fail();
+
+	// Changing a state damages the view
+	tree = attach(root);
+	child->set_state("hot", true);
+	if (tree->dirty_box() != Rectf(30.0f, 40.0f, 130.0f, 90.0f))
+		fail();
+
+	// Views outside a tree have nowhere to report damage
+	auto detached = std::make_shared<View>();
+	detached->set_needs_render();
+	detached->set_needs_layout();
+	if (tree->dirty_box() != Rectf(30.0f, 40.0f, 130.0f, 90.0f))
+		fail();
+
+	if (tree->retained_rendering())
+		fail();
+	tree->set_retained_rendering(true);
+	if (!tree->retained_rendering())
+		fail();
+}
+
+void TestApp::test_layout_damage()
+{
+	Console::write_line("   Layout damage");
+
+	std::shared_ptr<View> root, child, grandchild;
+	create_views(root, child, grandchild);
+
+	// Only the view requesting layout is damaged, not its ancestors
+	auto tree = attach(root);
+	grandchild->set_needs_layout();
+	if (tree->dirty_box() != Rectf(37.0f, 47.0f, 57.0f, 57.0f) || !root->needs_layout() || !child->needs_layout() || tree->render_requests != 1)
+		fail();
+
+	// Geometry changes damage both the old and the new bounds
+	tree = attach(root);
+	child->set_geometry(ViewGeometry::from_margin_box(child->style_cascade(), Rectf(20.0f, 130.0f, 120.0f, 180.0f)));
+	if (tree->dirty_box() != Rectf(30.0f, 40.0f, 130.0f, 190.0f))
+		fail();
+
+	// Setting the same geometry again does nothing
+	tree = attach(root);
+	child->set_geometry(ViewGeometry::from_margin_box(child->style_cascade(), Rectf(20.0f, 130.0f, 120.0f, 180.0f)));
+	if (tree->dirty_box() != Rectf() || tree->render_requests != 0)
+		fail();
+}
+
+void TestApp::test_box_shadow()
+{
+	Console::write_line("   Box shadow overflow");
+
+	std::shared_ptr<View> root, child, grandchild;
+	create_views(root, child, grandchild);
+	grandchild->style()->set("box-shadow: 4px 6px 3px black");
+
+	auto tree = attach(root);
+	grandchild->set_needs_render();
+	if (tree->dirty_box() != Rectf(37.0f, 47.0f, 64.0f, 66.0f))
+		fail();
+
+	// Inset shadows stay inside the border box
+	grandchild->style()->set("box-shadow: inset 4px 6px 3px black");
+	tree = attach(root);
+	grandchild->set_needs_render();
+	if (tree->dirty_box() != Rectf(37.0f, 47.0f, 57.0f, 57.0f))
+		fail();
+}
+
+void TestApp::test_layout_boundary()
+{
+	Console::write_line("   Layout boundaries");
+
+	auto root = std::make_shared<View>();
+	root->style()->set("flex-direction: column; padding: 10px");
+	auto panel = std::make_shared<View>();
+	panel->style()->set("width: 100px; height: 50px; flex-direction: row");
+	auto sibling = std::make_shared<View>();
+	sibling->style()->set("height: 20px");
+	auto leaf = std::make_shared<View>();
+	leaf->style()->set("height: 10px");
+	panel->add_child(leaf);
+	root->add_child(panel);
+	root->add_child(sibling);
+
+	auto tree = attach(root);
+	tree->layout_views(Rectf(0.0f, 0.0f, 400.0f, 300.0f));
+	if (root->needs_layout() || panel->needs_layout() || leaf->needs_layout())
+		fail();
+	if (panel->geometry().margin_box() != Rectf(0.0f, 0.0f, 100.0f, 50.0f) || leaf->geometry().margin_box() != Rectf(0.0f, 0.0f, 0.0f, 10.0f))
+		fail();
+
+	// The panel has a definite size, so a change inside it does not affect the root
+	leaf->set_needs_layout();
+	if (!leaf->needs_layout() || !panel->needs_layout() || root->needs_layout() || sibling->needs_layout())
+		fail();
+
+	leaf->style()->set("width: 40px");
+	tree->layout_views(Rectf(0.0f, 0.0f, 400.0f, 300.0f));
+	if (panel->needs_layout() || leaf->geometry().margin_box() != Rectf(0.0f, 0.0f, 40.0f, 10.0f))
+		fail();
+
+	// Changing the size of the panel itself invalidates the root
+	panel->style()->set("width: 120px");
+	leaf->set_needs_layout();
+	if (!root->needs_layout())
+		fail();
+	tree->layout_views(Rectf(0.0f, 0.0f, 400.0f, 300.0f));
+	if (panel->geometry().margin_box() != Rectf(0.0f, 0.0f, 120.0f, 50.0f) || sibling->geometry().margin_box() != Rectf(0.0f, 50.0f, 380.0f, 70.0f))
+		fail();
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
+
@@ -0,0 +1,69 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/ui.h>
+using namespace clan;
+
+class TestViewTree : public ViewTree
+{
+public:
+	DisplayWindow display_window() override { return DisplayWindow(); }
+	Canvas canvas() const override { return Canvas(); }
+
+	int render_requests = 0;
+
+	void layout_views(const Rectf &box)
+	{
+		Canvas canvas;
+		layout(canvas, box);
+	}
+
+protected:
+	void set_needs_render() override { render_requests++; }
+	Pointf client_to_screen_pos(const Pointf &pos) override { return pos; }
+	Pointf screen_to_client_pos(const Pointf &pos) override { return pos; }
+};
+
+class TestApp
+{
+public:
+	int main();
+
+private:
+	void test_dirty_box();
+	void test_layout_damage();
+	void test_box_shadow();
+	void test_layout_boundary();
+
+	std::shared_ptr<TestViewTree> attach(const std::shared_ptr<View> &root);
+
+	void fail();
+};